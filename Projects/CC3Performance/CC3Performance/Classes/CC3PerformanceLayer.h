@@ -66,6 +66,7 @@
  *   - updates per second
  *   - count of nodes updated per update pass
  *   - count of nodes whose globalTransformMatrix was recalculated per update pass
+ *   - speedup achieved by updating independent nodes concurrently on multiple cores
  *
  * There are also two joystick controls that allow the user to control the 3D camera.
  * By moving the camera, the user can move some of the coped nodes out of view, and
@@ -85,6 +86,7 @@
 	CCLabelBMFont* _updateRateLabel;
 	CCLabelBMFont* _nodesUpdatedLabel;
 	CCLabelBMFont* _nodesTransformedLabel;
+	CCLabelBMFont* _concurrentUpdateSpeedupLabel;
 	CCLabelBMFont* _drawingTitleLabel;
 	CCLabelBMFont* _frameRateLabel;
 	CCLabelBMFont* _nodesVisitedForDrawingLabel;
@@ -75,6 +75,13 @@
  */
 -(CC3PerformanceScene*) performanceScene { return (CC3PerformanceScene*)super.cc3Scene; }
 
+/**
+ * The scene class is derived automatically from the name of this layer class. To measure
+ * the benefit of culling with the node bounds tree of the scene, uncomment this method to
+ * use a CC3CullingBenchmarkScene instead, and watch the log for the drawing times.
+ */
+//-(Class) cc3SceneClass { return [CC3CullingBenchmarkScene class]; }
+
 /** Initialize all the 2D user controls. */
 -(void) initializeControls {
 	[self addButtons];
@@ -171,6 +178,7 @@
 	_updateRateLabel = [self addStatsLabel: @"0"];
 	_nodesUpdatedLabel = [self addStatsLabel: @"0"];
 	_nodesTransformedLabel = [self addStatsLabel: @"0"];
+	_concurrentUpdateSpeedupLabel = [self addStatsLabel: @"0"];
 	
 	_drawingTitleLabel = [self addStatsLabel: @"Drawing:"];
 	_drawingTitleLabel.color = CCColorRefFromCCC4F(kCCC4FYellow);
@@ -239,6 +247,7 @@
 	
 	vertPos -= kStatsLineSpacing;
 	_drawCallsLabel.position = ccp(leftTab, vertPos);
+	_concurrentUpdateSpeedupLabel.position = ccp(rightTab, vertPos);
 
 	vertPos -= kStatsLineSpacing;
 	_facesPresentedLabel.position = ccp(leftTab, vertPos);
@@ -345,6 +354,8 @@
 										stats.averageNodesUpdatedPerUpdate]];
 		[_nodesTransformedLabel setString: [NSString stringWithFormat: @"xfmed: %.0f",
 											stats.averageNodesTransformedPerUpdate]];
+		[_concurrentUpdateSpeedupLabel setString: [NSString stringWithFormat: @"speedup: %.1f",
+												   stats.concurrentUpdateSpeedup]];
 		
 		[stats reset];
 	}
@@ -120,6 +120,37 @@
 
 @end
 
+
+#pragma mark -
+#pragma mark CC3CullingBenchmarkScene
+
+/**
+ * A specialization of CC3PerformanceScene that measures the cost of frustum culling a scene
+ * that contains a very large number of nodes, most of which are outside the camera frustum.
+ *
+ * In addition to the content of the CC3PerformanceScene, this scene contains a field of
+ * 50,000 static box nodes, scattered over a large area around the camera, and 1,000 box
+ * nodes that continually move around the field.
+ *
+ * The shouldCullWithNodeBoundsTree property of the drawing visitor is alternately turned
+ * on and off every few seconds, and the average time taken to draw the scene content under
+ * each configuration is written to the log. The nodes drawn are the same in both configurations,
+ * so the difference between the two times is the cost saved by culling whole branches of the
+ * nodeBoundsTree of the scene, instead of testing each node individually against the frustum.
+ *
+ * To run this benchmark, uncomment the cc3SceneClass method in CC3PerformanceLayer.
+ */
+@interface CC3CullingBenchmarkScene : CC3PerformanceScene {
+	CC3Node* _cullingField;
+	CC3Vector* _moverCenters;
+	NSTimeInterval _cullingDrawTime;
+	CCTime _cullingRunTime;
+	GLuint _moverCount;
+	GLuint _cullingFrameCount;
+}
+
+@end
+
 /**
  * A specialized CC3NodeUpdatingVisitor that animates each copy of the template
  * node by modifying the rotation property of each copy of the template node
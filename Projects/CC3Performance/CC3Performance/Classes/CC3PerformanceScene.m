@@ -113,6 +113,10 @@
 
 	_shouldAnimateNodes = NO;	// Start with static nodes.
 
+	// Update the copies of the template node concurrently on all available cores.
+	// The speedup achieved is displayed in the performance statistics.
+	self.updateVisitor.shouldUpdateConcurrently = YES;
+
 	// Create the camera, place it back a bit, and add it to the scene
 	CC3Camera* cam = [CC3Camera nodeWithName: @"Camera"];
 	cam.location = cc3v( 0.0, 150.0, 300.0 );
@@ -373,6 +377,119 @@
 @end
 
 
+#pragma mark -
+#pragma mark CC3CullingBenchmarkScene
+
+#define kCullingFieldName			@"CullingField"
+#define kCullingStaticNodeCount		50000
+#define kCullingMovingNodeCount		1000
+#define kCullingFieldExtent			20000.0
+#define kCullingMoverOrbitRadius	200.0
+#define kCullingRunDuration			3.0
+
+@implementation CC3CullingBenchmarkScene
+
+-(void) dealloc {
+	free(_moverCenters);
+}
+
+/** Returns a random location within the culling field, at ground level. */
+-(CC3Vector) randomFieldLocation {
+	return cc3v(CC3RandomFloatBetween(-kCullingFieldExtent, kCullingFieldExtent),
+				CC3RandomFloatBetween(-20.0, 20.0),
+				CC3RandomFloatBetween(-kCullingFieldExtent, kCullingFieldExtent));
+}
+
+/**
+ * Adds a field of static box nodes, and a number of moving box nodes, scattered over a large
+ * area around the camera. Only a small fraction of these nodes are within the camera frustum.
+ */
+-(void) initializeScene {
+	[super initializeScene];
+
+	CC3BoxNode* boxTemplate = [CC3BoxNode nodeWithName: @"Culled box"];
+	[boxTemplate populateAsSolidBox: CC3BoxFromMinMax(cc3v(-5.0, -5.0, -5.0), cc3v(5.0, 5.0, 5.0))];
+	boxTemplate.color = CCColorRefFromCCC4F(kCCC4FCyan);
+	[boxTemplate selectShaders];
+	[boxTemplate createGLBuffers];
+	[boxTemplate releaseRedundantContent];
+
+	_cullingField = [CC3Node nodeWithName: kCullingFieldName];
+	[self addChild: _cullingField];
+
+	for (GLuint nIdx = 0; nIdx < kCullingStaticNodeCount; nIdx++) {
+		CC3Node* aNode = [boxTemplate copy];
+		aNode.location = [self randomFieldLocation];
+		[_cullingField addChild: aNode];
+	}
+
+	_moverCount = kCullingMovingNodeCount;
+	_moverCenters = malloc(_moverCount * sizeof(CC3Vector));
+	for (GLuint mIdx = 0; mIdx < _moverCount; mIdx++) {
+		_moverCenters[mIdx] = [self randomFieldLocation];
+		CC3Node* aNode = [boxTemplate copy];
+		aNode.location = _moverCenters[mIdx];
+		[_cullingField addChild: aNode];
+	}
+
+	_cullingDrawTime = 0.0;
+	_cullingRunTime = 0.0;
+	_cullingFrameCount = 0;
+}
+
+
+#pragma mark Updating
+
+/**
+ * Moves each of the moving nodes around a circular orbit about its own center. The moving
+ * nodes are the last children of the culling field.
+ */
+-(void) updateBeforeTransform: (CC3NodeUpdatingVisitor*) visitor {
+	[super updateBeforeTransform: visitor];
+
+	GLfloat elapsed = self.elapsedTimeSinceOpened;
+	NSArray* fieldNodes = _cullingField.children;
+	GLuint firstMoverIdx = (GLuint)fieldNodes.count - _moverCount;
+	for (GLuint mIdx = 0; mIdx < _moverCount; mIdx++) {
+		CC3Node* aNode = [fieldNodes objectAtIndex: (firstMoverIdx + mIdx)];
+		GLfloat angle = elapsed * (0.5 + (GLfloat)(mIdx % 7) * 0.1) + mIdx;
+		aNode.location = CC3VectorAdd(_moverCenters[mIdx],
+									  cc3v(cosf(angle) * kCullingMoverOrbitRadius,
+										   0.0,
+										   sinf(angle) * kCullingMoverOrbitRadius));
+	}
+}
+
+
+#pragma mark Drawing
+
+/**
+ * Times the drawing of the scene content. Every few seconds, the average time per frame is
+ * logged, and the use of the nodeBoundsTree by the drawing visitor is toggled on or off.
+ */
+-(void) drawSceneContentWithVisitor: (CC3NodeDrawingVisitor*) visitor {
+	NSTimeInterval startTime = NSDate.timeIntervalSinceReferenceDate;
+	[super drawSceneContentWithVisitor: visitor];
+	_cullingDrawTime += NSDate.timeIntervalSinceReferenceDate - startTime;
+	_cullingFrameCount++;
+
+	_cullingRunTime += visitor.deltaTime;
+	if (_cullingRunTime < kCullingRunDuration) return;
+
+	LogInfo(@"%@ drew %lu field nodes in %.3f ms per frame %@ the node bounds tree",
+			self, (unsigned long)_cullingField.children.count,
+			(_cullingDrawTime * 1000.0 / _cullingFrameCount),
+			(visitor.shouldCullWithNodeBoundsTree ? @"using" : @"without"));
+
+	visitor.shouldCullWithNodeBoundsTree = !visitor.shouldCullWithNodeBoundsTree;
+	_cullingDrawTime = 0.0;
+	_cullingRunTime = 0.0;
+	_cullingFrameCount = 0;
+}
+
+@end
+
+
 #pragma mark -
 #pragma mark CC3AnimatingVisitor
 
@@ -0,0 +1,283 @@
+/******************************************************************************
+
+ @File         BoneBatchBench.cpp
+
+ @Title        BoneBatchBench
+
+ @Copyright    Copyright (c) 2010-2014 The Brenwill Workshop Ltd.
+
+ @Platform     ANSI compatible
+
+ @Description  Command-line tool that measures how long CPVRTBoneBatches takes
+               to batch the bones of synthetic skinned meshes, and how many
+               batches it creates. See README.txt for usage.
+
+******************************************************************************/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "PVRTBoneBatch.h"
+
+/*!***************************************************************************
+ Structures
+*****************************************************************************/
+/*!***************************************************************************
+ @struct			SRigVertex
+ @brief				A skinned vertex, with up to four bones.
+*****************************************************************************/
+struct SRigVertex
+{
+	float			fPosition[3];
+	float			fWeights[4];
+	unsigned char	ui8Bones[4];
+};
+
+/*!***************************************************************************
+ @struct			SRig
+ @brief				A synthetic skinned mesh.
+*****************************************************************************/
+struct SRig
+{
+	const char		*pszName;
+	SRigVertex		*pVertices;
+	unsigned int	*pui32Indices;
+	int				nNumVertices;
+	int				nNumTriangles;
+	int				nNumBones;
+	int				nBatchBoneMax;
+};
+
+/*!***************************************************************************
+ @Function			AllocateRig
+ @Input				nNumVertices	Number of vertices
+ @Input				nNumTriangles	Number of triangles
+ @Output			rig				The rig to allocate
+ @Description		Allocates the vertices and triangles of a rig.
+*****************************************************************************/
+static void AllocateRig(const int nNumVertices, const int nNumTriangles, SRig &rig)
+{
+	rig.nNumVertices = nNumVertices;
+	rig.nNumTriangles = nNumTriangles;
+	rig.pVertices = (SRigVertex*)calloc(nNumVertices, sizeof(SRigVertex));
+	rig.pui32Indices = (unsigned int*)malloc(nNumTriangles * 3 * sizeof(unsigned int));
+}
+
+/*!***************************************************************************
+ @Function			AddQuad
+ @Input				pui32Indices	Index array
+ @Input				nQuad			Index of the quad
+ @Input				a, b, c, d		Corners of the quad, anticlockwise
+ @Description		Adds the two triangles of a quad.
+*****************************************************************************/
+static void AddQuad(unsigned int * const pui32Indices, const int nQuad,
+					const unsigned int a, const unsigned int b, const unsigned int c, const unsigned int d)
+{
+	unsigned int* pTri = pui32Indices + nQuad * 6;
+	pTri[0] = a; pTri[1] = b; pTri[2] = c;
+	pTri[3] = a; pTri[4] = c; pTri[5] = d;
+}
+
+/*!***************************************************************************
+ @Function			CreateChainRig
+ @Input				nNumBones		Number of bones in the chain
+ @Input				nRings			Number of rings of vertices along the chain
+ @Input				nSegments		Number of vertices around each ring
+ @Input				nBatchBoneMax	Number of bones a batch can reference
+ @Output			rig				The rig
+ @Description		Creates a tube skinned to a chain of bones, such as a tail or
+					a tentacle. Each vertex is weighted to the bone of its ring
+					and the next bone along the chain.
+*****************************************************************************/
+static void CreateChainRig(const int nNumBones, const int nRings, const int nSegments, const int nBatchBoneMax, SRig &rig)
+{
+	rig.pszName = "chain";
+	rig.nNumBones = nNumBones;
+	rig.nBatchBoneMax = nBatchBoneMax;
+	AllocateRig(nRings * nSegments, (nRings - 1) * nSegments * 2, rig);
+
+	for(int r = 0; r < nRings; ++r)
+	{
+		float fAlong = (float)r * (nNumBones - 1) / (nRings - 1);
+		int nBone = (int)fAlong;
+		if(nBone >= nNumBones - 1)
+			nBone = nNumBones - 2;
+		float fBlend = fAlong - nBone;
+
+		for(int s = 0; s < nSegments; ++s)
+		{
+			SRigVertex &v = rig.pVertices[r * nSegments + s];
+			v.fPosition[0] = (float)s;
+			v.fPosition[1] = fAlong;
+			v.fWeights[0] = 1.0f - fBlend;
+			v.fWeights[1] = fBlend;
+			v.ui8Bones[0] = (unsigned char)nBone;
+			v.ui8Bones[1] = (unsigned char)(nBone + 1);
+		}
+	}
+
+	int nQuad = 0;
+	for(int r = 0; r < nRings - 1; ++r)
+		for(int s = 0; s < nSegments; ++s)
+		{
+			int sNext = (s + 1) % nSegments;
+			AddQuad(rig.pui32Indices, nQuad++, r * nSegments + s, r * nSegments + sNext,
+					(r + 1) * nSegments + sNext, (r + 1) * nSegments + s);
+		}
+}
+
+/*!***************************************************************************
+ @Function			CreateGridRig
+ @Input				nBoneGrid		Number of bones along each side of the grid
+ @Input				nVertexGrid		Number of vertices along each side of the mesh
+ @Input				nBatchBoneMax	Number of bones a batch can reference
+ @Output			rig				The rig
+ @Description		Creates a sheet skinned to a square grid of bones, such as a
+					face or a cloth. Each vertex is weighted to the four bones
+					around it.
+*****************************************************************************/
+static void CreateGridRig(const int nBoneGrid, const int nVertexGrid, const int nBatchBoneMax, SRig &rig)
+{
+	rig.pszName = "grid";
+	rig.nNumBones = nBoneGrid * nBoneGrid;
+	rig.nBatchBoneMax = nBatchBoneMax;
+	AllocateRig(nVertexGrid * nVertexGrid, (nVertexGrid - 1) * (nVertexGrid - 1) * 2, rig);
+
+	for(int y = 0; y < nVertexGrid; ++y)
+		for(int x = 0; x < nVertexGrid; ++x)
+		{
+			SRigVertex &v = rig.pVertices[y * nVertexGrid + x];
+			float fX = (float)x * (nBoneGrid - 1) / (nVertexGrid - 1);
+			float fY = (float)y * (nBoneGrid - 1) / (nVertexGrid - 1);
+			int nX = (int)fX, nY = (int)fY;
+			if(nX >= nBoneGrid - 1)
+				nX = nBoneGrid - 2;
+			if(nY >= nBoneGrid - 1)
+				nY = nBoneGrid - 2;
+			float fBlendX = fX - nX, fBlendY = fY - nY;
+
+			v.fPosition[0] = fX;
+			v.fPosition[1] = fY;
+			for(int c = 0; c < 4; ++c)
+			{
+				int nCX = c & 1, nCY = c >> 1;
+				v.fWeights[c] = (nCX ? fBlendX : 1.0f - fBlendX) * (nCY ? fBlendY : 1.0f - fBlendY);
+				v.ui8Bones[c] = (unsigned char)((nY + nCY) * nBoneGrid + nX + nCX);
+			}
+		}
+
+	int nQuad = 0;
+	for(int y = 0; y < nVertexGrid - 1; ++y)
+		for(int x = 0; x < nVertexGrid - 1; ++x)
+			AddQuad(rig.pui32Indices, nQuad++, y * nVertexGrid + x, y * nVertexGrid + x + 1,
+					(y + 1) * nVertexGrid + x + 1, (y + 1) * nVertexGrid + x);
+}
+
+/*!***************************************************************************
+ @Function			DestroyRig
+ @Modified			rig				The rig to free
+ @Description		Frees the vertices and triangles of a rig.
+*****************************************************************************/
+static void DestroyRig(SRig &rig)
+{
+	free(rig.pVertices);
+	free(rig.pui32Indices);
+}
+
+/*!***************************************************************************
+ @Function			Measure
+ @Input				rig				The rig to batch
+ @Input				bMinimizeBatches	Whether to use the minimize-batches mode
+ @Input				uiRepeats		Number of times to batch the rig
+ @Return			true if the rig was batched successfully
+ @Description		Batches the bones of the rig the specified number of times,
+					and prints the average time taken and the number of batches.
+*****************************************************************************/
+static bool Measure(const SRig &rig, const bool bMinimizeBatches, const unsigned int uiRepeats)
+{
+	unsigned int* pui32Indices = (unsigned int*)malloc(rig.nNumTriangles * 3 * sizeof(unsigned int));
+	int nNumBatches = 0;
+	clock_t elapsed = 0;
+
+	for(unsigned int r = 0; r < uiRepeats; ++r)
+	{
+		// Create() rewrites the indices, so each run starts from the original triangles
+		memcpy(pui32Indices, rig.pui32Indices, rig.nNumTriangles * 3 * sizeof(unsigned int));
+
+		CPVRTBoneBatches batches;
+		int nNumVerticesOut = 0;
+		char* pVerticesOut = NULL;
+
+		clock_t start = clock();
+		EPVRTError eError = batches.Create(&nNumVerticesOut, &pVerticesOut, pui32Indices, rig.nNumVertices,
+										   (const char*)rig.pVertices, sizeof(SRigVertex),
+										   offsetof(SRigVertex, fWeights), EPODDataFloat,
+										   offsetof(SRigVertex, ui8Bones), EPODDataUnsignedByte,
+										   rig.nNumTriangles, rig.nBatchBoneMax, 4
+#if !defined(BONEBATCHBENCH_ORIGINAL)
+										   , bMinimizeBatches
+#endif
+										   );
+		elapsed += clock() - start;
+
+		if(eError != PVR_SUCCESS)
+		{
+			fprintf(stderr, "BoneBatchBench: failed to batch the %s rig\n", rig.pszName);
+			free(pui32Indices);
+			return false;
+		}
+
+		nNumBatches = batches.nBatchCnt;
+		free(pVerticesOut);
+		batches.Release();
+	}
+	free(pui32Indices);
+
+	double dMillis = 1000.0 * (double)elapsed / CLOCKS_PER_SEC / uiRepeats;
+	printf("%-8s %6d bones %8d triangles %4d bones/batch  %-10s %10.1f ms %6d batches\n", rig.pszName, rig.nNumBones,
+		   rig.nNumTriangles, rig.nBatchBoneMax, bMinimizeBatches ? "minimize" : "default", dMillis, nNumBatches);
+	return true;
+}
+
+/*!***************************************************************************
+ @Function			main
+ @Description		Measures each rig in each mode.
+*****************************************************************************/
+int main(int argc, char** argv)
+{
+	unsigned int uiRepeats = 5;
+	bool bSuccess = true;
+
+	if(argc == 3 && strcmp(argv[1], "-n") == 0)
+	{
+		uiRepeats = (unsigned int)atoi(argv[2]);
+		if(!uiRepeats)
+			uiRepeats = 1;
+	}
+	else if(argc != 1)
+	{
+		fprintf(stderr, "Usage: BoneBatchBench [-n repeats]\n");
+		return 1;
+	}
+
+	SRig rigs[2];
+	CreateChainRig(200, 400, 128, 8, rigs[0]);
+	CreateGridRig(16, 161, 16, rigs[1]);
+
+	for(int r = 0; r < 2; ++r)
+	{
+		bSuccess = Measure(rigs[r], false, uiRepeats) && bSuccess;
+#if !defined(BONEBATCHBENCH_ORIGINAL)
+		bSuccess = Measure(rigs[r], true, uiRepeats) && bSuccess;
+#endif
+		DestroyRig(rigs[r]);
+	}
+
+	return bSuccess ? 0 : 1;
+}
+
+/*****************************************************************************
+ End of file (BoneBatchBench.cpp)
+*****************************************************************************/
@@ -0,0 +1,134 @@
+/******************************************************************************
+
+ @File         DecompressBench.cpp
+
+ @Title        DecompressBench
+
+ @Copyright    Copyright (c) 2010-2014 The Brenwill Workshop Ltd.
+
+ @Platform     ANSI compatible
+
+ @Description  Command-line tool that measures the throughput of the PVRTC and
+               ETC1 decoders in PVRTDecompress. See README.txt for usage.
+
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "PVRTDecompress.h"
+#include "PVRTParallel.h"
+
+/*!***************************************************************************
+ @Function			WallClockSeconds
+ @Return			The current wall-clock time, in seconds
+ @Description		Returns the wall-clock time. clock() is not used, because
+					it adds together the time taken by all worker threads.
+*****************************************************************************/
+static double WallClockSeconds()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec * 1.0e-6;
+}
+
+/*!***************************************************************************
+ @Function			GenerateData
+ @Input				uiSize			Number of bytes to generate
+ @Return			A buffer of pseudo-random bytes, to be freed with free()
+ @Description		Generates compressed texture data. Every bit pattern is a
+					valid PVRTC or ETC1 block, so random data exercises every
+					decode path without needing a compressor.
+*****************************************************************************/
+static unsigned char* GenerateData(const unsigned int uiSize)
+{
+	unsigned char* pData = (unsigned char*)malloc(uiSize);
+	unsigned int uiSeed = 0x1234567;
+	for(unsigned int i = 0; i < uiSize; ++i)
+	{
+		uiSeed = uiSeed * 1103515245 + 12345;
+		pData[i] = (unsigned char)(uiSeed >> 16);
+	}
+	return pData;
+}
+
+/*!***************************************************************************
+ @Function			Measure
+ @Input				pszFormat		Name of the format, for the report
+ @Input				nFormat			0 for PVRTC 2bpp, 1 for PVRTC 4bpp, 2 for ETC1
+ @Input				uiDim			Width and height of the texture
+ @Input				uiRepeats		Number of times to decode the texture
+ @Description		Decodes a square texture of random data the specified number
+					of times, with the scalar and SSE2/NEON paths on one thread
+					and with the SSE2/NEON paths on all threads, and prints the
+					throughput of each in megapixels per second.
+*****************************************************************************/
+static void Measure(const char * const pszFormat, const int nFormat, const unsigned int uiDim, const unsigned int uiRepeats)
+{
+	const unsigned int uiBitsPerPixel = (nFormat == 0) ? 2 : 4;
+	unsigned char* pSrc = GenerateData(uiDim * uiDim * uiBitsPerPixel / 8);
+	unsigned char* pDest = (unsigned char*)malloc(uiDim * uiDim * 4);
+
+	const bool c_bSIMD[] = { false, true, true };
+	const unsigned int c_uiThreads[] = { 1, 1, 0 };
+	double dMPs[3];
+
+	for(unsigned int m = 0; m < 3; ++m)
+	{
+		PVRTDecompressSetSIMD(c_bSIMD[m]);
+		PVRTDecompressSetThreadCount(c_uiThreads[m]);
+
+		double dStart = WallClockSeconds();
+		for(unsigned int r = 0; r < uiRepeats; ++r)
+		{
+			if(nFormat == 2)
+				PVRTDecompressETC(pSrc, uiDim, uiDim, pDest, 0);
+			else
+				PVRTDecompressPVRTC(pSrc, nFormat == 0, (int)uiDim, (int)uiDim, pDest);
+		}
+		double dSeconds = WallClockSeconds() - dStart;
+		dMPs[m] = (double)uiDim * uiDim * uiRepeats / 1.0e6 / dSeconds;
+	}
+
+	printf("%-12s %5u x %-5u %10.1f MP/s %10.1f MP/s %10.1f MP/s\n", pszFormat, uiDim, uiDim, dMPs[0], dMPs[1], dMPs[2]);
+
+	free(pSrc);
+	free(pDest);
+}
+
+/*!***************************************************************************
+ @Function			main
+ @Description		Measures each format at increasing texture sizes.
+*****************************************************************************/
+int main(int argc, char** argv)
+{
+	unsigned int uiRepeats = 10;
+
+	if(argc == 3 && strcmp(argv[1], "-n") == 0)
+	{
+		uiRepeats = (unsigned int)atoi(argv[2]);
+		if(!uiRepeats)
+			uiRepeats = 1;
+	}
+	else if(argc != 1)
+	{
+		fprintf(stderr, "Usage: DecompressBench [-n repeats]\n");
+		return 1;
+	}
+
+	printf("SIMD paths %s, %u threads\n", PVRTDecompressUsesSIMD() ? "available" : "not compiled in", PVRTParallelThreadCount());
+	printf("%-12s %-13s %15s %15s %15s\n", "format", "size", "scalar", "SIMD", "SIMD, threads");
+
+	const char* c_pszFormats[] = { "PVRTC 2bpp", "PVRTC 4bpp", "ETC1" };
+	const unsigned int c_uiDims[] = { 64, 256, 1024, 2048 };
+	for(int f = 0; f < 3; ++f)
+		for(unsigned int d = 0; d < sizeof(c_uiDims) / sizeof(c_uiDims[0]); ++d)
+			Measure(c_pszFormats[f], f, c_uiDims[d], uiRepeats);
+
+	return 0;
+}
+
+/*****************************************************************************
+ End of file (DecompressBench.cpp)
+*****************************************************************************/
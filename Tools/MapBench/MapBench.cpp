@@ -0,0 +1,198 @@
+/******************************************************************************
+
+ @File         MapBench.cpp
+
+ @Title        MapBench
+
+ @Copyright    Copyright (c) 2010-2014 The Brenwill Workshop Ltd.
+
+ @Platform     ANSI compatible
+
+ @Description  Command-line tool that measures the insertion and lookup times
+               of CPVRTMap against the linear search it replaced. See
+               README.txt for usage.
+
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "PVRTMap.h"
+
+/*!***************************************************************************
+ Class
+*****************************************************************************/
+/*!***************************************************************************
+ @class				CLinearMap
+ @brief				The original CPVRTMap, which finds every key by searching
+					the key array from the start.
+*****************************************************************************/
+template <typename KeyType, typename DataType>
+class CLinearMap
+{
+public:
+	CLinearMap() : m_uiSize(0) {}
+
+	PVRTuint32 GetIndexOf(const KeyType key) const
+	{
+		for (PVRTuint32 i=0; i<m_uiSize; ++i)
+		{
+			if (m_Keys[i]==key)
+				return i;
+		}
+		return m_uiSize;
+	}
+
+	DataType& operator[] (const KeyType key)
+	{
+		PVRTuint32 uiIndex = GetIndexOf(key);
+		if (uiIndex != m_uiSize)
+			return m_Data[uiIndex];
+
+		m_Keys.Append(key);
+		m_Data.Append(DataType());
+		++m_uiSize;
+		return m_Data[m_Keys.GetSize()-1];
+	}
+
+	bool Exists(const KeyType key) const
+	{
+		return (GetIndexOf(key) != m_uiSize);
+	}
+
+private:
+	CPVRTArray<KeyType> m_Keys;
+	CPVRTArray<DataType> m_Data;
+	PVRTuint32 m_uiSize;
+};
+
+/*!***************************************************************************
+ @Function			GenerateKeys
+ @Input				uiCount			Number of keys to generate
+ @Return			An array of distinct pseudo-random keys, to be freed with free()
+ @Description		Generates distinct 32-bit keys, spread like the FourCC and
+					hashed-name keys that the maps are used with. The top bit of
+					every key is clear, so setting it makes a key that is absent.
+*****************************************************************************/
+static PVRTuint32* GenerateKeys(const unsigned int uiCount)
+{
+	PVRTuint32* pKeys = (PVRTuint32*)malloc(uiCount * sizeof(PVRTuint32));
+	for(unsigned int i = 0; i < uiCount; ++i)
+		pKeys[i] = (i * 2654435761u) & 0x7FFFFFFF;
+	return pKeys;
+}
+
+/*!***************************************************************************
+ @Function			TimeMap
+ @Input				pKeys			Keys to insert and look up
+ @Input				uiCount			Number of keys
+ @Input				uiOperations	Number of insertions, and of lookups of present and
+									of absent keys, to time
+ @Output			dInsertNanos	Average time taken per insertion, in nanoseconds
+ @Output			dHitNanos		Average time taken to find a present key
+ @Output			dMissNanos		Average time taken to find an absent key
+ @Return			A checksum of the lookups, which keeps them from being optimized away
+ @Description		Builds maps of the keys with operator[], including the time
+					taken to free each map, then looks up present keys with
+					operator[] and absent keys with Exists().
+*****************************************************************************/
+template <typename MapType>
+static unsigned int TimeMap(const PVRTuint32 * const pKeys, const unsigned int uiCount, const unsigned int uiOperations,
+							double &dInsertNanos, double &dHitNanos, double &dMissNanos)
+{
+	const unsigned int uiBuilds = (uiOperations + uiCount - 1) / uiCount;
+	const double dNanosPerTick = 1.0e9 / CLOCKS_PER_SEC;
+	unsigned int uiChecksum = 0;
+
+	clock_t start = clock();
+	for(unsigned int b = 0; b < uiBuilds; ++b)
+	{
+		MapType Map;
+		for(unsigned int i = 0; i < uiCount; ++i)
+			Map[pKeys[i]] = i;
+		uiChecksum += Map[pKeys[b % uiCount]];
+	}
+	dInsertNanos = (clock() - start) * dNanosPerTick / ((double)uiBuilds * uiCount);
+
+	MapType Map;
+	for(unsigned int i = 0; i < uiCount; ++i)
+		Map[pKeys[i]] = i;
+
+	start = clock();
+	for(unsigned int i = 0; i < uiOperations; ++i)
+		uiChecksum += Map[pKeys[(i * 7919) % uiCount]];
+	dHitNanos = (clock() - start) * dNanosPerTick / uiOperations;
+
+	start = clock();
+	for(unsigned int i = 0; i < uiOperations; ++i)
+		uiChecksum += Map.Exists(pKeys[(i * 7919) % uiCount] | 0x80000000) ? 1 : 0;
+	dMissNanos = (clock() - start) * dNanosPerTick / uiOperations;
+
+	return uiChecksum;
+}
+
+/*!***************************************************************************
+ @Function			Measure
+ @Input				uiCount			Number of entries in the maps
+ @Input				uiOperations	Number of insertions and lookups to time
+ @Return			true if both maps returned the same lookup results
+ @Description		Prints the time per insertion, per successful lookup and per
+					failed lookup of CPVRTMap and of the linear map.
+*****************************************************************************/
+static bool Measure(const unsigned int uiCount, const unsigned int uiOperations)
+{
+	PVRTuint32* pKeys = GenerateKeys(uiCount);
+	double dLinear[3], dHashed[3];
+
+	unsigned int uiLinearSum = TimeMap< CLinearMap<PVRTuint32, unsigned int> >(pKeys, uiCount, uiOperations,
+																			   dLinear[0], dLinear[1], dLinear[2]);
+	unsigned int uiHashedSum = TimeMap< CPVRTMap<PVRTuint32, unsigned int> >(pKeys, uiCount, uiOperations,
+																			 dHashed[0], dHashed[1], dHashed[2]);
+	free(pKeys);
+
+	const char* c_pszOperations[] = { "insert", "lookup, present", "lookup, absent" };
+	for(unsigned int o = 0; o < 3; ++o)
+		printf("%8u entries  %-16s %12.1f ns %12.1f ns\n", uiCount, c_pszOperations[o], dLinear[o], dHashed[o]);
+
+	if(uiLinearSum != uiHashedSum)
+	{
+		fprintf(stderr, "MapBench: lookups of %u entries differ between the maps\n", uiCount);
+		return false;
+	}
+	return true;
+}
+
+/*!***************************************************************************
+ @Function			main
+ @Description		Measures maps of increasing size.
+*****************************************************************************/
+int main(int argc, char** argv)
+{
+	unsigned int uiOperations = 1000000;
+	bool bSuccess = true;
+
+	if(argc == 3 && strcmp(argv[1], "-n") == 0)
+	{
+		uiOperations = (unsigned int)atoi(argv[2]);
+		if(!uiOperations)
+			uiOperations = 1;
+	}
+	else if(argc != 1)
+	{
+		fprintf(stderr, "Usage: MapBench [-n operations]\n");
+		return 1;
+	}
+
+	printf("%-16s  %-16s %15s %15s\n", "size", "operation", "linear", "CPVRTMap");
+
+	const unsigned int c_uiCounts[] = { 10, 100, 10000 };
+	for(unsigned int c = 0; c < sizeof(c_uiCounts) / sizeof(c_uiCounts[0]); ++c)
+		bSuccess = Measure(c_uiCounts[c], uiOperations) && bSuccess;
+
+	return bSuccess ? 0 : 1;
+}
+
+/*****************************************************************************
+ End of file (MapBench.cpp)
+*****************************************************************************/
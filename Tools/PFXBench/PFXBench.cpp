@@ -0,0 +1,180 @@
+/******************************************************************************
+
+ @File         PFXBench.cpp
+
+ @Title        PFXBench
+
+ @Copyright    Copyright (c) 2010-2014 The Brenwill Workshop Ltd.
+
+ @Platform     ANSI compatible
+
+ @Description  Command-line tool that measures how long CPVRTPFXParser takes
+               to parse PFX files. See README.txt for usage.
+
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "PVRTPFXParser.h"
+#include "PVRTResourceFile.h"
+
+/*!***************************************************************************
+ @Function			GeneratePFX
+ @Input				uiNumEffects	Number of effects to generate
+ @Input				uiNumCodeLines	Number of lines of GLSL code in each shader
+ @Return			The text of the generated PFX script
+ @Description		Generates a valid PFX script with the specified number of
+					effects, each with its own texture, vertex shader and
+					fragment shader, in the layout of a typical effect library.
+*****************************************************************************/
+static CPVRTString GeneratePFX(const unsigned int uiNumEffects, const unsigned int uiNumCodeLines)
+{
+	CPVRTString PFX;
+
+	// CPVRTString grows only by what is appended, so reserve the whole script up front
+	PFX.reserve(1024 + uiNumEffects * (2048 + uiNumCodeLines * 160));
+
+	PFX += "[HEADER]\n"
+		   "\tVERSION\t\t01.00.00.00\n"
+		   "\tDESCRIPTION Generated effect library\n"
+		   "\tCOPYRIGHT\tThe Brenwill Workshop Ltd.\n"
+		   "[/HEADER]\n\n";
+
+	for(unsigned int i = 0; i < uiNumEffects; ++i)
+	{
+		PFX += PVRTStringFromFormattedStr(
+			"[TEXTURE]\n"
+			"\tNAME\t\tTexture%u\n"
+			"\tPATH\t\tTexture%u.pvr\n"
+			"\tMINIFICATION\tLINEAR\n"
+			"\tMAGNIFICATION\tLINEAR\n"
+			"\tMIPMAP\t\tNEAREST\n"
+			"\tWRAP_S\t\tREPEAT\n"
+			"\tWRAP_T\t\tCLAMP\n"
+			"[/TEXTURE]\n\n", i, i);
+	}
+
+	for(unsigned int i = 0; i < uiNumEffects; ++i)
+	{
+		PFX += PVRTStringFromFormattedStr(
+			"// Effect %u ------------------------------\n"
+			"[EFFECT]\n"
+			"\tNAME\t\tEffect%u\n"
+			"\t[ANNOTATION]\n"
+			"\t\tGenerated effect %u.\n"
+			"\t[/ANNOTATION]\n\n"
+			"\tUNIFORM\tu_mvpMatrix\t\tWORLDVIEWPROJECTION\n"
+			"\tUNIFORM\tu_lightPos\t\tLIGHTPOSMODEL0\n"
+			"\tUNIFORM\tu_tint\t\t\tMATERIALCOLORDIFFUSE\tvec4(1.0, 0.5, 0.25, 1.0)\n"
+			"\tUNIFORM\ts_texture\t\tTEXTURE0\n\n"
+			"\tATTRIBUTE\ta_position\t\tPOSITION\n"
+			"\tATTRIBUTE\ta_normal\t\tNORMAL\n"
+			"\tATTRIBUTE\ta_texCoord\t\tUV\n\n"
+			"\tVERTEXSHADER\tVertexShader%u\n"
+			"\tFRAGMENTSHADER\tFragmentShader%u\n"
+			"\tTEXTURE 0\t\tTexture%u\n"
+			"[/EFFECT]\n\n", i, i, i, i, i, i);
+
+		const char* c_pszShaderTypes[] = { "VERTEXSHADER", "FRAGMENTSHADER" };
+		const char* c_pszShaderNames[] = { "VertexShader", "FragmentShader" };
+		for(unsigned int s = 0; s < 2; ++s)
+		{
+			PFX += PVRTStringFromFormattedStr("[%s]\n\tNAME\t\t%s%u\n\n\t[GLSL_CODE]\n", c_pszShaderTypes[s], c_pszShaderNames[s], i);
+			PFX += "\t\tuniform mat4\tu_mvpMatrix;\t\t// Model-view-projection matrix\n"
+				   "\t\tattribute vec4\ta_position;\n\n"
+				   "\t\tvoid main(void) {\n";
+			for(unsigned int l = 0; l < uiNumCodeLines; ++l)
+				PFX += PVRTStringFromFormattedStr("\t\t\tvec4 v%u = u_mvpMatrix * (a_position + vec4(%u.0, 0.0, 0.0, 0.0));\t// Line %u\n", l, l, l);
+			PFX += "\t\t\tgl_Position = u_mvpMatrix * a_position;\n"
+				   "\t\t}\n"
+				   "\t[/GLSL_CODE]\n";
+			PFX += PVRTStringFromFormattedStr("[/%s]\n\n", c_pszShaderTypes[s]);
+		}
+	}
+
+	return PFX;
+}
+
+/*!***************************************************************************
+ @Function			Measure
+ @Input				pszScript		PFX script to parse
+ @Input				pszName			Name of the script, for the report
+ @Input				uiRepeats		Number of times to parse the script
+ @Return			true if the script parsed successfully
+ @Description		Parses the script the specified number of times and prints
+					the average time taken and string allocations per parse.
+*****************************************************************************/
+static bool Measure(const char * const pszScript, const char * const pszName, const unsigned int uiRepeats)
+{
+	SPVRTStringAllocStats stats;
+	CPVRTString::ResetAllocStats();
+	clock_t start = clock();
+	for(unsigned int r = 0; r < uiRepeats; ++r)
+	{
+		CPVRTPFXParser Parser;
+		CPVRTString Error;
+		if(Parser.ParseFromMemory(pszScript, &Error) != PVR_SUCCESS)
+		{
+			fprintf(stderr, "PFXBench: %s failed to parse: %s\n", pszName, Error.c_str());
+			return false;
+		}
+	}
+	double dMillis = 1000.0 * (double)(clock() - start) / CLOCKS_PER_SEC / uiRepeats;
+	CPVRTString::GetAllocStats(stats);
+
+	printf("%-32s %10lu bytes %10.3f ms %10lu string allocations per parse\n", pszName, (unsigned long)strlen(pszScript),
+		   dMillis, stats.nAllocations / uiRepeats);
+	return true;
+}
+
+/*!***************************************************************************
+ @Function			main
+ @Description		Measures the generated scripts, then any PFX files named on
+					the command line.
+*****************************************************************************/
+int main(int argc, char** argv)
+{
+	unsigned int uiRepeats = 10;
+	bool bSuccess = true;
+	int i = 1;
+
+	if(i + 1 < argc && strcmp(argv[i], "-n") == 0)
+	{
+		uiRepeats = (unsigned int)atoi(argv[i + 1]);
+		if(!uiRepeats)
+			uiRepeats = 1;
+		i += 2;
+	}
+
+	// Generated effect libraries of increasing size
+	const unsigned int c_uiNumEffects[] = { 10, 100, 1000 };
+	for(unsigned int e = 0; e < sizeof(c_uiNumEffects) / sizeof(c_uiNumEffects[0]); ++e)
+	{
+		CPVRTString Script = GeneratePFX(c_uiNumEffects[e], 40);
+		CPVRTString Name = PVRTStringFromFormattedStr("generated, %u effects", c_uiNumEffects[e]);
+		bSuccess = Measure(Script.c_str(), Name.c_str(), uiRepeats) && bSuccess;
+	}
+
+	// PFX files named on the command line
+	for(; i < argc; ++i)
+	{
+		CPVRTResourceFile PfxFile(argv[i]);
+		if(!PfxFile.IsOpen())
+		{
+			fprintf(stderr, "PFXBench: unable to open %s\n", argv[i]);
+			bSuccess = false;
+			continue;
+		}
+
+		CPVRTString Script((const char*)PfxFile.DataPtr(), PfxFile.Size());
+		bSuccess = Measure(Script.c_str(), argv[i], uiRepeats) && bSuccess;
+	}
+
+	return bSuccess ? 0 : 1;
+}
+
+/*****************************************************************************
+ End of file (PFXBench.cpp)
+*****************************************************************************/
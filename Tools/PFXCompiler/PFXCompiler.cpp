@@ -0,0 +1,121 @@
+/******************************************************************************
+
+ @File         PFXCompiler.cpp
+
+ @Title        PFXCompiler
+
+ @Copyright    Copyright (c) 2010-2014 The Brenwill Workshop Ltd.
+
+ @Platform     ANSI compatible
+
+ @Description  Command-line tool that compiles PFX files into binary PFX
+               files, which CC3PFXResource loads without parsing the PFX
+               script. See README.txt for usage.
+
+******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "PVRTPFXParser.h"
+#include "PVRTResourceFile.h"
+
+/*!***************************************************************************
+ @Function			BinaryFileName
+ @Input				pszFileName		Source PFX file name
+ @Return			The name of the binary file
+ @Description		Replaces the extension of the PFX file with ".pfxb",
+					which is where CC3PFXResource looks for the binary file.
+*****************************************************************************/
+static CPVRTString BinaryFileName(const char * const pszFileName)
+{
+	CPVRTString Name(pszFileName);
+	size_t nDot = Name.find_last_of('.');
+	size_t nSlash = Name.find_last_of('/');
+
+	if(nDot != CPVRTString::npos && (nSlash == CPVRTString::npos || nDot > nSlash))
+		Name = Name.substr(0, nDot);
+
+	return Name + ".pfxb";
+}
+
+/*!***************************************************************************
+ @Function			Compile
+ @Input				pszFileName		PFX file to compile
+ @Input				pszOutName		Binary file to write, or NULL for the default
+ @Return			true if successful
+ @Description		Parses a single PFX file, writes the binary file, and reads
+					it back to check that it restores the same effects.
+*****************************************************************************/
+static bool Compile(const char * const pszFileName, const char * const pszOutName)
+{
+	SPVRTPFXBinaryInfo info;
+	CPVRTPFXParser Parser, Check;
+	CPVRTString Error;
+	CPVRTString OutName(pszOutName ? CPVRTString(pszOutName) : BinaryFileName(pszFileName));
+
+	if(PVRTPFXHashFile(pszFileName, info) != PVR_SUCCESS ||
+	   Parser.ParseFromFile(pszFileName, &Error) != PVR_SUCCESS)
+	{
+		fprintf(stderr, "PFXCompiler: Could not parse %s\n%s", pszFileName, Error.c_str());
+		return false;
+	}
+
+	if(Parser.SaveBinary(OutName.c_str(), info) != PVR_SUCCESS)
+	{
+		fprintf(stderr, "PFXCompiler: Could not write %s\n", OutName.c_str());
+		return false;
+	}
+
+	if(Check.LoadBinaryFromFile(OutName.c_str(), &Error) != PVR_SUCCESS ||
+	   Check.GetNumberEffects() != Parser.GetNumberEffects() ||
+	   Check.GetNumberTextures() != Parser.GetNumberTextures() ||
+	   Check.GetNumberRenderPasses() != Parser.GetNumberRenderPasses())
+	{
+		fprintf(stderr, "PFXCompiler: %s does not restore the content of %s\n%s", OutName.c_str(), pszFileName, Error.c_str());
+		remove(OutName.c_str());
+		return false;
+	}
+
+	printf("%s -> %s (%u effects, %u textures, hash %08X)\n", pszFileName, OutName.c_str(),
+		   Parser.GetNumberEffects(), Parser.GetNumberTextures(), info.ui32SourceHash);
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	const char *pszOutName = NULL;
+	int nFiles = 0, nFailed = 0;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+			pszOutName = argv[++i];
+		else if(argv[i][0] == '-')
+			nFiles = -1, i = argc;
+		else
+			++nFiles;
+	}
+
+	if(nFiles <= 0 || (pszOutName && nFiles > 1))
+	{
+		fprintf(stderr, "Usage: PFXCompiler [-o output.pfxb] file.pfx [file.pfx ...]\n");
+		return 1;
+	}
+
+	// File names are used as given, rather than relative to a read path
+	CPVRTResourceFile::SetReadPath("");
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "-o") == 0)
+			++i;
+		else if(!Compile(argv[i], pszOutName))
+			++nFailed;
+	}
+
+	return nFailed ? 1 : 0;
+}
+
+/*****************************************************************************
+ End of file (PFXCompiler.cpp)
+*****************************************************************************/
@@ -0,0 +1,133 @@
+/******************************************************************************
+
+ @File         PODBaker.cpp
+
+ @Title        PODBaker
+
+ @Copyright    Copyright (c) 2010-2014 The Brenwill Workshop Ltd.
+
+ @Platform     ANSI compatible
+
+ @Description  Command-line tool that bakes POD files into the form in which
+               CC3PODResource draws them. See README.txt for usage.
+
+******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "PVRTModelPOD.h"
+#include "PVRTResourceFile.h"
+#include "PVRTArray.h"
+
+/*!***************************************************************************
+ @Function			BakedFileName
+ @Input				pszFileName		Source POD file name
+ @Return			The name of the baked file
+ @Description		Replaces the extension of the POD file with ".podbake",
+					which is where CC3PODResource looks for the baked file.
+*****************************************************************************/
+static CPVRTString BakedFileName(const char * const pszFileName)
+{
+	CPVRTString Name(pszFileName);
+	size_t nDot = Name.find_last_of('.');
+	size_t nSlash = Name.find_last_of('/');
+
+	if(nDot != CPVRTString::npos && (nSlash == CPVRTString::npos || nDot > nSlash))
+		Name = Name.substr(0, nDot);
+
+	return Name + ".podbake";
+}
+
+/*!***************************************************************************
+ @Function			Bake
+ @Input				pszFileName		POD file to bake
+ @Input				pszOutName		Baked file to write, or NULL for the default
+ @Input				ui32Flags		PVRTMODELPODBF_* flags
+ @Return			true if successful
+ @Description		Bakes a single POD file.
+*****************************************************************************/
+static bool Bake(const char * const pszFileName, const char * const pszOutName, const PVRTuint32 ui32Flags)
+{
+	SPODBakeInfo info;
+	CPVRTModelPOD pod;
+	CPVRTArray<float> ACMR;
+	CPVRTString OutName(pszOutName ? CPVRTString(pszOutName) : BakedFileName(pszFileName));
+
+	info.ui32Flags = ui32Flags;
+
+	if(PVRTModelPODHashFile(pszFileName, info.ui32SourceHash, info.ui32SourceSize) != PVR_SUCCESS ||
+	   pod.ReadFromFile(pszFileName) != PVR_SUCCESS)
+	{
+		fprintf(stderr, "PODBaker: Could not read %s\n", pszFileName);
+		return false;
+	}
+
+	if(ui32Flags & PVRTMODELPODBF_OPTIMIZED_VERTEX_CACHE)
+	{
+		for(unsigned int i = 0; i < pod.nNumMesh; ++i)
+			ACMR.Append(PVRTModelPODCalculateACMR(pod.pMesh[i]));
+	}
+
+	if(PVRTModelPODBake(pod, ui32Flags) != PVR_SUCCESS)
+	{
+		fprintf(stderr, "PODBaker: Could not bake %s\n", pszFileName);
+		return false;
+	}
+
+	// Report the average number of vertices transformed per triangle
+	for(unsigned int i = 0; i < ACMR.GetSize(); ++i)
+		printf("%s: mesh %u ACMR %.3f -> %.3f\n", pszFileName, i, ACMR[i], PVRTModelPODCalculateACMR(pod.pMesh[i]));
+
+	if(PVRTModelPODSaveBaked(pod, OutName.c_str(), info) != PVR_SUCCESS)
+	{
+		fprintf(stderr, "PODBaker: Could not write %s\n", OutName.c_str());
+		return false;
+	}
+
+	printf("%s -> %s (%u meshes, hash %08X)\n", pszFileName, OutName.c_str(), pod.nNumMesh, info.ui32SourceHash);
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	PVRTuint32 ui32Flags = 0;
+	const char *pszOutName = NULL;
+	int nFiles = 0, nFailed = 0;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "-flip") == 0)
+			ui32Flags |= PVRTMODELPODBF_FLIPPED_UVS;
+		else if(strcmp(argv[i], "-vcache") == 0)
+			ui32Flags |= PVRTMODELPODBF_OPTIMIZED_VERTEX_CACHE;
+		else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+			pszOutName = argv[++i];
+		else if(argv[i][0] == '-')
+			nFiles = -1, i = argc;
+		else
+			++nFiles;
+	}
+
+	if(nFiles <= 0 || (pszOutName && nFiles > 1))
+	{
+		fprintf(stderr, "Usage: PODBaker [-flip] [-vcache] [-o output.podbake] file.pod [file.pod ...]\n");
+		return 1;
+	}
+
+	// File names are used as given, rather than relative to a read path
+	CPVRTResourceFile::SetReadPath("");
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "-o") == 0)
+			++i;
+		else if(argv[i][0] != '-' && !Bake(argv[i], pszOutName, ui32Flags))
+			++nFailed;
+	}
+
+	return nFailed ? 1 : 0;
+}
+
+/*****************************************************************************
+ End of file (PODBaker.cpp)
+*****************************************************************************/
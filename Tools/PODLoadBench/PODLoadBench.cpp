@@ -0,0 +1,134 @@
+/******************************************************************************
+
+ @File         PODLoadBench.cpp
+
+ @Title        PODLoadBench
+
+ @Copyright    Copyright (c) 2010-2014 The Brenwill Workshop Ltd.
+
+ @Platform     ANSI compatible
+
+ @Description  Command-line tool that measures how long CPVRTModelPOD takes to
+               decode POD files serially and in parallel. See README.txt for
+               usage.
+
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "PVRTModelPOD.h"
+#include "PVRTResourceFile.h"
+#include "PVRTParallel.h"
+
+/*!***************************************************************************
+ @Function			WallClockSeconds
+ @Return			The current wall-clock time, in seconds
+ @Description		Returns the wall-clock time. clock() is not used, because
+					it adds together the time taken by all worker threads.
+*****************************************************************************/
+static double WallClockSeconds()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec * 1.0e-6;
+}
+
+/*!***************************************************************************
+ @Function			TimeDecode
+ @Input				pData			Content of the POD file
+ @Input				uiSize			Size of the content
+ @Input				ui32Threads		Number of decode threads; zero uses all processors
+ @Input				uiRepeats		Number of times to decode the content
+ @Output			dMillis			Average time taken per decode, in milliseconds
+ @Return			true if every decode succeeded
+ @Description		Decodes the POD content from memory the specified number of
+					times, with the specified number of decode threads.
+*****************************************************************************/
+static bool TimeDecode(const char * const pData, const size_t uiSize, const unsigned int ui32Threads,
+					   const unsigned int uiRepeats, double &dMillis)
+{
+	CPVRTModelPOD::SetDecodeThreadCount(ui32Threads);
+
+	double dStart = WallClockSeconds();
+	for(unsigned int r = 0; r < uiRepeats; ++r)
+	{
+		CPVRTModelPOD pod;
+		if(pod.ReadFromMemory(pData, uiSize) != PVR_SUCCESS)
+			return false;
+	}
+	dMillis = 1000.0 * (WallClockSeconds() - dStart) / uiRepeats;
+	return true;
+}
+
+/*!***************************************************************************
+ @Function			Measure
+ @Input				pszFileName		POD file to measure
+ @Input				uiRepeats		Number of times to decode the file
+ @Return			true if the file was read and decoded successfully
+ @Description		Reads the POD file into memory, so that file access is not
+					measured, then prints the average time taken to decode it
+					with the serial loader and with the parallel loader.
+*****************************************************************************/
+static bool Measure(const char * const pszFileName, const unsigned int uiRepeats)
+{
+	CPVRTResourceFile PodFile(pszFileName);
+	if(!PodFile.IsOpen())
+	{
+		fprintf(stderr, "PODLoadBench: unable to open %s\n", pszFileName);
+		return false;
+	}
+
+	double dSerial, dParallel;
+	if(!TimeDecode((const char*)PodFile.DataPtr(), PodFile.Size(), 1, uiRepeats, dSerial) ||
+	   !TimeDecode((const char*)PodFile.DataPtr(), PodFile.Size(), 0, uiRepeats, dParallel))
+	{
+		fprintf(stderr, "PODLoadBench: %s failed to decode\n", pszFileName);
+		return false;
+	}
+
+	printf("%-56s %10lu bytes %10.3f ms %10.3f ms %8.2fx\n", pszFileName, (unsigned long)PodFile.Size(),
+		   dSerial, dParallel, dSerial / dParallel);
+	return true;
+}
+
+/*!***************************************************************************
+ @Function			main
+ @Description		Measures each POD file named on the command line.
+*****************************************************************************/
+int main(int argc, char** argv)
+{
+	unsigned int uiRepeats = 20;
+	bool bSuccess = true;
+	int i = 1;
+
+	if(i + 1 < argc && strcmp(argv[i], "-n") == 0)
+	{
+		uiRepeats = (unsigned int)atoi(argv[i + 1]);
+		if(!uiRepeats)
+			uiRepeats = 1;
+		i += 2;
+	}
+
+	if(i >= argc)
+	{
+		fprintf(stderr, "Usage: PODLoadBench [-n repeats] file.pod [file.pod ...]\n");
+		return 1;
+	}
+
+	// File names are used as given, rather than relative to a read path
+	CPVRTResourceFile::SetReadPath("");
+
+	printf("%u threads\n", PVRTParallelThreadCount());
+	printf("%-56s %16s %13s %13s %9s\n", "file", "size", "serial", "parallel", "speedup");
+
+	for(; i < argc; ++i)
+		bSuccess = Measure(argv[i], uiRepeats) && bSuccess;
+
+	return bSuccess ? 0 : 1;
+}
+
+/*****************************************************************************
+ End of file (PODLoadBench.cpp)
+*****************************************************************************/
@@ -0,0 +1,231 @@
+/******************************************************************************
+
+ @File         TransBench.cpp
+
+ @Title        TransBench
+
+ @Copyright    Copyright (c) 2010-2014 The Brenwill Workshop Ltd.
+
+ @Platform     ANSI compatible
+
+ @Description  Command-line tool that measures the bounding box and transform
+               loops of PVRTTrans, with and without their SSE2/NEON paths.
+               See README.txt for usage.
+
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "PVRTGlobal.h"
+#include "PVRTFixedPoint.h"
+#include "PVRTMatrix.h"
+#include "PVRTTrans.h"
+
+/*!***************************************************************************
+ Defines
+*****************************************************************************/
+#define INTERLEAVED_STRIDE	32		// Position, normal and texture coordinate, as in a typical POD mesh
+
+/*!***************************************************************************
+ Structures
+*****************************************************************************/
+/*!***************************************************************************
+ @struct			SBenchData
+ @brief				The vertex content shared by all the measurements.
+*****************************************************************************/
+struct SBenchData
+{
+	unsigned int	uiNumVertices;
+	PVRTVECTOR3		*pPacked;			///< Positions, packed
+	unsigned char	*pInterleaved;		///< The same positions, interleaved with other content
+	PVRTVECTOR3		*pOut3;				///< Output of PVRTTransformArray()
+	PVRTVECTOR4		*pOut4;				///< Output of PVRTTransformVec3Array()
+	PVRTMATRIX		Matrix;
+};
+
+/*!***************************************************************************
+ @Function			CreateData
+ @Input				uiNumVertices	Number of vertices
+ @Output			data			The vertex content
+ @Description		Fills packed and interleaved arrays with the same
+					pseudo-random positions, and sets up a rotation,
+					scale and translation matrix.
+*****************************************************************************/
+static void CreateData(const unsigned int uiNumVertices, SBenchData &data)
+{
+	data.uiNumVertices = uiNumVertices;
+	data.pPacked = (PVRTVECTOR3*)malloc(uiNumVertices * sizeof(PVRTVECTOR3));
+	data.pInterleaved = (unsigned char*)calloc(uiNumVertices, INTERLEAVED_STRIDE);
+	data.pOut3 = (PVRTVECTOR3*)malloc(uiNumVertices * sizeof(PVRTVECTOR3));
+	data.pOut4 = (PVRTVECTOR4*)malloc(uiNumVertices * sizeof(PVRTVECTOR4));
+
+	unsigned int uiSeed = 0x1234567;
+	for(unsigned int i = 0; i < uiNumVertices; ++i)
+	{
+		VERTTYPE* pV = &data.pPacked[i].x;
+		for(unsigned int c = 0; c < 3; ++c)
+		{
+			uiSeed = uiSeed * 1103515245 + 12345;
+			pV[c] = f2vt((float)((uiSeed >> 8) & 0xFFFF) / 65536.0f * 200.0f - 100.0f);
+		}
+		memcpy(data.pInterleaved + i * INTERLEAVED_STRIDE, pV, sizeof(PVRTVECTOR3));
+	}
+
+	PVRTMATRIX Rotation, Scale;
+	PVRTMatrixRotationY(Rotation, f2vt(0.5f));
+	PVRTMatrixScaling(Scale, f2vt(1.5f), f2vt(0.5f), f2vt(2.0f));
+	PVRTMatrixMultiply(data.Matrix, Rotation, Scale);
+	data.Matrix.f[12] = f2vt(10.0f);
+	data.Matrix.f[13] = f2vt(-20.0f);
+	data.Matrix.f[14] = f2vt(30.0f);
+}
+
+/*!***************************************************************************
+ @Function			DestroyData
+ @Modified			data			The vertex content to free
+ @Description		Frees the vertex content.
+*****************************************************************************/
+static void DestroyData(SBenchData &data)
+{
+	free(data.pPacked);
+	free(data.pInterleaved);
+	free(data.pOut3);
+	free(data.pOut4);
+}
+
+/*!***************************************************************************
+ @Function			RunTest
+ @Input				data			The vertex content
+ @Input				nTest			Index of the loop to run
+ @Output			Box				The bounding box, for the bounding box loops
+ @Description		Runs one of the loops being measured over the vertex content.
+*****************************************************************************/
+static void RunTest(SBenchData &data, const int nTest, PVRTBOUNDINGBOX &Box)
+{
+	const int nNum = (int)data.uiNumVertices;
+	switch(nTest)
+	{
+		case 0: PVRTBoundingBoxCompute(&Box, data.pPacked, nNum); break;
+		case 1: PVRTBoundingBoxComputeInterleaved(&Box, data.pInterleaved, nNum, 0, INTERLEAVED_STRIDE); break;
+		case 2: PVRTTransformArray(data.pOut3, data.pPacked, nNum, &data.Matrix); break;
+		case 3: PVRTTransformVec3Array(data.pOut4, sizeof(PVRTVECTOR4), data.pPacked, sizeof(PVRTVECTOR3), &data.Matrix, nNum); break;
+		case 4: PVRTTransformVec3Array(data.pOut4, sizeof(PVRTVECTOR4), (const PVRTVECTOR3*)data.pInterleaved, INTERLEAVED_STRIDE, &data.Matrix, nNum); break;
+	}
+}
+
+/*!***************************************************************************
+ @Function			MaxDifference
+ @Input				pA				First array of floats
+ @Input				pB				Second array of floats
+ @Input				uiCount			Number of floats
+ @Return			The largest absolute difference between the arrays
+ @Description		Compares the output of the scalar and SSE2/NEON paths.
+*****************************************************************************/
+static float MaxDifference(const VERTTYPE * const pA, const VERTTYPE * const pB, const unsigned int uiCount)
+{
+	float fMax = 0.0f;
+	for(unsigned int i = 0; i < uiCount; ++i)
+	{
+		float fDiff = (float)fabs(vt2f(pA[i]) - vt2f(pB[i]));
+		if(fDiff > fMax)
+			fMax = fDiff;
+	}
+	return fMax;
+}
+
+/*!***************************************************************************
+ @Function			Measure
+ @Input				data			The vertex content
+ @Input				nTest			Index of the loop to measure
+ @Input				pszName			Name of the loop, for the report
+ @Input				uiRepeats		Number of times to run the loop
+ @Return			true if the scalar and SSE2/NEON paths gave the same result
+ @Description		Runs the loop the specified number of times with the scalar
+					paths and with the SSE2/NEON paths, and prints the average
+					time taken by each, and the largest difference between
+					their results.
+*****************************************************************************/
+static bool Measure(SBenchData &data, const int nTest, const char * const pszName, const unsigned int uiRepeats)
+{
+	const bool bBox = (nTest < 2);
+	const unsigned int uiOutFloats = data.uiNumVertices * ((nTest == 2) ? 3 : 4);
+	VERTTYPE* pScalarOut = (VERTTYPE*)malloc(bBox ? sizeof(PVRTBOUNDINGBOX) : uiOutFloats * sizeof(VERTTYPE));
+	PVRTBOUNDINGBOX Box;
+	const VERTTYPE* pOut = bBox ? &Box.Point[0].x : ((nTest == 2) ? &data.pOut3[0].x : &data.pOut4[0].x);
+	double dMillis[2];
+
+	for(int m = 0; m < 2; ++m)
+	{
+		PVRTTransSetSIMD(m == 1);
+
+		clock_t start = clock();
+		for(unsigned int r = 0; r < uiRepeats; ++r)
+			RunTest(data, nTest, Box);
+		dMillis[m] = 1000.0 * (double)(clock() - start) / CLOCKS_PER_SEC / uiRepeats;
+
+		// Keep the scalar result to compare with the SSE2/NEON result
+		if(m == 0)
+			memcpy(pScalarOut, pOut, bBox ? sizeof(PVRTBOUNDINGBOX) : uiOutFloats * sizeof(VERTTYPE));
+	}
+
+	float fDiff = MaxDifference(pScalarOut, pOut, bBox ? 24 : uiOutFloats);
+	free(pScalarOut);
+
+	printf("%-36s %10.3f ms %10.3f ms %8.2fx %12g\n", pszName, dMillis[0], dMillis[1], dMillis[0] / dMillis[1], fDiff);
+	return fDiff <= 1.0e-3f;
+}
+
+/*!***************************************************************************
+ @Function			main
+ @Description		Measures each loop over the same vertex content.
+*****************************************************************************/
+int main(int argc, char** argv)
+{
+	unsigned int uiNumVertices = 1000000;
+	unsigned int uiRepeats = 20;
+	bool bSuccess = true;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(i + 1 < argc && strcmp(argv[i], "-n") == 0)
+			uiRepeats = (unsigned int)atoi(argv[++i]);
+		else if(i + 1 < argc && strcmp(argv[i], "-v") == 0)
+			uiNumVertices = (unsigned int)atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Usage: TransBench [-n repeats] [-v vertices]\n");
+			return 1;
+		}
+	}
+	if(!uiRepeats)
+		uiRepeats = 1;
+	if(!uiNumVertices)
+		uiNumVertices = 1;
+
+	SBenchData data;
+	CreateData(uiNumVertices, data);
+
+	PVRTTransSetSIMD(true);
+	printf("%u vertices, SIMD paths %s\n", uiNumVertices, PVRTTransUsesSIMD() ? "available" : "not compiled in");
+	printf("%-36s %13s %13s %9s %12s\n", "loop", "scalar", "SIMD", "speedup", "difference");
+
+	const char* c_pszNames[] = {
+		"PVRTBoundingBoxCompute, packed",
+		"PVRTBoundingBoxComputeInterleaved",
+		"PVRTTransformArray, packed",
+		"PVRTTransformVec3Array, packed",
+		"PVRTTransformVec3Array, interleaved",
+	};
+	for(int t = 0; t < (int)(sizeof(c_pszNames) / sizeof(c_pszNames[0])); ++t)
+		bSuccess = Measure(data, t, c_pszNames[t], uiRepeats) && bSuccess;
+
+	DestroyData(data);
+	return bSuccess ? 0 : 1;
+}
+
+/*****************************************************************************
+ End of file (TransBench.cpp)
+*****************************************************************************/
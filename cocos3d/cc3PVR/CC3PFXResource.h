@@ -53,6 +53,8 @@
 	NSMutableDictionary* _texturesByName;
 	NSMutableDictionary* _effectsByName;
 	Class _semanticDelegateClass;
+	BOOL _shouldUseBinaryFile : 1;
+	BOOL _wasLoadedFromBinaryFile : 1;
 }
 
 /** Returns the PFX effect with the specified name, or nil if it doesn't exist. */
@@ -82,6 +84,31 @@
  */
 @property(nonatomic, retain) Class semanticDelegateClass;
 
+/**
+ * Indicates whether the loadFromFile: method should load a binary version of the PFX file,
+ * if one is available.
+ *
+ * A binary PFX file is produced offline from a PFX file by the PFXCompiler command-line tool,
+ * and has the same name as the PFX file, with a pfxb file extension. It contains the textures,
+ * shaders, effects and render passes parsed from the PFX file, and is loaded without parsing
+ * the PFX script again.
+ *
+ * The binary file identifies the PFX file it was produced from by the hash of the PFX file
+ * content. If the PFX file has changed since the binary file was produced, the binary file is
+ * ignored, and the PFX file is parsed instead.
+ *
+ * The initial value of this property is YES. This property must be set before the loadFromFile:
+ * method is invoked.
+ */
+@property(nonatomic, assign) BOOL shouldUseBinaryFile;
+
+/**
+ * Indicates whether the content of this resource was loaded from a binary version of the PFX file.
+ *
+ * See the shouldUseBinaryFile property for more info about binary PFX files.
+ */
+@property(nonatomic, readonly) BOOL wasLoadedFromBinaryFile;
+
 /**
  * The default class used to instantiate the semantic delegate for the GLSL programs created
  * for the PFX effects defined in instances of this class. The value of this property determines
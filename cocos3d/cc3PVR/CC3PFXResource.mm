@@ -45,6 +45,7 @@ extern "C" {
 @implementation CC3PFXResource
 
 @synthesize semanticDelegateClass=_semanticDelegateClass;
+@synthesize shouldUseBinaryFile=_shouldUseBinaryFile, wasLoadedFromBinaryFile=_wasLoadedFromBinaryFile;
 
 -(void) dealloc {
 	[_texturesByName release];
@@ -92,6 +93,8 @@ extern "C" {
 		_effectsByName = [NSMutableDictionary new];		// retained
 		_texturesByName = [NSMutableDictionary new];	// retained
 		_semanticDelegateClass = [self.class.defaultSemanticDelegateClass retain];		// retained
+		_shouldUseBinaryFile = YES;
+		_wasLoadedFromBinaryFile = NO;
 	}
 	return self;
 }
@@ -110,7 +113,8 @@ extern "C" {
 
 	CPVRTString	error;
 	CPVRTPFXParser* pfxParser = new CPVRTPFXParser();
-	BOOL wasLoaded = (pfxParser->ParseFromFile(fileName.UTF8String, &error) == PVR_SUCCESS);
+	BOOL wasLoaded = ([self loadBinaryFileFor: fileName into: &pfxParser] ||
+					  pfxParser->ParseFromFile(fileName.UTF8String, &error) == PVR_SUCCESS);
 	if (wasLoaded)
 		[self buildFromPFXParser: pfxParser];
 	else
@@ -122,6 +126,40 @@ extern "C" {
 	return wasLoaded;
 }
 
+/**
+ * If a binary file exists for the specified PFX file, and was produced from the current content
+ * of the PFX file, loads the binary file into the specified parser, instead of parsing the PFX file.
+ * Returns whether the binary file was loaded. If it was not, the parser is replaced with a new
+ * empty parser, ready to parse the PFX file.
+ */
+-(BOOL) loadBinaryFileFor: (NSString*) fileName into: (CPVRTPFXParser**) pPFXParser {
+	if ( !_shouldUseBinaryFile ) return NO;
+
+	NSString* binaryName = [fileName.stringByDeletingPathExtension stringByAppendingPathExtension: @"pfxb"];
+	SPVRTPFXBinaryInfo binaryInfo, pfxInfo;
+	if (PVRTPFXReadBinaryInfo(binaryName.UTF8String, binaryInfo) != PVR_SUCCESS) return NO;
+
+	if (PVRTPFXHashFile(fileName.UTF8String, pfxInfo) != PVR_SUCCESS ||
+		pfxInfo.ui32SourceHash != binaryInfo.ui32SourceHash || pfxInfo.ui32SourceSize != binaryInfo.ui32SourceSize) {
+		LogRez(@"%@ ignoring binary file %@ because it was not produced from the current content of %@",
+			   self, binaryName, fileName);
+		return NO;
+	}
+
+	CPVRTString error;
+	if ((*pPFXParser)->LoadBinaryFromFile(binaryName.UTF8String, &error) != PVR_SUCCESS) {
+		LogRez(@"%@ ignoring binary file %@ because %@", self, binaryName,
+			   [NSString stringWithUTF8String: error.c_str()]);
+		delete *pPFXParser;
+		*pPFXParser = new CPVRTPFXParser();
+		return NO;
+	}
+
+	LogRez(@"%@ loaded binary file %@", self, binaryName);
+	_wasLoadedFromBinaryFile = YES;
+	return YES;
+}
+
 /** Build this instance from the contents of the resource. */
 -(void) buildFromPFXParser: (CPVRTPFXParser*) pfxParser  {
 	[self buildTexturesFromPFXParser: pfxParser];
@@ -40,7 +40,12 @@
 
 -(id) initAtIndex: (GLint) aPODIndex fromPODResource: (CC3PODResource*) aPODRez {
 	if ( (self = [super initAtIndex: aPODIndex fromPODResource: aPODRez]) ) {
-		SPODMesh* psm = (SPODMesh*)[aPODRez meshPODStructAtIndex: aPODIndex];
+		// The vertex arrays take over ownership of the vertex data below, and will free it when
+		// no longer needed. The content is retrieved already decoded, if it was loaded lazily,
+		// and copied out of the memory-mapped POD file, since the mapping is released along
+		// with the CPVRTModelPOD.
+		SPODMesh* psm = (SPODMesh*)[aPODRez meshContentPODStructAtIndex: aPODIndex];
+		CC3Assert(psm, @"%@ could not load the content of mesh %i from %@", [self class], aPODIndex, aPODRez);
 		LogRez(@"Creating %@ at index %i from: %@", [self class], aPODIndex, NSStringFromSPODMesh(psm));
 		
 		self.vertexLocations = [CC3VertexLocations arrayFromCPODData: &psm->sVertex fromSPODMesh: psm];
@@ -54,7 +59,8 @@
 		for (GLuint i = 0; i < psm->nNumUVW; i++) {
 			CC3VertexTextureCoordinates* texCoords;
 			texCoords = [CC3VertexTextureCoordinates arrayFromSPODMesh: psm forTextureUnit: i];
-			texCoords.expectsVerticallyFlippedTextures = aPODRez.expectsVerticallyFlippedTextures;
+			texCoords.expectsVerticallyFlippedTextures = XOR(aPODRez.expectsVerticallyFlippedTextures,
+															 aPODRez.hasFlippedBakedTextureCoordinates);
 			[self addTextureCoordinates: texCoords];
 		}
 		
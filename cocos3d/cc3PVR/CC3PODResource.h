@@ -97,6 +97,12 @@
 	GLuint _animationFrameCount;
 	GLfloat _animationFrameRate;
 	BOOL _shouldAutoBuild : 1;
+	BOOL _shouldLoadMeshesLazily : 1;
+	BOOL _shouldUseBakedFile : 1;
+	BOOL _wasLoadedFromBakedFile : 1;
+	BOOL _hasFlippedBakedTextureCoordinates : 1;
+	BOOL _shouldOptimizeVertexCache : 1;
+	BOOL _hasOptimizedBakedVertexCache : 1;
 }
 
 /**
@@ -206,6 +212,92 @@
  */
 @property(nonatomic, assign) BOOL shouldAutoBuild;
 
+/**
+ * Indicates whether the vertex and face content of each mesh should be decoded from the POD file
+ * only when the corresponding CC3Mesh is first built, instead of when the file is loaded.
+ *
+ * When this property is set to YES, loading the file only indexes the location of each mesh within
+ * the file, and each mesh is decoded and built the first time it is retrieved using the meshAtIndex:
+ * method. Building the nodes retrieves every mesh that is used by a mesh node, so when the nodes are
+ * built, only the meshes that are not used by any node are skipped. This is useful when a POD file
+ * contains meshes that no node uses, or when the shouldAutoBuild property is set to NO, and only
+ * selected meshes are retrieved from the file.
+ *
+ * When lazy loading is active, the meshes property contains an NSNull placeholder for each mesh
+ * that has not been built, so that each mesh remains at its index within the POD file. Once the
+ * POD file content has been released after building, the meshAtIndex: method returns nil for
+ * such a mesh.
+ *
+ * The initial value of this property is NO. Like the shouldAutoBuild property, this property must
+ * be set before the loadFromFile: method is invoked.
+ */
+@property(nonatomic, assign) BOOL shouldLoadMeshesLazily;
+
+/**
+ * Indicates whether the loadFromFile: method should load a baked version of the POD file,
+ * if one is available.
+ *
+ * A baked file is produced offline from a POD file by the PODBaker command-line tool, and has
+ * the same name as the POD file, with a podbake file extension. It contains the same content as
+ * the POD file, but with the vertex content of each mesh already interleaved into the form used
+ * by the GL engine, and aligned so that it can be used directly from a memory-mapping of the file,
+ * avoiding per-vertex processing during loading. The texture coordinates may also be pre-flipped,
+ * to avoid having to flip them when upside-down textures are attached to the meshes.
+ *
+ * The baked file identifies the POD file it was produced from by the hash of the POD file content.
+ * If the POD file has changed since the baked file was produced, the baked file is ignored, and
+ * the POD file is loaded instead.
+ *
+ * The initial value of this property is YES. Like the shouldAutoBuild property, this property must
+ * be set before the loadFromFile: method is invoked.
+ */
+@property(nonatomic, assign) BOOL shouldUseBakedFile;
+
+/**
+ * Indicates whether the content of this resource was loaded from a baked version of the POD file.
+ *
+ * See the shouldUseBakedFile property for more info about baked files.
+ */
+@property(nonatomic, readonly) BOOL wasLoadedFromBakedFile;
+
+/**
+ * Indicates whether the texture coordinates of the meshes were flipped vertically when the
+ * baked file was produced.
+ *
+ * If this property is YES, the expectsVerticallyFlippedTextures property of each mesh is the
+ * inverse of the value of the expectsVerticallyFlippedTextures property of this resource.
+ *
+ * This property always returns NO if the wasLoadedFromBakedFile property returns NO.
+ */
+@property(nonatomic, readonly) BOOL hasFlippedBakedTextureCoordinates;
+
+/**
+ * Indicates whether the triangles of each mesh should be reordered, as the mesh is loaded, so that
+ * the GPU reuses more of the vertices it has already transformed.
+ *
+ * When this property is set to YES, the triangles of each mesh that is made of indexed triangles
+ * are reordered for the post-transform vertex cache of the GPU, and the vertices are then reordered
+ * into the order in which the triangles first use them. The drawn geometry is unchanged, but fewer
+ * vertices are transformed per triangle. The average number of vertices transformed per triangle
+ * (ACMR) of each mesh, before and after optimization, is logged. Meshes made of triangle strips,
+ * and meshes of a baked file whose vertex cache was optimized by the PODBaker tool, are left as is.
+ *
+ * Since the optimization takes time proportional to the size of each mesh, it is better to optimize
+ * large meshes offline, using the -vcache option of the PODBaker tool.
+ *
+ * The initial value of this property is NO. Like the shouldAutoBuild property, this property must
+ * be set before the loadFromFile: method is invoked.
+ */
+@property(nonatomic, assign) BOOL shouldOptimizeVertexCache;
+
+/**
+ * Indicates whether the triangles of the meshes were reordered for the vertex cache when the
+ * baked file was produced.
+ *
+ * This property always returns NO if the wasLoadedFromBakedFile property returns NO.
+ */
+@property(nonatomic, readonly) BOOL hasOptimizedBakedVertexCache;
+
 /**
  * Template method that extracts and builds all components. This is automatically invoked from
  * the loadFromFile: method if the POD file was successfully loaded, and the shouldAutoBuild
@@ -415,11 +507,31 @@
  * Returns meshIndex'th SPODMesh structure from the data structures.
  * Note that meshIndex is an ordinal number indicating the rank of the mesh.
  *
+ * If the shouldLoadMeshesLazily property is set to YES, the vertex and face content of the
+ * returned structure may not yet have been loaded. Use the meshContentPODStructAtIndex:
+ * method to access that content.
+ *
  * The returned pointer must be cast to SPODMesh before accessing any internals of
  * the data structure.
  */
 -(PODStructPtr) meshPODStructAtIndex: (uint) meshIndex;
 
+/**
+ * Returns meshIndex'th SPODMesh structure from the data structures, after ensuring that the vertex
+ * and face content of the mesh has been loaded from the POD file, and copied out of the POD file
+ * memory mapping, so that ownership of the content can be transferred to the vertex arrays of a mesh.
+ * Note that meshIndex is an ordinal number indicating the rank of the mesh.
+ *
+ * If the shouldOptimizeVertexCache property is set to YES, the content is also reordered for the
+ * vertex cache of the GPU.
+ *
+ * Returns NULL if the content could not be loaded.
+ *
+ * The returned pointer must be cast to SPODMesh before accessing any internals of
+ * the data structure.
+ */
+-(PODStructPtr) meshContentPODStructAtIndex: (uint) meshIndex;
+
 
 #pragma mark Accessing light data and building light nodes
 
@@ -49,7 +49,11 @@ extern "C" {
 
 @synthesize pvrtModel=_pvrtModel, allNodes=_allNodes, meshes=_meshes;
 @synthesize materials=_materials, textures=_textures, textureParameters=_textureParameters;
-@synthesize shouldAutoBuild = _shouldAutoBuild;
+@synthesize shouldAutoBuild = _shouldAutoBuild, shouldLoadMeshesLazily = _shouldLoadMeshesLazily;
+@synthesize shouldUseBakedFile = _shouldUseBakedFile, wasLoadedFromBakedFile = _wasLoadedFromBakedFile;
+@synthesize hasFlippedBakedTextureCoordinates = _hasFlippedBakedTextureCoordinates;
+@synthesize shouldOptimizeVertexCache = _shouldOptimizeVertexCache;
+@synthesize hasOptimizedBakedVertexCache = _hasOptimizedBakedVertexCache;
 @synthesize ambientLight=_ambientLight, backgroundColor=_backgroundColor;
 @synthesize animationFrameCount=_animationFrameCount, animationFrameRate=_animationFrameRate;
 
@@ -85,6 +89,12 @@ extern "C" {
 		_textures = [NSMutableArray new];		// retain
 		_textureParameters = [CC3Texture defaultTextureParameters];
 		_shouldAutoBuild = YES;
+		_shouldLoadMeshesLazily = NO;
+		_shouldUseBakedFile = YES;
+		_wasLoadedFromBakedFile = NO;
+		_hasFlippedBakedTextureCoordinates = NO;
+		_shouldOptimizeVertexCache = NO;
+		_hasOptimizedBakedVertexCache = NO;
 	}
 	return self;
 }
@@ -99,14 +109,47 @@ extern "C" {
 
 	CPVRTResourceFile::SetReadPath([dirName stringByAppendingString: @"/"].UTF8String);
 	
+	// Map the file into memory instead of reading it into a buffer. Mesh data that can be used
+	// in place is not copied until a CC3Mesh takes ownership of it during building. When loading
+	// lazily, mesh content is not even decoded until the CC3Mesh is built. An up-to-date baked
+	// version of the file is preferred, since its mesh data needs no further processing.
 	[self createCPVRTModelPOD];
-	BOOL wasLoaded = (self.pvrtModelImpl->ReadFromFile(fileName.UTF8String) == PVR_SUCCESS);
+	BOOL wasLoaded = ([self loadBakedFileFor: fileName] ||
+					  self.pvrtModelImpl->ReadFromMappedFile(fileName.UTF8String,
+															 _shouldLoadMeshesLazily) == PVR_SUCCESS);
 	
 	if (wasLoaded && _shouldAutoBuild) [self build];
 	
 	return wasLoaded;
 }
 
+/**
+ * If a baked file exists for the specified POD file, and was produced from the current content of
+ * the POD file, loads the baked file instead. Returns whether the baked file was loaded.
+ */
+-(BOOL) loadBakedFileFor: (NSString*) fileName {
+	if ( !_shouldUseBakedFile ) return NO;
+
+	NSString* bakedName = [fileName.stringByDeletingPathExtension stringByAppendingPathExtension: @"podbake"];
+	SPODBakeInfo bakeInfo, podInfo;
+	if (PVRTModelPODReadBakeInfo(bakedName.UTF8String, bakeInfo) != PVR_SUCCESS) return NO;
+
+	if (PVRTModelPODHashFile(fileName.UTF8String, podInfo.ui32SourceHash, podInfo.ui32SourceSize) != PVR_SUCCESS ||
+		podInfo.ui32SourceHash != bakeInfo.ui32SourceHash || podInfo.ui32SourceSize != bakeInfo.ui32SourceSize) {
+		LogRez(@"%@ ignoring baked file %@ because it was not produced from the current content of %@",
+			   self, bakedName, fileName);
+		return NO;
+	}
+
+	if (self.pvrtModelImpl->ReadFromMappedFile(bakedName.UTF8String, _shouldLoadMeshesLazily) != PVR_SUCCESS) return NO;
+
+	LogRez(@"%@ loaded baked file %@", self, bakedName);
+	_wasLoadedFromBakedFile = YES;
+	_hasFlippedBakedTextureCoordinates = ((bakeInfo.ui32Flags & PVRTMODELPODBF_FLIPPED_UVS) != 0);
+	_hasOptimizedBakedVertexCache = ((bakeInfo.ui32Flags & PVRTMODELPODBF_OPTIMIZED_VERTEX_CACHE) != 0);
+	return YES;
+}
+
 
 #pragma mark Building
 
@@ -386,13 +429,23 @@ extern "C" {
 
 -(GLuint) meshCount { return _pvrtModel ? self.pvrtModelImpl->nNumMesh : 0; }
 
-// Build the array containing all materials in the PVRT structure
+// Build the array containing all meshes in the PVRT structure. If loading lazily,
+// each mesh is represented by a placeholder until it is first accessed.
 -(void) buildMeshes {
 	GLuint mCount = self.meshCount;
-	for (GLuint i = 0; i < mCount; i++) [_meshes addObject: [self buildMeshAtIndex: i]];
+	for (GLuint i = 0; i < mCount; i++)
+		[_meshes addObject: (_shouldLoadMeshesLazily ? [NSNull null] : [self buildMeshAtIndex: i])];
 }
 
--(CC3Mesh*) meshAtIndex: (GLuint) meshIndex { return (CC3Mesh*)[_meshes objectAtIndex: meshIndex]; }
+-(CC3Mesh*) meshAtIndex: (GLuint) meshIndex {
+	id mesh = [_meshes objectAtIndex: meshIndex];
+	if (mesh == [NSNull null]) {
+		if ( !_pvrtModel ) return nil;		// Never built, and the POD content has been released
+		mesh = [self buildMeshAtIndex: meshIndex];
+		[_meshes replaceObjectAtIndex: meshIndex withObject: mesh];
+	}
+	return (CC3Mesh*)mesh;
+}
 
 // Deprecated method.
 -(CC3Mesh*) meshModelAtIndex: (GLuint) meshIndex { return [self meshAtIndex: meshIndex]; }
@@ -403,6 +456,31 @@ extern "C" {
 
 -(PODStructPtr) meshPODStructAtIndex: (GLuint) meshIndex { return &self.pvrtModelImpl->pMesh[meshIndex]; }
 
+-(PODStructPtr) meshContentPODStructAtIndex: (GLuint) meshIndex {
+	CPVRTModelPOD* pod = self.pvrtModelImpl;
+	if (pod->LoadMeshData(meshIndex) != PVR_SUCCESS || pod->UnmapMeshData(meshIndex) != PVR_SUCCESS) return NULL;
+	SPODMesh* psm = &pod->pMesh[meshIndex];
+	if (_shouldOptimizeVertexCache && !_hasOptimizedBakedVertexCache) [self optimizeVertexCacheOf: psm atIndex: meshIndex];
+	return psm;
+}
+
+/**
+ * Reorders the triangles and vertices of the specified mesh for the vertex cache of the GPU,
+ * and logs the average number of vertices transformed per triangle before and after.
+ * Meshes that are not made of indexed triangles are left as is.
+ */
+-(void) optimizeVertexCacheOf: (SPODMesh*) psm atIndex: (GLuint) meshIndex {
+	if (psm->nNumStrips || !psm->sFaces.pData) return;
+
+	GLfloat acmrBefore = PVRTModelPODCalculateACMR(*psm);
+	if (PVRTModelPODOptimizeVertexCache(*psm) != PVR_SUCCESS) {
+		LogRez(@"%@ could not optimize the vertex cache of mesh %u", self, meshIndex);
+		return;
+	}
+	LogRez(@"%@ optimized the vertex cache of mesh %u from ACMR %.3f to %.3f",
+		   self, meshIndex, acmrBefore, PVRTModelPODCalculateACMR(*psm));
+}
+
 
 #pragma mark Accessing light data and building light nodes
 
@@ -51,6 +51,10 @@
  * than the receiver of that method.
  */
 @interface CC3PVRTexture : CC3Texture {
+	NSData* _mipmapStreamingData;
+	GLuint _mipmapCount;
+	GLuint _residentMipmapLevel;
+	GLuint _targetMipmapLevel;
 	BOOL _isTextureCube : 1;
 }
 
@@ -66,6 +70,155 @@
  */
 @property(nonatomic, assign) BOOL shouldFlipHorizontallyOnLoad;
 
+
+#pragma mark Mipmap streaming
+
+/**
+ * Returns whether this texture is streaming its mipmap levels from its PVR file.
+ *
+ * A streaming texture keeps its PVR file content mapped into memory, so that it can bring
+ * in more detailed mipmap levels over a number of frames, and drop its most detailed
+ * mipmap levels when memory is short. See the class-side shouldStreamMipmaps property.
+ */
+@property(nonatomic, readonly) BOOL isStreamingMipmaps;
+
+/**
+ * The number of mipmap levels in the PVR file from which this texture was loaded.
+ *
+ * Returns zero if this texture is not streaming its mipmap levels.
+ */
+@property(nonatomic, readonly) GLuint mipmapCount;
+
+/**
+ * The level, within the PVR file, of the most detailed mipmap level that is currently
+ * loaded into the GL engine. Level zero is the full-size image.
+ *
+ * The size property always indicates the size of this mipmap level.
+ *
+ * Always returns zero if this texture is not streaming its mipmap levels.
+ */
+@property(nonatomic, readonly) GLuint residentMipmapLevel;
+
+/**
+ * The most detailed mipmap level, within the PVR file, that this texture should stream in.
+ *
+ * While the value of the residentMipmapLevel property is larger than the value of this
+ * property, the streamMipmaps method will load more detailed mipmap levels, one level at
+ * a time. Setting this property to a value larger than the residentMipmapLevel property
+ * does not unload any levels. Use the dropTopMipmapLevels: method for that.
+ *
+ * The initial value of this property is zero, indicating that the full-size image should
+ * be streamed in.
+ */
+@property(nonatomic, assign) GLuint targetMipmapLevel;
+
+/**
+ * Returns the number of bytes of PVR file content that will be loaded into the GL engine
+ * by the next invocation of the streamNextMipmapLevel method, or zero if this texture has
+ * already streamed in its targetMipmapLevel.
+ *
+ * Because OpenGL ES 2.0 requires all mipmap levels of a texture to be specified together,
+ * bringing in a mipmap level reloads all of the smaller levels as well.
+ */
+@property(nonatomic, readonly) GLuint nextMipmapLevelByteCount;
+
+/**
+ * If this texture has not yet streamed in its targetMipmapLevel, loads the next more
+ * detailed mipmap level into the GL engine, and returns YES. Otherwise, does nothing
+ * and returns NO.
+ *
+ * This method must be invoked while the GL context is active. Normally, you will not
+ * invoke this method directly, and will instead let the class-side streamMipmaps method
+ * stream the mipmaps of all textures within a per-frame budget.
+ */
+-(BOOL) streamNextMipmapLevel;
+
+/**
+ * Unloads the specified number of the most detailed mipmap levels of this texture from
+ * the GL engine, to reduce the memory used by the texture, and sets the targetMipmapLevel
+ * property so that the dropped levels will not be streamed back in. To allow the dropped
+ * levels to be streamed back in later, reduce the value of the targetMipmapLevel property.
+ *
+ * The smallest mipmap level in the file is never dropped. This method does nothing if
+ * this texture is not streaming its mipmap levels, and must be invoked while the GL
+ * context is active.
+ */
+-(void) dropTopMipmapLevels: (GLuint) levelCount;
+
+/**
+ * Returns whether PVR textures should stream their mipmap levels.
+ *
+ * See the setShouldStreamMipmaps: method for more information.
+ */
++(BOOL) shouldStreamMipmaps;
+
+/**
+ * Sets whether PVR textures loaded from files containing mipmaps should stream their
+ * mipmap levels.
+ *
+ * When a streaming texture is loaded, only its smaller mipmap levels, up to the size given
+ * by the class-side mipmapStreamingInitialSize property, are loaded into the GL engine.
+ * The more detailed levels are then brought in over the following frames by the class-side
+ * streamMipmaps method, within a per-frame budget defined by the class-side
+ * mipmapStreamingBytesPerFrame property. This reduces the stall when loading large scenes,
+ * and allows textures to drop their most detailed levels when memory is short.
+ *
+ * Mipmap streaming requires OpenGL ES 2.0, and is not used for PVR files that require
+ * byte-swapping. The initial value of this property is NO.
+ */
++(void) setShouldStreamMipmaps: (BOOL) shouldStream;
+
+/**
+ * Returns the maximum width and height of the most detailed mipmap level that is loaded
+ * when a streaming texture is first loaded.
+ *
+ * The initial value of this property is 64.
+ */
++(GLuint) mipmapStreamingInitialSize;
+
+/**
+ * Sets the maximum width and height of the most detailed mipmap level that is loaded
+ * when a streaming texture is first loaded.
+ *
+ * The initial value of this property is 64.
+ */
++(void) setMipmapStreamingInitialSize: (GLuint) initialSize;
+
+/**
+ * Returns the number of bytes of PVR file content that the streamMipmaps method may load
+ * into the GL engine each time it is invoked.
+ *
+ * The initial value of this property is one megabyte.
+ */
++(GLuint) mipmapStreamingBytesPerFrame;
+
+/**
+ * Sets the number of bytes of PVR file content that the streamMipmaps method may load
+ * into the GL engine each time it is invoked.
+ *
+ * The initial value of this property is one megabyte.
+ */
++(void) setMipmapStreamingBytesPerFrame: (GLuint) byteCount;
+
+/**
+ * Streams the next mipmap level of streaming textures into the GL engine, one level at a
+ * time and smallest textures first, until the budget of the mipmapStreamingBytesPerFrame
+ * property is used up, or no more levels are needed. Returns the number of bytes loaded.
+ *
+ * At least one level is loaded whenever one is needed, even if it is larger than the budget.
+ *
+ * This method is invoked automatically by CC3Scene on each frame, before the scene is
+ * drawn, and must be invoked while the GL context is active.
+ */
++(GLuint) streamMipmaps;
+
+/**
+ * Invokes the dropTopMipmapLevels: method on all streaming textures.
+ *
+ * You can invoke this method when the app receives a memory warning.
+ */
++(void) dropTopMipmapLevelsOfStreamingTextures: (GLuint) levelCount;
+
 @end
 
 
@@ -78,6 +231,8 @@
  */
 @interface CC3PVRTextureContent : NSObject {
 	GLuint _textureID;
+	GLuint _mipmapCount;
+	GLuint _mipmapLevel;
 	CC3IntSize _size;
 	GLenum _pixelFormat;
 	GLenum _pixelType;
@@ -92,6 +247,16 @@
 /** The size of this texture in pixels. */
 @property(nonatomic, readonly) CC3IntSize size;
 
+/** The number of mipmap levels in the PVR content. */
+@property(nonatomic, readonly) GLuint mipmapCount;
+
+/**
+ * The level, within the PVR content, of the mipmap level that was loaded as the base level
+ * of the texture. This is zero unless the initFromData:fromMipmapLevel:intoTexture: method
+ * was used to skip the most detailed levels.
+ */
+@property(nonatomic, readonly) GLuint mipmapLevel;
+
 /**
  * Returns the pixel format of the texture.
  *
@@ -136,4 +301,15 @@
  */
 -(id) initFromFile: (NSString*) filePath;
 
+/**
+ * Initializes this instance by loading the mipmap levels of the specified PVR file content,
+ * starting at the specified mipmap level, which becomes the base level of the GL texture.
+ *
+ * If the specified texture ID is not zero, the levels are loaded into that existing GL
+ * texture, replacing its content. Otherwise, a new GL texture is created.
+ *
+ * Returns nil if the content could not be loaded, or if it must be byte-swapped.
+ */
+-(id) initFromData: (NSData*) data fromMipmapLevel: (GLuint) mipmapLevel intoTexture: (GLuint) textureID;
+
 @end
@@ -39,10 +39,56 @@
 
 @interface CC3Texture (TemplateMethods)
 -(void) deleteGLTexture;
+-(void) checkGLDebugLabel;
+-(void) markTextureParametersDirty;
+-(BOOL) loadFromFile: (NSString*) filePath;
+-(void) bindTextureContent: (id) texContent toTarget: (GLenum) target;
 @end
 
+#if CC3_OGLES_2
+/**
+ * Reads the header of the specified PVR file content into the specified V3 header,
+ * converting a legacy header if needed. Returns false if the content is too short,
+ * or if it must be byte-swapped, which only the PVR file loader does.
+ */
+static bool CC3GetPVRTextureHeader(NSData* data, PVRTextureHeaderV3& header) {
+	if (data.length < PVRTEX3_HEADERSIZE) return false;
+
+	PVRTuint32 ident = *(const PVRTuint32*)data.bytes;
+	if (ident == PVRTEX3_IDENT) {
+		header = *(const PVRTextureHeaderV3*)data.bytes;
+		return true;
+	}
+	if (ident == PVRTEX3_IDENT_REV || !PVRTIsLittleEndian()) return false;
+
+	PVRTConvertOldTextureHeaderToV3((const PVR_Texture_Header*)data.bytes, header, NULL);
+	return true;
+}
+
+/**
+ * Returns the number of bytes of texture data, for all faces, in the mipmap levels of the
+ * specified PVR file content, starting at the specified level and ending at the smallest.
+ */
+static GLuint CC3PVRTextureByteCount(NSData* data, GLuint mipmapLevel) {
+	PVRTextureHeaderV3 header;
+	if ( !CC3GetPVRTextureHeader(data, header) ) return 0;
+
+	GLuint byteCount = 0;
+	for (GLuint mipLevel = mipmapLevel; mipLevel < header.u32MIPMapCount; mipLevel++)
+		byteCount += PVRTGetTextureDataSize(header, mipLevel, false, true);
+	return byteCount;
+}
+#endif	// CC3_OGLES_2
+
 @implementation CC3PVRTexture
 
+-(void) dealloc {
+	if (_mipmapStreamingData) [self.class removeStreamingTexture: self];
+	[_mipmapStreamingData release];
+
+	[super dealloc];
+}
+
 -(BOOL) shouldFlipVerticallyOnLoad { return NO; }
 -(void) setShouldFlipVerticallyOnLoad: (BOOL) shouldFlipVerticallyOnLoad {}
 
@@ -87,6 +133,17 @@
 								: [CC3Texture2D class].defaultTextureParameters;
 }
 
+/**
+ * When mipmap streaming is active, attempts to stream the texture, and falls back to loading
+ * the entire file if the file content cannot be streamed.
+ */
+-(BOOL) loadFromFile: (NSString*) filePath {
+#if CC3_OGLES_2
+	if (self.class.shouldStreamMipmaps && [self loadStreamingFromFile: filePath]) return YES;
+#endif	// CC3_OGLES_2
+	return [super loadFromFile: filePath];
+}
+
 /** Replacing pixels not supported in compressed PVR textures. */
 -(void) replacePixels: (CC3Viewport) rect
 			 inTarget: (GLenum) target
@@ -108,6 +165,190 @@
 		[visitor increment2DTextureUnit];
 }
 
+
+#pragma mark Mipmap streaming
+
+@synthesize mipmapCount=_mipmapCount, residentMipmapLevel=_residentMipmapLevel;
+@synthesize targetMipmapLevel=_targetMipmapLevel;
+
+-(BOOL) isStreamingMipmaps { return (_mipmapStreamingData != nil); }
+
+-(void) setTargetMipmapLevel: (GLuint) mipmapLevel {
+	_targetMipmapLevel = MIN(mipmapLevel, (_mipmapCount ? _mipmapCount - 1 : 0));
+}
+
+/** Returns whether a more detailed mipmap level should be streamed in. */
+-(BOOL) needsNextMipmapLevel { return self.isStreamingMipmaps && (_residentMipmapLevel > _targetMipmapLevel); }
+
+-(GLuint) nextMipmapLevelByteCount {
+#if CC3_OGLES_2
+	if (self.needsNextMipmapLevel) return CC3PVRTextureByteCount(_mipmapStreamingData, _residentMipmapLevel - 1);
+#endif	// CC3_OGLES_2
+	return 0;
+}
+
+-(BOOL) streamNextMipmapLevel {
+	if ( !self.needsNextMipmapLevel ) return NO;
+
+	// If the level cannot be loaded, stop trying to stream it in
+	if ( ![self loadMipmapLevel: _residentMipmapLevel - 1] ) {
+		_targetMipmapLevel = _residentMipmapLevel;
+		return NO;
+	}
+	return YES;
+}
+
+-(void) dropTopMipmapLevels: (GLuint) levelCount {
+	if ( !self.isStreamingMipmaps ) return;
+
+	GLuint mipLevel = MIN(_residentMipmapLevel + levelCount, _mipmapCount - 1);
+	_targetMipmapLevel = MAX(_targetMipmapLevel, mipLevel);
+	if (mipLevel > _residentMipmapLevel) [self loadMipmapLevel: mipLevel];
+}
+
+/**
+ * Reloads the GL texture from the mipmap levels of the retained PVR file content, starting
+ * at the specified level. OpenGL ES 2.0 cannot change the base level of a texture, so all of
+ * the smaller levels are reloaded along with the new base level.
+ */
+-(BOOL) loadMipmapLevel: (GLuint) mipmapLevel {
+#if CC3_OGLES_2
+	MarkRezActivityStart();
+
+	// The PVR loader binds the texture and sets the unpacking alignment directly,
+	// so set them through the GL state cache first, to keep it in step.
+	CC3OpenGL* gl = CC3OpenGL.sharedGL;
+	[gl bindTexture: _textureID toTarget: self.textureTarget at: 0];
+	[gl setPixelUnpackingAlignment: 1];
+
+	CC3PVRTextureContent* content = [[CC3PVRTextureContent alloc] initFromData: _mipmapStreamingData
+																fromMipmapLevel: mipmapLevel
+																	intoTexture: _textureID];
+	if ( !content ) {
+		LogError(@"%@ could not load mipmap level %u", self, mipmapLevel);
+		return NO;
+	}
+
+	_residentMipmapLevel = content.mipmapLevel;
+	_size = content.size;
+	_hasMipmap = content.hasMipmap;
+	[content release];
+
+	[self markTextureParametersDirty];		// The PVR loader replaced the texture parameters
+
+	LogRez(@"%@ loaded mipmap level %u (%@) in %.3f ms", self, _residentMipmapLevel,
+		   NSStringFromCC3IntSize(_size), GetRezActivityDuration() * 1000);
+	return YES;
+#else
+	return NO;
+#endif	// CC3_OGLES_2
+}
+
+#if CC3_OGLES_2
+/**
+ * Maps the specified PVR file into memory, loads its smallest mipmap levels up to the size
+ * indicated by the class-side mipmapStreamingInitialSize property, and registers this texture
+ * to have the remaining levels streamed in. Returns NO, without logging an error, if the file
+ * does not contain mipmaps or cannot be streamed, so that it can be loaded normally.
+ */
+-(BOOL) loadStreamingFromFile: (NSString*) filePath {
+	NSString* absFilePath = CC3ResolveResourceFilePath(filePath);
+	if ( !absFilePath ) return NO;
+
+	NSData* data = [NSData dataWithContentsOfFile: absFilePath options: NSDataReadingMappedIfSafe error: NULL];
+	PVRTextureHeaderV3 pvrHeader;
+	if ( !(data && CC3GetPVRTextureHeader(data, pvrHeader) && pvrHeader.u32MIPMapCount > 1) ) return NO;
+
+	if (!_name) self.name = [self.class textureNameFromFilePath: filePath];
+
+	MarkRezActivityStart();
+
+	// Start with the most detailed mipmap level that fits within the initial size
+	GLuint mipCount = pvrHeader.u32MIPMapCount;
+	GLuint maxDim = MAX(pvrHeader.u32Width, pvrHeader.u32Height);
+	GLuint mipLevel = 0;
+	while (mipLevel < mipCount - 1 && (maxDim >> mipLevel) > _mipmapStreamingInitialSize) mipLevel++;
+
+	CC3PVRTextureContent* content = [[CC3PVRTextureContent alloc] initFromData: data
+																fromMipmapLevel: mipLevel
+																	intoTexture: 0];
+	if ( !content ) return NO;
+
+	[self bindTextureContent: content toTarget: self.textureTarget];
+	[content release];
+
+	if ( !_mipmapStreamingData ) [self.class addStreamingTexture: self];
+	[_mipmapStreamingData release];
+	_mipmapStreamingData = [data retain];
+	_mipmapCount = mipCount;
+	_residentMipmapLevel = mipLevel;
+	_targetMipmapLevel = 0;
+
+	[self checkGLDebugLabel];
+
+	LogRez(@"%@ loaded mipmap level %u of %u from file %@ in %.3f ms", self, mipLevel, mipCount,
+		   filePath, GetRezActivityDuration() * 1000);
+	return YES;
+}
+#endif	// CC3_OGLES_2
+
+static BOOL _shouldStreamMipmaps = NO;
+static GLuint _mipmapStreamingInitialSize = 64;
+static GLuint _mipmapStreamingBytesPerFrame = (1 << 20);
+static NSMutableArray* _streamingTextures = nil;
+
++(BOOL) shouldStreamMipmaps { return _shouldStreamMipmaps; }
+
++(void) setShouldStreamMipmaps: (BOOL) shouldStream { _shouldStreamMipmaps = shouldStream; }
+
++(GLuint) mipmapStreamingInitialSize { return _mipmapStreamingInitialSize; }
+
++(void) setMipmapStreamingInitialSize: (GLuint) initialSize { _mipmapStreamingInitialSize = initialSize; }
+
++(GLuint) mipmapStreamingBytesPerFrame { return _mipmapStreamingBytesPerFrame; }
+
++(void) setMipmapStreamingBytesPerFrame: (GLuint) byteCount { _mipmapStreamingBytesPerFrame = byteCount; }
+
+/** Adds the specified texture to the weakly-held collection of streaming textures. */
++(void) addStreamingTexture: (CC3PVRTexture*) texture {
+	if ( !_streamingTextures ) _streamingTextures = [NSMutableArray new];	// retained
+	[_streamingTextures addObject: [texture asWeakReference]];
+}
+
+/** Removes the specified texture from the collection of streaming textures. */
++(void) removeStreamingTexture: (CC3PVRTexture*) texture {
+	[_streamingTextures removeObject: [texture asWeakReference]];
+}
+
++(GLuint) streamMipmaps {
+	GLuint bytesLoaded = 0;
+	while (YES) {
+		// Find the texture whose next mipmap level is the smallest
+		CC3PVRTexture* nextTex = nil;
+		GLuint nextByteCount = 0;
+		for (NSValue* texRef in _streamingTextures) {
+			CC3PVRTexture* tex = [texRef resolveWeakReference];
+			GLuint texByteCount = tex.nextMipmapLevelByteCount;
+			if (texByteCount && (!nextTex || texByteCount < nextByteCount)) {
+				nextTex = tex;
+				nextByteCount = texByteCount;
+			}
+		}
+
+		// Stop when done, or when the budget is used up, but always load at least one level
+		if ( !nextTex ) break;
+		if (bytesLoaded && (bytesLoaded + nextByteCount > _mipmapStreamingBytesPerFrame)) break;
+
+		if ( [nextTex streamNextMipmapLevel] ) bytesLoaded += nextByteCount;
+	}
+	return bytesLoaded;
+}
+
++(void) dropTopMipmapLevelsOfStreamingTextures: (GLuint) levelCount {
+	for (NSValue* texRef in _streamingTextures)
+		[(CC3PVRTexture*)[texRef resolveWeakReference] dropTopMipmapLevels: levelCount];
+}
+
 @end
 
 
@@ -117,6 +358,7 @@
 @implementation CC3PVRTextureContent
 
 @synthesize textureID=_textureID, size=_size, isTextureCube=_isTextureCube;
+@synthesize mipmapCount=_mipmapCount, mipmapLevel=_mipmapLevel;
 @synthesize pixelFormat=_pixelFormat, pixelType=_pixelType;
 @synthesize hasMipmap=_hasMipmap, hasPremultipliedAlpha=_hasPremultipliedAlpha;
 
@@ -125,6 +367,18 @@
 
 #pragma mark Allocation and Initialization
 
+/** Populates this instance from the specified PVR header, allowing for any skipped mipmap levels. */
+-(void) populateFromPVRHeader: (PVRTextureHeaderV3*) pvrHeader {
+	_size = CC3IntSizeMake(MAX(pvrHeader->u32Width >> _mipmapLevel, 1),
+						   MAX(pvrHeader->u32Height >> _mipmapLevel, 1));
+	_mipmapCount = pvrHeader->u32MIPMapCount;
+	_hasMipmap = (_mipmapCount - _mipmapLevel > 1);
+	_isTextureCube = (pvrHeader->u32NumFaces > 1);
+	_hasPremultipliedAlpha = ((pvrHeader->u32Flags & PVRTEX3_PREMULTIPLIED) != 0);
+	_pixelFormat = GL_ZERO;		// Unknown - could query from GL if needed
+	_pixelType = GL_ZERO;		// Unknown - could query from GL if needed
+}
+
 #if CC3_IOS
 
 -(id) initFromFile: (NSString*) filePath {
@@ -150,12 +404,7 @@
 			[self release];
 			return nil;
 		}
-		_size = CC3IntSizeMake(pvrHeader.u32Width, pvrHeader.u32Height);
-		_hasMipmap = (pvrHeader.u32MIPMapCount > 1);
-		_isTextureCube = (pvrHeader.u32NumFaces > 1);
-		_hasPremultipliedAlpha = ((pvrHeader.u32Flags & PVRTEX3_PREMULTIPLIED) != 0);
-		_pixelFormat = GL_ZERO;		// Unknown - could query from GL if needed
-		_pixelType = GL_ZERO;		// Unknown - could query from GL if needed
+		[self populateFromPVRHeader: &pvrHeader];
 	}
 	return self;
 }
@@ -169,4 +418,37 @@
 
 #endif	// CC3_IOS
 
+#if CC3_OGLES_2
+
+-(id) initFromData: (NSData*) data fromMipmapLevel: (GLuint) mipmapLevel intoTexture: (GLuint) textureID {
+	if ( (self = [super init]) ) {
+		PVRTextureHeaderV3 pvrHeader;
+		if ( !CC3GetPVRTextureHeader(data, pvrHeader) ) {
+			[self release];
+			return nil;
+		}
+		_mipmapLevel = MIN(mipmapLevel, pvrHeader.u32MIPMapCount - 1);
+		_textureID = textureID;
+		BOOL wasLoaded = PVRTTextureLoadFromPointer(data.bytes, &_textureID, &pvrHeader,
+													true, _mipmapLevel, NULL, NULL, true) == PVR_SUCCESS;
+		if ( !wasLoaded ) {
+			LogError(@"Could not load PVR texture content from mipmap level %u.", _mipmapLevel);
+			[self release];
+			return nil;
+		}
+		[self populateFromPVRHeader: &pvrHeader];
+	}
+	return self;
+}
+
+#else
+
+-(id) initFromData: (NSData*) data fromMipmapLevel: (GLuint) mipmapLevel intoTexture: (GLuint) textureID {
+	LogError(@"Could not load PVR texture content because mipmap streaming requires OpenGL ES 2.0.");
+	[self release];
+	return nil;
+}
+
+#endif	// CC3_OGLES_2
+
 @end
@@ -334,6 +334,8 @@ void PVRTTextureTile(
  @Modified		pMetaData			If a valid map is supplied, this will return any and all 
 									MetaDataBlocks stored in the texture, organised by DevFourCC
 									then identifier. Supplying NULL will ignore all MetaData.
+ @Input			bReuseTexName		If true and texName is not zero, load into that texture
+									instead of generating a new one.
  @Return		PVR_SUCCESS on success
  @Description	Allows textures to be stored in C header files and loaded in. Can load parts of a
 				mip mapped texture (i.e. skipping the highest detailed levels). In OpenGL Cube Map, each
@@ -348,7 +350,8 @@ EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
 										bool bAllowDecompress,
 										const unsigned int nLoadFromLevel,
 										const void * const texPtr,
-										CPVRTMap<unsigned int, CPVRTMap<unsigned int, MetaDataBlock> > *pMetaData)
+										CPVRTMap<unsigned int, CPVRTMap<unsigned int, MetaDataBlock> > *pMetaData,
+										const bool bReuseTexName)
 {
 	//Compression bools
 	bool bIsCompressedFormatSupported=false;
@@ -517,9 +520,10 @@ EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
 						return PVR_FAIL;
 					}
 
-					//Get the dimensions for the current MIP level.
-					PVRTuint32 uiMIPWidth = sTextureHeaderDecomp.u32Width>>nLoadFromLevel;
-					PVRTuint32 uiMIPHeight = sTextureHeaderDecomp.u32Height>>nLoadFromLevel;
+					//Get the dimensions of the top MIP level. Levels before nLoadFromLevel are stepped
+					//over, so each level is decompressed to the offset the upload below reads it from.
+					PVRTuint32 uiMIPWidth = sTextureHeaderDecomp.u32Width;
+					PVRTuint32 uiMIPHeight = sTextureHeaderDecomp.u32Height;
 
 					//Setup temporary variables.
 					PVRTuint8* pTempDecompData = (PVRTuint8*)pDecompressedData;
@@ -531,14 +535,15 @@ EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
 						for (PVRTuint32 uiFace=0;uiFace<sTextureHeader.u32NumFaces;++uiFace)
 						{
 
-							for (PVRTuint32 uiMIPMap=nLoadFromLevel;uiMIPMap<sTextureHeader.u32MIPMapCount;++uiMIPMap)
+							for (PVRTuint32 uiMIPMap=0;uiMIPMap<sTextureHeader.u32MIPMapCount;++uiMIPMap)
 							{
 								//Get the face offset. Varies per MIP level.
 								PVRTuint32 decompressedFaceOffset = PVRTGetTextureDataSize(sTextureHeaderDecomp, uiMIPMap, false, false);
 								PVRTuint32 compressedFaceOffset = PVRTGetTextureDataSize(sTextureHeader, uiMIPMap, false, false);
 
 								//Decompress the texture data.
-								PVRTDecompressPVRTC(pTempCompData,bIs2bppPVRTC?1:0,uiMIPWidth,uiMIPHeight,pTempDecompData);
+								if (uiMIPMap>=nLoadFromLevel)
+									PVRTDecompressPVRTC(pTempCompData,bIs2bppPVRTC?1:0,uiMIPWidth,uiMIPHeight,pTempDecompData);
 
 								//Move forward through the pointers.
 								pTempDecompData+=decompressedFaceOffset;
@@ -557,7 +562,7 @@ EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
 					else
 					{
 						//Decompress all the MIP levels.
-						for (PVRTuint32 uiMIPMap=nLoadFromLevel;uiMIPMap<sTextureHeader.u32MIPMapCount;++uiMIPMap)
+						for (PVRTuint32 uiMIPMap=0;uiMIPMap<sTextureHeader.u32MIPMapCount;++uiMIPMap)
 						{
 							//Get the face offset. Varies per MIP level.
 							PVRTuint32 decompressedFaceOffset = PVRTGetTextureDataSize(sTextureHeaderDecomp, uiMIPMap, false, false);
@@ -566,7 +571,8 @@ EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
 							for (PVRTuint32 uiFace=0;uiFace<sTextureHeader.u32NumFaces;++uiFace)
 							{
 								//Decompress the texture data.
-								PVRTDecompressPVRTC(pTempCompData,bIs2bppPVRTC?1:0,uiMIPWidth,uiMIPHeight,pTempDecompData);
+								if (uiMIPMap>=nLoadFromLevel)
+									PVRTDecompressPVRTC(pTempCompData,bIs2bppPVRTC?1:0,uiMIPWidth,uiMIPHeight,pTempDecompData);
 
 								//Move forward through the pointers.
 								pTempDecompData+=decompressedFaceOffset;
@@ -637,9 +643,10 @@ EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
 						return PVR_FAIL;
 					}
 
-					//Get the dimensions for the current MIP level.
-					PVRTuint32 uiMIPWidth = sTextureHeaderDecomp.u32Width>>nLoadFromLevel;
-					PVRTuint32 uiMIPHeight = sTextureHeaderDecomp.u32Height>>nLoadFromLevel;
+					//Get the dimensions of the top MIP level. Levels before nLoadFromLevel are stepped
+					//over, so each level is decompressed to the offset the upload below reads it from.
+					PVRTuint32 uiMIPWidth = sTextureHeaderDecomp.u32Width;
+					PVRTuint32 uiMIPHeight = sTextureHeaderDecomp.u32Height;
 
 					//Setup temporary variables.
 					PVRTuint8* pTempDecompData = (PVRTuint8*)pDecompressedData;
@@ -651,14 +658,15 @@ EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
 						for (PVRTuint32 uiFace=0;uiFace<sTextureHeader.u32NumFaces;++uiFace)
 						{
 
-							for (PVRTuint32 uiMIPMap=nLoadFromLevel;uiMIPMap<sTextureHeader.u32MIPMapCount;++uiMIPMap)
+							for (PVRTuint32 uiMIPMap=0;uiMIPMap<sTextureHeader.u32MIPMapCount;++uiMIPMap)
 							{
 								//Get the face offset. Varies per MIP level.
 								PVRTuint32 decompressedFaceOffset = PVRTGetTextureDataSize(sTextureHeaderDecomp, uiMIPMap, false, false);
 								PVRTuint32 compressedFaceOffset = PVRTGetTextureDataSize(sTextureHeader, uiMIPMap, false, false);
 
 								//Decompress the texture data.
-								PVRTDecompressETC(pTempCompData,uiMIPWidth,uiMIPHeight,pTempDecompData,0);
+								if (uiMIPMap>=nLoadFromLevel)
+									PVRTDecompressETC(pTempCompData,uiMIPWidth,uiMIPHeight,pTempDecompData,0);
 
 								//Move forward through the pointers.
 								pTempDecompData+=decompressedFaceOffset;
@@ -677,7 +685,7 @@ EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
 					else
 					{
 						//Decompress all the MIP levels.
-						for (PVRTuint32 uiMIPMap=nLoadFromLevel;uiMIPMap<sTextureHeader.u32MIPMapCount;++uiMIPMap)
+						for (PVRTuint32 uiMIPMap=0;uiMIPMap<sTextureHeader.u32MIPMapCount;++uiMIPMap)
 						{
 							//Get the face offset. Varies per MIP level.
 							PVRTuint32 decompressedFaceOffset = PVRTGetTextureDataSize(sTextureHeaderDecomp, uiMIPMap, false, false);
@@ -686,7 +694,8 @@ EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
 							for (PVRTuint32 uiFace=0;uiFace<sTextureHeader.u32NumFaces;++uiFace)
 							{
 								//Decompress the texture data.
-								PVRTDecompressETC(pTempCompData,uiMIPWidth,uiMIPHeight,pTempDecompData,0);
+								if (uiMIPMap>=nLoadFromLevel)
+									PVRTDecompressETC(pTempCompData,uiMIPWidth,uiMIPHeight,pTempDecompData,0);
 
 								//Move forward through the pointers.
 								pTempDecompData+=decompressedFaceOffset;
@@ -752,8 +761,11 @@ EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
 	//PVR files are never row aligned.
 	glPixelStorei(GL_UNPACK_ALIGNMENT,1);
 
-	//Generate a texture
-	glGenTextures(1, texName);
+	//Generate a texture, unless the levels are being reloaded into an existing one.
+	if (!bReuseTexName || !*texName)
+	{
+		glGenTextures(1, texName);
+	}
 
 	//Initialise a texture target.
 	GLint eTarget=GL_TEXTURE_2D;
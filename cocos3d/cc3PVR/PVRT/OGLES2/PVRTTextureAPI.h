@@ -37,6 +37,9 @@ class CPVRTMap;
  @param[in,out]	pMetaData			If a valid map is supplied, this will return any and all 
 									MetaDataBlocks stored in the texture, organised by DevFourCC
 									then identifier. Supplying NULL will ignore all MetaData.
+ @param[in]		bReuseTexName		If true and texName is not zero, the texture is loaded into
+									the existing texture, replacing all of its levels, instead of
+									a new one. Used to stream mipmap levels in and out.
  @return		PVR_SUCCESS on success
 *****************************************************************************/
 EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
@@ -45,7 +48,8 @@ EPVRTError PVRTTextureLoadFromPointer(	const void* pointer,
 										bool bAllowDecompress = true,
 										const unsigned int nLoadFromLevel=0,
 										const void * const texPtr=0,
-										CPVRTMap<unsigned int, CPVRTMap<unsigned int, struct MetaDataBlock> > *pMetaData=NULL);
+										CPVRTMap<unsigned int, CPVRTMap<unsigned int, struct MetaDataBlock> > *pMetaData=NULL,
+										const bool bReuseTexName=false);
 
 /*!***************************************************************************
  @brief      	Allows textures to be stored in binary PVR files and loaded in. Can load parts of a
@@ -24,7 +24,8 @@
 //#include "PVRTContext.h"					// patched for Cocos3D by Bill Hollings
 
 #include <vector>
-#include <list>
+#include <queue>
+#include <algorithm>
 
 #include "PVRTMatrix.h"
 #include "PVRTVertex.h"
@@ -33,6 +34,7 @@
 /****************************************************************************
 ** Defines
 ****************************************************************************/
+#define PVRTBONEBATCH_MAX_TRI_BONES	12		/*!< Most bones a triangle can reference: 3 vertices of 4 bones */
 
 /****************************************************************************
 ** Macros
@@ -42,242 +44,313 @@
 ** Structures
 ****************************************************************************/
 /*!***************************************************************************
-@Class CBatch
-@Brief Class to contain and manage batch information.
+@Class CBoneMasks
+@Brief Class that holds a set of batches as bitsets of the bones they reference.
 *****************************************************************************/
-class CBatch
+class CBoneMasks
 {
 protected:
-	int	m_nCapacity, 		// Maximum size of the batch
-	m_nCnt, 				// Number of elements currently contained in the batch
-	*m_pnPalette;			// Array of palette indices
+	int							m_nWords;			// Number of 64 bit words per mask
+	int							m_nCapacity;		// Maximum number of bones in a batch
+	std::vector<PVRTuint64>		m_Mask;				// Bone mask of each batch
+	std::vector<int>			m_Cnt;				// Number of bones in each batch, or -1 if merged away
 
 public:
 /*!***************************************************************************
- @Function		CBatch
- @Description	The default constructor
+ @Function		CBoneMasks
+ @Input			nBoneCnt		Number of bones in the mesh
+ @Input			nCapacity		Maximum number of bones in a batch
+ @Description	Constructor
 *****************************************************************************/
-	CBatch() : 	m_nCapacity(0),
-				m_nCnt(0),
-				m_pnPalette(0)
+	CBoneMasks(const int nBoneCnt, const int nCapacity) :
+		m_nWords((nBoneCnt + 63) / 64),
+		m_nCapacity(nCapacity)
 	{
 	}
 
 /*!***************************************************************************
- @Function		CBatch
- @Input			src				CBatch to copy
- @Description	Copy constructor
+ @Function		size
+ @Return		int				The number of batches, including merged ones
+ @Description	Returns the number of batches, including merged ones.
 *****************************************************************************/
-	CBatch(const CBatch &src) : m_pnPalette(0)
+	int size() const
 	{
-		SetSize(src.m_nCapacity);
-		*this = src;
+		return (int)m_Cnt.size();
 	}
-	
+
 /*!***************************************************************************
- @Function		~CBatch
- @Description	Destructor
+ @Function		Count
+ @Input			nBatch			The batch
+ @Return		int				The number of bones in the batch, or -1
+ @Description	Returns the number of bones in a batch, or -1 if the batch
+				has been merged into another.
 *****************************************************************************/
-	~CBatch()
+	int Count(const int nBatch) const
 	{
-		FREE(m_pnPalette);
+		return m_Cnt[nBatch];
 	}
-	
+
 /*!***************************************************************************
- @Function		operator=
- @Description	Operator overload for the '=' operand
+ @Function		Capacity
+ @Return		int				The maximum number of bones in a batch
+ @Description	Returns the maximum number of bones in a batch.
 *****************************************************************************/
-	CBatch& operator= (const CBatch &src)
+	int Capacity() const
 	{
-		_ASSERT(m_nCapacity == src.m_nCapacity);
-		m_nCnt = src.m_nCnt;
-		memcpy(m_pnPalette, src.m_pnPalette, m_nCnt * sizeof(*m_pnPalette));
-		return *this;
+		return m_nCapacity;
 	}
-	
+
 /*!***************************************************************************
- @Function		SetSize
- @Input			nSize			The new size of the batch
- @Description	Delete all current information and resizes the batch 
-				to the value that has been passed in.
+ @Function		LiveCount
+ @Return		int				The number of batches not merged away
+ @Description	Returns the number of batches that have not been merged
+				into others.
 *****************************************************************************/
-	void SetSize(const int nSize)
+	int LiveCount() const
 	{
-		FREE(m_pnPalette);
+		int i, nCnt = 0;
 
-		m_nCapacity	= nSize;
-		m_nCnt		= 0;
-		m_pnPalette		= (int*)malloc(m_nCapacity * sizeof(*m_pnPalette));
+		for(i = 0; i < size(); ++i)
+			if(m_Cnt[i] >= 0)
+				++nCnt;
+
+		return nCnt;
 	}
-	
+
 /*!***************************************************************************
- @Function		Clear
- @Description	Resets the count
+ @Function		Add
+ @Input			pnBones			The bones of the new batch
+ @Input			nCnt			The number of bones
+ @Return		int				The index of the new batch
+ @Description	Adds a batch referencing the specified distinct bones.
 *****************************************************************************/
-	void Clear()
+	int Add(const int * const pnBones, const int nCnt)
 	{
-		m_nCnt = 0;
+		int i;
+
+		m_Mask.resize(m_Mask.size() + m_nWords, 0);
+		m_Cnt.push_back(nCnt);
+
+		for(i = 0; i < nCnt; ++i)
+			m_Mask[m_Mask.size() - m_nWords + (pnBones[i] >> 6)] |= (PVRTuint64)1 << (pnBones[i] & 63);
+
+		return size() - 1;
 	}
 
 /*!***************************************************************************
- @Function		Clear
- @Input			n			The index of the new item
- Return			bool		Returns true if the item already exists or has been added.
- @Description	Adds a new item to the batch, providing it has not already
-				been added to the batch and the count doesn't exceed the
-				maximum number of bones the batch can hold.
+ @Function		Set
+ @Input			nBatch			The batch
+ @Input			pnBones			The new bones of the batch
+ @Input			nCnt			The number of bones
+ @Description	Replaces the bones of a batch with the specified distinct bones.
 *****************************************************************************/
-	bool Add(const int n)
+	void Set(const int nBatch, const int * const pnBones, const int nCnt)
 	{
 		int i;
 
-		if(n < 0)
-			return false;
+		for(i = 0; i < m_nWords; ++i)
+			m_Mask[nBatch * m_nWords + i] = 0;
 
-		// If we already have this item, do nothing
-		for(i = 0; i < m_nCnt; ++i)
-		{
-			if(m_pnPalette[i] == n)
-				return true;
-		}
+		for(i = 0; i < nCnt; ++i)
+			m_Mask[nBatch * m_nWords + (pnBones[i] >> 6)] |= (PVRTuint64)1 << (pnBones[i] & 63);
 
-		// Add the new item
-		if(m_nCnt < m_nCapacity)
-		{
-			m_pnPalette[m_nCnt] = n;
-			++m_nCnt;
-			return true;
-		}
-		else
-		{
-			return false;
-		}
+		m_Cnt[nBatch] = nCnt;
 	}
 
 /*!***************************************************************************
- @Function		Merge
- @Input			src				The batch to merge with
- @Description	Merges the input batch with the current batch.
+ @Function		IsContainedIn
+ @Input			nBatch			The batch
+ @Input			pnBones			Distinct bones
+ @Input			nCnt			The number of bones
+ @Return		bool			Returns true if all the bones of the batch are
+								among the specified bones
+ @Description	Returns true if the batch is a subset of the specified bones.
 *****************************************************************************/
-	void Merge(const CBatch &src)
+	bool IsContainedIn(const int nBatch, const int * const pnBones, const int nCnt) const
 	{
-		int i;
+		int i, nFound = 0;
+
+		if(m_Cnt[nBatch] > nCnt)
+			return false;
+
+		for(i = 0; i < nCnt; ++i)
+			if(Contains(nBatch, pnBones[i]))
+				++nFound;
 
-		for(i = 0; i < src.m_nCnt; ++i)
-			Add(src.m_pnPalette[i]);
+		return nFound == m_Cnt[nBatch];
 	}
 
 /*!***************************************************************************
- @Function		TestMerge
- @Input			src				The batch to merge with
- @Return		int				The number of items that are not already
-								present in the batch. -1 if the merge will
-								exceed the capacity of the batch
- @Description	Tests how many of the items of the input batch are not
-				already contained in the batch. This returns the number of
-				items that would need to be added, or -1 if the number
-				of additional items would exceed the capacity of the batch.
+ @Function		Contains
+ @Input			nBatch			The batch
+ @Input			nBone			The bone
+ @Return		bool			Returns true if the batch contains the bone
+ @Description	Returns true if the batch contains the bone.
 *****************************************************************************/
-	int TestMerge(const CBatch &src)
+	bool Contains(const int nBatch, const int nBone) const
 	{
-		int i, nCnt;
-
-		nCnt = 0;
-		for(i = 0; i < src.m_nCnt; ++i)
-			if(!Contains(src.m_pnPalette[i]))
-				++nCnt;
-
-		return m_nCnt+nCnt > m_nCapacity ? -1 : nCnt;
+		return (m_Mask[nBatch * m_nWords + (nBone >> 6)] >> (nBone & 63)) & 1;
 	}
 
 /*!***************************************************************************
  @Function		Contains
- @Input			src				The batch to compare
- @Return		bool			Returns true if the batch and the input batch
-								have at least one item in common
- @Description	Returns true if the batch's have at least one item in common
+ @Input			nBatch			The batch
+ @Input			pnBones			The bones
+ @Input			nCnt			The number of bones
+ @Return		bool			Returns true if the batch contains all the bones
+ @Description	Returns true if the batch contains all the bones.
 *****************************************************************************/
-	bool Contains(const CBatch &batch) const
+	bool Contains(const int nBatch, const int * const pnBones, const int nCnt) const
 	{
 		int i;
 
-		for(i = 0; i < batch.m_nCnt; ++i)
-			if(!Contains(batch.m_pnPalette[i]))
+		for(i = 0; i < nCnt; ++i)
+			if(!Contains(nBatch, pnBones[i]))
 				return false;
 
 		return true;
 	}
-	
+
 /*!***************************************************************************
- @Function		Contains
- @Input			n				The index of the new item
- @Return		bool			Returns true if the batch contains the item
- @Description	Returns true if the batch contains the item.
+ @Function		Shared
+ @Input			nBatch			A batch
+ @Input			nBatch2			Another batch
+ @Return		int				The number of bones the batches share
+ @Description	Counts the bones that are in both batches.
 *****************************************************************************/
-	bool Contains(const int n) const
+	int Shared(const int nBatch, const int nBatch2) const
 	{
-		int i;
+		const PVRTuint64 *pMask = &m_Mask[nBatch * m_nWords], *pMask2 = &m_Mask[nBatch2 * m_nWords];
+		int i, nCnt = 0;
+
+		for(i = 0; i < m_nWords; ++i)
+			nCnt += PopCount(pMask[i] & pMask2[i]);
 
-		for(i = 0; i < m_nCnt; ++i)
-			if(m_pnPalette[i] == n)
-				return true;
+		return nCnt;
+	}
 
-		return false;
+/*!***************************************************************************
+ @Function		TestMerge
+ @Input			nBatch			The batch to merge into
+ @Input			nBatch2			The batch to merge
+ @Return		int				The number of bones of nBatch2 that are
+								not already in nBatch. -1 if the merge would
+								exceed the capacity of a batch
+ @Description	Tests how many bones merging a batch into another would add.
+*****************************************************************************/
+	int TestMerge(const int nBatch, const int nBatch2) const
+	{
+		const int nCnt = m_Cnt[nBatch2] - Shared(nBatch, nBatch2);
+		return m_Cnt[nBatch] + nCnt > m_nCapacity ? -1 : nCnt;
 	}
-	
+
+/*!***************************************************************************
+ @Function		Merge
+ @Input			nBatch			The batch to merge into
+ @Input			nBatch2			The batch to merge, which is then marked
+								as merged away
+ @Description	Merges a batch into another.
+*****************************************************************************/
+	void Merge(const int nBatch, const int nBatch2)
+	{
+		PVRTuint64 *pMask = &m_Mask[nBatch * m_nWords];
+		const PVRTuint64 *pMask2 = &m_Mask[nBatch2 * m_nWords];
+		int i, nCnt = 0;
+
+		for(i = 0; i < m_nWords; ++i)
+		{
+			pMask[i] |= pMask2[i];
+			nCnt += PopCount(pMask[i]);
+		}
+
+		_ASSERT(nCnt <= m_nCapacity);
+		m_Cnt[nBatch] = nCnt;
+		m_Cnt[nBatch2] = -1;
+	}
+
 /*!***************************************************************************
  @Function		Write
- @Output		pn				The array of items to overwrite
- @Output		pnCnt			The number of items in the array
- @Description	Writes the array of items and the number of items to the output
-				parameters.
+ @Input			nBatch			The batch
+ @Output		pn				The bones of the batch, in ascending order
+ @Output		pnCnt			The number of bones
+ @Description	Writes the bones of a batch to the output parameters.
 *****************************************************************************/
 	void Write(
+		const int nBatch,
 		int * const pn,
 		int * const pnCnt) const
 	{
-		memcpy(pn, m_pnPalette, m_nCnt * sizeof(*pn));
-		*pnCnt = m_nCnt;
+		const PVRTuint64 *pMask = &m_Mask[nBatch * m_nWords];
+		int i, j;
+
+		*pnCnt = 0;
+		for(i = 0; i < m_nWords; ++i)
+			for(j = 0; j < 64; ++j)
+				if((pMask[i] >> j) & 1)
+					pn[(*pnCnt)++] = i * 64 + j;
 	}
 
 /*!***************************************************************************
- @Function		GetVertexBoneIndices
- @Modified		pfI				Returned index
- @Input			pfW				Weight?
- @Input			n				Length of index array
- @Description	For each element of the input array, the index value is compared
-				with the palette's index value. If the values are equal, the
-				value of the current input array element is replaced with the
-				palette index, otherwise the value is set to zero.
+ @Function		PopCount
+ @Input			ui64				Bits to count
+ @Return		int					The number of set bits
+ @Description	Counts the set bits of a word.
 *****************************************************************************/
-	void GetVertexBoneIndices(
-		float		* const pfI,
-		const float	* const pfW,
-		const int	n)
+	static int PopCount(PVRTuint64 ui64)
 	{
-		int i, j;
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_popcountll(ui64);
+#else
+		ui64 = ui64 - ((ui64 >> 1) & 0x5555555555555555ULL);
+		ui64 = (ui64 & 0x3333333333333333ULL) + ((ui64 >> 2) & 0x3333333333333333ULL);
+		ui64 = (ui64 + (ui64 >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return (int)((ui64 * 0x0101010101010101ULL) >> 56);
+#endif
+	}
+};
 
-		for(i = 0; i < n; ++i)
-		{
-			if(pfW[i] != 0)
-			{
-				for(j = 0; j < m_nCnt; ++j)
-				{
-					if(pfI[i] != m_pnPalette[j])
-						continue;
+/*!***************************************************************************
+@Struct SBatchMerge
+@Brief A candidate merge of two batches that share bones, queued by
+       CPVRTBoneBatches::Create when minimizing batches.
+*****************************************************************************/
+struct SBatchMerge
+{
+	int				nShared;	// Number of bones the batches share
+	int				nUnion;		// Number of bones in the merged batch
+	int				nBatch, nBatch2;
+	unsigned int	ui32Ver, ui32Ver2;	// Versions of the batches the merge was scored against
 
-					pfI[i] = (float)j;
-					break;
-				}
+/*!***************************************************************************
+ @Function		operator<
+ @Input			rhs				Merge to compare with
+ @Return		bool			True if rhs is the better merge
+ @Description	Orders merges so that the one sharing the most bones, then
+				the one giving the smallest batch, is at the top of the
+				queue. Ties go to the lowest batch indices, for a
+				deterministic result.
+*****************************************************************************/
+	bool operator<(const SBatchMerge &rhs) const
+	{
+		if(nShared != rhs.nShared)	return nShared < rhs.nShared;
+		if(nUnion != rhs.nUnion)	return nUnion > rhs.nUnion;
+		if(nBatch != rhs.nBatch)	return nBatch > rhs.nBatch;
+		return nBatch2 > rhs.nBatch2;
+	}
+};
 
-				// This batch *must* contain this vertex
-				_ASSERT(j != m_nCnt);
-			}
-			else
-			{
-				pfI[i] = 0;
-			}
-		}
+/*!***************************************************************************
+ Orders the bone sets of CPVRTBoneBatches::Create by descending size.
+*****************************************************************************/
+struct SLargerSet
+{
+	const std::vector<int>	&vnSetCnt;
+
+	SLargerSet(const std::vector<int> &vnCnt) : vnSetCnt(vnCnt) {}
+
+	bool operator()(const int nSet, const int nSet2) const
+	{
+		return vnSetCnt[nSet] > vnSetCnt[nSet2];
 	}
 };
 
@@ -291,6 +364,7 @@ protected:
 	char	*m_p;
 	int		m_nSize;
 	int		m_nCnt;
+	int		m_nCapacity;
 
 public:
 /*!***************************************************************************
@@ -302,9 +376,10 @@ public:
 *****************************************************************************/
 	CGrowableArray(const int nSize)
 	{
-		m_p		= NULL;
-		m_nSize	= nSize;
-		m_nCnt	= 0;
+		m_p			= NULL;
+		m_nSize		= nSize;
+		m_nCnt		= 0;
+		m_nCapacity	= 0;
 	}
 	
 /*!***************************************************************************
@@ -324,7 +399,12 @@ public:
 *****************************************************************************/
 	void Append(const void * const pData, const int nCnt)
 	{
-		m_p = (char*)realloc(m_p, (m_nCnt + nCnt) * m_nSize);
+		// Grow geometrically, so that appending one element at a time does not copy the array each time
+		if(m_nCnt + nCnt > m_nCapacity)
+		{
+			m_nCapacity = PVRT_MAX(m_nCnt + nCnt, 2 * m_nCapacity);
+			m_p = (char*)realloc(m_p, m_nCapacity * m_nSize);
+		}
 		_ASSERT(m_p);
 
 		memcpy(&m_p[m_nCnt * m_nSize], pData, nCnt * m_nSize);
@@ -374,11 +454,20 @@ public:
 	{
 		int nCnt;
 
+		// Trim the spare capacity
+		if(m_p && m_nCnt < m_nCapacity)
+		{
+			char *p = (char*)realloc(m_p, PVRT_MAX(m_nCnt, 1) * m_nSize);
+			if(p)
+				m_p = p;
+		}
+
 		*pData = m_p;
 		nCnt = m_nCnt;
 
-		m_p		= NULL;
-		m_nCnt	= 0;
+		m_p			= NULL;
+		m_nCnt		= 0;
+		m_nCapacity	= 0;
 
 		return nCnt;
 	}
@@ -391,16 +480,30 @@ public:
 /****************************************************************************
 ** Local function definitions
 ****************************************************************************/
-static bool FillBatch(
-	CBatch					&batch,
-	const unsigned int	* const pui32Idx,	// input AND output; index array for triangle list
-	const char				* const pVtx,	// Input vertices
-	const int				nStride,		// Size of a vertex (in bytes)
-	const int				nOffsetWeight,	// Offset in bytes to the vertex bone-weights
-	EPVRTDataType			eTypeWeight,	// Data type of the vertex bone-weights
-	const int				nOffsetIdx,		// Offset in bytes to the vertex bone-indices
-	EPVRTDataType			eTypeIdx,		// Data type of the vertex bone-indices
-	const int				nVertexBones);	// Number of bones affecting each vertex
+static int ReadTriangleBones(
+	int						* const pnBones,	// Output distinct bones, in ascending order
+	const unsigned int		* const pui32Idx,	// Indices of the triangle
+	const char				* const pVtx,		// Input vertices
+	const int				nStride,			// Size of a vertex (in bytes)
+	const int				nOffsetWeight,		// Offset in bytes to the vertex bone-weights
+	EPVRTDataType			eTypeWeight,		// Data type of the vertex bone-weights
+	const int				nOffsetIdx,			// Offset in bytes to the vertex bone-indices
+	EPVRTDataType			eTypeIdx,			// Data type of the vertex bone-indices
+	const int				nVertexBones);		// Number of bones affecting each vertex
+
+static void BatchInTriangleOrder(
+	CBoneMasks				&masks,
+	const std::vector<int>	&vnTriSet,
+	const std::vector<int>	&vnSetStart,
+	const std::vector<int>	&vnSetCnt,
+	const std::vector<int>	&vnSetBones);
+
+static void MergeGreedy(
+	CBoneMasks				&masks);
+
+static void MergeSharedBones(
+	CBoneMasks				&masks,
+	std::vector<std::vector<int> >	vvnBoneBatches);
 
 static bool BonesMatch(
 	const float * const pfIdx0,
@@ -425,8 +528,12 @@ static bool BonesMatch(
  @Input			nTriNum			Number of triangles
  @Input			nBatchBoneMax	Number of bones a batch can reference
  @Input			nVertexBones	Number of bones affecting each vertex
+ @Input			bMinimizeBatches	Whether to spend more time to find fewer batches
  @Returns		PVR_SUCCESS if successful
- @Description	Fills the bone batch structure
+ @Description	Fills the bone batch structure. Triangles that reference the
+				same set of bones are batched together, and the batches are
+				held as bone bitsets, so the cost grows with the number of
+				distinct bone sets rather than the number of triangles.
 *****************************************************************************/
 EPVRTError CPVRTBoneBatches::Create(
 	int					* const pnVtxNumOut,
@@ -441,20 +548,16 @@ EPVRTError CPVRTBoneBatches::Create(
 	const EPVRTDataType	eTypeIdx,
 	const int			nTriNum,
 	const int			nBatchBoneMax,
-	const int			nVertexBones)
+	const int			nVertexBones,
+	const bool			bMinimizeBatches)
 {
-	int							i, j, k, nTriCnt;
-	CBatch						batch;
-	std::list<CBatch>			lBatch;
-	std::list<CBatch>::iterator	iBatch, iBatch2;
-	CBatch						**ppBatch;
-	unsigned int				*pui32IdxNew;
-	const char					*pV, *pV2;
+	int							i, j, k, nCnt, nBoneCnt, nSetCnt;
+	int							pnBones[PVRTBONEBATCH_MAX_TRI_BONES];
+	unsigned int				ui32Hash, ui32SrcIdx;
+	const char					*pV;
 	PVRTVECTOR4					vWeight, vIdx;
-	PVRTVECTOR4					vWeight2, vIdx2;
 	std::vector<int>			*pvDup;
 	CGrowableArray				*pVtxBuf;
-	unsigned int				ui32SrcIdx;
 
 	memset(this, 0, sizeof(*this));
 
@@ -464,155 +567,218 @@ EPVRTError CPVRTBoneBatches::Create(
 		return PVR_FAIL;
 	}
 
-	memset(&vWeight, 0, sizeof(vWeight));
-	memset(&vWeight2, 0, sizeof(vWeight2));
-	memset(&vIdx, 0, sizeof(vIdx));
-	memset(&vIdx2, 0, sizeof(vIdx2));
+	// Find the distinct sets of bones that the triangles reference, using an open-addressing hash table
+	std::vector<int>	vnTriSet(nTriNum), vnSetStart, vnSetCnt, vnSetBones;
+	unsigned int		ui32TableSize = 16;
 
-	batch.SetSize(nBatchBoneMax);
+	while(ui32TableSize < 2 * (unsigned int)nTriNum)
+		ui32TableSize <<= 1;
 
-	// Allocate some working space
-	ppBatch		= (CBatch**)malloc(nTriNum * sizeof(*ppBatch));
-	pui32IdxNew	= (unsigned int*)malloc(nTriNum * 3 * sizeof(*pui32IdxNew));
-	pvDup		= new std::vector<int>[nVtxNum];
-	pVtxBuf		= new CGrowableArray(nStride);
+	std::vector<int>	vnTable(ui32TableSize, -1);
 
-	// Check what batches are necessary
+	nBoneCnt = 0;
 	for(i = 0; i < nTriNum; ++i)
 	{
-		// Build the batch
-		if(!FillBatch(batch, &pui32Idx[i * 3], pVtx, nStride, nOffsetWeight, eTypeWeight, nOffsetIdx, eTypeIdx, nVertexBones))
+		nCnt = ReadTriangleBones(pnBones, &pui32Idx[i * 3], pVtx, nStride, nOffsetWeight, eTypeWeight, nOffsetIdx, eTypeIdx, nVertexBones);
+		if(nCnt < 0 || nCnt > nBatchBoneMax)
 		{
-			free(pui32IdxNew);
+			_RPT0(_CRT_WARN, "CPVRTBoneBatching() found a triangle that cannot fit in a batch.\n");
 			return PVR_FAIL;
 		}
 
-		// Update the batch list
-		for(iBatch = lBatch.begin(); iBatch != lBatch.end(); ++iBatch)
-		{
-			// Do nothing if an existing batch is a superset of this new batch
-			if(iBatch->Contains(batch))
-			{
-				break;
-			}
+		ui32Hash = 2166136261u;
+		for(j = 0; j < nCnt; ++j)
+			ui32Hash = (ui32Hash ^ (unsigned int)pnBones[j]) * 16777619u;
 
-			// If this new batch is a superset of an existing batch, replace the old with the new
-			if(batch.Contains(*iBatch))
-			{
-				*iBatch = batch;
+		for(ui32Hash &= ui32TableSize - 1; vnTable[ui32Hash] >= 0; ui32Hash = (ui32Hash + 1) & (ui32TableSize - 1))
+		{
+			const int nSet = vnTable[ui32Hash];
+			if(vnSetCnt[nSet] == nCnt && (nCnt == 0 || memcmp(&vnSetBones[vnSetStart[nSet]], pnBones, nCnt * sizeof(*pnBones)) == 0))
 				break;
-			}
 		}
 
-		// If no suitable batch exists, create a new one
-		if(iBatch == lBatch.end())
+		if(vnTable[ui32Hash] < 0)
 		{
-			lBatch.push_back(batch);
+			vnTable[ui32Hash] = (int)vnSetCnt.size();
+			vnSetStart.push_back((int)vnSetBones.size());
+			vnSetCnt.push_back(nCnt);
+			vnSetBones.insert(vnSetBones.end(), pnBones, pnBones + nCnt);
+
+			if(nCnt)
+				nBoneCnt = PVRT_MAX(nBoneCnt, pnBones[nCnt - 1] + 1);
 		}
+
+		vnTriSet[i] = vnTable[ui32Hash];
 	}
+	nSetCnt = (int)vnSetCnt.size();
 
-	//	Group batches into fewer batches. This simple greedy algorithm could be improved.
-		int							nCurrent, nShortest;
-		std::list<CBatch>::iterator	iShortest;
+	// Start with a batch for each set that is not contained in a larger one. Any batch
+	// containing a set also contains its first bone, so only those batches are checked.
+	std::vector<int>				vnOrder(nSetCnt);
+	std::vector<std::vector<int> >	vvnBoneBatches(nBoneCnt);
+	CBoneMasks						masks(nBoneCnt, nBatchBoneMax);
 
-		for(iBatch = lBatch.begin(); iBatch != lBatch.end(); ++iBatch)
-		{
-			for(;;)
-			{
-				nShortest	= nBatchBoneMax;
-				iBatch2		= iBatch;
-				++iBatch2;
-				for(; iBatch2 != lBatch.end(); ++iBatch2)
-				{
-					nCurrent = iBatch->TestMerge(*iBatch2);
+	for(i = 0; i < nSetCnt; ++i)
+		vnOrder[i] = i;
+	std::stable_sort(vnOrder.begin(), vnOrder.end(), SLargerSet(vnSetCnt));
 
-					if(nCurrent >= 0 && nCurrent < nShortest)
-					{
-						nShortest	= nCurrent;
-						iShortest	= iBatch2;
-					}
-				}
+	for(i = 0; i < nSetCnt && vnSetCnt[vnOrder[i]]; ++i)
+	{
+		const int * const pnSet = &vnSetBones[vnSetStart[vnOrder[i]]];
+		const std::vector<int> &vnCandidates = vvnBoneBatches[pnSet[0]];
+		nCnt = vnSetCnt[vnOrder[i]];
 
-				if(nShortest < nBatchBoneMax)
-				{
-					iBatch->Merge(*iShortest);
-					lBatch.erase(iShortest);
-				}
-				else
-				{
-					break;
-				}
-			}
-		}
+		for(j = 0; j < (int)vnCandidates.size(); ++j)
+			if(masks.Contains(vnCandidates[j], pnSet, nCnt))
+				break;
 
-	// Place each triangle in a batch.
-	for(i = 0; i < nTriNum; ++i)
-	{
-		if(!FillBatch(batch, &pui32Idx[i * 3], pVtx, nStride, nOffsetWeight, eTypeWeight, nOffsetIdx, eTypeIdx, nVertexBones))
+		if(j == (int)vnCandidates.size())
 		{
-			free(pui32IdxNew);
-			return PVR_FAIL;
+			const int nBatch = masks.Add(pnSet, nCnt);
+			for(j = 0; j < nCnt; ++j)
+				vvnBoneBatches[pnSet[j]].push_back(nBatch);
 		}
+	}
 
-		for(iBatch = lBatch.begin(); iBatch != lBatch.end(); ++iBatch)
-		{
-			if(iBatch->Contains(batch))
-			{
-				ppBatch[i] = &*iBatch;
-				break;
-			}
-		}
+	// Group batches into fewer batches. When minimizing, two other groupings are also tried,
+	// and the one with the fewest batches is kept: merging the batches that share the most
+	// bones first, and the original PVRT algorithm, so that there are never more batches.
+	if(bMinimizeBatches)
+	{
+		CBoneMasks shared(masks), original(nBoneCnt, nBatchBoneMax);
+
+		MergeSharedBones(shared, vvnBoneBatches);
+		MergeGreedy(shared);
+
+		BatchInTriangleOrder(original, vnTriSet, vnSetStart, vnSetCnt, vnSetBones);
+		MergeGreedy(original);
 
-		_ASSERT(iBatch != lBatch.end());
+		MergeGreedy(masks);
+
+		if(shared.LiveCount() < masks.LiveCount())
+			masks = shared;
+		if(original.LiveCount() < masks.LiveCount())
+			masks = original;
+	}
+	else
+	{
+		MergeGreedy(masks);
 	}
 
 	// Now that we know how many batches there are, we can allocate the output arrays
+	std::vector<int> vnLive;
+	for(i = 0; i < masks.size(); ++i)
+		if(masks.Count(i) >= 0)
+			vnLive.push_back(i);
+
+	// Triangles that reference no bones need a batch, even if no triangle references any
+	if(vnLive.empty())
+		vnLive.push_back(masks.Add(NULL, 0));
+
 	CPVRTBoneBatches::nBatchBoneMax = nBatchBoneMax;
-	pnBatches		= (int*) calloc(lBatch.size() * nBatchBoneMax, sizeof(*pnBatches));
-	pnBatchBoneCnt	= (int*) calloc(lBatch.size(), sizeof(*pnBatchBoneCnt));
-	pnBatchOffset	= (int*) calloc(lBatch.size(), sizeof(*pnBatchOffset));
+	nBatchCnt		= (int)vnLive.size();
+	pnBatches		= (int*) calloc(nBatchCnt * nBatchBoneMax, sizeof(*pnBatches));
+	pnBatchBoneCnt	= (int*) calloc(nBatchCnt, sizeof(*pnBatchBoneCnt));
+	pnBatchOffset	= (int*) calloc(nBatchCnt, sizeof(*pnBatchOffset));
+	if(!pnBatches || !pnBatchBoneCnt || !pnBatchOffset)
+	{
+		Release();
+		return PVR_FAIL;
+	}
 
-	// Create the new triangle index list, the new vertex list, and the batch information.
-	nTriCnt = 0;
-	nBatchCnt = 0;
+	for(i = 0; i < (int)vvnBoneBatches.size(); ++i)
+		vvnBoneBatches[i].clear();
 
-	for(iBatch = lBatch.begin(); iBatch != lBatch.end(); ++iBatch)
+	for(i = 0; i < nBatchCnt; ++i)
 	{
-		// Write pnBatches, pnBatchBoneCnt and pnBatchOffset for this batch.
-		iBatch->Write(&pnBatches[nBatchCnt * nBatchBoneMax], &pnBatchBoneCnt[nBatchCnt]);
-		pnBatchOffset[nBatchCnt] = nTriCnt;
-		++nBatchCnt;
+		masks.Write(vnLive[i], &pnBatches[i * nBatchBoneMax], &pnBatchBoneCnt[i]);
+		for(j = 0; j < pnBatchBoneCnt[i]; ++j)
+			vvnBoneBatches[pnBatches[i * nBatchBoneMax + j]].push_back(i);
+	}
 
-		// Copy any triangle indices for this batch
-		for(i = 0; i < nTriNum; ++i)
-		{
-			if(ppBatch[i] != &*iBatch)
-				continue;
+	// Place each set, and so each triangle, in the first batch that contains it
+	std::vector<int> vnSetBatch(nSetCnt, 0);
+	for(i = 0; i < nSetCnt; ++i)
+	{
+		if(!vnSetCnt[i])
+			continue;
+
+		const int * const pnSet = &vnSetBones[vnSetStart[i]];
+		const std::vector<int> &vnCandidates = vvnBoneBatches[pnSet[0]];
+
+		for(j = 0; j < (int)vnCandidates.size(); ++j)
+			if(masks.Contains(vnLive[vnCandidates[j]], pnSet, vnSetCnt[i]))
+				break;
+
+		_ASSERT(j != (int)vnCandidates.size());
+		vnSetBatch[i] = vnCandidates[j];
+	}
+
+	// Sort the triangles by batch, keeping their order within each batch
+	std::vector<int> vnTriOrder(nTriNum), vnBatchEnd(nBatchCnt, 0);
+
+	for(i = 0; i < nTriNum; ++i)
+		++vnBatchEnd[vnSetBatch[vnTriSet[i]]];
+
+	for(i = 0, nCnt = 0; i < nBatchCnt; ++i)
+	{
+		pnBatchOffset[i] = nCnt;
+		nCnt += vnBatchEnd[i];
+		vnBatchEnd[i] = pnBatchOffset[i];
+	}
+
+	for(i = 0; i < nTriNum; ++i)
+		vnTriOrder[vnBatchEnd[vnSetBatch[vnTriSet[i]]]++] = i;
+
+	// Create the new triangle index list and the new vertex list
+	unsigned int				*pui32IdxNew = (unsigned int*)malloc(nTriNum * 3 * sizeof(*pui32IdxNew));
+	std::vector<int>			vnBoneSlot(nBoneCnt, -1);
+	std::vector<PVRTVECTOR4>	vOutIdx;
+
+	if(nTriNum && !pui32IdxNew)
+	{
+		Release();
+		return PVR_FAIL;
+	}
 
+	pvDup		= new std::vector<int>[nVtxNum];
+	pVtxBuf		= new CGrowableArray(nStride);
+
+	for(i = 0; i < nBatchCnt; ++i)
+	{
+		// Note the palette index of each bone of this batch
+		const int * const pnPalette = &pnBatches[i * nBatchBoneMax];
+		for(j = 0; j < pnBatchBoneCnt[i]; ++j)
+			vnBoneSlot[pnPalette[j]] = j;
+
+		for(int nTri = pnBatchOffset[i]; nTri < vnBatchEnd[i]; ++nTri)
+		{
 			for(j = 0; j < 3; ++j)
 			{
-				ui32SrcIdx = pui32Idx[3 * i + j];
+				ui32SrcIdx = pui32Idx[3 * vnTriOrder[nTri] + j];
 
 				// Get desired bone indices for this vertex/tri
 				pV = &pVtx[ui32SrcIdx * nStride];
 
+				memset(&vWeight, 0, sizeof(vWeight));
+				memset(&vIdx, 0, sizeof(vIdx));
 				PVRTVertexRead(&vWeight, &pV[nOffsetWeight], eTypeWeight, nVertexBones);
 				PVRTVertexRead(&vIdx, &pV[nOffsetIdx], eTypeIdx, nVertexBones);
 
-				iBatch->GetVertexBoneIndices(&vIdx.x, &vWeight.x, nVertexBones);
+				for(k = 0; k < nVertexBones; ++k)
+				{
+					// This batch *must* contain the bones of this vertex
+					_ASSERT((&vWeight.x)[k] == 0 || vnBoneSlot[(int)(&vIdx.x)[k]] >= 0);
+					(&vIdx.x)[k] = (&vWeight.x)[k] != 0 ? (float)vnBoneSlot[(int)(&vIdx.x)[k]] : 0;
+				}
 				_ASSERT(vIdx.x == 0 || vIdx.x != vIdx.y);
 
 				// Check the list of copies of this vertex for one with suitable bone indices
 				for(k = 0; k < (int)pvDup[ui32SrcIdx].size(); ++k)
 				{
-					pV2 = pVtxBuf->at(pvDup[ui32SrcIdx][k]);
-
-					PVRTVertexRead(&vWeight2, &pV2[nOffsetWeight], eTypeWeight, nVertexBones);
-					PVRTVertexRead(&vIdx2, &pV2[nOffsetIdx], eTypeIdx, nVertexBones);
-
-					if(BonesMatch(&vIdx2.x, &vIdx.x))
+					if(BonesMatch(&vOutIdx[pvDup[ui32SrcIdx][k]].x, &vIdx.x))
 					{
-						pui32IdxNew[3 * nTriCnt + j] = pvDup[ui32SrcIdx][k];
+						pui32IdxNew[3 * nTri + j] = pvDup[ui32SrcIdx][k];
 						break;
 					}
 				}
@@ -623,16 +789,18 @@ EPVRTError CPVRTBoneBatches::Create(
 				//	Did not find a suitable duplicate of the vertex, so create one
 				pVtxBuf->Append(pV, 1);
 				pvDup[ui32SrcIdx].push_back(pVtxBuf->size() - 1);
+				vOutIdx.push_back(vIdx);
 
 				PVRTVertexWrite(&pVtxBuf->last()[nOffsetIdx], eTypeIdx, nVertexBones, &vIdx);
 
-				pui32IdxNew[3 * nTriCnt + j] = pVtxBuf->size() - 1;
+				pui32IdxNew[3 * nTri + j] = pVtxBuf->size() - 1;
 			}
-			++nTriCnt;
 		}
+
+		for(j = 0; j < pnBatchBoneCnt[i]; ++j)
+			vnBoneSlot[pnPalette[j]] = -1;
 	}
-	_ASSERTE(nTriCnt == nTriNum);
-	_ASSERTE(nBatchCnt == (int)lBatch.size());
+	_ASSERTE(nBatchCnt == 0 || vnBatchEnd[nBatchCnt - 1] == nTriNum);
 
 	//	Copy indices to output
 	memcpy(pui32Idx, pui32IdxNew, nTriNum * 3 * sizeof(*pui32IdxNew));
@@ -643,7 +811,6 @@ EPVRTError CPVRTBoneBatches::Create(
 	//	Free working memory
 	delete [] pvDup;
 	delete pVtxBuf;
-	FREE(ppBatch);
 	FREE(pui32IdxNew);
 
 	return PVR_SUCCESS;
@@ -654,8 +821,8 @@ EPVRTError CPVRTBoneBatches::Create(
 ****************************************************************************/
 
 /*!***********************************************************************
- @Function		FillBatch
- @Modified		batch 			The batch to fill
+ @Function		ReadTriangleBones
+ @Output		pnBones			The distinct bones, in ascending order
  @Input			pui32Idx		Input index array for triangle list
  @Input			pVtx			Input vertices
  @Input			nStride			Size of a vertex (in bytes)
@@ -664,12 +831,12 @@ EPVRTError CPVRTBoneBatches::Create(
  @Input			nOffsetIdx		Offset in bytes to the vertex bone-indices
  @Input			eTypeIdx		Data type of the vertex bone-indices
  @Input			nVertexBones	Number of bones affecting each vertex
- @Returns		True if successful
- @Description	Creates a bone batch from a triangle.
+ @Returns		The number of bones, or -1 if a bone index is negative
+ @Description	Reads the bones with non-zero weights that a triangle references.
 *************************************************************************/
-static bool FillBatch(
-	CBatch					&batch,
-	const unsigned int	* const pui32Idx,
+static int ReadTriangleBones(
+	int						* const pnBones,
+	const unsigned int		* const pui32Idx,
 	const char				* const pVtx,
 	const int				nStride,
 	const int				nOffsetWeight,
@@ -680,11 +847,9 @@ static bool FillBatch(
 {
 	PVRTVECTOR4	vWeight, vIdx;
 	const char	*pV;
-	int			i;
-	bool		bOk;
+	int			i, j, k, nBone, nCnt;
 
-	bOk = true;
-	batch.Clear();
+	nCnt = 0;
 	for(i = 0; i < 3; ++i)
 	{
 		pV = &pVtx[pui32Idx[i] * nStride];
@@ -693,12 +858,221 @@ static bool FillBatch(
 		PVRTVertexRead(&vWeight, &pV[nOffsetWeight], eTypeWeight, nVertexBones);
 		PVRTVertexRead(&vIdx, &pV[nOffsetIdx], eTypeIdx, nVertexBones);
 
-		if(nVertexBones >= 1 && vWeight.x != 0)	bOk &= batch.Add((int)vIdx.x);
-		if(nVertexBones >= 2 && vWeight.y != 0)	bOk &= batch.Add((int)vIdx.y);
-		if(nVertexBones >= 3 && vWeight.z != 0)	bOk &= batch.Add((int)vIdx.z);
-		if(nVertexBones >= 4 && vWeight.w != 0)	bOk &= batch.Add((int)vIdx.w);
+		for(j = 0; j < nVertexBones; ++j)
+		{
+			if((&vWeight.x)[j] == 0)
+				continue;
+
+			nBone = (int)(&vIdx.x)[j];
+			if(nBone < 0)
+				return -1;
+
+			// Insert the bone in order, unless we already have it
+			for(k = nCnt; k > 0 && pnBones[k - 1] > nBone; --k);
+			if(k > 0 && pnBones[k - 1] == nBone)
+				continue;
+
+			memmove(&pnBones[k + 1], &pnBones[k], (nCnt - k) * sizeof(*pnBones));
+			pnBones[k] = nBone;
+			++nCnt;
+		}
+	}
+	return nCnt;
+}
+
+/*!***********************************************************************
+ @Function		BatchInTriangleOrder
+ @Modified		masks			Empty batches to fill
+ @Input			vnTriSet		The bone set of each triangle
+ @Input			vnSetStart		The position of each set in vnSetBones
+ @Input			vnSetCnt		The number of bones in each set
+ @Input			vnSetBones		The bones of all the sets
+ @Description	Creates the initial batches as the original PVRT algorithm
+				did: each triangle in turn is dropped if a batch contains it,
+				replaces the first batch that it contains, or else starts a
+				new batch.
+*************************************************************************/
+static void BatchInTriangleOrder(
+	CBoneMasks				&masks,
+	const std::vector<int>	&vnTriSet,
+	const std::vector<int>	&vnSetStart,
+	const std::vector<int>	&vnSetCnt,
+	const std::vector<int>	&vnSetBones)
+{
+	int i, j;
+
+	for(i = 0; i < (int)vnTriSet.size(); ++i)
+	{
+		const int nCnt = vnSetCnt[vnTriSet[i]];
+		const int * const pnSet = nCnt ? &vnSetBones[vnSetStart[vnTriSet[i]]] : NULL;
+
+		for(j = 0; j < masks.size(); ++j)
+		{
+			// Do nothing if an existing batch is a superset of this new batch
+			if(masks.Contains(j, pnSet, nCnt))
+				break;
+
+			// If this new batch is a superset of an existing batch, replace the old with the new
+			if(masks.IsContainedIn(j, pnSet, nCnt))
+			{
+				masks.Set(j, pnSet, nCnt);
+				break;
+			}
+		}
+
+		// If no suitable batch exists, create a new one
+		if(j == masks.size())
+			masks.Add(pnSet, nCnt);
+	}
+}
+
+/*!***********************************************************************
+ @Function		MergeGreedy
+ @Modified		masks			The batches to merge
+ @Description	Merges batches with a simple greedy algorithm: each batch in
+				turn repeatedly takes in the later batch that adds the fewest
+				bones to it, until no later batch fits.
+*************************************************************************/
+static void MergeGreedy(
+	CBoneMasks				&masks)
+{
+	int	i, j, nCurrent, nShortest, nBest;
+
+	for(i = 0; i < masks.size(); ++i)
+	{
+		if(masks.Count(i) < 0)
+			continue;
+
+		for(;;)
+		{
+			nBest = -1;
+			nShortest = 0;
+			for(j = i + 1; j < masks.size(); ++j)
+			{
+				if(masks.Count(j) < 0)
+					continue;
+
+				nCurrent = masks.TestMerge(i, j);
+				if(nCurrent >= 0 && (nBest < 0 || nCurrent < nShortest))
+				{
+					nShortest	= nCurrent;
+					nBest		= j;
+
+					// Nothing adds fewer bones than a subset
+					if(!nShortest)
+						break;
+				}
+			}
+
+			if(nBest < 0)
+				break;
+
+			masks.Merge(i, nBest);
+		}
+	}
+}
+
+/*!***********************************************************************
+ @Function		MergeSharedBones
+ @Modified		masks			The batches to merge
+ @Input			vvnBoneBatches	The batches containing each bone. A copy is
+								taken, as merged batches are added to it.
+ @Description	Repeatedly merges the two batches that share the most bones,
+				preferring the smallest result, until no two batches that
+				share a bone fit in one batch. Candidate merges are kept in a
+				priority queue, and are discarded when popped if either batch
+				has changed since they were scored.
+*************************************************************************/
+static void MergeSharedBones(
+	CBoneMasks				&masks,
+	std::vector<std::vector<int> >	vvnBoneBatches)
+{
+	std::priority_queue<SBatchMerge>	qMerges;
+	std::vector<unsigned int>			vui32Ver(masks.size(), 0);
+	std::vector<int>					vnSeen(masks.size(), 0);	// Stamp of the last scan that found each batch
+	std::vector<int>					vnBones(masks.Capacity() + 1);
+	int									i, j, k, nCnt, nStamp = 0;
+
+	for(i = 0; i < masks.size(); ++i)
+	{
+		// Score a merge with each later batch that shares a bone with this one
+		SBatchMerge sMerge;
+
+		++nStamp;
+		masks.Write(i, &vnBones[0], &nCnt);
+
+		for(j = 0; j < nCnt; ++j)
+		{
+			const std::vector<int> &vnCandidates = vvnBoneBatches[vnBones[j]];
+			for(k = 0; k < (int)vnCandidates.size(); ++k)
+			{
+				const int nOther = vnCandidates[k];
+				if(nOther <= i || vnSeen[nOther] == nStamp || masks.Count(nOther) < 0)
+					continue;
+				vnSeen[nOther] = nStamp;
+
+				sMerge.nShared = masks.Shared(i, nOther);
+				sMerge.nUnion = masks.Count(i) + masks.Count(nOther) - sMerge.nShared;
+				if(masks.TestMerge(i, nOther) < 0)
+					continue;
+
+				sMerge.nBatch = i;
+				sMerge.nBatch2 = nOther;
+				sMerge.ui32Ver = vui32Ver[i];
+				sMerge.ui32Ver2 = vui32Ver[nOther];
+				qMerges.push(sMerge);
+			}
+		}
+	}
+
+	while(!qMerges.empty())
+	{
+		const SBatchMerge sMerge = qMerges.top();
+		qMerges.pop();
+
+		if(masks.Count(sMerge.nBatch) < 0 || masks.Count(sMerge.nBatch2) < 0 ||
+		   vui32Ver[sMerge.nBatch] != sMerge.ui32Ver || vui32Ver[sMerge.nBatch2] != sMerge.ui32Ver2)
+			continue;
+
+		// Merge into the lower batch, and note that it now holds the bones of the other
+		const int nBatch = sMerge.nBatch;
+
+		masks.Write(sMerge.nBatch2, &vnBones[0], &nCnt);
+		for(j = 0; j < nCnt; ++j)
+			if(!masks.Contains(nBatch, vnBones[j]))
+				vvnBoneBatches[vnBones[j]].push_back(nBatch);
+
+		masks.Merge(nBatch, sMerge.nBatch2);
+		++vui32Ver[nBatch];
+
+		// Rescore merges of the grown batch with the batches it shares bones with
+		++nStamp;
+		masks.Write(nBatch, &vnBones[0], &nCnt);
+
+		for(j = 0; j < nCnt; ++j)
+		{
+			const std::vector<int> &vnCandidates = vvnBoneBatches[vnBones[j]];
+			for(k = 0; k < (int)vnCandidates.size(); ++k)
+			{
+				const int nOther = vnCandidates[k];
+				if(nOther == nBatch || vnSeen[nOther] == nStamp || masks.Count(nOther) < 0)
+					continue;
+				vnSeen[nOther] = nStamp;
+
+				if(masks.TestMerge(nBatch, nOther) < 0)
+					continue;
+
+				SBatchMerge sNew;
+				sNew.nBatch = PVRT_MIN(nBatch, nOther);
+				sNew.nBatch2 = PVRT_MAX(nBatch, nOther);
+				sNew.nShared = masks.Shared(nBatch, nOther);
+				sNew.nUnion = masks.Count(nBatch) + masks.Count(nOther) - sNew.nShared;
+				sNew.ui32Ver = vui32Ver[sNew.nBatch];
+				sNew.ui32Ver2 = vui32Ver[sNew.nBatch2];
+				qMerges.push(sNew);
+			}
+		}
 	}
-	return bOk;
 }
 
 /*!***********************************************************************
@@ -726,4 +1100,3 @@ static bool BonesMatch(
 /*****************************************************************************
  End of file (PVRTBoneBatch.cpp)
 *****************************************************************************/
-
@@ -42,6 +42,9 @@ public:
 	 @param[in]		nTriNum			Number of triangles
 	 @param[in]		nBatchBoneMax	Number of bones a batch can reference
 	 @param[in]		nVertexBones	Number of bones affecting each vertex
+	 @param[in]		bMinimizeBatches	If true, also tries merging the batches that
+									share the most bones first, and keeps the result if
+									it has fewer batches. Slower, never more batches.
 	 @return		PVR_SUCCESS if successful
 	*************************************************************************/
 	EPVRTError Create(
@@ -57,7 +60,8 @@ public:
 		const EPVRTDataType	eTypeIdx,
 		const int			nTriNum,
 		const int			nBatchBoneMax,
-		const int			nVertexBones);
+		const int			nVertexBones,
+		const bool			bMinimizeBatches = false);
 
 	/*!***********************************************************************
 	 @brief      	Destroy the bone batch structure
@@ -25,6 +25,31 @@
 #include "PVRTDecompress.h"
 #include "PVRTTexture.h"
 #include "PVRTGlobal.h"
+#include "PVRTParallel.h"
+
+// The SSE2 and NEON decode paths build their output in little-endian lane order
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PVRTDECOMPRESS_SSE2
+	#include <emmintrin.h>
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__ARM_BIG_ENDIAN)
+	#define PVRTDECOMPRESS_NEON
+	#include <arm_neon.h>
+#endif
+
+#if defined(PVRTDECOMPRESS_SSE2) || defined(PVRTDECOMPRESS_NEON)
+	#define PVRTDECOMPRESS_SIMD
+#endif
+
+/*****************************************************************************
+ * Defines
+ *****************************************************************************/
+#define PVRTDECOMPRESS_ROWS_PER_THREAD	8	/*!< Minimum number of block rows given to each decode thread */
+
+/*****************************************************************************
+ * Static variables
+ *****************************************************************************/
+static unsigned int s_ui32DecompressThreads = 0;	/*!< Decode threads; zero uses all processors */
+static bool s_bDecompressSIMD = true;				/*!< Whether the SSE2/NEON decode paths are enabled */
 
 /***********************************************************
 				DECOMPRESSION ROUTINES
@@ -485,6 +510,230 @@ static void pvrtcGetDecompressedPixels(const PVRTCWord& P, const PVRTCWord& Q,
 	}	
 }
 
+/*!***********************************************************************
+ Pointer to pvrtcGetDecompressedPixels() or one of its SIMD equivalents.
+*************************************************************************/
+typedef void (*PFNGetDecompressedPixels)(const PVRTCWord& P, const PVRTCWord& Q,
+										 const PVRTCWord& R, const PVRTCWord& S,
+										 Pixel32 *pColourData, PVRTuint8 ui8Bpp);
+
+#if defined(PVRTDECOMPRESS_SIMD)
+/****************************************************************************
+** SSE2/NEON decode
+**
+** One vector holds the four 32 bit channels of a Pixel128S. Every step below
+** performs exactly the integer operations of the scalar code it replaces, so
+** the output is bit-exact with it.
+****************************************************************************/
+#if defined(PVRTDECOMPRESS_SSE2)
+	typedef __m128i VEC4I;
+	#define VEC4I_ADD(a,b)			_mm_add_epi32(a,b)
+	#define VEC4I_SUB(a,b)			_mm_sub_epi32(a,b)
+	#define VEC4I_SHL(a,n)			_mm_slli_epi32(a,n)
+	#define VEC4I_SHR(a,n)			_mm_srai_epi32(a,n)
+	#define VEC4I_SELECT(m,a,b)		_mm_or_si128(_mm_and_si128(m,a), _mm_andnot_si128(m,b))
+	#define VEC4I_LOAD(p)			_mm_loadu_si128((const __m128i*)(p))
+	#define VEC4I_STORE(p,a)		_mm_storeu_si128((__m128i*)(p),a)
+#else
+	typedef int32x4_t VEC4I;
+	#define VEC4I_ADD(a,b)			vaddq_s32(a,b)
+	#define VEC4I_SUB(a,b)			vsubq_s32(a,b)
+	#define VEC4I_SHL(a,n)			vshlq_n_s32(a,n)
+	#define VEC4I_SHR(a,n)			vshrq_n_s32(a,n)
+	#define VEC4I_SELECT(m,a,b)		vbslq_s32(vreinterpretq_u32_s32(m),a,b)
+	#define VEC4I_LOAD(p)			vld1q_s32((const int32_t*)(p))
+	#define VEC4I_STORE(p,a)		vst1q_s32((int32_t*)(p),a)
+#endif
+
+/*!***********************************************************************
+ @Function		vecFromPixel
+ @Input			c		Colour to convert
+ @Return		The colour as four 32 bit channels
+ @Description	Widens a Pixel32 to a vector, red in the lowest lane.
+*************************************************************************/
+static inline VEC4I vecFromPixel(const Pixel32 c)
+{
+	const Pixel128S w = {(PVRTint32)c.red, (PVRTint32)c.green, (PVRTint32)c.blue, (PVRTint32)c.alpha};
+	return VEC4I_LOAD(&w);
+}
+
+/*!***********************************************************************
+ @Function		interpolateColoursSIMD
+ @Input			P,Q,R,S				Low bit-rate colour values for each PVRTCWord.
+ @Modified		pPixel				Output array for upscaled colour values.
+ @Input			ui8Bpp				Number of bpp.
+ @Description	SIMD equivalent of interpolateColours(). The colour and
+				alpha channels use different shifts, so both are computed
+				and the alpha lane is selected from the second.
+*************************************************************************/
+static void interpolateColoursSIMD(Pixel32 P, Pixel32 Q, Pixel32 R, Pixel32 S,
+								   Pixel128S *pPixel, PVRTuint8 ui8Bpp)
+{
+	const Pixel128S ColourMask = {-1, -1, -1, 0};
+	const VEC4I mask = VEC4I_LOAD(&ColourMask);
+
+	VEC4I hP = vecFromPixel(P);
+	VEC4I hR = vecFromPixel(R);
+	const VEC4I QminusP = VEC4I_SUB(vecFromPixel(Q), hP);
+	const VEC4I SminusR = VEC4I_SUB(vecFromPixel(S), hR);
+
+	if (ui8Bpp==2)
+	{
+		hP = VEC4I_SHL(hP, 3);
+		hR = VEC4I_SHL(hR, 3);
+
+		for (unsigned int x=0; x < 8; x++)
+		{
+			VEC4I Result = VEC4I_SHL(hP, 2);
+			const VEC4I dY = VEC4I_SUB(hR, hP);
+
+			for (unsigned int y=0; y < 4; y++)
+			{
+				const VEC4I colour = VEC4I_ADD(VEC4I_SHR(Result, 7), VEC4I_SHR(Result, 2));
+				const VEC4I alpha = VEC4I_ADD(VEC4I_SHR(Result, 5), VEC4I_SHR(Result, 1));
+				VEC4I_STORE(&pPixel[y*8+x], VEC4I_SELECT(mask, colour, alpha));
+				Result = VEC4I_ADD(Result, dY);
+			}
+
+			hP = VEC4I_ADD(hP, QminusP);
+			hR = VEC4I_ADD(hR, SminusR);
+		}
+	}
+	else
+	{
+		hP = VEC4I_SHL(hP, 2);
+		hR = VEC4I_SHL(hR, 2);
+
+		for (unsigned int y=0; y < 4; y++)
+		{
+			VEC4I Result = VEC4I_SHL(hP, 2);
+			const VEC4I dY = VEC4I_SUB(hR, hP);
+
+			for (unsigned int x=0; x < 4; x++)
+			{
+				const VEC4I colour = VEC4I_ADD(VEC4I_SHR(Result, 6), VEC4I_SHR(Result, 1));
+				const VEC4I alpha = VEC4I_ADD(VEC4I_SHR(Result, 4), Result);
+				VEC4I_STORE(&pPixel[y*4+x], VEC4I_SELECT(mask, colour, alpha));
+				Result = VEC4I_ADD(Result, dY);
+			}
+
+			hP = VEC4I_ADD(hP, QminusP);
+			hR = VEC4I_ADD(hR, SminusR);
+		}
+	}
+}
+
+/*!***********************************************************************
+ @Function		modulatePixelSIMD
+ @Input			A					Upscaled colour A of the pixel.
+ @Input			B					Upscaled colour B of the pixel.
+ @Input			mod					Modulation value of the pixel.
+ @Output		Out					Output pixel.
+ @Description	Blends the two colours of a pixel as pvrtcGetDecompressedPixels()
+				does. The upscaled colours lie in [0, 255], so the division
+				by eight is a shift and the narrowing never saturates.
+*************************************************************************/
+static inline void modulatePixelSIMD(const Pixel128S &A, const Pixel128S &B, PVRTint32 mod, Pixel32 &Out)
+{
+	bool punchthroughAlpha=false;
+	if (mod>10) {punchthroughAlpha=true; mod-=10;}
+
+	PVRTuint32 ui32Result;
+#if defined(PVRTDECOMPRESS_SSE2)
+	// Interleave the 16 bit channels of A and B so that one multiply-add blends them
+	__m128i AB = _mm_packs_epi32(VEC4I_LOAD(&A), VEC4I_LOAD(&B));
+	AB = _mm_unpacklo_epi16(AB, _mm_srli_si128(AB, 8));
+
+	__m128i result = _mm_srai_epi32(_mm_madd_epi16(AB, _mm_set1_epi32((mod << 16) | (8 - mod))), 3);
+	if (punchthroughAlpha) result = _mm_and_si128(result, _mm_set_epi32(0, -1, -1, -1));
+
+	result = _mm_packs_epi32(result, result);
+	ui32Result = (PVRTuint32)_mm_cvtsi128_si32(_mm_packus_epi16(result, result));
+#else
+	int32x4_t result = vshrq_n_s32(vmlaq_n_s32(vmulq_n_s32(VEC4I_LOAD(&A), 8 - mod), VEC4I_LOAD(&B), mod), 3);
+	if (punchthroughAlpha) result = vsetq_lane_s32(0, result, 3);
+
+	const int16x4_t result16 = vmovn_s32(result);
+	ui32Result = vget_lane_u32(vreinterpret_u32_u8(vqmovun_s16(vcombine_s16(result16, result16))), 0);
+#endif
+	memcpy(&Out, &ui32Result, sizeof(Out));
+}
+
+/*!***********************************************************************
+ @Function		pvrtcGetDecompressedPixelsSIMD
+ @Input			P,Q,R,S				PVRTWords in current decompression area.
+ @Modified		pColourData			Output pixels.
+ @Input			ui8Bpp				Number of bpp.
+ @Description	SIMD equivalent of pvrtcGetDecompressedPixels().
+*************************************************************************/
+static void pvrtcGetDecompressedPixelsSIMD(const PVRTCWord& P, const PVRTCWord& Q,
+										   const PVRTCWord& R, const PVRTCWord& S,
+										   Pixel32 *pColourData,
+										   PVRTuint8 ui8Bpp)
+{
+	PVRTint32 i32ModulationValues[16][8];
+	PVRTint32 i32ModulationModes[16][8];
+	Pixel128S upscaledColourA[32];
+	Pixel128S upscaledColourB[32];
+
+	PVRTuint32 ui32WordWidth=4;
+	PVRTuint32 ui32WordHeight=4;
+	if (ui8Bpp==2)
+		ui32WordWidth=8;
+
+	unpackModulations(P, 0, 0, i32ModulationValues, i32ModulationModes, ui8Bpp);
+	unpackModulations(Q, ui32WordWidth, 0, i32ModulationValues, i32ModulationModes, ui8Bpp);
+	unpackModulations(R, 0, ui32WordHeight, i32ModulationValues, i32ModulationModes, ui8Bpp);
+	unpackModulations(S, ui32WordWidth, ui32WordHeight, i32ModulationValues, i32ModulationModes, ui8Bpp);
+
+	interpolateColoursSIMD(getColourA(P.u32ColourData), getColourA(Q.u32ColourData),
+		getColourA(R.u32ColourData), getColourA(S.u32ColourData),
+		upscaledColourA, ui8Bpp);
+	interpolateColoursSIMD(getColourB(P.u32ColourData), getColourB(Q.u32ColourData),
+		getColourB(R.u32ColourData), getColourB(S.u32ColourData),
+		upscaledColourB, ui8Bpp);
+
+	for (unsigned int y=0; y < ui32WordHeight; y++)
+	{
+		for (unsigned int x=0; x < ui32WordWidth; x++)
+		{
+			PVRTint32 mod = getModulationValues(i32ModulationValues,i32ModulationModes,x+ui32WordWidth/2,y+ui32WordHeight/2,ui8Bpp);
+
+			// 4bpp words are stored transposed, as in pvrtcGetDecompressedPixels()
+			Pixel32 &Out = (ui8Bpp==2) ? pColourData[y*ui32WordWidth+x] : pColourData[y+x*ui32WordHeight];
+			modulatePixelSIMD(upscaledColourA[y*ui32WordWidth+x], upscaledColourB[y*ui32WordWidth+x], mod, Out);
+		}
+	}
+}
+#endif /* PVRTDECOMPRESS_SIMD */
+
+/*!***********************************************************************
+ @Function		getDecompressedPixelsFunction
+ @Return		The function used to decompress PVRTC words
+ @Description	Chooses between the scalar and SIMD decode paths.
+*************************************************************************/
+static PFNGetDecompressedPixels getDecompressedPixelsFunction()
+{
+#if defined(PVRTDECOMPRESS_SIMD)
+	if (s_bDecompressSIMD)
+		return &pvrtcGetDecompressedPixelsSIMD;
+#endif
+	return &pvrtcGetDecompressedPixels;
+}
+
+/*!***********************************************************************
+ @Function		decompressThreadCount
+ @Input			ui32Rows			Number of block rows to decode
+ @Return		Number of threads to decode the rows with
+ @Description	Limits the thread count so that small textures and MIP
+				levels are decoded on the calling thread.
+*************************************************************************/
+static unsigned int decompressThreadCount(const unsigned int ui32Rows)
+{
+	unsigned int ui32Threads = s_ui32DecompressThreads ? s_ui32DecompressThreads : PVRTParallelThreadCount();
+	return PVRT_MAX(PVRT_MIN(ui32Threads, ui32Rows / PVRTDECOMPRESS_ROWS_PER_THREAD), 1u);
+}
+
 /*!***********************************************************************
  @Function		wrapWordIndex
  @Input			numWords			Total number of PVRTCWords in the current surface.
@@ -615,6 +864,86 @@ static void mapDecompressedData(Pixel32* pOutput, int width,
 		}
 	}
 }
+/*!***********************************************************************
+ Shared state of the tasks that decompress the rows of a PVRTC surface.
+*************************************************************************/
+struct SPVRTCDecodeJob
+{
+	const PVRTuint32			*pWordMembers;
+	Pixel32						*pOutData;
+	PVRTuint32					ui32Width;
+	int							i32NumXWords;
+	int							i32NumYWords;
+	PVRTuint8					ui8Bpp;
+	PFNGetDecompressedPixels	pfnGetDecompressedPixels;
+};
+
+/*!***********************************************************************
+ @Function		pvrtcDecompressRow
+ @Input			pUserData			The SPVRTCDecodeJob
+ @Input			ui32Index			Row of words to decompress, plus one
+ @Description	Decompresses the pixels between one row of words and the
+				next. Every row writes a different half of two rows of
+				words, so rows can be decompressed concurrently.
+*************************************************************************/
+static void pvrtcDecompressRow(void *pUserData, const unsigned int ui32Index)
+{
+	const SPVRTCDecodeJob &job = *(const SPVRTCDecodeJob*)pUserData;
+	const int wordY = (int)ui32Index - 1;
+	const int i32NumXWords = job.i32NumXWords;
+	const int i32NumYWords = job.i32NumYWords;
+
+	// Structs used for decompression
+	PVRTCWordIndices indices;
+	Pixel32 pPixels[32];
+
+	// The twiddled offset of a word is the bitwise OR of the offsets of its
+	// column and of its row, so each row and column is only twiddled once.
+	const PVRTuint32 ui32TopOffset = TwiddleUV(i32NumXWords, i32NumYWords, 0, wrapWordIndex(i32NumYWords, wordY));
+	const PVRTuint32 ui32BottomOffset = TwiddleUV(i32NumXWords, i32NumYWords, 0, wrapWordIndex(i32NumYWords, wordY + 1));
+	PVRTuint32 ui32RightOffset = TwiddleUV(i32NumXWords, i32NumYWords, wrapWordIndex(i32NumXWords, -1), 0);
+
+	// for each column of words
+	for(int wordX=-1; wordX < i32NumXWords-1; wordX++)
+	{
+		indices.P[0] = wrapWordIndex(i32NumXWords, wordX);
+		indices.P[1] = wrapWordIndex(i32NumYWords, wordY);
+		indices.Q[0] = wrapWordIndex(i32NumXWords, wordX + 1); 
+		indices.Q[1] = wrapWordIndex(i32NumYWords, wordY);
+		indices.R[0] = wrapWordIndex(i32NumXWords, wordX); 
+		indices.R[1] = wrapWordIndex(i32NumYWords, wordY + 1);
+		indices.S[0] = wrapWordIndex(i32NumXWords, wordX + 1);
+		indices.S[1] = wrapWordIndex(i32NumYWords, wordY + 1);
+
+		const PVRTuint32 ui32LeftOffset = ui32RightOffset;
+		ui32RightOffset = TwiddleUV(i32NumXWords, i32NumYWords, indices.Q[0], 0);
+
+		//Work out the offsets into the twiddle structs, multiply by two as there are two members per word.
+		PVRTuint32 WordOffsets[4] =
+		{
+			(ui32LeftOffset | ui32TopOffset)*2,
+			(ui32RightOffset | ui32TopOffset)*2,
+			(ui32LeftOffset | ui32BottomOffset)*2,
+			(ui32RightOffset | ui32BottomOffset)*2,
+		};
+
+		//Access individual elements to fill out PVRTCWord
+		PVRTCWord P,Q,R,S;
+		P.u32ColourData = job.pWordMembers[WordOffsets[0]+1];
+		P.u32ModulationData = job.pWordMembers[WordOffsets[0]];
+		Q.u32ColourData = job.pWordMembers[WordOffsets[1]+1];
+		Q.u32ModulationData = job.pWordMembers[WordOffsets[1]];
+		R.u32ColourData = job.pWordMembers[WordOffsets[2]+1];
+		R.u32ModulationData = job.pWordMembers[WordOffsets[2]];
+		S.u32ColourData = job.pWordMembers[WordOffsets[3]+1];
+		S.u32ModulationData = job.pWordMembers[WordOffsets[3]];
+
+		// assemble 4 words into struct to get decompressed pixels from
+		job.pfnGetDecompressedPixels(P,Q,R,S,pPixels,job.ui8Bpp);
+		mapDecompressedData(job.pOutData, job.ui32Width, pPixels, indices, job.ui8Bpp);
+	} // for each word
+}
+
 /*!***********************************************************************
  @Function		pvrtcDecompress
  @Input			pCompressedData		The PVRTC texture data to decompress
@@ -635,61 +964,21 @@ static int pvrtcDecompress(	PVRTuint8 *pCompressedData,
 	if (ui8Bpp==2)
 		ui32WordWidth=8;
 
-	PVRTuint32 *pWordMembers = (PVRTuint32 *)pCompressedData;
-	Pixel32 *pOutData = pDecompressedData;
+	SPVRTCDecodeJob job;
+	job.pWordMembers = (const PVRTuint32 *)pCompressedData;
+	job.pOutData = pDecompressedData;
+	job.ui32Width = ui32Width;
+	job.ui8Bpp = ui8Bpp;
+	job.pfnGetDecompressedPixels = getDecompressedPixelsFunction();
 
 	// Calculate number of words
-	int i32NumXWords = (int)(ui32Width / ui32WordWidth);
-	int i32NumYWords = (int)(ui32Height / ui32WordHeight);
+	job.i32NumXWords = (int)(ui32Width / ui32WordWidth);
+	job.i32NumYWords = (int)(ui32Height / ui32WordHeight);
 
-	// Structs used for decompression
-	PVRTCWordIndices indices;
-	Pixel32 *pPixels;
-	pPixels = (Pixel32*)malloc(ui32WordWidth*ui32WordHeight*sizeof(Pixel32));
-	
 	// For each row of words
-	for(int wordY=-1; wordY < i32NumYWords-1; wordY++)
-	{
-		// for each column of words
-		for(int wordX=-1; wordX < i32NumXWords-1; wordX++)
-		{
-			indices.P[0] = wrapWordIndex(i32NumXWords, wordX);
-			indices.P[1] = wrapWordIndex(i32NumYWords, wordY);
-			indices.Q[0] = wrapWordIndex(i32NumXWords, wordX + 1); 
-			indices.Q[1] = wrapWordIndex(i32NumYWords, wordY);
-			indices.R[0] = wrapWordIndex(i32NumXWords, wordX); 
-			indices.R[1] = wrapWordIndex(i32NumYWords, wordY + 1);
-			indices.S[0] = wrapWordIndex(i32NumXWords, wordX + 1);
-			indices.S[1] = wrapWordIndex(i32NumYWords, wordY + 1);
-
-			//Work out the offsets into the twiddle structs, multiply by two as there are two members per word.
-			PVRTuint32 WordOffsets[4] =
-			{
-				TwiddleUV(i32NumXWords,i32NumYWords,indices.P[0], indices.P[1])*2,
-				TwiddleUV(i32NumXWords,i32NumYWords,indices.Q[0], indices.Q[1])*2,
-				TwiddleUV(i32NumXWords,i32NumYWords,indices.R[0], indices.R[1])*2,
-				TwiddleUV(i32NumXWords,i32NumYWords,indices.S[0], indices.S[1])*2,
-			};
-
-			//Access individual elements to fill out PVRTCWord
-			PVRTCWord P,Q,R,S;
-			P.u32ColourData = pWordMembers[WordOffsets[0]+1];
-			P.u32ModulationData = pWordMembers[WordOffsets[0]];
-			Q.u32ColourData = pWordMembers[WordOffsets[1]+1];
-			Q.u32ModulationData = pWordMembers[WordOffsets[1]];
-			R.u32ColourData = pWordMembers[WordOffsets[2]+1];
-			R.u32ModulationData = pWordMembers[WordOffsets[2]];
-			S.u32ColourData = pWordMembers[WordOffsets[3]+1];
-			S.u32ModulationData = pWordMembers[WordOffsets[3]];
-							
-			// assemble 4 words into struct to get decompressed pixels from
-			pvrtcGetDecompressedPixels(P,Q,R,S,pPixels,ui8Bpp);
-			mapDecompressedData(pOutData, ui32Width, pPixels, indices, ui8Bpp);
-			
-		} // for each word
-	} // for each row of words
-
-	free(pPixels);
+	const unsigned int ui32Rows = (unsigned int)job.i32NumYWords;
+	PVRTParallelFor(ui32Rows, &pvrtcDecompressRow, &job, decompressThreadCount(ui32Rows));
+
 	//Return the data size
 	return ui32Width * ui32Height / (PVRTuint32)(ui32WordWidth/2);
 }
@@ -767,6 +1056,23 @@ const int mod[8][4]={{2, 8,-2,-8},
 					{33, 106, -33, -106},
 					{47, 183, -47, -183}};
 
+ /*!***********************************************************************
+ @Function		getModIndex
+ @Input			modBlock	Values for the current block
+ @Input			index		Pixel x position in block * 4 + y position
+ @Returns		Index of the pixel's modifier in its modulation table
+ @Description	Used by modifyPixel and ETCDecodeBlockSIMD
+*************************************************************************/
+static inline int getModIndex(unsigned int modBlock, int index)
+{
+	unsigned int mostSig = modBlock<<1;
+
+	if (index<8)
+		return ((modBlock>>(index+24))&0x1)+((mostSig>>(index+8))&0x2);
+	else
+		return ((modBlock>>(index+8))&0x1)+((mostSig>>(index-8))&0x2);
+}
+
  /*!***********************************************************************
  @Function		modifyPixel
  @Input			red		Red value of pixel
@@ -777,17 +1083,11 @@ const int mod[8][4]={{2, 8,-2,-8},
  @Input			modBlock	Values for the current block
  @Input			modTable	Modulation values
  @Returns		Returns actual pixel colour
- @Description	Used by ETCTextureDecompress
+ @Description	Used by ETCDecodeBlock
 *************************************************************************/
 static unsigned int modifyPixel(int red, int green, int blue, int x, int y, unsigned int modBlock, int modTable)
 {
-	int index = x*4+y, pixelMod;
-	unsigned int mostSig = modBlock<<1;
-
-	if (index<8)
-		pixelMod = mod[modTable][((modBlock>>(index+24))&0x1)+((mostSig>>(index+8))&0x2)];
-	else
-		pixelMod = mod[modTable][((modBlock>>(index+8))&0x1)+((mostSig>>(index-8))&0x2)];
+	int pixelMod = mod[modTable][getModIndex(modBlock, x*4+y)];
 
 	red = _CLAMP_(red+pixelMod,0,255);
 	green = _CLAMP_(green+pixelMod,0,255);
@@ -797,107 +1097,235 @@ static unsigned int modifyPixel(int red, int green, int blue, int x, int y, unsi
 }
 
  /*!***********************************************************************
- @Function		ETCTextureDecompress
- @Input			pSrcData The ETC texture data to decompress
- @Input			x X dimension of the texture
- @Input			y Y dimension of the texture
- @Modified		pDestData The decompressed texture data
- @Input			nMode The format of the data
- @Returns		The number of bytes of ETC data decompressed
- @Description	Decompresses ETC to RGBA 8888
+ @Function		ETCGetBaseColours
+ @Input			blockTop	Colour half of the block
+ @Output		red1, green1, blue1		Base colour of subblock 1
+ @Output		red2, green2, blue2		Base colour of subblock 2
+ @Description	Decodes the base colours of the two subblocks of a block
+*************************************************************************/
+static void ETCGetBaseColours(unsigned int blockTop,
+							  unsigned char &red1, unsigned char &green1, unsigned char &blue1,
+							  unsigned char &red2, unsigned char &green2, unsigned char &blue2)
+{
+	if(blockTop & ETC_DIFF)
+	{	// differential mode 5 colour bits + 3 difference bits
+		// get base colour for subblock 1
+		blue1 = (unsigned char)((blockTop&0xf80000)>>16);
+		green1 = (unsigned char)((blockTop&0xf800)>>8);
+		red1 = (unsigned char)(blockTop&0xf8);
+
+		// get differential colour for subblock 2
+		signed char blues = (signed char)(blue1>>3) + ((signed char) ((blockTop & 0x70000) >> 11)>>5);
+		signed char greens = (signed char)(green1>>3) + ((signed char)((blockTop & 0x700) >>3)>>5);
+		signed char reds = (signed char)(red1>>3) + ((signed char)((blockTop & 0x7)<<5)>>5);
+
+		blue2 = (unsigned char)blues;
+		green2 = (unsigned char)greens;
+		red2 = (unsigned char)reds;
+
+		red1 = red1 +(red1>>5);	// copy bits to lower sig
+		green1 = green1 + (green1>>5);	// copy bits to lower sig
+		blue1 = blue1 + (blue1>>5);	// copy bits to lower sig
+
+		red2 = (red2<<3) +(red2>>2);	// copy bits to lower sig
+		green2 = (green2<<3) + (green2>>2);	// copy bits to lower sig
+		blue2 = (blue2<<3) + (blue2>>2);	// copy bits to lower sig
+	}
+	else
+	{	// individual mode 4 + 4 colour bits
+		// get base colour for subblock 1
+		blue1 = (unsigned char)((blockTop&0xf00000)>>16);
+		blue1 = blue1 +(blue1>>4);	// copy bits to lower sig
+		green1 = (unsigned char)((blockTop&0xf000)>>8);
+		green1 = green1 + (green1>>4);	// copy bits to lower sig
+		red1 = (unsigned char)(blockTop&0xf0);
+		red1 = red1 + (red1>>4);	// copy bits to lower sig
+
+		// get base colour for subblock 2
+		blue2 = (unsigned char)((blockTop&0xf0000)>>12);
+		blue2 = blue2 +(blue2>>4);	// copy bits to lower sig
+		green2 = (unsigned char)((blockTop&0xf00)>>4);
+		green2 = green2 + (green2>>4);	// copy bits to lower sig
+		red2 = (unsigned char)((blockTop&0xf)<<4);
+		red2 = red2 + (red2>>4);	// copy bits to lower sig
+	}
+}
+
+ /*!***********************************************************************
+ @Function		ETCDecodeBlock
+ @Input			blockTop	Colour half of the block
+ @Input			blockBot	Modulation half of the block
+ @Modified		output		First pixel of the block in the output
+ @Input			x			X dimension of the texture
+ @Description	Decodes a 4x4 block to BGRA 8888
 *************************************************************************/
-static int ETCTextureDecompress(const void * const pSrcData, const int &x, const int &y, const void *pDestData,const int &/*nMode*/)
+static void ETCDecodeBlock(unsigned int blockTop, unsigned int blockBot, unsigned int *output, const int x)
 {
-	unsigned int blockTop, blockBot, *input = (unsigned int*)pSrcData, *output;
 	unsigned char red1, green1, blue1, red2, green2, blue2;
-	bool bFlip, bDiff;
-	int modtable1,modtable2;
+	ETCGetBaseColours(blockTop, red1, green1, blue1, red2, green2, blue2);
 
-	for(int i=0;i<y;i+=4)
-	{
-		for(int m=0;m<x;m+=4)
+	// get the modtables for each subblock
+	int modtable1 = (blockTop>>29)&0x7;
+	int modtable2 = (blockTop>>26)&0x7;
+
+	if(!(blockTop & ETC_FLIP))
+	{	// 2 2x4 blocks side by side
+
+		for(int j=0;j<4;j++)	// vertical
 		{
-				blockTop = *(input++);
-				blockBot = *(input++);
-
-			output = (unsigned int*)pDestData + i*x +m;
-
-			// check flipbit
-			bFlip = (blockTop & ETC_FLIP) != 0;
-			bDiff = (blockTop & ETC_DIFF) != 0;
-
-			if(bDiff)
-			{	// differential mode 5 colour bits + 3 difference bits
-				// get base colour for subblock 1
-				blue1 = (unsigned char)((blockTop&0xf80000)>>16);
-				green1 = (unsigned char)((blockTop&0xf800)>>8);
-				red1 = (unsigned char)(blockTop&0xf8);
-
-				// get differential colour for subblock 2
-				signed char blues = (signed char)(blue1>>3) + ((signed char) ((blockTop & 0x70000) >> 11)>>5);
-				signed char greens = (signed char)(green1>>3) + ((signed char)((blockTop & 0x700) >>3)>>5);
-				signed char reds = (signed char)(red1>>3) + ((signed char)((blockTop & 0x7)<<5)>>5);
-
-				blue2 = (unsigned char)blues;
-				green2 = (unsigned char)greens;
-				red2 = (unsigned char)reds;
-
-				red1 = red1 +(red1>>5);	// copy bits to lower sig
-				green1 = green1 + (green1>>5);	// copy bits to lower sig
-				blue1 = blue1 + (blue1>>5);	// copy bits to lower sig
-
-				red2 = (red2<<3) +(red2>>2);	// copy bits to lower sig
-				green2 = (green2<<3) + (green2>>2);	// copy bits to lower sig
-				blue2 = (blue2<<3) + (blue2>>2);	// copy bits to lower sig
+			for(int k=0;k<2;k++)	// horizontal
+			{
+				*(output+j*x+k) = modifyPixel(red1,green1,blue1,k,j,blockBot,modtable1);
+				*(output+j*x+k+2) = modifyPixel(red2,green2,blue2,k+2,j,blockBot,modtable2);
 			}
-			else
-			{	// individual mode 4 + 4 colour bits
-				// get base colour for subblock 1
-				blue1 = (unsigned char)((blockTop&0xf00000)>>16);
-				blue1 = blue1 +(blue1>>4);	// copy bits to lower sig
-				green1 = (unsigned char)((blockTop&0xf000)>>8);
-				green1 = green1 + (green1>>4);	// copy bits to lower sig
-				red1 = (unsigned char)(blockTop&0xf0);
-				red1 = red1 + (red1>>4);	// copy bits to lower sig
-
-				// get base colour for subblock 2
-				blue2 = (unsigned char)((blockTop&0xf0000)>>12);
-				blue2 = blue2 +(blue2>>4);	// copy bits to lower sig
-				green2 = (unsigned char)((blockTop&0xf00)>>4);
-				green2 = green2 + (green2>>4);	// copy bits to lower sig
-				red2 = (unsigned char)((blockTop&0xf)<<4);
-				red2 = red2 + (red2>>4);	// copy bits to lower sig
+		}
+
+	}
+	else
+	{	// 2 4x2 blocks on top of each other
+		for(int j=0;j<2;j++)
+		{
+			for(int k=0;k<4;k++)
+			{
+				*(output+j*x+k) = modifyPixel(red1,green1,blue1,k,j,blockBot,modtable1);
+				*(output+(j+2)*x+k) = modifyPixel(red2,green2,blue2,k,j+2,blockBot,modtable2);
 			}
-			// get the modtables for each subblock
-			modtable1 = (blockTop>>29)&0x7;
-			modtable2 = (blockTop>>26)&0x7;
+		}
+	}
+}
 
-			if(!bFlip)
-			{	// 2 2x4 blocks side by side
+#if defined(PVRTDECOMPRESS_SIMD)
+ /*!***********************************************************************
+ @Function		ETCGetPaletteSIMD
+ @Input			red, green, blue	Base colour of a subblock
+ @Input			modTable	Modulation table of the subblock
+ @Output		pPalette	The four colours the subblock's pixels can take
+ @Description	Applies each modifier of the table to the base colour at
+				once, clamping as modifyPixel does, to give RGBA 8888.
+*************************************************************************/
+static inline void ETCGetPaletteSIMD(int red, int green, int blue, int modTable, unsigned int pPalette[4])
+{
+	const int *m = mod[modTable];
+#if defined(PVRTDECOMPRESS_SSE2)
+	const __m128i base = _mm_set_epi16(255, blue, green, red, 255, blue, green, red);
+	const __m128i mod01 = _mm_set_epi16(0, m[1], m[1], m[1], 0, m[0], m[0], m[0]);
+	const __m128i mod23 = _mm_set_epi16(0, m[3], m[3], m[3], 0, m[2], m[2], m[2]);
+
+	_mm_storeu_si128((__m128i*)pPalette, _mm_packus_epi16(_mm_add_epi16(base, mod01), _mm_add_epi16(base, mod23)));
+#else
+	const int16_t i16Base[8] = {(int16_t)red, (int16_t)green, (int16_t)blue, 255, (int16_t)red, (int16_t)green, (int16_t)blue, 255};
+	const int16_t i16Mod01[8] = {(int16_t)m[0], (int16_t)m[0], (int16_t)m[0], 0, (int16_t)m[1], (int16_t)m[1], (int16_t)m[1], 0};
+	const int16_t i16Mod23[8] = {(int16_t)m[2], (int16_t)m[2], (int16_t)m[2], 0, (int16_t)m[3], (int16_t)m[3], (int16_t)m[3], 0};
+	const int16x8_t base = vld1q_s16(i16Base);
+
+	vst1q_u8((uint8_t*)pPalette, vcombine_u8(vqmovun_s16(vaddq_s16(base, vld1q_s16(i16Mod01))),
+											 vqmovun_s16(vaddq_s16(base, vld1q_s16(i16Mod23)))));
+#endif
+}
 
-				for(int j=0;j<4;j++)	// vertical
-				{
-					for(int k=0;k<2;k++)	// horizontal
-					{
-						*(output+j*x+k) = modifyPixel(red1,green1,blue1,k,j,blockBot,modtable1);
-						*(output+j*x+k+2) = modifyPixel(red2,green2,blue2,k+2,j,blockBot,modtable2);
-					}
-				}
+ /*!***********************************************************************
+ @Function		ETCDecodeBlockSIMD
+ @Input			blockTop	Colour half of the block
+ @Input			blockBot	Modulation half of the block
+ @Modified		output		First pixel of the block in the output
+ @Input			x			X dimension of the texture
+ @Description	SIMD equivalent of ETCDecodeBlock, which writes RGBA 8888
+				so that the red and blue channels need not be swapped.
+*************************************************************************/
+static void ETCDecodeBlockSIMD(unsigned int blockTop, unsigned int blockBot, unsigned int *output, const int x)
+{
+	unsigned char red1, green1, blue1, red2, green2, blue2;
+	ETCGetBaseColours(blockTop, red1, green1, blue1, red2, green2, blue2);
 
-			}
-			else
-			{	// 2 4x2 blocks on top of each other
-				for(int j=0;j<2;j++)
-				{
-					for(int k=0;k<4;k++)
-					{
-						*(output+j*x+k) = modifyPixel(red1,green1,blue1,k,j,blockBot,modtable1);
-						*(output+(j+2)*x+k) = modifyPixel(red2,green2,blue2,k,j+2,blockBot,modtable2);
-					}
-				}
-			}
+	unsigned int palette[2][4];
+	ETCGetPaletteSIMD(red1, green1, blue1, (blockTop>>29)&0x7, palette[0]);
+	ETCGetPaletteSIMD(red2, green2, blue2, (blockTop>>26)&0x7, palette[1]);
+
+	const bool bFlip = (blockTop & ETC_FLIP) != 0;
+
+	for(int j=0;j<4;j++)
+	{
+		for(int k=0;k<4;k++)
+		{
+			const int subBlock = bFlip ? (j>>1) : (k>>1);
+			*(output+j*x+k) = palette[subBlock][getModIndex(blockBot, k*4+j)];
 		}
 	}
+}
+#endif /* PVRTDECOMPRESS_SIMD */
+
+/*!***********************************************************************
+ Shared state of the tasks that decompress the rows of an ETC surface.
+*************************************************************************/
+struct SETCDecodeJob
+{
+	const unsigned int	*pInput;
+	unsigned int		*pOutput;
+	int					x;
+	int					y;
+	bool				bSIMD;
+};
+
+ /*!***********************************************************************
+ @Function		ETCDecompressRow
+ @Input			pUserData	The SETCDecodeJob
+ @Input			ui32Index	Row of blocks to decompress
+ @Description	Decompresses one row of blocks to RGBA 8888
+*************************************************************************/
+static void ETCDecompressRow(void *pUserData, const unsigned int ui32Index)
+{
+	const SETCDecodeJob &job = *(const SETCDecodeJob*)pUserData;
+	const int i = (int)ui32Index*4;
+	const int blocksPerRow = (job.x+3)/4;
+	const unsigned int *input = job.pInput + ui32Index*blocksPerRow*2;
+	unsigned int *output = job.pOutput + i*job.x;
+
+#if defined(PVRTDECOMPRESS_SIMD)
+	if(job.bSIMD)
+	{
+		for(int m=0;m<job.x;m+=4, input+=2)
+			ETCDecodeBlockSIMD(input[0], input[1], output+m, job.x);
+		return;
+	}
+#endif
+
+	for(int m=0;m<job.x;m+=4, input+=2)
+		ETCDecodeBlock(input[0], input[1], output+m, job.x);
+
+	// swap r and b channels
+	unsigned char* pSwap = (unsigned char*)output, swap;
+
+	for(int r=i;r<i+4 && r<job.y;r++)
+		for(int j=0;j<job.x;j++)
+		{
+			swap = pSwap[0];
+			pSwap[0] = pSwap[2];
+			pSwap[2] = swap;
+			pSwap+=4;
+		}
+}
+
+ /*!***********************************************************************
+ @Function		ETCTextureDecompress
+ @Input			pSrcData The ETC texture data to decompress
+ @Input			x X dimension of the texture
+ @Input			y Y dimension of the texture
+ @Modified		pDestData The decompressed texture data
+ @Input			nMode The format of the data
+ @Returns		The number of bytes of ETC data decompressed
+ @Description	Decompresses ETC to RGBA 8888
+*************************************************************************/
+static int ETCTextureDecompress(const void * const pSrcData, const int &x, const int &y, void *pDestData,const int &/*nMode*/)
+{
+	SETCDecodeJob job;
+	job.pInput = (const unsigned int*)pSrcData;
+	job.pOutput = (unsigned int*)pDestData;
+	job.x = x;
+	job.y = y;
+	job.bSIMD = PVRTDecompressUsesSIMD();
+
+	const unsigned int ui32Rows = (unsigned int)(y+3)/4;
+	PVRTParallelFor(ui32Rows, &ETCDecompressRow, &job, decompressThreadCount(ui32Rows));
 
 	return x*y/2;
 }
@@ -922,7 +1350,11 @@ int PVRTDecompressETC(const void * const pSrcData,
 
 	if(x<ETC_MIN_TEXWIDTH || y<ETC_MIN_TEXHEIGHT)
 	{	// decompress into a buffer big enough to take the minimum size
-		char* pTempBuffer =	(char*)malloc(PVRT_MAX(x,ETC_MIN_TEXWIDTH)*PVRT_MAX(y,ETC_MIN_TEXHEIGHT)*4);
+		char* pTempBuffer = NULL;
+		pTempBuffer = (char*)malloc(PVRT_MAX(x,ETC_MIN_TEXWIDTH)*PVRT_MAX(y,ETC_MIN_TEXHEIGHT)*4);
+		if(!pTempBuffer)
+			return 0;
+
 		i32read = ETCTextureDecompress(pSrcData,PVRT_MAX(x,ETC_MIN_TEXWIDTH),PVRT_MAX(y,ETC_MIN_TEXHEIGHT),pTempBuffer,nMode);
 
 		for(unsigned int i=0;i<y;i++)
@@ -935,19 +1367,41 @@ int PVRTDecompressETC(const void * const pSrcData,
 	else	// decompress larger MIP levels straight into the output data
 		i32read = ETCTextureDecompress(pSrcData,x,y,pDestData,nMode);
 
-	// swap r and b channels
-	unsigned char* pSwap = (unsigned char*)pDestData, swap;
+	return i32read;
+}
 
-	for(unsigned int i=0;i<y;i++)
-		for(unsigned int j=0;j<x;j++)
-		{
-			swap = pSwap[0];
-			pSwap[0] = pSwap[2];
-			pSwap[2] = swap;
-			pSwap+=4;
-		}
+/*!***********************************************************************
+ @Function		PVRTDecompressSetThreadCount
+ @Input			ui32Threads		Number of threads; zero uses all processors
+ @Description	Sets the number of threads used to decompress textures.
+*************************************************************************/
+void PVRTDecompressSetThreadCount(const unsigned int ui32Threads)
+{
+	s_ui32DecompressThreads = ui32Threads;
+}
 
-	return i32read;
+/*!***********************************************************************
+ @Function		PVRTDecompressSetSIMD
+ @Input			bEnable			Whether to use the SSE2/NEON decode paths
+ @Description	Enables or disables the SSE2/NEON decode paths.
+*************************************************************************/
+void PVRTDecompressSetSIMD(const bool bEnable)
+{
+	s_bDecompressSIMD = bEnable;
+}
+
+/*!***********************************************************************
+ @Function		PVRTDecompressUsesSIMD
+ @Return		true if the SSE2/NEON decode paths are in use
+ @Description	Returns whether the SSE2/NEON decode paths are in use.
+*************************************************************************/
+bool PVRTDecompressUsesSIMD()
+{
+#if defined(PVRTDECOMPRESS_SIMD)
+	return s_bDecompressSIMD;
+#else
+	return false;
+#endif
 }
 
 /*****************************************************************************
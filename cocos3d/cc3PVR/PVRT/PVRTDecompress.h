@@ -39,6 +39,31 @@ int PVRTDecompressETC(const void * const pSrcData,
 						 void *pDestData,
 						 const int &nMode);
 
+/*!***********************************************************************
+ @brief      	Sets the number of threads used by PVRTDecompressPVRTC() and
+				PVRTDecompressETC(). Each thread decodes whole rows of
+				blocks, so the output does not depend on the thread count.
+				Zero, the default, uses all processors.
+ @param[in]		ui32Threads     Number of threads
+*************************************************************************/
+void PVRTDecompressSetThreadCount(const unsigned int ui32Threads);
+
+/*!***********************************************************************
+ @brief      	Enables or disables the SSE2/NEON decode paths. Their output
+				is bit-exact with the scalar path, which is used when they
+				are disabled or when the library was built for a processor
+				without SSE2 or NEON. Enabled by default.
+ @param[in]		bEnable         Whether to use the SSE2/NEON decode paths
+*************************************************************************/
+void PVRTDecompressSetSIMD(const bool bEnable);
+
+/*!***********************************************************************
+ @brief      	Returns whether PVRTDecompressPVRTC() and PVRTDecompressETC()
+				currently use the SSE2/NEON decode paths.
+ @return		true if the SSE2/NEON decode paths are in use
+*************************************************************************/
+bool PVRTDecompressUsesSIMD();
+
 
 #endif /* _PVRTDECOMPRESS_H_ */
 
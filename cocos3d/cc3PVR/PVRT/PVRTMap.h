@@ -8,12 +8,70 @@
 #ifndef __PVRTMAP_H__
 #define __PVRTMAP_H__
 
+#include <string.h>
 #include "PVRTArray.h"
 
+/*!***************************************************************************
+ Maps with no more than this many entries are searched linearly, which is
+ faster than hashing for so few keys, and needs no index.
+*****************************************************************************/
+#define PVRTMAP_LINEAR_SEARCH_MAX	8
+
+/*!***************************************************************************
+ @brief      	Returns the hash of a CPVRTMap key. The default hashes the bytes
+				of the key, which suits keys that are plain data with no padding.
+				Specialise it for any other key type.
+ @param[in]		key     Key to hash
+ @return		The hash of the key.
+*****************************************************************************/
+template <typename KeyType>
+inline PVRTuint32 PVRTMapHash(const KeyType& key)
+{
+	//FNV-1a
+	const PVRTuint8* pBytes = (const PVRTuint8*)&key;
+	PVRTuint32 ui32Hash = 2166136261u;
+	for (size_t i = 0; i < sizeof(KeyType); ++i)
+		ui32Hash = (ui32Hash ^ pBytes[i]) * 16777619u;
+	return ui32Hash;
+}
+
+/*!***************************************************************************
+ @brief      	Hashes a 32 bit integer key by mixing all of its bits, so that
+				keys such as FourCCs and small indices spread over the index.
+ @param[in]		key     Key to hash
+ @return		The hash of the key.
+*****************************************************************************/
+template <>
+inline PVRTuint32 PVRTMapHash<PVRTuint32>(const PVRTuint32& key)
+{
+	PVRTuint32 ui32Hash = key;
+	ui32Hash ^= ui32Hash >> 16;
+	ui32Hash *= 0x85EBCA6Bu;
+	ui32Hash ^= ui32Hash >> 13;
+	ui32Hash *= 0xC2B2AE35u;
+	ui32Hash ^= ui32Hash >> 16;
+	return ui32Hash;
+}
+
+/*!***************************************************************************
+ @brief      	Hashes a signed 32 bit integer key.
+ @param[in]		key     Key to hash
+ @return		The hash of the key.
+*****************************************************************************/
+template <>
+inline PVRTuint32 PVRTMapHash<PVRTint32>(const PVRTint32& key)
+{
+	return PVRTMapHash<PVRTuint32>((PVRTuint32)key);
+}
+
 /*!***************************************************************************
  @class		CPVRTMap
  @brief		Expanding map template class.
- @details   A simple and easy-to-use implementation of a map.
+ @details   A simple and easy-to-use implementation of a map. Keys and data are
+			held in two packed arrays, in the order they were added, and maps
+			with more than PVRTMAP_LINEAR_SEARCH_MAX entries are indexed by an
+			open-addressing hash table of positions in those arrays, so that
+			lookups take constant time.
 *****************************************************************************/
 template <typename KeyType, typename DataType>
 class CPVRTMap
@@ -24,7 +82,7 @@ public:
 	 @brief      	Constructor for a CPVRTMap.
 	 @return		A new CPVRTMap.
 	*************************************************************************/
-	CPVRTMap() : m_Keys(), m_Data(), m_uiSize(0)
+	CPVRTMap() : m_Keys(), m_Data(), m_Slots(), m_uiSize(0)
 	{}
 
 	/*!***********************************************************************
@@ -36,11 +94,23 @@ public:
 		Clear();
 	}
 
+	/*!***********************************************************************
+	 @brief      	Reserves space for the specified number of members, so that
+					adding them does not reallocate the map.
+	 @param[in]		uiSize     Number of members to reserve space for
+	 @return		PVR_SUCCESS, or the most serious allocation error.
+	*************************************************************************/
 	EPVRTError Reserve(const PVRTuint32 uiSize)
 	{
 		//Sets the capacity of each member array to the requested size. The array used will only expand.
 		//Returns the most serious error from either method.
-		return PVRT_MAX(m_Keys.SetCapacity(uiSize),m_Data.SetCapacity(uiSize));
+		EPVRTError eError = PVRT_MAX(m_Keys.SetCapacity(uiSize),m_Data.SetCapacity(uiSize));
+
+		//Size the index for the reserved members now, rather than growing it as they are added.
+		if (eError == PVR_SUCCESS && uiSize > PVRTMAP_LINEAR_SEARCH_MAX && GetSlotCountFor(uiSize) > m_Slots.GetSize())
+			eError = Rehash(GetSlotCountFor(uiSize));
+
+		return eError;
 	}
 
 	/*!***********************************************************************
@@ -62,19 +132,26 @@ public:
 	*************************************************************************/
 	PVRTuint32 GetIndexOf(const KeyType key) const
 	{
-		//Loop through all the valid keys.
-		for (PVRTuint32 i=0; i<m_uiSize; ++i)
+		//Small maps have no index, so loop through all the valid keys.
+		if (!m_Slots.GetSize())
 		{
-			//Check if a key matches.
-			if (m_Keys[i]==key)
+			for (PVRTuint32 i=0; i<m_uiSize; ++i)
 			{
-				//If a matched key is found, return the position.
-				return i;
+				//Check if a key matches.
+				if (m_Keys[i]==key)
+				{
+					//If a matched key is found, return the position.
+					return i;
+				}
 			}
+
+			//If not found, return the number of meaningful members.
+			return m_uiSize;
 		}
 
-		//If not found, return the number of meaningful members.
-		return m_uiSize;
+		//Look up the position of the key in the index. An empty slot holds no position.
+		PVRTuint32 uiEntry = m_Slots[FindSlot(key)];
+		return uiEntry ? uiEntry-1 : m_uiSize;
 	}
 
 	/*!***********************************************************************
@@ -117,7 +194,7 @@ public:
 			m_Keys.Append(key);
 
 			//Create a new DataType.
-			DataType sNewData;
+			DataType sNewData = DataType();
 
 			//Append the new pointer to the Data array.
 			m_Data.Append(sNewData);
@@ -125,8 +202,14 @@ public:
 			//Increment the size of meaningful data.
 			++m_uiSize;
 
+			//Add the new member to the index, growing it if it is more than half full.
+			if (m_Slots.GetSize() && m_uiSize*2 <= m_Slots.GetSize())
+				m_Slots[FindSlot(key)] = m_uiSize;
+			else if (m_uiSize > PVRTMAP_LINEAR_SEARCH_MAX)
+				Rehash(GetSlotCountFor(m_uiSize));
+
 			//Return the contents of pNewData.
-			return m_Data[m_Keys.GetSize()-1];
+			return m_Data[m_uiSize-1];
 		}
 	}
 
@@ -151,12 +234,22 @@ public:
 		//Decrement the size of the map to ignore the last element in each array.
 		m_uiSize--;
 
-		//Copy the last key over the deleted key. There are now two copies of one element, 
-		//but the one at the end of the array is ignored.
-		m_Keys[uiIndex]=m_Keys[m_uiSize-1];
+		//Remove the key from the index, and point the index entry of the last member,
+		//which is about to move, at the position of the deleted member.
+		if (m_Slots.GetSize())
+		{
+			RemoveSlot(FindSlot(key));
+			if (uiIndex != m_uiSize)
+				m_Slots[FindSlot(m_Keys[m_uiSize])] = uiIndex+1;
+		}
+
+		//Move the last key over the deleted key, and drop the last element of the array.
+		m_Keys[uiIndex]=m_Keys[m_uiSize];
+		m_Keys.RemoveLast();
 
-		//Copy the last data over the deleted data in the same way as the keys.
-		m_Data[uiIndex]=m_Data[m_uiSize-1];
+		//Move the last data over the deleted data in the same way as the keys.
+		m_Data[uiIndex]=m_Data[m_uiSize];
+		m_Data.RemoveLast();
 
 		//Return success.
 		return PVR_SUCCESS;
@@ -171,6 +264,7 @@ public:
 		m_uiSize=0;
 		m_Keys.Clear();
 		m_Data.Clear();
+		m_Slots.Clear();
 	}
 
 	/*!***********************************************************************
@@ -186,11 +280,95 @@ public:
 
 private:
 
-	
+	/*!***********************************************************************
+	 @brief      	Returns the number of index slots for the specified number of
+					members, which is the power of two that keeps the index no
+					more than half full.
+	 @param[in]		uiSize     Number of members
+	 @return		The number of slots.
+	*************************************************************************/
+	static PVRTuint32 GetSlotCountFor(const PVRTuint32 uiSize)
+	{
+		PVRTuint32 uiSlotCount = 2*PVRTMAP_LINEAR_SEARCH_MAX;
+		while (uiSlotCount < uiSize*2)
+			uiSlotCount <<= 1;
+		return uiSlotCount;
+	}
+
+	/*!***********************************************************************
+	 @brief      	Probes the index linearly from the home slot of the key, and
+					returns the slot that holds the key, or the empty slot at
+					which the probe stopped if the key is not in the map.
+	 @param[in]		key     Key type
+	 @return		The slot position.
+	*************************************************************************/
+	PVRTuint32 FindSlot(const KeyType& key) const
+	{
+		const PVRTuint32 uiMask = m_Slots.GetSize()-1;
+		PVRTuint32 uiSlot = PVRTMapHash<KeyType>(key) & uiMask;
+
+		while (m_Slots[uiSlot] && !(m_Keys[m_Slots[uiSlot]-1]==key))
+			uiSlot = (uiSlot+1) & uiMask;
+
+		return uiSlot;
+	}
+
+	/*!***********************************************************************
+	 @brief      	Empties an index slot, shifting back any later members of
+					the same probe sequence so that lookups still find them.
+	 @param[in]		uiSlot     The slot to empty
+	*************************************************************************/
+	void RemoveSlot(PVRTuint32 uiSlot)
+	{
+		const PVRTuint32 uiMask = m_Slots.GetSize()-1;
+		PVRTuint32 uiNext = uiSlot;
+
+		while (true)
+		{
+			uiNext = (uiNext+1) & uiMask;
+			if (!m_Slots[uiNext])
+				break;
+
+			//A member can move back to the empty slot only if its home slot does not lie
+			//cyclically after the empty slot, up to the member's current slot.
+			PVRTuint32 uiHome = PVRTMapHash<KeyType>(m_Keys[m_Slots[uiNext]-1]) & uiMask;
+			if (((uiNext - uiHome) & uiMask) >= ((uiNext - uiSlot) & uiMask))
+			{
+				m_Slots[uiSlot] = m_Slots[uiNext];
+				uiSlot = uiNext;
+			}
+		}
+
+		m_Slots[uiSlot] = 0;
+	}
+
+	/*!***********************************************************************
+	 @brief      	Rebuilds the index with the specified number of slots.
+	 @param[in]		uiSlotCount     Number of slots, a power of two
+	 @return		PVR_SUCCESS, or PVR_FAIL if the index could not be allocated.
+	*************************************************************************/
+	EPVRTError Rehash(const PVRTuint32 uiSlotCount)
+	{
+		if (m_Slots.Resize(uiSlotCount) != PVR_SUCCESS)
+		{
+			//Fall back to searching linearly.
+			m_Slots.Clear();
+			return PVR_FAIL;
+		}
+
+		memset(&m_Slots[0], 0, uiSlotCount*sizeof(PVRTuint32));
+		for (PVRTuint32 i=0; i<m_uiSize; ++i)
+			m_Slots[FindSlot(m_Keys[i])] = i+1;
+
+		return PVR_SUCCESS;
+	}
+
 	CPVRTArray<KeyType> m_Keys; /*!< Array of all the keys. Indices match m_Data. */
 
 	CPVRTArray<DataType> m_Data; /*!< Array of pointers to all the allocated data. */
 
+	CPVRTArray<PVRTuint32> m_Slots; /*!< Open-addressing index of the keys. Each slot holds the position of a member plus one, or zero if empty. Empty for small maps. */
+
 	PVRTuint32 m_uiSize; /*!< The number of meaningful members in the map. */
 };
 
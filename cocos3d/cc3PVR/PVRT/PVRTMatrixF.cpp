@@ -23,6 +23,14 @@
 #include "PVRTFixedPoint.h"		// Only needed for trig function float lookups
 #include "PVRTMatrix.h"
 
+// The SSE2 and NEON paths compute one row of a matrix product per vector
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PVRTMATRIX_SSE2
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define PVRTMATRIX_NEON
+	#include <arm_neon.h>
+#endif
 
 /****************************************************************************
 ** Constants
@@ -68,6 +76,62 @@ void PVRTMatrixMultiplyF(
 	const PVRTMATRIXf	&mA,
 	const PVRTMATRIXf	&mB)
 {
+#if defined(PVRTMATRIX_SSE2) || defined(PVRTMATRIX_NEON)
+	/*
+		Each row of the result is the sum of the rows of mB scaled by the
+		row of mA, added in the same order as the scalar code so that the
+		result is the same.
+	*/
+#if defined(PVRTMATRIX_SSE2)
+	#define PVRTMATRIX_ROW(i) \
+		_mm_add_ps(_mm_add_ps(_mm_add_ps( \
+			_mm_mul_ps(_mm_set1_ps(mA.f[4*(i)+0]), b0), \
+			_mm_mul_ps(_mm_set1_ps(mA.f[4*(i)+1]), b1)), \
+			_mm_mul_ps(_mm_set1_ps(mA.f[4*(i)+2]), b2)), \
+			_mm_mul_ps(_mm_set1_ps(mA.f[4*(i)+3]), b3))
+
+	const __m128 b0 = _mm_loadu_ps(&mB.f[ 0]);
+	const __m128 b1 = _mm_loadu_ps(&mB.f[ 4]);
+	const __m128 b2 = _mm_loadu_ps(&mB.f[ 8]);
+	const __m128 b3 = _mm_loadu_ps(&mB.f[12]);
+
+	// All rows are computed before any is stored, as mOut can be mA or mB
+	const __m128 r0 = PVRTMATRIX_ROW(0);
+	const __m128 r1 = PVRTMATRIX_ROW(1);
+	const __m128 r2 = PVRTMATRIX_ROW(2);
+	const __m128 r3 = PVRTMATRIX_ROW(3);
+
+	_mm_storeu_ps(&mOut.f[ 0], r0);
+	_mm_storeu_ps(&mOut.f[ 4], r1);
+	_mm_storeu_ps(&mOut.f[ 8], r2);
+	_mm_storeu_ps(&mOut.f[12], r3);
+#else
+	// vmlaq_f32 may be fused, so multiply and add separately
+	#define PVRTMATRIX_ROW(i) \
+		vaddq_f32(vaddq_f32(vaddq_f32( \
+			vmulq_n_f32(b0, mA.f[4*(i)+0]), \
+			vmulq_n_f32(b1, mA.f[4*(i)+1])), \
+			vmulq_n_f32(b2, mA.f[4*(i)+2])), \
+			vmulq_n_f32(b3, mA.f[4*(i)+3]))
+
+	const float32x4_t b0 = vld1q_f32(&mB.f[ 0]);
+	const float32x4_t b1 = vld1q_f32(&mB.f[ 4]);
+	const float32x4_t b2 = vld1q_f32(&mB.f[ 8]);
+	const float32x4_t b3 = vld1q_f32(&mB.f[12]);
+
+	// All rows are computed before any is stored, as mOut can be mA or mB
+	const float32x4_t r0 = PVRTMATRIX_ROW(0);
+	const float32x4_t r1 = PVRTMATRIX_ROW(1);
+	const float32x4_t r2 = PVRTMATRIX_ROW(2);
+	const float32x4_t r3 = PVRTMATRIX_ROW(3);
+
+	vst1q_f32(&mOut.f[ 0], r0);
+	vst1q_f32(&mOut.f[ 4], r1);
+	vst1q_f32(&mOut.f[ 8], r2);
+	vst1q_f32(&mOut.f[12], r3);
+#endif
+	#undef PVRTMATRIX_ROW
+#else
 	PVRTMATRIXf mRet;
 
 	/* Perform calculation on a dummy matrix (mRet) */
@@ -93,6 +157,7 @@ void PVRTMatrixMultiplyF(
 
 	/* Copy result to mOut */
 	mOut = mRet;
+#endif
 }
 
 
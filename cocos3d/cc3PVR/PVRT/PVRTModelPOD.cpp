@@ -17,6 +17,13 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #include "PVRTGlobal.h"
 #if defined(BUILD_DX11)
@@ -31,6 +38,9 @@
 //#include "PVRTMisc.h"				// patched for Cocos3D by Bill Hollings
 #include "PVRTResourceFile.h"
 #include "PVRTTrans.h"
+#include "PVRTArray.h"
+#include "PVRTParallel.h"
+#include "PVRTHash.h"
 
 /****************************************************************************
 ** Defines
@@ -41,6 +51,10 @@
 
 #define CFAH		(1024)
 
+#define PVRTMODELPOD_SCRATCH_BLOCKS	(8)		/*!< Buffers kept for reuse by each PVRTModelPODProcessMeshes() thread */
+
+#define PVRTMODELPOD_BAKE_HISTORY	"PVRTBAKE %08X %08X %08X"	/*!< History of a baked POD file: source hash, source size and flags */
+
 /****************************************************************************
 ** Enumerations
 ****************************************************************************/
@@ -167,30 +181,63 @@ enum EPODFileName
 	ePODFileDataType			= 9000,
 	ePODFileN,
 	ePODFileStride,
-	ePODFileData
+	ePODFileData,
+
+	ePODFilePadding				= 10000		/*!< Alignment padding; skipped like any unknown block */
 };
 
 /****************************************************************************
 ** Structures
 ****************************************************************************/
+struct SPODBlock;
+class CPODArena;
+
 struct SPVRTPODImpl
 {
 	VERTTYPE	fFrame;		/*!< Frame number */
 	VERTTYPE	fBlend;		/*!< Frame blend	(AKA fractional part of animation frame number) */
 	int			nFrame;		/*!< Frame number (AKA integer part of animation frame number) */
 
-	VERTTYPE	*pfCache;		/*!< Cache indicating the frames at which the matrix cache was filled */
-	PVRTMATRIX	*pWmCache;		/*!< Cache of world matrices */
+	unsigned int nWmSets;		/*!< Number of frames held by the world-matrix cache */
+	VERTTYPE	fWmQuantum;		/*!< Step the frames of the world-matrix cache are rounded to, or zero */
+	VERTTYPE	*pfSetFrame;	/*!< Frame of each set of the world-matrix cache */
+	PVRTuint64	*pnSetUsed;		/*!< Clock at which each set was last used, or zero if it is empty */
+	PVRTuint32	*pnSetGen;		/*!< Generation of each set, incremented when it is reused for another frame */
+	PVRTuint32	*pnWmGen;		/*!< Generation of its set at which each cached matrix was computed */
+	PVRTMATRIX	*pWmCache;		/*!< Cache of world matrices, nNumNode per set */
 	PVRTMATRIX	*pWmZeroCache;	/*!< Pre-calculated frame 0 matrices */
+	PVRTuint64	nWmClock;		/*!< Number of uses of the world-matrix cache, for LRU eviction */
+	SPODWorldMatrixCacheStats	sWmStats;	/*!< World-matrix cache counters */
+	unsigned int *pnNodeOrder;	/*!< Node indices, ordered so that every parent precedes its children */
 
 	bool		bFromMemory;	/*!< Was the mesh data loaded from memory? */
 
-#ifdef _DEBUG
-	PVRTint64 nWmTotal, nWmCacheHit, nWmZeroCacheHit;
-	float	fHitPerc, fHitPercZero;
-#endif
+	PVRTuint8	*pMappedFile;		/*!< Memory mapping of the POD file, if loaded with ReadFromMappedFile() */
+	size_t		nMappedFileSize;	/*!< Size of the memory mapping in bytes */
+	SPODBlock	*pMeshBlocks;		/*!< Per-mesh block locations, if the mesh data is loaded lazily */
+	CPODArena	*pArena;			/*!< Blocks the scene content was allocated from, if loaded with arena allocation */
+	bool		*pbHeapMesh;		/*!< Per-mesh flags, set when a mesh of an arena model holds heap data */
+};
+
+/*!****************************************************************************
+ @Struct      SPODBlock
+ @Brief       Location of a mesh, node or material block found by the marker
+              scan, awaiting decoding
+******************************************************************************/
+struct SPODBlock
+{
+	unsigned int	nName;		/*!< Block type: ePODFileMesh, ePODFileNode or ePODFileMaterial */
+	unsigned int	nIdx;		/*!< Index of the object within its scene array */
+	size_t			nOffset;	/*!< Offset of the block content within the source buffer */
+	size_t			nSize;		/*!< Size of the block content, including its end marker */
 };
 
+/****************************************************************************
+** Local data
+****************************************************************************/
+static unsigned int s_ui32DecodeThreads = 0;	/*!< Threads used to decode blocks; zero uses all processors */
+static bool s_bArenaAllocation = false;			/*!< Whether new models allocate their scene content from an arena */
+
 /****************************************************************************
 ** Local code: Memory allocation
 ****************************************************************************/
@@ -229,6 +276,365 @@ void SafeRealloc(T* &ptr, size_t cnt)
 	_ASSERT(ptr);
 }
 
+/*!****************************************************************************
+ @Class       CPODScratch
+ @Brief       Keeps the buffers freed by one mesh operation for the
+              allocations of the next, for PVRTModelPODProcessMeshes()
+******************************************************************************/
+class CPODScratch
+{
+public:
+	CPODScratch() : m_nBlocks(0) {}
+
+	~CPODScratch()
+	{
+		for(unsigned int i = 0; i < m_nBlocks; ++i)
+			free(m_pBlock[i]);
+	}
+
+/*!***************************************************************************
+ @Function			Alloc
+ @Input				nSize			Size of the allocation in bytes
+ @Return			Zeroed memory, to be released with free() or Free()
+ @Description		Returns the smallest kept buffer that holds nSize bytes
+					and wastes no more than nSize, or a new one.
+*****************************************************************************/
+	void *Alloc(const size_t nSize)
+	{
+		unsigned int i, nBest = m_nBlocks;
+
+		if(!nSize)
+			return NULL;
+
+		for(i = 0; i < m_nBlocks; ++i)
+		{
+			if(m_nSize[i] >= nSize && m_nSize[i] / 2 <= nSize && (nBest == m_nBlocks || m_nSize[i] < m_nSize[nBest]))
+				nBest = i;
+		}
+
+		if(nBest == m_nBlocks)
+			return calloc(nSize, 1);
+
+		void *p = m_pBlock[nBest];
+		--m_nBlocks;
+		m_pBlock[nBest]	= m_pBlock[m_nBlocks];
+		m_nSize[nBest]	= m_nSize[m_nBlocks];
+
+		memset(p, 0, nSize);
+		return p;
+	}
+
+/*!***************************************************************************
+ @Function			Free
+ @Input				p				Memory from malloc() or Alloc()
+ @Input				nSize			Number of bytes of the buffer to reuse
+ @Description		Keeps a buffer for reuse, dropping the smallest kept
+					buffer if there is no room.
+*****************************************************************************/
+	void Free(void * const p, const size_t nSize)
+	{
+		unsigned int i, nSmallest = 0;
+
+		if(!p)
+			return;
+
+		if(m_nBlocks < PVRTMODELPOD_SCRATCH_BLOCKS)
+		{
+			m_pBlock[m_nBlocks]	= p;
+			m_nSize[m_nBlocks]	= nSize;
+			++m_nBlocks;
+			return;
+		}
+
+		for(i = 1; i < m_nBlocks; ++i)
+		{
+			if(m_nSize[i] < m_nSize[nSmallest])
+				nSmallest = i;
+		}
+
+		if(m_nSize[nSmallest] >= nSize)
+		{
+			free(p);
+			return;
+		}
+
+		free(m_pBlock[nSmallest]);
+		m_pBlock[nSmallest]	= p;
+		m_nSize[nSmallest]	= nSize;
+	}
+
+private:
+	void			*m_pBlock[PVRTMODELPOD_SCRATCH_BLOCKS];	/*!< Kept buffers */
+	size_t			m_nSize[PVRTMODELPOD_SCRATCH_BLOCKS];	/*!< Usable size of each kept buffer */
+	unsigned int	m_nBlocks;								/*!< Number of kept buffers */
+};
+
+/*!***************************************************************************
+ @Function			ScratchAlloc
+ @Input				pScratch		Buffers to reuse, or NULL
+ @Output			ptr
+ @Input				cnt
+ @Return			false if memory allocation failed
+ @Description		Allocates a zeroed block of memory like SafeAlloc(),
+					reusing a buffer of pScratch if possible.
+*****************************************************************************/
+template <typename T>
+bool ScratchAlloc(CPODScratch * const pScratch, T* &ptr, size_t cnt)
+{
+	if(!pScratch)
+		return SafeAlloc(ptr, cnt);
+
+	_ASSERT(!ptr);
+	ptr = (T*) pScratch->Alloc(cnt * sizeof(T));
+	return ptr || !cnt;
+}
+
+/*!***************************************************************************
+ @Function			ScratchFree
+ @Input				pScratch		Buffers to reuse, or NULL
+ @Modified			ptr
+ @Input				cnt
+ @Description		Frees a block of memory like FREE(), or gives it to
+					pScratch for reuse.
+*****************************************************************************/
+template <typename T>
+void ScratchFree(CPODScratch * const pScratch, T* &ptr, size_t cnt)
+{
+	if(pScratch && cnt)
+	{
+		pScratch->Free(ptr, cnt * sizeof(T));
+		ptr = 0;
+	}
+	else
+	{
+		FREE(ptr);
+	}
+}
+
+/*!****************************************************************************
+ @Class       CPODArena
+ @Brief       Bump allocator holding the scene content of a model, released
+              all at once when the model is destroyed
+******************************************************************************/
+class CPODArena
+{
+public:
+/*!***************************************************************************
+ @Function			CPODArena
+ @Input				nBlockSize		Size of the first block in bytes
+ @Description		Constructor. No memory is allocated until the first
+					call to Alloc().
+*****************************************************************************/
+	CPODArena(const size_t nBlockSize)
+		: m_pHead(NULL), m_ppSorted(NULL), m_nSorted(0), m_nSortedCapacity(0), m_nBlockSize(nBlockSize)
+	{
+		memset(&m_sStats, 0, sizeof(m_sStats));
+#if !defined(_WIN32)
+		pthread_mutex_init(&m_Mutex, NULL);
+#endif
+	}
+
+	~CPODArena()
+	{
+		while(m_pHead)
+		{
+			SBlock *pNext = m_pHead->pNext;
+			free(m_pHead);
+			m_pHead = pNext;
+		}
+		free(m_ppSorted);
+#if !defined(_WIN32)
+		pthread_mutex_destroy(&m_Mutex);
+#endif
+	}
+
+/*!***************************************************************************
+ @Function			Alloc
+ @Input				nSize			Size of the allocation in bytes
+ @Return			Zeroed memory, or NULL
+ @Description		Hands out the next nSize bytes of the current block,
+					rounded up to a multiple of 16. When the block is full a
+					new one twice its size is started; allocations larger
+					than half a block get a block of their own, so that the
+					rest of the current block is not wasted. Safe to call
+					from the threads decoding blocks in parallel.
+*****************************************************************************/
+	void *Alloc(const size_t nSize)
+	{
+		const size_t nAligned = (nSize + 15) & ~(size_t) 15;
+		PVRTuint8 *p = NULL;
+
+		if(!nSize)
+			return NULL;
+
+#if !defined(_WIN32)
+		pthread_mutex_lock(&m_Mutex);
+#endif
+		SBlock *pBlock = m_pHead;
+
+		if(!pBlock || pBlock->nUsed + nAligned > pBlock->nSize)
+		{
+			const bool bOwnBlock = nAligned > m_nBlockSize / 2;
+
+			pBlock = ReserveSorted() ? (SBlock*) calloc(1, sizeof(SBlock) + (bOwnBlock ? nAligned : m_nBlockSize)) : NULL;
+			if(pBlock)
+			{
+				InsertSorted(pBlock);
+
+				pBlock->nSize	= bOwnBlock ? nAligned : m_nBlockSize;
+				pBlock->nUsed	= 0;
+
+				// Blocks of their own go behind the current block, which keeps serving small allocations
+				if(bOwnBlock && m_pHead)
+				{
+					pBlock->pNext	= m_pHead->pNext;
+					m_pHead->pNext	= pBlock;
+				}
+				else
+				{
+					pBlock->pNext	= m_pHead;
+					m_pHead			= pBlock;
+				}
+
+				if(!bOwnBlock)
+					m_nBlockSize *= 2;
+
+				++m_sStats.nBlocks;
+				m_sStats.nBytesReserved += pBlock->nSize;
+			}
+		}
+
+		if(pBlock)
+		{
+			p = pBlock->Data() + pBlock->nUsed;
+			pBlock->nUsed += nAligned;
+
+			++m_sStats.nAllocations;
+			m_sStats.nBytesUsed += nAligned;
+		}
+#if !defined(_WIN32)
+		pthread_mutex_unlock(&m_Mutex);
+#endif
+		_ASSERT(p);
+		return p;
+	}
+
+/*!***************************************************************************
+ @Function			Contains
+ @Input				pData			Pointer to test
+ @Return			true if pData was returned by Alloc()
+ @Description		Returns whether the specified data lies in one of the
+					blocks of the arena, by a binary search of the blocks in
+					address order. Must not be called while other threads
+					are allocating.
+*****************************************************************************/
+	bool Contains(const void * const pData) const
+	{
+		const PVRTuint8 *p = (const PVRTuint8*) pData;
+		size_t nLow = 0, nHigh = m_nSorted;
+
+		// Find the last block starting at or before p
+		while(nLow < nHigh)
+		{
+			const size_t nMid = (nLow + nHigh) / 2;
+			if(m_ppSorted[nMid]->Data() <= p)
+				nLow = nMid + 1;
+			else
+				nHigh = nMid;
+		}
+
+		if(!nLow)
+			return false;
+
+		const SBlock *pBlock = m_ppSorted[nLow - 1];
+		return p < pBlock->Data() + pBlock->nSize;
+	}
+
+	const SPODArenaStats &GetStats() const { return m_sStats; }
+
+private:
+	struct SBlock
+	{
+		SBlock		*pNext;		/*!< Next block, in the order they are freed */
+		size_t		nSize;		/*!< Number of bytes the block can hand out */
+		size_t		nUsed;		/*!< Number of bytes handed out so far */
+		size_t		nPad;		/*!< Keeps the block data 16-byte aligned on 32-bit hosts */
+
+		PVRTuint8 *Data() const { return (PVRTuint8*) (this + 1); }
+	};
+
+/*!***************************************************************************
+ @Function			ReserveSorted
+ @Return			false if memory allocation failed
+ @Description		Makes room in the address-ordered block index for one
+					more block.
+*****************************************************************************/
+	bool ReserveSorted()
+	{
+		if(m_nSorted < m_nSortedCapacity)
+			return true;
+
+		const size_t nCapacity = m_nSortedCapacity ? m_nSortedCapacity * 2 : 16;
+		SBlock **ppSorted = (SBlock**) realloc(m_ppSorted, nCapacity * sizeof(SBlock*));
+		if(!ppSorted)
+			return false;
+
+		m_ppSorted = ppSorted;
+		m_nSortedCapacity = nCapacity;
+		return true;
+	}
+
+/*!***************************************************************************
+ @Function			InsertSorted
+ @Input				pBlock			New block
+ @Description		Adds a block to the address-ordered block index, which
+					must have room for it.
+*****************************************************************************/
+	void InsertSorted(SBlock * const pBlock)
+	{
+		size_t nPos = m_nSorted;
+		while(nPos && m_ppSorted[nPos - 1] > pBlock)
+		{
+			m_ppSorted[nPos] = m_ppSorted[nPos - 1];
+			--nPos;
+		}
+		m_ppSorted[nPos] = pBlock;
+		++m_nSorted;
+	}
+
+	SBlock			*m_pHead;		/*!< Block currently being allocated from */
+	SBlock			**m_ppSorted;	/*!< All the blocks, in address order, for Contains() */
+	size_t			m_nSorted;		/*!< Number of blocks in m_ppSorted */
+	size_t			m_nSortedCapacity;	/*!< Number of blocks m_ppSorted has room for */
+	size_t			m_nBlockSize;	/*!< Size of the next block to allocate */
+	SPODArenaStats	m_sStats;		/*!< Memory usage counters */
+#if !defined(_WIN32)
+	pthread_mutex_t	m_Mutex;		/*!< Serialises Alloc() between decoding threads */
+#endif
+
+	CPODArena(const CPODArena&);
+	CPODArena &operator=(const CPODArena&);
+};
+
+/*!***************************************************************************
+ @Function			FreeUnlessBorrowed
+ @Input				pod
+ @Modified			ptr
+ @Description		Frees a block of scene data, unless it points directly
+					into the memory mapping of the POD file or was allocated
+					from the arena of the model, in which case the reference
+					is simply cleared. The mapping and the arena themselves
+					are released by DestroyImpl().
+*****************************************************************************/
+template <typename T>
+void FreeUnlessBorrowed(const CPVRTModelPOD &pod, T* &ptr)
+{
+	if(ptr && (pod.IsMappedData(ptr) || pod.IsArenaData(ptr)))
+		ptr = 0;
+	else
+		FREE(ptr);
+}
+
 /****************************************************************************
 ** Class: CPODData
 ****************************************************************************/
@@ -261,7 +667,16 @@ template<> struct check16BitType<short> {};
 *****************************************************************************/
 class CSource
 {
+protected:
+	CPODArena	*m_pArena;	/*!< Arena the scene content is allocated from, or NULL for the heap */
+
 public:
+	/*!***************************************************************************
+	@Function			CSource
+	@Description		Constructor
+	*****************************************************************************/
+	CSource() : m_pArena(NULL) {}
+
 	/*!***************************************************************************
 	@Function			~CSource
 	@Description		Destructor
@@ -308,10 +723,56 @@ public:
 
 	bool ReadMarker(unsigned int &nName, unsigned int &nLen);
 
+	/*!***************************************************************************
+	@Function			ReadMapped
+	@Input				nBytes			Number of bytes to read
+	@Input				nAlign			Required alignment of the returned pointer
+	@Return				Pointer to the data, or NULL if it cannot be used in place
+	@Description		Returns a pointer directly into the source for the next
+						nBytes and skips over them. Sources that cannot provide
+						data in place (or cannot satisfy the alignment) return
+						NULL and leave the read position unchanged, in which
+						case the caller should fall back to a copying read.
+	*****************************************************************************/
+	virtual PVRTuint8* ReadMapped(const unsigned int /*nBytes*/, const unsigned int /*nAlign*/) { return NULL; }
+
+	/*!***************************************************************************
+	@Function			GetBuffer
+	@Output				nReadPos		Current read position within the buffer
+	@Output				nSize			Size of the buffer
+	@Output				bInPlace		Whether data may be used in place
+	@Return				The memory backing the source, or NULL
+	@Description		Exposes the memory backing the source, if the whole source
+						is held in memory. Used to decode blocks in parallel.
+	*****************************************************************************/
+	virtual PVRTuint8* GetBuffer(size_t &/*nReadPos*/, size_t &/*nSize*/, bool &/*bInPlace*/) { return NULL; }
+
+	void SetArena(CPODArena * const pArena) { m_pArena = pArena; }
+	CPODArena *GetArena() const { return m_pArena; }
+
+	/*!***************************************************************************
+	@Function			Alloc
+	@Output				ptr
+	@Input				cnt
+	@Return				false if memory allocation failed
+	@Description		Allocates a zeroed block of memory for the content being
+						read, from the arena if one is set, or like SafeAlloc().
+	*****************************************************************************/
+	template <typename T>
+	bool Alloc(T* &ptr, size_t cnt)
+	{
+		if(!m_pArena)
+			return SafeAlloc(ptr, cnt);
+
+		_ASSERT(!ptr);
+		ptr = (T*) m_pArena->Alloc(cnt * sizeof(T));
+		return ptr || !cnt;
+	}
+
 	template <typename T>
 	bool ReadAfterAlloc(T* &lpBuffer, const unsigned int dwNumberOfBytesToRead)
 	{
-		if(!SafeAlloc(lpBuffer, dwNumberOfBytesToRead))
+		if(!Alloc(lpBuffer, dwNumberOfBytesToRead))
 			return false;
 		return Read(lpBuffer, dwNumberOfBytesToRead);
 	}
@@ -320,7 +781,7 @@ public:
 	bool ReadAfterAlloc32(T* &lpBuffer, const unsigned int dwNumberOfBytesToRead)
 	{
 		check32BitType<T>();
-		if(!SafeAlloc(lpBuffer, dwNumberOfBytesToRead/4))
+		if(!Alloc(lpBuffer, dwNumberOfBytesToRead/4))
 			return false;
 		return ReadArray32((unsigned int*) lpBuffer, dwNumberOfBytesToRead / 4);
 	}
@@ -341,7 +802,7 @@ public:
 	bool ReadAfterAlloc16(T* &lpBuffer, const unsigned int dwNumberOfBytesToRead)
 	{
 		check16BitType<T>();
-		if(!SafeAlloc(lpBuffer, dwNumberOfBytesToRead/2 ))
+		if(!Alloc(lpBuffer, dwNumberOfBytesToRead/2 ))
 			return false;
 		return ReadArray16((unsigned short*) lpBuffer, dwNumberOfBytesToRead / 2);
 	}
@@ -393,6 +854,7 @@ public:
 
 	virtual bool Read(void* lpBuffer, const unsigned int dwNumberOfBytesToRead);
 	virtual bool Skip(const unsigned int nBytes);
+	virtual PVRTuint8* GetBuffer(size_t &nReadPos, size_t &nSize, bool &bInPlace);
 };
 
 /*!***************************************************************************
@@ -486,6 +948,25 @@ bool CSourceStream::Skip(const unsigned int nBytes)
 	return true;
 }
 
+/*!***************************************************************************
+@Function			GetBuffer
+@Output				nReadPos		Current read position within the buffer
+@Output				nSize			Size of the buffer
+@Output				bInPlace		Always false; the buffer does not outlive the stream
+@Return				The file data
+@Description		Exposes the file data held by the stream.
+*****************************************************************************/
+PVRTuint8* CSourceStream::GetBuffer(size_t &nReadPos, size_t &nSize, bool &bInPlace)
+{
+	if(!m_pFile)
+		return NULL;
+
+	nReadPos	= m_BytesReadCount;
+	nSize		= m_pFile->Size();
+	bInPlace	= false;
+	return (PVRTuint8*) m_pFile->DataPtr();
+}
+
 #if defined(_WIN32)
 /*!***************************************************************************
  Class: CSourceResource
@@ -564,54 +1045,211 @@ bool CSourceResource::Skip(const unsigned int nBytes)
 
 #endif /* _WIN32 */
 
-/****************************************************************************
-** Local code: File writing
-****************************************************************************/
-
 /*!***************************************************************************
- @Function			WriteFileSafe
- @Input				pFile
- @Input				lpBuffer
- @Input				nNumberOfBytesToWrite
- @Return			true if successful
- @Description		Writes data to a file, checking return codes.
+ Class: CSourceMemory
 *****************************************************************************/
-static bool WriteFileSafe(FILE *pFile, const void * const lpBuffer, const unsigned int nNumberOfBytesToWrite)
+class CSourceMemory : public CSource
 {
-	if(nNumberOfBytesToWrite)
-	{
-		size_t count = fwrite(lpBuffer, nNumberOfBytesToWrite, 1, pFile);
-		return count == 1;
-	}
+protected:
+	PVRTuint8	*m_pData;
+	size_t		m_nSize, m_nReadPos;
+	bool		m_bInPlace;
+
+public:
+	/*!***************************************************************************
+	@Function			CSourceMemory
+	@Input				pData			Address of the source data
+	@Input				nSize			Size of the data (in bytes)
+	@Input				bInPlace		Whether data may be used in place
+	@Description		Constructor. Reads from a block of memory owned by the
+						caller. If bInPlace is true, ReadMapped() hands out
+						pointers directly into the block.
+	*****************************************************************************/
+	CSourceMemory(PVRTuint8 *pData = 0, const size_t nSize = 0, const bool bInPlace = false)
+		: m_pData(pData), m_nSize(nSize), m_nReadPos(0), m_bInPlace(bInPlace) {}
+
+	virtual bool Read(void* lpBuffer, const unsigned int dwNumberOfBytesToRead);
+	virtual bool Skip(const unsigned int nBytes);
+	virtual PVRTuint8* ReadMapped(const unsigned int nBytes, const unsigned int nAlign);
+	virtual PVRTuint8* GetBuffer(size_t &nReadPos, size_t &nSize, bool &bInPlace);
+};
+
+bool CSourceMemory::Read(void* lpBuffer, const unsigned int dwNumberOfBytesToRead)
+{
+	if(m_nReadPos + dwNumberOfBytesToRead > m_nSize)
+		return false;
+
+	_ASSERT(lpBuffer);
+	memcpy(lpBuffer, &m_pData[m_nReadPos], dwNumberOfBytesToRead);
+	m_nReadPos += dwNumberOfBytesToRead;
 	return true;
 }
 
-static bool WriteFileSafe16(FILE *pFile, const unsigned short * const lpBuffer, const unsigned int nSize)
+bool CSourceMemory::Skip(const unsigned int nBytes)
 {
-	if(nSize)
-	{
-		unsigned char ub[2];
-		bool bRet = true;
+	if(m_nReadPos + nBytes > m_nSize)
+		return false;
 
-		for(unsigned int i = 0; i < nSize; ++i)
-		{
-			ub[0] = (unsigned char) lpBuffer[i];
-			ub[1] = lpBuffer[i] >> 8;
+	m_nReadPos += nBytes;
+	return true;
+}
 
-			bRet &= (fwrite(ub, 2, 1, pFile) == 1);
-		}
+/*!***************************************************************************
+@Function			ReadMapped
+@Input				nBytes			Number of bytes to read
+@Input				nAlign			Required alignment of the returned pointer
+@Return				Pointer into the memory block, or NULL
+@Description		POD data is stored little-endian, so data can only be used
+					in place on little-endian hosts. Big-endian hosts, and
+					blocks that are not suitably aligned, fall back to a copy.
+*****************************************************************************/
+PVRTuint8* CSourceMemory::ReadMapped(const unsigned int nBytes, const unsigned int nAlign)
+{
+	if(!m_bInPlace || !nBytes || m_nReadPos + nBytes > m_nSize || !PVRTIsLittleEndian())
+		return NULL;
 
-		return bRet;
-	}
-	return true;
+	PVRTuint8 *pData = &m_pData[m_nReadPos];
+	if(nAlign > 1 && ((size_t) pData % nAlign) != 0)
+		return NULL;
+
+	m_nReadPos += nBytes;
+	return pData;
 }
 
-static bool WriteFileSafe32(FILE *pFile, const unsigned int * const lpBuffer, const unsigned int nSize)
+PVRTuint8* CSourceMemory::GetBuffer(size_t &nReadPos, size_t &nSize, bool &bInPlace)
 {
-	if(nSize)
-	{
-		unsigned char ub[4];
-		bool bRet = true;
+	nReadPos	= m_nReadPos;
+	nSize		= m_nSize;
+	bInPlace	= m_bInPlace;
+	return m_pData;
+}
+
+#if !defined(_WIN32)
+/*!***************************************************************************
+ Class: CSourceMapped
+*****************************************************************************/
+class CSourceMapped : public CSourceMemory
+{
+public:
+	/*!***************************************************************************
+	@Function			~CSourceMapped
+	@Description		Destructor. Unmaps the file unless ownership of the
+						mapping has been taken with Detach().
+	*****************************************************************************/
+	virtual ~CSourceMapped();
+
+	bool Init(const char * const pszFileName);
+	PVRTuint8* Detach(size_t &nSize);
+};
+
+CSourceMapped::~CSourceMapped()
+{
+	if(m_pData)
+		munmap(m_pData, m_nSize);
+}
+
+/*!***************************************************************************
+@Function			Init
+@Input				pszFileName		Source file
+@Description		Maps the file at the specified path into memory. The mapping
+					is private and writable, so in-place modification of the
+					data (endian fix-ups, texture coordinate flipping etc.)
+					only affects the pages that are touched, and never the file.
+*****************************************************************************/
+bool CSourceMapped::Init(const char * const pszFileName)
+{
+	if(!pszFileName)
+		return false;
+
+	int fd = open(pszFileName, O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat sStat;
+	if(fstat(fd, &sStat) != 0 || sStat.st_size <= 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	void *pMap = mmap(NULL, (size_t) sStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(pMap == MAP_FAILED)
+		return false;
+
+	m_pData		= (PVRTuint8*) pMap;
+	m_nSize		= (size_t) sStat.st_size;
+	m_nReadPos	= 0;
+	m_bInPlace	= true;
+	return true;
+}
+
+/*!***************************************************************************
+@Function			Detach
+@Output				nSize			Size of the mapping
+@Return				The mapping base address
+@Description		Hands ownership of the mapping to the caller, who becomes
+					responsible for unmapping it.
+*****************************************************************************/
+PVRTuint8* CSourceMapped::Detach(size_t &nSize)
+{
+	PVRTuint8 *pData = m_pData;
+	nSize = m_nSize;
+	m_pData = 0;
+	m_nSize = 0;
+	return pData;
+}
+#endif /* !_WIN32 */
+
+/****************************************************************************
+** Local code: File writing
+****************************************************************************/
+
+/*!***************************************************************************
+ @Function			WriteFileSafe
+ @Input				pFile
+ @Input				lpBuffer
+ @Input				nNumberOfBytesToWrite
+ @Return			true if successful
+ @Description		Writes data to a file, checking return codes.
+*****************************************************************************/
+static bool WriteFileSafe(FILE *pFile, const void * const lpBuffer, const unsigned int nNumberOfBytesToWrite)
+{
+	if(nNumberOfBytesToWrite)
+	{
+		size_t count = fwrite(lpBuffer, nNumberOfBytesToWrite, 1, pFile);
+		return count == 1;
+	}
+	return true;
+}
+
+static bool WriteFileSafe16(FILE *pFile, const unsigned short * const lpBuffer, const unsigned int nSize)
+{
+	if(nSize)
+	{
+		unsigned char ub[2];
+		bool bRet = true;
+
+		for(unsigned int i = 0; i < nSize; ++i)
+		{
+			ub[0] = (unsigned char) lpBuffer[i];
+			ub[1] = lpBuffer[i] >> 8;
+
+			bRet &= (fwrite(ub, 2, 1, pFile) == 1);
+		}
+
+		return bRet;
+	}
+	return true;
+}
+
+static bool WriteFileSafe32(FILE *pFile, const unsigned int * const lpBuffer, const unsigned int nSize)
+{
+	if(nSize)
+	{
+		unsigned char ub[4];
+		bool bRet = true;
 
 		for(unsigned int i = 0; i < nSize; ++i)
 		{
@@ -655,6 +1293,39 @@ static bool WriteMarker(
 	return bRet;
 }
 
+/*!***************************************************************************
+ @Function			WritePadding
+ @Input				pFile
+ @Input				nAlign		Alignment in bytes; zero writes nothing
+ @Return			true if successful
+ @Description		Writes a padding block, if needed, so that the content of
+					the data block written next starts at a file offset that
+					is a multiple of nAlign. Readers skip the padding block.
+*****************************************************************************/
+static bool WritePadding(FILE * const pFile, const unsigned int nAlign)
+{
+	if(nAlign <= 1)
+		return true;
+
+	const long nPos = ftell(pFile);
+
+	if(nPos < 0)
+		return false;
+
+	if((nPos + 8) % nAlign == 0)
+		return true;
+
+	// The padding block has a start and an end marker, then follows the start marker of the data block
+	const unsigned int nLen = (nAlign - (unsigned int) ((nPos + 24) % nAlign)) % nAlign;
+
+	if(!WriteMarker(pFile, ePODFilePadding, false, nLen)) return false;
+
+	for(unsigned int i = 0; i < nLen; ++i)
+		if(fputc(0, pFile) == EOF) return false;
+
+	return WriteMarker(pFile, ePODFilePadding, true);
+}
+
 /*!***************************************************************************
  @Function			WriteData
  @Input				pFile
@@ -761,6 +1432,7 @@ static bool WriteData(
  @Input				n
  @Input				nEntries
  @Input				bValidData
+ @Input				nAlign		File alignment of the data; zero for none
  @Return			true if successful
  @Description		Write the value n, bracketed by an nName begin/end markers.
 *****************************************************************************/
@@ -769,7 +1441,8 @@ static bool WriteCPODData(
 	const unsigned int	nName,
 	const CPODData		&n,
 	const unsigned int	nEntries,
-	const bool			bValidData)
+	const bool			bValidData,
+	const unsigned int	nAlign = 0)
 {
 	if(!WriteMarker(pFile, nName, false)) return false;
 	if(!WriteData32(pFile, ePODFileDataType, &n.eType)) return false;
@@ -777,6 +1450,8 @@ static bool WriteCPODData(
 	if(!WriteData32(pFile, ePODFileStride, &n.nStride)) return false;
 	if(bValidData)
 	{
+		if(n.pData && !WritePadding(pFile, nAlign)) return false;
+
 		switch(PVRTModelPODDataTypeSize(n.eType))
 		{
 			case 1: if(!WriteData(pFile, ePODFileData, n.pData, nEntries * n.nStride)) return false; break;
@@ -798,10 +1473,11 @@ static bool WriteCPODData(
  @Function			WriteInterleaved
  @Input				pFile
  @Input				mesh
+ @Input				nAlign		File alignment of the data; zero for none
  @Return			true if successful
  @Description		Write out the interleaved data to file.
 *****************************************************************************/
-static bool WriteInterleaved(FILE * const pFile, SPODMesh &mesh)
+static bool WriteInterleaved(FILE * const pFile, SPODMesh &mesh, const unsigned int nAlign = 0)
 {
 	if(!mesh.pInterleaved)
 		return true;
@@ -842,6 +1518,7 @@ static bool WriteInterleaved(FILE * const pFile, SPODMesh &mesh)
 	}
 
 	// Write out the data
+	if(!WritePadding(pFile, nAlign)) return false;
 	if(!WriteMarker(pFile, ePODFileMeshInterleaved, false, mesh.nNumVertex * mesh.sVertex.nStride)) return false;
 
 	for(i = 0; i < mesh.nNumVertex; ++i)
@@ -911,6 +1588,7 @@ PVRTuint32 PVRTModelPODGetAnimArraySize(PVRTuint32 *pAnimDataIdx, PVRTuint32 ui3
  @Output			The file referenced by pFile
  @Input				s The POD Scene to write
  @Input				pszExpOpt Exporter options
+ @Input				ui32DataAlign File alignment of mesh data; zero for none
  @Return			true if successful
  @Description		Write a POD file
 *****************************************************************************/
@@ -918,7 +1596,8 @@ static bool WritePOD(
 	FILE			* const pFile,
 	const char		* const pszExpOpt,
 	const char		* const pszHistory,
-	const SPODScene	&s)
+	const SPODScene	&s,
+	const unsigned int ui32DataAlign = 0)
 {
 	unsigned int i, j;
 
@@ -1047,7 +1726,7 @@ static bool WritePOD(
 			if(!WriteData32(pFile, ePODFileMeshNumUVW,			&s.pMesh[i].nNumUVW)) return false;
 			if(!WriteData32(pFile, ePODFileMeshStripLength,		s.pMesh[i].pnStripLength, s.pMesh[i].nNumStrips)) return false;
 			if(!WriteData32(pFile, ePODFileMeshNumStrips,		&s.pMesh[i].nNumStrips)) return false;
-			if(!WriteInterleaved(pFile, s.pMesh[i])) return false;
+			if(!WriteInterleaved(pFile, s.pMesh[i], ui32DataAlign)) return false;
 			if(!WriteData32(pFile, ePODFileMeshBoneBatchBoneMax,&s.pMesh[i].sBoneBatches.nBatchBoneMax)) return false;
 			if(!WriteData32(pFile, ePODFileMeshBoneBatchCnt,	&s.pMesh[i].sBoneBatches.nBatchCnt)) return false;
 			if(!WriteData32(pFile, ePODFileMeshBoneBatches,		s.pMesh[i].sBoneBatches.pnBatches, s.pMesh[i].sBoneBatches.nBatchBoneMax * s.pMesh[i].sBoneBatches.nBatchCnt)) return false;
@@ -1055,18 +1734,18 @@ static bool WritePOD(
 			if(!WriteData32(pFile, ePODFileMeshBoneBatchOffsets,	s.pMesh[i].sBoneBatches.pnBatchOffset,s.pMesh[i].sBoneBatches.nBatchCnt)) return false;
 			if(!WriteData32(pFile, ePODFileMeshUnpackMatrix,	s.pMesh[i].mUnpackMatrix.f, 16))	return false;
 
-			if(!WriteCPODData(pFile, ePODFileMeshFaces,			s.pMesh[i].sFaces,		PVRTModelPODCountIndices(s.pMesh[i]), true)) return false;
-			if(!WriteCPODData(pFile, ePODFileMeshVtx,			s.pMesh[i].sVertex,		s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0)) return false;
-			if(!WriteCPODData(pFile, ePODFileMeshNor,			s.pMesh[i].sNormals,	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0)) return false;
-			if(!WriteCPODData(pFile, ePODFileMeshTan,			s.pMesh[i].sTangents,	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0)) return false;
-			if(!WriteCPODData(pFile, ePODFileMeshBin,			 s.pMesh[i].sBinormals,	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0)) return false;
+			if(!WriteCPODData(pFile, ePODFileMeshFaces,			s.pMesh[i].sFaces,		PVRTModelPODCountIndices(s.pMesh[i]), true, ui32DataAlign)) return false;
+			if(!WriteCPODData(pFile, ePODFileMeshVtx,			s.pMesh[i].sVertex,		s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0, ui32DataAlign)) return false;
+			if(!WriteCPODData(pFile, ePODFileMeshNor,			s.pMesh[i].sNormals,	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0, ui32DataAlign)) return false;
+			if(!WriteCPODData(pFile, ePODFileMeshTan,			s.pMesh[i].sTangents,	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0, ui32DataAlign)) return false;
+			if(!WriteCPODData(pFile, ePODFileMeshBin,			 s.pMesh[i].sBinormals,	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0, ui32DataAlign)) return false;
 
 			for(j = 0; j < s.pMesh[i].nNumUVW; ++j)
-				if(!WriteCPODData(pFile, ePODFileMeshUVW,		s.pMesh[i].psUVW[j],	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0)) return false;
+				if(!WriteCPODData(pFile, ePODFileMeshUVW,		s.pMesh[i].psUVW[j],	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0, ui32DataAlign)) return false;
 
-			if(!WriteCPODData(pFile, ePODFileMeshVtxCol,		s.pMesh[i].sVtxColours, s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0)) return false;
-			if(!WriteCPODData(pFile, ePODFileMeshBoneIdx,		s.pMesh[i].sBoneIdx,	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0)) return false;
-			if(!WriteCPODData(pFile, ePODFileMeshBoneWeight,	s.pMesh[i].sBoneWeight,	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0)) return false;
+			if(!WriteCPODData(pFile, ePODFileMeshVtxCol,		s.pMesh[i].sVtxColours, s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0, ui32DataAlign)) return false;
+			if(!WriteCPODData(pFile, ePODFileMeshBoneIdx,		s.pMesh[i].sBoneIdx,	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0, ui32DataAlign)) return false;
+			if(!WriteCPODData(pFile, ePODFileMeshBoneWeight,	s.pMesh[i].sBoneWeight,	s.pMesh[i].nNumVertex, s.pMesh[i].pInterleaved == 0, ui32DataAlign)) return false;
 
 			if(!WriteMarker(pFile, ePODFileMesh, true)) return false;
 		}
@@ -1144,6 +1823,7 @@ static bool WritePOD(
  @Input				src CSource object to read data from.
  @Input				nSpec
  @Input				bValidData
+ @Input				bSkipData	Skip over the data itself, leaving pData NULL
  @Return			true if successful
  @Description		Read a CPODData block in  from a pod file
 *****************************************************************************/
@@ -1151,7 +1831,8 @@ static bool ReadCPODData(
 	CPODData			&s,
 	CSource				&src,
 	const unsigned int	nSpec,
-	const bool			bValidData)
+	const bool			bValidData,
+	const bool			bSkipData = false)
 {
 	unsigned int nName, nLen, nBuff;
 
@@ -1166,8 +1847,15 @@ static bool ReadCPODData(
 		case ePODFileN:			if(!src.Read32(s.n)) return false;						break;
 		case ePODFileStride:	if(!src.Read32(s.nStride)) return false;					break;
 		case ePODFileData:
-			if(bValidData)
+			if(bSkipData)
+			{
+				if(!src.Skip(nLen)) return false;
+			}
+			else if(bValidData)
 			{
+				if((s.pData = src.ReadMapped(nLen, PVRTModelPODDataTypeSize(s.eType))) != NULL)
+					break;
+
 				switch(PVRTModelPODDataTypeSize(s.eType))
 				{
 					case 1: if(!src.ReadAfterAlloc(s.pData, nLen)) return false; break;
@@ -1447,15 +2135,20 @@ static void PVRTFixInterleavedEndianness(SPODMesh &s)
  @Function			ReadMesh
  @Modified			s The SPODMesh to read into
  @Input				src	CSource object to read data from.
+ @Input				bSkipData	Skip over the face, vertex and interleaved data
  @Return			true if successful
- @Description		Read a mesh block in from a pod file
+ @Description		Read a mesh block in from a pod file. If bSkipData is set,
+					only the description of the mesh is read, and its face and
+					vertex data pointers are left NULL.
 *****************************************************************************/
 static bool ReadMesh(
 	SPODMesh	&s,
-	CSource		&src)
+	CSource		&src,
+	const bool	bSkipData = false)
 {
 	unsigned int	nName, nLen;
 	unsigned int	nUVWs=0;
+	bool			bInterleaved = false;
 
 	PVRTMatrixIdentity(s.mUnpackMatrix);
 
@@ -1471,10 +2164,19 @@ static bool ReadMesh(
 
 		case ePODFileMeshNumVtx:			if(!src.Read32(s.nNumVertex)) return false;													break;
 		case ePODFileMeshNumFaces:			if(!src.Read32(s.nNumFaces)) return false;													break;
-		case ePODFileMeshNumUVW:			if(!src.Read32(s.nNumUVW)) return false;	if(!SafeAlloc(s.psUVW, s.nNumUVW)) return false;	break;
+		case ePODFileMeshNumUVW:			if(!src.Read32(s.nNumUVW)) return false;	if(!src.Alloc(s.psUVW, s.nNumUVW)) return false;	break;
 		case ePODFileMeshStripLength:		if(!src.ReadAfterAlloc32(s.pnStripLength, nLen)) return false;								break;
 		case ePODFileMeshNumStrips:			if(!src.Read32(s.nNumStrips)) return false;													break;
-		case ePODFileMeshInterleaved:		if(!src.ReadAfterAlloc(s.pInterleaved, nLen)) return false;									break;
+		case ePODFileMeshInterleaved:
+			if(bSkipData)
+			{
+				if(!src.Skip(nLen)) return false;
+				bInterleaved = nLen != 0;
+				break;
+			}
+			if(!(s.pInterleaved = src.ReadMapped(nLen, 4)) && !src.ReadAfterAlloc(s.pInterleaved, nLen)) return false;
+			bInterleaved = s.pInterleaved != 0;
+			break;
 		case ePODFileMeshBoneBatches:		if(!src.ReadAfterAlloc32(s.sBoneBatches.pnBatches, nLen)) return false;						break;
 		case ePODFileMeshBoneBatchBoneCnts:	if(!src.ReadAfterAlloc32(s.sBoneBatches.pnBatchBoneCnt, nLen)) return false;					break;
 		case ePODFileMeshBoneBatchOffsets:	if(!src.ReadAfterAlloc32(s.sBoneBatches.pnBatchOffset, nLen)) return false;					break;
@@ -1482,15 +2184,15 @@ static bool ReadMesh(
 		case ePODFileMeshBoneBatchCnt:		if(!src.Read32(s.sBoneBatches.nBatchCnt)) return false;										break;
 		case ePODFileMeshUnpackMatrix:		if(!src.ReadArray32(&s.mUnpackMatrix.f[0], 16)) return false;										break;
 
-		case ePODFileMeshFaces:			if(!ReadCPODData(s.sFaces, src, ePODFileMeshFaces, true)) return false;							break;
-		case ePODFileMeshVtx:			if(!ReadCPODData(s.sVertex, src, ePODFileMeshVtx, s.pInterleaved == 0)) return false;			break;
-		case ePODFileMeshNor:			if(!ReadCPODData(s.sNormals, src, ePODFileMeshNor, s.pInterleaved == 0)) return false;			break;
-		case ePODFileMeshTan:			if(!ReadCPODData(s.sTangents, src, ePODFileMeshTan, s.pInterleaved == 0)) return false;			break;
-		case ePODFileMeshBin:			if(!ReadCPODData(s.sBinormals, src, ePODFileMeshBin, s.pInterleaved == 0)) return false;			break;
-		case ePODFileMeshUVW:			if(!ReadCPODData(s.psUVW[nUVWs++], src, ePODFileMeshUVW, s.pInterleaved == 0)) return false;		break;
-		case ePODFileMeshVtxCol:		if(!ReadCPODData(s.sVtxColours, src, ePODFileMeshVtxCol, s.pInterleaved == 0)) return false;		break;
-		case ePODFileMeshBoneIdx:		if(!ReadCPODData(s.sBoneIdx, src, ePODFileMeshBoneIdx, s.pInterleaved == 0)) return false;		break;
-		case ePODFileMeshBoneWeight:	if(!ReadCPODData(s.sBoneWeight, src, ePODFileMeshBoneWeight, s.pInterleaved == 0)) return false;	break;
+		case ePODFileMeshFaces:			if(!ReadCPODData(s.sFaces, src, ePODFileMeshFaces, true, bSkipData)) return false;							break;
+		case ePODFileMeshVtx:			if(!ReadCPODData(s.sVertex, src, ePODFileMeshVtx, !bInterleaved, bSkipData)) return false;			break;
+		case ePODFileMeshNor:			if(!ReadCPODData(s.sNormals, src, ePODFileMeshNor, !bInterleaved, bSkipData)) return false;			break;
+		case ePODFileMeshTan:			if(!ReadCPODData(s.sTangents, src, ePODFileMeshTan, !bInterleaved, bSkipData)) return false;			break;
+		case ePODFileMeshBin:			if(!ReadCPODData(s.sBinormals, src, ePODFileMeshBin, !bInterleaved, bSkipData)) return false;			break;
+		case ePODFileMeshUVW:			if(!ReadCPODData(s.psUVW[nUVWs++], src, ePODFileMeshUVW, !bInterleaved, bSkipData)) return false;		break;
+		case ePODFileMeshVtxCol:		if(!ReadCPODData(s.sVtxColours, src, ePODFileMeshVtxCol, !bInterleaved, bSkipData)) return false;		break;
+		case ePODFileMeshBoneIdx:		if(!ReadCPODData(s.sBoneIdx, src, ePODFileMeshBoneIdx, !bInterleaved, bSkipData)) return false;		break;
+		case ePODFileMeshBoneWeight:	if(!ReadCPODData(s.sBoneWeight, src, ePODFileMeshBoneWeight, !bInterleaved, bSkipData)) return false;	break;
 
 		default:
 			if(!src.Skip(nLen)) return false;
@@ -1531,7 +2233,7 @@ static bool ReadNode(
 					s.nAnimFlags |= ePODHasPositionAni;
 				else
 				{
-					s.pfAnimPosition = (VERTTYPE*) malloc(sizeof(fPos));
+					if(!src.Alloc(s.pfAnimPosition, sizeof(fPos) / sizeof(*fPos))) return false;
 					memcpy(s.pfAnimPosition, fPos, sizeof(fPos));
 				}
 
@@ -1539,7 +2241,7 @@ static bool ReadNode(
 					s.nAnimFlags |= ePODHasRotationAni;
 				else
 				{
-					s.pfAnimRotation = (VERTTYPE*) malloc(sizeof(fQuat));
+					if(!src.Alloc(s.pfAnimRotation, sizeof(fQuat) / sizeof(*fQuat))) return false;
 					memcpy(s.pfAnimRotation, fQuat, sizeof(fQuat));
 				}
 
@@ -1547,7 +2249,7 @@ static bool ReadNode(
 					s.nAnimFlags |= ePODHasScaleAni;
 				else
 				{
-					s.pfAnimScale = (VERTTYPE*) malloc(sizeof(fScale));
+					if(!src.Alloc(s.pfAnimScale, sizeof(fScale) / sizeof(*fScale))) return false;
 					memcpy(s.pfAnimScale, fScale, sizeof(fScale));
 				}
 			}
@@ -1621,16 +2323,123 @@ static bool ReadTexture(
 	return false;
 }
 
+/*!***************************************************************************
+ @Function			DeferBlock
+ @Modified			blocks	Array to record the block in
+ @Input				nName	Block type
+ @Input				nIdx	Index of the object within its scene array
+ @Modified			src		CSource object positioned at the block content
+ @Return			true if successful
+ @Description		Records the location of a block and skips over it without
+					decoding it. Container start markers carry no length, so
+					a linear walk over the markers finds the end marker.
+*****************************************************************************/
+static bool DeferBlock(
+	CPVRTArray<SPODBlock>	&blocks,
+	const unsigned int		nName,
+	const unsigned int		nIdx,
+	CSource					&src)
+{
+	size_t nStart, nEnd, nSize;
+	bool bInPlace;
+	unsigned int nMarker, nLen;
+
+	if(!src.GetBuffer(nStart, nSize, bInPlace))
+		return false;
+
+	while(src.ReadMarker(nMarker, nLen))
+	{
+		if(nMarker == (nName | PVRTMODELPOD_TAG_END))
+		{
+			src.GetBuffer(nEnd, nSize, bInPlace);
+
+			SPODBlock &block = blocks[blocks.Append()];
+			block.nName		= nName;
+			block.nIdx		= nIdx;
+			block.nOffset	= nStart;
+			block.nSize		= nEnd - nStart;
+			return true;
+		}
+
+		if(!src.Skip(nLen))
+			return false;
+	}
+	return false;
+}
+
+/*!****************************************************************************
+ @Struct      SPODDecodeJob
+ @Brief       Shared state for decoding deferred blocks in parallel
+******************************************************************************/
+struct SPODDecodeJob
+{
+	SPODScene			*pScene;	/*!< Scene being loaded */
+	const SPODBlock		*pBlocks;	/*!< Blocks to decode */
+	PVRTuint8			*pBuffer;	/*!< Buffer the block offsets refer to */
+	bool				bInPlace;	/*!< Whether data may be used in place */
+	bool				bSkipMeshData;	/*!< Whether to decode only the mesh descriptions */
+	CPODArena			*pArena;	/*!< Arena to allocate the decoded content from, or NULL */
+	volatile bool		bFailed;	/*!< Set if any block fails to decode */
+};
+
+/*!***************************************************************************
+ @Function			DecodeBlock
+ @Input				pUserData	The SPODDecodeJob
+ @Input				ui32Index	Index of the block to decode
+ @Description		Decodes one deferred block into its scene array entry. Each
+					block is decoded by the same function the serial loader
+					uses, from its own view of the buffer.
+*****************************************************************************/
+static void DecodeBlock(void *pUserData, const unsigned int ui32Index)
+{
+	SPODDecodeJob &job = *(SPODDecodeJob*) pUserData;
+	const SPODBlock &block = job.pBlocks[ui32Index];
+	CSourceMemory src(job.pBuffer + block.nOffset, block.nSize, job.bInPlace);
+	bool bOK = false;
+
+	src.SetArena(job.pArena);
+
+	switch(block.nName)
+	{
+	case ePODFileMesh:		bOK = ReadMesh(job.pScene->pMesh[block.nIdx], src, job.bSkipMeshData);	break;
+	case ePODFileNode:		bOK = ReadNode(job.pScene->pNode[block.nIdx], src);			break;
+	case ePODFileMaterial:	bOK = ReadMaterial(job.pScene->pMaterial[block.nIdx], src);	break;
+	}
+
+	if(!bOK)
+		job.bFailed = true;
+}
+
+/*!***************************************************************************
+ @Function			CompareBlockSize
+ @Description		qsort comparator placing the largest blocks first, so the
+					biggest meshes start decoding before the small blocks.
+*****************************************************************************/
+static int CompareBlockSize(const void *pA, const void *pB)
+{
+	const size_t nA = ((const SPODBlock*) pA)->nSize, nB = ((const SPODBlock*) pB)->nSize;
+	return nA > nB ? -1 : (nA < nB ? 1 : 0);
+}
+
 /*!***************************************************************************
  @Function			ReadScene
  @Modified			s The SPODScene to read into
  @Input				src	CSource object to read data from.
+ @Output			pLazyMeshes	If not NULL, receives the location of each mesh
+								block, whose face and vertex data is then
+								not decoded
  @Return			true if successful
- @Description		Read a scene block in from a pod file
+ @Description		Read a scene block in from a pod file. If the source is held
+					in memory and more than one decode thread is available, the
+					mesh, node and material blocks are only located during the
+					scan of the scene, and are then decoded in parallel.
+					Mesh data can only be left for later decoding if the source
+					data is used in place.
 *****************************************************************************/
 static bool ReadScene(
-	SPODScene	&s,
-	CSource		&src)
+	SPODScene				&s,
+	CSource					&src,
+	CPVRTArray<SPODBlock>	* const pLazyMeshes = NULL)
 {
 	unsigned int nName, nLen;
 	unsigned int nCameras=0, nLights=0, nMaterials=0, nMeshes=0, nTextures=0, nNodes=0;
@@ -1641,6 +2450,15 @@ static bool ReadScene(
 	s.pUserData = 0;
 	s.nUserDataSize = 0;
 
+	// Decide whether to defer mesh, node and material blocks for parallel decoding
+	size_t nReadPos, nSize;
+	bool bInPlace;
+	PVRTuint8 *pBuffer = src.GetBuffer(nReadPos, nSize, bInPlace);
+	unsigned int ui32Threads = s_ui32DecodeThreads ? s_ui32DecodeThreads : PVRTParallelThreadCount();
+	CPVRTArray<SPODBlock> blocks;
+	const bool bLazyMeshes = pLazyMeshes && pBuffer && bInPlace;
+	CPVRTArray<SPODBlock> * const pDeferred = (pBuffer && (ui32Threads > 1 || bLazyMeshes)) ? &blocks : NULL;
+
 	while(src.ReadMarker(nName, nLen))
 	{
 		switch(nName)
@@ -1652,27 +2470,58 @@ static bool ReadScene(
 			if(nMeshes		!= s.nNumMesh) return false;
 			if(nTextures	!= s.nNumTexture) return false;
 			if(nNodes		!= s.nNumNode) return false;
+
+			if(pDeferred && blocks.GetSize())
+			{
+				SPODDecodeJob job;
+				job.pScene		= &s;
+				job.pBlocks		= &blocks[0];
+				job.pBuffer		= pBuffer;
+				job.bInPlace	= bInPlace;
+				job.pArena		= src.GetArena();
+				job.bSkipMeshData	= bLazyMeshes;
+				job.bFailed		= false;
+
+				qsort(&blocks[0], blocks.GetSize(), sizeof(SPODBlock), CompareBlockSize);
+				PVRTParallelFor(blocks.GetSize(), &DecodeBlock, &job, ui32Threads);
+
+				if(job.bFailed)
+					return false;
+
+				if(bLazyMeshes)
+				{
+					for(unsigned int i = 0; i < blocks.GetSize(); ++i)
+						if(blocks[i].nName == ePODFileMesh)
+							pLazyMeshes->Append(blocks[i]);
+				}
+			}
 			return true;
 			
 		case ePODFileUnits:				if(!src.Read32(s.fUnits))	return false;				break;
 		case ePODFileColourBackground:	if(!src.ReadArray32(&s.pfColourBackground[0], sizeof(s.pfColourBackground) / sizeof(*s.pfColourBackground))) return false;	break;
 		case ePODFileColourAmbient:		if(!src.ReadArray32(&s.pfColourAmbient[0], sizeof(s.pfColourAmbient) / sizeof(*s.pfColourAmbient))) return false;		break;
-		case ePODFileNumCamera:			if(!src.Read32(s.nNumCamera)) return false;			if(!SafeAlloc(s.pCamera, s.nNumCamera)) return false;		break;
-		case ePODFileNumLight:			if(!src.Read32(s.nNumLight)) return false;			if(!SafeAlloc(s.pLight, s.nNumLight)) return false;			break;
-		case ePODFileNumMesh:			if(!src.Read32(s.nNumMesh)) return false;				if(!SafeAlloc(s.pMesh, s.nNumMesh)) return false;			break;
-		case ePODFileNumNode:			if(!src.Read32(s.nNumNode)) return false;				if(!SafeAlloc(s.pNode, s.nNumNode)) return false;			break;
+		case ePODFileNumCamera:			if(!src.Read32(s.nNumCamera)) return false;			if(!src.Alloc(s.pCamera, s.nNumCamera)) return false;		break;
+		case ePODFileNumLight:			if(!src.Read32(s.nNumLight)) return false;			if(!src.Alloc(s.pLight, s.nNumLight)) return false;			break;
+		case ePODFileNumMesh:			if(!src.Read32(s.nNumMesh)) return false;				if(!src.Alloc(s.pMesh, s.nNumMesh)) return false;			break;
+		case ePODFileNumNode:			if(!src.Read32(s.nNumNode)) return false;				if(!src.Alloc(s.pNode, s.nNumNode)) return false;			break;
 		case ePODFileNumMeshNode:		if(!src.Read32(s.nNumMeshNode)) return false;			break;
-		case ePODFileNumTexture:		if(!src.Read32(s.nNumTexture)) return false;			if(!SafeAlloc(s.pTexture, s.nNumTexture)) return false;		break;
-		case ePODFileNumMaterial:		if(!src.Read32(s.nNumMaterial)) return false;			if(!SafeAlloc(s.pMaterial, s.nNumMaterial)) return false;	break;
+		case ePODFileNumTexture:		if(!src.Read32(s.nNumTexture)) return false;			if(!src.Alloc(s.pTexture, s.nNumTexture)) return false;		break;
+		case ePODFileNumMaterial:		if(!src.Read32(s.nNumMaterial)) return false;			if(!src.Alloc(s.pMaterial, s.nNumMaterial)) return false;	break;
 		case ePODFileNumFrame:			if(!src.Read32(s.nNumFrame)) return false;			break;
 		case ePODFileFPS:				if(!src.Read32(s.nFPS))	return false;				break;
 		case ePODFileFlags:				if(!src.Read32(s.nFlags)) return false;				break;
 
 		case ePODFileCamera:	if(!ReadCamera(s.pCamera[nCameras++], src)) return false;		break;
 		case ePODFileLight:		if(!ReadLight(s.pLight[nLights++], src)) return false;			break;
-		case ePODFileMaterial:	if(!ReadMaterial(s.pMaterial[nMaterials++], src)) return false;	break;
-		case ePODFileMesh:		if(!ReadMesh(s.pMesh[nMeshes++], src)) return false;			break;
-		case ePODFileNode:		if(!ReadNode(s.pNode[nNodes++], src)) return false;				break;
+		case ePODFileMaterial:
+			if(pDeferred ? !DeferBlock(blocks, ePODFileMaterial, nMaterials++, src) : !ReadMaterial(s.pMaterial[nMaterials++], src)) return false;
+			break;
+		case ePODFileMesh:
+			if(pDeferred ? !DeferBlock(blocks, ePODFileMesh, nMeshes++, src) : !ReadMesh(s.pMesh[nMeshes++], src)) return false;
+			break;
+		case ePODFileNode:
+			if(pDeferred ? !DeferBlock(blocks, ePODFileNode, nNodes++, src) : !ReadNode(s.pNode[nNodes++], src)) return false;
+			break;
 		case ePODFileTexture:	if(!ReadTexture(s.pTexture[nTextures++], src)) return false;	break;
 
 		case ePODFileUserData:
@@ -1699,6 +2548,8 @@ static bool ReadScene(
  @Input				count			Data size.
  @Output			pszHistory		Export history.
  @Input				historyCount	History data size.
+ @Output			pLazyMeshes		Mesh block locations, if the mesh data
+									is to be decoded later. May be NULL.
  @Description		Loads the specified ".POD" file; returns the scene in
 					pScene. This structure must later be destroyed with
 					PVRTModelPODDestroy() to prevent memory leaks.
@@ -1712,7 +2563,8 @@ static bool Read(
 	char			* const pszExpOpt,
 	const size_t	count,
 	char			* const pszHistory,
-	const size_t	historyCount)
+	const size_t	historyCount,
+	CPVRTArray<SPODBlock> * const pLazyMeshes = NULL)
 {
 	unsigned int	nName, nLen;
 	bool			bVersionOK = false, bDone = false;
@@ -1739,7 +2591,7 @@ static bool Read(
 		case ePODFileScene:
 			if(pS)
 			{
-				if(!ReadScene(*pS, src))
+				if(!ReadScene(*pS, src, pLazyMeshes))
 					return false;
 				bDone = true;
 			}
@@ -1817,6 +2669,51 @@ static bool Read(
 	return bVersionOK == true && bDone == true;
 }
 
+/*!***************************************************************************
+ @Function			CreateArena
+ @Modified			src				CSource object the scene will be read from
+ @Return			The arena, or NULL if arena allocation is disabled
+ @Description		Creates the arena of a model about to be read from src,
+					if SetArenaAllocation() is enabled, and has src allocate
+					from it. The first block is sized after the source data,
+					which is largely copied unless it is used in place.
+*****************************************************************************/
+static CPODArena *CreateArena(CSource &src)
+{
+	size_t nReadPos = 0, nSize = 0;
+	bool bInPlace = false;
+
+	if(!s_bArenaAllocation)
+		return NULL;
+
+	src.GetBuffer(nReadPos, nSize, bInPlace);
+
+	CPODArena * const pArena = new CPODArena(PVRT_MAX((size_t) PVRTMODELPOD_ARENA_BLOCK_SIZE, bInPlace ? nSize / 8 : nSize));
+	src.SetArena(pArena);
+	return pArena;
+}
+
+/*!***************************************************************************
+ @Function			AttachArena
+ @Modified			impl			Implementation data of the model
+ @Input				pArena			Arena the model was read into, or NULL
+ @Input				nNumMesh		Number of meshes of the model
+ @Description		Hands the arena over to the model, with the flags that
+					record which of its meshes have since been moved to the
+					heap. The flags are allocated up front, so that meshes
+					can be loaded and unmapped from several threads.
+*****************************************************************************/
+static void AttachArena(SPVRTPODImpl &impl, CPODArena * const pArena, const unsigned int nNumMesh)
+{
+	impl.pArena = pArena;
+
+	if(pArena && nNumMesh && !impl.pbHeapMesh)
+	{
+		impl.pbHeapMesh = new bool[nNumMesh];
+		memset(impl.pbHeapMesh, 0, nNumMesh * sizeof(bool));
+	}
+}
+
 /*!***************************************************************************
  @Function			ReadFromSourceStream
  @Output			pS				CPVRTModelPOD data. May not be NULL.
@@ -1847,79 +2744,426 @@ static EPVRTError ReadFromSourceStream(
 }
 
 /****************************************************************************
-** Class: CPVRTModelPOD
+** Local code: World matrices
 ****************************************************************************/
 
 /*!***************************************************************************
- @Function			ReadFromFile
- @Input				pszFileName		Filename to load
- @Output			pszExpOpt		String in which to place exporter options
- @Input				count			Maximum number of characters to store.
- @Output			pszHistory		String in which to place the pod file history
- @Input				historyCount	Maximum number of characters to store.
- @Return			PVR_SUCCESS if successful, PVR_FAIL if not
- @Description		Loads the specified ".POD" file; returns the scene in
-					pScene. This structure must later be destroyed with
-					PVRTModelPODDestroy() to prevent memory leaks.
-					".POD" files are exported using the PVRGeoPOD exporters.
-					If pszExpOpt is NULL, the scene is loaded; otherwise the
-					scene is not loaded and pszExpOpt is filled in. The same
-					is true for pszHistory.
+ @Function			GetLocalMatrix
+ @Input				pod				Model the node belongs to
+ @Output			mOut			Local matrix
+ @Input				node			Node to get the local matrix from
+ @Description		Generates the transformation of a node relative to its
+					parent, at the current frame of the model.
 *****************************************************************************/
-EPVRTError CPVRTModelPOD::ReadFromFile(
-	const char		* const pszFileName,
-	char			* const pszExpOpt,
-	const size_t	count,
-	char			* const pszHistory,
-	const size_t	historyCount)
+static void GetLocalMatrix(
+	const CPVRTModelPOD	&pod,
+	PVRTMATRIX			&mOut,
+	const SPODNode		&node)
 {
-	CSourceStream src;
+	PVRTMATRIX mTmp;
 
-	if(!src.Init(pszFileName))
-		return PVR_FAIL;
+	if(node.pfAnimMatrix) // The transformations are stored as matrices
+		pod.GetTransformationMatrix(mOut, node);
+	else
+	{
+		// Scale
+		pod.GetScalingMatrix(mOut, node);
+
+		// Rotation
+		pod.GetRotationMatrix(mTmp, node);
+		PVRTMatrixMultiply(mOut, mOut, mTmp);
 
-	return ReadFromSourceStream(this, src, pszExpOpt, count, pszHistory, historyCount);
+		// Translation
+		pod.GetTranslationMatrix(mTmp, node);
+		PVRTMatrixMultiply(mOut, mOut, mTmp);
+	}
 }
 
 /*!***************************************************************************
- @Function			ReadFromMemory
- @Input				pData			Data to load
- @Input				i32Size			Size of data
- @Output			pszExpOpt		String in which to place exporter options
- @Input				count			Maximum number of characters to store.
- @Output			pszHistory		String in which to place the pod file history
- @Input				historyCount	Maximum number of characters to store.
- @Return			PVR_SUCCESS if successful, PVR_FAIL if not
- @Description		Loads the supplied pod data. This data can be exported
-					directly to a header using one of the pod exporters.
-					If pszExpOpt is NULL, the scene is loaded; otherwise the
-					scene is not loaded and pszExpOpt is filled in. The same
-					is true for pszHistory.
+ @Function			SortNodesByDepth
+ @Output			pnOrder			Node indices, parents first
+ @Input				pNode			Nodes
+ @Input				nNumNode		Number of nodes
+ @Description		Orders the nodes by their depth in the hierarchy, so that
+					every parent precedes its children and the world matrices
+					can be computed in a single pass. Nodes of equal depth
+					keep their file order.
 *****************************************************************************/
-EPVRTError CPVRTModelPOD::ReadFromMemory(
-	const char		* pData,
-	const size_t	i32Size,
-	char			* const pszExpOpt,
-	const size_t	count,
-	char			* const pszHistory,
-	const size_t	historyCount)
+static void SortNodesByDepth(
+	unsigned int		* const pnOrder,
+	const SPODNode		* const pNode,
+	const unsigned int	nNumNode)
 {
-	CSourceStream src;
+	unsigned int *pnDepth = new unsigned int[nNumNode];
+	unsigned int *pnCount = new unsigned int[nNumNode + 1];
+	unsigned int i, j, nDepth;
 
-	if(!src.Init(pData, i32Size))
-		return PVR_FAIL;
+	// Walk up to the root, or to the first ancestor whose depth is known
+	for(i = 0; i < nNumNode; ++i)
+		pnDepth[i] = 0xFFFFFFFF;
+
+	for(i = 0; i < nNumNode; ++i)
+	{
+		nDepth = 0;
+		for(j = i; pNode[j].nIdxParent >= 0 && pnDepth[j] == 0xFFFFFFFF && nDepth < nNumNode; j = pNode[j].nIdxParent)
+			++nDepth;
 
-	return ReadFromSourceStream(this, src, pszExpOpt, count, pszHistory, historyCount);
+		nDepth += pnDepth[j] == 0xFFFFFFFF ? 0 : pnDepth[j];
+
+		// Parents that form a loop cannot be ordered, but must not overflow the count
+		if(nDepth >= nNumNode)
+			nDepth = nNumNode - 1;
+
+		// Fill in the depths of the nodes just walked
+		for(j = i; pnDepth[j] == 0xFFFFFFFF; j = pNode[j].nIdxParent)
+		{
+			pnDepth[j] = nDepth ? nDepth-- : 0;
+			if(pNode[j].nIdxParent < 0)
+				break;
+		}
+	}
+
+	// Counting sort by depth
+	memset(pnCount, 0, (nNumNode + 1) * sizeof(*pnCount));
+	for(i = 0; i < nNumNode; ++i)
+		++pnCount[pnDepth[i] + 1];
+
+	for(i = 1; i <= nNumNode; ++i)
+		pnCount[i] += pnCount[i - 1];
+
+	for(i = 0; i < nNumNode; ++i)
+		pnOrder[pnCount[pnDepth[i]]++] = i;
+
+	delete [] pnCount;
+	delete [] pnDepth;
 }
 
 /*!***************************************************************************
- @Function			ReadFromMemory
- @Input				scene			Scene data from the header file
- @Return			PVR_SUCCESS if successful, PVR_FAIL if not
- @Description		Sets the scene data from the supplied data structure. Use
-					when loading from .H files.
+ @Function			EvaluateFrame
+ @Input				pod				Model to evaluate
+ @Input				pnOrder			Node indices, parents first
+ @Output			pmWorld			World matrix of each node
+ @Input				pmInstance		Matrix to apply to the root nodes, or NULL
+ @Description		Computes the world matrices of all the nodes at the
+					current frame of the model, in one pass over the nodes
+					in hierarchy order. Each parent's world matrix is
+					computed once and reused by all of its children.
 *****************************************************************************/
-EPVRTError CPVRTModelPOD::ReadFromMemory(
+static void EvaluateFrame(
+	const CPVRTModelPOD		&pod,
+	const unsigned int		* const pnOrder,
+	PVRTMATRIX				* const pmWorld,
+	const PVRTMATRIX		* const pmInstance)
+{
+	for(unsigned int i = 0; i < pod.nNumNode; ++i)
+	{
+		const unsigned int	nIdx = pnOrder[i];
+		const SPODNode		&node = pod.pNode[nIdx];
+
+		GetLocalMatrix(pod, pmWorld[nIdx], node);
+
+		if(node.nIdxParent >= 0)
+			PVRTMatrixMultiply(pmWorld[nIdx], pmWorld[nIdx], pmWorld[node.nIdxParent]);
+		else if(pmInstance)
+			PVRTMatrixMultiply(pmWorld[nIdx], pmWorld[nIdx], *pmInstance);
+	}
+}
+
+/*!***************************************************************************
+ @Function			SetImplFrame
+ @Modified			impl			Implementation data
+ @Input				nNumFrame		Number of frames of animation
+ @Input				fFrame			Frame number
+ @Description		Sets the frame that the Get*() functions use.
+*****************************************************************************/
+static void SetImplFrame(
+	SPVRTPODImpl		&impl,
+	const unsigned int	nNumFrame,
+	const VERTTYPE		fFrame)
+{
+	if(nNumFrame) {
+		/*
+			Limit animation frames.
+
+			Example: If there are 100 frames of animation, the highest frame
+			number allowed is 98, since that will blend between frames 98 and
+			99. (99 being of course the 100th frame.)
+		*/
+		_ASSERT(fFrame <= f2vt((float)(nNumFrame-1)));
+		impl.nFrame = (int)vt2f(fFrame);
+		impl.fBlend = fFrame - f2vt(impl.nFrame);
+	}
+	else
+	{
+		impl.fBlend = 0;
+		impl.nFrame = 0;
+	}
+
+	impl.fFrame = fFrame;
+}
+
+/*!***************************************************************************
+ @Function			QuantizeFrame
+ @Input				impl			Implementation data
+ @Input				nNumFrame		Number of frames of animation
+ @Input				fFrame			Frame number
+ @Return			The frame the world-matrix cache keys fFrame by
+ @Description		Rounds a frame to the nearest multiple of the quantum of
+					the world-matrix cache, if it has one.
+*****************************************************************************/
+static VERTTYPE QuantizeFrame(
+	const SPVRTPODImpl	&impl,
+	const unsigned int	nNumFrame,
+	const VERTTYPE		fFrame)
+{
+	if(impl.fWmQuantum <= 0)
+		return fFrame;
+
+	const float fQuantum = vt2f(impl.fWmQuantum);
+	float fKey = floorf(vt2f(fFrame) / fQuantum + 0.5f) * fQuantum;
+
+	// The last frame can only be blended towards, so do not round up to it
+	if(nNumFrame && fKey > vt2f(fFrame) && fKey >= (float)(nNumFrame - 1))
+		fKey = floorf(vt2f(fFrame) / fQuantum) * fQuantum;
+
+	return f2vt(fKey);
+}
+
+/*!***************************************************************************
+ @Function			FindWorldMatrixSet
+ @Modified			impl			Implementation data
+ @Input				nNumNode		Number of nodes
+ @Input				fKey			Quantized frame
+ @Return			The set of the cache that holds the frame, or -1 if the
+					cache is disabled
+ @Description		Finds the set of the world-matrix cache for a frame. If
+					no set holds the frame, the least recently used set is
+					emptied and given to it.
+*****************************************************************************/
+static int FindWorldMatrixSet(
+	SPVRTPODImpl		&impl,
+	const unsigned int	nNumNode,
+	const VERTTYPE		fKey)
+{
+	unsigned int i, nLRU = 0;
+
+	if(!impl.nWmSets)
+		return -1;
+
+	for(i = 0; i < impl.nWmSets; ++i)
+	{
+		if(impl.pnSetUsed[i] && impl.pfSetFrame[i] == fKey)
+		{
+			impl.pnSetUsed[i] = ++impl.nWmClock;
+			return (int)i;
+		}
+
+		if(impl.pnSetUsed[i] < impl.pnSetUsed[nLRU])
+			nLRU = i;
+	}
+
+	if(impl.pnSetUsed[nLRU])
+		++impl.sWmStats.nEvictions;
+
+	// A new generation invalidates the matrices of the previous frame
+	if(++impl.pnSetGen[nLRU] == 0)
+	{
+		memset(&impl.pnWmGen[nLRU * nNumNode], 0, nNumNode * sizeof(*impl.pnWmGen));
+		impl.pnSetGen[nLRU] = 1;
+	}
+
+	impl.pfSetFrame[nLRU]	= fKey;
+	impl.pnSetUsed[nLRU]	= ++impl.nWmClock;
+	return (int)nLRU;
+}
+
+/*!***************************************************************************
+ @Function			CreateWorldMatrixCache
+ @Modified			impl			Implementation data
+ @Input				nNumNode		Number of nodes
+ @Description		Allocates impl.nWmSets sets of nNumNode world matrices,
+					freeing any previous sets.
+*****************************************************************************/
+static void CreateWorldMatrixCache(
+	SPVRTPODImpl		&impl,
+	const unsigned int	nNumNode)
+{
+	delete [] impl.pfSetFrame;
+	delete [] impl.pnSetUsed;
+	delete [] impl.pnSetGen;
+	delete [] impl.pnWmGen;
+	delete [] impl.pWmCache;
+
+	impl.pfSetFrame	= new VERTTYPE[impl.nWmSets];
+	impl.pnSetUsed	= new PVRTuint64[impl.nWmSets];
+	impl.pnSetGen	= new PVRTuint32[impl.nWmSets];
+	impl.pnWmGen	= new PVRTuint32[impl.nWmSets * nNumNode];
+	impl.pWmCache	= new PVRTMATRIX[impl.nWmSets * nNumNode];
+
+	memset(impl.pnSetUsed, 0, impl.nWmSets * sizeof(*impl.pnSetUsed));
+	memset(impl.pnSetGen, 0, impl.nWmSets * sizeof(*impl.pnSetGen));
+	memset(impl.pnWmGen, 0, impl.nWmSets * nNumNode * sizeof(*impl.pnWmGen));
+}
+
+/****************************************************************************
+** Class: CPVRTModelPOD
+****************************************************************************/
+
+/*!***************************************************************************
+ @Function			ReadFromFile
+ @Input				pszFileName		Filename to load
+ @Output			pszExpOpt		String in which to place exporter options
+ @Input				count			Maximum number of characters to store.
+ @Output			pszHistory		String in which to place the pod file history
+ @Input				historyCount	Maximum number of characters to store.
+ @Return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Loads the specified ".POD" file; returns the scene in
+					pScene. This structure must later be destroyed with
+					PVRTModelPODDestroy() to prevent memory leaks.
+					".POD" files are exported using the PVRGeoPOD exporters.
+					If pszExpOpt is NULL, the scene is loaded; otherwise the
+					scene is not loaded and pszExpOpt is filled in. The same
+					is true for pszHistory.
+*****************************************************************************/
+EPVRTError CPVRTModelPOD::ReadFromFile(
+	const char		* const pszFileName,
+	char			* const pszExpOpt,
+	const size_t	count,
+	char			* const pszHistory,
+	const size_t	historyCount)
+{
+	CSourceStream src;
+
+	if(!src.Init(pszFileName))
+		return PVR_FAIL;
+
+	CPODArena * const pArena = pszExpOpt || pszHistory ? NULL : CreateArena(src);
+
+	if(ReadFromSourceStream(this, src, pszExpOpt, count, pszHistory, historyCount) != PVR_SUCCESS)
+	{
+		// Anything read so far may point into the arena, which is about to be released
+		if(pArena)
+			memset(this, 0, sizeof(*this));
+		delete pArena;
+		return PVR_FAIL;
+	}
+
+	AttachArena(*m_pImpl, pArena, nNumMesh);
+	return PVR_SUCCESS;
+}
+
+/*!***************************************************************************
+ @Function			ReadFromMappedFile
+ @Input				pszFileName		Filename to load
+ @Input				bLazyMeshData	Defer decoding the mesh data until LoadMeshData()
+ @Return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Loads the specified ".POD" file by mapping it into memory.
+					Where alignment and endianness allow, the mesh face,
+					vertex and interleaved data point directly into the
+					mapping instead of being copied. The mapping is released
+					by Destroy(). If the file cannot be mapped, this falls back
+					to ReadFromFile().
+					If bLazyMeshData is set, only the location of each mesh
+					block is recorded, along with the mesh description, and
+					the face and vertex data is decoded by LoadMeshData().
+*****************************************************************************/
+EPVRTError CPVRTModelPOD::ReadFromMappedFile(const char * const pszFileName, const bool bLazyMeshData)
+{
+#if defined(_WIN32)
+	return ReadFromFile(pszFileName);
+#else
+	CSourceMapped src;
+	CPVRTString Path(CPVRTResourceFile::GetReadPath());
+	Path += pszFileName;
+
+	if(!pszFileName || !src.Init(Path.c_str()))
+		return ReadFromFile(pszFileName);
+
+	Destroy();
+
+	CPODArena * const pArena = CreateArena(src);
+	CPVRTArray<SPODBlock> lazyMeshes;
+	if(!Read(this, src, NULL, 0, NULL, 0, bLazyMeshData ? &lazyMeshes : NULL))
+	{
+		// Any data read so far points into the mapping or the arena, which are about to be released
+		memset(this, 0, sizeof(*this));
+		delete pArena;
+		return PVR_FAIL;
+	}
+
+	if(InitImpl() != PVR_SUCCESS)
+	{
+		delete pArena;
+		return PVR_FAIL;
+	}
+
+	m_pImpl->pMappedFile = src.Detach(m_pImpl->nMappedFileSize);
+	AttachArena(*m_pImpl, pArena, nNumMesh);
+
+	// Index the mesh blocks that have yet to be decoded. An unused entry has a size of zero.
+	if(lazyMeshes.GetSize())
+	{
+		m_pImpl->pMeshBlocks = new SPODBlock[nNumMesh];
+		memset(m_pImpl->pMeshBlocks, 0, nNumMesh * sizeof(*m_pImpl->pMeshBlocks));
+
+		for(unsigned int i = 0; i < lazyMeshes.GetSize(); ++i)
+			m_pImpl->pMeshBlocks[lazyMeshes[i].nIdx] = lazyMeshes[i];
+	}
+	return PVR_SUCCESS;
+#endif
+}
+
+/*!***************************************************************************
+ @Function			ReadFromMemory
+ @Input				pData			Data to load
+ @Input				i32Size			Size of data
+ @Output			pszExpOpt		String in which to place exporter options
+ @Input				count			Maximum number of characters to store.
+ @Output			pszHistory		String in which to place the pod file history
+ @Input				historyCount	Maximum number of characters to store.
+ @Return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Loads the supplied pod data. This data can be exported
+					directly to a header using one of the pod exporters.
+					If pszExpOpt is NULL, the scene is loaded; otherwise the
+					scene is not loaded and pszExpOpt is filled in. The same
+					is true for pszHistory.
+*****************************************************************************/
+EPVRTError CPVRTModelPOD::ReadFromMemory(
+	const char		* pData,
+	const size_t	i32Size,
+	char			* const pszExpOpt,
+	const size_t	count,
+	char			* const pszHistory,
+	const size_t	historyCount)
+{
+	CSourceStream src;
+
+	if(!src.Init(pData, i32Size))
+		return PVR_FAIL;
+
+	CPODArena * const pArena = pszExpOpt || pszHistory ? NULL : CreateArena(src);
+
+	if(ReadFromSourceStream(this, src, pszExpOpt, count, pszHistory, historyCount) != PVR_SUCCESS)
+	{
+		// Anything read so far may point into the arena, which is about to be released
+		if(pArena)
+			memset(this, 0, sizeof(*this));
+		delete pArena;
+		return PVR_FAIL;
+	}
+
+	AttachArena(*m_pImpl, pArena, nNumMesh);
+	return PVR_SUCCESS;
+}
+
+/*!***************************************************************************
+ @Function			ReadFromMemory
+ @Input				scene			Scene data from the header file
+ @Return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Sets the scene data from the supplied data structure. Use
+					when loading from .H files.
+*****************************************************************************/
+EPVRTError CPVRTModelPOD::ReadFromMemory(
 	const SPODScene &scene)
 {
 	Destroy();
@@ -2047,10 +3291,15 @@ EPVRTError CPVRTModelPOD::ReadFromResource(
 		return PVR_FAIL;
 
 	memset(this, 0, sizeof(*this));
-	if(!Read(this, src, NULL, 0, NULL, 0))
-		return PVR_FAIL;
-	if(InitImpl() != PVR_SUCCESS)
+	CPODArena * const pArena = CreateArena(src);
+	if(!Read(this, src, NULL, 0, NULL, 0) || InitImpl() != PVR_SUCCESS)
+	{
+		if(pArena)
+			memset(this, 0, sizeof(*this));
+		delete pArena;
 		return PVR_FAIL;
+	}
+	AttachArena(*m_pImpl, pArena, nNumMesh);
 	return PVR_SUCCESS;
 }
 #endif /* WIN32 */
@@ -2065,6 +3314,17 @@ EPVRTError CPVRTModelPOD::ReadFromResource(
 *************************************************************************/
 EPVRTError CPVRTModelPOD::InitImpl()
 {
+	// Retain ownership of any file mapping or arena the scene data may point into
+	PVRTuint8	*pMappedFile = m_pImpl ? m_pImpl->pMappedFile : NULL;
+	size_t		nMappedFileSize = m_pImpl ? m_pImpl->nMappedFileSize : 0;
+	SPODBlock	*pMeshBlocks = m_pImpl ? m_pImpl->pMeshBlocks : NULL;
+	CPODArena	*pArena = m_pImpl ? m_pImpl->pArena : NULL;
+	bool		*pbHeapMesh = m_pImpl ? m_pImpl->pbHeapMesh : NULL;
+
+	// Keep the size of the world-matrix cache
+	unsigned int	nWmSets = m_pImpl ? m_pImpl->nWmSets : 1;
+	VERTTYPE		fWmQuantum = m_pImpl ? m_pImpl->fWmQuantum : 0;
+
 	// Allocate space for implementation data
 	delete m_pImpl;
 	m_pImpl = new SPVRTPODImpl;
@@ -2073,15 +3333,18 @@ EPVRTError CPVRTModelPOD::InitImpl()
 
 	// Zero implementation data
 	memset(m_pImpl, 0, sizeof(*m_pImpl));
-
-#ifdef _DEBUG
-	m_pImpl->nWmTotal = 0;
-#endif
+	m_pImpl->pMappedFile		= pMappedFile;
+	m_pImpl->nMappedFileSize	= nMappedFileSize;
+	m_pImpl->pMeshBlocks		= pMeshBlocks;
+	m_pImpl->pArena				= pArena;
+	m_pImpl->pbHeapMesh			= pbHeapMesh;
+	m_pImpl->nWmSets			= nWmSets;
+	m_pImpl->fWmQuantum			= fWmQuantum;
 
 	// Allocate world-matrix cache
-	m_pImpl->pfCache		= new VERTTYPE[nNumNode];
-	m_pImpl->pWmCache		= new PVRTMATRIX[nNumNode];
+	CreateWorldMatrixCache(*m_pImpl, nNumNode);
 	m_pImpl->pWmZeroCache	= new PVRTMATRIX[nNumNode];
+	m_pImpl->pnNodeOrder	= new unsigned int[nNumNode];
 	FlushCache();
 
 	return PVR_SUCCESS;
@@ -2095,9 +3358,20 @@ void CPVRTModelPOD::DestroyImpl()
 {
 	if(m_pImpl)
 	{
-		if(m_pImpl->pfCache)		delete [] m_pImpl->pfCache;
+		if(m_pImpl->pfSetFrame)		delete [] m_pImpl->pfSetFrame;
+		if(m_pImpl->pnSetUsed)		delete [] m_pImpl->pnSetUsed;
+		if(m_pImpl->pnSetGen)		delete [] m_pImpl->pnSetGen;
+		if(m_pImpl->pnWmGen)		delete [] m_pImpl->pnWmGen;
 		if(m_pImpl->pWmCache)		delete [] m_pImpl->pWmCache;
 		if(m_pImpl->pWmZeroCache)	delete [] m_pImpl->pWmZeroCache;
+		if(m_pImpl->pnNodeOrder)	delete [] m_pImpl->pnNodeOrder;
+		if(m_pImpl->pMeshBlocks)	delete [] m_pImpl->pMeshBlocks;
+		if(m_pImpl->pbHeapMesh)		delete [] m_pImpl->pbHeapMesh;
+
+#if !defined(_WIN32)
+		if(m_pImpl->pMappedFile)	munmap(m_pImpl->pMappedFile, m_pImpl->nMappedFileSize);
+#endif
+		delete m_pImpl->pArena;
 
 		delete m_pImpl;
 		m_pImpl = 0;
@@ -2107,18 +3381,68 @@ void CPVRTModelPOD::DestroyImpl()
 /*!***********************************************************************
  @Function		FlushCache
  @Description	Clears the matrix cache; use this if necessary when you
-				edit the position or animation of a node.
+				edit the position, animation or parent of a node.
 *************************************************************************/
 void CPVRTModelPOD::FlushCache()
 {
+	// Order the nodes so that the world matrices can be computed in one pass
+	SortNodesByDepth(m_pImpl->pnNodeOrder, pNode, nNumNode);
+
 	// Pre-calc frame zero matrices
 	SetFrame(0);
-	for(unsigned int i = 0; i < nNumNode; ++i)
-		GetWorldMatrixNoCache(m_pImpl->pWmZeroCache[i], pNode[i]);
+	EvaluateFrame(*this, m_pImpl->pnNodeOrder, m_pImpl->pWmZeroCache, NULL);
+
+	// Empty the cache of the other frames
+	memset(m_pImpl->pnSetUsed, 0, m_pImpl->nWmSets * sizeof(*m_pImpl->pnSetUsed));
+}
+
+/*!***********************************************************************
+ @Function		SetWorldMatrixCacheSize
+ @Input			nFrames			Number of frames to cache
+ @Input			fFrameQuantum	Step to round the frames to, or zero
+ @Return		PVR_SUCCESS if successful, PVR_FAIL if no model is loaded
+ @Description	Sets how many frames of world matrices GetWorldMatrix()
+				caches, in addition to frame zero. When the cache is
+				full, the least recently used frame is dropped. If
+				fFrameQuantum is not zero, frames are rounded to the
+				nearest multiple of it, and the world matrices are
+				computed at the rounded frame, so that instances at
+				nearby frames share them. Empties the cache.
+*************************************************************************/
+EPVRTError CPVRTModelPOD::SetWorldMatrixCacheSize(const unsigned int nFrames, const VERTTYPE fFrameQuantum)
+{
+	if(!m_pImpl)
+		return PVR_FAIL;
+
+	m_pImpl->nWmSets	= nFrames;
+	m_pImpl->fWmQuantum	= fFrameQuantum;
+	CreateWorldMatrixCache(*m_pImpl, nNumNode);
+	return PVR_SUCCESS;
+}
 
-	// Load cache with frame-zero data
-	memcpy(m_pImpl->pWmCache, m_pImpl->pWmZeroCache, nNumNode * sizeof(*m_pImpl->pWmCache));
-	memset(m_pImpl->pfCache, 0, nNumNode * sizeof(*m_pImpl->pfCache));
+/*!***********************************************************************
+ @Function		GetWorldMatrixCacheStats
+ @Output		sStats			Counters of the world-matrix cache
+ @Description	Returns how GetWorldMatrix() calls were served since the
+				model was loaded or ResetWorldMatrixCacheStats() was
+				called, to help choose the size of the cache.
+*************************************************************************/
+void CPVRTModelPOD::GetWorldMatrixCacheStats(SPODWorldMatrixCacheStats &sStats) const
+{
+	if(m_pImpl)
+		sStats = m_pImpl->sWmStats;
+	else
+		memset(&sStats, 0, sizeof(sStats));
+}
+
+/*!***********************************************************************
+ @Function		ResetWorldMatrixCacheStats
+ @Description	Zeroes the counters of the world-matrix cache.
+*************************************************************************/
+void CPVRTModelPOD::ResetWorldMatrixCacheStats()
+{
+	if(m_pImpl)
+		memset(&m_pImpl->sWmStats, 0, sizeof(m_pImpl->sWmStats));
 }
 
 /*!***********************************************************************
@@ -2130,99 +3454,374 @@ bool CPVRTModelPOD::IsLoaded()
 	return (m_pImpl!=NULL);
 }
 
-/*!***************************************************************************
- @Function			Constructor
- @Description		Initializes the pointer to scene data to NULL
-*****************************************************************************/
-CPVRTModelPOD::CPVRTModelPOD() : m_pImpl(NULL)
-{}
+/*!***********************************************************************
+ @Function		SetDecodeThreadCount
+ @Input			ui32Threads		Number of threads; zero uses all processors
+ @Description	Sets the number of threads used to decode the mesh, node and
+				material blocks of subsequently loaded POD files. A value of
+				one selects the serial loader.
+*************************************************************************/
+void CPVRTModelPOD::SetDecodeThreadCount(const unsigned int ui32Threads)
+{
+	s_ui32DecodeThreads = ui32Threads;
+}
 
-/*!***************************************************************************
- @Function			Destructor
- @Description		Frees the memory allocated to store the scene in pScene.
-*****************************************************************************/
-CPVRTModelPOD::~CPVRTModelPOD()
+/*!***********************************************************************
+ @Function		GetDecodeThreadCount
+ @Return		Number of decode threads; zero means all processors
+ @Description	Returns the value set with SetDecodeThreadCount().
+*************************************************************************/
+unsigned int CPVRTModelPOD::GetDecodeThreadCount()
 {
-	Destroy();
+	return s_ui32DecodeThreads;
 }
 
-/*!***************************************************************************
- @Function			Destroy
- @Description		Frees the memory allocated to store the scene in pScene.
-*****************************************************************************/
-void CPVRTModelPOD::Destroy()
+/*!***********************************************************************
+ @Function		SetArenaAllocation
+ @Input			bArena		Whether to allocate from an arena
+ @Description	Sets whether subsequently loaded POD files allocate their
+				scene content from an arena owned by the model, which
+				Destroy() releases all at once.
+*************************************************************************/
+void CPVRTModelPOD::SetArenaAllocation(const bool bArena)
 {
-	unsigned int	i;
+	s_bArenaAllocation = bArena;
+}
 
-	if(m_pImpl != NULL)
-	{
-		/*
-			Only attempt to free this memory if it was actually allocated at
-			run-time, as opposed to compiled into the app.
-		*/
-		if(!m_pImpl->bFromMemory)
-		{
+/*!***********************************************************************
+ @Function		GetArenaAllocation
+ @Return		Whether new models allocate from an arena
+ @Description	Returns the value set with SetArenaAllocation().
+*************************************************************************/
+bool CPVRTModelPOD::GetArenaAllocation()
+{
+	return s_bArenaAllocation;
+}
 
-			for(i = 0; i < nNumCamera; ++i)
-				FREE(pCamera[i].pfAnimFOV);
-			FREE(pCamera);
+/*!***********************************************************************
+ @Function		IsArenaData
+ @Input			pData		Pointer to test
+ @Return		true if pData was allocated from the arena
+ @Description	Returns whether the specified data was allocated from the
+				arena of this model. Such data must not be freed or
+				reallocated.
+*************************************************************************/
+bool CPVRTModelPOD::IsArenaData(const void * const pData) const
+{
+	if(!m_pImpl || !m_pImpl->pArena || !pData)
+		return false;
 
-			FREE(pLight);
+	return m_pImpl->pArena->Contains(pData);
+}
 
-			for(i = 0; i < nNumMaterial; ++i)
-			{
-				FREE(pMaterial[i].pszName);
-				FREE(pMaterial[i].pszEffectFile);
-				FREE(pMaterial[i].pszEffectName);
-				FREE(pMaterial[i].pUserData);
-			}
-			FREE(pMaterial);
+/*!***********************************************************************
+ @Function		GetArenaStats
+ @Output		sStats		Memory used by the arena
+ @Description	Returns the memory used by the arena of this model, or
+				zeroes if the model was not loaded into an arena.
+*************************************************************************/
+void CPVRTModelPOD::GetArenaStats(SPODArenaStats &sStats) const
+{
+	if(m_pImpl && m_pImpl->pArena)
+		sStats = m_pImpl->pArena->GetStats();
+	else
+		memset(&sStats, 0, sizeof(sStats));
+}
 
-			for(i = 0; i < nNumMesh; ++i) {
-				FREE(pMesh[i].sFaces.pData);
-				FREE(pMesh[i].pnStripLength);
-				if(pMesh[i].pInterleaved)
-				{
-					FREE(pMesh[i].pInterleaved);
-				}
-				else
+/*!***********************************************************************
+ @Function		IsMappedData
+ @Input			pData		Pointer to test
+ @Return		true if pData points into the file mapping
+ @Description	Returns whether the specified data points directly into the
+				memory mapping created by ReadFromMappedFile(). Such data
+				must not be freed or reallocated.
+*************************************************************************/
+bool CPVRTModelPOD::IsMappedData(const void * const pData) const
+{
+	if(!m_pImpl || !m_pImpl->pMappedFile || !pData)
+		return false;
+
+	const PVRTuint8 *p = (const PVRTuint8*) pData;
+	return p >= m_pImpl->pMappedFile && p < m_pImpl->pMappedFile + m_pImpl->nMappedFileSize;
+}
+
+/*!***********************************************************************
+ @Function		UnmapData
+ @Input			pod			Model owning the mapping or arena
+ @Modified		pData		Data to copy to the heap
+ @Input			cnt			Number of elements of the data
+ @Return		false if memory allocation failed
+ @Description	Replaces a pointer into the file mapping, or into the
+				arena, with a heap copy.
+*************************************************************************/
+template <typename T>
+static bool UnmapData(const CPVRTModelPOD &pod, T* &pData, const size_t cnt)
+{
+	if(!pod.IsMappedData(pData) && !pod.IsArenaData(pData))
+		return true;
+
+	T *pCopy = NULL;
+	if(!SafeAlloc(pCopy, cnt))
+		return false;
+
+	memcpy(pCopy, pData, cnt * sizeof(T));
+	pData = pCopy;
+	return true;
+}
+
+/*!***********************************************************************
+ @Function		UnmapMeshData
+ @Input			ui32Mesh	Index of the mesh
+ @Return		PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description	Replaces any data of the mesh that points into the file
+				mapping, or that was allocated from the arena, with a heap
+				copy. Call this before modifying the mesh with the
+				PVRTModelPOD*() utility functions, or before handing the
+				mesh data over to code that will free it. Safe to call for
+				different meshes from several threads at once.
+*************************************************************************/
+EPVRTError CPVRTModelPOD::UnmapMeshData(const unsigned int ui32Mesh)
+{
+	if(ui32Mesh >= nNumMesh)
+		return PVR_FAIL;
+
+	SPODMesh &mesh = pMesh[ui32Mesh];
+	bool bOK = UnmapData(*this, mesh.sFaces.pData, PVRTModelPODDataStride(mesh.sFaces) * PVRTModelPODCountIndices(mesh));
+
+	bOK &= UnmapData(*this, mesh.pnStripLength, mesh.nNumStrips);
+	bOK &= UnmapData(*this, mesh.psUVW, mesh.nNumUVW);
+
+	if(mesh.pInterleaved)
+	{
+		bOK &= UnmapData(*this, mesh.pInterleaved, mesh.nNumVertex * mesh.sVertex.nStride);
+	}
+	else
+	{
+		bOK &= UnmapData(*this, mesh.sVertex.pData, PVRTModelPODDataStride(mesh.sVertex) * mesh.nNumVertex);
+		bOK &= UnmapData(*this, mesh.sNormals.pData, PVRTModelPODDataStride(mesh.sNormals) * mesh.nNumVertex);
+		bOK &= UnmapData(*this, mesh.sTangents.pData, PVRTModelPODDataStride(mesh.sTangents) * mesh.nNumVertex);
+		bOK &= UnmapData(*this, mesh.sBinormals.pData, PVRTModelPODDataStride(mesh.sBinormals) * mesh.nNumVertex);
+		for(unsigned int i = 0; i < mesh.nNumUVW; ++i)
+			bOK &= UnmapData(*this, mesh.psUVW[i].pData, PVRTModelPODDataStride(mesh.psUVW[i]) * mesh.nNumVertex);
+		bOK &= UnmapData(*this, mesh.sVtxColours.pData, PVRTModelPODDataStride(mesh.sVtxColours) * mesh.nNumVertex);
+		bOK &= UnmapData(*this, mesh.sBoneIdx.pData, PVRTModelPODDataStride(mesh.sBoneIdx) * mesh.nNumVertex);
+		bOK &= UnmapData(*this, mesh.sBoneWeight.pData, PVRTModelPODDataStride(mesh.sBoneWeight) * mesh.nNumVertex);
+	}
+
+	CPVRTBoneBatches &batches = mesh.sBoneBatches;
+	bOK &= UnmapData(*this, batches.pnBatches, (size_t) batches.nBatchCnt * batches.nBatchBoneMax);
+	bOK &= UnmapData(*this, batches.pnBatchBoneCnt, batches.nBatchCnt);
+	bOK &= UnmapData(*this, batches.pnBatchOffset, batches.nBatchCnt);
+
+	// Destroy() must now free this mesh, even though the rest of the model is in the arena
+	if(m_pImpl && m_pImpl->pbHeapMesh)
+		m_pImpl->pbHeapMesh[ui32Mesh] = true;
+
+	return bOK ? PVR_SUCCESS : PVR_FAIL;
+}
+
+/*!***************************************************************************
+ @Function			DestroyMesh
+ @Input				pod			Model owning any file mapping or arena
+ @Modified			mesh		Mesh to free
+ @Description		Frees the memory allocated by a mesh.
+*****************************************************************************/
+static void DestroyMesh(const CPVRTModelPOD &pod, SPODMesh &mesh)
+{
+	FreeUnlessBorrowed(pod, mesh.sFaces.pData);
+	FreeUnlessBorrowed(pod, mesh.pnStripLength);
+	if(mesh.pInterleaved)
+	{
+		FreeUnlessBorrowed(pod, mesh.pInterleaved);
+	}
+	else
+	{
+		FreeUnlessBorrowed(pod, mesh.sVertex.pData);
+		FreeUnlessBorrowed(pod, mesh.sNormals.pData);
+		FreeUnlessBorrowed(pod, mesh.sTangents.pData);
+		FreeUnlessBorrowed(pod, mesh.sBinormals.pData);
+		for(unsigned int j = 0; j < mesh.nNumUVW; ++j)
+			FreeUnlessBorrowed(pod, mesh.psUVW[j].pData);
+		FreeUnlessBorrowed(pod, mesh.sVtxColours.pData);
+		FreeUnlessBorrowed(pod, mesh.sBoneIdx.pData);
+		FreeUnlessBorrowed(pod, mesh.sBoneWeight.pData);
+	}
+	FreeUnlessBorrowed(pod, mesh.psUVW);
+	FreeUnlessBorrowed(pod, mesh.sBoneBatches.pnBatches);
+	FreeUnlessBorrowed(pod, mesh.sBoneBatches.pnBatchBoneCnt);
+	FreeUnlessBorrowed(pod, mesh.sBoneBatches.pnBatchOffset);
+	mesh.sBoneBatches.Release();
+}
+
+/*!***************************************************************************
+ @Function			AdoptMeshData
+ @Modified			mesh		Mesh to receive the data
+ @Modified			content		Mesh to take the data from
+ @Description		Moves the face, vertex and interleaved data pointers of
+					content into mesh, leaving them NULL in content.
+*****************************************************************************/
+static void AdoptMeshData(SPODMesh &mesh, SPODMesh &content)
+{
+	CPODData * const pDst[] = { &mesh.sFaces, &mesh.sVertex, &mesh.sNormals, &mesh.sTangents, &mesh.sBinormals, &mesh.sVtxColours, &mesh.sBoneIdx, &mesh.sBoneWeight };
+	CPODData * const pSrc[] = { &content.sFaces, &content.sVertex, &content.sNormals, &content.sTangents, &content.sBinormals, &content.sVtxColours, &content.sBoneIdx, &content.sBoneWeight };
+
+	for(unsigned int i = 0; i < sizeof(pDst) / sizeof(*pDst); ++i)
+	{
+		pDst[i]->pData = pSrc[i]->pData;
+		pSrc[i]->pData = NULL;
+	}
+
+	for(unsigned int i = 0; i < PVRT_MIN(mesh.nNumUVW, content.nNumUVW); ++i)
+	{
+		mesh.psUVW[i].pData = content.psUVW[i].pData;
+		content.psUVW[i].pData = NULL;
+	}
+
+	mesh.pInterleaved = content.pInterleaved;
+	content.pInterleaved = NULL;
+}
+
+/*!***********************************************************************
+ @Function		LoadMeshData
+ @Input			ui32Mesh	Index of the mesh
+ @Return		PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description	Decodes the face, vertex and interleaved data of a mesh
+				loaded with ReadFromMappedFile() in lazy mode. Does nothing
+				if the data has already been decoded. Safe to call for
+				different meshes from several threads at once.
+*************************************************************************/
+EPVRTError CPVRTModelPOD::LoadMeshData(const unsigned int ui32Mesh)
+{
+	if(ui32Mesh >= nNumMesh)
+		return PVR_FAIL;
+
+	if(IsMeshDataLoaded(ui32Mesh))
+		return PVR_SUCCESS;
+
+	// Decode the whole block again, keeping only the data skipped by the first pass
+	SPODBlock &block = m_pImpl->pMeshBlocks[ui32Mesh];
+	CSourceMemory src(m_pImpl->pMappedFile + block.nOffset, block.nSize, true);
+	SPODMesh content;
+	memset(&content, 0, sizeof(content));
+
+	bool bOK = ReadMesh(content, src);
+
+	if(bOK)
+	{
+		AdoptMeshData(pMesh[ui32Mesh], content);
+		block.nSize = 0;
+
+		// The data was decoded to the heap, so Destroy() must free it
+		if(m_pImpl->pbHeapMesh)
+			m_pImpl->pbHeapMesh[ui32Mesh] = true;
+	}
+
+	DestroyMesh(*this, content);
+	return bOK ? PVR_SUCCESS : PVR_FAIL;
+}
+
+/*!***********************************************************************
+ @Function		IsMeshDataLoaded
+ @Input			ui32Mesh	Index of the mesh
+ @Return		true if the mesh data has been decoded
+ @Description	Returns whether the face and vertex data of a mesh is
+				available, which is always the case unless the model was
+				loaded with ReadFromMappedFile() in lazy mode.
+*************************************************************************/
+bool CPVRTModelPOD::IsMeshDataLoaded(const unsigned int ui32Mesh) const
+{
+	return !m_pImpl || !m_pImpl->pMeshBlocks || ui32Mesh >= nNumMesh || !m_pImpl->pMeshBlocks[ui32Mesh].nSize;
+}
+
+/*!***************************************************************************
+ @Function			Constructor
+ @Description		Initializes the pointer to scene data to NULL
+*****************************************************************************/
+CPVRTModelPOD::CPVRTModelPOD() : m_pImpl(NULL)
+{}
+
+/*!***************************************************************************
+ @Function			Destructor
+ @Description		Frees the memory allocated to store the scene in pScene.
+*****************************************************************************/
+CPVRTModelPOD::~CPVRTModelPOD()
+{
+	Destroy();
+}
+
+/*!***************************************************************************
+ @Function			Destroy
+ @Description		Frees the memory allocated to store the scene in pScene.
+*****************************************************************************/
+void CPVRTModelPOD::Destroy()
+{
+	unsigned int	i;
+
+	if(m_pImpl != NULL)
+	{
+		/*
+			Only attempt to free this memory if it was actually allocated at
+			run-time, as opposed to compiled into the app.
+		*/
+		if(!m_pImpl->bFromMemory && m_pImpl->pArena)
+		{
+			/*
+				The scene content is all in the arena or the file mapping, which
+				DestroyImpl() releases at once, except for the meshes that have
+				since been moved to the heap.
+			*/
+			if(m_pImpl->pbHeapMesh)
+			{
+				for(i = 0; i < nNumMesh; ++i)
 				{
-					FREE(pMesh[i].sVertex.pData);
-					FREE(pMesh[i].sNormals.pData);
-					FREE(pMesh[i].sTangents.pData);
-					FREE(pMesh[i].sBinormals.pData);
-					for(unsigned int j = 0; j < pMesh[i].nNumUVW; ++j)
-						FREE(pMesh[i].psUVW[j].pData);
-					FREE(pMesh[i].sVtxColours.pData);
-					FREE(pMesh[i].sBoneIdx.pData);
-					FREE(pMesh[i].sBoneWeight.pData);
+					if(m_pImpl->pbHeapMesh[i])
+						DestroyMesh(*this, pMesh[i]);
 				}
-				FREE(pMesh[i].psUVW);
-				pMesh[i].sBoneBatches.Release();
 			}
-			FREE(pMesh);
+		}
+		else if(!m_pImpl->bFromMemory)
+		{
+			// Data in the file mapping is released with it, by DestroyImpl()
+			for(i = 0; i < nNumCamera; ++i)
+				FreeUnlessBorrowed(*this, pCamera[i].pfAnimFOV);
+			FreeUnlessBorrowed(*this, pCamera);
+
+			FreeUnlessBorrowed(*this, pLight);
+
+			for(i = 0; i < nNumMaterial; ++i)
+			{
+				FreeUnlessBorrowed(*this, pMaterial[i].pszName);
+				FreeUnlessBorrowed(*this, pMaterial[i].pszEffectFile);
+				FreeUnlessBorrowed(*this, pMaterial[i].pszEffectName);
+				FreeUnlessBorrowed(*this, pMaterial[i].pUserData);
+			}
+			FreeUnlessBorrowed(*this, pMaterial);
+
+			for(i = 0; i < nNumMesh; ++i)
+				DestroyMesh(*this, pMesh[i]);
+			FreeUnlessBorrowed(*this, pMesh);
 
 			for(i = 0; i < nNumNode; ++i) {
-				FREE(pNode[i].pszName);
-				FREE(pNode[i].pfAnimPosition);
-				FREE(pNode[i].pnAnimPositionIdx);
-				FREE(pNode[i].pfAnimRotation);
-				FREE(pNode[i].pnAnimRotationIdx);
-				FREE(pNode[i].pfAnimScale);
-				FREE(pNode[i].pnAnimScaleIdx);
-				FREE(pNode[i].pfAnimMatrix);
-				FREE(pNode[i].pnAnimMatrixIdx);
-				FREE(pNode[i].pUserData);
+				FreeUnlessBorrowed(*this, pNode[i].pszName);
+				FreeUnlessBorrowed(*this, pNode[i].pfAnimPosition);
+				FreeUnlessBorrowed(*this, pNode[i].pnAnimPositionIdx);
+				FreeUnlessBorrowed(*this, pNode[i].pfAnimRotation);
+				FreeUnlessBorrowed(*this, pNode[i].pnAnimRotationIdx);
+				FreeUnlessBorrowed(*this, pNode[i].pfAnimScale);
+				FreeUnlessBorrowed(*this, pNode[i].pnAnimScaleIdx);
+				FreeUnlessBorrowed(*this, pNode[i].pfAnimMatrix);
+				FreeUnlessBorrowed(*this, pNode[i].pnAnimMatrixIdx);
+				FreeUnlessBorrowed(*this, pNode[i].pUserData);
 				pNode[i].nAnimFlags = 0;
 			}
 
-			FREE(pNode);
+			FreeUnlessBorrowed(*this, pNode);
 
 			for(i = 0; i < nNumTexture; ++i)
-				FREE(pTexture[i].pszName);
-			FREE(pTexture);
+				FreeUnlessBorrowed(*this, pTexture[i].pszName);
+			FreeUnlessBorrowed(*this, pTexture);
 
-			FREE(pUserData);
+			FreeUnlessBorrowed(*this, pUserData);
 		}
 
 		// Free the working space used by the implementation
@@ -2235,30 +3834,68 @@ void CPVRTModelPOD::Destroy()
 /*!***************************************************************************
  @Function			SetFrame
  @Input				fFrame			Frame number
+ @Input				bEvaluateWorldMatrices	Whether to compute the world
+									matrices of all the nodes now
  @Description		Set the animation frame for which subsequent Get*() calls
-					should return data.
+					should return data. If bEvaluateWorldMatrices is true,
+					the world matrices of all the nodes are computed in one
+					pass and cached, so that GetWorldMatrix() does not need
+					to walk the parents of each node.
 *****************************************************************************/
-void CPVRTModelPOD::SetFrame(const VERTTYPE fFrame)
+void CPVRTModelPOD::SetFrame(const VERTTYPE fFrame, const bool bEvaluateWorldMatrices)
 {
-	if(nNumFrame) {
-		/*
-			Limit animation frames.
+	SetImplFrame(*m_pImpl, nNumFrame, fFrame);
 
-			Example: If there are 100 frames of animation, the highest frame
-			number allowed is 98, since that will blend between frames 98 and
-			99. (99 being of course the 100th frame.)
-		*/
-		_ASSERT(fFrame <= f2vt((float)(nNumFrame-1)));
-		m_pImpl->nFrame = (int)vt2f(fFrame);
-		m_pImpl->fBlend = fFrame - f2vt(m_pImpl->nFrame);
+	if(!bEvaluateWorldMatrices)
+		return;
+
+	// Frame zero has a dedicated cache
+	const VERTTYPE fKey = QuantizeFrame(*m_pImpl, nNumFrame, fFrame);
+	const int nSet = fKey != 0 ? FindWorldMatrixSet(*m_pImpl, nNumNode, fKey) : -1;
+
+	if(nSet >= 0)
+	{
+		if(fKey != fFrame)
+			SetImplFrame(*m_pImpl, nNumFrame, fKey);
+
+		EvaluateFrame(*this, m_pImpl->pnNodeOrder, &m_pImpl->pWmCache[nSet * nNumNode], NULL);
+
+		for(unsigned int i = 0; i < nNumNode; ++i)
+			m_pImpl->pnWmGen[nSet * nNumNode + i] = m_pImpl->pnSetGen[nSet];
+
+		if(fKey != fFrame)
+			SetImplFrame(*m_pImpl, nNumFrame, fFrame);
 	}
-	else
+}
+
+/*!***************************************************************************
+ @Function			EvaluateWorldMatrices
+ @Output			pmOut			nCount * nNumNode world matrices
+ @Input				pfFrames		Frame of each evaluation
+ @Input				nCount			Number of evaluations
+ @Input				pmInstance		Matrix of each evaluation, or NULL
+ @Description		Computes the world matrices of all the nodes at several
+					frames, for example for a crowd of instances that share
+					this model. The matrices of evaluation i are written to
+					pmOut[i * nNumNode] onwards, in node order, and are
+					transformed by pmInstance[i] if pmInstance is not NULL.
+					The current frame is left unchanged.
+*****************************************************************************/
+void CPVRTModelPOD::EvaluateWorldMatrices(
+	PVRTMATRIX			* const pmOut,
+	const VERTTYPE		* const pfFrames,
+	const unsigned int	nCount,
+	const PVRTMATRIX	* const pmInstance)
+{
+	const VERTTYPE fFrame = m_pImpl->fFrame;
+
+	for(unsigned int i = 0; i < nCount; ++i)
 	{
-		m_pImpl->fBlend = 0;
-		m_pImpl->nFrame = 0;
+		SetFrame(pfFrames[i]);
+		EvaluateFrame(*this, m_pImpl->pnNodeOrder, &pmOut[i * nNumNode], pmInstance ? &pmInstance[i] : NULL);
 	}
 
-	m_pImpl->fFrame = fFrame;
+	SetFrame(fFrame);
 }
 
 /*!***************************************************************************
@@ -2530,21 +4167,7 @@ void CPVRTModelPOD::GetWorldMatrixNoCache(
 {
 	PVRTMATRIX mTmp;
 
-    if(node.pfAnimMatrix) // The transformations are stored as matrices
-		GetTransformationMatrix(mOut, node);
-	else
-	{
-		// Scale
-		GetScalingMatrix(mOut, node);
-
-		// Rotation
-		GetRotationMatrix(mTmp, node);
-		PVRTMatrixMultiply(mOut, mOut, mTmp);
-
-		// Translation
-		GetTranslationMatrix(mTmp, node);
-		PVRTMatrixMultiply(mOut, mOut, mTmp);
-	}
+	GetLocalMatrix(*this, mOut, node);
 
  	// Do we have to worry about a parent?
 	if(node.nIdxParent < 0)
@@ -2580,42 +4203,51 @@ void CPVRTModelPOD::GetWorldMatrix(
 	PVRTMATRIX		&mOut,
 	const SPODNode	&node) const
 {
+	SPVRTPODImpl &impl = *m_pImpl;
 	unsigned int nIdx;
 
-#ifdef _DEBUG
-	++m_pImpl->nWmTotal;
-	m_pImpl->fHitPerc = (float)m_pImpl->nWmCacheHit / (float)m_pImpl->nWmTotal;
-	m_pImpl->fHitPercZero = (float)m_pImpl->nWmZeroCacheHit / (float)m_pImpl->nWmTotal;
-#endif
+	++impl.sWmStats.nLookups;
 
 	// Calculate a node index
 	nIdx = (unsigned int)(&node - pNode);
 
 	// There is a dedicated cache for frame 0 data
-	if(m_pImpl->fFrame == 0)
+	const VERTTYPE fKey = QuantizeFrame(impl, nNumFrame, impl.fFrame);
+	if(fKey == 0)
 	{
-		mOut = m_pImpl->pWmZeroCache[nIdx];
-#ifdef _DEBUG
-		++m_pImpl->nWmZeroCacheHit;
-#endif
+		mOut = impl.pWmZeroCache[nIdx];
+		++impl.sWmStats.nZeroHits;
 		return;
 	}
 
 	// Has this matrix been calculated & cached?
-	if(m_pImpl->fFrame == m_pImpl->pfCache[nIdx])
+	const int nSet = FindWorldMatrixSet(impl, nNumNode, fKey);
+	if(nSet >= 0 && impl.pnWmGen[nSet * nNumNode + nIdx] == impl.pnSetGen[nSet])
 	{
-		mOut = m_pImpl->pWmCache[nIdx];
-#ifdef _DEBUG
-		++m_pImpl->nWmCacheHit;
-#endif
+		mOut = impl.pWmCache[nSet * nNumNode + nIdx];
+		++impl.sWmStats.nHits;
 		return;
 	}
 
-	GetWorldMatrixNoCache(mOut, node);
+	++impl.sWmStats.nMisses;
+
+	// Compute the matrix at the frame the cache is keyed by
+	if(fKey != impl.fFrame)
+	{
+		const VERTTYPE fFrame = impl.fFrame;
+		SetImplFrame(impl, nNumFrame, fKey);
+		GetWorldMatrixNoCache(mOut, node);
+		SetImplFrame(impl, nNumFrame, fFrame);
+	}
+	else
+		GetWorldMatrixNoCache(mOut, node);
 
 	// Cache the matrix
-	m_pImpl->pfCache[nIdx]	= m_pImpl->fFrame;
-	m_pImpl->pWmCache[nIdx]	= mOut;
+	if(nSet >= 0)
+	{
+		impl.pnWmGen[nSet * nNumNode + nIdx]	= impl.pnSetGen[nSet];
+		impl.pWmCache[nSet * nNumNode + nIdx]	= mOut;
+	}
 }
 
 /*!***************************************************************************
@@ -2970,18 +4602,28 @@ EPVRTError CPVRTModelPOD::CreateSkinIdxWeight(
  @Function			SavePOD
  @Input				pszFilename		Filename to save to
  @Input				pszExpOpt		A string containing the options used by the exporter
- @Description		Save a binary POD file (.POD).
+ @Input				pszHistory		A string containing the history of the exported pod file
+ @Input				ui32DataAlign	File alignment of the mesh data; zero for none
+ @Description		Save a binary POD file (.POD). Meshes whose data has
+					not yet been decoded are loaded first.
 *****************************************************************************/
-EPVRTError CPVRTModelPOD::SavePOD(const char * const pszFilename, const char * const pszExpOpt, const char * const pszHistory)
+EPVRTError CPVRTModelPOD::SavePOD(const char * const pszFilename, const char * const pszExpOpt, const char * const pszHistory, const unsigned int ui32DataAlign)
 {
 	FILE	*pFile;
 	bool	bRet;
 
+	// Meshes read lazily must be decoded, so that their data is written
+	for(unsigned int i = 0; i < nNumMesh; ++i)
+	{
+		if(LoadMeshData(i) != PVR_SUCCESS)
+			return PVR_FAIL;
+	}
+
 	pFile = fopen(pszFilename, "wb+");
 	if(!pFile)
 		return PVR_FAIL;
 
-	bRet = WritePOD(pFile, pszExpOpt, pszHistory, *this);
+	bRet = WritePOD(pFile, pszExpOpt, pszHistory, *this, ui32DataAlign);
 
 	// Done
 	fclose(pFile);
@@ -3086,13 +4728,15 @@ PVRTuint32 PVRTModelPODDataStride(const CPODData &data)
 }
 
 /*!***************************************************************************
- @Function			PVRTModelPODDataConvert
+ @Function			DataConvert
  @Modified			data		Data elements to convert
  @Input				eNewType	New type of elements
  @Input				nCnt		Number of elements
+ @Input				pScratch	Buffers to reuse, or NULL
  @Description		Convert the format of the array of vectors.
+					Freed buffers are given to pScratch for reuse.
 *****************************************************************************/
-void PVRTModelPODDataConvert(CPODData &data, const unsigned int nCnt, const EPVRTDataType eNewType)
+static void DataConvert(CPODData &data, const unsigned int nCnt, const EPVRTDataType eNewType, CPODScratch * const pScratch)
 {
 	PVRTVECTOR4f	v;
 	unsigned int	i;
@@ -3138,7 +4782,8 @@ void PVRTModelPODDataConvert(CPODData &data, const unsigned int nCnt, const EPVR
 	// If the old & new strides are identical, we can convert it in place
 	if(old.nStride != data.nStride)
 	{
-		data.pData = (unsigned char*)malloc(data.nStride * nCnt);
+		data.pData = 0;
+		ScratchAlloc(pScratch, data.pData, data.nStride * nCnt);
 	}
 
 	for(i = 0; i < nCnt; ++i)
@@ -3149,21 +4794,35 @@ void PVRTModelPODDataConvert(CPODData &data, const unsigned int nCnt, const EPVR
 
 	if(old.nStride != data.nStride)
 	{
-		FREE(old.pData);
+		ScratchFree(pScratch, old.pData, old.nStride * nCnt);
 	}
 }
 
 /*!***************************************************************************
- @Function		PVRTModelPODScaleAndConvertVtxData
+ @Function			PVRTModelPODDataConvert
+ @Modified			data		Data elements to convert
+ @Input				eNewType	New type of elements
+ @Input				nCnt		Number of elements
+ @Description		Convert the format of the array of vectors.
+*****************************************************************************/
+void PVRTModelPODDataConvert(CPODData &data, const unsigned int nCnt, const EPVRTDataType eNewType)
+{
+	DataConvert(data, nCnt, eNewType, NULL);
+}
+
+/*!***************************************************************************
+ @Function		ScaleAndConvertVtxData
  @Modified		mesh		POD mesh to scale and convert the mesh data
  @Input			eNewType	The data type to scale and convert the vertex data to
+ @Input			pScratch	Buffers to reuse, or NULL
  @Return		PVR_SUCCESS on success and PVR_FAIL on failure.
  @Description	Scales the vertex data to fit within the range of the requested
 				data type and then converts the data to that type. This function
 				isn't currently compiled in for fixed point builds of the tools.
+				Freed buffers are given to pScratch for reuse.
 *****************************************************************************/
 #if !defined(PVRT_FIXED_POINT_ENABLE)
-EPVRTError PVRTModelPODScaleAndConvertVtxData(SPODMesh &mesh, const EPVRTDataType eNewType)
+static EPVRTError ScaleAndConvertVtxData(SPODMesh &mesh, const EPVRTDataType eNewType, CPODScratch * const pScratch)
 {
 	// Initialise the matrix to identity
 	PVRTMatrixIdentity(mesh.mUnpackMatrix);
@@ -3286,10 +4945,24 @@ EPVRTError PVRTModelPODScaleAndConvertVtxData(SPODMesh &mesh, const EPVRTDataTyp
 	}
 
 	// Convert the data to the chosen format
-	PVRTModelPODDataConvert(mesh.sVertex, mesh.nNumVertex, eNewType);
+	DataConvert(mesh.sVertex, mesh.nNumVertex, eNewType, pScratch);
 
 	return PVR_SUCCESS;
 }
+
+/*!***************************************************************************
+ @Function		PVRTModelPODScaleAndConvertVtxData
+ @Modified		mesh		POD mesh to scale and convert the mesh data
+ @Input			eNewType	The data type to scale and convert the vertex data to
+ @Return		PVR_SUCCESS on success and PVR_FAIL on failure.
+ @Description	Scales the vertex data to fit within the range of the requested
+				data type and then converts the data to that type. This function
+				isn't currently compiled in for fixed point builds of the tools.
+*****************************************************************************/
+EPVRTError PVRTModelPODScaleAndConvertVtxData(SPODMesh &mesh, const EPVRTDataType eNewType)
+{
+	return ScaleAndConvertVtxData(mesh, eNewType, NULL);
+}
 #endif
 /*!***************************************************************************
  @Function			PVRTModelPODDataShred
@@ -3395,6 +5068,7 @@ void PVRTModelPODReorderFaces(SPODMesh &mesh, const int i32El1, const int i32El2
  @Input				nStride
  @Input				nPadding
  @Input				nOffset
+ @Input				pScratch
  @Description		Interleaves the pod data
 *****************************************************************************/
 static void InterleaveArray(
@@ -3403,7 +5077,8 @@ static void InterleaveArray(
 	const PVRTuint32 nNumVertex,
 	const PVRTuint32 nStride,
 	const PVRTuint32 nPadding,
-	PVRTuint32		&nOffset)
+	PVRTuint32		&nOffset,
+	CPODScratch		* const pScratch)
 {
 	if(!data.nStride)
 		return;
@@ -3411,7 +5086,7 @@ static void InterleaveArray(
 	for(PVRTuint32 i = 0; i < nNumVertex; ++i)
 		memcpy(pInterleaved + i * nStride + nOffset, (char*)data.pData + i * data.nStride, data.nStride);
 
-	FREE(data.pData);
+	ScratchFree(pScratch, data.pData, data.nStride * nNumVertex);
 	data.pData		= ((unsigned char*)0 + nOffset);	// patched for Cocos3D by Bill Hollings
 	data.nStride	= nStride;
 	nOffset			+= PVRTModelPODDataStride(data) + nPadding;
@@ -3422,13 +5097,16 @@ static void InterleaveArray(
  @Input				data
  @Input				pInter
  @Input				nNumVertex
+ @Input				nAlignToNBytes
+ @Input				pScratch
  @Description		DeInterleaves the pod data
 *****************************************************************************/
 static void DeinterleaveArray(
 	CPODData			&data,
 	const void			* const pInter,
 	const PVRTuint32	nNumVertex,
-	const PVRTuint32	nAlignToNBytes)
+	const PVRTuint32	nAlignToNBytes,
+	CPODScratch			* const pScratch)
 {
 	const PVRTuint32 nSrcStride	= data.nStride;
 	const PVRTuint32 nDestStride= PVRTModelPODDataStride(data);
@@ -3439,7 +5117,7 @@ static void DeinterleaveArray(
 		return;
 
 	data.pData = 0;
-	SafeAlloc(data.pData, nAlignedStride * nNumVertex);
+	ScratchAlloc(pScratch, data.pData, nAlignedStride * nNumVertex);
 	data.nStride = nAlignedStride;
 
 	for(PVRTuint32 i = 0; i < nNumVertex; ++i)
@@ -3447,12 +5125,14 @@ static void DeinterleaveArray(
 }
 
 /*!***************************************************************************
- @Function		PVRTModelPODToggleInterleaved
+ @Function		ToggleInterleaved
  @Modified		mesh		Mesh to modify
  @Input			ui32AlignToNBytes Align the interleaved data to this no. of bytes.
+ @Input			pScratch	Buffers to reuse, or NULL
  @Description	Switches the supplied mesh to or from interleaved data format.
+				Freed buffers are given to pScratch for reuse.
 *****************************************************************************/
-void PVRTModelPODToggleInterleaved(SPODMesh &mesh, const PVRTuint32 ui32AlignToNBytes)
+static void ToggleInterleaved(SPODMesh &mesh, const PVRTuint32 ui32AlignToNBytes, CPODScratch * const pScratch)
 {
 	unsigned int i;
 
@@ -3464,18 +5144,20 @@ void PVRTModelPODToggleInterleaved(SPODMesh &mesh, const PVRTuint32 ui32AlignToN
 		/*
 			De-interleave
 		*/
-		DeinterleaveArray(mesh.sVertex, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes);
-		DeinterleaveArray(mesh.sNormals, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes);
-		DeinterleaveArray(mesh.sTangents, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes);
-		DeinterleaveArray(mesh.sBinormals, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes);
+		const PVRTuint32 nInterleavedStride = mesh.sVertex.nStride;
+
+		DeinterleaveArray(mesh.sVertex, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes, pScratch);
+		DeinterleaveArray(mesh.sNormals, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes, pScratch);
+		DeinterleaveArray(mesh.sTangents, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes, pScratch);
+		DeinterleaveArray(mesh.sBinormals, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes, pScratch);
 
 		for(i = 0; i < mesh.nNumUVW; ++i)
-			DeinterleaveArray(mesh.psUVW[i], mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes);
+			DeinterleaveArray(mesh.psUVW[i], mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes, pScratch);
 
-		DeinterleaveArray(mesh.sVtxColours, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes);
-		DeinterleaveArray(mesh.sBoneIdx, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes);
-		DeinterleaveArray(mesh.sBoneWeight, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes);
-		FREE(mesh.pInterleaved);
+		DeinterleaveArray(mesh.sVtxColours, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes, pScratch);
+		DeinterleaveArray(mesh.sBoneIdx, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes, pScratch);
+		DeinterleaveArray(mesh.sBoneWeight, mesh.pInterleaved, mesh.nNumVertex, ui32AlignToNBytes, pScratch);
+		ScratchFree(pScratch, mesh.pInterleaved, mesh.nNumVertex * nInterleavedStride);
 	}
 	else
 	{
@@ -3521,7 +5203,7 @@ void PVRTModelPODToggleInterleaved(SPODMesh &mesh, const PVRTuint32 ui32AlignToN
 
 #undef NEEDED_PADDING
 		// Allocate interleaved array
-		SafeAlloc(mesh.pInterleaved, mesh.nNumVertex * nStride);
+		ScratchAlloc(pScratch, mesh.pInterleaved, mesh.nNumVertex * nStride);
 
 		// Interleave the data
 		nOffset = 0;
@@ -3529,42 +5211,55 @@ void PVRTModelPODToggleInterleaved(SPODMesh &mesh, const PVRTuint32 ui32AlignToN
 		for(nBytes = 4; nBytes > 0; nBytes >>= 1)
 		{
 			if(PVRTModelPODDataTypeSize(mesh.sVertex.eType) == nBytes)
-				InterleaveArray((char*)mesh.pInterleaved, mesh.sVertex, mesh.nNumVertex, nStride, nVertexPadding, nOffset);
+				InterleaveArray((char*)mesh.pInterleaved, mesh.sVertex, mesh.nNumVertex, nStride, nVertexPadding, nOffset, pScratch);
 
 			if(PVRTModelPODDataTypeSize(mesh.sNormals.eType) == nBytes)
-				InterleaveArray((char*)mesh.pInterleaved, mesh.sNormals, mesh.nNumVertex, nStride, nNormalPadding, nOffset);
+				InterleaveArray((char*)mesh.pInterleaved, mesh.sNormals, mesh.nNumVertex, nStride, nNormalPadding, nOffset, pScratch);
 
 			if(PVRTModelPODDataTypeSize(mesh.sTangents.eType) == nBytes)
-				InterleaveArray((char*)mesh.pInterleaved, mesh.sTangents, mesh.nNumVertex, nStride, nTangentPadding, nOffset);
+				InterleaveArray((char*)mesh.pInterleaved, mesh.sTangents, mesh.nNumVertex, nStride, nTangentPadding, nOffset, pScratch);
 
 			if(PVRTModelPODDataTypeSize(mesh.sBinormals.eType) == nBytes)
-				InterleaveArray((char*)mesh.pInterleaved, mesh.sBinormals, mesh.nNumVertex, nStride, nBinormalPadding, nOffset);
+				InterleaveArray((char*)mesh.pInterleaved, mesh.sBinormals, mesh.nNumVertex, nStride, nBinormalPadding, nOffset, pScratch);
 
 			if(PVRTModelPODDataTypeSize(mesh.sVtxColours.eType) == nBytes)
-				InterleaveArray((char*)mesh.pInterleaved, mesh.sVtxColours, mesh.nNumVertex, nStride, nVtxColourPadding, nOffset);
+				InterleaveArray((char*)mesh.pInterleaved, mesh.sVtxColours, mesh.nNumVertex, nStride, nVtxColourPadding, nOffset, pScratch);
 
 			for(i = 0; i < mesh.nNumUVW; ++i)
 			{
 				if(PVRTModelPODDataTypeSize(mesh.psUVW[i].eType) == nBytes)
-					InterleaveArray((char*)mesh.pInterleaved, mesh.psUVW[i], mesh.nNumVertex, nStride, nUVWPadding[i], nOffset);
+					InterleaveArray((char*)mesh.pInterleaved, mesh.psUVW[i], mesh.nNumVertex, nStride, nUVWPadding[i], nOffset, pScratch);
 			}
 
 			if(PVRTModelPODDataTypeSize(mesh.sBoneIdx.eType) == nBytes)
-				InterleaveArray((char*)mesh.pInterleaved, mesh.sBoneIdx, mesh.nNumVertex, nStride, nBoneIdxPadding, nOffset);
+				InterleaveArray((char*)mesh.pInterleaved, mesh.sBoneIdx, mesh.nNumVertex, nStride, nBoneIdxPadding, nOffset, pScratch);
 
 			if(PVRTModelPODDataTypeSize(mesh.sBoneWeight.eType) == nBytes)
-				InterleaveArray((char*)mesh.pInterleaved, mesh.sBoneWeight, mesh.nNumVertex, nStride, nBoneWeightPadding, nOffset);
+				InterleaveArray((char*)mesh.pInterleaved, mesh.sBoneWeight, mesh.nNumVertex, nStride, nBoneWeightPadding, nOffset, pScratch);
 		}
 	}
 }
 
 /*!***************************************************************************
- @Function			PVRTModelPODDeIndex
+ @Function		PVRTModelPODToggleInterleaved
+ @Modified		mesh		Mesh to modify
+ @Input			ui32AlignToNBytes Align the interleaved data to this no. of bytes.
+ @Description	Switches the supplied mesh to or from interleaved data format.
+*****************************************************************************/
+void PVRTModelPODToggleInterleaved(SPODMesh &mesh, const PVRTuint32 ui32AlignToNBytes)
+{
+	ToggleInterleaved(mesh, ui32AlignToNBytes, NULL);
+}
+
+/*!***************************************************************************
+ @Function			DeIndex
  @Modified			mesh		Mesh to modify
+ @Input				pScratch	Buffers to reuse, or NULL
  @Description		De-indexes the supplied mesh. The mesh must be
 					Interleaved before calling this function.
+					Freed buffers are given to pScratch for reuse.
 *****************************************************************************/
-void PVRTModelPODDeIndex(SPODMesh &mesh)
+static void DeIndex(SPODMesh &mesh, CPODScratch * const pScratch)
 {
 	unsigned char *pNew = 0;
 
@@ -3573,9 +5268,11 @@ void PVRTModelPODDeIndex(SPODMesh &mesh)
 
 	_ASSERT(mesh.nNumVertex && mesh.nNumFaces);
 
+	const size_t nOldVertexSize = mesh.sVertex.nStride * mesh.nNumVertex;
+
 	// Create a new vertex list
 	mesh.nNumVertex = PVRTModelPODCountIndices(mesh);
-	SafeAlloc(pNew, mesh.sVertex.nStride * mesh.nNumVertex);
+	ScratchAlloc(pScratch, pNew, mesh.sVertex.nStride * mesh.nNumVertex);
 
 	// Deindex the vertices
 	if(mesh.sFaces.eType == EPODDataUnsignedShort)
@@ -3592,24 +5289,37 @@ void PVRTModelPODDeIndex(SPODMesh &mesh)
 	}
 
 	// Replace the old vertex list
-	FREE(mesh.pInterleaved);
+	ScratchFree(pScratch, mesh.pInterleaved, nOldVertexSize);
 	mesh.pInterleaved = pNew;
 
 	// Get rid of the index list
-	FREE(mesh.sFaces.pData);
+	ScratchFree(pScratch, mesh.sFaces.pData, PVRTModelPODDataStride(mesh.sFaces) * mesh.nNumVertex);
 	mesh.sFaces.n		= 0;
 	mesh.sFaces.nStride	= 0;
 }
 
 /*!***************************************************************************
- @Function			PVRTModelPODToggleStrips
+ @Function			PVRTModelPODDeIndex
  @Modified			mesh		Mesh to modify
+ @Description		De-indexes the supplied mesh. The mesh must be
+					Interleaved before calling this function.
+*****************************************************************************/
+void PVRTModelPODDeIndex(SPODMesh &mesh)
+{
+	DeIndex(mesh, NULL);
+}
+
+/*!***************************************************************************
+ @Function			ToggleStrips
+ @Modified			mesh		Mesh to modify
+ @Input				pScratch	Buffers to reuse, or NULL
  @Description		Converts the supplied mesh to or from strips.
+					Freed buffers are given to pScratch for reuse.
 *****************************************************************************/
-void PVRTModelPODToggleStrips(SPODMesh &mesh)
+static void ToggleStrips(SPODMesh &mesh, CPODScratch * const pScratch)
 {
 	CPODData	old;
-	size_t	nIdxSize, nTriStride;
+	size_t	nIdxSize, nTriStride, nOldSize;
 
 	if(!mesh.nNumFaces)
 		return;
@@ -3617,10 +5327,11 @@ void PVRTModelPODToggleStrips(SPODMesh &mesh)
 	_ASSERT(mesh.sFaces.n == 1);
 	nIdxSize	= PVRTModelPODDataTypeSize(mesh.sFaces.eType);
 	nTriStride	= PVRTModelPODDataStride(mesh.sFaces) * 3;
+	nOldSize	= PVRTModelPODDataStride(mesh.sFaces) * PVRTModelPODCountIndices(mesh);
 
 	old					= mesh.sFaces;
 	mesh.sFaces.pData	= 0;
-	SafeAlloc(mesh.sFaces.pData, nTriStride * mesh.nNumFaces);
+	ScratchAlloc(pScratch, mesh.sFaces.pData, nTriStride * mesh.nNumFaces);
 
 	if(mesh.nNumStrips)
 	{
@@ -3638,145 +5349,698 @@ void PVRTModelPODToggleStrips(SPODMesh &mesh)
 				{
 					_ASSERT(j == 1); // Because this will surely break with any other number
 
-					memcpy(
-						(char*)mesh.sFaces.pData	+ nIdxSize * nListIdxCnt,
-						(char*)old.pData			+ nIdxSize * (nStripIdxCnt - 1),
-						nIdxSize);
-					nListIdxCnt += 1;
+					memcpy(
+						(char*)mesh.sFaces.pData	+ nIdxSize * nListIdxCnt,
+						(char*)old.pData			+ nIdxSize * (nStripIdxCnt - 1),
+						nIdxSize);
+					nListIdxCnt += 1;
+
+					memcpy(
+						(char*)mesh.sFaces.pData	+ nIdxSize * nListIdxCnt,
+						(char*)old.pData			+ nIdxSize * (nStripIdxCnt - 2),
+						nIdxSize);
+					nListIdxCnt += 1;
+
+					memcpy(
+						(char*)mesh.sFaces.pData	+ nIdxSize * nListIdxCnt,
+						(char*)old.pData			+ nIdxSize * nStripIdxCnt,
+						nIdxSize);
+					nListIdxCnt += 1;
+
+					nStripIdxCnt += 1;
+				}
+				else
+				{
+					memcpy(
+						(char*)mesh.sFaces.pData	+ nIdxSize * nListIdxCnt,
+						(char*)old.pData			+ nIdxSize * nStripIdxCnt,
+						nTriStride);
+
+					nStripIdxCnt += 3;
+					nListIdxCnt += 3;
+				}
+			}
+		}
+
+		_ASSERT(nListIdxCnt == mesh.nNumFaces*3);
+		FREE(mesh.pnStripLength);
+		mesh.nNumStrips = 0;
+	}
+	else
+	{
+		int		nIdxCnt;
+		int		nBatchCnt;
+		unsigned int n0, n1, n2;
+		unsigned int p0, p1, p2, nFaces;
+		unsigned char* pFaces;
+
+		//	Convert to strips
+		mesh.pnStripLength	= (unsigned int*)calloc(mesh.nNumFaces, sizeof(*mesh.pnStripLength));
+		mesh.nNumStrips		= 0;
+		nIdxCnt				= 0;
+		nBatchCnt			= mesh.sBoneBatches.nBatchCnt ? mesh.sBoneBatches.nBatchCnt : 1;
+
+		for(int h = 0; h < nBatchCnt; ++h)
+		{
+			n0 = 0;
+			n1 = 0;
+			n2 = 0;
+
+			if(!mesh.sBoneBatches.nBatchCnt)
+			{
+				nFaces = mesh.nNumFaces;
+				pFaces = old.pData;
+			}
+			else
+			{
+				if(h + 1 < mesh.sBoneBatches.nBatchCnt)
+					nFaces = mesh.sBoneBatches.pnBatchOffset[h+1] - mesh.sBoneBatches.pnBatchOffset[h];
+				else
+					nFaces = mesh.nNumFaces - mesh.sBoneBatches.pnBatchOffset[h];
+
+				pFaces = &old.pData[3 * mesh.sBoneBatches.pnBatchOffset[h] * old.nStride];
+			}
+
+			for(unsigned int i = 0; i < nFaces; ++i)
+			{
+				p0 = n0;
+				p1 = n1;
+				p2 = n2;
+
+				PVRTVertexRead(&n0, (char*)pFaces + (3 * i + 0) * old.nStride, old.eType);
+				PVRTVertexRead(&n1, (char*)pFaces + (3 * i + 1) * old.nStride, old.eType);
+				PVRTVertexRead(&n2, (char*)pFaces + (3 * i + 2) * old.nStride, old.eType);
+
+				if(mesh.pnStripLength[mesh.nNumStrips])
+				{
+					if(mesh.pnStripLength[mesh.nNumStrips] & 0x01)
+					{
+						if(p1 == n1 && p2 == n0)
+						{
+							PVRTVertexWrite((char*)mesh.sFaces.pData + nIdxCnt * mesh.sFaces.nStride, mesh.sFaces.eType, n2);
+							++nIdxCnt;
+							mesh.pnStripLength[mesh.nNumStrips] += 1;
+							continue;
+						}
+					}
+					else
+					{
+						if(p2 == n1 && p0 == n0)
+						{
+							PVRTVertexWrite((char*)mesh.sFaces.pData + nIdxCnt * mesh.sFaces.nStride, mesh.sFaces.eType, n2);
+							++nIdxCnt;
+							mesh.pnStripLength[mesh.nNumStrips] += 1;
+							continue;
+						}
+					}
+
+					++mesh.nNumStrips;
+				}
+
+				//	Start of strip, copy entire triangle
+				PVRTVertexWrite((char*)mesh.sFaces.pData + nIdxCnt * mesh.sFaces.nStride, mesh.sFaces.eType, n0);
+				++nIdxCnt;
+				PVRTVertexWrite((char*)mesh.sFaces.pData + nIdxCnt * mesh.sFaces.nStride, mesh.sFaces.eType, n1);
+				++nIdxCnt;
+				PVRTVertexWrite((char*)mesh.sFaces.pData + nIdxCnt * mesh.sFaces.nStride, mesh.sFaces.eType, n2);
+				++nIdxCnt;
+
+				mesh.pnStripLength[mesh.nNumStrips] += 1;
+			}
+		}
+
+		if(mesh.pnStripLength[mesh.nNumStrips])
+			++mesh.nNumStrips;
+
+		SafeRealloc(mesh.sFaces.pData, nIdxCnt * nIdxSize);
+		mesh.pnStripLength	= (unsigned int*)realloc(mesh.pnStripLength, sizeof(*mesh.pnStripLength) * mesh.nNumStrips);
+	}
+
+	ScratchFree(pScratch, old.pData, nOldSize);
+}
+
+/*!***************************************************************************
+ @Function			PVRTModelPODToggleStrips
+ @Modified			mesh		Mesh to modify
+ @Description		Converts the supplied mesh to or from strips.
+*****************************************************************************/
+void PVRTModelPODToggleStrips(SPODMesh &mesh)
+{
+	ToggleStrips(mesh, NULL);
+}
+
+/*!***************************************************************************
+ @Function		PVRTModelPODCountIndices
+ @Input			mesh		Mesh
+ @Return		Number of indices used by mesh
+ @Description	Counts the number of indices of a mesh
+*****************************************************************************/
+unsigned int PVRTModelPODCountIndices(const SPODMesh &mesh)
+{
+	return mesh.nNumStrips ? mesh.nNumFaces + (mesh.nNumStrips * 2) : mesh.nNumFaces * 3;
+}
+
+/*!***************************************************************************
+ @Function		PVRTModelPODCalculateACMR
+ @Input			mesh			Mesh
+ @Input			ui32CacheSize	Number of vertices held by the simulated cache
+ @Return		Average cache miss ratio of the mesh
+ @Description	Runs the indices of a mesh through a FIFO post-transform
+				vertex cache, and returns the number of vertices transformed
+				per triangle. Works for lists and strips.
+*****************************************************************************/
+float PVRTModelPODCalculateACMR(const SPODMesh &mesh, const unsigned int ui32CacheSize)
+{
+	unsigned int *pnLoaded = 0;
+	unsigned int nIdx, nMisses = 0;
+
+	if(!mesh.nNumFaces || !mesh.sFaces.pData || !ui32CacheSize)
+		return 0;
+
+	// pnLoaded holds the miss count after which each vertex entered the cache
+	if(!SafeAlloc(pnLoaded, mesh.nNumVertex))
+		return 0;
+
+	const unsigned int nCnt = PVRTModelPODCountIndices(mesh);
+
+	for(unsigned int i = 0; i < nCnt; ++i)
+	{
+		PVRTVertexRead(&nIdx, (char*)mesh.sFaces.pData + i * mesh.sFaces.nStride, mesh.sFaces.eType);
+
+		if(nIdx >= mesh.nNumVertex)
+		{
+			++nMisses;
+			continue;
+		}
+
+		if(!pnLoaded[nIdx] || nMisses - pnLoaded[nIdx] >= ui32CacheSize)
+			pnLoaded[nIdx] = ++nMisses;
+	}
+
+	FREE(pnLoaded);
+	return (float) nMisses / (float) mesh.nNumFaces;
+}
+
+/*!***************************************************************************
+ @Function			VertexCacheScore
+ @Input				nCachePos		Position of the vertex in the cache, or -1
+ @Input				nLive			Number of triangles still to be drawn that use the vertex
+ @Input				nCacheSize		Size of the cache
+ @Return			Score of the vertex
+ @Description		Scores a vertex as in Tom Forsyth's "Linear-Speed Vertex
+					Cache Optimisation": vertices of the last triangle and
+					near the front of the cache score highly, and vertices
+					with few triangles left are boosted so that they are
+					finished off rather than left stranded.
+*****************************************************************************/
+static float VertexCacheScore(const int nCachePos, const unsigned int nLive, const unsigned int nCacheSize)
+{
+	float fScore = 0;
+
+	if(!nLive)
+		return -1.0f;
+
+	if(nCachePos >= 0)
+	{
+		if(nCachePos < 3)
+			fScore = 0.75f;
+		else
+			fScore = powf(1.0f - (float)(nCachePos - 3) / (float)(nCacheSize - 3), 1.5f);
+	}
+
+	return fScore + 2.0f / sqrtf((float) nLive);
+}
+
+/*!***************************************************************************
+ @Function			OptimizeTriangleOrder
+ @Modified			pui32Idx		Indices of a triangle list
+ @Input				nTris			Number of triangles
+ @Input				nNumVertex		Number of vertices the indices refer to
+ @Input				nCacheSize		Size of the cache, at least four
+ @Input				pScratch		Buffers to reuse, or NULL
+ @Return			false if memory allocation failed
+ @Description		Reorders the triangles of a list for a post-transform
+					vertex cache with Tom Forsyth's greedy algorithm. Each
+					step draws the highest scoring triangle that uses a
+					cached vertex, or the next triangle in the original order
+					if there is none.
+*****************************************************************************/
+static bool OptimizeTriangleOrder(
+	PVRTuint32			* const pui32Idx,
+	const unsigned int	nTris,
+	const unsigned int	nNumVertex,
+	const unsigned int	nCacheSize,
+	CPODScratch			* const pScratch)
+{
+	unsigned int	*pnTriStart = 0, *pnTri = 0, *pnLive = 0, *pnCache = 0, *pnNewCache = 0;
+	PVRTuint32		*pui32Out = 0;
+	int				*pnCachePos = 0;
+	float			*pfScore = 0;
+	bool			*pbDrawn = 0;
+	unsigned int	i, j, k, nCached = 0, nCursor = 0, nBest;
+	bool			bOK;
+
+	bOK =	ScratchAlloc(pScratch, pnTriStart, nNumVertex + 1) &&
+			ScratchAlloc(pScratch, pnTri, nTris * 3) &&
+			ScratchAlloc(pScratch, pnLive, nNumVertex) &&
+			ScratchAlloc(pScratch, pnCache, nCacheSize + 3) &&
+			ScratchAlloc(pScratch, pnNewCache, nCacheSize + 3) &&
+			ScratchAlloc(pScratch, pui32Out, nTris * 3) &&
+			ScratchAlloc(pScratch, pnCachePos, nNumVertex) &&
+			ScratchAlloc(pScratch, pfScore, nNumVertex) &&
+			ScratchAlloc(pScratch, pbDrawn, nTris);
+
+	if(bOK)
+	{
+		// Build the lists of triangles using each vertex
+		for(i = 0; i < nTris * 3; ++i)
+			++pnLive[pui32Idx[i]];
+
+		for(i = 0; i < nNumVertex; ++i)
+		{
+			pnTriStart[i + 1]	= pnTriStart[i] + pnLive[i];
+			pnCachePos[i]		= -1;
+			pfScore[i]			= VertexCacheScore(-1, pnLive[i], nCacheSize);
+			pnLive[i]			= 0;
+		}
+
+		for(i = 0; i < nTris * 3; ++i)
+		{
+			const PVRTuint32 v = pui32Idx[i];
+			pnTri[pnTriStart[v] + pnLive[v]++] = i / 3;
+		}
+
+		nBest = nTris;
+
+		for(i = 0; i < nTris; ++i)
+		{
+			if(nBest == nTris)
+			{
+				while(pbDrawn[nCursor])
+					++nCursor;
+
+				nBest = nCursor;
+			}
+
+			// Draw the triangle, and remove it from the live lists of its vertices
+			const PVRTuint32 * const pui32Tri = &pui32Idx[nBest * 3];
+			unsigned int nNewCached = 0;
+
+			pbDrawn[nBest] = true;
+
+			for(j = 0; j < 3; ++j)
+			{
+				const PVRTuint32 v = pui32Tri[j];
+				unsigned int * const pnVtxTri = &pnTri[pnTriStart[v]];
+
+				pui32Out[i * 3 + j] = v;
+
+				for(k = 0; pnVtxTri[k] != nBest; ++k);
+				pnVtxTri[k] = pnVtxTri[--pnLive[v]];
+				pnVtxTri[pnLive[v]] = nBest;
+
+				for(k = 0; k < nNewCached && pnNewCache[k] != v; ++k);
+				if(k == nNewCached)
+					pnNewCache[nNewCached++] = v;
+			}
+
+			// The vertices of the triangle move to the front of the cache
+			const unsigned int nTriCached = nNewCached;
+
+			for(j = 0; j < nCached; ++j)
+			{
+				const unsigned int v = pnCache[j];
+
+				for(k = 0; k < nTriCached && pnNewCache[k] != v; ++k);
+				if(k == nTriCached)
+					pnNewCache[nNewCached++] = v;
+			}
+
+			for(j = 0; j < nNewCached; ++j)
+			{
+				const unsigned int v = pnNewCache[j];
+
+				pnCachePos[v]	= j < nCacheSize ? (int) j : -1;
+				pfScore[v]		= VertexCacheScore(pnCachePos[v], pnLive[v], nCacheSize);
+			}
+
+			nCached = PVRT_MIN(nNewCached, nCacheSize);
+			memcpy(pnCache, pnNewCache, nCached * sizeof(*pnCache));
+
+			// Pick the best triangle using a cached vertex
+			float fBest = -1.0f;
+			nBest = nTris;
+
+			for(j = 0; j < nCached; ++j)
+			{
+				const unsigned int v = pnCache[j];
+
+				for(k = 0; k < pnLive[v]; ++k)
+				{
+					const unsigned int t = pnTri[pnTriStart[v] + k];
+					const float fScore = pfScore[pui32Idx[t * 3 + 0]] + pfScore[pui32Idx[t * 3 + 1]] + pfScore[pui32Idx[t * 3 + 2]];
+
+					if(fScore > fBest)
+					{
+						fBest = fScore;
+						nBest = t;
+					}
+				}
+			}
+		}
+
+		memcpy(pui32Idx, pui32Out, nTris * 3 * sizeof(*pui32Idx));
+	}
+
+	ScratchFree(pScratch, pnTriStart, nNumVertex + 1);
+	ScratchFree(pScratch, pnTri, nTris * 3);
+	ScratchFree(pScratch, pnLive, nNumVertex);
+	ScratchFree(pScratch, pnCache, nCacheSize + 3);
+	ScratchFree(pScratch, pnNewCache, nCacheSize + 3);
+	ScratchFree(pScratch, pui32Out, nTris * 3);
+	ScratchFree(pScratch, pnCachePos, nNumVertex);
+	ScratchFree(pScratch, pfScore, nNumVertex);
+	ScratchFree(pScratch, pbDrawn, nTris);
+	return bOK;
+}
+
+/*!***************************************************************************
+ @Function			RemapArray
+ @Modified			data			Vertex array to reorder
+ @Input				pnOld			The old index of each new vertex
+ @Input				nNumVertex		Number of vertices
+ @Input				pScratch		Buffers to reuse, or NULL
+ @Return			false if memory allocation failed
+ @Description		Reorders a vertex array that is not interleaved.
+*****************************************************************************/
+static bool RemapArray(CPODData &data, const unsigned int * const pnOld, const unsigned int nNumVertex, CPODScratch * const pScratch)
+{
+	PVRTuint8 *pNew = 0;
+
+	if(!data.n || !data.pData)
+		return true;
+
+	if(!ScratchAlloc(pScratch, pNew, (size_t) data.nStride * nNumVertex))
+		return false;
+
+	for(unsigned int i = 0; i < nNumVertex; ++i)
+		memcpy(pNew + i * data.nStride, data.pData + pnOld[i] * data.nStride, data.nStride);
+
+	ScratchFree(pScratch, data.pData, (size_t) data.nStride * nNumVertex);
+	data.pData = pNew;
+	return true;
+}
+
+/*!***************************************************************************
+ @Function			OptimizeVertexCache
+ @Modified			mesh			Mesh to modify
+ @Input				ui32CacheSize	Size of the post-transform vertex cache
+ @Input				pScratch		Buffers to reuse, or NULL
+ @Return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Reorders the triangles of an indexed triangle list for the
+					vertex cache, then the vertices into the order in which
+					the triangles first use them. Freed buffers are given to
+					pScratch for reuse.
+*****************************************************************************/
+static EPVRTError OptimizeVertexCache(SPODMesh &mesh, const unsigned int ui32CacheSize, CPODScratch * const pScratch)
+{
+	PVRTuint32		*pui32Idx = 0;
+	unsigned int	*pnNew = 0, *pnOld = 0;
+	unsigned int	i, nBatchCnt, nUsed = 0;
+	bool			bOK;
+
+	if(!mesh.nNumFaces)
+		return PVR_SUCCESS;
+
+	if(mesh.nNumStrips || !mesh.sFaces.pData || ui32CacheSize < 4)
+		return PVR_FAIL;
+
+	const unsigned int nIdx = mesh.nNumFaces * 3;
 
-					memcpy(
-						(char*)mesh.sFaces.pData	+ nIdxSize * nListIdxCnt,
-						(char*)old.pData			+ nIdxSize * (nStripIdxCnt - 2),
-						nIdxSize);
-					nListIdxCnt += 1;
+	bOK =	ScratchAlloc(pScratch, pui32Idx, nIdx) &&
+			ScratchAlloc(pScratch, pnNew, mesh.nNumVertex) &&
+			ScratchAlloc(pScratch, pnOld, mesh.nNumVertex);
 
-					memcpy(
-						(char*)mesh.sFaces.pData	+ nIdxSize * nListIdxCnt,
-						(char*)old.pData			+ nIdxSize * nStripIdxCnt,
-						nIdxSize);
-					nListIdxCnt += 1;
+	for(i = 0; bOK && i < nIdx; ++i)
+	{
+		PVRTVertexRead(&pui32Idx[i], (char*)mesh.sFaces.pData + i * mesh.sFaces.nStride, mesh.sFaces.eType);
+		bOK = pui32Idx[i] < mesh.nNumVertex;
+	}
 
-					nStripIdxCnt += 1;
-				}
-				else
-				{
-					memcpy(
-						(char*)mesh.sFaces.pData	+ nIdxSize * nListIdxCnt,
-						(char*)old.pData			+ nIdxSize * nStripIdxCnt,
-						nTriStride);
+	// Reorder the triangles within each bone batch
+	nBatchCnt = mesh.sBoneBatches.nBatchCnt ? mesh.sBoneBatches.nBatchCnt : 1;
 
-					nStripIdxCnt += 3;
-					nListIdxCnt += 3;
-				}
-			}
+	for(i = 0; bOK && i < nBatchCnt; ++i)
+	{
+		unsigned int nStart = 0, nEnd = mesh.nNumFaces;
+
+		if(mesh.sBoneBatches.nBatchCnt)
+		{
+			nStart = mesh.sBoneBatches.pnBatchOffset[i];
+
+			if(i + 1 < nBatchCnt)
+				nEnd = mesh.sBoneBatches.pnBatchOffset[i + 1];
 		}
 
-		_ASSERT(nListIdxCnt == mesh.nNumFaces*3);
-		FREE(mesh.pnStripLength);
-		mesh.nNumStrips = 0;
+		if(nStart < nEnd)
+			bOK = OptimizeTriangleOrder(&pui32Idx[nStart * 3], nEnd - nStart, mesh.nNumVertex, ui32CacheSize, pScratch);
 	}
-	else
-	{
-		int		nIdxCnt;
-		int		nBatchCnt;
-		unsigned int n0, n1, n2;
-		unsigned int p0, p1, p2, nFaces;
-		unsigned char* pFaces;
 
-		//	Convert to strips
-		mesh.pnStripLength	= (unsigned int*)calloc(mesh.nNumFaces, sizeof(*mesh.pnStripLength));
-		mesh.nNumStrips		= 0;
-		nIdxCnt				= 0;
-		nBatchCnt			= mesh.sBoneBatches.nBatchCnt ? mesh.sBoneBatches.nBatchCnt : 1;
+	if(bOK)
+	{
+		// Number the vertices in the order of first use; unused vertices go last
+		for(i = 0; i < mesh.nNumVertex; ++i)
+			pnNew[i] = 0xFFFFFFFF;
 
-		for(int h = 0; h < nBatchCnt; ++h)
+		for(i = 0; i < nIdx; ++i)
 		{
-			n0 = 0;
-			n1 = 0;
-			n2 = 0;
-
-			if(!mesh.sBoneBatches.nBatchCnt)
+			if(pnNew[pui32Idx[i]] == 0xFFFFFFFF)
 			{
-				nFaces = mesh.nNumFaces;
-				pFaces = old.pData;
+				pnOld[nUsed] = pui32Idx[i];
+				pnNew[pui32Idx[i]] = nUsed++;
 			}
-			else
+
+			pui32Idx[i] = pnNew[pui32Idx[i]];
+		}
+
+		for(i = 0; i < mesh.nNumVertex; ++i)
+		{
+			if(pnNew[i] == 0xFFFFFFFF)
+				pnOld[nUsed++] = i;
+		}
+
+		if(mesh.pInterleaved)
+		{
+			PVRTuint8 *pNew = 0;
+			const size_t nStride = mesh.sVertex.nStride;
+
+			bOK = ScratchAlloc(pScratch, pNew, nStride * mesh.nNumVertex);
+
+			if(bOK)
 			{
-				if(h + 1 < mesh.sBoneBatches.nBatchCnt)
-					nFaces = mesh.sBoneBatches.pnBatchOffset[h+1] - mesh.sBoneBatches.pnBatchOffset[h];
-				else
-					nFaces = mesh.nNumFaces - mesh.sBoneBatches.pnBatchOffset[h];
+				for(i = 0; i < mesh.nNumVertex; ++i)
+					memcpy(pNew + i * nStride, mesh.pInterleaved + pnOld[i] * nStride, nStride);
 
-				pFaces = &old.pData[3 * mesh.sBoneBatches.pnBatchOffset[h] * old.nStride];
+				ScratchFree(pScratch, mesh.pInterleaved, nStride * mesh.nNumVertex);
+				mesh.pInterleaved = pNew;
 			}
+		}
+		else
+		{
+			bOK =	RemapArray(mesh.sVertex, pnOld, mesh.nNumVertex, pScratch) &&
+					RemapArray(mesh.sNormals, pnOld, mesh.nNumVertex, pScratch) &&
+					RemapArray(mesh.sTangents, pnOld, mesh.nNumVertex, pScratch) &&
+					RemapArray(mesh.sBinormals, pnOld, mesh.nNumVertex, pScratch) &&
+					RemapArray(mesh.sVtxColours, pnOld, mesh.nNumVertex, pScratch) &&
+					RemapArray(mesh.sBoneIdx, pnOld, mesh.nNumVertex, pScratch) &&
+					RemapArray(mesh.sBoneWeight, pnOld, mesh.nNumVertex, pScratch);
+
+			for(i = 0; bOK && i < mesh.nNumUVW; ++i)
+				bOK = RemapArray(mesh.psUVW[i], pnOld, mesh.nNumVertex, pScratch);
+		}
+	}
 
-			for(unsigned int i = 0; i < nFaces; ++i)
-			{
-				p0 = n0;
-				p1 = n1;
-				p2 = n2;
+	if(bOK)
+	{
+		for(i = 0; i < nIdx; ++i)
+			PVRTVertexWrite((char*)mesh.sFaces.pData + i * mesh.sFaces.nStride, mesh.sFaces.eType, pui32Idx[i]);
+	}
 
-				PVRTVertexRead(&n0, (char*)pFaces + (3 * i + 0) * old.nStride, old.eType);
-				PVRTVertexRead(&n1, (char*)pFaces + (3 * i + 1) * old.nStride, old.eType);
-				PVRTVertexRead(&n2, (char*)pFaces + (3 * i + 2) * old.nStride, old.eType);
+	ScratchFree(pScratch, pui32Idx, nIdx);
+	ScratchFree(pScratch, pnNew, mesh.nNumVertex);
+	ScratchFree(pScratch, pnOld, mesh.nNumVertex);
+	return bOK ? PVR_SUCCESS : PVR_FAIL;
+}
 
-				if(mesh.pnStripLength[mesh.nNumStrips])
-				{
-					if(mesh.pnStripLength[mesh.nNumStrips] & 0x01)
-					{
-						if(p1 == n1 && p2 == n0)
-						{
-							PVRTVertexWrite((char*)mesh.sFaces.pData + nIdxCnt * mesh.sFaces.nStride, mesh.sFaces.eType, n2);
-							++nIdxCnt;
-							mesh.pnStripLength[mesh.nNumStrips] += 1;
-							continue;
-						}
-					}
-					else
-					{
-						if(p2 == n1 && p0 == n0)
-						{
-							PVRTVertexWrite((char*)mesh.sFaces.pData + nIdxCnt * mesh.sFaces.nStride, mesh.sFaces.eType, n2);
-							++nIdxCnt;
-							mesh.pnStripLength[mesh.nNumStrips] += 1;
-							continue;
-						}
-					}
+/*!***************************************************************************
+ @Function			PVRTModelPODOptimizeVertexCache
+ @Modified			mesh			Mesh to modify
+ @Input				ui32CacheSize	Size of the post-transform vertex cache
+ @Return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Reorders the triangles of an indexed triangle list for the
+					vertex cache, then the vertices into the order in which
+					the triangles first use them.
+*****************************************************************************/
+EPVRTError PVRTModelPODOptimizeVertexCache(SPODMesh &mesh, const unsigned int ui32CacheSize)
+{
+	return OptimizeVertexCache(mesh, ui32CacheSize, NULL);
+}
 
-					++mesh.nNumStrips;
-				}
+/*!****************************************************************************
+ @Struct      SPODMeshJob
+ @Brief       Shared state for processing the meshes of a scene in parallel
+******************************************************************************/
+struct SPODMeshJob
+{
+	CPVRTModelPOD			*pPod;			/*!< Scene whose meshes are processed */
+	const SPODMeshStep		*pSteps;		/*!< Operations to apply */
+	unsigned int			ui32NumSteps;	/*!< Number of operations */
+	const PVRTuint64		*pOrder;		/*!< Mesh indices in the low 32 bits, largest mesh first */
+	volatile unsigned int	ui32Next;		/*!< Next entry of pOrder to hand out */
+	volatile bool			bFailed;		/*!< Set if any operation fails */
+};
 
-				//	Start of strip, copy entire triangle
-				PVRTVertexWrite((char*)mesh.sFaces.pData + nIdxCnt * mesh.sFaces.nStride, mesh.sFaces.eType, n0);
-				++nIdxCnt;
-				PVRTVertexWrite((char*)mesh.sFaces.pData + nIdxCnt * mesh.sFaces.nStride, mesh.sFaces.eType, n1);
-				++nIdxCnt;
-				PVRTVertexWrite((char*)mesh.sFaces.pData + nIdxCnt * mesh.sFaces.nStride, mesh.sFaces.eType, n2);
-				++nIdxCnt;
+/*!***************************************************************************
+ @Function			ProcessMesh
+ @Modified			pod				Scene owning the mesh
+ @Input				ui32Mesh		Index of the mesh
+ @Input				pSteps			Operations to apply
+ @Input				ui32NumSteps	Number of operations
+ @Modified			scratch			Buffers to reuse
+ @Return			true if successful
+ @Description		Applies the operations of a PVRTModelPODProcessMeshes()
+					pipeline to one mesh.
+*****************************************************************************/
+static bool ProcessMesh(
+	CPVRTModelPOD		&pod,
+	const unsigned int	ui32Mesh,
+	const SPODMeshStep	* const pSteps,
+	const unsigned int	ui32NumSteps,
+	CPODScratch			&scratch)
+{
+	SPODMesh &mesh = pod.pMesh[ui32Mesh];
 
-				mesh.pnStripLength[mesh.nNumStrips] += 1;
-			}
+	// The mesh data is rewritten, so it must be decoded and owned by the heap. Each
+	// thread handles different meshes, which LoadMeshData() and UnmapMeshData() allow.
+	if(pod.LoadMeshData(ui32Mesh) != PVR_SUCCESS || pod.UnmapMeshData(ui32Mesh) != PVR_SUCCESS)
+		return false;
+
+	for(unsigned int i = 0; i < ui32NumSteps; ++i)
+	{
+		const PVRTuint32 * const pArg = pSteps[i].ui32Arg;
+
+		switch(pSteps[i].eStep)
+		{
+		case ePODMeshScaleAndConvertVtxData:
+#if !defined(PVRT_FIXED_POINT_ENABLE)
+			if(ScaleAndConvertVtxData(mesh, (EPVRTDataType) pArg[0], &scratch) != PVR_SUCCESS)
+				return false;
+			break;
+#else
+			return false;
+#endif
+		case ePODMeshReorderFaces:		PVRTModelPODReorderFaces(mesh, (int) pArg[0], (int) pArg[1], (int) pArg[2]);	break;
+		case ePODMeshToggleInterleaved:	ToggleInterleaved(mesh, pArg[0] ? pArg[0] : 1, &scratch);	break;
+		case ePODMeshDeIndex:			DeIndex(mesh, &scratch);		break;
+		case ePODMeshToggleStrips:		ToggleStrips(mesh, &scratch);	break;
+		case ePODMeshOptimizeVertexCache:
+			if(OptimizeVertexCache(mesh, pArg[0] ? pArg[0] : PVRTMODELPOD_VERTEX_CACHE_SIZE, &scratch) != PVR_SUCCESS)
+				return false;
+			break;
+		default:						return false;
 		}
+	}
+	return true;
+}
 
-		if(mesh.pnStripLength[mesh.nNumStrips])
-			++mesh.nNumStrips;
+/*!***************************************************************************
+ @Function			ProcessMeshes
+ @Input				pUserData		The SPODMeshJob
+ @Input				ui32Worker		Index of the worker
+ @Description		Processes meshes of the job until none remain. Each
+					worker keeps its own buffers for reuse across all the
+					meshes it processes.
+*****************************************************************************/
+static void ProcessMeshes(void *pUserData, const unsigned int ui32Worker)
+{
+	SPODMeshJob &job = *(SPODMeshJob*) pUserData;
+	CPODScratch scratch;
+	unsigned int i;
 
-		SafeRealloc(mesh.sFaces.pData, nIdxCnt * nIdxSize);
-		mesh.pnStripLength	= (unsigned int*)realloc(mesh.pnStripLength, sizeof(*mesh.pnStripLength) * mesh.nNumStrips);
+	(void) ui32Worker;
+
+#if defined(_WIN32)
+	while((i = job.ui32Next++) < job.pPod->nNumMesh)
+#else
+	while((i = __sync_fetch_and_add(&job.ui32Next, 1)) < job.pPod->nNumMesh)
+#endif
+	{
+		if(!ProcessMesh(*job.pPod, (unsigned int) job.pOrder[i], job.pSteps, job.ui32NumSteps, scratch))
+			job.bFailed = true;
 	}
+}
 
-	FREE(old.pData);
+/*!***************************************************************************
+ @Function			CompareMeshSize
+ @Description		qsort comparator placing the largest meshes first, so the
+					biggest meshes start processing before the small ones.
+*****************************************************************************/
+static int CompareMeshSize(const void *pA, const void *pB)
+{
+	const PVRTuint64 nA = *(const PVRTuint64*) pA, nB = *(const PVRTuint64*) pB;
+	return nA > nB ? -1 : (nA < nB ? 1 : 0);
 }
 
 /*!***************************************************************************
- @Function		PVRTModelPODCountIndices
- @Input			mesh		Mesh
- @Return		Number of indices used by mesh
- @Description	Counts the number of indices of a mesh
+ @Function			PVRTModelPODProcessMeshes
+ @Modified			pod				Scene whose meshes to process
+ @Input				pSteps			Operations to apply to each mesh, in order
+ @Input				ui32NumSteps	Number of operations
+ @Input				ui32MaxThreads	Upper limit on the number of threads
+ @Return			PVR_SUCCESS if successful, PVR_FAIL if any operation failed
+ @Description		Applies a sequence of mesh operations to every mesh of the
+					scene, processing several meshes at once, with each
+					thread recycling the buffers freed by one operation for
+					the allocations of the next.
 *****************************************************************************/
-unsigned int PVRTModelPODCountIndices(const SPODMesh &mesh)
+EPVRTError PVRTModelPODProcessMeshes(
+	CPVRTModelPOD		&pod,
+	const SPODMeshStep	* const pSteps,
+	const unsigned int	ui32NumSteps,
+	const unsigned int	ui32MaxThreads)
 {
-	return mesh.nNumStrips ? mesh.nNumFaces + (mesh.nNumStrips * 2) : mesh.nNumFaces * 3;
+	if(!pod.nNumMesh)
+		return PVR_SUCCESS;
+
+	// Sort the meshes by size, keeping the index in the low bits
+	PVRTuint64 *pOrder = new PVRTuint64[pod.nNumMesh];
+
+	for(unsigned int i = 0; i < pod.nNumMesh; ++i)
+	{
+		const SPODMesh &mesh = pod.pMesh[i];
+		const PVRTuint64 nSize = (PVRTuint64) mesh.nNumVertex + (PVRTuint64) mesh.nNumFaces * 3;
+		pOrder[i] = (nSize << 32) | i;
+	}
+
+	qsort(pOrder, pod.nNumMesh, sizeof(*pOrder), CompareMeshSize);
+
+	SPODMeshJob job;
+	job.pPod			= &pod;
+	job.pSteps			= pSteps;
+	job.ui32NumSteps	= ui32NumSteps;
+	job.pOrder			= pOrder;
+	job.ui32Next		= 0;
+	job.bFailed			= false;
+
+	// Each worker takes meshes until none remain
+	unsigned int ui32Workers = ui32MaxThreads ? ui32MaxThreads : PVRTParallelThreadCount();
+	if(ui32Workers > pod.nNumMesh)
+		ui32Workers = pod.nNumMesh;
+
+	PVRTParallelFor(ui32Workers, &ProcessMeshes, &job, ui32Workers);
+
+	delete [] pOrder;
+	return job.bFailed ? PVR_FAIL : PVR_SUCCESS;
 }
 
 /*!***************************************************************************
@@ -4398,7 +6662,10 @@ static bool MergeTexture(const CPVRTModelPOD &src, CPVRTModelPOD &dst, const int
 	{
 		if(dstTexID == -1)
 		{
-			// Resize our texture array to add our texture
+			// Resize our texture array to add our texture, moving it to the heap first if it is in the mapping or arena
+			if(!UnmapData(dst, dst.pTexture, dst.nNumTexture))
+				return false;
+
 			dst.pTexture = (SPODTexture*) realloc(dst.pTexture, (dst.nNumTexture + 1) * sizeof(SPODTexture));
 
 			if(!dst.pTexture)
@@ -4448,7 +6715,7 @@ static bool MergeTexture(const CPVRTModelPOD &src, CPVRTModelPOD &dst, const int
 		if(bFilenameMatch)
 		{
 			// Our filenames match but our extensions don't so merge our textures
-			FREE(dst.pTexture[dstTexID].pszName);
+			FreeUnlessBorrowed(dst, dst.pTexture[dstTexID].pszName);
 			dst.pTexture[dstTexID].pszName = (char*) malloc(strlen(src.pTexture[srcTexID].pszName) + 1);
 			strcpy(dst.pTexture[dstTexID].pszName, src.pTexture[srcTexID].pszName);
 			return true;
@@ -4569,14 +6836,14 @@ EPVRTError PVRTModelPODMergeMaterials(const CPVRTModelPOD &src, CPVRTModelPOD &d
 				// Merge effect names
 				if(srcMaterial.pszEffectFile)
 				{
-					FREE(dstMaterial.pszEffectFile);
+					FreeUnlessBorrowed(dst, dstMaterial.pszEffectFile);
 					dstMaterial.pszEffectFile = (char*) malloc(strlen(srcMaterial.pszEffectFile) + 1);
 					strcpy(dstMaterial.pszEffectFile, srcMaterial.pszEffectFile);
 				}
 
 				if(srcMaterial.pszEffectName)
 				{
-					FREE(dstMaterial.pszEffectName);
+					FreeUnlessBorrowed(dst, dstMaterial.pszEffectName);
 					dstMaterial.pszEffectName = (char*) malloc(strlen(srcMaterial.pszEffectName) + 1);
 					strcpy(dstMaterial.pszEffectName, srcMaterial.pszEffectName);
 				}
@@ -4590,6 +6857,153 @@ EPVRTError PVRTModelPODMergeMaterials(const CPVRTModelPOD &src, CPVRTModelPOD &d
 	return PVR_SUCCESS;
 }
 
+/*!***************************************************************************
+ @Function			PVRTModelPODHashFile
+ @Input				pszFileName		File to hash, relative to the read path
+ @Output			ui32Hash		Hash of the file content
+ @Output			ui32Size		Size of the file in bytes
+ @Return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Hashes the content of a POD file, to identify the source
+					of a baked POD file.
+*****************************************************************************/
+EPVRTError PVRTModelPODHashFile(const char * const pszFileName, PVRTuint32 &ui32Hash, PVRTuint32 &ui32Size)
+{
+	CSourceStream src;
+	size_t nReadPos, nSize;
+	bool bInPlace;
+
+	if(!pszFileName || !src.Init(pszFileName))
+		return PVR_FAIL;
+
+	const PVRTuint8 * const pData = src.GetBuffer(nReadPos, nSize, bInPlace);
+	if(!pData)
+		return PVR_FAIL;
+
+	ui32Hash = CPVRTHash::MakeHash(pData, 1, (unsigned int) nSize);
+	ui32Size = (PVRTuint32) nSize;
+	return PVR_SUCCESS;
+}
+
+/*!***************************************************************************
+ @Function			PVRTModelPODBake
+ @Modified			pod			Scene to bake
+ @Input				ui32Flags	PVRTMODELPODBF_* flags
+ @Return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Converts every mesh of the scene to the layout in which it
+					is drawn: interleaved, with four byte aligned elements,
+					and with the triangles optionally reordered for the
+					vertex cache and the texture coordinates flipped.
+*****************************************************************************/
+EPVRTError PVRTModelPODBake(CPVRTModelPOD &pod, const PVRTuint32 ui32Flags)
+{
+	for(unsigned int i = 0; i < pod.nNumMesh; ++i)
+	{
+		SPODMesh &mesh = pod.pMesh[i];
+
+		// The mesh data is rewritten, so it must be decoded and owned by the heap
+		if(pod.LoadMeshData(i) != PVR_SUCCESS || pod.UnmapMeshData(i) != PVR_SUCCESS)
+			return PVR_FAIL;
+
+		// Meshes of strips are left in their order
+		if((ui32Flags & PVRTMODELPODBF_OPTIMIZED_VERTEX_CACHE) && !mesh.nNumStrips && mesh.sFaces.pData)
+		{
+			if(PVRTModelPODOptimizeVertexCache(mesh) != PVR_SUCCESS)
+				return PVR_FAIL;
+		}
+
+		if(!mesh.pInterleaved)
+			PVRTModelPODToggleInterleaved(mesh, 4);
+
+		if(!(ui32Flags & PVRTMODELPODBF_FLIPPED_UVS))
+			continue;
+
+		for(unsigned int j = 0; j < mesh.nNumUVW; ++j)
+		{
+			const CPODData &uvw = mesh.psUVW[j];
+
+			if(uvw.n < 2)
+				continue;
+
+			if(uvw.eType != EPODDataFloat)
+			{
+				PVRTErrorOutputDebug("Error: Only float texture coordinates can be flipped when baking a POD file.\n");
+				return PVR_FAIL;
+			}
+
+			PVRTuint8 *pV = mesh.pInterleaved + (size_t) uvw.pData + sizeof(float);
+			for(unsigned int k = 0; k < mesh.nNumVertex; ++k, pV += uvw.nStride)
+			{
+				float fV;
+				memcpy(&fV, pV, sizeof(fV));
+				fV = 1.0f - fV;
+				memcpy(pV, &fV, sizeof(fV));
+			}
+		}
+	}
+	return PVR_SUCCESS;
+}
+
+/*!***************************************************************************
+ @Function			PVRTModelPODSaveBaked
+ @Input				pod				Scene baked with PVRTModelPODBake()
+ @Input				pszFileName		File to save to
+ @Input				info			Source and flags of the baked scene
+ @Return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Saves a baked POD file, recording the bake information in
+					the file history, and aligning the mesh data for use in
+					place by ReadFromMappedFile().
+*****************************************************************************/
+EPVRTError PVRTModelPODSaveBaked(CPVRTModelPOD &pod, const char * const pszFileName, const SPODBakeInfo &info)
+{
+	char pszHistory[64];
+	sprintf(pszHistory, PVRTMODELPOD_BAKE_HISTORY, info.ui32SourceHash, info.ui32SourceSize, info.ui32Flags);
+
+	return pod.SavePOD(pszFileName, NULL, pszHistory, 4);
+}
+
+/*!***************************************************************************
+ @Function			PVRTModelPODReadBakeInfo
+ @Input				pszFileName		Baked file, relative to the read path
+ @Output			info			Source and flags of the baked scene
+ @Return			PVR_SUCCESS if the file is a baked POD file, PVR_FAIL if not
+ @Description		Reads the bake information from the history of a baked POD
+					file. The history precedes the scene, so only the start of
+					the file is read when it can be mapped.
+*****************************************************************************/
+EPVRTError PVRTModelPODReadBakeInfo(const char * const pszFileName, SPODBakeInfo &info)
+{
+	char pszHistory[64];
+	memset(pszHistory, 0, sizeof(pszHistory));
+
+	if(!pszFileName)
+		return PVR_FAIL;
+
+#if !defined(_WIN32)
+	CSourceMapped src;
+	CPVRTString Path(CPVRTResourceFile::GetReadPath());
+	Path += pszFileName;
+
+	if(src.Init(Path.c_str()))
+	{
+		if(!Read(NULL, src, NULL, 0, pszHistory, sizeof(pszHistory) - 1))
+			return PVR_FAIL;
+	}
+	else
+#endif
+	{
+		CSourceStream stream;
+		if(!stream.Init(pszFileName) || !Read(NULL, stream, NULL, 0, pszHistory, sizeof(pszHistory) - 1))
+			return PVR_FAIL;
+	}
+
+	SPODBakeInfo read;
+	if(sscanf(pszHistory, PVRTMODELPOD_BAKE_HISTORY, &read.ui32SourceHash, &read.ui32SourceSize, &read.ui32Flags) != 3)
+		return PVR_FAIL;
+
+	info = read;
+	return PVR_SUCCESS;
+}
+
 /*****************************************************************************
  End of file (PVRTModelPOD.cpp)
 *****************************************************************************/
@@ -21,6 +21,13 @@
 // PVRTMODELPOD Scene Flags
 #define PVRTMODELPODSF_FIXED	(0x00000001)   /*!< PVRTMODELPOD Fixed-point 16.16 data (otherwise float) flag */
 
+// PVRTMODELPOD Bake Flags
+#define PVRTMODELPODBF_FLIPPED_UVS	(0x00000001)   /*!< Baked texture coordinates are flipped vertically (v' = 1 - v) */
+#define PVRTMODELPODBF_OPTIMIZED_VERTEX_CACHE	(0x00000002)   /*!< Baked triangle lists are reordered for the vertex cache */
+
+#define PVRTMODELPOD_VERTEX_CACHE_SIZE	(32)	/*!< Default post-transform vertex cache size, in vertices */
+#define PVRTMODELPOD_ARENA_BLOCK_SIZE	(64 * 1024)	/*!< Smallest block allocated by the arena of a model */
+
 /****************************************************************************
 ** Enumerations
 ****************************************************************************/
@@ -107,6 +114,20 @@ enum EPODBlendOp
 	ePODBlendOp_REVERSE_SUBTRACT
 };
 
+/*!****************************************************************************
+ @struct      EPODMeshStep
+ @brief       Mesh operations that PVRTModelPODProcessMeshes() can apply
+******************************************************************************/
+enum EPODMeshStep
+{
+	ePODMeshScaleAndConvertVtxData,	/*!< PVRTModelPODScaleAndConvertVtxData() to the EPVRTDataType in ui32Arg[0] */
+	ePODMeshReorderFaces,			/*!< PVRTModelPODReorderFaces() with the indices in ui32Arg[0..2] */
+	ePODMeshToggleInterleaved,		/*!< PVRTModelPODToggleInterleaved() aligned to ui32Arg[0] bytes, or one if zero */
+	ePODMeshDeIndex,				/*!< PVRTModelPODDeIndex() */
+	ePODMeshToggleStrips,			/*!< PVRTModelPODToggleStrips() */
+	ePODMeshOptimizeVertexCache		/*!< PVRTModelPODOptimizeVertexCache() for a cache of ui32Arg[0] vertices, or PVRTMODELPOD_VERTEX_CACHE_SIZE if zero */
+};
+
 /****************************************************************************
 ** Structures
 ****************************************************************************/
@@ -298,6 +319,48 @@ struct SPODScene {
 	PVRTchar8		*pUserData;
 };
 
+/*!****************************************************************************
+ @struct      SPODBakeInfo
+ @brief       Identifies the POD file a baked POD file was produced from
+******************************************************************************/
+struct SPODBakeInfo {
+	PVRTuint32			ui32SourceHash;	/*!< Hash of the content of the source POD file */
+	PVRTuint32			ui32SourceSize;	/*!< Size of the source POD file in bytes */
+	PVRTuint32			ui32Flags;		/*!< PVRTMODELPODBF_* flags the file was baked with */
+};
+
+/*!****************************************************************************
+ @struct      SPODWorldMatrixCacheStats
+ @brief       Counters of the world-matrix cache of a CPVRTModelPOD
+******************************************************************************/
+struct SPODWorldMatrixCacheStats {
+	PVRTuint64			nLookups;	/*!< Calls to GetWorldMatrix() */
+	PVRTuint64			nZeroHits;	/*!< Lookups at frame zero, served by the frame-zero cache */
+	PVRTuint64			nHits;		/*!< Other lookups served by the cache */
+	PVRTuint64			nMisses;	/*!< Lookups that computed the world matrix */
+	PVRTuint64			nEvictions;	/*!< Frames dropped from the cache to make room for others */
+};
+
+/*!****************************************************************************
+ @struct      SPODArenaStats
+ @brief       Memory used by the arena of a CPVRTModelPOD
+******************************************************************************/
+struct SPODArenaStats {
+	size_t				nBlocks;		/*!< Number of blocks allocated from the heap */
+	size_t				nBytesReserved;	/*!< Total size of the blocks */
+	size_t				nBytesUsed;		/*!< Bytes handed out, including alignment padding */
+	size_t				nAllocations;	/*!< Number of allocations served by the arena */
+};
+
+/*!****************************************************************************
+ @struct      SPODMeshStep
+ @brief       One operation of a PVRTModelPODProcessMeshes() pipeline
+******************************************************************************/
+struct SPODMeshStep {
+	EPODMeshStep		eStep;			/*!< Operation to apply */
+	PVRTuint32			ui32Arg[3];		/*!< Arguments of the operation */
+};
+
 struct SPVRTPODImpl;	// Internal implementation data
 
 /*!***************************************************************************
@@ -339,6 +402,30 @@ public:
 		char			* const pszHistory = NULL,
 		const size_t	historyCount = 0);
 
+	/*!***************************************************************************
+	@fn       			ReadFromMappedFile
+	@param[in]			pszFileName		Filename to load
+	@param[in]			bLazyMeshData	Defer decoding the mesh data until LoadMeshData()
+	@return			    PVR_SUCCESS if successful, PVR_FAIL if not
+	@brief     		    Loads the specified ".POD" file by mapping it into memory
+						rather than reading it into a buffer. Where alignment and
+						endianness allow, the mesh face, vertex and interleaved data
+						point directly into the mapping instead of being copied;
+						use IsMappedData() to test a pointer, and UnmapMeshData()
+						to take a private copy before modifying or freeing it. The
+						mapping is released by Destroy(). Falls back to
+						ReadFromFile() if the file cannot be mapped.
+						If bLazyMeshData is true, the loader only indexes the
+						mesh blocks and reads the mesh descriptions, including
+						the bone batches. The face, vertex and interleaved data
+						pointers of each mesh remain NULL until LoadMeshData()
+						is called for that mesh. Meshes must be loaded before
+						being passed to the PVRTModelPOD*() utility functions.
+						Lazy loading is ignored if the file is read with
+						ReadFromFile() instead.
+	*****************************************************************************/
+	EPVRTError ReadFromMappedFile(const char * const pszFileName, const bool bLazyMeshData = false);
+
 	/*!***************************************************************************
 	@brief     		    Loads the supplied pod data. This data can be exported
 						directly to a header using one of the pod exporters.
@@ -414,16 +501,162 @@ public:
 	/*!***********************************************************************
 	 @fn       		FlushCache
 	 @brief     	Clears the matrix cache; use this if necessary when you
-					edit the position or animation of a node.
+					edit the position, animation or parent of a node.
 	*************************************************************************/
 	void FlushCache();
 
+	/*!***********************************************************************
+	 @fn       		SetWorldMatrixCacheSize
+	 @param[in]		nFrames			Number of frames to cache
+	 @param[in]		fFrameQuantum	Step to round the frames to, or zero
+	 @return		PVR_SUCCESS if successful, PVR_FAIL if no model is loaded
+	 @brief     	Sets how many frames of world matrices GetWorldMatrix()
+					caches, in addition to frame zero. When the cache is
+					full, the least recently used frame is dropped. If
+					fFrameQuantum is not zero, frames are rounded to the
+					nearest multiple of it, and the world matrices are
+					computed at the rounded frame, so that instances at
+					nearby frames share them. Empties the cache. The
+					default is one frame, not rounded.
+	*************************************************************************/
+	EPVRTError SetWorldMatrixCacheSize(const unsigned int nFrames, const VERTTYPE fFrameQuantum = 0);
+
+	/*!***********************************************************************
+	 @fn       		GetWorldMatrixCacheStats
+	 @param[out]	sStats			Counters of the world-matrix cache
+	 @brief     	Returns how GetWorldMatrix() calls were served since the
+					model was loaded or ResetWorldMatrixCacheStats() was
+					called, to help choose the size of the cache.
+	*************************************************************************/
+	void GetWorldMatrixCacheStats(SPODWorldMatrixCacheStats &sStats) const;
+
+	/*!***********************************************************************
+	 @fn       		ResetWorldMatrixCacheStats
+	 @brief     	Zeroes the counters of the world-matrix cache.
+	*************************************************************************/
+	void ResetWorldMatrixCacheStats();
+
 	/*!***********************************************************************
 	@fn       		IsLoaded
 	@brief     	Boolean to check whether a POD file has been loaded.
 	*************************************************************************/
 	bool IsLoaded();
 
+	/*!***********************************************************************
+	@fn       		SetDecodeThreadCount
+	@param[in]		ui32Threads		Number of threads; zero uses all processors
+	@brief     		Sets the number of threads used to decode POD files loaded
+					from a file or from memory. The loader first scans the
+					scene markers to locate each mesh, node and material block,
+					then decodes those blocks concurrently. The loaded data is
+					identical to that of the serial loader, which is used when
+					this is set to one. The default is zero.
+	*************************************************************************/
+	static void SetDecodeThreadCount(const unsigned int ui32Threads);
+
+	/*!***********************************************************************
+	@fn       		GetDecodeThreadCount
+	@return			Number of decode threads; zero means all processors
+	@brief     		Returns the value set with SetDecodeThreadCount().
+	*************************************************************************/
+	static unsigned int GetDecodeThreadCount();
+
+	/*!***********************************************************************
+	@fn       		SetArenaAllocation
+	@param[in]		bArena		Whether to allocate from an arena
+	@brief     		Sets whether POD files loaded from a file or from memory
+					allocate their scene content from an arena: a few large
+					blocks, owned by the model, from which the node names,
+					animation tracks, materials, cameras and mesh content are
+					allocated in turn, and which Destroy() frees all at once.
+					This avoids one heap allocation per object when loading,
+					and one heap release per object when destroying. Data
+					allocated from the arena must not be freed or reallocated;
+					use IsArenaData() to test a pointer, and UnmapMeshData()
+					to move the data of a mesh to the heap. Destroy() does not
+					visit the objects in the arena; it frees individually only
+					the meshes moved to the heap by UnmapMeshData() or decoded
+					by LoadMeshData(). Models that are already loaded are not
+					affected. The default is false.
+	*************************************************************************/
+	static void SetArenaAllocation(const bool bArena);
+
+	/*!***********************************************************************
+	@fn       		GetArenaAllocation
+	@return			Whether new models allocate from an arena
+	@brief     		Returns the value set with SetArenaAllocation().
+	*************************************************************************/
+	static bool GetArenaAllocation();
+
+	/*!***********************************************************************
+	@fn       		IsArenaData
+	@param[in]		pData		Pointer to test
+	@return			true if pData was allocated from the arena
+	@brief     		Returns whether the specified data was allocated from the
+					arena of this model. Such data must not be freed or
+					reallocated.
+	*************************************************************************/
+	bool IsArenaData(const void * const pData) const;
+
+	/*!***********************************************************************
+	@fn       		GetArenaStats
+	@param[out]		sStats		Memory used by the arena
+	@brief     		Returns the memory used by the arena of this model. All
+					counts are zero if the model was not loaded into an arena.
+	*************************************************************************/
+	void GetArenaStats(SPODArenaStats &sStats) const;
+
+	/*!***********************************************************************
+	@fn       		IsMappedData
+	@param[in]		pData		Pointer to test
+	@return			true if pData points into the file mapping
+	@brief     		Returns whether the specified data points directly into
+					the memory mapping created by ReadFromMappedFile(). Such
+					data must not be freed or reallocated.
+	*************************************************************************/
+	bool IsMappedData(const void * const pData) const;
+
+	/*!***********************************************************************
+	@fn       		UnmapMeshData
+	@param[in]		ui32Mesh	Index of the mesh
+	@return			PVR_SUCCESS if successful, PVR_FAIL if not
+	@brief     		Replaces any data of the mesh that points into the file
+					mapping, or that was allocated from the arena, with a
+					heap copy. Call this before modifying the mesh with the
+					PVRTModelPOD*() utility functions, or before handing the
+					mesh data over to code that will free it. Different meshes
+					may be unmapped, and loaded with LoadMeshData(), from
+					several threads at once, but each mesh must only be used
+					by one thread at a time.
+	*************************************************************************/
+	EPVRTError UnmapMeshData(const unsigned int ui32Mesh);
+
+	/*!***********************************************************************
+	@fn       		LoadMeshData
+	@param[in]		ui32Mesh	Index of the mesh
+	@return			PVR_SUCCESS if successful, PVR_FAIL if not
+	@brief     		Decodes the face, vertex and interleaved data of a mesh
+					whose decoding was deferred by ReadFromMappedFile(). Does
+					nothing if the data is already available. Each call reads
+					only the file mapping and writes only the specified mesh,
+					allocating from the heap, so different meshes may be loaded,
+					and unmapped with UnmapMeshData(), from several threads at
+					once. Loading the same mesh from two threads at once is
+					not safe.
+	*************************************************************************/
+	EPVRTError LoadMeshData(const unsigned int ui32Mesh);
+
+	/*!***********************************************************************
+	@fn       		IsMeshDataLoaded
+	@param[in]		ui32Mesh	Index of the mesh
+	@return			true if the mesh data has been decoded
+	@brief     		Returns whether the face, vertex and interleaved data of
+					a mesh is available. This is only false for meshes of a
+					lazily loaded model that have not yet been passed to
+					LoadMeshData().
+	*************************************************************************/
+	bool IsMeshDataLoaded(const unsigned int ui32Mesh) const;
+
 	/*!***************************************************************************
 	 @fn       		Destroy
 	 @brief     	Frees the memory allocated to store the scene in pScene.
@@ -433,11 +666,36 @@ public:
 	/*!***************************************************************************
 	 @fn       		SetFrame
 	 @param[in]			fFrame			Frame number
+	 @param[in]			bEvaluateWorldMatrices	Whether to compute the world
+										matrices of all the nodes now
 	 @brief     	Set the animation frame for which subsequent Get*() calls
-					should return data.
+					should return data. If bEvaluateWorldMatrices is true,
+					the world matrices of all the nodes are computed in one
+					pass and cached, so that GetWorldMatrix() does not need
+					to walk the parents of each node.
 	*****************************************************************************/
 	void SetFrame(
-		const VERTTYPE fFrame);
+		const VERTTYPE fFrame,
+		const bool bEvaluateWorldMatrices = false);
+
+	/*!***************************************************************************
+	 @fn       		EvaluateWorldMatrices
+	 @param[out]	pmOut			nCount * nNumNode world matrices
+	 @param[in]		pfFrames		Frame of each evaluation
+	 @param[in]		nCount			Number of evaluations
+	 @param[in]		pmInstance		Matrix of each evaluation, or NULL
+	 @brief     	Computes the world matrices of all the nodes at several
+					frames, for example for a crowd of instances that share
+					this model. The matrices of evaluation i are written to
+					pmOut[i * nNumNode] onwards, in node order, and are
+					transformed by pmInstance[i] if pmInstance is not NULL.
+					The current frame is left unchanged.
+	*****************************************************************************/
+	void EvaluateWorldMatrices(
+		PVRTMATRIX			* const pmOut,
+		const VERTTYPE		* const pfFrames,
+		const unsigned int	nCount,
+		const PVRTMATRIX	* const pmInstance = NULL);
 
 	/*!***************************************************************************
 	 @brief     	Generates the world matrix for the given Mesh Instance;
@@ -668,9 +926,16 @@ public:
 	 @param[in]		pszFilename		Filename to save to
 	 @param[in]		pszExpOpt		A string containing the options used by the exporter
 	 @param[in]		pszHistory		A string containing the history of the exported pod file
-	 @brief     	Save a binary POD file (.POD).
+	 @param[in]		ui32DataAlign	If not zero, the mesh face, vertex and interleaved data
+									are padded to start at file offsets that are multiples
+									of this value, so that ReadFromMappedFile() can use them
+									in place.
+	 @brief     	Save a binary POD file (.POD). The data of meshes read
+					lazily by ReadFromMappedFile() is loaded with
+					LoadMeshData() first, and PVR_FAIL is returned if it
+					cannot be.
 	*****************************************************************************/
-	EPVRTError SavePOD(const char * const pszFilename, const char * const pszExpOpt = 0, const char * const pszHistory = 0);
+	EPVRTError SavePOD(const char * const pszFilename, const char * const pszExpOpt = 0, const char * const pszHistory = 0, const unsigned int ui32DataAlign = 0);
 
 private:
 	SPVRTPODImpl	*m_pImpl;	/*!< Internal implementation data */
@@ -789,6 +1054,55 @@ void PVRTModelPODToggleStrips(SPODMesh &mesh);
 *****************************************************************************/
 unsigned int PVRTModelPODCountIndices(const SPODMesh &mesh);
 
+/*!***************************************************************************
+ @fn       		PVRTModelPODCalculateACMR
+ @param[in]		mesh			Mesh
+ @param[in]		ui32CacheSize	Number of vertices held by the simulated cache
+ @return		Average cache miss ratio: vertices transformed per triangle
+ @brief     	Measures how well a mesh uses a FIFO post-transform vertex
+				cache. The result ranges from 3 for a mesh that shares no
+				vertices to about 0.5 for an ideally ordered regular grid.
+*****************************************************************************/
+float PVRTModelPODCalculateACMR(const SPODMesh &mesh, const unsigned int ui32CacheSize = PVRTMODELPOD_VERTEX_CACHE_SIZE);
+
+/*!***************************************************************************
+ @fn       		PVRTModelPODOptimizeVertexCache
+ @Modified		mesh			Mesh to modify
+ @param[in]		ui32CacheSize	Size of the post-transform vertex cache, at
+								least four
+ @return		PVR_SUCCESS if successful, PVR_FAIL if not
+ @brief     	Reorders the triangles of an indexed triangle list so that
+				they reuse the vertices in the post-transform cache, using
+				Tom Forsyth's linear-speed algorithm, then reorders the
+				vertices into the order in which the triangles first use
+				them, which improves the locality of vertex fetches. The
+				triangles of each bone batch stay within the batch. Meshes
+				of strips and non-indexed meshes are not supported.
+*****************************************************************************/
+EPVRTError PVRTModelPODOptimizeVertexCache(SPODMesh &mesh, const unsigned int ui32CacheSize = PVRTMODELPOD_VERTEX_CACHE_SIZE);
+
+/*!***************************************************************************
+ @fn       		PVRTModelPODProcessMeshes
+ @Modified		pod				Scene whose meshes to process
+ @param[in]		pSteps			Operations to apply to each mesh, in order
+ @param[in]		ui32NumSteps	Number of operations
+ @param[in]		ui32MaxThreads	Upper limit on the number of threads, as for
+								PVRTParallelFor(); zero uses all processors
+ @return		PVR_SUCCESS if successful, PVR_FAIL if any operation failed
+ @brief     	Applies a sequence of the mesh operations above to every
+				mesh of the scene, processing several meshes at once. The
+				mesh data is decoded and copied out of any file mapping
+				first. Each thread recycles the buffers freed by one
+				operation for the allocations of the next, rather than
+				returning them to the heap. The result is the same as
+				calling the operations on each mesh in turn.
+*****************************************************************************/
+EPVRTError PVRTModelPODProcessMeshes(
+	CPVRTModelPOD		&pod,
+	const SPODMeshStep	* const pSteps,
+	const unsigned int	ui32NumSteps,
+	const unsigned int	ui32MaxThreads = 0);
+
 /*!***************************************************************************
  @fn       			PVRTModelPODCopyCPODData
  @param[in]			in
@@ -872,6 +1186,60 @@ EPVRTError PVRTModelPODFlattenToWorldSpace(CPVRTModelPOD &in, CPVRTModelPOD &out
 *****************************************************************************/
 EPVRTError PVRTModelPODMergeMaterials(const CPVRTModelPOD &src, CPVRTModelPOD &dst);
 
+/*!***************************************************************************
+ @fn       			PVRTModelPODHashFile
+ @param[in]			pszFileName		File to hash, relative to the read path
+ @param[out]		ui32Hash		Hash of the file content
+ @param[out]		ui32Size		Size of the file in bytes
+ @return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @brief     		Hashes the content of a POD file, to identify the source
+					of a baked POD file.
+*****************************************************************************/
+EPVRTError PVRTModelPODHashFile(const char * const pszFileName, PVRTuint32 &ui32Hash, PVRTuint32 &ui32Size);
+
+/*!***************************************************************************
+ @fn       			PVRTModelPODBake
+ @param[in,out]		pod			Scene to bake
+ @param[in]			ui32Flags	PVRTMODELPODBF_* flags
+ @return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @brief     		Converts every mesh of the scene to the layout in which it
+					is drawn, so that loading it needs no further per-vertex
+					processing. The vertex data of each mesh is interleaved,
+					with each element aligned to four bytes. If ui32Flags
+					contains PVRTMODELPODBF_OPTIMIZED_VERTEX_CACHE, triangle
+					lists are first reordered with
+					PVRTModelPODOptimizeVertexCache(). If ui32Flags
+					contains PVRTMODELPODBF_FLIPPED_UVS, the texture
+					coordinates, which must be floats, are flipped
+					vertically. Save the result with PVRTModelPODSaveBaked().
+*****************************************************************************/
+EPVRTError PVRTModelPODBake(CPVRTModelPOD &pod, const PVRTuint32 ui32Flags);
+
+/*!***************************************************************************
+ @fn       			PVRTModelPODSaveBaked
+ @param[in]			pod				Scene baked with PVRTModelPODBake()
+ @param[in]			pszFileName		File to save to
+ @param[in]			info			Source and flags of the baked scene
+ @return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @brief     		Saves a baked POD file. This is an ordinary POD file whose
+					history records the bake information, and whose mesh data
+					is aligned so that CPVRTModelPOD::ReadFromMappedFile() can
+					use it in place.
+*****************************************************************************/
+EPVRTError PVRTModelPODSaveBaked(CPVRTModelPOD &pod, const char * const pszFileName, const SPODBakeInfo &info);
+
+/*!***************************************************************************
+ @fn       			PVRTModelPODReadBakeInfo
+ @param[in]			pszFileName		Baked file, relative to the read path
+ @param[out]		info			Source and flags of the baked scene
+ @return			PVR_SUCCESS if the file is a baked POD file, PVR_FAIL if not
+ @brief     		Reads the bake information of a file saved with
+					PVRTModelPODSaveBaked(), without loading the scene. Compare
+					it with PVRTModelPODHashFile() of the source POD file to
+					decide whether the baked file is up to date.
+*****************************************************************************/
+EPVRTError PVRTModelPODReadBakeInfo(const char * const pszFileName, SPODBakeInfo &info);
+
 #endif /* _PVRTMODELPOD_H_ */
 
 /*****************************************************************************
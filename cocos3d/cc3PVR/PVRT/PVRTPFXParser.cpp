@@ -32,6 +32,7 @@
 #include "PVRTPFXParser.h"
 #include "PVRTResourceFile.h"
 #include "PVRTString.h"
+#include "PVRTMap.h"
 //#include "PVRTMisc.h"		// Used for POT functions	// patched for Cocos3D by Bill Hollings
 
 /****************************************************************************
@@ -78,10 +79,14 @@ public:
 	char			**ppszEffectFile;
 	int				*pnFileLineNumber;
 	unsigned int	nNumLines, nMaxLines;
+	char			*pszLines;			// Holds the text of all the lines, each null-terminated
+	unsigned int	*puiEndTagLines;	// Indices of the lines that begin with "[/", in order
+	unsigned int	nNumEndTagLines;
 
 public:
 	CPVRTPFXParserReadContext();
 	~CPVRTPFXParserReadContext();
+	bool Allocate(const unsigned int nLines, const size_t nTextSize);
 };
 
 /*!***************************************************************************
@@ -90,10 +95,13 @@ public:
 *****************************************************************************/
 CPVRTPFXParserReadContext::CPVRTPFXParserReadContext()
 {
-	nMaxLines = 5000;
+	nMaxLines = 0;
 	nNumLines = 0;
-	ppszEffectFile		= new char*[nMaxLines];
-	pnFileLineNumber	= new int[nMaxLines];
+	nNumEndTagLines		= 0;
+	ppszEffectFile		= NULL;
+	pnFileLineNumber	= NULL;
+	pszLines			= NULL;
+	puiEndTagLines		= NULL;
 }
 
 /*!***************************************************************************
@@ -103,12 +111,28 @@ CPVRTPFXParserReadContext::CPVRTPFXParserReadContext()
 CPVRTPFXParserReadContext::~CPVRTPFXParserReadContext()
 {
 	// free effect file
-	for(unsigned int i = 0; i < nNumLines; i++)
-	{
-		FREE(ppszEffectFile[i]);
-	}
+	FREE(pszLines);
 	delete [] ppszEffectFile;
 	delete [] pnFileLineNumber;
+	delete [] puiEndTagLines;
+}
+
+/*!***************************************************************************
+ @Function			Allocate
+ @Input				nLines			maximum number of lines
+ @Input				nTextSize		maximum size of the text of all lines,
+									including their terminators
+ @Return			true if successful
+ @Description		Allocates space for the lines of a PFX script, all at once.
+*****************************************************************************/
+bool CPVRTPFXParserReadContext::Allocate(const unsigned int nLines, const size_t nTextSize)
+{
+	nMaxLines			= nLines;
+	ppszEffectFile		= new char*[nMaxLines];
+	pnFileLineNumber	= new int[nMaxLines];
+	puiEndTagLines		= new unsigned int[nMaxLines];
+	pszLines			= (char*)malloc(nTextSize);
+	return pszLines != NULL;
 }
 
 /*!***************************************************************************
@@ -632,11 +656,13 @@ bool CPVRTPFXParser::Parse(CPVRTString * const pReturnError)
 		{
 			if(GetEndTag("VERTEXSHADER", nLine, &nEndLine))
 			{
-				SPVRTPFXParserShader VertexShader;
-				if(ParseShader(nLine, nEndLine, pReturnError, VertexShader, "VERTEXSHADER"))
-					m_psVertexShader.Append(VertexShader);
-				else
+				// Parse into place, rather than copying a parsed shader into the array
+				unsigned int uiIndex = m_psVertexShader.Append();
+				if(!ParseShader(nLine, nEndLine, pReturnError, m_psVertexShader[uiIndex], "VERTEXSHADER"))
+				{
+					m_psVertexShader.RemoveLast();
 					return false;
+				}
 			}
 			else
 			{
@@ -649,11 +675,12 @@ bool CPVRTPFXParser::Parse(CPVRTString * const pReturnError)
 		{
 			if(GetEndTag("FRAGMENTSHADER", nLine, &nEndLine))
 			{
-				SPVRTPFXParserShader FragShader;
-				if(ParseShader(nLine, nEndLine, pReturnError, FragShader, "FRAGMENTSHADER"))
-					m_psFragmentShader.Append(FragShader);
-				else
+				unsigned int uiIndex = m_psFragmentShader.Append();
+				if(!ParseShader(nLine, nEndLine, pReturnError, m_psFragmentShader[uiIndex], "FRAGMENTSHADER"))
+				{
+					m_psFragmentShader.RemoveLast();
 					return false;
+				}
 			}
 			else
 			{
@@ -666,11 +693,12 @@ bool CPVRTPFXParser::Parse(CPVRTString * const pReturnError)
 		{
 			if(GetEndTag("EFFECT", nLine, &nEndLine))
 			{
-				SPVRTPFXParserEffect Effect;
-				if(ParseEffect(Effect, nLine, nEndLine, pReturnError))
-					m_psEffect.Append(Effect);
-				else
+				unsigned int uiIndex = m_psEffect.Append();
+				if(!ParseEffect(m_psEffect[uiIndex], nLine, nEndLine, pReturnError))
+				{
+					m_psEffect.RemoveLast();
 					return false;
+				}
 			}
 			else
 			{
@@ -704,18 +732,34 @@ bool CPVRTPFXParser::Parse(CPVRTString * const pReturnError)
 		return false;
 	}
 
+	// Index the textures by the hash of their names, keeping the first of any duplicates
+	unsigned int uiTexSize = m_psTexture.GetSize();
+	CPVRTMap<PVRTuint32, unsigned int> TextureIndex;
+	TextureIndex.Reserve(uiTexSize);
+	for(k = 0; k < uiTexSize; ++k)
+	{
+		PVRTuint32 uiHash = m_psTexture[k]->Name.Hash();
+		if(!TextureIndex.Exists(uiHash))
+			TextureIndex[uiHash] = k;
+	}
+
 	// Loop Effects
 	for(i = 0; i < m_psEffect.GetSize(); ++i)
 	{
 		// Loop Textures in Effects
 		for(j = 0; j < m_psEffect[i].Textures.GetSize(); ++j)
 		{
-			// Loop Textures in whole PFX
-			unsigned int uiTexSize = m_psTexture.GetSize();
-			for(k = 0; k < uiTexSize; ++k)
+			// Look up the texture in the whole PFX. If another name has the same hash, search them all.
+			const CPVRTStringHash& Name = m_psEffect[i].Textures[j].Name;
+			const unsigned int* puiTex = TextureIndex.GetDataAtIndex(TextureIndex.GetIndexOf(Name.Hash()));
+			k = puiTex ? *puiTex : uiTexSize;
+			if(puiTex && !(m_psTexture[k]->Name == Name))
 			{
-				if(m_psTexture[k]->Name == m_psEffect[i].Textures[j].Name)
-					break;
+				for(k = 0; k < uiTexSize; ++k)
+				{
+					if(m_psTexture[k]->Name == Name)
+						break;
+				}
 			}
 
 			// Texture mismatch. Report error.
@@ -747,11 +791,14 @@ bool CPVRTPFXParser::Parse(CPVRTString * const pReturnError)
 EPVRTError CPVRTPFXParser::ParseFromMemory(const char * const pszScript, CPVRTString * const pReturnError)
 {
 	CPVRTPFXParserReadContext	context;
-	char			pszLine[512];
+	const unsigned int	nMaxLineLen = 511;
+	char			*pszLine;
 	const char		*pszEnd, *pszCurr;
 	int				nLineCounter;
 	unsigned int	nLen;
 	unsigned int	nReduce;
+	unsigned int	nLines;
+	size_t			nScriptLen;
 	bool			bDone;
 
 	if(!pszScript)
@@ -759,10 +806,28 @@ EPVRTError CPVRTPFXParser::ParseFromMemory(const char * const pszScript, CPVRTSt
 
 	m_psContext = &context;
 
+	// Size the lines in one pass. A long line is split into lines of at most nMaxLineLen
+	// characters, and each line takes no more space than its text and its terminator.
+	nLines = 1;
+	for(pszCurr = pszScript; *pszCurr; ++pszCurr)
+	{
+		if(*pszCurr == '\n')
+			++nLines;
+	}
+	nScriptLen = (size_t)(pszCurr - pszScript);
+	nLines += (unsigned int)(nScriptLen / nMaxLineLen);
+
+	if(!context.Allocate(nLines, nScriptLen + 1))
+	{
+		*pReturnError = CPVRTString("Unable to allocate memory for PFX script\n");
+		return PVR_FAIL;
+	}
+
 	// Find & process each line
 	nLineCounter	= 0;
 	bDone			= false;
 	pszCurr			= pszScript;
+	pszLine			= context.pszLines;
 	while(!bDone)
 	{
 		nLineCounter++;
@@ -786,12 +851,12 @@ EPVRTError CPVRTPFXParser::ParseFromMemory(const char * const pszScript, CPVRTSt
 		while(nLen - nReduce > 0 && pszCurr[nLen - 1 - nReduce] == '\r')
 			nReduce++;
 
-		// Ensure pszLine will not be not overrun
-		if(nLen+1-nReduce > sizeof(pszLine) / sizeof(*pszLine))
-			nLen = sizeof(pszLine) / sizeof(*pszLine) - 1 + nReduce;
+		// Ensure the line is not longer than the maximum
+		if(nLen - nReduce > nMaxLineLen)
+			nLen = nMaxLineLen + nReduce;
 
-		// Copy line into pszLine
-		strncpy(pszLine, pszCurr, nLen - nReduce);
+		// Copy line into the line store
+		memcpy(pszLine, pszCurr, nLen - nReduce);
 		pszLine[nLen - nReduce] = 0;
 		pszCurr += nLen + 1;
 
@@ -805,19 +870,16 @@ EPVRTError CPVRTPFXParser::ParseFromMemory(const char * const pszScript, CPVRTSt
 		// Reduce whitespace to one character.
 		ReduceWhitespace(pszLine);
 
+		// Index the lines that may hold end tags, for GetEndTag().
+		if(pszLine[0] == '[' && pszLine[1] == '/')
+			m_psContext->puiEndTagLines[m_psContext->nNumEndTagLines++] = m_psContext->nNumLines;
+
 		// Store the line, even if blank lines (to get correct errors from GLSL compiler).
-		if(m_psContext->nNumLines < m_psContext->nMaxLines)
-		{
-			m_psContext->pnFileLineNumber[m_psContext->nNumLines] = nLineCounter;
-			m_psContext->ppszEffectFile[m_psContext->nNumLines] = (char *)malloc((strlen(pszLine) + 1) * sizeof(char));
-			strcpy(m_psContext->ppszEffectFile[m_psContext->nNumLines], pszLine);
-			m_psContext->nNumLines++;
-		}
-		else
-		{
-			*pReturnError = PVRTStringFromFormattedStr("Too many lines of text in file (maximum is %d)\n", m_psContext->nMaxLines);
-			return PVR_FAIL;
-		}
+		_ASSERT(m_psContext->nNumLines < m_psContext->nMaxLines);
+		m_psContext->pnFileLineNumber[m_psContext->nNumLines] = nLineCounter;
+		m_psContext->ppszEffectFile[m_psContext->nNumLines] = pszLine;
+		m_psContext->nNumLines++;
+		pszLine += strlen(pszLine) + 1;
 	}
 
 	return Parse(pReturnError) ? PVR_SUCCESS : PVR_FAIL;
@@ -974,11 +1036,25 @@ bool CPVRTPFXParser::GetEndTag(const char* pszTagName, int nStartLine, int *pnEn
 	strcat(pszEndTag, pszTagName);
 	strcat(pszEndTag, "]");
 
-	for(unsigned int i = nStartLine; i < m_psContext->nNumLines; i++)
+	// Only the lines that began with "[/" when they were read can hold an end tag. Find the
+	// first of them at or after the start line, then check each in turn. The lines may have
+	// been tokenized since they were indexed, so their current text is compared.
+	const unsigned int *puiLines = m_psContext->puiEndTagLines;
+	unsigned int uiLow = 0, uiHigh = m_psContext->nNumEndTagLines;
+	while(uiLow < uiHigh)
+	{
+		unsigned int uiMid = (uiLow + uiHigh) / 2;
+		if((int)puiLines[uiMid] < nStartLine)
+			uiLow = uiMid + 1;
+		else
+			uiHigh = uiMid;
+	}
+
+	for(unsigned int i = uiLow; i < m_psContext->nNumEndTagLines; i++)
 	{
-		if(strcmp(pszEndTag, m_psContext->ppszEffectFile[i]) == 0)
+		if(strcmp(pszEndTag, m_psContext->ppszEffectFile[puiLines[i]]) == 0)
 		{
-			*pnEndLine = i;
+			*pnEndLine = puiLines[i];
 			return true;
 		}
 	}
@@ -991,66 +1067,31 @@ bool CPVRTPFXParser::GetEndTag(const char* pszTagName, int nStartLine, int *pnEn
  @Output			line		output text
  @Input				line		input text
  @Description		Reduces all white space characters in the string to one
-					blank space.
+					blank space, in a single pass.
 *****************************************************************************/
 void CPVRTPFXParser::ReduceWhitespace(char *line)
 {
-	// convert tabs and newlines to ' '
-	char *tmp = strpbrk (line, "\t\n");
-	while(tmp != NULL)
-	{
-		*tmp = ' ';
-		tmp = strpbrk (line, "\t\n");
-	}
+	char *pszOut = line;
+	bool bSpace = false;
 
-	// remove all whitespace at start
-	while(line[0] == ' ')
+	for(const char *pszIn = line; *pszIn; ++pszIn)
 	{
-		// move chars along to omit whitespace
-		int counter = 0;
-		do{
-			line[counter] = line[counter+1];
-			counter++;
-		}while(line[counter] != '\0');
-	}
-
-	// step through chars of line remove multiple whitespace
-	for(int i=0; i < (int)strlen(line); i++)
-	{
-		// whitespace found
-		if(line[i] == ' ')
+		// Tabs and newlines count as spaces. A run of spaces is written as one space,
+		// once the next character is found, so that spaces at the start and end are dropped.
+		if(*pszIn == ' ' || *pszIn == '\t' || *pszIn == '\n')
 		{
-			// count number of whitespace chars
-			int numWhiteChars = 0;
-			while(line[i+1+numWhiteChars] == ' ')
-			{
-				numWhiteChars++;
-			}
-
-			// multiple whitespace chars found
-			if(numWhiteChars>0)
-			{
-				// move chars along to omit whitespace
-				int counter=1;
-				while(line[i+counter] != '\0')
-				{
-					line[i+counter] = line[i+numWhiteChars+counter];
-					counter++;
-				}
-			}
+			bSpace = (pszOut != line);
+			continue;
 		}
-	}
-
-	// If there is no string then do not remove terminating white symbols
-	if(!strlen(line))
-	    return;
 
-	// remove all whitespace from end
-	while(line[strlen(line)-1] == ' ')
-	{
-		// move chars along to omit whitespace
-		line[strlen(line)-1] = '\0';
+		if(bSpace)
+		{
+			*pszOut++ = ' ';
+			bSpace = false;
+		}
+		*pszOut++ = *pszIn;
 	}
+	*pszOut = '\0';
 }
 
 /*!***************************************************************************
@@ -1280,15 +1321,15 @@ bool CPVRTPFXParser::ParseGenericSurface(int nStartLine, int nEndLine, SPVRTPFXP
 		if(!*m_psContext->ppszEffectFile[i])
 			continue;
 
-		// Need to make a copy so we can use strtok and not affect subsequent parsing
-		size_t lineLen = strlen(m_psContext->ppszEffectFile[i]);
-		char* pBlockCopy = new char[lineLen+1];
-		strcpy(pBlockCopy, m_psContext->ppszEffectFile[i]);
+		// Need to make a copy so we can use strtok and not affect subsequent parsing.
+		// Lines are never longer than ParseFromMemory() allows, so the copy fits on the stack.
+		char pBlockCopy[512];
+		strncpy(pBlockCopy, m_psContext->ppszEffectFile[i], sizeof(pBlockCopy) - 1);
+		pBlockCopy[sizeof(pBlockCopy) - 1] = 0;
 
 		char *str = strtok (pBlockCopy, NEWLINE_TOKENS DELIM_TOKENS);
 		if(!str)
 		{
-			delete[] pBlockCopy;
 			return false;		
 		}
 
@@ -1315,7 +1356,6 @@ bool CPVRTPFXParser::ParseGenericSurface(int nStartLine, int nEndLine, SPVRTPFXP
 			if(!pszRemaining)
 			{
 				*pReturnError = PVRTStringFromFormattedStr("Missing FILTER arguments in [%s] on line %d: %s\n", pCaller, m_psContext->pnFileLineNumber[i],  m_psContext->ppszEffectFile[i]);
-				delete[] pBlockCopy;
 				return false;
 			}
 
@@ -1328,7 +1368,6 @@ bool CPVRTPFXParser::ParseGenericSurface(int nStartLine, int nEndLine, SPVRTPFXP
 
 			if(!ParseTextureFlags(pszRemaining, pFlags, 3, c_ppszFilters, eFilter_Size, pReturnError, i))
 			{
-				delete[] pBlockCopy;
 				return false;
 			}
 
@@ -1341,7 +1380,6 @@ bool CPVRTPFXParser::ParseGenericSurface(int nStartLine, int nEndLine, SPVRTPFXP
 			if(!pszRemaining)
 			{
 				*pReturnError = PVRTStringFromFormattedStr("Missing WRAP arguments in [%s] on line %d: %s\n", pCaller, m_psContext->pnFileLineNumber[i],  m_psContext->ppszEffectFile[i]);
-				delete[] pBlockCopy;
 				return false;
 			}
 
@@ -1354,7 +1392,6 @@ bool CPVRTPFXParser::ParseGenericSurface(int nStartLine, int nEndLine, SPVRTPFXP
 
 			if(!ParseTextureFlags(pszRemaining, pFlags, 3, c_ppszWraps, eWrap_Size, pReturnError, i))
 			{
-				delete[] pBlockCopy;
 				return false;
 			}
 
@@ -1374,7 +1411,6 @@ bool CPVRTPFXParser::ParseGenericSurface(int nStartLine, int nEndLine, SPVRTPFXP
 				if(!pszRemaining)
 				{
 					*pReturnError = PVRTStringFromFormattedStr("Missing RESOLUTION argument(s) (requires width AND height) in [TARGET] on line %d\n", m_psContext->pnFileLineNumber[i]);
-					delete[] pBlockCopy;
 					return false;
 				}
 
@@ -1384,7 +1420,6 @@ bool CPVRTPFXParser::ParseGenericSurface(int nStartLine, int nEndLine, SPVRTPFXP
 					||  (val < 0))
 				{
 					*pReturnError = PVRTStringFromFormattedStr("Invalid RESOLUTION argument \"%s\" in [TEXTURE] on line %d\n", pszRemaining, m_psContext->pnFileLineNumber[i]);
-					delete[] pBlockCopy;
 					return false;
 				}
 
@@ -1400,7 +1435,6 @@ bool CPVRTPFXParser::ParseGenericSurface(int nStartLine, int nEndLine, SPVRTPFXP
 			if(!pszRemaining)
 			{
 				*pReturnError = PVRTStringFromFormattedStr("Missing SURFACETYPE arguments in [TARGET] on line %d\n", m_psContext->pnFileLineNumber[i]);
-				delete[] pBlockCopy;
 				return false;
 			}
 
@@ -1424,7 +1458,6 @@ bool CPVRTPFXParser::ParseGenericSurface(int nStartLine, int nEndLine, SPVRTPFXP
 			if(!pszRemaining)
 			{
 				*pReturnError = PVRTStringFromFormattedStr("Missing arguments in [%s] on line %d: %s\n", pCaller, m_psContext->pnFileLineNumber[i],  m_psContext->ppszEffectFile[i]);
-				delete[] pBlockCopy;
 				return false;
 			}
 
@@ -1442,7 +1475,6 @@ bool CPVRTPFXParser::ParseGenericSurface(int nStartLine, int nEndLine, SPVRTPFXP
 			if(Type == INVALID_TYPE)
 			{
 				*pReturnError = PVRTStringFromFormattedStr("Unknown keyword '%s' in [%s] on line %d: %s\n", pszRemaining, pCaller, m_psContext->pnFileLineNumber[i], m_psContext->ppszEffectFile[i]);
-				delete[] pBlockCopy;
 				return false;
 			}
 
@@ -1463,12 +1495,9 @@ bool CPVRTPFXParser::ParseGenericSurface(int nStartLine, int nEndLine, SPVRTPFXP
 			if(pszRemaining)
 			{
 				*pReturnError = PVRTStringFromFormattedStr("Unexpected keyword '%s' in [%s] on line %d: %s\n", pszRemaining, pCaller, m_psContext->pnFileLineNumber[i],  m_psContext->ppszEffectFile[i]);
-				delete[] pBlockCopy;
 				return false;
 			}
 		}	
-
-		delete [] pBlockCopy;
 	}
 
 	return true;
@@ -2649,12 +2678,12 @@ bool CPVRTPFXParser::ParseEffect(SPVRTPFXParserEffect &effect, const int nStartL
 *****************************************************************************/
 bool CPVRTPFXParser::DetermineRenderPassDependencies(CPVRTString * const pReturnError)
 {
-	unsigned int	ui(0), uj(0), uk(0);
+	unsigned int	ui(0);
 
 	if(m_RenderPasses.GetSize() == 0)
 		return true;
 
-	// --- Add all render pass nodes to the skip graph.
+	// --- Match each render pass with the effect that targets it.
 	for(ui = 0; ui < m_RenderPasses.GetSize(); ++ui)
 	{
 		SPVRTPFXRenderPass& Pass = m_RenderPasses[ui];
@@ -2694,11 +2723,24 @@ bool CPVRTPFXParser::DetermineRenderPassDependencies(CPVRTString * const pReturn
 			if(bFound)
 				break;
 		}
-
-		// Add a pointer to the post process
-		m_renderPassSkipGraph.AddNode(&Pass);
 	}
 
+	BuildRenderPassSkipGraph();
+	return true;
+}
+
+/*!***************************************************************************
+ @Function			BuildRenderPassSkipGraph
+ @Description		Adds every render pass to the skip graph, with a dependency
+					on each pass that renders a texture its effect reads.
+*****************************************************************************/
+void CPVRTPFXParser::BuildRenderPassSkipGraph()
+{
+	unsigned int	ui(0), uj(0), uk(0);
+
+	// --- Add a pointer to each pass to the skip graph
+	for(ui = 0; ui < m_RenderPasses.GetSize(); ++ui)
+		m_renderPassSkipGraph.AddNode(&m_RenderPasses[ui]);
 
 	// --- Loop through all created render passes in the skip graph and determine their dependencies
 	for(ui = 0; ui < m_renderPassSkipGraph.GetNumNodes(); ++ui)
@@ -2733,8 +2775,6 @@ bool CPVRTPFXParser::DetermineRenderPassDependencies(CPVRTString * const pReturn
 			}
 		}
 	}
-	
-	return true;
 }
 
 /*!***************************************************************************
@@ -2933,6 +2973,664 @@ int CPVRTPFXParser::FindTextureByName(const CPVRTStringHash& Name) const
 	return -1;
 }
 
+/****************************************************************************
+** Binary PFX files
+****************************************************************************/
+#define PFXBINARY_VERSION	1				// Increment whenever the layout changes
+#define PFXBINARY_NONE		0xFFFFFFFF		// Length of a NULL string, or index of no object
+
+static const char c_szPFXBinaryMagic[4] = { 'P', 'F', 'X', 'B' };
+
+/*!***************************************************************************
+ @Class				CPFXBinaryWriter
+ @Description		Accumulates the little-endian content of a binary PFX file.
+*****************************************************************************/
+class CPFXBinaryWriter
+{
+public:
+	CPFXBinaryWriter() : m_pData(NULL), m_nSize(0), m_nCapacity(0), m_bFailed(false) {}
+	~CPFXBinaryWriter() { FREE(m_pData); }
+
+	void WriteBytes(const void * const pData, const size_t nSize)
+	{
+		if(m_nSize + nSize > m_nCapacity)
+		{
+			size_t nCapacity = PVRT_MAX(m_nCapacity * 2, m_nSize + nSize + 1024);
+			char *pNew = (char*) realloc(m_pData, nCapacity);
+			if(!pNew)
+			{
+				m_bFailed = true;
+				return;
+			}
+			m_pData = pNew;
+			m_nCapacity = nCapacity;
+		}
+		if(nSize)
+			memcpy(m_pData + m_nSize, pData, nSize);
+		m_nSize += nSize;
+	}
+
+	void WriteUInt32(const PVRTuint32 ui32)
+	{
+		const PVRTuint8 pBytes[4] = { (PVRTuint8) ui32, (PVRTuint8) (ui32 >> 8), (PVRTuint8) (ui32 >> 16), (PVRTuint8) (ui32 >> 24) };
+		WriteBytes(pBytes, 4);
+	}
+
+	void WriteFloat(const float f)
+	{
+		PVRTuint32 ui32;
+		memcpy(&ui32, &f, 4);
+		WriteUInt32(ui32);
+	}
+
+	void WriteString(const CPVRTString &String)
+	{
+		WriteUInt32((PVRTuint32) String.length());
+		WriteBytes(String.c_str(), String.length());
+	}
+
+	void WriteCString(const char * const pszString)
+	{
+		if(!pszString)
+		{
+			WriteUInt32(PFXBINARY_NONE);
+			return;
+		}
+		size_t nLength = strlen(pszString);
+		WriteUInt32((PVRTuint32) nLength);
+		WriteBytes(pszString, nLength);
+	}
+
+	const char* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_nSize; }
+	bool Failed() const { return m_bFailed; }
+
+private:
+	char	*m_pData;
+	size_t	m_nSize, m_nCapacity;
+	bool	m_bFailed;
+};
+
+/*!***************************************************************************
+ @Class				CPFXBinaryReader
+ @Description		Reads the content of a binary PFX file, failing, rather than
+					reading past the end, if the content is truncated.
+*****************************************************************************/
+class CPFXBinaryReader
+{
+public:
+	CPFXBinaryReader(const void * const pData, const size_t nSize) : m_pData((const PVRTuint8*) pData), m_nSize(nSize), m_nPos(0), m_bFailed(false) {}
+
+	bool ReadBytes(void * const pData, const size_t nSize)
+	{
+		if(m_bFailed || nSize > m_nSize - m_nPos)
+		{
+			m_bFailed = true;
+			return false;
+		}
+		if(nSize)
+			memcpy(pData, m_pData + m_nPos, nSize);
+		m_nPos += nSize;
+		return true;
+	}
+
+	// Returns the next nSize bytes in place, or NULL if fewer remain
+	const void* ReadInPlace(const size_t nSize)
+	{
+		if(m_bFailed || nSize > m_nSize - m_nPos)
+		{
+			m_bFailed = true;
+			return NULL;
+		}
+		const void *pData = m_pData + m_nPos;
+		m_nPos += nSize;
+		return pData;
+	}
+
+	PVRTuint32 ReadUInt32()
+	{
+		PVRTuint8 pBytes[4];
+		if(!ReadBytes(pBytes, 4))
+			return 0;
+		return (PVRTuint32) pBytes[0] | ((PVRTuint32) pBytes[1] << 8) | ((PVRTuint32) pBytes[2] << 16) | ((PVRTuint32) pBytes[3] << 24);
+	}
+
+	float ReadFloat()
+	{
+		PVRTuint32 ui32 = ReadUInt32();
+		float f;
+		memcpy(&f, &ui32, 4);
+		return f;
+	}
+
+	// Reads a count of items, failing if the remaining content cannot hold that many
+	unsigned int ReadCount(const size_t nMinItemSize)
+	{
+		PVRTuint32 ui32Count = ReadUInt32();
+		if(m_bFailed || ui32Count > (m_nSize - m_nPos) / nMinItemSize)
+		{
+			m_bFailed = true;
+			return 0;
+		}
+		return ui32Count;
+	}
+
+	void ReadString(CPVRTString &String)
+	{
+		PVRTuint32 ui32Length = ReadCount(1);
+		if(m_bFailed)
+			return;
+		String.assign((const char*) m_pData + m_nPos, ui32Length);
+		m_nPos += ui32Length;
+	}
+
+	void ReadString(CPVRTStringHash &String)
+	{
+		CPVRTString Temp;
+		ReadString(Temp);
+		String.assign(Temp);
+	}
+
+	// Reads a string written by WriteCString() into a malloc'ed copy, or NULL
+	char* ReadCString()
+	{
+		PVRTuint32 ui32Length = ReadUInt32();
+		if(m_bFailed || ui32Length == PFXBINARY_NONE)
+			return NULL;
+
+		char *pszString = ui32Length <= m_nSize - m_nPos ? (char*) malloc(ui32Length + 1) : NULL;
+		if(!pszString || !ReadBytes(pszString, ui32Length))
+		{
+			m_bFailed = true;
+			FREE(pszString);
+			return NULL;
+		}
+		pszString[ui32Length] = '\0';
+		return pszString;
+	}
+
+	bool Failed() const { return m_bFailed; }
+
+private:
+	const PVRTuint8	*m_pData;
+	size_t			m_nSize, m_nPos;
+	bool			m_bFailed;
+};
+
+/*!***************************************************************************
+ @Function			WriteSemantic
+ @Modified			Writer			Binary content
+ @Input				Semantic		Semantic to write
+ @Description		Writes a uniform or attribute of an effect. Only the default
+					values used by the type of the semantic are written.
+*****************************************************************************/
+static void WriteSemantic(CPFXBinaryWriter &Writer, const SPVRTPFXParserSemantic &Semantic)
+{
+	const SPVRTSemanticDefaultData &Default = Semantic.sDefaultValue;
+
+	Writer.WriteCString(Semantic.pszName);
+	Writer.WriteCString(Semantic.pszValue);
+	Writer.WriteUInt32(Semantic.nIdx);
+	Writer.WriteUInt32((PVRTuint32) Default.eType);
+
+	if(Default.eType >= eNumDefaultDataTypes)
+		return;
+
+	const SPVRTSemanticDefaultDataTypeInfo &Info = c_psSemanticDefaultDataTypeInfo[Default.eType];
+	for(unsigned int i = 0; i < Info.nNumberDataItems; ++i)
+	{
+		switch(Info.eInternalType)
+		{
+			case eFloating:	Writer.WriteFloat(Default.pfData[i]);				break;
+			case eInteger:	Writer.WriteUInt32((PVRTuint32) Default.pnData[i]);	break;
+			case eBoolean:	Writer.WriteUInt32(Default.pbData[i] ? 1 : 0);		break;
+		}
+	}
+}
+
+/*!***************************************************************************
+ @Function			ReadSemantic
+ @Modified			Reader			Binary content
+ @Output			Semantic		Semantic read
+ @Description		Reads a semantic written by WriteSemantic().
+*****************************************************************************/
+static void ReadSemantic(CPFXBinaryReader &Reader, SPVRTPFXParserSemantic &Semantic)
+{
+	SPVRTSemanticDefaultData &Default = Semantic.sDefaultValue;
+
+	Semantic.pszName	= Reader.ReadCString();
+	Semantic.pszValue	= Reader.ReadCString();
+	Semantic.nIdx		= Reader.ReadUInt32();
+
+	memset(Default.pfData, 0, sizeof(Default.pfData));
+	memset(Default.pnData, 0, sizeof(Default.pnData));
+	memset(Default.pbData, 0, sizeof(Default.pbData));
+	PVRTuint32 ui32Type = Reader.ReadUInt32();
+	Default.eType = ui32Type <= eDataTypeRGBA ? (ESemanticDefaultDataType) ui32Type : eDataTypeNone;
+
+	if(Default.eType >= eNumDefaultDataTypes)
+		return;
+
+	const SPVRTSemanticDefaultDataTypeInfo &Info = c_psSemanticDefaultDataTypeInfo[Default.eType];
+	for(unsigned int i = 0; i < Info.nNumberDataItems; ++i)
+	{
+		switch(Info.eInternalType)
+		{
+			case eFloating:	Default.pfData[i] = Reader.ReadFloat();				break;
+			case eInteger:	Default.pnData[i] = (int) Reader.ReadUInt32();		break;
+			case eBoolean:	Default.pbData[i] = Reader.ReadUInt32() != 0;		break;
+		}
+	}
+}
+
+/*!***************************************************************************
+ @Function			WriteShader
+ @Modified			Writer			Binary content
+ @Input				Shader			Shader to write
+ @Description		Writes a vertex or fragment shader, including its code and
+					any binary loaded from a BINARYFILE.
+*****************************************************************************/
+static void WriteShader(CPFXBinaryWriter &Writer, const SPVRTPFXParserShader &Shader)
+{
+	Writer.WriteString(Shader.Name.String());
+	Writer.WriteUInt32(Shader.bUseFileName ? 1 : 0);
+	Writer.WriteCString(Shader.pszGLSLfile);
+	Writer.WriteCString(Shader.pszGLSLBinaryFile);
+	Writer.WriteCString(Shader.pszGLSLcode);
+	Writer.WriteUInt32(Shader.nFirstLineNumber);
+	Writer.WriteUInt32(Shader.nLastLineNumber);
+
+	if(Shader.pbGLSLBinary)
+	{
+		Writer.WriteUInt32(Shader.nGLSLBinarySize);
+		Writer.WriteBytes(Shader.pbGLSLBinary, Shader.nGLSLBinarySize);
+	}
+	else
+	{
+		Writer.WriteUInt32(PFXBINARY_NONE);
+	}
+}
+
+/*!***************************************************************************
+ @Function			ReadShader
+ @Modified			Reader			Binary content
+ @Output			Shader			Shader read
+ @Description		Reads a shader written by WriteShader().
+*****************************************************************************/
+static void ReadShader(CPFXBinaryReader &Reader, SPVRTPFXParserShader &Shader)
+{
+	Reader.ReadString(Shader.Name);
+	Shader.bUseFileName			= Reader.ReadUInt32() != 0;
+	Shader.pszGLSLfile			= Reader.ReadCString();
+	Shader.pszGLSLBinaryFile	= Reader.ReadCString();
+	Shader.pszGLSLcode			= Reader.ReadCString();
+	Shader.nFirstLineNumber		= Reader.ReadUInt32();
+	Shader.nLastLineNumber		= Reader.ReadUInt32();
+	Shader.pbGLSLBinary			= NULL;
+	Shader.nGLSLBinarySize		= 0;
+
+	PVRTuint32 ui32BinarySize = Reader.ReadUInt32();
+	if(ui32BinarySize == PFXBINARY_NONE || Reader.Failed())
+		return;
+
+	// Check the size against the content before allocating for it
+	const void *pBinary = Reader.ReadInPlace(ui32BinarySize);
+	if(!pBinary)
+		return;
+
+	Shader.pbGLSLBinary = (char*) malloc(PVRT_MAX(ui32BinarySize, 1u));
+	if(!Shader.pbGLSLBinary)
+		return;
+	memcpy(Shader.pbGLSLBinary, pBinary, ui32BinarySize);
+	Shader.nGLSLBinarySize = ui32BinarySize;
+}
+
+/*!***************************************************************************
+ @Function			WriteEffect
+ @Modified			Writer			Binary content
+ @Input				Effect			Effect to write
+ @Description		Writes an effect, with its uniforms, attributes, textures
+					and targets.
+*****************************************************************************/
+static void WriteEffect(CPFXBinaryWriter &Writer, const SPVRTPFXParserEffect &Effect)
+{
+	unsigned int i;
+
+	Writer.WriteString(Effect.Name.String());
+	Writer.WriteString(Effect.Annotation);
+	Writer.WriteString(Effect.VertexShaderName.String());
+	Writer.WriteString(Effect.FragmentShaderName.String());
+
+	Writer.WriteUInt32(Effect.Uniforms.GetSize());
+	for(i = 0; i < Effect.Uniforms.GetSize(); ++i)
+		WriteSemantic(Writer, Effect.Uniforms[i]);
+
+	Writer.WriteUInt32(Effect.Attributes.GetSize());
+	for(i = 0; i < Effect.Attributes.GetSize(); ++i)
+		WriteSemantic(Writer, Effect.Attributes[i]);
+
+	Writer.WriteUInt32(Effect.Textures.GetSize());
+	for(i = 0; i < Effect.Textures.GetSize(); ++i)
+	{
+		Writer.WriteString(Effect.Textures[i].Name.String());
+		Writer.WriteUInt32(Effect.Textures[i].nNumber);
+	}
+
+	Writer.WriteUInt32(Effect.Targets.GetSize());
+	for(i = 0; i < Effect.Targets.GetSize(); ++i)
+	{
+		Writer.WriteString(Effect.Targets[i].BufferType);
+		Writer.WriteString(Effect.Targets[i].TargetName);
+	}
+}
+
+/*!***************************************************************************
+ @Function			ReadEffect
+ @Modified			Reader			Binary content
+ @Output			Effect			Effect read
+ @Description		Reads an effect written by WriteEffect().
+*****************************************************************************/
+static void ReadEffect(CPFXBinaryReader &Reader, SPVRTPFXParserEffect &Effect)
+{
+	unsigned int i, uiCount;
+
+	Reader.ReadString(Effect.Name);
+	Reader.ReadString(Effect.Annotation);
+	Reader.ReadString(Effect.VertexShaderName);
+	Reader.ReadString(Effect.FragmentShaderName);
+
+	// Each semantic takes at least four 32-bit fields, and each texture or target two
+	uiCount = Reader.ReadCount(16);
+	for(i = 0; i < uiCount && !Reader.Failed(); ++i)
+		ReadSemantic(Reader, Effect.Uniforms[Effect.Uniforms.Append()]);
+
+	uiCount = Reader.ReadCount(16);
+	for(i = 0; i < uiCount && !Reader.Failed(); ++i)
+		ReadSemantic(Reader, Effect.Attributes[Effect.Attributes.Append()]);
+
+	uiCount = Reader.ReadCount(8);
+	for(i = 0; i < uiCount && !Reader.Failed(); ++i)
+	{
+		SPVRTPFXParserEffectTexture &Texture = Effect.Textures[Effect.Textures.Append()];
+		Reader.ReadString(Texture.Name);
+		Texture.nNumber = Reader.ReadUInt32();
+	}
+
+	uiCount = Reader.ReadCount(8);
+	for(i = 0; i < uiCount && !Reader.Failed(); ++i)
+	{
+		SPVRTTargetPair &Target = Effect.Targets[Effect.Targets.Append()];
+		Reader.ReadString(Target.BufferType);
+		Reader.ReadString(Target.TargetName);
+	}
+}
+
+/*!***************************************************************************
+ @Function			SaveBinary
+ @Input				pszFileName		Binary file to write
+ @Input				info			Source of the parsed script
+ @Return			EPVRTError		PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Saves the parsed header, textures, shaders, effects and
+					render passes to a binary PFX file.
+*****************************************************************************/
+EPVRTError CPVRTPFXParser::SaveBinary(const char * const pszFileName, const SPVRTPFXBinaryInfo &info) const
+{
+	CPFXBinaryWriter Writer;
+	unsigned int i, j;
+
+	Writer.WriteBytes(c_szPFXBinaryMagic, sizeof(c_szPFXBinaryMagic));
+	Writer.WriteUInt32(PFXBINARY_VERSION);
+	Writer.WriteUInt32(info.ui32SourceHash);
+	Writer.WriteUInt32(info.ui32SourceSize);
+
+	Writer.WriteString(m_szFileName);
+	Writer.WriteString(m_sHeader.Version);
+	Writer.WriteString(m_sHeader.Description);
+	Writer.WriteString(m_sHeader.Copyright);
+
+	Writer.WriteUInt32(m_psTexture.GetSize());
+	for(i = 0; i < m_psTexture.GetSize(); ++i)
+	{
+		const SPVRTPFXParserTexture &Texture = *m_psTexture[i];
+		Writer.WriteString(Texture.Name.String());
+		Writer.WriteString(Texture.FileName.String());
+		Writer.WriteUInt32(Texture.bRenderToTexture ? 1 : 0);
+		Writer.WriteUInt32(Texture.nMin);
+		Writer.WriteUInt32(Texture.nMag);
+		Writer.WriteUInt32(Texture.nMIP);
+		Writer.WriteUInt32(Texture.nWrapS);
+		Writer.WriteUInt32(Texture.nWrapT);
+		Writer.WriteUInt32(Texture.nWrapR);
+		Writer.WriteUInt32(Texture.uiWidth);
+		Writer.WriteUInt32(Texture.uiHeight);
+		Writer.WriteUInt32(Texture.uiFlags);
+	}
+
+	Writer.WriteUInt32(m_psVertexShader.GetSize());
+	for(i = 0; i < m_psVertexShader.GetSize(); ++i)
+		WriteShader(Writer, m_psVertexShader[i]);
+
+	Writer.WriteUInt32(m_psFragmentShader.GetSize());
+	for(i = 0; i < m_psFragmentShader.GetSize(); ++i)
+		WriteShader(Writer, m_psFragmentShader[i]);
+
+	Writer.WriteUInt32(m_psEffect.GetSize());
+	for(i = 0; i < m_psEffect.GetSize(); ++i)
+		WriteEffect(Writer, m_psEffect[i]);
+
+	// Render passes refer to their effect and texture by index
+	Writer.WriteUInt32(m_RenderPasses.GetSize());
+	for(i = 0; i < m_RenderPasses.GetSize(); ++i)
+	{
+		const SPVRTPFXRenderPass &Pass = m_RenderPasses[i];
+		PVRTuint32 ui32Effect = PFXBINARY_NONE, ui32Texture = PFXBINARY_NONE;
+
+		for(j = 0; j < m_psEffect.GetSize(); ++j)
+		{
+			if(Pass.pEffect == &m_psEffect[j])
+				ui32Effect = j;
+		}
+		for(j = 0; j < m_psTexture.GetSize(); ++j)
+		{
+			if(Pass.pTexture == m_psTexture[j])
+				ui32Texture = j;
+		}
+
+		Writer.WriteUInt32((PVRTuint32) Pass.eRenderPassType);
+		Writer.WriteUInt32((PVRTuint32) Pass.eViewType);
+		Writer.WriteUInt32(Pass.uiFormatFlags);
+		Writer.WriteUInt32(ui32Effect);
+		Writer.WriteUInt32(ui32Texture);
+		Writer.WriteString(Pass.NodeName);
+		Writer.WriteString(Pass.SemanticName);
+	}
+
+	Writer.WriteUInt32(m_aszPostProcessNames.GetSize());
+	for(i = 0; i < m_aszPostProcessNames.GetSize(); ++i)
+		Writer.WriteString(m_aszPostProcessNames[i]);
+
+	if(Writer.Failed() || !pszFileName)
+		return PVR_FAIL;
+
+	FILE *pFile = fopen(pszFileName, "wb");
+	if(!pFile)
+		return PVR_FAIL;
+
+	bool bWritten = fwrite(Writer.GetData(), 1, Writer.GetSize(), pFile) == Writer.GetSize();
+	bWritten = (fclose(pFile) == 0) && bWritten;
+	return bWritten ? PVR_SUCCESS : PVR_FAIL;
+}
+
+/*!***************************************************************************
+ @Function			LoadBinaryFromMemory
+ @Input				pData			Content of a binary PFX file
+ @Input				nSize			Size of the content in bytes
+ @Output			pReturnError	error string
+ @Return			EPVRTError		PVR_SUCCESS if successful, PVR_FAIL if the
+									content is not a valid binary PFX file
+ @Description		Restores the state saved by SaveBinary().
+*****************************************************************************/
+EPVRTError CPVRTPFXParser::LoadBinaryFromMemory(const void * const pData, const size_t nSize, CPVRTString * const pReturnError)
+{
+	CPFXBinaryReader Reader(pData, nSize);
+	char szMagic[sizeof(c_szPFXBinaryMagic)];
+	unsigned int i, uiCount;
+
+	if(!pData || !Reader.ReadBytes(szMagic, sizeof(szMagic)) || memcmp(szMagic, c_szPFXBinaryMagic, sizeof(szMagic)) ||
+	   Reader.ReadUInt32() != PFXBINARY_VERSION)
+	{
+		*pReturnError = "Not a binary PFX file, or written by a different version\n";
+		return PVR_FAIL;
+	}
+
+	Reader.ReadUInt32();		// Source hash
+	Reader.ReadUInt32();		// Source size
+
+	Reader.ReadString(m_szFileName);
+	Reader.ReadString(m_sHeader.Version);
+	Reader.ReadString(m_sHeader.Description);
+	Reader.ReadString(m_sHeader.Copyright);
+
+	uiCount = Reader.ReadCount(48);
+	for(i = 0; i < uiCount && !Reader.Failed(); ++i)
+	{
+		SPVRTPFXParserTexture *pTexture = new SPVRTPFXParserTexture();
+		m_psTexture.Append(pTexture);
+
+		Reader.ReadString(pTexture->Name);
+		Reader.ReadString(pTexture->FileName);
+		pTexture->bRenderToTexture	= Reader.ReadUInt32() != 0;
+		pTexture->nMin				= Reader.ReadUInt32();
+		pTexture->nMag				= Reader.ReadUInt32();
+		pTexture->nMIP				= Reader.ReadUInt32();
+		pTexture->nWrapS			= Reader.ReadUInt32();
+		pTexture->nWrapT			= Reader.ReadUInt32();
+		pTexture->nWrapR			= Reader.ReadUInt32();
+		pTexture->uiWidth			= Reader.ReadUInt32();
+		pTexture->uiHeight			= Reader.ReadUInt32();
+		pTexture->uiFlags			= Reader.ReadUInt32();
+	}
+
+	uiCount = Reader.ReadCount(32);
+	for(i = 0; i < uiCount && !Reader.Failed(); ++i)
+		ReadShader(Reader, m_psVertexShader[m_psVertexShader.Append()]);
+
+	uiCount = Reader.ReadCount(32);
+	for(i = 0; i < uiCount && !Reader.Failed(); ++i)
+		ReadShader(Reader, m_psFragmentShader[m_psFragmentShader.Append()]);
+
+	uiCount = Reader.ReadCount(32);
+	m_psEffect.SetCapacity(uiCount);
+	for(i = 0; i < uiCount && !Reader.Failed(); ++i)
+		ReadEffect(Reader, m_psEffect[m_psEffect.Append()]);
+
+	// The effects are all read, so pointers to them remain valid
+	uiCount = Reader.ReadCount(28);
+	for(i = 0; i < uiCount && !Reader.Failed(); ++i)
+	{
+		SPVRTPFXRenderPass &Pass = m_RenderPasses[m_RenderPasses.Append()];
+
+		PVRTuint32 ui32PassType	= Reader.ReadUInt32();
+		PVRTuint32 ui32ViewType	= Reader.ReadUInt32();
+		Pass.uiFormatFlags		= Reader.ReadUInt32();
+		PVRTuint32 ui32Effect	= Reader.ReadUInt32();
+		PVRTuint32 ui32Texture	= Reader.ReadUInt32();
+		Reader.ReadString(Pass.NodeName);
+		Reader.ReadString(Pass.SemanticName);
+
+		// Check the enumeration values before casting them
+		if(ui32PassType > eENVMAPSPH_PASS || ui32ViewType > eVIEW_NONE ||
+		   (ui32Effect != PFXBINARY_NONE && ui32Effect >= m_psEffect.GetSize()) ||
+		   ui32Texture >= m_psTexture.GetSize())
+		{
+			*pReturnError = "Invalid render pass in binary PFX file\n";
+			return PVR_FAIL;
+		}
+		Pass.eRenderPassType	= (EPVRTPFXPassType) ui32PassType;
+		Pass.eViewType			= (EPVRTPFXPassView) ui32ViewType;
+		Pass.pEffect	= ui32Effect != PFXBINARY_NONE ? &m_psEffect[ui32Effect] : NULL;
+		Pass.pTexture	= m_psTexture[ui32Texture];
+	}
+
+	uiCount = Reader.ReadCount(4);
+	for(i = 0; i < uiCount && !Reader.Failed(); ++i)
+		Reader.ReadString(m_aszPostProcessNames[m_aszPostProcessNames.Append()]);
+
+	if(Reader.Failed())
+	{
+		*pReturnError = "Binary PFX file is truncated or corrupt\n";
+		return PVR_FAIL;
+	}
+
+	BuildRenderPassSkipGraph();
+	return PVR_SUCCESS;
+}
+
+/*!***************************************************************************
+ @Function			LoadBinaryFromFile
+ @Input				pszFileName		Binary PFX file name
+ @Output			pReturnError	error string
+ @Return			EPVRTError		PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Reads a binary PFX file and calls LoadBinaryFromMemory().
+*****************************************************************************/
+EPVRTError CPVRTPFXParser::LoadBinaryFromFile(const char * const pszFileName, CPVRTString * const pReturnError)
+{
+	CPVRTResourceFile BinaryFile(pszFileName);
+	if(!BinaryFile.IsOpen())
+	{
+		*pReturnError = CPVRTString("Unable to open file ") + pszFileName;
+		return PVR_FAIL;
+	}
+
+	return LoadBinaryFromMemory(BinaryFile.DataPtr(), BinaryFile.Size(), pReturnError);
+}
+
+/*!***************************************************************************
+ @Function			PVRTPFXHashFile
+ @Input				pszFileName		File to hash, relative to the read path
+ @Output			info			Hash and size of the file content
+ @Return			EPVRTError		PVR_SUCCESS if successful, PVR_FAIL if not
+ @Description		Hashes the content of a PFX file, to identify the source
+					of a binary PFX file.
+*****************************************************************************/
+EPVRTError PVRTPFXHashFile(const char * const pszFileName, SPVRTPFXBinaryInfo &info)
+{
+	CPVRTResourceFile PfxFile(pszFileName);
+	if(!PfxFile.IsOpen())
+		return PVR_FAIL;
+
+	info.ui32SourceHash = CPVRTHash::MakeHash(PfxFile.DataPtr(), 1, (unsigned int) PfxFile.Size());
+	info.ui32SourceSize = (PVRTuint32) PfxFile.Size();
+	return PVR_SUCCESS;
+}
+
+/*!***************************************************************************
+ @Function			PVRTPFXReadBinaryInfo
+ @Input				pszFileName		Binary PFX file, relative to the read path
+ @Output			info			Source of the binary file
+ @Return			EPVRTError		PVR_SUCCESS if the file is a binary PFX
+									file, PVR_FAIL if not
+ @Description		Reads the source information of a file saved with
+					CPVRTPFXParser::SaveBinary(), without loading it.
+*****************************************************************************/
+EPVRTError PVRTPFXReadBinaryInfo(const char * const pszFileName, SPVRTPFXBinaryInfo &info)
+{
+	CPVRTResourceFile BinaryFile(pszFileName);
+	if(!BinaryFile.IsOpen())
+		return PVR_FAIL;
+
+	CPFXBinaryReader Reader(BinaryFile.DataPtr(), BinaryFile.Size());
+	char szMagic[sizeof(c_szPFXBinaryMagic)];
+
+	if(!Reader.ReadBytes(szMagic, sizeof(szMagic)) || memcmp(szMagic, c_szPFXBinaryMagic, sizeof(szMagic)) ||
+	   Reader.ReadUInt32() != PFXBINARY_VERSION)
+		return PVR_FAIL;
+
+	info.ui32SourceHash = Reader.ReadUInt32();
+	info.ui32SourceSize = Reader.ReadUInt32();
+	return Reader.Failed() ? PVR_FAIL : PVR_SUCCESS;
+}
+
 /*!***************************************************************************
 @Function		PVRTPFXCreateStringCopy
 @Return			void
@@ -256,6 +256,16 @@ struct SPVRTPFXParserEffect
 	SPVRTPFXParserEffect();
 };
 
+/*!**************************************************************************
+@struct SPVRTPFXBinaryInfo
+@brief  Identifies the PFX file a binary PFX file was produced from
+****************************************************************************/
+struct SPVRTPFXBinaryInfo
+{
+	PVRTuint32			ui32SourceHash;		/*!< Hash of the content of the source PFX file */
+	PVRTuint32			ui32SourceSize;		/*!< Size of the source PFX file in bytes */
+};
+
 /****************************************************************************
 ** Constants
 ****************************************************************************/
@@ -465,6 +475,40 @@ public:
 	*****************************************************************************/
 	const CPVRTArray<CPVRTString>& GetPostProcessNames() const;
 
+	/*!***************************************************************************
+	@fn      			SaveBinary
+	@param[in]			pszFileName		Binary file to write
+	@param[in]			info			Source of the parsed script
+	@return				PVR_SUCCESS if successful, PVR_FAIL if not
+	@brief     		    Saves the parsed header, textures, shaders, effects and
+						render passes to a binary PFX file, which LoadBinaryFromFile()
+						restores without parsing the script again. Shader code and
+						binaries are stored in the file, but shaders that reference
+						a FILE are stored by file name only.
+	*****************************************************************************/
+	EPVRTError SaveBinary(const char * const pszFileName, const SPVRTPFXBinaryInfo &info) const;
+
+	/*!***************************************************************************
+	@fn      			LoadBinaryFromMemory
+	@param[in]			pData			Content of a binary PFX file
+	@param[in]			nSize			Size of the content in bytes
+	@param[out]			pReturnError	error string
+	@return				PVR_SUCCESS if successful, PVR_FAIL if the content is not
+						a valid binary PFX file
+	@brief     		    Restores the state saved by SaveBinary(). The parser must
+						not already contain a parsed script.
+	*****************************************************************************/
+	EPVRTError LoadBinaryFromMemory(const void * const pData, const size_t nSize, CPVRTString * const pReturnError);
+
+	/*!***************************************************************************
+	@fn      			LoadBinaryFromFile
+	@param[in]			pszFileName		Binary PFX file name
+	@param[out]			pReturnError	error string
+	@return				PVR_SUCCESS if successful, PVR_FAIL if not
+	@brief     		    Reads a binary PFX file and calls LoadBinaryFromMemory().
+	*****************************************************************************/
+	EPVRTError LoadBinaryFromFile(const char * const pszFileName, CPVRTString * const pReturnError);
+
 public:
 	static const unsigned int							VIEWPORT_SIZE;
 		
@@ -654,6 +698,12 @@ private:
 	*****************************************************************************/
 	bool DetermineRenderPassDependencies(CPVRTString * const pReturnError);
 
+	/*!***************************************************************************
+	 @brief     	Adds every render pass to the skip graph, with a dependency
+					on each pass that renders a texture its effect reads.
+	*****************************************************************************/
+	void BuildRenderPassSkipGraph();
+
 	/*!***************************************************************************
 	 @brief     	Recursively look through dependencies until leaf nodes are
 					encountered. At this point, add a given leaf node to the
@@ -666,6 +716,31 @@ private:
 										CPVRTSkipGraphNode<SPVRTPFXRenderPass*> &renderPassNode);
 };
 
+/****************************************************************************
+** Binary PFX files
+****************************************************************************/
+/*!***************************************************************************
+ @fn       			PVRTPFXHashFile
+ @param[in]			pszFileName		File to hash, relative to the read path
+ @param[out]		info			Hash and size of the file content
+ @return			PVR_SUCCESS if successful, PVR_FAIL if not
+ @brief     		Hashes the content of a PFX file, to identify the source
+					of a binary PFX file.
+*****************************************************************************/
+EPVRTError PVRTPFXHashFile(const char * const pszFileName, SPVRTPFXBinaryInfo &info);
+
+/*!***************************************************************************
+ @fn       			PVRTPFXReadBinaryInfo
+ @param[in]			pszFileName		Binary PFX file, relative to the read path
+ @param[out]		info			Source of the binary file
+ @return			PVR_SUCCESS if the file is a binary PFX file, PVR_FAIL if not
+ @brief     		Reads the source information of a file saved with
+					CPVRTPFXParser::SaveBinary(), without loading it. Compare
+					it with PVRTPFXHashFile() of the source PFX file to decide
+					whether the binary file is up to date.
+*****************************************************************************/
+EPVRTError PVRTPFXReadBinaryInfo(const char * const pszFileName, SPVRTPFXBinaryInfo &info);
+
 
 #endif /* _PVRTPFXPARSER_H_ */
 
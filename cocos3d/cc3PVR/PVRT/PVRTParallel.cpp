@@ -0,0 +1,154 @@
+/******************************************************************************
+
+ @File         PVRTParallel.cpp
+
+ @Title        PVRTParallel
+
+ @Version      
+
+ @Copyright    Copyright (c) 2010-2014 The Brenwill Workshop Ltd.
+
+ @Platform     ANSI compatible; threaded on POSIX platforms
+
+ @Description  Minimal fork-join parallel loop used by the PVRT tools.
+
+******************************************************************************/
+#include "PVRTParallel.h"
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/****************************************************************************
+** Structures
+****************************************************************************/
+struct SPVRTParallelJob
+{
+	PFNPVRTParallelTask		pfnTask;	/*!< Task to invoke */
+	void					*pUserData;	/*!< User data passed to the task */
+	unsigned int			ui32Count;	/*!< Number of indices */
+	volatile unsigned int	ui32Next;	/*!< Next index to hand out */
+};
+
+/****************************************************************************
+** Local code
+****************************************************************************/
+
+/*!***************************************************************************
+ @Function			RunJob
+ @Modified			job				The job to take indices from
+ @Description		Processes indices of the job until none remain.
+*****************************************************************************/
+static void RunJob(SPVRTParallelJob &job)
+{
+#if defined(_WIN32)
+	while(job.ui32Next < job.ui32Count)
+		job.pfnTask(job.pUserData, job.ui32Next++);
+#else
+	unsigned int ui32Index;
+	while((ui32Index = __sync_fetch_and_add(&job.ui32Next, 1)) < job.ui32Count)
+		job.pfnTask(job.pUserData, ui32Index);
+#endif
+}
+
+#if !defined(_WIN32)
+static void* WorkerMain(void *pJob)
+{
+	RunJob(*(SPVRTParallelJob*) pJob);
+	return 0;
+}
+
+static unsigned int			s_ui32ThreadCount = 1;
+static pthread_once_t		s_ThreadCountOnce = PTHREAD_ONCE_INIT;
+
+/*!***************************************************************************
+ @Function			InitThreadCount
+ @Description		Reads the number of online processors. Invoked once,
+					through pthread_once(), by PVRTParallelThreadCount().
+*****************************************************************************/
+static void InitThreadCount()
+{
+	long i32Online = sysconf(_SC_NPROCESSORS_ONLN);
+	s_ui32ThreadCount = i32Online > 0 ? (unsigned int) i32Online : 1;
+}
+#endif
+
+/****************************************************************************
+** Functions
+****************************************************************************/
+
+/*!***************************************************************************
+ @Function			PVRTParallelThreadCount
+ @Return			Number of worker threads
+ @Description		Returns the number of worker threads PVRTParallelFor will
+					use by default, which is the number of online processors.
+					Safe to call from several threads at once.
+*****************************************************************************/
+unsigned int PVRTParallelThreadCount()
+{
+#if defined(_WIN32)
+	return 1;
+#else
+	// Several loader threads may ask at once
+	pthread_once(&s_ThreadCountOnce, &InitThreadCount);
+	return s_ui32ThreadCount;
+#endif
+}
+
+/*!***************************************************************************
+ @Function			PVRTParallelFor
+ @Input				ui32Count		Number of indices to process
+ @Input				pfnTask			Task to invoke for each index
+ @Input				pUserData		User data passed to each task invocation
+ @Input				ui32MaxThreads	Upper limit on the number of threads
+ @Description		Invokes pfnTask once for every index in [0, ui32Count),
+					spreading the indices across worker threads. Threads that
+					cannot be created simply leave more work for the others.
+*****************************************************************************/
+void PVRTParallelFor(
+	const unsigned int	ui32Count,
+	PFNPVRTParallelTask	pfnTask,
+	void				*pUserData,
+	const unsigned int	ui32MaxThreads)
+{
+	SPVRTParallelJob job;
+	job.pfnTask		= pfnTask;
+	job.pUserData	= pUserData;
+	job.ui32Count	= ui32Count;
+	job.ui32Next	= 0;
+
+	unsigned int ui32Threads = PVRTParallelThreadCount();
+	if(ui32MaxThreads && ui32MaxThreads < ui32Threads)
+		ui32Threads = ui32MaxThreads;
+	if(ui32Threads > ui32Count)
+		ui32Threads = ui32Count;
+
+#if !defined(_WIN32)
+	if(ui32Threads > 1)
+	{
+		pthread_t *pThreads = new pthread_t[ui32Threads - 1];
+		unsigned int ui32Started = 0;
+
+		for(unsigned int i = 0; i < ui32Threads - 1; ++i)
+		{
+			if(pthread_create(&pThreads[ui32Started], 0, &WorkerMain, &job) == 0)
+				++ui32Started;
+		}
+
+		RunJob(job);
+
+		for(unsigned int i = 0; i < ui32Started; ++i)
+			pthread_join(pThreads[i], 0);
+
+		delete [] pThreads;
+		return;
+	}
+#endif
+
+	RunJob(job);
+}
+
+/*****************************************************************************
+ End of file (PVRTParallel.cpp)
+*****************************************************************************/
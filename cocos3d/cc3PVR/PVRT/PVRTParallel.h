@@ -0,0 +1,60 @@
+/*!****************************************************************************
+
+ @file         PVRTParallel.h
+ @copyright    Copyright (c) 2010-2014 The Brenwill Workshop Ltd.
+ @brief        Minimal fork-join parallel loop used by the PVRT tools.
+
+******************************************************************************/
+#ifndef _PVRTPARALLEL_H_
+#define _PVRTPARALLEL_H_
+
+/****************************************************************************
+** Typedefs
+****************************************************************************/
+/*!***************************************************************************
+ @brief     		Task invoked once per index by PVRTParallelFor.
+ @param[in]			pUserData		The user data passed to PVRTParallelFor
+ @param[in]			ui32Index		Index of the item to process
+*****************************************************************************/
+typedef void (*PFNPVRTParallelTask)(void *pUserData, const unsigned int ui32Index);
+
+/****************************************************************************
+** Functions
+****************************************************************************/
+
+/*!***************************************************************************
+ @fn       			PVRTParallelThreadCount
+ @return			Number of worker threads
+ @brief     		Returns the number of worker threads PVRTParallelFor will
+					use by default, which is the number of online processors.
+					Always 1 on platforms without thread support. Safe to call
+					from several threads at once.
+*****************************************************************************/
+unsigned int PVRTParallelThreadCount();
+
+/*!***************************************************************************
+ @fn       			PVRTParallelFor
+ @param[in]			ui32Count		Number of indices to process
+ @param[in]			pfnTask			Task to invoke for each index
+ @param[in]			pUserData		User data passed to each task invocation
+ @param[in]			ui32MaxThreads	Upper limit on the number of threads,
+									including the calling thread. Zero uses
+									PVRTParallelThreadCount(); one runs all
+									tasks serially on the calling thread.
+ @brief     		Invokes pfnTask once for every index in [0, ui32Count),
+					spreading the indices across worker threads, and returns
+					once all of them have completed. The calling thread takes
+					part in the work. Tasks must not depend on the order in
+					which indices are processed.
+*****************************************************************************/
+void PVRTParallelFor(
+	const unsigned int	ui32Count,
+	PFNPVRTParallelTask	pfnTask,
+	void				*pUserData,
+	const unsigned int	ui32MaxThreads = 0);
+
+#endif /* _PVRTPARALLEL_H_ */
+
+/*****************************************************************************
+ End of file (PVRTParallel.h)
+*****************************************************************************/
@@ -32,6 +32,51 @@ const size_t CPVRTString::npos = (size_t) -1;
 #define snprintf _snprintf
 #endif
 
+/****************************************************************************
+** Heap buffers
+****************************************************************************/
+#if defined(PVRTSTRING_ALLOC_STATS)
+static volatile unsigned long s_nAllocations = 0;
+static volatile unsigned long s_nFrees = 0;
+static volatile unsigned long s_nBytesAllocated = 0;
+
+// Strings are created on the loader threads, so count atomically where the threads run in parallel
+#if defined(_WIN32)
+#define PVRTSTRING_COUNT(var, n)	((var) += (n))
+#else
+#define PVRTSTRING_COUNT(var, n)	__sync_fetch_and_add(&(var), (unsigned long) (n))
+#endif
+#endif
+
+/*!***********************************************************************
+@Function			AllocBuffer
+@Input				_Capacity	Size of the buffer
+@Returns			A new heap buffer
+@Description		Allocates the heap buffer of a string that does not fit
+					in its local buffer.
+*************************************************************************/
+static char* AllocBuffer(size_t _Capacity)
+{
+#if defined(PVRTSTRING_ALLOC_STATS)
+	PVRTSTRING_COUNT(s_nAllocations, 1);
+	PVRTSTRING_COUNT(s_nBytesAllocated, _Capacity);
+#endif
+	return (char*)malloc(_Capacity);
+}
+
+/*!***********************************************************************
+@Function			FreeBuffer
+@Input				pBuffer		A buffer returned by AllocBuffer()
+@Description		Frees the heap buffer of a string.
+*************************************************************************/
+static void FreeBuffer(char* pBuffer)
+{
+#if defined(PVRTSTRING_ALLOC_STATS)
+	PVRTSTRING_COUNT(s_nFrees, 1);
+#endif
+	free(pBuffer);
+}
+
 /*!***********************************************************************
 @Function			CPVRTString
 @Input				_Ptr	A string
@@ -39,8 +84,9 @@ const size_t CPVRTString::npos = (size_t) -1;
 @Description		Constructor
 ************************************************************************/
 CPVRTString::CPVRTString(const char* _Ptr, size_t _Count) :
-m_pString(0), m_Capacity(0)
+m_pString(m_szLocal), m_Size(0), m_Capacity(PVRTSTRING_LOCAL_CAPACITY)
 {
+	m_szLocal[0] = '\0';
 	if (_Count == npos)
 	{
 		if (_Ptr == NULL)
@@ -64,8 +110,9 @@ m_pString(0), m_Capacity(0)
 @Description		Constructor
 ************************************************************************/
 CPVRTString::CPVRTString(const CPVRTString& _Right, size_t _Roff, size_t _Count) :
-m_pString(0), m_Capacity(0)
+m_pString(m_szLocal), m_Size(0), m_Capacity(PVRTSTRING_LOCAL_CAPACITY)
 {
+	m_szLocal[0] = '\0';
 	assign(_Right, _Roff, _Count);
 }
 
@@ -76,8 +123,9 @@ m_pString(0), m_Capacity(0)
 @Description		Constructor
 *************************************************************************/
 CPVRTString::CPVRTString(size_t _Count, char _Ch) :
-m_pString(0), m_Capacity(0)
+m_pString(m_szLocal), m_Size(0), m_Capacity(PVRTSTRING_LOCAL_CAPACITY)
 {
+	m_szLocal[0] = '\0';
 	assign(_Count,_Ch);
 }
 
@@ -87,8 +135,9 @@ m_pString(0), m_Capacity(0)
 @Description		Constructor
 *************************************************************************/
 CPVRTString::CPVRTString(const char _Ch) :
-m_pString(0), m_Capacity(0)
-{  	
+m_pString(m_szLocal), m_Size(0), m_Capacity(PVRTSTRING_LOCAL_CAPACITY)
+{
+	m_szLocal[0] = '\0';
 	assign( 1, _Ch);
 }
 
@@ -97,22 +146,96 @@ m_pString(0), m_Capacity(0)
 @Description		Constructor
 *************************************************************************/
 CPVRTString::CPVRTString() :
-m_Size(0), m_Capacity(1)
+m_pString(m_szLocal), m_Size(0), m_Capacity(PVRTSTRING_LOCAL_CAPACITY)
 {
-	m_pString = (char*)calloc(1, 1);
+	m_szLocal[0] = '\0';
 }
 
+#if defined(PVRTSTRING_MOVE)
+/*!***********************************************************************
+@Function			CPVRTString
+@Input				_Right	A string
+@Description		Move constructor
+*************************************************************************/
+CPVRTString::CPVRTString(CPVRTString&& _Right) :
+m_pString(m_szLocal), m_Size(0), m_Capacity(PVRTSTRING_LOCAL_CAPACITY)
+{
+	m_szLocal[0] = '\0';
+	take(_Right);
+}
+
+/*!***********************************************************************
+@Function			=
+@Input				_Right A string
+@Returns			An updated string
+@Description		Move assignment
+*************************************************************************/
+CPVRTString& CPVRTString::operator=(CPVRTString&& _Right)
+{
+	take(_Right);
+	return *this;
+}
+#endif
+
 /*!***********************************************************************
 @Function			~CPVRTString
 @Description		Destructor
 *************************************************************************/
 CPVRTString::~CPVRTString()
 {
-	if (m_pString)
+	if (m_pString != m_szLocal)
+		FreeBuffer(m_pString);
+}
+
+/*!***********************************************************************
+@Function			grow
+@Input				_Capacity	Required capacity, including the null terminator
+@Description		Replaces the buffer with one of at least _Capacity chars,
+					keeping the current content.
+*************************************************************************/
+void CPVRTString::grow(size_t _Capacity)
+{
+	if (_Capacity <= m_Capacity)
+		return;
+
+	char* pString = AllocBuffer(_Capacity);
+	memcpy(pString, m_pString, m_Size + 1);
+	if (m_pString != m_szLocal)
+		FreeBuffer(m_pString);
+
+	m_pString = pString;
+	m_Capacity = _Capacity;
+}
+
+/*!***********************************************************************
+@Function			take
+@Input				_Right	A string
+@Description		Takes the content of _Right, leaving _Right empty. A heap
+					buffer is taken over rather than copied.
+*************************************************************************/
+void CPVRTString::take(CPVRTString& _Right)
+{
+	if (&_Right == this)
+		return;
+
+	if (_Right.m_pString == _Right.m_szLocal)
+	{
+		assign(_Right.m_pString, _Right.m_Size);
+	}
+	else
 	{
-		free(m_pString);
-		m_pString=NULL;
+		if (m_pString != m_szLocal)
+			FreeBuffer(m_pString);
+
+		m_pString = _Right.m_pString;
+		m_Size = _Right.m_Size;
+		m_Capacity = _Right.m_Capacity;
 	}
+
+	_Right.m_pString = _Right.m_szLocal;
+	_Right.m_Size = 0;
+	_Right.m_Capacity = PVRTSTRING_LOCAL_CAPACITY;
+	_Right.m_szLocal[0] = '\0';
 }
 
 /*!***********************************************************************
@@ -139,33 +262,26 @@ CPVRTString& CPVRTString::append(const char* _Ptr)
 *************************************************************************/
 CPVRTString& CPVRTString::append(const char* _Ptr, size_t _Count)
 {
-	char* pString = m_pString;
 	size_t newCapacity = _Count + m_Size + 1;	// +1 for null termination
 
-	// extend CPVRTString if necessary
+	// extend CPVRTString if necessary, doubling it so that repeated appends take linear time.
+	// A string that was given enough room with reserve() is never reallocated.
 	if (m_Capacity < newCapacity)
 	{
-		pString = (char*)malloc(newCapacity);
-		m_Capacity = newCapacity;				 // Using low memory profile (but very slow append)
-		memmove(pString, m_pString, m_Size);
-		pString[m_Capacity-1]='\0';
+		// _Ptr may point into this string
+		bool bSelf = (_Ptr >= m_pString && _Ptr < m_pString + m_Capacity);
+		size_t nOffset = bSelf ? (size_t)(_Ptr - m_pString) : 0;
+
+		grow(PVRT_MAX(newCapacity, m_Capacity * 2));
+		if (bSelf)
+			_Ptr = m_pString + nOffset;
 	}
 
 	// append chars from _Ptr
-	memmove(pString + m_Size, _Ptr, _Count);
+	memmove(m_pString + m_Size, _Ptr, _Count);
 	m_Size += _Count;
-	pString[m_Size] = 0;
+	m_pString[m_Size] = 0;
 
-	// remove old CPVRTString if necessary
-	if (pString != m_pString)
-	{
-		if (m_pString)
-		{
-			free(m_pString);
-			m_pString=NULL;
-		}
-		m_pString = pString;
-	}
 	return *this;
 }
 
@@ -214,17 +330,12 @@ CPVRTString& CPVRTString::append(const CPVRTString& _Str, size_t _Off, size_t _C
 *************************************************************************/
 CPVRTString& CPVRTString::append(size_t _Count, char _Ch)
 {
-	char* pString = m_pString;
 	size_t newCapacity = _Count + m_Size + 1;	// +1 for null termination
 	// extend CPVRTString if necessary
 	if (m_Capacity < newCapacity)
-	{
-		pString = (char*)malloc(newCapacity);
-		m_Capacity = newCapacity;
-		memmove(pString, m_pString, m_Size+1);
-	}
+		grow(PVRT_MAX(newCapacity, m_Capacity * 2));
 
-	char* newChar = &pString[m_Size];
+	char* newChar = &m_pString[m_Size];
 	// fill new space with _Ch
 	for(size_t i=0;i<_Count;++i)
 	{
@@ -233,16 +344,6 @@ CPVRTString& CPVRTString::append(size_t _Count, char _Ch)
 	*newChar = '\0';		// set null terminator
 	m_Size+=_Count;			// adjust length of string for new characters
 
-	// remove old CPVRTString if necessary
-	if (pString != m_pString)
-	{
-		if (m_pString)
-		{
-			free(m_pString);
-			m_pString=NULL;
-		}
-		m_pString = pString;
-	}
 	return *this;
 }
 
@@ -272,10 +373,14 @@ CPVRTString& CPVRTString::assign(const char* _Ptr, size_t _Count)
 {	
 	if(m_Capacity <= _Count)
 	{
-		free(m_pString);
+		// _Ptr may point into this string, so copy it before freeing the old buffer
+		char* pString = AllocBuffer(_Count+1);
+		memcpy(pString, _Ptr, _Count);
+		if (m_pString != m_szLocal)
+			FreeBuffer(m_pString);
+
+		m_pString = pString;
 		m_Capacity = _Count+1;
-		m_pString = (char*)malloc(m_Capacity);
-		memcpy(m_pString, _Ptr, _Count);
 	}
 	else
 		memmove(m_pString, _Ptr, _Count);
@@ -325,12 +430,10 @@ CPVRTString& CPVRTString::assign(size_t _Count,char _Ch)
 {
 	if (m_Capacity <= _Count)
 	{
-		if (m_pString)
-		{
-			free(m_pString);
-			m_pString=NULL;
-		}
-		m_pString = (char*)malloc(_Count + 1);
+		if (m_pString != m_szLocal)
+			FreeBuffer(m_pString);
+
+		m_pString = AllocBuffer(_Count + 1);
 		m_Capacity = _Count+1;
 	}
 	m_Size = _Count;
@@ -365,18 +468,12 @@ size_t CPVRTString::capacity() const
 
 /*!***********************************************************************
 @Function			clear
-@Description		Clears the string
+@Description		Clears the string, keeping its buffer for reuse
 *************************************************************************/
 void CPVRTString::clear()
 {
-	if (m_pString)
-	{
-		free(m_pString);
-		m_pString=NULL;
-	}
-	m_pString = (char*)calloc(1, 1);
 	m_Size = 0;
-	m_Capacity = 1;
+	m_pString[0] = 0;
 }
 
 /*!***********************************************************************
@@ -1517,10 +1614,7 @@ void CPVRTString::push_back(char _Ch)
 void CPVRTString::reserve(size_t _Count)
 {
 	if (_Count >= m_Capacity)
-	{
-		m_pString = (char*)realloc(m_pString, _Count + 1);
-		m_Capacity = _Count + 1;
-	}
+		grow(_Count + 1);
 }
 
 /*!***********************************************************************
@@ -1576,15 +1670,14 @@ CPVRTString CPVRTString::substr(size_t _Off, size_t _Count) const
 *************************************************************************/
 void CPVRTString::swap(CPVRTString& _Str)
 {
-	size_t Size = _Str.m_Size;
-	size_t Capacity = _Str.m_Capacity;
-	char* pString = _Str.m_pString;
-	_Str.m_Size = m_Size;
-	_Str.m_Capacity = m_Capacity;
-	_Str.m_pString = m_pString;
-	m_Size = Size;
-	m_Capacity = Capacity;
-	m_pString = pString;
+	if (&_Str == this)
+		return;
+
+	// Heap buffers change hands; local buffers are copied, since they cannot move
+	CPVRTString Temp;
+	Temp.take(_Str);
+	_Str.take(*this);
+	take(Temp);
 }
 
 /*!***********************************************************************
@@ -1729,6 +1822,38 @@ CPVRTString::reference CPVRTString::operator[](size_t _Off)
 	return m_pString[_Off];
 }
 
+/*!***********************************************************************
+@Function			GetAllocStats
+@Output				stats	Heap traffic
+@Description		Returns the heap traffic of all CPVRTStrings since the
+					last ResetAllocStats().
+*************************************************************************/
+void CPVRTString::GetAllocStats(SPVRTStringAllocStats& stats)
+{
+#if defined(PVRTSTRING_ALLOC_STATS)
+	stats.nAllocations = s_nAllocations;
+	stats.nFrees = s_nFrees;
+	stats.nBytesAllocated = s_nBytesAllocated;
+#else
+	stats.nAllocations = 0;
+	stats.nFrees = 0;
+	stats.nBytesAllocated = 0;
+#endif
+}
+
+/*!***********************************************************************
+@Function			ResetAllocStats
+@Description		Resets the counts returned by GetAllocStats().
+*************************************************************************/
+void CPVRTString::ResetAllocStats()
+{
+#if defined(PVRTSTRING_ALLOC_STATS)
+	s_nAllocations = 0;
+	s_nFrees = 0;
+	s_nBytesAllocated = 0;
+#endif
+}
+
 /*!***********************************************************************
 @Function			+
 @Input				_Left A string
@@ -1738,7 +1863,10 @@ CPVRTString::reference CPVRTString::operator[](size_t _Off)
 *************************************************************************/
 CPVRTString operator+ (const CPVRTString& _Left, const CPVRTString& _Right)
 {
-	return CPVRTString(_Left).append(_Right);
+	CPVRTString Result;
+	Result.reserve(_Left.length() + _Right.length());
+	Result.append(_Left).append(_Right);
+	return Result;
 }
 
 /*!***********************************************************************
@@ -1750,7 +1878,11 @@ CPVRTString operator+ (const CPVRTString& _Left, const CPVRTString& _Right)
 *************************************************************************/
 CPVRTString operator+ (const CPVRTString& _Left, const char* _Right)
 {
-	return CPVRTString(_Left).append(_Right);
+	size_t nRight = _Right ? strlen(_Right) : 0;
+	CPVRTString Result;
+	Result.reserve(_Left.length() + nRight);
+	Result.append(_Left).append(_Right, nRight);
+	return Result;
 }
 
 /*!***********************************************************************
@@ -1762,7 +1894,10 @@ CPVRTString operator+ (const CPVRTString& _Left, const char* _Right)
 *************************************************************************/
 CPVRTString operator+ (const CPVRTString& _Left, const char _Right)
 {
-	return CPVRTString(_Left).append(_Right);
+	CPVRTString Result;
+	Result.reserve(_Left.length() + 1);
+	Result.append(_Left).append(1, _Right);
+	return Result;
 }
 
 /*!***********************************************************************
@@ -1774,7 +1909,11 @@ CPVRTString operator+ (const CPVRTString& _Left, const char _Right)
 *************************************************************************/
 CPVRTString operator+ (const char* _Left, const CPVRTString& _Right)
 {
-	return CPVRTString(_Left).append(_Right);
+	size_t nLeft = _Left ? strlen(_Left) : 0;
+	CPVRTString Result;
+	Result.reserve(nLeft + _Right.length());
+	Result.append(_Left, nLeft).append(_Right);
+	return Result;
 }
 
 /*!***********************************************************************
@@ -1786,7 +1925,10 @@ CPVRTString operator+ (const char* _Left, const CPVRTString& _Right)
 *************************************************************************/
 CPVRTString operator+ (const char _Left, const CPVRTString& _Right)
 {
-	return CPVRTString(_Left).append(_Right);
+	CPVRTString Result;
+	Result.reserve(1 + _Right.length());
+	Result.append(1, _Left).append(_Right);
+	return Result;
 }
 
 /*************************************************************************
@@ -13,6 +13,29 @@
 #include <stdio.h>
 #define _USING_PVRTSTRING_
 
+/*!***************************************************************************
+ Strings shorter than this, including the null terminator, are stored within
+ the CPVRTString itself instead of on the heap.
+*****************************************************************************/
+#define PVRTSTRING_LOCAL_CAPACITY	24
+
+// Move construction and assignment need a C++11 compiler
+#if !defined(PVRTSTRING_MOVE) && (__cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600))
+#define PVRTSTRING_MOVE
+#endif
+
+/*!***************************************************************************
+ @struct SPVRTStringAllocStats
+ @brief  Heap traffic of all CPVRTStrings, counted when PVRTSTRING_ALLOC_STATS
+		 is defined. Use it to measure the heap traffic of loading a resource.
+*****************************************************************************/
+struct SPVRTStringAllocStats
+{
+	unsigned long	nAllocations;		/*!< Number of buffers allocated */
+	unsigned long	nFrees;				/*!< Number of buffers freed */
+	unsigned long	nBytesAllocated;	/*!< Total size of the buffers allocated */
+};
+
 /*!***************************************************************************
  @class CPVRTString
  @brief A string class
@@ -82,6 +105,23 @@ public:
 	************************************************************************/
 	CPVRTString();
 
+#if defined(PVRTSTRING_MOVE)
+	/*!***********************************************************************
+	@brief      		Move constructor. Takes the heap buffer of _Right, if
+						it has one, and leaves _Right empty.
+	@param[in]				_Right	A string
+	************************************************************************/
+	CPVRTString(CPVRTString&& _Right);
+
+	/*!***********************************************************************
+	@brief      		Move assignment. Takes the heap buffer of _Right, if
+						it has one, and leaves _Right empty.
+	@param[in]			_Right A string
+	@return 			An updated string
+	*************************************************************************/
+	CPVRTString& operator=(CPVRTString&& _Right);
+#endif
+
 	/*!***********************************************************************
 	@brief      		Destructor
 	************************************************************************/
@@ -837,10 +877,37 @@ public:
 	*************************************************************************/
 	friend CPVRTString operator+ (const char _Left, const CPVRTString& _Right);
 
+	/*!***********************************************************************
+	@brief      		Returns the heap traffic of all CPVRTStrings since the
+						last ResetAllocStats(). All counts are zero unless
+						PVRTSTRING_ALLOC_STATS is defined.
+	@param[out]			stats	Heap traffic
+	*************************************************************************/
+	static void GetAllocStats(SPVRTStringAllocStats& stats);
+
+	/*!***********************************************************************
+	@brief      		Resets the counts returned by GetAllocStats().
+	*************************************************************************/
+	static void ResetAllocStats();
+
 protected:
+	/*!***********************************************************************
+	@brief      		Replaces the buffer with one of at least _Capacity
+						chars, keeping the current content.
+	@param[in]			_Capacity	Required capacity, including the null terminator
+	*************************************************************************/
+	void grow(size_t _Capacity);
+
+	/*!***********************************************************************
+	@brief      		Takes the content of _Right, leaving _Right empty.
+	@param[in]			_Right	A string
+	*************************************************************************/
+	void take(CPVRTString& _Right);
+
 	char* m_pString;
 	size_t m_Size;
 	size_t m_Capacity;
+	char m_szLocal[PVRTSTRING_LOCAL_CAPACITY];	// Holds short strings, in which case m_pString points here
 };
 
 /*************************************************************************
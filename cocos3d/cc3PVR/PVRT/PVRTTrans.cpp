@@ -20,10 +20,234 @@
 #include "PVRTMatrix.h"
 #include "PVRTTrans.h"
 
+// The SSE2 and NEON paths transform one vertex per vector, in x, y, z, w lane order
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PVRTTRANS_SSE2
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define PVRTTRANS_NEON
+	#include <arm_neon.h>
+#endif
+
+#if (defined(PVRTTRANS_SSE2) || defined(PVRTTRANS_NEON)) && !defined(PVRT_FIXED_POINT_ENABLE)
+	#define PVRTTRANS_SIMD
+#endif
+
+/****************************************************************************
+** Static variables
+****************************************************************************/
+static bool s_bTransSIMD = true;	/*!< Whether the SSE2/NEON paths are enabled */
+
+/****************************************************************************
+** SIMD helpers
+****************************************************************************/
+#if defined(PVRTTRANS_SIMD)
+
+#if defined(PVRTTRANS_SSE2)
+	typedef __m128 PVRTVec4f;
+	#define PVRTVEC4F_LOAD(p)			_mm_loadu_ps(p)
+	#define PVRTVEC4F_SET3(x,y,z)		_mm_set_ps(0.0f, (z), (y), (x))
+	#define PVRTVEC4F_SPLAT(f)			_mm_set1_ps(f)
+	#define PVRTVEC4F_ADD(a,b)			_mm_add_ps((a), (b))
+	#define PVRTVEC4F_MUL(a,b)			_mm_mul_ps((a), (b))
+	#define PVRTVEC4F_STORE(p,v)		_mm_storeu_ps((p), (v))
+	// Return the second operand unless the first is smaller/larger, as the scalar comparisons do, NaNs included
+	#define PVRTVEC4F_MIN(v,m)			_mm_min_ps((v), (m))
+	#define PVRTVEC4F_MAX(v,m)			_mm_max_ps((v), (m))
+	#define PVRTVEC4F_SPLAT_LANE(v,i)	_mm_shuffle_ps((v), (v), _MM_SHUFFLE(i,i,i,i))
+	#define PVRTVEC4F_LANE(v,i)			_mm_cvtss_f32(PVRTVEC4F_SPLAT_LANE(v,i))
+#else
+	typedef float32x4_t PVRTVec4f;
+	#define PVRTVEC4F_LOAD(p)			vld1q_f32(p)
+	#define PVRTVEC4F_SPLAT(f)			vdupq_n_f32(f)
+	#define PVRTVEC4F_ADD(a,b)			vaddq_f32((a), (b))
+	#define PVRTVEC4F_MUL(a,b)			vmulq_f32((a), (b))
+	#define PVRTVEC4F_STORE(p,v)		vst1q_f32((p), (v))
+	// vminq_f32/vmaxq_f32 propagate NaNs, so select explicitly to match the scalar comparisons
+	#define PVRTVEC4F_MIN(v,m)			vbslq_f32(vcltq_f32((v), (m)), (v), (m))
+	#define PVRTVEC4F_MAX(v,m)			vbslq_f32(vcgtq_f32((v), (m)), (v), (m))
+	#define PVRTVEC4F_LANE(v,i)			vgetq_lane_f32((v), (i))
+	#define PVRTVEC4F_SPLAT_LANE(v,i)	vdupq_n_f32(vgetq_lane_f32((v), (i)))
+
+	static inline PVRTVec4f PVRTVEC4F_SET3(const float x, const float y, const float z)
+	{
+		const float af[4] = { x, y, z, 0.0f };
+		return vld1q_f32(af);
+	}
+#endif
+
+/*!***************************************************************************
+ @Function			PVRTVec4fWideLoadCount
+ @Input				nNumberOfVertices	Number of vertices
+ @Input				nStride				Stride between vertices in bytes
+ @Return			Number of leading vertices that may be loaded as four floats
+ @Description		A four float load of a three float vertex reads four bytes
+					past it. That is safe for every vertex but the last when
+					the vertices are at least four bytes apart, because the
+					extra bytes then lie within the last vertex. All other
+					vertices are gathered one float at a time.
+*****************************************************************************/
+static inline int PVRTVec4fWideLoadCount(const int nNumberOfVertices, const int nStride)
+{
+	return (nStride >= (int)sizeof(float) && nNumberOfVertices > 0) ? nNumberOfVertices - 1 : 0;
+}
+
+/*!***************************************************************************
+ @Function			PVRTVec4fLoadVec3
+ @Input				pV					Vertex to load
+ @Input				bWide				Whether a four float load is safe
+ @Return			The vertex, with an undefined fourth lane if bWide is true
+ @Description		Loads a three float vertex into a vector.
+*****************************************************************************/
+static inline PVRTVec4f PVRTVec4fLoadVec3(const float * const pV, const bool bWide)
+{
+	return bWide ? PVRTVEC4F_LOAD(pV) : PVRTVEC4F_SET3(pV[0], pV[1], pV[2]);
+}
+
+/*!***************************************************************************
+ @Function			PVRTVec4fStoreVec3
+ @Output			pOut				Destination vertex
+ @Input				v					Vector to store
+ @Description		Stores the first three lanes of a vector, without touching
+					the bytes that follow, which may be the next input vertex
+					when transforming in place.
+*****************************************************************************/
+static inline void PVRTVec4fStoreVec3(float * const pOut, const PVRTVec4f v)
+{
+#if defined(PVRTTRANS_SSE2)
+	_mm_storel_pi((__m64*)pOut, v);
+	_mm_store_ss(pOut + 2, _mm_movehl_ps(v, v));
+#else
+	vst1_f32(pOut, vget_low_f32(v));
+	vst1q_lane_f32(pOut + 2, v, 2);
+#endif
+}
+
+/*!***************************************************************************
+ @Function			PVRTVec4fTransform
+ @Input				v					Vertex, whose fourth lane is ignored
+ @Input				c0					First column of the matrix
+ @Input				c1					Second column of the matrix
+ @Input				c2					Third column of the matrix
+ @Input				c3					Fourth column of the matrix, scaled by W
+ @Return			The transformed vertex
+ @Description		Transforms a vertex by a matrix, summing the products in
+					the same order as the scalar code.
+*****************************************************************************/
+static inline PVRTVec4f PVRTVec4fTransform(const PVRTVec4f v, const PVRTVec4f c0, const PVRTVec4f c1,
+										   const PVRTVec4f c2, const PVRTVec4f c3)
+{
+	PVRTVec4f r = PVRTVEC4F_MUL(c0, PVRTVEC4F_SPLAT_LANE(v, 0));
+	r = PVRTVEC4F_ADD(r, PVRTVEC4F_MUL(c1, PVRTVEC4F_SPLAT_LANE(v, 1)));
+	r = PVRTVEC4F_ADD(r, PVRTVEC4F_MUL(c2, PVRTVEC4F_SPLAT_LANE(v, 2)));
+	return PVRTVEC4F_ADD(r, c3);
+}
+
+/*!***************************************************************************
+ @Function			PVRTBoundingBoxExtentsSIMD
+ @Output			pMin				Minimum x, y and z
+ @Output			pMax				Maximum x, y and z
+ @Input				pV					First vertex
+ @Input				nNumberOfVertices	Number of vertices, at least one
+ @Input				i32Stride			Stride between vertices in bytes
+ @Description		SIMD equivalent of the extrema loops of the bounding box
+					functions. NaN coordinates are ignored as they are by the
+					scalar loops, so the results only differ in the sign of
+					zero extrema.
+*****************************************************************************/
+static void PVRTBoundingBoxExtentsSIMD(
+	VERTTYPE			* const pMin,
+	VERTTYPE			* const pMax,
+	const unsigned char	* const pV,
+	const int			nNumberOfVertices,
+	const int			i32Stride)
+{
+	const int nWide = PVRTVec4fWideLoadCount(nNumberOfVertices, i32Stride);
+	const unsigned char *pVertex = pV;
+	int i = 1;
+
+	PVRTVec4f vMin = PVRTVec4fLoadVec3((const float*)pVertex, nWide > 0);
+	PVRTVec4f vMax = vMin;
+
+	// Two sets of extrema halve the dependency chains
+	PVRTVec4f vMin2 = vMin, vMax2 = vMax;
+	for (; i+1<nWide; i+=2)
+	{
+		PVRTVec4f v = PVRTVEC4F_LOAD((const float*)(pVertex + i32Stride));
+		PVRTVec4f v2 = PVRTVEC4F_LOAD((const float*)(pVertex + 2*i32Stride));
+		pVertex += 2*i32Stride;
+		vMin = PVRTVEC4F_MIN(v, vMin);
+		vMax = PVRTVEC4F_MAX(v, vMax);
+		vMin2 = PVRTVEC4F_MIN(v2, vMin2);
+		vMax2 = PVRTVEC4F_MAX(v2, vMax2);
+	}
+	vMin = PVRTVEC4F_MIN(vMin2, vMin);
+	vMax = PVRTVEC4F_MAX(vMax2, vMax);
+
+	for (; i<nNumberOfVertices; ++i)
+	{
+		pVertex += i32Stride;
+		PVRTVec4f v = PVRTVec4fLoadVec3((const float*)pVertex, i < nWide);
+		vMin = PVRTVEC4F_MIN(v, vMin);
+		vMax = PVRTVEC4F_MAX(v, vMax);
+	}
+
+	pMin[0] = PVRTVEC4F_LANE(vMin, 0);	pMax[0] = PVRTVEC4F_LANE(vMax, 0);
+	pMin[1] = PVRTVEC4F_LANE(vMin, 1);	pMax[1] = PVRTVEC4F_LANE(vMax, 1);
+	pMin[2] = PVRTVEC4F_LANE(vMin, 2);	pMax[2] = PVRTVEC4F_LANE(vMax, 2);
+}
+
+/*!***************************************************************************
+ @Function			PVRTBoundingBoxFromExtents
+ @Output			pBoundingBox
+ @Input				pMin				Minimum x, y and z
+ @Input				pMax				Maximum x, y and z
+ @Description		Sets the eight corners of a bounding box, in the same order
+					as PVRTBoundingBoxCompute().
+*****************************************************************************/
+static void PVRTBoundingBoxFromExtents(
+	PVRTBOUNDINGBOX		* const pBoundingBox,
+	const VERTTYPE		* const pMin,
+	const VERTTYPE		* const pMax)
+{
+	for (int i=0; i<8; ++i)
+	{
+		pBoundingBox->Point[i].x = (i & 4) ? pMax[0] : pMin[0];
+		pBoundingBox->Point[i].y = (i & 2) ? pMax[1] : pMin[1];
+		pBoundingBox->Point[i].z = (i & 1) ? pMax[2] : pMin[2];
+	}
+}
+
+#endif /* PVRTTRANS_SIMD */
+
 /****************************************************************************
 ** Functions
 ****************************************************************************/
 
+/*!***************************************************************************
+ @Function			PVRTTransSetSIMD
+ @Input				bEnable			Whether to use the SSE2/NEON paths
+ @Description		Enables or disables the SSE2/NEON paths.
+*****************************************************************************/
+void PVRTTransSetSIMD(const bool bEnable)
+{
+	s_bTransSIMD = bEnable;
+}
+
+/*!***************************************************************************
+ @Function			PVRTTransUsesSIMD
+ @Return			true if the SSE2/NEON paths are in use
+ @Description		Returns whether the SSE2/NEON paths are in use.
+*****************************************************************************/
+bool PVRTTransUsesSIMD()
+{
+#if defined(PVRTTRANS_SIMD)
+	return s_bTransSIMD;
+#else
+	return false;
+#endif
+}
+
 /*!***************************************************************************
  @Function			PVRTBoundingBoxCompute
  @Output			pBoundingBox
@@ -43,6 +267,16 @@ void PVRTBoundingBoxCompute(
 	int			i;
 	VERTTYPE	MinX, MaxX, MinY, MaxY, MinZ, MaxZ;
 
+#if defined(PVRTTRANS_SIMD)
+	if (s_bTransSIMD && nNumberOfVertices > 0)
+	{
+		VERTTYPE afMin[3], afMax[3];
+		PVRTBoundingBoxExtentsSIMD(afMin, afMax, (const unsigned char*)pV, nNumberOfVertices, sizeof(PVRTVECTOR3));
+		PVRTBoundingBoxFromExtents(pBoundingBox, afMin, afMax);
+		return;
+	}
+#endif
+
 	/* Inialise values to first vertex */
 	MinX=pV->x;	MaxX=pV->x;
 	MinY=pV->y;	MaxY=pV->y;
@@ -131,6 +365,16 @@ void PVRTBoundingBoxComputeInterleaved(
 	int			i;
 	VERTTYPE	MinX, MaxX, MinY, MaxY, MinZ, MaxZ;
 
+#if defined(PVRTTRANS_SIMD)
+	if (s_bTransSIMD && nNumberOfVertices > 0)
+	{
+		VERTTYPE afMin[3], afMax[3];
+		PVRTBoundingBoxExtentsSIMD(afMin, afMax, pV+i32Offset, nNumberOfVertices, i32Stride);
+		PVRTBoundingBoxFromExtents(pBoundingBox, afMin, afMax);
+		return;
+	}
+#endif
+
 	// point ot first vertex
 	PVRTVECTOR3 *pVertex =(PVRTVECTOR3*)(pV+i32Offset);
 
@@ -318,6 +562,27 @@ void PVRTTransformVec3Array(
 	pSrc = pV;
 	pDst = pOut;
 
+#if defined(PVRTTRANS_SIMD)
+	if (s_bTransSIMD)
+	{
+		const PVRTVec4f c0 = PVRTVEC4F_LOAD(&pMatrix->f[0]);
+		const PVRTVec4f c1 = PVRTVEC4F_LOAD(&pMatrix->f[4]);
+		const PVRTVec4f c2 = PVRTVEC4F_LOAD(&pMatrix->f[8]);
+		const PVRTVec4f c3 = PVRTVEC4F_LOAD(&pMatrix->f[12]);
+		const int nWide = PVRTVec4fWideLoadCount(nNumberOfVertices, nInStride);
+
+		for (i=0; i<nNumberOfVertices; ++i)
+		{
+			const PVRTVec4f v = PVRTVec4fLoadVec3(&pSrc->x, i < nWide);
+			PVRTVEC4F_STORE(&pDst->x, PVRTVec4fTransform(v, c0, c1, c2, c3));
+
+			pDst = (PVRTVECTOR4*)((char*)pDst + nOutStride);
+			pSrc = (PVRTVECTOR3*)((char*)pSrc + nInStride);
+		}
+		return;
+	}
+#endif
+
 	/* Transform all vertices with *pMatrix */
 	for (i=0; i<nNumberOfVertices; ++i)
 	{
@@ -366,6 +631,24 @@ void PVRTTransformArray(
 {
 	int			i;
 
+#if defined(PVRTTRANS_SIMD)
+	if (s_bTransSIMD)
+	{
+		const PVRTVec4f c0 = PVRTVEC4F_LOAD(&pMatrix->f[0]);
+		const PVRTVec4f c1 = PVRTVEC4F_LOAD(&pMatrix->f[4]);
+		const PVRTVec4f c2 = PVRTVEC4F_LOAD(&pMatrix->f[8]);
+		const PVRTVec4f c3 = PVRTVEC4F_MUL(PVRTVEC4F_LOAD(&pMatrix->f[12]), PVRTVEC4F_SPLAT(fW));
+		const int nWide = PVRTVec4fWideLoadCount(nNumberOfVertices, sizeof(PVRTVECTOR3));
+
+		for (i=0; i<nNumberOfVertices; ++i)
+		{
+			const PVRTVec4f v = PVRTVec4fLoadVec3(&pV[i].x, i < nWide);
+			PVRTVec4fStoreVec3(&pTransformedVertex[i].x, PVRTVec4fTransform(v, c0, c1, c2, c3));
+		}
+		return;
+	}
+#endif
+
 	/* Transform all vertices with *pMatrix */
 	for (i=0; i<nNumberOfVertices; ++i)
 	{
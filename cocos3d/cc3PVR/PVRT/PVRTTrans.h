@@ -86,6 +86,24 @@ bool PVRTBoundingBoxIsVisible(
 	const PVRTMATRIX		* const pMatrix,
 	bool					* const pNeedsZClipping);
 
+/*!***************************************************************************
+ @fn       			PVRTTransSetSIMD
+ @param[in]			bEnable			Whether to use the SSE2/NEON paths
+ @brief      		Enables or disables the SSE2/NEON paths of
+					PVRTBoundingBoxCompute(), PVRTBoundingBoxComputeInterleaved(),
+					PVRTTransformVec3Array() and PVRTTransformArray(). The scalar
+					paths are used when they are disabled, or when the library was
+					built for a processor without SSE2 or NEON. Enabled by default.
+*****************************************************************************/
+void PVRTTransSetSIMD(const bool bEnable);
+
+/*!***************************************************************************
+ @fn       			PVRTTransUsesSIMD
+ @return			true if the SSE2/NEON paths are in use
+ @brief      		Returns whether the SSE2/NEON paths are in use.
+*****************************************************************************/
+bool PVRTTransUsesSIMD();
+
 /*!***************************************************************************
  @fn                PVRTTransformVec3Array
  @param[out]		pOut				Destination for transformed vectors
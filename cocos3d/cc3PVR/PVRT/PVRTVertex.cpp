@@ -25,15 +25,20 @@
 #include "PVRTFixedPoint.h"
 #include "PVRTMatrix.h"
 #include "PVRTVertex.h"
+#include "PVRTParallel.h"
 
 /****************************************************************************
 ** Defines
 ****************************************************************************/
+#define PVRTVERTEX_TRIS_PER_TASK	1024		/*!< Triangles per task of the tangent space pass */
+#define PVRTVERTEX_VERTS_PER_TASK	1024		/*!< Vertices per task of the vertex splitting passes */
+#define PVRTVERTEX_HASHED_VALENCE	16			/*!< Vertices with more corners than this bucket them by tangent frame */
+#define PVRTVERTEX_FRAME_BUCKETS	256			/*!< Number of tangent frame buckets, a power of two */
+#define PVRTVERTEX_NO_CORNER		0xFFFFFFFF	/*!< Marks the end of a group, or an empty bucket */
 
 /****************************************************************************
 ** Macros
 ****************************************************************************/
-#define MAX_VERTEX_OUT (3*nVtxNum)
 
 /****************************************************************************
 ** Structures
@@ -557,6 +562,235 @@ void PVRTVertexTangentBitangent(
 	}
 }
 
+/*!***************************************************************************
+ Work shared by the passes of PVRTVertexGenerateTangentSpace. Corners are
+ the entries of the index array; corner positions index the adjacency list
+ pui32Corner, in which the corners of each vertex are contiguous.
+*****************************************************************************/
+struct STangentSpaceJob
+{
+	const unsigned int	*pui32Idx;			// Input index array
+	unsigned int		nVtxNum;			// Input vertex count
+	unsigned int		nTriNum;			// Number of triangles
+	const char			*pVtx;				// Input vertices
+	unsigned int		nStride;			// Size of a vertex (in bytes)
+	unsigned int		nOffsetPos, nOffsetNor, nOffsetTex, nOffsetTan, nOffsetBin;
+	EPVRTDataType		eTypePos, eTypeNor, eTypeTex, eTypeTan, eTypeBin;
+	float				fSplitDifference;	// Split threshold for the DP3 of tangents/bitangents
+
+	PVRTVECTOR3f		*pvTan;				// Tangent wanted at each corner
+	PVRTVECTOR3f		*pvBin;				// Bitangent wanted at each corner
+	unsigned int		*pui32VtxStart;		// First position of each vertex's corners, plus an end entry
+	unsigned int		*pui32Corner;		// Corner at each position, grouped by vertex, in triangle order
+	unsigned int		*pui32Group;		// Group of the corner at each position, numbered per vertex
+	unsigned int		*pui32Next;			// Next position in the same group, or PVRTVERTEX_NO_CORNER
+	unsigned int		*pui32Head;			// First position of group g of a vertex, at the vertex's start + g
+	unsigned int		*pui32Tail;			// Last position of group g of a vertex, at the vertex's start + g
+	unsigned int		*pui32VtxOutStart;	// Group count, then first output vertex, of each vertex
+	unsigned int		*pui32IdxNew;		// Output index of each corner
+	char				*pVtxOut;			// Output vertices
+};
+
+/*!***************************************************************************
+ @Function			PVRTVertexFreeTangentSpaceJob
+ @Modified			job					Work to free
+ @Description		Frees the work space of PVRTVertexGenerateTangentSpace.
+*****************************************************************************/
+static void PVRTVertexFreeTangentSpaceJob(STangentSpaceJob &job)
+{
+	FREE(job.pvTan);
+	FREE(job.pvBin);
+	FREE(job.pui32VtxStart);
+	FREE(job.pui32Corner);
+	FREE(job.pui32Group);
+	FREE(job.pui32Next);
+	FREE(job.pui32Head);
+	FREE(job.pui32Tail);
+	FREE(job.pui32VtxOutStart);
+	FREE(job.pui32IdxNew);
+	FREE(job.pVtxOut);
+}
+
+/*!***************************************************************************
+ @Function			PVRTVertexTangentSpaceTris
+ @Input				pUserData			The STangentSpaceJob
+ @Input				ui32Task			Index of the block of triangles
+ @Description		Calculates the tangent and bitangent that each triangle in
+					a block wants at each of its corners.
+*****************************************************************************/
+static void PVRTVertexTangentSpaceTris(void *pUserData, const unsigned int ui32Task)
+{
+	const STangentSpaceJob &job = *(const STangentSpaceJob*)pUserData;
+	const unsigned int nTriEnd = PVRT_MIN(job.nTriNum, (ui32Task + 1) * PVRTVERTEX_TRIS_PER_TASK);
+	float pfPos[3][4], pfTex[3][4], pfNor[3][4];
+
+	for(unsigned int nTri = ui32Task * PVRTVERTEX_TRIS_PER_TASK; nTri < nTriEnd; ++nTri) {
+		for(int k = 0; k < 3; ++k) {
+			const char *pV = &job.pVtx[job.pui32Idx[3*nTri+k] * job.nStride];
+			PVRTVertexRead((PVRTVECTOR4f*) &pfPos[k][0], pV + job.nOffsetPos, job.eTypePos, 3);
+			PVRTVertexRead((PVRTVECTOR4f*) &pfNor[k][0], pV + job.nOffsetNor, job.eTypeNor, 3);
+			PVRTVertexRead((PVRTVECTOR4f*) &pfTex[k][0], pV + job.nOffsetTex, job.eTypeTex, 3);
+		}
+
+		for(int k = 0; k < 3; ++k) {
+			const int k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+			PVRTVertexTangentBitangent(
+				&job.pvTan[3*nTri+k],
+				&job.pvBin[3*nTri+k],
+				(PVRTVECTOR3f*) &pfNor[k][0],
+				pfPos[k], pfPos[k1], pfPos[k2],
+				pfTex[k], pfTex[k1], pfTex[k2]);
+		}
+	}
+}
+
+/*!***************************************************************************
+ @Function			PVRTVertexTangentFrameHash
+ @Input				vTan				Tangent
+ @Input				vBin				Bitangent
+ @Return			Hash of the bits of the tangent frame
+ @Description		Hashes a tangent frame for the frame buckets of
+					PVRTVertexTangentSpaceGroup.
+*****************************************************************************/
+static inline unsigned int PVRTVertexTangentFrameHash(const PVRTVECTOR3f &vTan, const PVRTVECTOR3f &vBin)
+{
+	PVRTuint32 aui32Bits[6];
+	memcpy(&aui32Bits[0], &vTan, sizeof(vTan));
+	memcpy(&aui32Bits[3], &vBin, sizeof(vBin));
+
+	PVRTuint32 ui32Hash = 2166136261u;
+	for(int i = 0; i < 6; ++i)
+		ui32Hash = (ui32Hash ^ aui32Bits[i]) * 16777619u;
+	return ui32Hash ^ (ui32Hash >> 15);
+}
+
+/*!***************************************************************************
+ @Function			PVRTVertexTangentSpaceGroup
+ @Input				pUserData			The STangentSpaceJob
+ @Input				ui32Task			Index of the block of vertices
+ @Description		Groups the corners of each vertex in a block. A corner
+					joins the first group all of whose corners want a similar
+					tangent space, or else starts a new group. High-valence
+					vertices keep a bucket of recent corners per tangent frame;
+					a corner with exactly the same frame as one in its bucket
+					joins that corner's group without comparing, as comparing
+					would give the same group.
+*****************************************************************************/
+static void PVRTVertexTangentSpaceGroup(void *pUserData, const unsigned int ui32Task)
+{
+	const STangentSpaceJob &job = *(const STangentSpaceJob*)pUserData;
+	const unsigned int nVertEnd = PVRT_MIN(job.nVtxNum, (ui32Task + 1) * PVRTVERTEX_VERTS_PER_TASK);
+	unsigned int aui32Bucket[PVRTVERTEX_FRAME_BUCKETS];
+
+	for(unsigned int nVert = ui32Task * PVRTVERTEX_VERTS_PER_TASK; nVert < nVertEnd; ++nVert) {
+		const unsigned int nStart = job.pui32VtxStart[nVert];
+		const unsigned int nEnd = job.pui32VtxStart[nVert + 1];
+		const bool bHashed = (nEnd - nStart) > PVRTVERTEX_HASHED_VALENCE;
+		unsigned int nGroups = 0;
+
+		if(bHashed)
+			memset(aui32Bucket, 0xFF, sizeof(aui32Bucket));
+
+		for(unsigned int nPos = nStart; nPos < nEnd; ++nPos) {
+			const PVRTVECTOR3f &vTan = job.pvTan[job.pui32Corner[nPos]];
+			const PVRTVECTOR3f &vBin = job.pvBin[job.pui32Corner[nPos]];
+			unsigned int nGroup = PVRTVERTEX_NO_CORNER, nBucket = 0;
+
+			if(bHashed) {
+				nBucket = PVRTVertexTangentFrameHash(vTan, vBin) & (PVRTVERTEX_FRAME_BUCKETS - 1);
+				const unsigned int nSame = aui32Bucket[nBucket];
+				if(nSame != PVRTVERTEX_NO_CORNER &&
+				   memcmp(&vTan, &job.pvTan[job.pui32Corner[nSame]], sizeof(vTan)) == 0 &&
+				   memcmp(&vBin, &job.pvBin[job.pui32Corner[nSame]], sizeof(vBin)) == 0)
+					nGroup = job.pui32Group[nSame];
+			}
+
+			// Run through the groups to see if all the corners of one match
+			for(unsigned int g = 0; nGroup == PVRTVERTEX_NO_CORNER && g < nGroups; ++g) {
+				unsigned int nCmp;
+				for(nCmp = job.pui32Head[nStart + g]; nCmp != PVRTVERTEX_NO_CORNER; nCmp = job.pui32Next[nCmp]) {
+					if(PVRTMatrixVec3DotProductF(vTan, job.pvTan[job.pui32Corner[nCmp]]) < job.fSplitDifference)
+						break;
+					if(PVRTMatrixVec3DotProductF(vBin, job.pvBin[job.pui32Corner[nCmp]]) < job.fSplitDifference)
+						break;
+				}
+
+				if(nCmp == PVRTVERTEX_NO_CORNER)
+					nGroup = g;
+			}
+
+			if(nGroup == PVRTVERTEX_NO_CORNER) {
+				// We never found another matching group, so let's add this as a different one
+				nGroup = nGroups++;
+				job.pui32Head[nStart + nGroup] = nPos;
+			} else {
+				job.pui32Next[job.pui32Tail[nStart + nGroup]] = nPos;
+			}
+
+			job.pui32Tail[nStart + nGroup] = nPos;
+			job.pui32Next[nPos] = PVRTVERTEX_NO_CORNER;
+			job.pui32Group[nPos] = nGroup;
+
+			if(bHashed)
+				aui32Bucket[nBucket] = nPos;
+		}
+
+		job.pui32VtxOutStart[nVert] = nGroups;
+	}
+}
+
+/*!***************************************************************************
+ @Function			PVRTVertexTangentSpaceWrite
+ @Input				pUserData			The STangentSpaceJob
+ @Input				ui32Task			Index of the block of vertices
+ @Description		Writes an output vertex for each group of each vertex in a
+					block, with the average tangent space of the group, and
+					points the corners of the group at it.
+*****************************************************************************/
+static void PVRTVertexTangentSpaceWrite(void *pUserData, const unsigned int ui32Task)
+{
+	const STangentSpaceJob &job = *(const STangentSpaceJob*)pUserData;
+	const unsigned int nVertEnd = PVRT_MIN(job.nVtxNum, (ui32Task + 1) * PVRTVERTEX_VERTS_PER_TASK);
+	float pfTan[4], pfBin[4];
+
+	for(unsigned int nVert = ui32Task * PVRTVERTEX_VERTS_PER_TASK; nVert < nVertEnd; ++nVert) {
+		const unsigned int nStart = job.pui32VtxStart[nVert];
+		const unsigned int nOutStart = job.pui32VtxOutStart[nVert];
+		const unsigned int nGroups = job.pui32VtxOutStart[nVert + 1] - nOutStart;
+
+		for(unsigned int g = 0; g < nGroups; ++g) {
+			const unsigned int nOut = nOutStart + g;
+			char *pOut = &job.pVtxOut[nOut * job.nStride];
+
+			memset(&pfTan, 0, sizeof(pfTan));
+			memset(&pfBin, 0, sizeof(pfBin));
+
+			for(unsigned int nPos = job.pui32Head[nStart + g]; nPos != PVRTVERTEX_NO_CORNER; nPos = job.pui32Next[nPos]) {
+				const unsigned int nCorner = job.pui32Corner[nPos];
+
+				// Sum the tangent & bitangents, so we can average them
+				pfTan[0] += job.pvTan[nCorner].x;
+				pfTan[1] += job.pvTan[nCorner].y;
+				pfTan[2] += job.pvTan[nCorner].z;
+
+				pfBin[0] += job.pvBin[nCorner].x;
+				pfBin[1] += job.pvBin[nCorner].y;
+				pfBin[2] += job.pvBin[nCorner].z;
+
+				// Update the triangle index to use this vtx
+				job.pui32IdxNew[nCorner] = nOut;
+			}
+
+			PVRTMatrixVec3NormalizeF(*(PVRTVECTOR3f*) &pfTan[0], *(PVRTVECTOR3f*) &pfTan[0]);
+			PVRTMatrixVec3NormalizeF(*(PVRTVECTOR3f*) &pfBin[0], *(PVRTVECTOR3f*) &pfBin[0]);
+
+			memcpy(pOut, &job.pVtx[nVert * job.nStride], job.nStride);
+			PVRTVertexWrite(pOut + job.nOffsetTan, job.eTypeTan, 3, (PVRTVECTOR4f*) &pfTan[0]);
+			PVRTVertexWrite(pOut + job.nOffsetBin, job.eTypeBin, 3, (PVRTVECTOR4f*) &pfBin[0]);
+		}
+	}
+}
+
 /*!***************************************************************************
  @Function			PVRTVertexGenerateTangentSpace
  @Output			pnVtxNumOut			Output vertex count
@@ -587,6 +821,9 @@ void PVRTVertexTangentBitangent(
 					uses fSplitDifference - of the DP3 of two desired
 					tangents or two desired bitangents is higher than this,
 					the vertex will be split.
+					Any number of triangles may share a vertex. The work
+					space is proportional to the number of indices, and the
+					output does not depend on the number of threads used.
 *****************************************************************************/
 EPVRTError PVRTVertexGenerateTangentSpace(
 	unsigned int	* const pnVtxNumOut,
@@ -608,214 +845,114 @@ EPVRTError PVRTVertexGenerateTangentSpace(
 	const unsigned int	nTriNum,
 	const float		fSplitDifference)
 {
-	const int cnMaxSharedVtx = 32;
-	struct SVtxData
-	{
-		int				n;							// Number of items in following arrays, AKA number of tris using this vtx
-		PVRTVECTOR3f	pvTan[cnMaxSharedVtx];		// Tangent (one per triangle referencing this vtx)
-		PVRTVECTOR3f	pvBin[cnMaxSharedVtx];		// Bitangent (one per triangle referencing this vtx)
-		int				pnTri[cnMaxSharedVtx];		// Triangle index (one per triangle referencing this vtx)
-	};
-	SVtxData		*psVtxData;		// Array of desired tangent spaces per vertex
-	SVtxData		*psTSpass;		// Array of *different* tangent spaces desired for current vertex
-	unsigned int	nTSpassLen;
-	SVtxData		*psVtx, *psCmp;
-	unsigned int	nVert, nCurr, i, j;	// Loop counters
-	unsigned int	nIdx0, nIdx1, nIdx2;
-	float			pfPos0[4], pfPos1[4], pfPos2[4];
-	float			pfTex0[4], pfTex1[4], pfTex2[4];
-	float			pfNor0[4], pfNor1[4], pfNor2[4];
-	unsigned int	*pui32IdxNew;		// New index array, this will be copied over the input array
+	const unsigned int nCornerNum = nTriNum * 3;
+	STangentSpaceJob job;
+	unsigned int nVert, nCorner;
 
 	// Initialise the outputs
 	*pnVtxNumOut	= 0;
-	*pVtxOut		= (char*)malloc(MAX_VERTEX_OUT * nStride);
-	if(!*pVtxOut)
-	{
-		return PVR_FAIL;
-	}
-
-	// Allocate some work space
-	pui32IdxNew		= (unsigned int*)calloc(nTriNum * 3, sizeof(*pui32IdxNew));
-	_ASSERT(pui32IdxNew);
-	psVtxData		= (SVtxData*)calloc(nVtxNum, sizeof(*psVtxData));
-	_ASSERT(psVtxData);
-	psTSpass		= (SVtxData*)calloc(cnMaxSharedVtx, sizeof(*psTSpass));
-	_ASSERT(psTSpass);
-	if(!pui32IdxNew || !psVtxData || !psTSpass)
-	{
-		free(pui32IdxNew);
-		free(psVtxData);
-		free(psTSpass);
-		return PVR_FAIL;
-	}
+	*pVtxOut		= NULL;
 
-	for(nCurr = 0; nCurr < nTriNum; ++nCurr) {
-		nIdx0 = pui32Idx[3*nCurr+0];
-		nIdx1 = pui32Idx[3*nCurr+1];
-		nIdx2 = pui32Idx[3*nCurr+2];
+	// Reject bad triangles before doing any work
+	for(nCorner = 0; nCorner < nCornerNum; nCorner += 3) {
+		const unsigned int nIdx0 = pui32Idx[nCorner+0];
+		const unsigned int nIdx1 = pui32Idx[nCorner+1];
+		const unsigned int nIdx2 = pui32Idx[nCorner+2];
 
 		_ASSERT(nIdx0 < nVtxNum);
 		_ASSERT(nIdx1 < nVtxNum);
 		_ASSERT(nIdx2 < nVtxNum);
-
-		if(nIdx0 == nIdx1 || nIdx1 == nIdx2 || nIdx0 == nIdx2) {
-			_RPT0(_CRT_WARN,"GenerateTangentSpace(): Degenerate triangle found.\n");
+		if(nIdx0 >= nVtxNum || nIdx1 >= nVtxNum || nIdx2 >= nVtxNum) {
+			_RPT0(_CRT_WARN,"GenerateTangentSpace(): Vertex index out of range.\n");
 			return PVR_FAIL;
 		}
 
-		if(
-			psVtxData[nIdx0].n >= cnMaxSharedVtx ||
-			psVtxData[nIdx1].n >= cnMaxSharedVtx ||
-			psVtxData[nIdx2].n >= cnMaxSharedVtx)
-		{
-			_RPT0(_CRT_WARN,"GenerateTangentSpace(): Too many tris sharing a vtx.\n");
+		if(nIdx0 == nIdx1 || nIdx1 == nIdx2 || nIdx0 == nIdx2) {
+			_RPT0(_CRT_WARN,"GenerateTangentSpace(): Degenerate triangle found.\n");
 			return PVR_FAIL;
 		}
-
-		PVRTVertexRead((PVRTVECTOR4f*) &pfPos0[0], (char*)&pVtx[nIdx0 * nStride] + nOffsetPos, eTypePos, 3);
-		PVRTVertexRead((PVRTVECTOR4f*) &pfPos1[0], (char*)&pVtx[nIdx1 * nStride] + nOffsetPos, eTypePos, 3);
-		PVRTVertexRead((PVRTVECTOR4f*) &pfPos2[0], (char*)&pVtx[nIdx2 * nStride] + nOffsetPos, eTypePos, 3);
-
-		PVRTVertexRead((PVRTVECTOR4f*) &pfNor0[0], (char*)&pVtx[nIdx0 * nStride] + nOffsetNor, eTypeNor, 3);
-		PVRTVertexRead((PVRTVECTOR4f*) &pfNor1[0], (char*)&pVtx[nIdx1 * nStride] + nOffsetNor, eTypeNor, 3);
-		PVRTVertexRead((PVRTVECTOR4f*) &pfNor2[0], (char*)&pVtx[nIdx2 * nStride] + nOffsetNor, eTypeNor, 3);
-
-		PVRTVertexRead((PVRTVECTOR4f*) &pfTex0[0], (char*)&pVtx[nIdx0 * nStride] + nOffsetTex, eTypeTex, 3);
-		PVRTVertexRead((PVRTVECTOR4f*) &pfTex1[0], (char*)&pVtx[nIdx1 * nStride] + nOffsetTex, eTypeTex, 3);
-		PVRTVertexRead((PVRTVECTOR4f*) &pfTex2[0], (char*)&pVtx[nIdx2 * nStride] + nOffsetTex, eTypeTex, 3);
-
-		PVRTVertexTangentBitangent(
-			&psVtxData[nIdx0].pvTan[psVtxData[nIdx0].n],
-			&psVtxData[nIdx0].pvBin[psVtxData[nIdx0].n],
-			(PVRTVECTOR3f*) &pfNor0[0],
-			pfPos0, pfPos1, pfPos2,
-			pfTex0, pfTex1, pfTex2);
-
-		PVRTVertexTangentBitangent(
-			&psVtxData[nIdx1].pvTan[psVtxData[nIdx1].n],
-			&psVtxData[nIdx1].pvBin[psVtxData[nIdx1].n],
-			(PVRTVECTOR3f*) &pfNor1[0],
-			pfPos1, pfPos2, pfPos0,
-			pfTex1, pfTex2, pfTex0);
-
-		PVRTVertexTangentBitangent(
-			&psVtxData[nIdx2].pvTan[psVtxData[nIdx2].n],
-			&psVtxData[nIdx2].pvBin[psVtxData[nIdx2].n],
-			(PVRTVECTOR3f*) &pfNor2[0],
-			pfPos2, pfPos0, pfPos1,
-			pfTex2, pfTex0, pfTex1);
-
-		psVtxData[nIdx0].pnTri[psVtxData[nIdx0].n] = nCurr;
-		psVtxData[nIdx1].pnTri[psVtxData[nIdx1].n] = nCurr;
-		psVtxData[nIdx2].pnTri[psVtxData[nIdx2].n] = nCurr;
-
-		++psVtxData[nIdx0].n;
-		++psVtxData[nIdx1].n;
-		++psVtxData[nIdx2].n;
 	}
 
-	// Now let's go through the vertices calculating avg tangent-spaces; create new vertices if necessary
-	for(nVert = 0; nVert < nVtxNum; ++nVert) {
-		psVtx = &psVtxData[nVert];
-
-		// Start out with no output vertices required for this input vertex
-		nTSpassLen = 0;
-
-		// Run through each desired tangent space for this vertex
-		for(nCurr = 0; nCurr < (unsigned int) psVtx->n; ++nCurr) {
-			// Run through the possible vertices we can share with to see if we match
-			for(i = 0; i < nTSpassLen; ++i) {
-				psCmp = &psTSpass[i];
-
-				// Check all the shared vertices which match
-				for(j = 0; j < (unsigned int) psCmp->n; ++j) {
-					if(PVRTMatrixVec3DotProductF(psVtx->pvTan[nCurr], psCmp->pvTan[j]) < fSplitDifference)
-						break;
-					if(PVRTMatrixVec3DotProductF(psVtx->pvBin[nCurr], psCmp->pvBin[j]) < fSplitDifference)
-						break;
-				}
-
-				// Did all the existing vertices match?
-				if(j == (unsigned int) psCmp->n) {
-					// Yes, so add to list
-					_ASSERT(psCmp->n < cnMaxSharedVtx);
-					psCmp->pvTan[psCmp->n] = psVtx->pvTan[nCurr];
-					psCmp->pvBin[psCmp->n] = psVtx->pvBin[nCurr];
-					psCmp->pnTri[psCmp->n] = psVtx->pnTri[nCurr];
-					++psCmp->n;
-					break;
-				}
-			}
-
-			if(i == nTSpassLen) {
-				// We never found another matching matrix, so let's add this as a different one
-				_ASSERT(nTSpassLen < cnMaxSharedVtx);
-				psTSpass[nTSpassLen].pvTan[0] = psVtx->pvTan[nCurr];
-				psTSpass[nTSpassLen].pvBin[0] = psVtx->pvBin[nCurr];
-				psTSpass[nTSpassLen].pnTri[0] = psVtx->pnTri[nCurr];
-				psTSpass[nTSpassLen].n = 1;
-				++nTSpassLen;
-			}
-		}
-
-		// OK, now we have 'nTSpassLen' different desired matrices, so we need to add that many to output
-		_ASSERT(nTSpassLen >= 1);
-		for(nCurr = 0; nCurr < nTSpassLen; ++nCurr) {
-			psVtx = &psTSpass[nCurr];
-
-			memset(&pfPos0, 0, sizeof(pfPos0));
-			memset(&pfPos1, 0, sizeof(pfPos1));
-
-			for(i = 0; i < (unsigned int) psVtx->n; ++i) {
-				// Sum the tangent & bitangents, so we can average them
-				pfPos0[0] += psVtx->pvTan[i].x;
-				pfPos0[1] += psVtx->pvTan[i].y;
-				pfPos0[2] += psVtx->pvTan[i].z;
+	job.pui32Idx			= pui32Idx;
+	job.nVtxNum				= nVtxNum;
+	job.nTriNum				= nTriNum;
+	job.pVtx				= pVtx;
+	job.nStride				= nStride;
+	job.nOffsetPos			= nOffsetPos;
+	job.eTypePos			= eTypePos;
+	job.nOffsetNor			= nOffsetNor;
+	job.eTypeNor			= eTypeNor;
+	job.nOffsetTex			= nOffsetTex;
+	job.eTypeTex			= eTypeTex;
+	job.nOffsetTan			= nOffsetTan;
+	job.eTypeTan			= eTypeTan;
+	job.nOffsetBin			= nOffsetBin;
+	job.eTypeBin			= eTypeBin;
+	job.fSplitDifference	= fSplitDifference;
+	job.pVtxOut				= NULL;
+
+	// Allocate the work space, all of it proportional to the number of indices
+	job.pvTan			= (PVRTVECTOR3f*)malloc(nCornerNum * sizeof(*job.pvTan));
+	job.pvBin			= (PVRTVECTOR3f*)malloc(nCornerNum * sizeof(*job.pvBin));
+	job.pui32Corner		= (unsigned int*)malloc(nCornerNum * sizeof(*job.pui32Corner));
+	job.pui32Group		= (unsigned int*)malloc(nCornerNum * sizeof(*job.pui32Group));
+	job.pui32Next		= (unsigned int*)malloc(nCornerNum * sizeof(*job.pui32Next));
+	job.pui32Head		= (unsigned int*)malloc(nCornerNum * sizeof(*job.pui32Head));
+	job.pui32Tail		= (unsigned int*)malloc(nCornerNum * sizeof(*job.pui32Tail));
+	job.pui32IdxNew		= (unsigned int*)malloc(nCornerNum * sizeof(*job.pui32IdxNew));
+	job.pui32VtxStart	= (unsigned int*)calloc(nVtxNum + 1, sizeof(*job.pui32VtxStart));
+	job.pui32VtxOutStart= (unsigned int*)malloc((nVtxNum + 1) * sizeof(*job.pui32VtxOutStart));
+
+	if(!job.pui32VtxStart || !job.pui32VtxOutStart || (nCornerNum &&
+	   (!job.pvTan || !job.pvBin || !job.pui32Corner || !job.pui32Group || !job.pui32Next ||
+		!job.pui32Head || !job.pui32Tail || !job.pui32IdxNew)))
+	{
+		PVRTVertexFreeTangentSpaceJob(job);
+		return PVR_FAIL;
+	}
 
-				pfPos1[0] += psVtx->pvBin[i].x;
-				pfPos1[1] += psVtx->pvBin[i].y;
-				pfPos1[2] += psVtx->pvBin[i].z;
+	// Calculate the tangent space each triangle wants at each of its corners
+	PVRTParallelFor((nTriNum + PVRTVERTEX_TRIS_PER_TASK - 1) / PVRTVERTEX_TRIS_PER_TASK, PVRTVertexTangentSpaceTris, &job);
 
-				// Update triangle indices to use this vtx
-				if(pui32Idx[3 * psVtx->pnTri[i] + 0] == nVert) {
-					pui32IdxNew[3 * psVtx->pnTri[i] + 0] = *pnVtxNumOut;
+	// Build the vertex-to-corner adjacency, listing the corners of each vertex in triangle order
+	for(nCorner = 0; nCorner < nCornerNum; ++nCorner)
+		++job.pui32VtxStart[pui32Idx[nCorner] + 1];
 
-				} else if(pui32Idx[3 * psVtx->pnTri[i] + 1] == nVert) {
-					pui32IdxNew[3 * psVtx->pnTri[i] + 1] = *pnVtxNumOut;
+	for(nVert = 0; nVert < nVtxNum; ++nVert)
+		job.pui32VtxStart[nVert + 1] += job.pui32VtxStart[nVert];
 
-				} else if(pui32Idx[3 * psVtx->pnTri[i] + 2] == nVert) {
-					pui32IdxNew[3 * psVtx->pnTri[i] + 2] = *pnVtxNumOut;
+	memcpy(job.pui32Head, job.pui32VtxStart, nVtxNum * sizeof(*job.pui32Head));		// Used as fill positions here
+	for(nCorner = 0; nCorner < nCornerNum; ++nCorner)
+		job.pui32Corner[job.pui32Head[pui32Idx[nCorner]]++] = nCorner;
 
-				} else {
-					_ASSERT(0);
-				}
-			}
-
-			PVRTMatrixVec3NormalizeF(*(PVRTVECTOR3f*) &pfPos0[0], *(PVRTVECTOR3f*) &pfPos0[0]);
-			PVRTMatrixVec3NormalizeF(*(PVRTVECTOR3f*) &pfPos1[0], *(PVRTVECTOR3f*) &pfPos1[0]);
+	// Group the corners of each vertex by matching tangent space; each group becomes an output vertex
+	const unsigned int nVtxTasks = (nVtxNum + PVRTVERTEX_VERTS_PER_TASK - 1) / PVRTVERTEX_VERTS_PER_TASK;
+	PVRTParallelFor(nVtxTasks, PVRTVertexTangentSpaceGroup, &job);
 
-			if(*pnVtxNumOut >= MAX_VERTEX_OUT) {
-				_RPT0(_CRT_WARN,"PVRTVertexGenerateTangentSpace() ran out of working space! (Too many split vertices)\n");
-				return PVR_FAIL;
-			}
-
-			memcpy(&(*pVtxOut)[(*pnVtxNumOut) * nStride], &pVtx[nVert*nStride], nStride);
-			PVRTVertexWrite((char*)&(*pVtxOut)[(*pnVtxNumOut) * nStride] + nOffsetTan, eTypeTan, 3, (PVRTVECTOR4f*) &pfPos0[0]);
-			PVRTVertexWrite((char*)&(*pVtxOut)[(*pnVtxNumOut) * nStride] + nOffsetBin, eTypeBin, 3, (PVRTVECTOR4f*) &pfPos1[0]);
+	for(nVert = 0; nVert < nVtxNum; ++nVert) {
+		const unsigned int nGroups = job.pui32VtxOutStart[nVert];
+		_ASSERT(nGroups >= 1);
+		job.pui32VtxOutStart[nVert] = *pnVtxNumOut;
+		*pnVtxNumOut += nGroups;
+	}
+	job.pui32VtxOutStart[nVtxNum] = *pnVtxNumOut;
 
-			++*pnVtxNumOut;
-		}
+	// Write the averaged tangent space of each group to its output vertex
+	job.pVtxOut = (char*)malloc(*pnVtxNumOut * nStride);
+	if(*pnVtxNumOut && !job.pVtxOut)
+	{
+		*pnVtxNumOut = 0;
+		PVRTVertexFreeTangentSpaceJob(job);
+		return PVR_FAIL;
 	}
 
-	FREE(psTSpass);
-	FREE(psVtxData);
+	PVRTParallelFor(nVtxTasks, PVRTVertexTangentSpaceWrite, &job);
 
-	*pVtxOut = (char*)realloc(*pVtxOut, *pnVtxNumOut * nStride);
-	_ASSERT(*pVtxOut);
+	memcpy(pui32Idx, job.pui32IdxNew, nCornerNum * sizeof(*job.pui32IdxNew));
 
-	memcpy(pui32Idx, pui32IdxNew, nTriNum * 3 * sizeof(*pui32IdxNew));
-	FREE(pui32IdxNew);
+	*pVtxOut = job.pVtxOut;
+	job.pVtxOut = NULL;
+	PVRTVertexFreeTangentSpaceJob(job);
 
 	_RPT3(_CRT_WARN, "GenerateTangentSpace(): %d tris, %d vtx in, %d vtx out\n", nTriNum, nVtxNum, *pnVtxNumOut);
 	_ASSERT(*pnVtxNumOut >= nVtxNum);
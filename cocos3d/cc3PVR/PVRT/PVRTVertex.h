@@ -149,6 +149,9 @@ void PVRTVertexTangentBitangent(
 					uses fSplitDifference - of the DP3 of two desired
 					tangents or two desired bitangents is higher than this,
 					the vertex will be split.
+					Any number of triangles may share a vertex. The work
+					space is proportional to the number of indices, and the
+					output does not depend on the number of threads used.
 *****************************************************************************/
 EPVRTError PVRTVertexGenerateTangentSpace(
 	unsigned int	* const pnVtxNumOut,
@@ -50,9 +50,39 @@
  */
 @interface CC3AffineMatrix : CC3Matrix {
 	CC3Matrix4x3 _contents;
+	CC3Matrix4x3* _contentsStorage;
 }
 
 
+#pragma mark Contents storage
+
+/**
+ * The external CC3Matrix4x3 structure that holds the contents of this matrix, or NULL if this
+ * matrix holds its contents internally, which is the default.
+ *
+ * Setting this property to point to an external structure, such as an element of an array,
+ * makes this matrix a view onto that structure. The current contents of this matrix are not
+ * copied to the external structure, and the contents of this matrix become the contents of
+ * that structure. Setting this property back to NULL copies the contents of the external
+ * structure into the internal storage of this matrix.
+ *
+ * The external structure must remain valid while this matrix refers to it. If the external
+ * structure is moved, this property must be set to its new location before this matrix is
+ * used again. If the contents of the external structure are changed directly, rather than
+ * through this matrix, the contentsWereChanged method must be invoked before this matrix
+ * is used again.
+ */
+@property(nonatomic, assign) CC3Matrix4x3* contentsStorage;
+
+/**
+ * Updates the isIdentity and isRigid properties of this matrix from its current contents.
+ *
+ * This method must be invoked after the contents of the external structure identified by
+ * the contentsStorage property have been changed directly, rather than through this matrix.
+ */
+-(void) contentsWereChanged;
+
+
 #pragma mark Population
 
 /**
@@ -56,50 +56,78 @@
 
 #pragma mark Allocation and initialization
 
+// The contents storage must be established before the superclass populates the contents.
+-(id) init {
+	_contentsStorage = &_contents;
+	return [super init];
+}
+
 -(NSString*) description {
-	return [NSString stringWithFormat: @"%@ %@", self.class, NSStringFromCC3Matrix4x3(&_contents)];
+	return [NSString stringWithFormat: @"%@ %@", self.class, NSStringFromCC3Matrix4x3(_contentsStorage)];
+}
+
+
+#pragma mark Contents storage
+
+-(CC3Matrix4x3*) contentsStorage { return (_contentsStorage == &_contents) ? NULL : _contentsStorage; }
+
+-(void) setContentsStorage: (CC3Matrix4x3*) contents {
+	if ( !contents ) contents = &_contents;
+	if (contents == _contentsStorage) return;
+
+	// When reverting to internal storage, retain the contents of the external structure.
+	if (contents == &_contents)
+		CC3Matrix4x3PopulateFrom4x3(&_contents, _contentsStorage);
+
+	_contentsStorage = contents;
+	[self contentsWereChanged];
+}
+
+-(void) contentsWereChanged {
+	_isIdentity = CC3Matrix4x3IsIdentity(_contentsStorage);
+	_isRigid = _isIdentity;
 }
 
 
 #pragma mark Population
 
--(void) implPopulateZero { CC3Matrix4x3PopulateZero(&_contents); }
+-(void) implPopulateZero { CC3Matrix4x3PopulateZero(_contentsStorage); }
 
--(void) implPopulateIdentity { CC3Matrix4x3PopulateIdentity(&_contents); }
+-(void) implPopulateIdentity { CC3Matrix4x3PopulateIdentity(_contentsStorage); }
 
 // Double-dispatch to the other matrix
--(void) implPopulateFrom: (CC3Matrix*) aMatrix { [aMatrix populateCC3Matrix4x3: &_contents]; }
+-(void) implPopulateFrom: (CC3Matrix*) aMatrix { [aMatrix populateCC3Matrix4x3: _contentsStorage]; }
 
--(void) implPopulateFromCC3Matrix3x3: (CC3Matrix3x3*) mtx { CC3Matrix4x3PopulateFrom3x3(&_contents, mtx); }
+-(void) implPopulateFromCC3Matrix3x3: (CC3Matrix3x3*) mtx { CC3Matrix4x3PopulateFrom3x3(_contentsStorage, mtx); }
 
--(void) populateCC3Matrix3x3: (CC3Matrix3x3*) mtx { CC3Matrix3x3PopulateFrom4x3(mtx, &_contents); }
+-(void) populateCC3Matrix3x3: (CC3Matrix3x3*) mtx { CC3Matrix3x3PopulateFrom4x3(mtx, _contentsStorage); }
 
--(void) implPopulateFromCC3Matrix4x3: (CC3Matrix4x3*) mtx { CC3Matrix4x3PopulateFrom4x3(&_contents, mtx); }
+-(void) implPopulateFromCC3Matrix4x3: (CC3Matrix4x3*) mtx { CC3Matrix4x3PopulateFrom4x3(_contentsStorage, mtx); }
 
--(void) populateCC3Matrix4x3: (CC3Matrix4x3*) mtx { CC3Matrix4x3PopulateFrom4x3(mtx, &_contents); }
+-(void) populateCC3Matrix4x3: (CC3Matrix4x3*) mtx { CC3Matrix4x3PopulateFrom4x3(mtx, _contentsStorage); }
 
--(void) implPopulateFromCC3Matrix4x4: (CC3Matrix4x4*) mtx { CC3Matrix4x3PopulateFrom4x4(&_contents, mtx); }
+-(void) implPopulateFromCC3Matrix4x4: (CC3Matrix4x4*) mtx { CC3Matrix4x3PopulateFrom4x4(_contentsStorage, mtx); }
 
--(void) populateCC3Matrix4x4: (CC3Matrix4x4*) mtx { CC3Matrix4x4PopulateFrom4x3(mtx, &_contents); }
+-(void) populateCC3Matrix4x4: (CC3Matrix4x4*) mtx { CC3Matrix4x4PopulateFrom4x3(mtx, _contentsStorage); }
 
 -(void) implPopulateFromRotation: (CC3Vector) aRotation {
-	CC3Matrix4x3PopulateFromRotationYXZ(&_contents, aRotation);
+	CC3Matrix4x3PopulateFromRotationYXZ(_contentsStorage, aRotation);
 }
 
 -(void) implPopulateFromQuaternion: (CC3Quaternion) aQuaternion {
-	CC3Matrix4x3PopulateFromQuaternion(&_contents, aQuaternion);
+	CC3Matrix4x3PopulateFromQuaternion(_contentsStorage, aQuaternion);
 }
 
 -(void) implPopulateFromScale: (CC3Vector) aScale {
-	CC3Matrix4x3PopulateFromScale(&_contents, aScale);
+	CC3Matrix4x3PopulateFromScale(_contentsStorage, aScale);
 }
 
 -(void) implPopulateFromTranslation: (CC3Vector) aTranslation {
-	CC3Matrix4x3PopulateFromTranslation(&_contents, aTranslation);
+	CC3Matrix4x3PopulateFromTranslation(_contentsStorage, aTranslation);
 }
 
 -(void) implPopulateToPointTowards: (CC3Vector) fwdDirection withUp: (CC3Vector) upDirection {
-	CC3Matrix4x3PopulateToPointTowards(&_contents, fwdDirection, upDirection);
+	CC3Matrix4x3PopulateToPointTowards(_contentsStorage, fwdDirection, upDirection);
 }
 
 // Keep the compiler happy with the interface re-declaration
@@ -128,7 +156,7 @@
 							   andBottom: (GLfloat) bottom
 								 andNear: (GLfloat) near
 								  andFar: (GLfloat) far {
-	CC3Matrix4x3PopulateOrthoFrustum(&_contents, left, right, top, bottom, near, far);
+	CC3Matrix4x3PopulateOrthoFrustum(_contentsStorage, left, right, top, bottom, near, far);
 }
 
 -(void) implPopulateOrthoFromFrustumLeft: (GLfloat) left
@@ -136,159 +164,159 @@
 								  andTop: (GLfloat) top  
 							   andBottom: (GLfloat) bottom
 								 andNear: (GLfloat) near {
-	CC3Matrix4x3PopulateInfiniteOrthoFrustum(&_contents, left, right, top, bottom, near);
+	CC3Matrix4x3PopulateInfiniteOrthoFrustum(_contentsStorage, left, right, top, bottom, near);
 }
 
 
 #pragma mark Accessing content
 
--(CC3Vector) extractRotation { return CC3Matrix4x3ExtractRotationYXZ(&_contents); }
+-(CC3Vector) extractRotation { return CC3Matrix4x3ExtractRotationYXZ(_contentsStorage); }
 
--(CC3Quaternion) extractQuaternion { return CC3Matrix4x3ExtractQuaternion(&_contents); }
+-(CC3Quaternion) extractQuaternion { return CC3Matrix4x3ExtractQuaternion(_contentsStorage); }
 
--(CC3Vector) extractForwardDirection { return CC3Matrix4x3ExtractForwardDirection(&_contents); }
+-(CC3Vector) extractForwardDirection { return CC3Matrix4x3ExtractForwardDirection(_contentsStorage); }
 
--(CC3Vector) extractUpDirection { return CC3Matrix4x3ExtractUpDirection(&_contents); }
+-(CC3Vector) extractUpDirection { return CC3Matrix4x3ExtractUpDirection(_contentsStorage); }
 
--(CC3Vector) extractRightDirection { return CC3Matrix4x3ExtractRightDirection(&_contents); }
+-(CC3Vector) extractRightDirection { return CC3Matrix4x3ExtractRightDirection(_contentsStorage); }
 
--(CC3Vector) extractTranslation { return CC3Matrix4x3ExtractTranslation(&_contents); }
+-(CC3Vector) extractTranslation { return CC3Matrix4x3ExtractTranslation(_contentsStorage); }
 
 
 #pragma mark Matrix transformations
 
--(void) implRotateBy: (CC3Vector) aRotation { CC3Matrix4x3RotateYXZBy(&_contents, aRotation); }
+-(void) implRotateBy: (CC3Vector) aRotation { CC3Matrix4x3RotateYXZBy(_contentsStorage, aRotation); }
 
 -(void) implRotateByQuaternion: (CC3Quaternion) aQuaternion {
-	CC3Matrix4x3RotateByQuaternion(&_contents, aQuaternion);
+	CC3Matrix4x3RotateByQuaternion(_contentsStorage, aQuaternion);
 }
 
 -(void) orthonormalizeRotationStartingWith: (NSUInteger) startColNum {
-	CC3Matrix4x3Orthonormalize(&_contents, startColNum);
+	CC3Matrix4x3Orthonormalize(_contentsStorage, startColNum);
 }
 
--(void) implScaleBy: (CC3Vector) aScale { CC3Matrix4x3ScaleBy(&_contents, aScale); }
+-(void) implScaleBy: (CC3Vector) aScale { CC3Matrix4x3ScaleBy(_contentsStorage, aScale); }
 
--(void) implTranslateBy: (CC3Vector) aTranslation { CC3Matrix4x3TranslateBy(&_contents, aTranslation); }
+-(void) implTranslateBy: (CC3Vector) aTranslation { CC3Matrix4x3TranslateBy(_contentsStorage, aTranslation); }
 
 
 #pragma mark Matrix multiplication
 
 -(void) implMultiplyBy: (CC3Matrix*) aMatrix {
-	[aMatrix multiplyIntoCC3Matrix4x3: &_contents];
+	[aMatrix multiplyIntoCC3Matrix4x3: _contentsStorage];
 }
 
 -(void) multiplyIntoCC3Matrix3x3: (CC3Matrix3x3*) mtx {
 	if (_isIdentity) return;
 	CC3Matrix4x3 mRslt, mtx4;
 	CC3Matrix4x3PopulateFrom3x3(&mtx4, mtx);
-	CC3Matrix4x3Multiply(&mRslt, &mtx4, &_contents);
+	CC3Matrix4x3Multiply(&mRslt, &mtx4, _contentsStorage);
 	CC3Matrix3x3PopulateFrom4x3(mtx, &mRslt);
 }
 
 -(void) multiplyByCC3Matrix3x3: (CC3Matrix3x3*) mtx {
 	if (_isIdentity) {
-		CC3Matrix4x3PopulateFrom3x3(&_contents, mtx);
+		CC3Matrix4x3PopulateFrom3x3(_contentsStorage, mtx);
 	} else {
 		CC3Matrix4x3 mRslt, mtx4;
 		CC3Matrix4x3PopulateFrom3x3(&mtx4, mtx);
-		CC3Matrix4x3Multiply(&mRslt, &_contents, &mtx4);
-		CC3Matrix4x3PopulateFrom4x3(&_contents, &mRslt);
+		CC3Matrix4x3Multiply(&mRslt, _contentsStorage, &mtx4);
+		CC3Matrix4x3PopulateFrom4x3(_contentsStorage, &mRslt);
 	}
 }
 
 -(void) multiplyIntoCC3Matrix4x3: (CC3Matrix4x3*) mtx {
 	if (_isIdentity) return;
 	CC3Matrix4x3 mRslt;
-	CC3Matrix4x3Multiply(&mRslt, mtx, &_contents);
+	CC3Matrix4x3Multiply(&mRslt, mtx, _contentsStorage);
 	CC3Matrix4x3PopulateFrom4x3(mtx, &mRslt);
 }
 
 -(void) multiplyByCC3Matrix4x3: (CC3Matrix4x3*) mtx {
 	if (_isIdentity) {
-		CC3Matrix4x3PopulateFrom4x3(&_contents, mtx);
+		CC3Matrix4x3PopulateFrom4x3(_contentsStorage, mtx);
 	} else {
 		CC3Matrix4x3 mRslt;
-		CC3Matrix4x3Multiply(&mRslt, &_contents, mtx);
-		CC3Matrix4x3PopulateFrom4x3(&_contents, &mRslt);
+		CC3Matrix4x3Multiply(&mRslt, _contentsStorage, mtx);
+		CC3Matrix4x3PopulateFrom4x3(_contentsStorage, &mRslt);
 	}
 }
 
 -(void) multiplyIntoCC3Matrix4x4: (CC3Matrix4x4*) mtx {
 	if (_isIdentity) return;
 	CC3Matrix4x4 mRslt, mMine;
-	CC3Matrix4x4PopulateFrom4x3(&mMine, &_contents);
+	CC3Matrix4x4PopulateFrom4x3(&mMine, _contentsStorage);
 	CC3Matrix4x4Multiply(&mRslt, mtx, &mMine);
 	CC3Matrix4x4PopulateFrom4x4(mtx, &mRslt);
 }
 
 -(void) multiplyByCC3Matrix4x4: (CC3Matrix4x4*) mtx {
 	if (_isIdentity) {
-		CC3Matrix4x3PopulateFrom4x4(&_contents, mtx);
+		CC3Matrix4x3PopulateFrom4x4(_contentsStorage, mtx);
 	} else {
 		CC3Matrix4x4 mRslt, mMine;
-		CC3Matrix4x4PopulateFrom4x3(&mMine, &_contents);
+		CC3Matrix4x4PopulateFrom4x3(&mMine, _contentsStorage);
 		CC3Matrix4x4Multiply(&mRslt, &mMine, mtx);
-		CC3Matrix4x3PopulateFrom4x4(&_contents, &mRslt);
+		CC3Matrix4x3PopulateFrom4x4(_contentsStorage, &mRslt);
 	}
 }
 
 -(void) implLeftMultiplyBy: (CC3Matrix*) aMatrix {
-	[aMatrix leftMultiplyIntoCC3Matrix4x3: &_contents];
+	[aMatrix leftMultiplyIntoCC3Matrix4x3: _contentsStorage];
 }
 
 -(void) leftMultiplyIntoCC3Matrix3x3: (CC3Matrix3x3*) mtx {
 	if (_isIdentity) return;
 	CC3Matrix4x3 mRslt, mtx4;
 	CC3Matrix4x3PopulateFrom3x3(&mtx4, mtx);
-	CC3Matrix4x3Multiply(&mRslt, &_contents, &mtx4);
+	CC3Matrix4x3Multiply(&mRslt, _contentsStorage, &mtx4);
 	CC3Matrix3x3PopulateFrom4x3(mtx, &mRslt);
 }
 
 -(void) leftMultiplyByCC3Matrix3x3: (CC3Matrix3x3*) mtx {
 	if (_isIdentity) {
-		CC3Matrix4x3PopulateFrom3x3(&_contents, mtx);
+		CC3Matrix4x3PopulateFrom3x3(_contentsStorage, mtx);
 	} else {
 		CC3Matrix4x3 mRslt, mtx4;
 		CC3Matrix4x3PopulateFrom3x3(&mtx4, mtx);
-		CC3Matrix4x3Multiply(&mRslt, &mtx4, &_contents);
-		CC3Matrix4x3PopulateFrom4x3(&_contents, &mRslt);
+		CC3Matrix4x3Multiply(&mRslt, &mtx4, _contentsStorage);
+		CC3Matrix4x3PopulateFrom4x3(_contentsStorage, &mRslt);
 	}
 }
 
 -(void) leftMultiplyIntoCC3Matrix4x3: (CC3Matrix4x3*) mtx {
 	if (_isIdentity) return;
 	CC3Matrix4x3 mRslt;
-	CC3Matrix4x3Multiply(&mRslt, &_contents, mtx);
+	CC3Matrix4x3Multiply(&mRslt, _contentsStorage, mtx);
 	CC3Matrix4x3PopulateFrom4x3(mtx, &mRslt);
 }
 
 -(void) leftMultiplyByCC3Matrix4x3: (CC3Matrix4x3*) mtx {
 	if (_isIdentity) {
-		CC3Matrix4x3PopulateFrom4x3(&_contents, mtx);
+		CC3Matrix4x3PopulateFrom4x3(_contentsStorage, mtx);
 	} else {
 		CC3Matrix4x3 mRslt;
-		CC3Matrix4x3Multiply(&mRslt, mtx, &_contents);
-		CC3Matrix4x3PopulateFrom4x3(&_contents, &mRslt);
+		CC3Matrix4x3Multiply(&mRslt, mtx, _contentsStorage);
+		CC3Matrix4x3PopulateFrom4x3(_contentsStorage, &mRslt);
 	}
 }
 
 -(void) leftMultiplyIntoCC3Matrix4x4: (CC3Matrix4x4*) mtx {
 	if (_isIdentity) return;
 	CC3Matrix4x4 mRslt, mMine;
-	CC3Matrix4x4PopulateFrom4x3(&mMine, &_contents);
+	CC3Matrix4x4PopulateFrom4x3(&mMine, _contentsStorage);
 	CC3Matrix4x4Multiply(&mRslt, &mMine, mtx);
 	CC3Matrix4x4PopulateFrom4x4(mtx, &mRslt);
 }
 
 -(void) leftMultiplyByCC3Matrix4x4: (CC3Matrix4x4*) mtx {
 	if (_isIdentity) {
-		CC3Matrix4x3PopulateFrom4x4(&_contents, mtx);
+		CC3Matrix4x3PopulateFrom4x4(_contentsStorage, mtx);
 	} else {
 		CC3Matrix4x4 mRslt, mMine;
-		CC3Matrix4x4PopulateFrom4x3(&mMine, &_contents);
+		CC3Matrix4x4PopulateFrom4x3(&mMine, _contentsStorage);
 		CC3Matrix4x4Multiply(&mRslt, mtx, &mMine);
-		CC3Matrix4x3PopulateFrom4x4(&_contents, &mRslt);
+		CC3Matrix4x3PopulateFrom4x4(_contentsStorage, &mRslt);
 	}
 }
 
@@ -298,32 +326,32 @@
 // Short-circuit if this is an identity matrix
 -(CC3Vector) transformLocation: (CC3Vector) v {
 	if (_isIdentity) return v;
-	return CC3Matrix4x3TransformLocation(&_contents, v);
+	return CC3Matrix4x3TransformLocation(_contentsStorage, v);
 }
 
 // Short-circuit if this is an identity matrix
 -(CC3Vector) transformDirection: (CC3Vector) v {
 	if (_isIdentity) return v;
-	return CC3Matrix4x3TransformDirection(&_contents, v);
+	return CC3Matrix4x3TransformDirection(_contentsStorage, v);
 }
 
 // Short-circuit if this is an identity matrix
 -(CC3Vector4) transformHomogeneousVector: (CC3Vector4) aVector {
 	if (_isIdentity) return aVector;
-	return CC3Matrix4x3TransformCC3Vector4(&_contents, aVector);
+	return CC3Matrix4x3TransformCC3Vector4(_contentsStorage, aVector);
 }
 
 // Short-circuit if this is an identity matrix
--(void) transpose { if ( !_isIdentity ) CC3Matrix4x3Transpose(&_contents); }
+-(void) transpose { if ( !_isIdentity ) CC3Matrix4x3Transpose(_contentsStorage); }
 
 // Short-circuit if this is an identity matrix
 -(BOOL) invertAdjoint {
 	if (_isIdentity) return YES;
-	return CC3Matrix4x3InvertAdjoint(&_contents);
+	return CC3Matrix4x3InvertAdjoint(_contentsStorage);
 }
 
 // Short-circuit if this is an identity matrix
--(void) invertRigid { if ( !_isIdentity ) CC3Matrix4x3InvertRigid(&_contents); }
+-(void) invertRigid { if ( !_isIdentity ) CC3Matrix4x3InvertRigid(_contentsStorage); }
 
 @end
 
@@ -33,7 +33,7 @@
 #import "CC3VertexArrays.h"
 #import "CC3Material.h"
 
-@class CC3FaceArray;
+@class CC3FaceArray, CC3MeshFaceTree;
 
 /**
  * This enum defines the components of a bitwise-OR of flags enumerating the types of vertex
@@ -284,8 +284,10 @@ static inline CC3MeshIntersection* CC3NearestMeshIntersection(CC3MeshIntersectio
 	CC3VertexPointSizes* _vertexPointSizes;
 	CC3VertexIndices* _vertexIndices;
 	CC3FaceArray* _faces;
+	CC3MeshFaceTree* _faceTree;
 	GLfloat _capacityExpansionFactor;
 	BOOL _shouldInterleaveVertices : 1;
+	BOOL _shouldUseFaceTree : 1;
 }
 
 
@@ -1607,6 +1609,10 @@ static inline CC3MeshIntersection* CC3NearestMeshIntersection(CC3MeshIntersectio
  * this might mean the mesh is located behind the ray startLocation, or it might mean the ray starts
  * inside the mesh. Again,in most cases, you will be interested only in intersections that occur in
  * the direction the ray is pointing, and can ususally set this parameter to NO.
+ *
+ * If the shouldUseFaceTree property is set to YES, the faces are searched using the faceTree,
+ * which skips the faces in any branch of the tree that the ray misses, and visits the branches
+ * that the ray enters first before those further along the ray.
  */
 -(GLuint) findFirst: (GLuint) maxHitCount
 	  intersections: (CC3MeshIntersection*) intersections
@@ -1614,6 +1620,120 @@ static inline CC3MeshIntersection* CC3NearestMeshIntersection(CC3MeshIntersectio
 	acceptBackFaces: (BOOL) acceptBackFaces
 	acceptBehindRay: (BOOL) acceptBehind;
 
+/**
+ * Finds the intersection of the specified ray and this mesh that is closest to the startLocation
+ * of the ray, populates the specified intersection with information about it, and returns YES.
+ * If the ray does not intersect this mesh, returns NO, and the contents of the specified
+ * intersection are undefined.
+ *
+ * The location and distance components of the intersection are specified in the local coordinate
+ * system of this mesh. The acceptBackFaces and acceptBehind parameters have the same meaning as in
+ * the findFirst:intersections:ofLocalRay:acceptBackFaces:acceptBehindRay: method.
+ *
+ * Unlike the findFirst:intersections:ofLocalRay:acceptBackFaces:acceptBehindRay: method, which
+ * returns as soon as the requested number of intersections have been found, this method must
+ * consider every face that the ray could intersect, in order to determine the closest one.
+ *
+ * If the shouldUseFaceTree property is set to YES, the faces are searched using the faceTree,
+ * and any branch of the tree that the ray misses, or that the ray enters beyond the closest
+ * intersection found so far, is skipped. For a large mesh, only a small fraction of its faces
+ * are typically tested.
+ */
+-(BOOL) findNearestIntersection: (CC3MeshIntersection*) intersection
+					 ofLocalRay: (CC3Ray) aRay
+				acceptBackFaces: (BOOL) acceptBackFaces
+				acceptBehindRay: (BOOL) acceptBehind;
+
+/**
+ * Populates the specified array with the indices of the faces of this mesh that intersect the
+ * specified sphere, up to the specified maximum number of faces, and returns the number of face
+ * indices that were populated. The sphere is specified in the local coordinate system of this mesh.
+ *
+ * A face intersects the sphere if any part of the face, including its edges and corners, lies
+ * within the sphere. The face indices are not sorted in any way.
+ *
+ * To use this method, allocate an array of GLuints, pass a reference to it in the faceIndices
+ * parameter, and indicate the size of that array in the maxFaceCount parameter. The search ends
+ * as soon as the indicated number of faces have been found.
+ *
+ * If the shouldUseFaceTree property is set to YES, the faces are searched using the faceTree,
+ * and the faces in any branch of the tree whose box lies outside the sphere are skipped.
+ */
+-(GLuint) findFirst: (GLuint) maxFaceCount
+		faceIndices: (GLuint*) faceIndices
+intersectingLocalSphere: (CC3Sphere) aSphere;
+
+/**
+ * Populates the specified array with the indices of the faces of this mesh that overlap the
+ * specified box, up to the specified maximum number of faces, and returns the number of face
+ * indices that were populated. The box is specified in the local coordinate system of this mesh.
+ *
+ * A face overlaps the box if any part of the face, including its edges and corners, lies within
+ * the box. A face that passes through the box overlaps it, even if none of its corners lie
+ * within the box. The face indices are not sorted in any way.
+ *
+ * To use this method, allocate an array of GLuints, pass a reference to it in the faceIndices
+ * parameter, and indicate the size of that array in the maxFaceCount parameter. The search ends
+ * as soon as the indicated number of faces have been found.
+ *
+ * If the shouldUseFaceTree property is set to YES, the faces are searched using the faceTree,
+ * and the faces in any branch of the tree whose box does not overlap the specified box are skipped.
+ */
+-(GLuint) findFirst: (GLuint) maxFaceCount
+		faceIndices: (GLuint*) faceIndices
+  intersectingLocalBox: (CC3Box) aBox;
+
+/**
+ * A bounding volume hierarchy over the faces of this mesh, used to accelerate the methods of this
+ * mesh that search its faces for intersections with a ray, a sphere or a box.
+ *
+ * The tree is built lazily on the first access of this property, and is rebuilt automatically on
+ * the next access after the vertex locations or vertex indices of this mesh have been changed.
+ * See the markFaceTreeDirty method for the changes that are detected. Access to this property is
+ * synchronized, so that if the mesh is punctured by several threads at once, as can happen when the
+ * shouldUpdateConcurrently property of the CC3NodeUpdatingVisitor is set to YES, the tree is built
+ * only once. The vertex content of the mesh must not be changed while it is being searched.
+ *
+ * Building the tree takes time roughly proportional to the number of faces in this mesh, and
+ * the tree holds a copy of the vertex locations of each face. The buildTime and memoryUsed
+ * properties of the tree report these costs, and are logged each time the tree is built.
+ *
+ * The tree is expressed in the local coordinate system of this mesh, and is shared by all nodes
+ * that use this mesh. The tree is not copied when this mesh is copied. A copy of this mesh will
+ * build its own tree, if and when it needs one.
+ *
+ * Because the tree is built from the vertex locations held by this mesh, it does not reflect the
+ * deformation of a mesh that is skinned to a skeleton.
+ */
+@property(nonatomic, readonly) CC3MeshFaceTree* faceTree;
+
+/**
+ * Indicates whether the methods of this mesh that search its faces for intersections with a
+ * ray, a sphere or a box should use the faceTree to skip over faces that cannot intersect.
+ *
+ * Meshes with fewer than 64 faces are searched by testing each face in turn, regardless of the
+ * value of this property, because the cost of building and traversing the tree would outweigh
+ * the benefit of using it for so few faces.
+ *
+ * Setting this property to NO releases any faceTree that has already been built.
+ *
+ * The initial value of this property is YES.
+ */
+@property(nonatomic, assign) BOOL shouldUseFaceTree;
+
+/**
+ * Marks the faceTree as dirty, so that it will be rebuilt on its next access.
+ *
+ * Changes made to the vertex locations through this mesh, or through its vertexLocations array,
+ * are detected automatically. So are changes to the vertex indices made through this mesh, and
+ * replacement of the vertexLocations or vertexIndices arrays. Updating the GL buffers of the
+ * vertex locations or vertex indices also invokes this method.
+ *
+ * You need only invoke this method if you change the vertex locations or indices by writing to
+ * the underlying vertex content directly, and do not subsequently update the GL buffers.
+ */
+-(void) markFaceTreeDirty;
+
 
 #pragma mark Buffering content to GL engine
 
@@ -2043,6 +2163,120 @@ static inline CC3MeshIntersection* CC3NearestMeshIntersection(CC3MeshIntersectio
 -(void) movePivotToCenterOfGeometry __deprecated;
 
 
+#pragma mark Levels of detail
+
+/**
+ * Returns a new mesh that draws a simplified version of this mesh, using approximately the
+ * specified fraction of the triangles of this mesh. See the notes of the
+ * meshSimplifiedToTriangleCount:withSectionStarts:andSectionCounts:sectionCount: method
+ * for more information about how the mesh is simplified.
+ *
+ * Returns nil if this mesh has no vertex locations, or no faces.
+ */
+-(CC3Mesh*) meshSimplifiedToTriangleRatio: (GLfloat) ratio;
+
+/**
+ * Returns a new mesh that draws a simplified version of this mesh, using approximately the
+ * specified number of triangles.
+ *
+ * The mesh is simplified by repeatedly collapsing an edge of the mesh, moving one vertex of the
+ * edge onto the other, choosing the collapses that least change the shape of the surface, and the
+ * normals and first two sets of texture coordinates of the vertices. Because vertices are only
+ * removed, and never moved or created, the returned mesh shares the vertex arrays of this mesh,
+ * and only has its own vertexIndices, which draw the simplified triangles using GL_TRIANGLES.
+ * The returned mesh adds no vertex content to memory, or to GL buffers.
+ *
+ * Vertices that share a location with another vertex, such as along a texture or normal seam,
+ * are kept, so that the seam does not open up. Vertices on an open edge of the mesh only move
+ * along that edge, and vertices only collapse onto vertices that are influenced by the same bones.
+ * As a result, the returned mesh may have more triangles than the specified number.
+ *
+ * If this mesh is drawn in sections, such as the skin sections of a skinned mesh, the sections
+ * can be specified by the sectionStarts and sectionCounts arrays, each of which must contain
+ * sectionCount elements. Each section starts at the vertex index in the sectionStarts array and
+ * draws the number of vertex indices in the sectionCounts array. Vertices are not collapsed across
+ * sections, and vertices used by more than one section are kept. On return, the two arrays will
+ * contain the range of each section within the vertexIndices of the returned mesh. The sections
+ * must not overlap, and can only be specified if the drawingMode of this mesh is GL_TRIANGLES.
+ * If this mesh is not drawn in sections, the sectionStarts and sectionCounts arrays can be NULL,
+ * and the sectionCount argument zero.
+ *
+ * The vertex content of this mesh must be available in application memory, so this method must
+ * be invoked before the releaseRedundantContent method is invoked on this mesh.
+ *
+ * Returns nil if this mesh has no vertex locations, or no faces.
+ */
+-(CC3Mesh*) meshSimplifiedToTriangleCount: (GLuint) triangleCount
+						withSectionStarts: (GLuint*) sectionStarts
+						 andSectionCounts: (GLuint*) sectionCounts
+							 sectionCount: (GLuint) sectionCount;
+
+/**
+ * Returns an array of lodCount new meshes, each a simplified version of this mesh, using
+ * approximately the fraction of the triangles of this mesh that is specified in the
+ * corresponding element of the ratios array, which must contain lodCount elements.
+ *
+ * The ratios should be specified in decreasing order, so that the returned meshes form a
+ * chain of progressively coarser levels of detail. Each returned mesh is simplified from
+ * this mesh, and shares the vertex arrays of this mesh.
+ *
+ * See the notes of the meshSimplifiedToTriangleCount:withSectionStarts:andSectionCounts:sectionCount:
+ * method for more information about how each mesh is simplified.
+ *
+ * Returns nil if this mesh has no vertex locations, or no faces.
+ */
+-(NSArray*) levelsOfDetailWithTriangleRatios: (GLfloat*) ratios count: (GLuint) lodCount;
+
+
+#pragma mark Vertex quantization
+
+/**
+ * Converts the vertex content of this mesh to compact formats, reducing the memory, and the
+ * GL memory bandwidth, used by the mesh to typically one half or one third of that used by
+ * vertex content held in GL_FLOAT format.
+ *
+ * This is a convenience method that invokes the quantizeVertexContentWithDirectionType:
+ * method with GL_SHORT as the argument.
+ */
+-(void) quantizeVertexContent;
+
+/**
+ * Converts the vertex content of this mesh to compact formats, reducing the memory, and the
+ * GL memory bandwidth, used by the mesh. The vertex content is converted as follows:
+ *   - Vertex locations are held as four normalized GL_UNSIGNED_SHORT components, covering the
+ *     bounding box of the mesh. The quantizationOffset and quantizationScale properties of the
+ *     vertexLocations map the content back to locations. The fourth component pads each location
+ *     to eight bytes, to keep the content that follows it aligned.
+ *   - Vertex normals, tangents and bitangents are held in octahedral form, as two normalized
+ *     components of the specified directionType, which must be either GL_SHORT or GL_BYTE.
+ *     GL_BYTE halves the memory again, but limits the precision of each direction to about
+ *     one degree. Use GL_BYTE when the mesh has both normals and tangents, so that the two
+ *     together keep the content that follows them aligned.
+ *   - Texture coordinates are held as GL_HALF_FLOAT_OES values.
+ *   - Other vertex content is unchanged.
+ *
+ * The vertex content accessor methods of this mesh, such as vertexLocationAt: and vertexNormalAt:,
+ * and the default shaders, decode the converted content automatically. Custom shaders must decode
+ * the vertex locations using the kCC3SemanticVertexLocationOffset and kCC3SemanticVertexLocationScale
+ * semantics, and the normals and tangents using the kCC3SemanticIsVertexNormalOctahedral and
+ * kCC3SemanticIsVertexTangentOctahedral semantics. Half-float texture coordinates require GL
+ * support for half-float vertex content (the OES_vertex_half_float extension under OpenGL ES 2).
+ *
+ * Vertex locations are quantized to 1/65535 of the size of the mesh along each axis. Vertex content
+ * that is later changed must remain within the bounding box of the mesh at the time this method
+ * was invoked, so this method should not be used with meshes whose vertices are updated dynamically,
+ * such as mesh particles. Normals and tangents are held as unit directions.
+ *
+ * The vertex content of this mesh must be available in application memory, so this method must
+ * be invoked before the releaseRedundantContent method is invoked on this mesh. If this mesh has
+ * already been loaded into GL buffers, the buffers are recreated from the converted content.
+ *
+ * This method has no effect under OpenGL ES 1, which does not support shaders that can decode the
+ * converted content.
+ */
+-(void) quantizeVertexContentWithDirectionType: (GLenum) directionType;
+
+
 #pragma mark CCRGBAProtocol and CCBlendProtocol support
 
 /**
@@ -3017,3 +3251,153 @@ static inline CC3MeshIntersection* CC3NearestMeshIntersection(CC3MeshIntersectio
 
 @end
 
+
+#pragma mark -
+#pragma mark CC3MeshFaceTree
+
+/**
+ * A node in a CC3MeshFaceTree. Each node is either a leaf, which holds one or more faces, or a
+ * branch, which has two child nodes, and whose bounds enclose the bounds of both children.
+ *
+ * The nodes of the tree are held in depth-first order. The first child of a branch immediately
+ * follows the branch, so only the location of the second child needs to be held.
+ */
+typedef struct {
+	CC3Box bounds;			/**< The local bounds of the faces within this node. */
+	GLuint offset;			/**< For a leaf, the position of its first face. For a branch, the index of its second child. */
+	GLuint faceCount;		/**< The number of faces held by a leaf, or zero for a branch. */
+} CC3MeshFaceTreeNode;
+
+/**
+ * CC3MeshFaceTree is a bounding volume hierarchy over the faces of a mesh, which allows the faces
+ * that may intersect a ray, a sphere or a box to be found without testing every face of the mesh.
+ *
+ * Each leaf of the tree holds a small number of faces, and each branch holds the box enclosing the
+ * faces beneath it. A search tests the box of each branch it reaches, and skips the entire branch
+ * if the box cannot intersect. A search for the intersection of a ray that is closest to the start
+ * of the ray visits the branches in the order that the ray enters them, and skips any branch that
+ * the ray enters beyond the closest intersection found so far.
+ *
+ * The tree is built top-down, splitting the faces of each node in two using the surface area
+ * heuristic, which chooses, from a number of candidate planes along each axis, the split that
+ * minimizes the expected cost of testing a ray against the two resulting children. The faces
+ * are not split further once splitting would not reduce that cost.
+ *
+ * To keep searches cache-friendly, the nodes are held in a single compact array, in depth-first
+ * order, and the tree holds a copy of the vertex locations of each face, ordered so that the faces
+ * of each leaf are adjacent in memory. Searching a leaf therefore does not need to retrieve any
+ * content from the mesh.
+ *
+ * A CC3MeshFaceTree is created and built automatically by the faceTree property of a CC3Mesh, and
+ * is rebuilt automatically when the vertex locations or vertex indices of that mesh change.
+ * Usually, the application never needs to create or build a CC3MeshFaceTree directly.
+ */
+@interface CC3MeshFaceTree : NSObject {
+	CC3MeshFaceTreeNode* _nodes;
+	GLuint* _faceIndices;
+	CC3Face* _faces;
+	GLuint _nodeCount;
+	GLuint _faceCount;
+	GLuint _depth;
+	GLuint _vertexLocationsVersion;
+	NSTimeInterval _buildTime;
+	BOOL _isDirty : 1;
+}
+
+/** The number of faces in this tree. */
+@property(nonatomic, readonly) GLuint faceCount;
+
+/** The number of nodes, including both branches and leaves, in this tree. */
+@property(nonatomic, readonly) GLuint nodeCount;
+
+/** The number of levels in this tree. A tree containing only a single leaf has a depth of one. */
+@property(nonatomic, readonly) GLuint depth;
+
+/** The number of bytes of memory allocated to hold the nodes and faces of this tree. */
+@property(nonatomic, readonly) size_t memoryUsed;
+
+/** The time, in seconds, taken to build this tree the last time it was populated from a mesh. */
+@property(nonatomic, readonly) NSTimeInterval buildTime;
+
+/**
+ * Indicates whether this tree has been marked as dirty, using the markDirty method,
+ * since it was last populated from a mesh.
+ */
+@property(nonatomic, readonly) BOOL isDirty;
+
+/** Marks this tree as dirty, so that it will be rebuilt the next time it is retrieved from its mesh. */
+-(void) markDirty;
+
+/**
+ * Returns whether this tree accurately reflects the faces of the specified mesh.
+ *
+ * Returns NO if this tree has been marked dirty, if the number of faces in the mesh has changed,
+ * or if the vertex locations of the mesh have changed, since this tree was populated from it.
+ */
+-(BOOL) isCurrentForMesh: (CC3Mesh*) aMesh;
+
+/**
+ * Builds this tree from the faces of the specified mesh, replacing any previous content,
+ * and records the time taken to do so in the buildTime property.
+ */
+-(void) populateFromMesh: (CC3Mesh*) aMesh;
+
+
+#pragma mark Searching the tree
+
+/**
+ * Populates the specified array with information about the intersections of the specified ray
+ * and the faces in this tree, up to the specified maximum number of intersections, and returns
+ * the number of intersections found.
+ *
+ * The ray is specified in the local coordinate system of the mesh. The parameters have the same
+ * meaning as in the findFirst:intersections:ofLocalRay:acceptBackFaces:acceptBehindRay: method
+ * of CC3Mesh. Branches of the tree are visited in the order in which the ray enters them.
+ */
+-(GLuint) findFirst: (GLuint) maxHitCount
+	  intersections: (CC3MeshIntersection*) intersections
+		 ofLocalRay: (CC3Ray) aRay
+	acceptBackFaces: (BOOL) acceptBackFaces
+	acceptBehindRay: (BOOL) acceptBehind;
+
+/**
+ * Finds the intersection of the specified ray and the faces in this tree that is closest to the
+ * startLocation of the ray, populates the specified intersection with information about it, and
+ * returns YES. If the ray does not intersect any face, returns NO, and the contents of the
+ * specified intersection are undefined.
+ *
+ * The ray is specified in the local coordinate system of the mesh. The parameters have the same
+ * meaning as in the findNearestIntersection:ofLocalRay:acceptBackFaces:acceptBehindRay: method of
+ * CC3Mesh. Branches that the ray enters beyond the closest intersection found so far are skipped.
+ */
+-(BOOL) findNearestIntersection: (CC3MeshIntersection*) intersection
+					 ofLocalRay: (CC3Ray) aRay
+				acceptBackFaces: (BOOL) acceptBackFaces
+				acceptBehindRay: (BOOL) acceptBehind;
+
+/**
+ * Populates the specified array with the indices of the faces in this tree that intersect the
+ * specified sphere, up to the specified maximum number of faces, and returns the number of face
+ * indices that were populated. The sphere is specified in the local coordinate system of the mesh.
+ */
+-(GLuint) findFirst: (GLuint) maxFaceCount
+		faceIndices: (GLuint*) faceIndices
+ intersectingSphere: (CC3Sphere) aSphere;
+
+/**
+ * Populates the specified array with the indices of the faces in this tree that overlap the
+ * specified box, up to the specified maximum number of faces, and returns the number of face
+ * indices that were populated. The box is specified in the local coordinate system of the mesh.
+ */
+-(GLuint) findFirst: (GLuint) maxFaceCount
+		faceIndices: (GLuint*) faceIndices
+	intersectingBox: (CC3Box) aBox;
+
+
+#pragma mark Allocation and initialization
+
+/** Allocates and initializes an autoreleased empty instance. */
++(id) tree;
+
+@end
+
@@ -85,8 +85,364 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 }
 
 
+#pragma mark Mesh simplification
+
+/** The number of vertex attributes compared when simplifying: a normal and two texture coordinates. */
+#define kCC3SimplifyAttributeCount	7
+
+/** The content of a vertex that is considered when simplifying a mesh. */
+typedef struct {
+	CC3Vector location;								/**< The vertex location. */
+	GLfloat attributes[kCC3SimplifyAttributeCount];	/**< The normal and texture coordinates of the vertex. */
+	unsigned long long boneMask;					/**< The bones with a non-zero weight for the vertex. */
+	GLint section;									/**< The section of the triangles using the vertex, or -1. */
+	BOOL isLocked;									/**< Whether the vertex must be kept. */
+	BOOL isBorder;									/**< Whether the vertex lies on an open edge of the mesh. */
+} CC3SimplifyVertex;
+
+/** A vertex location, and the index of the vertex, for sorting vertices by location. */
+typedef struct {
+	CC3Vector location;
+	GLuint index;
+} CC3SimplifyLocation;
+
+/** A symmetric 4x4 quadric error matrix, stored as its upper triangle. */
+typedef struct {
+	double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+} CC3Quadric;
+
+/** An edge of a triangle, keyed by its two welded vertex indices, lowest first. */
+typedef struct {
+	unsigned long long key;
+	GLuint v0;
+	GLuint v1;
+} CC3SimplifyEdge;
+
+/** The collapse of one vertex onto another, and its cost. */
+typedef struct {
+	GLuint from;
+	GLuint to;
+	double cost;
+} CC3EdgeCollapse;
+
+static void CC3QuadricAddPlane(CC3Quadric* q, double a, double b, double c, double d, double w) {
+	q->a2 += w * a * a;  q->ab += w * a * b;  q->ac += w * a * c;  q->ad += w * a * d;
+	q->b2 += w * b * b;  q->bc += w * b * c;  q->bd += w * b * d;
+	q->c2 += w * c * c;  q->cd += w * c * d;
+	q->d2 += w * d * d;
+}
+
+static void CC3QuadricAdd(CC3Quadric* q, const CC3Quadric* other) {
+	q->a2 += other->a2;  q->ab += other->ab;  q->ac += other->ac;  q->ad += other->ad;
+	q->b2 += other->b2;  q->bc += other->bc;  q->bd += other->bd;
+	q->c2 += other->c2;  q->cd += other->cd;
+	q->d2 += other->d2;
+}
+
+/** Returns the sum of the squared distances of the location from the planes of the quadric. */
+static double CC3QuadricError(const CC3Quadric* q, CC3Vector p) {
+	double x = p.x, y = p.y, z = p.z;
+	return (q->a2 * x * x + 2.0 * q->ab * x * y + 2.0 * q->ac * x * z + 2.0 * q->ad * x +
+			q->b2 * y * y + 2.0 * q->bc * y * z + 2.0 * q->bd * y +
+			q->c2 * z * z + 2.0 * q->cd * z + q->d2);
+}
+
+/** Returns the unnormalized normal of the triangle, in double precision. */
+static void CC3SimplifyTriangleNormal(CC3Vector p0, CC3Vector p1, CC3Vector p2, double* n) {
+	double e1x = p1.x - p0.x, e1y = p1.y - p0.y, e1z = p1.z - p0.z;
+	double e2x = p2.x - p0.x, e2y = p2.y - p0.y, e2z = p2.z - p0.z;
+	n[0] = e1y * e2z - e1z * e2y;
+	n[1] = e1z * e2x - e1x * e2z;
+	n[2] = e1x * e2y - e1y * e2x;
+}
+
+static int CC3SimplifyCompareEdges(const void* a, const void* b) {
+	unsigned long long ka = ((const CC3SimplifyEdge*)a)->key, kb = ((const CC3SimplifyEdge*)b)->key;
+	return (ka < kb) ? -1 : ((ka > kb) ? 1 : 0);
+}
+
+static int CC3SimplifyCompareCollapses(const void* a, const void* b) {
+	double ca = ((const CC3EdgeCollapse*)a)->cost, cb = ((const CC3EdgeCollapse*)b)->cost;
+	return (ca < cb) ? -1 : ((ca > cb) ? 1 : 0);
+}
+
+static int CC3SimplifyCompareLocations(const void* a, const void* b) {
+	const CC3SimplifyLocation* la = a;
+	const CC3SimplifyLocation* lb = b;
+	if (la->location.x != lb->location.x) return (la->location.x < lb->location.x) ? -1 : 1;
+	if (la->location.y != lb->location.y) return (la->location.y < lb->location.y) ? -1 : 1;
+	if (la->location.z != lb->location.z) return (la->location.z < lb->location.z) ? -1 : 1;
+	return (la->index < lb->index) ? -1 : ((la->index > lb->index) ? 1 : 0);
+}
+
+/**
+ * Returns whether moving the specified vertex onto another would flip, or nearly flip, any of the
+ * triangles using the vertex that are not removed by the collapse.
+ */
+static BOOL CC3SimplifyCollapseFlips(GLuint from, GLuint to, const GLuint* indices,
+									 const GLuint* vtxTris, GLuint vtxTriStart, GLuint vtxTriEnd,
+									 const CC3SimplifyVertex* vertices) {
+	for (GLuint i = vtxTriStart; i < vtxTriEnd; i++) {
+		const GLuint* tri = &indices[vtxTris[i] * 3];
+		if (tri[0] == to || tri[1] == to || tri[2] == to) continue;
+
+		CC3Vector p[3], q[3];
+		for (GLuint c = 0; c < 3; c++) {
+			p[c] = vertices[tri[c]].location;
+			q[c] = (tri[c] == from) ? vertices[to].location : p[c];
+		}
+		double n0[3], n1[3];
+		CC3SimplifyTriangleNormal(p[0], p[1], p[2], n0);
+		CC3SimplifyTriangleNormal(q[0], q[1], q[2], n1);
+		double dot = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+		double len0 = sqrt(n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2]);
+		double len1 = sqrt(n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]);
+		if (dot <= 0.25 * len0 * len1) return YES;
+	}
+	return NO;
+}
+
+/**
+ * Simplifies a triangle list by repeatedly collapsing the vertex of an edge onto the other vertex
+ * of the edge, choosing the collapses that least move the surface, using the quadric error metric
+ * of Garland and Heckbert, plus the change in the normal and texture coordinates of the vertex.
+ * Since vertices are only removed, and never moved, the simplified triangles use the vertex
+ * content of the original mesh.
+ *
+ * Vertices that share their location with another vertex, as along texture seams, and vertices
+ * that are used by triangles of more than one section, are kept. A vertex on an open edge of the
+ * mesh may only collapse along that edge, and a vertex may only collapse onto a vertex of the same
+ * section that is influenced by the same bones.
+ *
+ * The triCount triangles in indices are simplified in place, toward targetTriCount triangles, and
+ * the number of remaining triangles is returned. The remaining triangles keep their original order,
+ * and the entries of triIDs move with them. On entry, each entry of triIDs holds the section of its
+ * triangle, or triIDs may be NULL if the mesh has a single section. The location, attributes and
+ * boneMask fields of the vertices must be set on entry. The locations are rescaled in place, and the
+ * other fields are used as workspace.
+ */
+static GLuint CC3SimplifyTriangles(GLuint* indices, GLuint* triIDs, GLuint triCount, GLuint targetTriCount,
+								   CC3SimplifyVertex* vertices, GLuint vtxCount) {
+	if (triCount <= targetTriCount || vtxCount == 0) return triCount;
+
+	CC3Quadric* quadrics = calloc(vtxCount, sizeof(CC3Quadric));
+	double* areas = calloc(vtxCount, sizeof(double));
+	GLuint* welds = calloc(vtxCount, sizeof(GLuint));
+	GLuint* remap = calloc(vtxCount, sizeof(GLuint));
+	GLuint* vtxTriStarts = calloc(vtxCount + 1, sizeof(GLuint));
+	GLuint* vtxTris = calloc(triCount * 3, sizeof(GLuint));
+	BOOL* isPassLocked = calloc(vtxCount, sizeof(BOOL));
+	CC3SimplifyEdge* edges = calloc(triCount * 3, sizeof(CC3SimplifyEdge));
+	CC3EdgeCollapse* collapses = calloc(triCount * 6, sizeof(CC3EdgeCollapse));
+	CC3SimplifyLocation* locations = calloc(vtxCount, sizeof(CC3SimplifyLocation));
+	GLuint i, j, c;
+
+	if ( !(quadrics && areas && welds && remap && vtxTriStarts && vtxTris && isPassLocked && edges && collapses && locations) ) {
+		LogError(@"Could not allocate memory to simplify %u triangles", triCount);
+		goto cleanup;
+	}
+
+	// Find the section of each vertex. Vertices used by several sections are kept.
+	for (i = 0; i < vtxCount; i++) {
+		vertices[i].section = -1;
+		vertices[i].isLocked = NO;
+	}
+	for (i = 0; i < triCount * 3; i++) {
+		CC3SimplifyVertex* v = &vertices[indices[i]];
+		GLint section = triIDs ? (GLint)triIDs[i / 3] : 0;
+		if (v->section >= 0 && v->section != section) v->isLocked = YES;
+		v->section = section;
+	}
+
+	// Normalize the locations into a unit cube, so that the errors do not depend on the mesh scale
+	CC3Vector minLoc = vertices[0].location, maxLoc = vertices[0].location;
+	for (i = 1; i < vtxCount; i++) {
+		minLoc = CC3VectorMinimize(minLoc, vertices[i].location);
+		maxLoc = CC3VectorMaximize(maxLoc, vertices[i].location);
+	}
+	CC3Vector extent = CC3VectorDifference(maxLoc, minLoc);
+	GLfloat scale = MAX(MAX(extent.x, extent.y), extent.z);
+	scale = (scale > 0.0f) ? (1.0f / scale) : 1.0f;
+	for (i = 0; i < vtxCount; i++) {
+		locations[i].location = vertices[i].location;
+		locations[i].index = i;
+		vertices[i].location = CC3VectorScaleUniform(CC3VectorDifference(vertices[i].location, minLoc), scale);
+		remap[i] = i;
+	}
+
+	// Weld the vertices by location. Vertices that share a location, such as those along
+	// a texture seam, are kept, so that the seam does not open up.
+	qsort(locations, vtxCount, sizeof(CC3SimplifyLocation), CC3SimplifyCompareLocations);
+	for (i = 0; i < vtxCount; i = j) {
+		for (j = i + 1; j < vtxCount && CC3VectorsAreEqual(locations[j].location, locations[i].location); j++);
+		for (GLuint k = i; k < j; k++) {
+			welds[locations[k].index] = locations[i].index;
+			if (j - i > 1) vertices[locations[k].index].isLocked = YES;
+		}
+	}
+
+	// Each triangle adds its plane to its vertices, weighted by its area
+	for (i = 0; i < triCount; i++) {
+		const GLuint* tri = &indices[i * 3];
+		double n[3];
+		CC3SimplifyTriangleNormal(vertices[tri[0]].location, vertices[tri[1]].location, vertices[tri[2]].location, n);
+		double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (len <= 0.0) continue;
+
+		CC3Vector p0 = vertices[tri[0]].location;
+		double a = n[0] / len, b = n[1] / len, cc = n[2] / len;
+		double d = -(a * p0.x + b * p0.y + cc * p0.z);
+		for (c = 0; c < 3; c++) {
+			CC3QuadricAddPlane(&quadrics[tri[c]], a, b, cc, d, len * 0.5);
+			areas[tri[c]] += len * 0.5;
+		}
+	}
+
+	while (triCount > targetTriCount) {
+
+		// Find the triangles that use each vertex
+		memset(vtxTriStarts, 0, (vtxCount + 1) * sizeof(GLuint));
+		for (i = 0; i < triCount * 3; i++) vtxTriStarts[indices[i] + 1]++;
+		for (i = 0; i < vtxCount; i++) vtxTriStarts[i + 1] += vtxTriStarts[i];
+		for (i = 0; i < triCount * 3; i++) vtxTris[vtxTriStarts[indices[i]]++] = i / 3;
+		for (i = vtxCount; i > 0; i--) vtxTriStarts[i] = vtxTriStarts[i - 1];
+		vtxTriStarts[0] = 0;
+
+		// Gather the edges by welded vertices, to find the open edges of the mesh,
+		// which are those used by a single triangle
+		for (i = 0; i < triCount * 3; i++) {
+			GLuint v0 = indices[i];
+			GLuint v1 = indices[(i % 3 == 2) ? (i - 2) : (i + 1)];
+			GLuint w0 = welds[v0], w1 = welds[v1];
+			edges[i].key = (w0 < w1) ? (((unsigned long long)w0 << 32) | w1) : (((unsigned long long)w1 << 32) | w0);
+			edges[i].v0 = v0;
+			edges[i].v1 = v1;
+		}
+		qsort(edges, triCount * 3, sizeof(CC3SimplifyEdge), CC3SimplifyCompareEdges);
+
+		for (i = 0; i < vtxCount; i++) vertices[i].isBorder = NO;
+		for (i = 0; i < triCount * 3; i = j) {
+			for (j = i + 1; j < triCount * 3 && edges[j].key == edges[i].key; j++);
+			if (j - i == 1) {
+				vertices[edges[i].v0].isBorder = YES;
+				vertices[edges[i].v1].isBorder = YES;
+			} else if (j - i > 2) {
+				vertices[edges[i].v0].isLocked = YES;		// Non-manifold edge
+				vertices[edges[i].v1].isLocked = YES;
+			}
+		}
+
+		// Cost each permitted collapse of each edge, in both directions
+		GLuint collapseCount = 0;
+		for (i = 0; i < triCount * 3; i = j) {
+			for (j = i + 1; j < triCount * 3 && edges[j].key == edges[i].key; j++);
+			BOOL isBorderEdge = (j - i == 1);
+			for (c = 0; c < 2; c++) {
+				GLuint from = c ? edges[i].v1 : edges[i].v0;
+				GLuint to = c ? edges[i].v0 : edges[i].v1;
+				CC3SimplifyVertex* vf = &vertices[from];
+				CC3SimplifyVertex* vt = &vertices[to];
+				if (vf->isLocked || (vf->isBorder && !isBorderEdge)) continue;
+				if (vf->section != vt->section || vf->boneMask != vt->boneMask) continue;
+
+				CC3Quadric q = quadrics[from];
+				CC3QuadricAdd(&q, &quadrics[to]);
+				double attrErr = 0.0;
+				for (GLuint a = 0; a < kCC3SimplifyAttributeCount; a++) {
+					double diff = vf->attributes[a] - vt->attributes[a];
+					attrErr += diff * diff;
+				}
+				collapses[collapseCount].from = from;
+				collapses[collapseCount].to = to;
+				collapses[collapseCount].cost = CC3QuadricError(&q, vt->location) + attrErr * areas[from];
+				collapseCount++;
+			}
+		}
+		qsort(collapses, collapseCount, sizeof(CC3EdgeCollapse), CC3SimplifyCompareCollapses);
+
+		// Apply the cheapest collapses. The neighbours of a collapsed vertex do not move again in this pass.
+		GLuint removeCount = triCount - targetTriCount;
+		GLuint removedCount = 0, collapsedCount = 0;
+		memset(isPassLocked, 0, vtxCount * sizeof(BOOL));
+		for (i = 0; i < collapseCount && removedCount < removeCount; i++) {
+			GLuint from = collapses[i].from, to = collapses[i].to;
+			if (isPassLocked[from] || isPassLocked[to]) continue;
+			if (CC3SimplifyCollapseFlips(from, to, indices, vtxTris, vtxTriStarts[from], vtxTriStarts[from + 1], vertices)) continue;
+
+			for (j = vtxTriStarts[from]; j < vtxTriStarts[from + 1]; j++) {
+				const GLuint* tri = &indices[vtxTris[j] * 3];
+				if (tri[0] == to || tri[1] == to || tri[2] == to) removedCount++;
+				for (c = 0; c < 3; c++) isPassLocked[tri[c]] = YES;
+			}
+			remap[from] = to;
+			CC3QuadricAdd(&quadrics[to], &quadrics[from]);
+			areas[to] += areas[from];
+			collapsedCount++;
+		}
+		if ( !collapsedCount ) break;
+
+		// Move the collapsed vertices, and drop the triangles that have become degenerate
+		GLuint keptCount = 0;
+		for (i = 0; i < triCount; i++) {
+			GLuint v0 = remap[indices[i * 3]], v1 = remap[indices[i * 3 + 1]], v2 = remap[indices[i * 3 + 2]];
+			if (v0 == v1 || v1 == v2 || v2 == v0) continue;
+			indices[keptCount * 3] = v0;
+			indices[keptCount * 3 + 1] = v1;
+			indices[keptCount * 3 + 2] = v2;
+			if (triIDs) triIDs[keptCount] = triIDs[i];
+			keptCount++;
+		}
+		triCount = keptCount;
+	}
+
+cleanup:
+	free(quadrics);
+	free(areas);
+	free(welds);
+	free(remap);
+	free(vtxTriStarts);
+	free(vtxTris);
+	free(isPassLocked);
+	free(edges);
+	free(collapses);
+	free(locations);
+	return triCount;
+}
+
+
 #pragma mark CC3Mesh
 
+/** Meshes with fewer faces than this are searched face by face, even if shouldUseFaceTree is YES. */
+#define kCC3MeshFaceTreeMinimumFaceCount	64
+
+/**
+ * Tests whether the specified ray intersects the specified face, and populates the specified
+ * intersection with the details of the test. Returns whether the ray intersects the face, taking
+ * into consideration whether back faces, and intersections behind the ray, are acceptable.
+ */
+static BOOL CC3MeshIntersectionPopulate(CC3MeshIntersection* hit, CC3Face face, GLuint faceIdx,
+										CC3Ray aRay, BOOL acceptBackFaces, BOOL acceptBehind) {
+	hit->faceIndex = faceIdx;
+	hit->face = face;
+	hit->facePlane = CC3FacePlane(face);
+	
+	// Check if the ray is not parallel to the face, is approaching from the front,
+	// or is approaching from the back and that is okay.
+	GLfloat dirDotNorm = CC3VectorDot(aRay.direction, CC3PlaneNormal(hit->facePlane));
+	hit->wasBackFace = dirDotNorm > 0.0f;
+	if ( !(dirDotNorm < 0.0f || (hit->wasBackFace && acceptBackFaces)) ) return NO;
+	
+	// Find the point of intersection of the ray with the plane
+	// and check that it is not behind the start of the ray.
+	CC3Vector4 loc4 = CC3RayIntersectionWithPlane(aRay, hit->facePlane);
+	if ( !(acceptBehind || loc4.w >= 0.0f) ) return NO;
+	
+	hit->location = loc4.v;
+	hit->distance = loc4.w;
+	hit->barycentricLocation = CC3FaceBarycentricWeights(face, hit->location);
+	return CC3BarycentricWeightsAreInsideTriangle(hit->barycentricLocation);
+}
+
 @implementation CC3Mesh
 
 @synthesize faces=_faces, capacityExpansionFactor=_capacityExpansionFactor;
@@ -104,6 +460,7 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 	[_vertexPointSizes release];
 	[_vertexIndices release];
 	[_faces release];
+	[_faceTree release];
 	
 	[super dealloc];
 }
@@ -138,6 +495,7 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 	[_vertexLocations release];
 	_vertexLocations = [vtxLocs retain];
 	[_vertexLocations deriveNameFrom: self];
+	[self markFaceTreeDirty];
 }
 
 -(BOOL) hasVertexLocations { return (_vertexLocations != nil); }
@@ -239,6 +597,7 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 	[_vertexIndices release];
 	_vertexIndices = [vtxInd retain];
 	[_vertexIndices deriveNameFrom: self];
+	[self markFaceTreeDirty];
 }
 
 -(BOOL) hasVertexIndices { return (_vertexIndices != nil); }
@@ -847,6 +1206,7 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 
 -(void) setVertexIndex: (GLuint) vertexIndex at: (GLuint) index {
 	[_vertexIndices setIndex: vertexIndex at: index];
+	[self markFaceTreeDirty];
 }
 
 
@@ -921,40 +1281,105 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 
 -(CC3FaceNeighbours) faceNeighboursAt: (GLuint) faceIndex { return [self.faces neighboursAt: faceIndex]; }
 
+/** Returns whether searches of the faces of this mesh should use the face tree. */
+-(BOOL) shouldSearchFaceTree {
+	return _shouldUseFaceTree && self.faceCount >= kCC3MeshFaceTreeMinimumFaceCount;
+}
+
 -(GLuint) findFirst: (GLuint) maxHitCount
 	  intersections: (CC3MeshIntersection*) intersections
 		 ofLocalRay: (CC3Ray) aRay
 	acceptBackFaces: (BOOL) acceptBackFaces
 	acceptBehindRay: (BOOL) acceptBehind {
+	if (self.shouldSearchFaceTree)
+		return [self.faceTree findFirst: maxHitCount
+						  intersections: intersections
+							 ofLocalRay: aRay
+						acceptBackFaces: acceptBackFaces
+						acceptBehindRay: acceptBehind];
 	
 	GLuint hitIdx = 0;
 	GLuint faceCount = self.faceCount;
 	for (int faceIdx = 0; faceIdx < faceCount && hitIdx < maxHitCount; faceIdx++) {
-		CC3MeshIntersection* hit = &intersections[hitIdx];
-		hit->faceIndex = faceIdx;
-		hit->face = [self faceAt: faceIdx];
-		hit->facePlane = CC3FacePlane(hit->face);
-		
-		// Check if the ray is not parallel to the face, is approaching from the front,
-		// or is approaching from the back and that is okay.
-		GLfloat dirDotNorm = CC3VectorDot(aRay.direction, CC3PlaneNormal(hit->facePlane));
-		hit->wasBackFace = dirDotNorm > 0.0f;
-		if (dirDotNorm < 0.0f || (hit->wasBackFace && acceptBackFaces)) {
-			
-			// Find the point of intersection of the ray with the plane
-			// and check that it is not behind the start of the ray.
-			CC3Vector4 loc4 = CC3RayIntersectionWithPlane(aRay, hit->facePlane);
-			if (acceptBehind || loc4.w >= 0.0f) {
-				hit->location = loc4.v;
-				hit->distance = loc4.w;
-				hit->barycentricLocation = CC3FaceBarycentricWeights(hit->face, hit->location);
-				if ( CC3BarycentricWeightsAreInsideTriangle(hit->barycentricLocation) ) hitIdx++;
-			}
+		if ( CC3MeshIntersectionPopulate(&intersections[hitIdx], [self faceAt: faceIdx], faceIdx,
+										 aRay, acceptBackFaces, acceptBehind) ) hitIdx++;
+	}
+	return hitIdx;
+}
+
+-(BOOL) findNearestIntersection: (CC3MeshIntersection*) intersection
+					 ofLocalRay: (CC3Ray) aRay
+				acceptBackFaces: (BOOL) acceptBackFaces
+				acceptBehindRay: (BOOL) acceptBehind {
+	if (self.shouldSearchFaceTree)
+		return [self.faceTree findNearestIntersection: intersection
+										   ofLocalRay: aRay
+									  acceptBackFaces: acceptBackFaces
+									  acceptBehindRay: acceptBehind];
+	
+	BOOL wasHit = NO;
+	CC3MeshIntersection hit;
+	GLuint faceCount = self.faceCount;
+	for (GLuint faceIdx = 0; faceIdx < faceCount; faceIdx++) {
+		if ( CC3MeshIntersectionPopulate(&hit, [self faceAt: faceIdx], faceIdx,
+										 aRay, acceptBackFaces, acceptBehind) &&
+			( !wasHit || hit.distance < intersection->distance) ) {
+			*intersection = hit;
+			wasHit = YES;
 		}
 	}
+	return wasHit;
+}
+
+-(GLuint) findFirst: (GLuint) maxFaceCount
+		faceIndices: (GLuint*) faceIndices
+intersectingLocalSphere: (CC3Sphere) aSphere {
+	if (self.shouldSearchFaceTree)
+		return [self.faceTree findFirst: maxFaceCount faceIndices: faceIndices intersectingSphere: aSphere];
+
+	GLuint hitIdx = 0;
+	GLuint faceCount = self.faceCount;
+	for (GLuint faceIdx = 0; faceIdx < faceCount && hitIdx < maxFaceCount; faceIdx++)
+		if ( CC3DoesFaceIntersectSphere([self faceAt: faceIdx], aSphere) ) faceIndices[hitIdx++] = faceIdx;
+	return hitIdx;
+}
+
+-(GLuint) findFirst: (GLuint) maxFaceCount
+		faceIndices: (GLuint*) faceIndices
+  intersectingLocalBox: (CC3Box) aBox {
+	if (self.shouldSearchFaceTree)
+		return [self.faceTree findFirst: maxFaceCount faceIndices: faceIndices intersectingBox: aBox];
+	
+	GLuint hitIdx = 0;
+	GLuint faceCount = self.faceCount;
+	for (GLuint faceIdx = 0; faceIdx < faceCount && hitIdx < maxFaceCount; faceIdx++)
+		if ( CC3DoesFaceIntersectBox([self faceAt: faceIdx], aBox) ) faceIndices[hitIdx++] = faceIdx;
 	return hitIdx;
 }
 
+/** Synchronized, because meshes may be punctured from concurrent node updates. */
+-(CC3MeshFaceTree*) faceTree {
+	@synchronized(self) {
+		if ( !_faceTree ) _faceTree = [CC3MeshFaceTree new];		// retained
+		if ( ![_faceTree isCurrentForMesh: self] ) [_faceTree populateFromMesh: self];
+		return _faceTree;
+	}
+}
+
+-(BOOL) shouldUseFaceTree { return _shouldUseFaceTree; }
+
+-(void) setShouldUseFaceTree: (BOOL) shouldUse {
+	_shouldUseFaceTree = shouldUse;
+	if ( !_shouldUseFaceTree ) {
+		@synchronized(self) {
+			[_faceTree release];
+			_faceTree = nil;
+		}
+	}
+}
+
+-(void) markFaceTreeDirty { [_faceTree markDirty]; }
+
 
 #pragma mark Buffering content to GL engine
 
@@ -1177,6 +1602,7 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 
 -(void) updateGLBuffersStartingAt: (GLuint) offsetIndex forLength: (GLuint) vertexCount {
 	[_vertexLocations updateGLBufferStartingAt: offsetIndex forLength: vertexCount];
+	[self markFaceTreeDirty];
 	if ( !_shouldInterleaveVertices ) {
 		[_vertexNormals updateGLBufferStartingAt: offsetIndex forLength: vertexCount];
 		[_vertexTangents updateGLBufferStartingAt: offsetIndex forLength: vertexCount];
@@ -1194,7 +1620,10 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 
 -(void) updateGLBuffers { [self updateGLBuffersStartingAt: 0 forLength: self.vertexCount]; }
 
--(void) updateVertexLocationsGLBuffer { [_vertexLocations updateGLBuffer]; }
+-(void) updateVertexLocationsGLBuffer {
+	[_vertexLocations updateGLBuffer];
+	[self markFaceTreeDirty];
+}
 
 -(void) updateVertexNormalsGLBuffer { [_vertexNormals updateGLBuffer]; }
 
@@ -1216,7 +1645,10 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 	[[self textureCoordinatesForTextureUnit: texUnit] updateGLBuffer];
 }
 
--(void) updateVertexIndicesGLBuffer { [_vertexIndices updateGLBuffer]; }
+-(void) updateVertexIndicesGLBuffer {
+	[_vertexIndices updateGLBuffer];
+	[self markFaceTreeDirty];
+}
 
 
 #pragma mark Mesh Geometry
@@ -1236,6 +1668,232 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 -(void) movePivotToCenterOfGeometry { [self moveMeshOriginToCenterOfGeometry]; }
 
 
+#pragma mark Levels of detail
+
+-(CC3Mesh*) meshSimplifiedToTriangleRatio: (GLfloat) ratio {
+	return [self meshSimplifiedToTriangleCount: (GLuint)(self.faceCount * ratio)
+							 withSectionStarts: NULL
+							  andSectionCounts: NULL
+								  sectionCount: 0];
+}
+
+-(CC3Mesh*) meshSimplifiedToTriangleCount: (GLuint) triangleCount
+						withSectionStarts: (GLuint*) sectionStarts
+						 andSectionCounts: (GLuint*) sectionCounts
+							 sectionCount: (GLuint) sectionCount {
+	GLuint vtxCount = self.vertexCount;
+	GLuint triCount = self.faceCount;
+	if ( !_vertexLocations || vtxCount == 0 || triCount == 0 ) return nil;
+
+	CC3Assert(_vertexLocations.vertices, @"%@ cannot be simplified after its vertex content has been released.", self);
+	CC3Assert(sectionCount == 0 || self.drawingMode == GL_TRIANGLES,
+			  @"%@ can only be simplified in sections if it is drawn with GL_TRIANGLES.", self);
+
+	CC3SimplifyVertex* vertices = calloc(vtxCount, sizeof(CC3SimplifyVertex));
+	GLuint* indices = calloc(triCount * 3, sizeof(GLuint));
+	GLuint* triIDs = sectionCount ? calloc(triCount, sizeof(GLuint)) : NULL;
+	if ( !(vertices && indices && (triIDs || !sectionCount)) ) {
+		LogError(@"%@ could not allocate memory to simplify %u triangles", self, triCount);
+		free(vertices);
+		free(indices);
+		free(triIDs);
+		return nil;
+	}
+
+	// Extract the vertex content that determines which vertices can be collapsed
+	GLuint texUnitCount = MIN(self.textureCoordinatesArrayCount, 2);
+	GLuint boneCount = (_vertexBoneIndices && _vertexBoneWeights) ? self.vertexBoneCount : 0;
+	for (GLuint vIdx = 0; vIdx < vtxCount; vIdx++) {
+		CC3SimplifyVertex* v = &vertices[vIdx];
+		v->location = [self vertexLocationAt: vIdx];
+		if (_vertexNormals) {
+			CC3Vector n = [self vertexNormalAt: vIdx];
+			v->attributes[0] = n.x;
+			v->attributes[1] = n.y;
+			v->attributes[2] = n.z;
+		}
+		for (GLuint tu = 0; tu < texUnitCount; tu++) {
+			ccTex2F tc = [self vertexTexCoord2FForTextureUnit: tu at: vIdx];
+			v->attributes[3 + (tu * 2)] = tc.u;
+			v->attributes[4 + (tu * 2)] = tc.v;
+		}
+		for (GLuint bIdx = 0; bIdx < boneCount; bIdx++) {
+			if ([self vertexWeightForBoneInfluence: bIdx at: vIdx] > 0.0f) {
+				GLuint bone = [self vertexBoneIndexForBoneInfluence: bIdx at: vIdx];
+				v->boneMask |= 1ULL << MIN(bone, 63);
+			}
+		}
+	}
+
+	// Extract the triangles, and the section of each triangle. Triangles outside
+	// all sections are placed in a section of their own.
+	for (GLuint fIdx = 0; fIdx < triCount; fIdx++) {
+		CC3FaceIndices face = [self faceIndicesAt: fIdx];
+		indices[fIdx * 3] = face.vertices[0];
+		indices[fIdx * 3 + 1] = face.vertices[1];
+		indices[fIdx * 3 + 2] = face.vertices[2];
+		if (triIDs) triIDs[fIdx] = sectionCount;
+	}
+	for (GLuint sIdx = 0; sIdx < sectionCount; sIdx++) {
+		GLuint fEnd = MIN((sectionStarts[sIdx] + sectionCounts[sIdx]) / 3, triCount);
+		for (GLuint fIdx = sectionStarts[sIdx] / 3; fIdx < fEnd; fIdx++) triIDs[fIdx] = sIdx;
+	}
+
+	GLuint lodTriCount = CC3SimplifyTriangles(indices, triIDs, triCount, triangleCount, vertices, vtxCount);
+
+	// The remaining triangles keep their order, so each section remains contiguous
+	for (GLuint sIdx = 0; sIdx < sectionCount; sIdx++) {
+		sectionStarts[sIdx] = 0;
+		sectionCounts[sIdx] = 0;
+	}
+	for (GLuint tIdx = 0; tIdx < lodTriCount; tIdx++) {
+		GLuint sIdx = triIDs ? triIDs[tIdx] : sectionCount;
+		if (sIdx >= sectionCount) continue;
+		if (sectionCounts[sIdx] == 0) sectionStarts[sIdx] = tIdx * 3;
+		sectionCounts[sIdx] += 3;
+	}
+
+	// The simplified mesh draws the original vertices with its own vertex indices
+	CC3VertexIndices* lodIndices = [CC3VertexIndices vertexArray];
+	lodIndices.drawingMode = GL_TRIANGLES;
+	if (_vertexIndices)
+		lodIndices.elementType = _vertexIndices.elementType;
+	else
+		lodIndices.elementType = (vtxCount > 0xFFFF) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+	lodIndices.allocatedVertexCapacity = lodTriCount * 3;
+	for (GLuint iIdx = 0; iIdx < lodTriCount * 3; iIdx++) [lodIndices setIndex: indices[iIdx] at: iIdx];
+
+	free(vertices);
+	free(indices);
+	free(triIDs);
+
+	NSString* lodName = _name ? [NSString stringWithFormat: @"%@-LOD-%u", _name, lodTriCount] : nil;
+	CC3Mesh* lodMesh = [CC3Mesh meshWithName: lodName];
+	lodMesh.shouldInterleaveVertices = _shouldInterleaveVertices;
+	lodMesh.vertexLocations = _vertexLocations;
+	lodMesh.vertexNormals = _vertexNormals;
+	lodMesh.vertexTangents = _vertexTangents;
+	lodMesh.vertexBitangents = _vertexBitangents;
+	lodMesh.vertexColors = _vertexColors;
+	lodMesh.vertexBoneIndices = _vertexBoneIndices;
+	lodMesh.vertexBoneWeights = _vertexBoneWeights;
+	lodMesh.vertexPointSizes = _vertexPointSizes;
+	GLuint tcCount = self.textureCoordinatesArrayCount;
+	for (GLuint tu = 0; tu < tcCount; tu++) [lodMesh addTextureCoordinates: [self textureCoordinatesForTextureUnit: tu]];
+	lodMesh.vertexIndices = lodIndices;
+
+	LogRez(@"%@ simplified from %u to %u triangles", self, triCount, lodTriCount);
+	return lodMesh;
+}
+
+-(NSArray*) levelsOfDetailWithTriangleRatios: (GLfloat*) ratios count: (GLuint) lodCount {
+	NSMutableArray* lodMeshes = [NSMutableArray arrayWithCapacity: lodCount];
+	for (GLuint lodIdx = 0; lodIdx < lodCount; lodIdx++) {
+		CC3Mesh* lodMesh = [self meshSimplifiedToTriangleRatio: ratios[lodIdx]];
+		if ( !lodMesh ) return nil;
+		[lodMeshes addObject: lodMesh];
+	}
+	return lodMeshes;
+}
+
+
+#pragma mark Vertex quantization
+
+-(void) quantizeVertexContent { [self quantizeVertexContentWithDirectionType: GL_SHORT]; }
+
+-(void) quantizeVertexContentWithDirectionType: (GLenum) directionType {
+#if CC3_GLSL
+	CC3Assert(directionType == GL_SHORT || directionType == GL_BYTE,
+			  @"%@ cannot quantize vertex directions to %@. Use GL_SHORT or GL_BYTE.",
+			  self, NSStringFromGLEnum(directionType));
+
+	GLuint vtxCount = self.vertexCount;
+	if ( !_vertexLocations || vtxCount == 0 ) return;
+
+	CC3Assert(_vertexLocations.vertices, @"%@ vertex content must be in memory to be quantized."
+			  @" Invoke this method before invoking the releaseRedundantContent method.", self);
+
+	GLuint oldStride = self.vertexStride;
+	BOOL wasBuffered = self.isUsingGLBuffers;
+	[self deleteGLBuffers];
+
+	// Read the current content from a copy of this mesh while the content of this mesh is converted.
+	// If the content is interleaved, the copied arrays must be pointed into the copied content.
+	CC3Mesh* srcMesh = [[self copy] autorelease];
+	GLuint vtxCap = _vertexLocations.allocatedVertexCapacity;
+	if (_shouldInterleaveVertices && vtxCap) srcMesh.allocatedVertexCapacity = vtxCap;
+	vtxCap = MAX(vtxCap, vtxCount);
+
+	// Release the current content before the vertex arrays change format
+	CC3Box bb = _vertexLocations.boundingBox;
+	self.allocatedVertexCapacity = 0;
+
+	// Locations span the bounding box. Avoid a zero scale along any flat axis.
+	CC3Vector bbSize = CC3BoxSize(bb);
+	_vertexLocations.elementType = GL_UNSIGNED_SHORT;
+	_vertexLocations.elementSize = 4;
+	_vertexLocations.shouldNormalizeContent = YES;
+	_vertexLocations.quantizationOffset = bb.minimum;
+	_vertexLocations.quantizationScale = cc3v((bbSize.x ? bbSize.x : 1.0f),
+											  (bbSize.y ? bbSize.y : 1.0f),
+											  (bbSize.z ? bbSize.z : 1.0f));
+
+	// Directions in octahedral form
+	CC3VertexArray* dirArrays[] = { _vertexNormals, _vertexTangents, _vertexBitangents };
+	for (GLuint daIdx = 0; daIdx < 3; daIdx++) {
+		CC3VertexArray* dirArray = dirArrays[daIdx];
+		dirArray.elementType = directionType;
+		dirArray.elementSize = 2;
+		dirArray.shouldNormalizeContent = YES;
+	}
+
+	// Texture coordinates as half floats
+	GLuint tcCount = self.textureCoordinatesArrayCount;
+	for (GLuint tcIdx = 0; tcIdx < tcCount; tcIdx++) {
+		CC3VertexTextureCoordinates* vtxTexCoords = [self textureCoordinatesForTextureUnit: tcIdx];
+		vtxTexCoords.elementType = GL_HALF_FLOAT_OES;
+		vtxTexCoords.shouldNormalizeContent = NO;
+	}
+
+	[self updateVertexStride];
+	self.allocatedVertexCapacity = vtxCap;
+	self.vertexCount = vtxCount;
+
+	// Encode the converted content through the vertex array accessors
+	CC3VertexLocations* srcLocs = srcMesh.vertexLocations;
+	for (GLuint vIdx = 0; vIdx < vtxCount; vIdx++) {
+		[_vertexLocations setHomogeneousLocation: [srcLocs homogeneousLocationAt: vIdx] at: vIdx];
+		if (_vertexNormals) [_vertexNormals setNormal: [srcMesh.vertexNormals normalAt: vIdx] at: vIdx];
+		if (_vertexTangents) [_vertexTangents setTangent: [srcMesh.vertexTangents tangentAt: vIdx] at: vIdx];
+		if (_vertexBitangents) [_vertexBitangents setTangent: [srcMesh.vertexBitangents tangentAt: vIdx] at: vIdx];
+		for (GLuint tcIdx = 0; tcIdx < tcCount; tcIdx++) {
+			ccTex2F tc = [[srcMesh textureCoordinatesForTextureUnit: tcIdx] texCoord2FAt: vIdx];
+			[[self textureCoordinatesForTextureUnit: tcIdx] setTexCoord2F: tc at: vIdx];
+		}
+	}
+
+	// Copy the unchanged content as is
+	CC3VertexArray* dstArrays[] = { _vertexColors, _vertexBoneWeights, _vertexBoneIndices, _vertexPointSizes };
+	CC3VertexArray* srcArrays[] = { srcMesh.vertexColors, srcMesh.vertexBoneWeights,
+									srcMesh.vertexBoneIndices, srcMesh.vertexPointSizes };
+	for (GLuint vaIdx = 0; vaIdx < 4; vaIdx++) {
+		CC3VertexArray* dstArray = dstArrays[vaIdx];
+		if ( !dstArray ) continue;
+		CC3VertexArray* srcArray = srcArrays[vaIdx];
+		GLuint elemLen = dstArray.elementLength;
+		for (GLuint vIdx = 0; vIdx < vtxCount; vIdx++)
+			memcpy([dstArray addressOfElement: vIdx], [srcArray addressOfElement: vIdx], elemLen);
+	}
+
+	if (wasBuffered) [self createGLBuffers];
+
+	LogRez(@"%@ quantized vertex content from %u to %u bytes per vertex", self, oldStride, self.vertexStride);
+#else
+	LogInfo(@"%@ vertex content cannot be quantized under OpenGL ES 1.", self);
+#endif	// CC3_GLSL
+}
+
+
 #pragma mark CCRGBAProtocol support
 
 -(CCColorRef) color { return _vertexColors ? _vertexColors.color : CCColorRefFromCCC4F(kCCC4FBlackTransparent); }
@@ -1446,7 +2104,9 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 		_overlayTextureCoordinates = nil;
 		_vertexIndices = nil;
 		_faces = nil;
+		_faceTree = nil;
 		_shouldInterleaveVertices = YES;
+		_shouldUseFaceTree = YES;
 		_capacityExpansionFactor = 1.25;
 	}
 	return self;
@@ -1459,6 +2119,7 @@ NSString* NSStringFromCC3VertexContent(CC3VertexContent vtxContent) {
 	[super populateFrom: another];
 	
 	_shouldInterleaveVertices = another.shouldInterleaveVertices;
+	_shouldUseFaceTree = another.shouldUseFaceTree;
 	_capacityExpansionFactor = another.capacityExpansionFactor;
 	
 	// Share vertex arrays between copies
@@ -2071,3 +2732,537 @@ static GLuint lastAssignedMeshTag;
 -(void) markNeighboursDirty { _neighboursAreDirty = YES; }
 
 @end
+
+
+#pragma mark -
+#pragma mark CC3MeshFaceTree
+
+/** The number of bins across which the centers of the faces of a node are sorted when choosing a split. */
+#define kCC3MeshFaceTreeBinCount			12
+
+/** A node holding no more than this many faces becomes a leaf if splitting it would not reduce its cost. */
+#define kCC3MeshFaceTreeMaxLeafFaceCount	4
+
+/** The cost of visiting a branch of the tree, relative to the cost of testing a single face. */
+#define kCC3MeshFaceTreeTraversalCost		1.0f
+
+/** The maximum depth of the tree. This also bounds the depth of the traversal stack. */
+#define kCC3MeshFaceTreeMaxDepth			64
+
+/** The fraction of the size of the mesh by which the box of each face is padded, to absorb rounding errors. */
+#define kCC3MeshFaceTreeBoundsPadding		1.0e-5f
+
+/** A box that contains nothing, and takes on the bounds of the first box added to it. */
+static const CC3Box kCC3MeshFaceTreeEmptyBox = { {FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX} };
+
+/** Returns the smallest box that contains both of the specified boxes. Faster than CC3BoxUnion. */
+static inline CC3Box CC3MeshFaceTreeBoxUnion(CC3Box bb1, CC3Box bb2) {
+	return CC3BoxFromMinMax(CC3VectorMinimize(bb1.minimum, bb2.minimum),
+							CC3VectorMaximize(bb1.maximum, bb2.maximum));
+}
+
+/** Returns the component of the specified vector along the specified axis (0 = X, 1 = Y, 2 = Z). */
+static inline GLfloat CC3MeshFaceTreeAxisValue(CC3Vector v, GLuint axis) {
+	return (axis == 0) ? v.x : ((axis == 1) ? v.y : v.z);
+}
+
+/** Returns the bin into which a face whose center has the specified value along the split axis is sorted. */
+static inline GLuint CC3MeshFaceTreeBinIndex(GLfloat value, GLfloat axisMin, GLfloat binScale) {
+	return (GLuint)MIN((value - axisMin) * binScale, (GLfloat)(kCC3MeshFaceTreeBinCount - 1));
+}
+
+/** Returns the reciprocal of the specified ray direction component, avoiding division by zero. */
+static inline GLfloat CC3MeshFaceTreeInverseDirection(GLfloat dirComponent) {
+	return 1.0f / ((dirComponent != 0.0f) ? dirComponent : FLT_MIN);
+}
+
+/**
+ * Returns whether the ray, starting at the specified location, enters the specified box. If it
+ * does, the entryDistance argument is set to the distance at which it does, measured as a multiple
+ * of the length of the ray direction, as are the distances of CC3MeshIntersections. The direction
+ * of the ray is specified as the reciprocal of each of its components.
+ *
+ * If acceptBehind is NO, the portion of the line behind the start of the ray is ignored, and the
+ * entry distance is zero when the start of the ray is inside the box. If acceptBehind is YES, the
+ * ray is treated as a complete line, and the entry distance may be negative.
+ */
+static inline BOOL CC3MeshFaceTreeRayEntersBox(CC3Box bb, CC3Vector rayStart, CC3Vector invDir,
+											   BOOL acceptBehind, GLfloat* entryDistance) {
+	GLfloat tx1 = (bb.minimum.x - rayStart.x) * invDir.x;
+	GLfloat tx2 = (bb.maximum.x - rayStart.x) * invDir.x;
+	GLfloat ty1 = (bb.minimum.y - rayStart.y) * invDir.y;
+	GLfloat ty2 = (bb.maximum.y - rayStart.y) * invDir.y;
+	GLfloat tz1 = (bb.minimum.z - rayStart.z) * invDir.z;
+	GLfloat tz2 = (bb.maximum.z - rayStart.z) * invDir.z;
+	GLfloat tNear = MAX(MAX(MIN(tx1, tx2), MIN(ty1, ty2)), MIN(tz1, tz2));
+	GLfloat tFar = MIN(MIN(MAX(tx1, tx2), MAX(ty1, ty2)), MAX(tz1, tz2));
+	if ( !acceptBehind ) tNear = MAX(tNear, 0.0f);
+	*entryDistance = tNear;
+	return tNear <= tFar;
+}
+
+/** Working content used while building a CC3MeshFaceTree. */
+typedef struct {
+	CC3MeshFaceTreeNode* nodes;		/**< The nodes of the tree, in depth-first order. */
+	GLuint* faceIndices;			/**< The indices of the faces, in the order that the leaves hold them. */
+	CC3Box* faceBounds;				/**< The padded bounds of each face, indexed by face index. */
+	CC3Vector* faceCenters;			/**< The center of the bounds of each face, indexed by face index. */
+	GLuint nodeCount;				/**< The number of nodes added to the tree so far. */
+	GLuint maxDepth;				/**< The depth of the deepest node added so far. The root is at depth zero. */
+} CC3MeshFaceTreeBuild;
+
+/**
+ * Chooses how to split the specified range of faces, by distributing the centers of the faces
+ * into bins along each axis, and evaluating the surface area heuristic at each boundary between
+ * the bins. The faces are reordered in place, so that the faces of the first child precede those
+ * of the second child, and the number of faces in the first child is returned. Returns zero if
+ * the faces should remain together in a leaf.
+ */
+static GLuint CC3MeshFaceTreePartition(CC3MeshFaceTreeBuild* build, GLuint first, GLuint count,
+									   CC3Box bounds, CC3Box centerBounds) {
+	GLuint* faceIndices = build->faceIndices + first;
+	CC3Vector centerExtent = CC3BoxSize(centerBounds);
+	GLfloat bestCost = kCC3MaxGLfloat;
+	GLint bestAxis = -1;
+	GLuint bestBin = 0;
+
+	for (GLuint axis = 0; axis < 3; axis++) {
+		GLfloat axisExtent = CC3MeshFaceTreeAxisValue(centerExtent, axis);
+		if (axisExtent <= 0.0f) continue;
+		GLfloat axisMin = CC3MeshFaceTreeAxisValue(centerBounds.minimum, axis);
+		GLfloat binScale = kCC3MeshFaceTreeBinCount / axisExtent;
+
+		CC3Box binBounds[kCC3MeshFaceTreeBinCount];
+		GLuint binCounts[kCC3MeshFaceTreeBinCount];
+		for (GLuint bIdx = 0; bIdx < kCC3MeshFaceTreeBinCount; bIdx++) {
+			binBounds[bIdx] = kCC3MeshFaceTreeEmptyBox;
+			binCounts[bIdx] = 0;
+		}
+		for (GLuint fIdx = 0; fIdx < count; fIdx++) {
+			GLuint faceIdx = faceIndices[fIdx];
+			GLuint bIdx = CC3MeshFaceTreeBinIndex(CC3MeshFaceTreeAxisValue(build->faceCenters[faceIdx], axis),
+												  axisMin, binScale);
+			binBounds[bIdx] = CC3MeshFaceTreeBoxUnion(binBounds[bIdx], build->faceBounds[faceIdx]);
+			binCounts[bIdx]++;
+		}
+
+		// Sweep from the right to accumulate the area and count of the faces to the right of each
+		// boundary, then sweep from the left to evaluate the cost of splitting at each boundary.
+		GLfloat rightAreas[kCC3MeshFaceTreeBinCount - 1];
+		GLuint rightCounts[kCC3MeshFaceTreeBinCount - 1];
+		CC3Box sweepBounds = kCC3MeshFaceTreeEmptyBox;
+		GLuint sweepCount = 0;
+		for (GLuint bIdx = kCC3MeshFaceTreeBinCount - 1; bIdx > 0; bIdx--) {
+			sweepBounds = CC3MeshFaceTreeBoxUnion(sweepBounds, binBounds[bIdx]);
+			sweepCount += binCounts[bIdx];
+			rightAreas[bIdx - 1] = sweepCount ? CC3BoxHalfSurfaceArea(sweepBounds) : 0.0f;
+			rightCounts[bIdx - 1] = sweepCount;
+		}
+		sweepBounds = kCC3MeshFaceTreeEmptyBox;
+		sweepCount = 0;
+		for (GLuint bIdx = 0; bIdx < kCC3MeshFaceTreeBinCount - 1; bIdx++) {
+			sweepBounds = CC3MeshFaceTreeBoxUnion(sweepBounds, binBounds[bIdx]);
+			sweepCount += binCounts[bIdx];
+			if (sweepCount == 0 || rightCounts[bIdx] == 0) continue;
+
+			GLfloat cost = (CC3BoxHalfSurfaceArea(sweepBounds) * sweepCount) + (rightAreas[bIdx] * rightCounts[bIdx]);
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = bIdx;
+			}
+		}
+	}
+
+	// If the centers of all the faces coincide, they cannot be separated by location.
+	// Keep them together, unless there are too many, in which case, split them in half.
+	if (bestAxis < 0) return (count > kCC3MeshFaceTreeMaxLeafFaceCount) ? (count / 2) : 0;
+
+	// Compare the cost of splitting to the cost of testing every face in a leaf.
+	// If there are too many faces for a single leaf, split them anyway.
+	GLfloat area = CC3BoxHalfSurfaceArea(bounds);
+	GLfloat splitCost = kCC3MeshFaceTreeTraversalCost + ((area > 0.0f) ? (bestCost / area) : count);
+	if (splitCost >= count && count <= kCC3MeshFaceTreeMaxLeafFaceCount) return 0;
+
+	// Move the faces in the bins up to and including the best bin to the front of the range
+	GLfloat axisMin = CC3MeshFaceTreeAxisValue(centerBounds.minimum, bestAxis);
+	GLfloat binScale = kCC3MeshFaceTreeBinCount / CC3MeshFaceTreeAxisValue(centerExtent, bestAxis);
+	GLuint frontCount = 0;
+	GLuint backStart = count;
+	while (frontCount < backStart) {
+		GLuint faceIdx = faceIndices[frontCount];
+		GLfloat centerValue = CC3MeshFaceTreeAxisValue(build->faceCenters[faceIdx], bestAxis);
+		if (CC3MeshFaceTreeBinIndex(centerValue, axisMin, binScale) <= bestBin) {
+			frontCount++;
+		} else {
+			faceIndices[frontCount] = faceIndices[--backStart];
+			faceIndices[backStart] = faceIdx;
+		}
+	}
+	return frontCount;
+}
+
+/**
+ * Adds a node holding the specified range of faces to the tree, at the specified depth, and
+ * recursively adds its children, if it is split. Returns the index of the node that was added.
+ */
+static GLuint CC3MeshFaceTreeBuildNode(CC3MeshFaceTreeBuild* build, GLuint first, GLuint count, GLuint depth) {
+	GLuint nodeIdx = build->nodeCount++;
+	build->maxDepth = MAX(build->maxDepth, depth);
+
+	CC3Box bounds = kCC3MeshFaceTreeEmptyBox;
+	CC3Box centerBounds = kCC3MeshFaceTreeEmptyBox;
+	for (GLuint fIdx = first; fIdx < first + count; fIdx++) {
+		GLuint faceIdx = build->faceIndices[fIdx];
+		bounds = CC3MeshFaceTreeBoxUnion(bounds, build->faceBounds[faceIdx]);
+		CC3Vector center = build->faceCenters[faceIdx];
+		centerBounds = CC3MeshFaceTreeBoxUnion(centerBounds, CC3BoxFromMinMax(center, center));
+	}
+	build->nodes[nodeIdx].bounds = bounds;
+
+	GLuint firstChildCount = 0;
+	if (count > 1 && depth + 1 < kCC3MeshFaceTreeMaxDepth)
+		firstChildCount = CC3MeshFaceTreePartition(build, first, count, bounds, centerBounds);
+
+	if (firstChildCount == 0) {
+		build->nodes[nodeIdx].offset = first;
+		build->nodes[nodeIdx].faceCount = count;
+		return nodeIdx;
+	}
+
+	// The first child immediately follows this node. Only the second child needs to be recorded.
+	CC3MeshFaceTreeBuildNode(build, first, firstChildCount, depth + 1);
+	build->nodes[nodeIdx].offset = CC3MeshFaceTreeBuildNode(build, first + firstChildCount,
+															count - firstChildCount, depth + 1);
+	build->nodes[nodeIdx].faceCount = 0;
+	return nodeIdx;
+}
+
+/** A test of whether a search shape intersects either a box, or a face. */
+typedef struct {
+	BOOL (*intersectsBox)(const void* shape, CC3Box bb);
+	BOOL (*intersectsFace)(const void* shape, CC3Face face);
+} CC3MeshFaceTreeShapeTest;
+
+static BOOL CC3MeshFaceTreeSphereIntersectsBox(const void* shape, CC3Box bb) {
+	return CC3DoesBoxIntersectSphere(bb, *(CC3Sphere*)shape);
+}
+
+static BOOL CC3MeshFaceTreeSphereIntersectsFace(const void* shape, CC3Face face) {
+	return CC3DoesFaceIntersectSphere(face, *(CC3Sphere*)shape);
+}
+
+static BOOL CC3MeshFaceTreeBoxIntersectsBox(const void* shape, CC3Box bb) {
+	return CC3DoesBoxIntersectBox(bb, *(CC3Box*)shape);
+}
+
+static BOOL CC3MeshFaceTreeBoxIntersectsFace(const void* shape, CC3Face face) {
+	return CC3DoesFaceIntersectBox(face, *(CC3Box*)shape);
+}
+
+static const CC3MeshFaceTreeShapeTest kCC3MeshFaceTreeSphereTest = {
+	CC3MeshFaceTreeSphereIntersectsBox, CC3MeshFaceTreeSphereIntersectsFace
+};
+
+static const CC3MeshFaceTreeShapeTest kCC3MeshFaceTreeBoxTest = {
+	CC3MeshFaceTreeBoxIntersectsBox, CC3MeshFaceTreeBoxIntersectsFace
+};
+
+@implementation CC3MeshFaceTree
+
+@synthesize faceCount=_faceCount, nodeCount=_nodeCount, depth=_depth;
+@synthesize buildTime=_buildTime;
+
+-(void) dealloc {
+	[self deallocateContent];
+	[super dealloc];
+}
+
+/** Frees the nodes and faces of this tree. */
+-(void) deallocateContent {
+	free(_nodes);
+	_nodes = NULL;
+	free(_faceIndices);
+	_faceIndices = NULL;
+	free(_faces);
+	_faces = NULL;
+	_nodeCount = 0;
+	_faceCount = 0;
+	_depth = 0;
+}
+
+-(size_t) memoryUsed {
+	return (_nodeCount * sizeof(CC3MeshFaceTreeNode)) + (_faceCount * (sizeof(GLuint) + sizeof(CC3Face)));
+}
+
+-(BOOL) isDirty { return _isDirty; }
+
+-(void) markDirty { _isDirty = YES; }
+
+-(BOOL) isCurrentForMesh: (CC3Mesh*) aMesh {
+	return !_isDirty && _faceCount == aMesh.faceCount &&
+			_vertexLocationsVersion == aMesh.vertexLocations.boundaryVersion;
+}
+
+
+#pragma mark Building
+
+-(void) populateFromMesh: (CC3Mesh*) aMesh {
+	NSTimeInterval startTime = NSDate.timeIntervalSinceReferenceDate;
+
+	[self deallocateContent];
+	_isDirty = NO;
+	_vertexLocationsVersion = aMesh.vertexLocations.boundaryVersion;
+	_faceCount = aMesh.faceCount;
+	if (_faceCount) [self buildFromMesh: aMesh];
+
+	_buildTime = NSDate.timeIntervalSinceReferenceDate - startTime;
+	LogInfo(@"%@ built from %@ in %.3f ms", self, aMesh, (_buildTime * 1000.0));
+}
+
+/** Retrieves each face from the specified mesh, and builds the nodes of the tree over them. */
+-(void) buildFromMesh: (CC3Mesh*) aMesh {
+	CC3MeshFaceTreeBuild build;
+	build.nodes = malloc(((2 * _faceCount) - 1) * sizeof(CC3MeshFaceTreeNode));
+	build.faceIndices = malloc(_faceCount * sizeof(GLuint));
+	build.faceBounds = malloc(_faceCount * sizeof(CC3Box));
+	build.faceCenters = malloc(_faceCount * sizeof(CC3Vector));
+	build.nodeCount = 0;
+	build.maxDepth = 0;
+	CC3Face* meshFaces = malloc(_faceCount * sizeof(CC3Face));
+
+	// Retrieve each face from the mesh only once
+	CC3Box meshBounds = kCC3MeshFaceTreeEmptyBox;
+	for (GLuint faceIdx = 0; faceIdx < _faceCount; faceIdx++) {
+		CC3Face face = [aMesh faceAt: faceIdx];
+		CC3Vector* vtx = face.vertices;
+		CC3Box faceBounds = CC3BoxFromMinMax(CC3VectorMinimize(CC3VectorMinimize(vtx[0], vtx[1]), vtx[2]),
+											 CC3VectorMaximize(CC3VectorMaximize(vtx[0], vtx[1]), vtx[2]));
+		meshFaces[faceIdx] = face;
+		build.faceIndices[faceIdx] = faceIdx;
+		build.faceBounds[faceIdx] = faceBounds;
+		build.faceCenters[faceIdx] = CC3BoxCenter(faceBounds);
+		meshBounds = CC3MeshFaceTreeBoxUnion(meshBounds, faceBounds);
+	}
+
+	// Pad each face, so that intersections found on the edge of a face lie within its box,
+	// despite rounding errors. Flat faces, such as those of terrain, would otherwise have
+	// boxes with no thickness.
+	CC3Vector meshSize = CC3BoxSize(meshBounds);
+	GLfloat padding = MAX(MAX(meshSize.x, meshSize.y), meshSize.z) * kCC3MeshFaceTreeBoundsPadding;
+	for (GLuint faceIdx = 0; faceIdx < _faceCount; faceIdx++)
+		build.faceBounds[faceIdx] = CC3BoxAddUniformPadding(build.faceBounds[faceIdx], padding);
+
+	CC3MeshFaceTreeBuildNode(&build, 0, _faceCount, 0);
+
+	// Copy the faces in the order in which the leaves hold them, so that
+	// the faces of each leaf are adjacent in memory when the leaf is searched.
+	_faces = malloc(_faceCount * sizeof(CC3Face));
+	for (GLuint fIdx = 0; fIdx < _faceCount; fIdx++) _faces[fIdx] = meshFaces[build.faceIndices[fIdx]];
+
+	_faceIndices = build.faceIndices;
+	_nodeCount = build.nodeCount;
+	_nodes = realloc(build.nodes, _nodeCount * sizeof(CC3MeshFaceTreeNode));
+	_depth = build.maxDepth + 1;
+
+	free(meshFaces);
+	free(build.faceBounds);
+	free(build.faceCenters);
+}
+
+
+#pragma mark Searching the tree
+
+/**
+ * Searches the faces in this tree for intersections with the specified ray. If nearestOnly is YES,
+ * the closest intersection is returned in the first element of the intersections array, and any
+ * branch of the tree that the ray enters beyond the closest intersection found so far is skipped.
+ * Otherwise, the search stops as soon as the specified number of intersections have been found.
+ */
+-(GLuint) findFirst: (GLuint) maxHitCount
+	  intersections: (CC3MeshIntersection*) intersections
+		 ofLocalRay: (CC3Ray) aRay
+	acceptBackFaces: (BOOL) acceptBackFaces
+	acceptBehindRay: (BOOL) acceptBehind
+		nearestOnly: (BOOL) nearestOnly {
+	if (_nodeCount == 0 || maxHitCount == 0) return 0;
+
+	CC3Vector rayStart = aRay.startLocation;
+	CC3Vector invDir = cc3v(CC3MeshFaceTreeInverseDirection(aRay.direction.x),
+							CC3MeshFaceTreeInverseDirection(aRay.direction.y),
+							CC3MeshFaceTreeInverseDirection(aRay.direction.z));
+
+	GLfloat rootDist;
+	if ( !CC3MeshFaceTreeRayEntersBox(_nodes[0].bounds, rayStart, invDir, acceptBehind, &rootDist) ) return 0;
+
+	// Depth-first traversal. Nodes are pushed with the distance at which the ray enters their box.
+	GLuint stack[kCC3MeshFaceTreeMaxDepth + 1];
+	GLfloat distStack[kCC3MeshFaceTreeMaxDepth + 1];
+	GLuint stackDepth = 0;
+	stack[stackDepth] = 0;
+	distStack[stackDepth++] = rootDist;
+
+	GLuint hitCount = 0;
+	CC3MeshIntersection hit;
+	while (stackDepth > 0) {
+		stackDepth--;
+		if (nearestOnly && hitCount && distStack[stackDepth] > intersections->distance) continue;
+
+		GLuint nodeIdx = stack[stackDepth];
+		CC3MeshFaceTreeNode* node = &_nodes[nodeIdx];
+		if (node->faceCount) {
+			GLuint leafEnd = node->offset + node->faceCount;
+			for (GLuint fIdx = node->offset; fIdx < leafEnd; fIdx++) {
+				if ( !CC3MeshIntersectionPopulate(&hit, _faces[fIdx], _faceIndices[fIdx],
+												  aRay, acceptBackFaces, acceptBehind) ) continue;
+				if (nearestOnly) {
+					if (hitCount == 0 || hit.distance < intersections->distance) {
+						*intersections = hit;
+						hitCount = 1;
+					}
+				} else {
+					intersections[hitCount++] = hit;
+					if (hitCount == maxHitCount) return hitCount;
+				}
+			}
+			continue;
+		}
+
+		// Order the children so that the child that the ray enters first is popped first
+		GLuint nearIdx = nodeIdx + 1;
+		GLuint farIdx = node->offset;
+		GLfloat nearDist, farDist;
+		BOOL isNearHit = CC3MeshFaceTreeRayEntersBox(_nodes[nearIdx].bounds, rayStart, invDir, acceptBehind, &nearDist);
+		BOOL isFarHit = CC3MeshFaceTreeRayEntersBox(_nodes[farIdx].bounds, rayStart, invDir, acceptBehind, &farDist);
+		if ( !isNearHit || (isFarHit && farDist < nearDist) ) {
+			GLuint tmpIdx = nearIdx;
+			nearIdx = farIdx;
+			farIdx = tmpIdx;
+			GLfloat tmpDist = nearDist;
+			nearDist = farDist;
+			farDist = tmpDist;
+			BOOL tmpHit = isNearHit;
+			isNearHit = isFarHit;
+			isFarHit = tmpHit;
+		}
+
+		CC3Assert(stackDepth + 2 <= kCC3MeshFaceTreeMaxDepth + 1, @"%@ is too deep to traverse", self);
+		if (isFarHit) {
+			stack[stackDepth] = farIdx;
+			distStack[stackDepth++] = farDist;
+		}
+		if (isNearHit) {
+			stack[stackDepth] = nearIdx;
+			distStack[stackDepth++] = nearDist;
+		}
+	}
+	return hitCount;
+}
+
+-(GLuint) findFirst: (GLuint) maxHitCount
+	  intersections: (CC3MeshIntersection*) intersections
+		 ofLocalRay: (CC3Ray) aRay
+	acceptBackFaces: (BOOL) acceptBackFaces
+	acceptBehindRay: (BOOL) acceptBehind {
+	return [self findFirst: maxHitCount
+			 intersections: intersections
+				ofLocalRay: aRay
+		   acceptBackFaces: acceptBackFaces
+		   acceptBehindRay: acceptBehind
+			   nearestOnly: NO];
+}
+
+-(BOOL) findNearestIntersection: (CC3MeshIntersection*) intersection
+					 ofLocalRay: (CC3Ray) aRay
+				acceptBackFaces: (BOOL) acceptBackFaces
+				acceptBehindRay: (BOOL) acceptBehind {
+	return [self findFirst: 1
+			 intersections: intersection
+				ofLocalRay: aRay
+		   acceptBackFaces: acceptBackFaces
+		   acceptBehindRay: acceptBehind
+			   nearestOnly: YES] > 0;
+}
+
+/**
+ * Populates the specified array with the indices of the faces in this tree that intersect the
+ * specified shape, as determined by the specified shape test, up to the specified maximum number
+ * of faces, and returns the number of face indices that were populated.
+ */
+-(GLuint) findFirst: (GLuint) maxFaceCount
+		faceIndices: (GLuint*) faceIndices
+	   intersecting: (const void*) shape
+		  usingTest: (const CC3MeshFaceTreeShapeTest*) shapeTest {
+	if (_nodeCount == 0 || maxFaceCount == 0) return 0;
+
+	GLuint stack[kCC3MeshFaceTreeMaxDepth + 1];
+	GLuint stackDepth = 0;
+	stack[stackDepth++] = 0;
+
+	GLuint hitCount = 0;
+	while (stackDepth > 0) {
+		GLuint nodeIdx = stack[--stackDepth];
+		CC3MeshFaceTreeNode* node = &_nodes[nodeIdx];
+		if ( !shapeTest->intersectsBox(shape, node->bounds) ) continue;
+
+		if (node->faceCount) {
+			GLuint leafEnd = node->offset + node->faceCount;
+			for (GLuint fIdx = node->offset; fIdx < leafEnd; fIdx++) {
+				if ( !shapeTest->intersectsFace(shape, _faces[fIdx]) ) continue;
+				faceIndices[hitCount++] = _faceIndices[fIdx];
+				if (hitCount == maxFaceCount) return hitCount;
+			}
+			continue;
+		}
+
+		CC3Assert(stackDepth + 2 <= kCC3MeshFaceTreeMaxDepth + 1, @"%@ is too deep to traverse", self);
+		stack[stackDepth++] = node->offset;
+		stack[stackDepth++] = nodeIdx + 1;
+	}
+	return hitCount;
+}
+
+-(GLuint) findFirst: (GLuint) maxFaceCount
+		faceIndices: (GLuint*) faceIndices
+ intersectingSphere: (CC3Sphere) aSphere {
+	return [self findFirst: maxFaceCount
+			   faceIndices: faceIndices
+			  intersecting: &aSphere
+				 usingTest: &kCC3MeshFaceTreeSphereTest];
+}
+
+-(GLuint) findFirst: (GLuint) maxFaceCount
+		faceIndices: (GLuint*) faceIndices
+	intersectingBox: (CC3Box) aBox {
+	return [self findFirst: maxFaceCount
+			   faceIndices: faceIndices
+			  intersecting: &aBox
+				 usingTest: &kCC3MeshFaceTreeBoxTest];
+}
+
+
+#pragma mark Allocation and initialization
+
+-(id) init {
+	if ( (self = [super init]) ) {
+		_nodes = NULL;
+		_faceIndices = NULL;
+		_faces = NULL;
+		_nodeCount = 0;
+		_faceCount = 0;
+		_depth = 0;
+		_vertexLocationsVersion = 0;
+		_buildTime = 0.0;
+		_isDirty = YES;
+	}
+	return self;
+}
+
++(id) tree { return [[[self alloc] init] autorelease]; }
+
+-(NSString*) description {
+	return [NSString stringWithFormat: @"%@ with %u faces in %u nodes, %u deep, using %lu bytes",
+			[self class], _faceCount, _nodeCount, _depth, (unsigned long)self.memoryUsed];
+}
+
+@end
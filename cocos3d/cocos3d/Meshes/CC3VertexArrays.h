@@ -876,9 +876,12 @@
  */
 @interface CC3VertexLocations : CC3DrawableVertexArray {
 	GLuint _firstVertex;
+	CC3Vector _quantizationOffset;
+	CC3Vector _quantizationScale;
 	CC3Box _boundingBox;
 	CC3Vector _centerOfGeometry;
 	GLfloat _radius;
+	GLuint _boundaryVersion;
 	BOOL _boundaryIsDirty : 1;
 	BOOL _radiusIsDirty : 1;
 }
@@ -914,6 +917,55 @@
 /** Marks the boundary, including bounding box and radius, as dirty, and need of recalculation. */
 -(void) markBoundaryDirty;
 
+/**
+ * A counter that is incremented each time the markBoundaryDirty method is invoked, which occurs
+ * whenever the vertex locations in this array are changed through the methods of this array.
+ *
+ * Structures that are built from the vertex locations, such as the faceTree of a CC3Mesh, can
+ * compare this value to the value it held when they were built, to determine whether they are
+ * out of date. The value itself has no meaning beyond that comparison, and it may wrap around.
+ */
+@property(nonatomic, readonly) GLuint boundaryVersion;
+
+/**
+ * Returns whether the vertex locations are held in a quantized form.
+ *
+ * Vertex locations are quantized when the elementType property is anything other than GL_FLOAT.
+ * Typically, quantized locations are held as GL_UNSIGNED_SHORT components, with the
+ * shouldNormalizeContent property set to YES, so that each component covers its range of
+ * the bounding box of the mesh in 65536 steps. Quantized content is mapped back to a location
+ * using the quantizationOffset and quantizationScale properties.
+ *
+ * Use the quantizeVertexContent method of CC3Mesh to convert a mesh to quantized content.
+ */
+@property(nonatomic, readonly) BOOL isQuantized;
+
+/**
+ * When the isQuantized property returns YES, this is the location that corresponds to a
+ * zero value in each component of the vertex content. The location of each vertex is:
+ *
+ *   location = quantizationOffset + (content * quantizationScale)
+ *
+ * where content is the value of each component, as seen by the shader.
+ *
+ * Shaders retrieve the value of this property through the kCC3SemanticVertexLocationOffset
+ * semantic. This property is ignored when the elementType property is GL_FLOAT.
+ *
+ * The initial value of this property is kCC3VectorZero.
+ */
+@property(nonatomic, assign) CC3Vector quantizationOffset;
+
+/**
+ * When the isQuantized property returns YES, this is the scale that maps each component of
+ * the vertex content to a location, as described for the quantizationOffset property.
+ *
+ * Shaders retrieve the value of this property through the kCC3SemanticVertexLocationScale
+ * semantic. This property is ignored when the elementType property is GL_FLOAT.
+ *
+ * The initial value of this property is kCC3VectorUnitCube.
+ */
+@property(nonatomic, assign) CC3Vector quantizationScale;
+
 /**
  * Returns the location element at the specified index in the underlying vertex content.
  *
@@ -923,6 +975,9 @@
  * This implementation takes into consideration the elementSize property. If the value
  * of the elementSize property is 2, the returned vector will contain zero in the Z component.
  *
+ * If the isQuantized property returns YES, the content is decoded using the elementType,
+ * shouldNormalizeContent, quantizationOffset and quantizationScale properties.
+ *
  * If the releaseRedundantContent method has been invoked and the underlying
  * vertex content has been released, this method will raise an assertion exception.
  */
@@ -939,6 +994,10 @@
  * of the elementSize property is 2, the Z component of the specified vector will be
  * ignored. If the value of the elementSize property is 4, the specified vector will
  * be converted to a 4D vector, with the W component set to one, before storing.
+ *
+ * If the isQuantized property returns YES, the location is encoded using the elementType,
+ * shouldNormalizeContent, quantizationOffset and quantizationScale properties. Locations
+ * outside the range described by those properties are clamped to that range.
  * 
  * If the new vertex location changes the bounding box of this instance, and this
  * instance is being used by any mesh nodes, be sure to invoke the markBoundingVolumeDirty
@@ -962,6 +1021,9 @@
  * in the W component. If the value of the elementSize property is 2, the returned
  * vector will contain zero in the Z component and one in the W component.
  *
+ * If the isQuantized property returns YES, the content is decoded as described for
+ * the locationAt: method. The W component is not affected by the quantization.
+ *
  * If the releaseRedundantContent method has been invoked and the underlying
  * vertex content has been released, this method will raise an assertion exception.
  */
@@ -978,6 +1040,9 @@
  * of the elementSize property is 3, the W component of the specified vector will be
  * ignored. If the value of the elementSize property is 2, both the W and Z components
  * of the specified vector will be ignored.
+ *
+ * If the isQuantized property returns YES, the location is encoded as described for
+ * the setLocation:at: method.
  * 
  * If the new vertex location changes the bounding box of this instance, and this
  * instance is being used by any mesh nodes, be sure to invoke the markBoundingVolumeDirty
@@ -1089,12 +1154,30 @@
 /** A CC3VertexArray that manages the normal aspect of an array of vertices. */
 @interface CC3VertexNormals : CC3VertexArray
 
+/**
+ * Returns whether each normal is held in octahedral form.
+ *
+ * When the elementSize property is 2, each normal is a unit direction held as two components that
+ * map the unit sphere onto a square, folding the lower hemisphere over the corners of the square.
+ * Typically the elementType property is GL_SHORT or GL_BYTE, and the shouldNormalizeContent
+ * property is YES, giving a precision of better than 0.1 degree, or about one degree, respectively.
+ *
+ * The normalAt: and setNormal:at: methods, and the default shaders, decode and encode octahedral
+ * content automatically. Decoded directions always have unit length.
+ *
+ * Use the quantizeVertexContent method of CC3Mesh to convert a mesh to octahedral content.
+ */
+@property(nonatomic, readonly) BOOL isOctahedral;
+
 /**
  * Returns the normal element at the specified index in the underlying vertex content.
  *
  * The index refers to vertices, not bytes. The implementation takes into consideration
  * the vertexStride and elementOffset properties to access the correct element.
  *
+ * This implementation takes into consideration the elementType, elementSize and
+ * shouldNormalizeContent properties, including content held in octahedral form.
+ *
  * If the releaseRedundantContent method has been invoked and the underlying
  * vertex content has been released, this method will raise an assertion exception.
  */
@@ -1107,6 +1190,9 @@
  * The index refers to vertices, not bytes. The implementation takes into consideration
  * the vertexStride and elementOffset properties to access the correct element.
  *
+ * This implementation takes into consideration the elementType, elementSize and
+ * shouldNormalizeContent properties, including content held in octahedral form.
+ *
  * If the releaseRedundantContent method has been invoked and the underlying
  * vertex content has been released, this method will raise an assertion exception.
  */
@@ -1124,12 +1210,30 @@
 /** A CC3VertexArray that manages the tangent or bitangent aspect of an array of vertices. */
 @interface CC3VertexTangents : CC3VertexArray
 
+/**
+ * Returns whether each tangent is held in octahedral form.
+ *
+ * When the elementSize property is 2, each tangent is a unit direction held as two components that
+ * map the unit sphere onto a square, folding the lower hemisphere over the corners of the square.
+ * Typically the elementType property is GL_SHORT or GL_BYTE, and the shouldNormalizeContent
+ * property is YES, giving a precision of better than 0.1 degree, or about one degree, respectively.
+ *
+ * The tangentAt: and setTangent:at: methods, and the default shaders, decode and encode octahedral
+ * content automatically. Decoded directions always have unit length.
+ *
+ * Use the quantizeVertexContent method of CC3Mesh to convert a mesh to octahedral content.
+ */
+@property(nonatomic, readonly) BOOL isOctahedral;
+
 /**
  * Returns the tangent element at the specified index in the underlying vertex content.
  *
  * The index refers to vertices, not bytes. The implementation takes into consideration
  * the vertexStride and elementOffset properties to access the correct element.
  *
+ * This implementation takes into consideration the elementType, elementSize and
+ * shouldNormalizeContent properties, including content held in octahedral form.
+ *
  * If the releaseRedundantContent method has been invoked and the underlying
  * vertex content has been released, this method will raise an assertion exception.
  */
@@ -1142,6 +1246,9 @@
  * The index refers to vertices, not bytes. The implementation takes into consideration
  * the vertexStride and elementOffset properties to access the correct element.
  *
+ * This implementation takes into consideration the elementType, elementSize and
+ * shouldNormalizeContent properties, including content held in octahedral form.
+ *
  * If the releaseRedundantContent method has been invoked and the underlying
  * vertex content has been released, this method will raise an assertion exception.
  */
@@ -1290,6 +1397,9 @@ static const CGRect kCC3UnitTextureRectangle = { {0.0, 0.0}, {1.0, 1.0} };
  * The index refers to vertices, not bytes. The implementation takes into consideration
  * the vertexStride and elementOffset properties to access the correct element.
  *
+ * This implementation takes into consideration the elementType and shouldNormalizeContent
+ * properties. In particular, texture coordinates may be held as GL_HALF_FLOAT_OES values.
+ *
  * If the releaseRedundantContent method has been invoked and the underlying
  * vertex content has been released, this method will raise an assertion exception.
  */
@@ -1302,6 +1412,9 @@ static const CGRect kCC3UnitTextureRectangle = { {0.0, 0.0}, {1.0, 1.0} };
  * The index refers to vertices, not bytes. The implementation takes into consideration
  * the vertexStride and elementOffset properties to access the correct element.
  *
+ * This implementation takes into consideration the elementType and shouldNormalizeContent
+ * properties, rounding the value to the precision of the elementType.
+ *
  * If the releaseRedundantContent method has been invoked and the underlying
  * vertex content has been released, this method will raise an assertion exception.
  */
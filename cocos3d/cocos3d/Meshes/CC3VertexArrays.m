@@ -34,6 +34,173 @@
 #import "CC3OpenGLUtility.h"
 
 
+#pragma mark -
+#pragma mark Vertex content conversion
+
+/** Returns the single-precision float value of the specified 16-bit half-precision float. */
+static GLfloat CC3FloatFromHalfFloat(GLushort hf) {
+	union { GLuint u; GLfloat f; } bits;
+	GLuint sign = (GLuint)(hf & 0x8000) << 16;
+	GLuint exp = (hf >> 10) & 0x1F;
+	GLuint mant = hf & 0x3FF;
+	if (exp == 0) {				// Zero or subnormal
+		GLfloat f = mant * (1.0f / 16777216.0f);
+		return sign ? -f : f;
+	}
+	bits.u = sign | ((exp == 0x1F)
+					 ? (0x7F800000 | (mant << 13))					// Infinity or NaN
+					 : (((exp + 112) << 23) | (mant << 13)));		// Rebias exponent from 15 to 127
+	return bits.f;
+}
+
+/**
+ * Returns the 16-bit half-precision float nearest to the specified single-precision float,
+ * rounding ties to even. Values beyond the range of a half float become infinity.
+ */
+static GLushort CC3HalfFloatFromFloat(GLfloat f) {
+	union { GLfloat f; GLuint u; } bits;
+	bits.f = f;
+	GLushort sign = (bits.u >> 16) & 0x8000;
+	GLuint absBits = bits.u & 0x7FFFFFFF;
+	if (absBits > 0x7F800000) return sign | 0x7E00;			// NaN
+	if (absBits >= 0x477FF000) return sign | 0x7C00;		// Rounds beyond 65504 to infinity
+	if (absBits < 0x38800000) return sign | (GLushort)lrintf(fabsf(f) * 16777216.0f);	// Subnormal
+	GLuint hf = (absBits - 0x38000000) >> 13;
+	GLuint rem = absBits & 0x1FFF;
+	if (rem > 0x1000 || (rem == 0x1000 && (hf & 1))) hf++;
+	return sign | (GLushort)hf;
+}
+
+/**
+ * Returns the value of the component at the specified index within the vertex element at the
+ * specified address, as it will be seen by a shader, given the specified element type, and
+ * whether the content is normalized.
+ *
+ * Signed normalized content is converted as c / max, clamped to -1, so that zero is exact.
+ */
+static GLfloat CC3VertexComponentAt(GLvoid* elemAddr, GLuint compIdx, GLenum elemType, BOOL isNormalized) {
+	switch (elemType) {
+		case GL_FLOAT:
+			return ((GLfloat*)elemAddr)[compIdx];
+		case GL_HALF_FLOAT_OES:
+			return CC3FloatFromHalfFloat(((GLushort*)elemAddr)[compIdx]);
+		case GL_BYTE: {
+			GLfloat c = ((GLbyte*)elemAddr)[compIdx];
+			return isNormalized ? MAX(c / 127.0f, -1.0f) : c;
+		}
+		case GL_UNSIGNED_BYTE: {
+			GLfloat c = ((GLubyte*)elemAddr)[compIdx];
+			return isNormalized ? (c / 255.0f) : c;
+		}
+		case GL_SHORT: {
+			GLfloat c = ((GLshort*)elemAddr)[compIdx];
+			return isNormalized ? MAX(c / 32767.0f, -1.0f) : c;
+		}
+		case GL_UNSIGNED_SHORT: {
+			GLfloat c = ((GLushort*)elemAddr)[compIdx];
+			return isNormalized ? (c / 65535.0f) : c;
+		}
+		case GL_FIXED:
+			return ((GLfixed*)elemAddr)[compIdx] / 65536.0f;
+		default:
+			return 0.0f;
+	}
+}
+
+/**
+ * Sets the component at the specified index within the vertex element at the specified address
+ * to the specified value, rounding and clamping it to the range of the specified element type.
+ * This is the inverse of CC3VertexComponentAt.
+ */
+static void CC3SetVertexComponentAt(GLvoid* elemAddr, GLuint compIdx, GLenum elemType, BOOL isNormalized, GLfloat value) {
+	switch (elemType) {
+		case GL_FLOAT:
+			((GLfloat*)elemAddr)[compIdx] = value;
+			break;
+		case GL_HALF_FLOAT_OES:
+			((GLushort*)elemAddr)[compIdx] = CC3HalfFloatFromFloat(value);
+			break;
+		case GL_BYTE:
+			if (isNormalized) value = CLAMP(value, -1.0f, 1.0f) * 127.0f;
+			((GLbyte*)elemAddr)[compIdx] = (GLbyte)lrintf(CLAMP(value, -128.0f, 127.0f));
+			break;
+		case GL_UNSIGNED_BYTE:
+			if (isNormalized) value = CLAMP(value, 0.0f, 1.0f) * 255.0f;
+			((GLubyte*)elemAddr)[compIdx] = (GLubyte)lrintf(CLAMP(value, 0.0f, 255.0f));
+			break;
+		case GL_SHORT:
+			if (isNormalized) value = CLAMP(value, -1.0f, 1.0f) * 32767.0f;
+			((GLshort*)elemAddr)[compIdx] = (GLshort)lrintf(CLAMP(value, -32768.0f, 32767.0f));
+			break;
+		case GL_UNSIGNED_SHORT:
+			if (isNormalized) value = CLAMP(value, 0.0f, 1.0f) * 65535.0f;
+			((GLushort*)elemAddr)[compIdx] = (GLushort)lrintf(CLAMP(value, 0.0f, 65535.0f));
+			break;
+		case GL_FIXED:
+			((GLfixed*)elemAddr)[compIdx] = (GLfixed)lrintf(value * 65536.0f);
+			break;
+		default:
+			break;
+	}
+}
+
+/** Returns 1 if the specified value is positive or zero, and -1 if it is negative. */
+static inline GLfloat CC3OctahedralSign(GLfloat v) { return (v >= 0.0f) ? 1.0f : -1.0f; }
+
+/**
+ * Returns the unit direction encoded by the specified octahedral coordinates, each in the range
+ * [-1, 1]. The upper hemisphere maps to the diamond |x| + |y| <= 1, and the lower hemisphere
+ * is folded over into the corners of the square.
+ */
+static CC3Vector CC3VectorFromOctahedral(GLfloat ox, GLfloat oy) {
+	CC3Vector v = CC3VectorMake(ox, oy, 1.0f - fabsf(ox) - fabsf(oy));
+	if (v.z < 0.0f) {
+		v.x = (1.0f - fabsf(oy)) * CC3OctahedralSign(ox);
+		v.y = (1.0f - fabsf(ox)) * CC3OctahedralSign(oy);
+	}
+	return CC3VectorNormalize(v);
+}
+
+/** Returns the octahedral coordinates of the specified direction. This is the inverse of CC3VectorFromOctahedral. */
+static CGPoint CC3OctahedralFromVector(CC3Vector v) {
+	GLfloat l1Norm = fabsf(v.x) + fabsf(v.y) + fabsf(v.z);
+	if (l1Norm == 0.0f) return CGPointZero;
+	GLfloat ox = v.x / l1Norm;
+	GLfloat oy = v.y / l1Norm;
+	if (v.z < 0.0f) {
+		GLfloat fx = (1.0f - fabsf(oy)) * CC3OctahedralSign(ox);
+		oy = (1.0f - fabsf(ox)) * CC3OctahedralSign(oy);
+		ox = fx;
+	}
+	return CGPointMake(ox, oy);
+}
+
+/**
+ * Returns the direction vector held in the vertex element at the specified address. If the element
+ * has two components, they hold the octahedral encoding of the direction, otherwise the first
+ * three components hold the direction itself.
+ */
+static CC3Vector CC3VertexDirectionAt(GLvoid* elemAddr, GLint elemSize, GLenum elemType, BOOL isNormalized) {
+	GLfloat x = CC3VertexComponentAt(elemAddr, 0, elemType, isNormalized);
+	GLfloat y = CC3VertexComponentAt(elemAddr, 1, elemType, isNormalized);
+	if (elemSize == 2) return CC3VectorFromOctahedral(x, y);
+	return CC3VectorMake(x, y, CC3VertexComponentAt(elemAddr, 2, elemType, isNormalized));
+}
+
+/** Sets the direction vector held in the vertex element at the specified address. This is the inverse of CC3VertexDirectionAt. */
+static void CC3SetVertexDirectionAt(GLvoid* elemAddr, GLint elemSize, GLenum elemType, BOOL isNormalized, CC3Vector dir) {
+	if (elemSize == 2) {
+		CGPoint oct = CC3OctahedralFromVector(dir);
+		CC3SetVertexComponentAt(elemAddr, 0, elemType, isNormalized, oct.x);
+		CC3SetVertexComponentAt(elemAddr, 1, elemType, isNormalized, oct.y);
+	} else {
+		CC3SetVertexComponentAt(elemAddr, 0, elemType, isNormalized, dir.x);
+		CC3SetVertexComponentAt(elemAddr, 1, elemType, isNormalized, dir.y);
+		CC3SetVertexComponentAt(elemAddr, 2, elemType, isNormalized, dir.z);
+	}
+}
+
+
 #pragma mark -
 #pragma mark CC3VertexArrayContent
 
@@ -496,6 +663,9 @@ static GLuint lastAssignedVertexArrayTag;
 					case GL_FIXED:
 						[desc appendFormat: @" %i,", ((GLfixed*)elemArray)[eaIdx]];
 						break;
+					case GL_HALF_FLOAT_OES:
+						[desc appendFormat: @" %.3f,", CC3FloatFromHalfFloat(((GLushort*)elemArray)[eaIdx])];
+						break;
 					default:
 						[desc appendFormat: @" unknown type (%u),", _elementType];
 						break;
@@ -755,6 +925,8 @@ static GLuint lastAssignedVertexArrayTag;
 @implementation CC3VertexLocations
 
 @synthesize firstVertex=_firstVertex;
+@synthesize quantizationOffset=_quantizationOffset, quantizationScale=_quantizationScale;
+@synthesize boundaryVersion=_boundaryVersion;
 
 // Deprecated
 -(GLuint) firstElement { return self.firstVertex; }
@@ -763,6 +935,7 @@ static GLuint lastAssignedVertexArrayTag;
 -(void) markBoundaryDirty {
 	_boundaryIsDirty = YES;
 	_radiusIsDirty = YES;
+	_boundaryVersion++;
 }
 
 // Mark boundary dirty, but only if vertices are valid (to avoid marking dirty on dealloc)
@@ -783,6 +956,8 @@ static GLuint lastAssignedVertexArrayTag;
 	[super populateFrom: another];
 
 	_firstVertex = another.firstVertex;
+	_quantizationOffset = another.quantizationOffset;
+	_quantizationScale = another.quantizationScale;
 	_boundingBox = another.boundingBox;
 	_centerOfGeometry = another.centerOfGeometry;
 	_radius = another.radius;
@@ -790,7 +965,11 @@ static GLuint lastAssignedVertexArrayTag;
 	_radiusIsDirty = another.radiusIsDirty;
 }
 
+-(BOOL) isQuantized { return _elementType != GL_FLOAT; }
+
 -(CC3Vector) locationAt: (GLuint) index {
+	if (self.isQuantized) return [self homogeneousLocationAt: index].v;
+
 	CC3Vector loc = *(CC3Vector*)[self addressOfElement: index];
 	switch (_elementSize) {
 		case 2:
@@ -804,6 +983,11 @@ static GLuint lastAssignedVertexArrayTag;
 }
 
 -(void) setLocation: (CC3Vector) aLocation at: (GLuint) index {
+	if (self.isQuantized) {
+		[self setHomogeneousLocation: CC3Vector4FromLocation(aLocation) at: index];
+		return;
+	}
+
 	GLvoid* elemAddr = [self addressOfElement: index];
 	switch (_elementSize) {
 		case 2:		// Just store X & Y
@@ -821,6 +1005,20 @@ static GLuint lastAssignedVertexArrayTag;
 }
 
 -(CC3Vector4) homogeneousLocationAt: (GLuint) index {
+	if (self.isQuantized) {
+		// Decode each component as the shader sees it, then map from the quantization range.
+		GLvoid* elemAddr = [self addressOfElement: index];
+		CC3Vector4 hLoc = kCC3Vector4ZeroLocation;
+		GLfloat* hComps = (GLfloat*)&hLoc;
+		GLint compCnt = MIN(_elementSize, 4);
+		for (GLint cIdx = 0; cIdx < compCnt; cIdx++)
+			hComps[cIdx] = CC3VertexComponentAt(elemAddr, cIdx, _elementType, _shouldNormalizeContent);
+		hLoc.x = _quantizationOffset.x + (hLoc.x * _quantizationScale.x);
+		hLoc.y = _quantizationOffset.y + (hLoc.y * _quantizationScale.y);
+		hLoc.z = _quantizationOffset.z + (hLoc.z * _quantizationScale.z);
+		return hLoc;
+	}
+
 	CC3Vector4 hLoc = *(CC3Vector4*)[self addressOfElement: index];
 	switch (_elementSize) {
 		case 2:
@@ -836,6 +1034,21 @@ static GLuint lastAssignedVertexArrayTag;
 
 -(void) setHomogeneousLocation: (CC3Vector4) aLocation at: (GLuint) index {
 	GLvoid* elemAddr = [self addressOfElement: index];
+
+	if (self.isQuantized) {
+		// Map into the quantization range, then encode each component.
+		CC3Vector4 qLoc = aLocation;
+		qLoc.x = _quantizationScale.x ? ((aLocation.x - _quantizationOffset.x) / _quantizationScale.x) : 0.0f;
+		qLoc.y = _quantizationScale.y ? ((aLocation.y - _quantizationOffset.y) / _quantizationScale.y) : 0.0f;
+		qLoc.z = _quantizationScale.z ? ((aLocation.z - _quantizationOffset.z) / _quantizationScale.z) : 0.0f;
+		GLfloat* qComps = (GLfloat*)&qLoc;
+		GLint compCnt = MIN(_elementSize, 4);
+		for (GLint cIdx = 0; cIdx < compCnt; cIdx++)
+			CC3SetVertexComponentAt(elemAddr, cIdx, _elementType, _shouldNormalizeContent, qComps[cIdx]);
+		[self markBoundaryDirty];
+		return;
+	}
+
 	switch (_elementSize) {
 		case 2:		// Just store X & Y
 			*(CGPoint*)elemAddr = *(CGPoint*)&aLocation;
@@ -893,7 +1106,6 @@ static GLuint lastAssignedVertexArrayTag;
 -(void) buildBoundingBox {
 	// If we don't have vertices, but do have a non-zero vertexCount, raise an assertion
 	CC3Assert( !( !_vertices && _vertexCount ), @"%@ bounding box requested after vertex data have been released", self);
-	CC3Assert(_elementType == GL_FLOAT, @"%@ must have elementType GLFLOAT to build the bounding box", self);
 
 	CC3Vector vl, vlMin, vlMax;
 	vl = (_vertexCount > 0) ? [self locationAt: 0] : kCC3VectorZero;
@@ -922,8 +1134,6 @@ static GLuint lastAssignedVertexArrayTag;
  * for the first time after the boundary has been marked dirty.
  */
 -(void) calcRadius {
-	CC3Assert(_elementType == GL_FLOAT, @"%@ must have elementType GLFLOAT to calculate mesh radius", [self class]);
-
 	CC3Vector cog = self.centerOfGeometry;		// Will measure it if necessary
 	if (_vertices && _vertexCount) {
 		// Work with the square of the radius so that all distances can be compared
@@ -998,9 +1208,12 @@ static GLuint lastAssignedVertexArrayTag;
 -(id) initWithTag: (GLuint) aTag withName: (NSString*) aName {
 	if ( (self = [super initWithTag: aTag withName: aName]) ) {
 		_firstVertex = 0;
+		_quantizationOffset = kCC3VectorZero;
+		_quantizationScale = kCC3VectorUnitCube;
 		_centerOfGeometry = kCC3VectorZero;
 		_boundingBox = kCC3BoxZero;
 		_radius = 0.0;
+		_boundaryVersion = 0;
 		[self markBoundaryDirty];
 	}
 	return self;
@@ -1016,18 +1229,26 @@ static GLuint lastAssignedVertexArrayTag;
 
 @implementation CC3VertexNormals
 
--(CC3Vector) normalAt: (GLuint) index { return *(CC3Vector*)[self addressOfElement: index]; }
+-(BOOL) isOctahedral { return _elementSize == 2; }
+
+-(CC3Vector) normalAt: (GLuint) index {
+	GLvoid* elemAddr = [self addressOfElement: index];
+	if (_elementType == GL_FLOAT && _elementSize == 3) return *(CC3Vector*)elemAddr;
+	return CC3VertexDirectionAt(elemAddr, _elementSize, _elementType, _shouldNormalizeContent);
+}
 
 -(void) setNormal: (CC3Vector) aNormal at: (GLuint) index {
-	*(CC3Vector*)[self addressOfElement: index] = aNormal;
+	GLvoid* elemAddr = [self addressOfElement: index];
+	if (_elementType == GL_FLOAT && _elementSize == 3)
+		*(CC3Vector*)elemAddr = aNormal;
+	else
+		CC3SetVertexDirectionAt(elemAddr, _elementSize, _elementType, _shouldNormalizeContent, aNormal);
 }
 
 -(void) flipNormals {
 	GLuint vtxCnt = self.vertexCount;
-	for (GLuint vtxIdx = 0; vtxIdx < vtxCnt; vtxIdx++) {
-		CC3Vector* pn = [self addressOfElement: vtxIdx];
-		*pn = CC3VectorNegate(*pn);
-	}
+	for (GLuint vtxIdx = 0; vtxIdx < vtxCnt; vtxIdx++)
+		[self setNormal: CC3VectorNegate([self normalAt: vtxIdx]) at: vtxIdx];
 }
 
 
@@ -1045,10 +1266,20 @@ static GLuint lastAssignedVertexArrayTag;
 
 @implementation CC3VertexTangents
 
--(CC3Vector) tangentAt: (GLuint) index { return *(CC3Vector*)[self addressOfElement: index]; }
+-(BOOL) isOctahedral { return _elementSize == 2; }
+
+-(CC3Vector) tangentAt: (GLuint) index {
+	GLvoid* elemAddr = [self addressOfElement: index];
+	if (_elementType == GL_FLOAT && _elementSize == 3) return *(CC3Vector*)elemAddr;
+	return CC3VertexDirectionAt(elemAddr, _elementSize, _elementType, _shouldNormalizeContent);
+}
 
 -(void) setTangent: (CC3Vector) aTangent at: (GLuint) index {
-	*(CC3Vector*)[self addressOfElement: index] = aTangent;
+	GLvoid* elemAddr = [self addressOfElement: index];
+	if (_elementType == GL_FLOAT && _elementSize == 3)
+		*(CC3Vector*)elemAddr = aTangent;
+	else
+		CC3SetVertexDirectionAt(elemAddr, _elementSize, _elementType, _shouldNormalizeContent, aTangent);
 }
 
 
@@ -1240,10 +1471,23 @@ static BOOL defaultExpectsVerticallyFlippedTextures = NO;
 	defaultExpectsVerticallyFlippedTextures = expectsFlipped;
 }
 
--(ccTex2F) texCoord2FAt: (GLuint) index { return *(ccTex2F*)[self addressOfElement: index]; }
+-(ccTex2F) texCoord2FAt: (GLuint) index {
+	GLvoid* elemAddr = [self addressOfElement: index];
+	if (_elementType == GL_FLOAT) return *(ccTex2F*)elemAddr;
+	ccTex2F tc;
+	tc.u = CC3VertexComponentAt(elemAddr, 0, _elementType, _shouldNormalizeContent);
+	tc.v = CC3VertexComponentAt(elemAddr, 1, _elementType, _shouldNormalizeContent);
+	return tc;
+}
 
 -(void) setTexCoord2F: (ccTex2F) aTex2F at: (GLuint) index {
-	*(ccTex2F*)[self addressOfElement: index] = aTex2F;
+	GLvoid* elemAddr = [self addressOfElement: index];
+	if (_elementType == GL_FLOAT) {
+		*(ccTex2F*)elemAddr = aTex2F;
+	} else {
+		CC3SetVertexComponentAt(elemAddr, 0, _elementType, _shouldNormalizeContent, aTex2F.u);
+		CC3SetVertexComponentAt(elemAddr, 1, _elementType, _shouldNormalizeContent, aTex2F.v);
+	}
 }
 
 /**
@@ -1275,19 +1519,20 @@ static BOOL defaultExpectsVerticallyFlippedTextures = NO;
 	// the mapSize and the old texture rectangle. Then, convert to the new coordinate, taking into
 	// consideration the mapSize and the new texture rectangle.
 	for (GLuint i = 0; i < _vertexCount; i++) {
-		ccTex2F* ptc = (ccTex2F*)[self addressOfElement: i];
+		ccTex2F tc = [self texCoord2FAt: i];
 		
-		GLfloat origU = ((ptc->u / mw) - ox) / ow;			// Revert to original value
-		ptc->u = (nx + (origU * nw)) * mw;					// Calc new value
+		GLfloat origU = ((tc.u / mw) - ox) / ow;			// Revert to original value
+		tc.u = (nx + (origU * nw)) * mw;					// Calc new value
 		
 		// Take into consideration whether the texture is flipped.
 		if (_expectsVerticallyFlippedTextures) {
-			GLfloat origV = (1.0f - (ptc->v / mh) - oy) / oh;	// Revert to original value
-			ptc->v = (1.0f - (ny + (origV * nh))) * mh;			// Calc new value
+			GLfloat origV = (1.0f - (tc.v / mh) - oy) / oh;	// Revert to original value
+			tc.v = (1.0f - (ny + (origV * nh))) * mh;			// Calc new value
 		} else {
-			GLfloat origV = (((ptc->v - hx) / mh) - oy) / oh;	// Revert to original value
-			ptc->v = (ny + (origV * nh)) * mh + hx;				// Calc new value
+			GLfloat origV = (((tc.v - hx) / mh) - oy) / oh;	// Revert to original value
+			tc.v = (ny + (origV * nh)) * mh + hx;				// Calc new value
 		}
+		[self setTexCoord2F: tc at: i];
 	}
 	[self updateGLBuffer];
 }
@@ -1312,9 +1557,10 @@ static BOOL defaultExpectsVerticallyFlippedTextures = NO;
 	GLfloat newVertXln = 1.0f - texCoverage.height;
 	
 	for (GLuint i = 0; i < _vertexCount; i++) {
-		ccTex2F* ptc = (ccTex2F*)[self addressOfElement: i];
-		ptc->u *= mapRatio.width;
-		ptc->v = (ptc->v - currVertXln) * mapRatio.height + newVertXln;
+		ccTex2F tc = [self texCoord2FAt: i];
+		tc.u *= mapRatio.width;
+		tc.v = (tc.v - currVertXln) * mapRatio.height + newVertXln;
+		[self setTexCoord2F: tc at: i];
 	}
 	_mapSize = texCoverage;	// Remember what we've set the map size to
 	[self updateGLBuffer];
@@ -1333,9 +1579,10 @@ static BOOL defaultExpectsVerticallyFlippedTextures = NO;
 	CGSize mapRatio = CGSizeMake(texCoverage.width / _mapSize.width, texCoverage.height / _mapSize.height);
 	
 	for (GLuint i = 0; i < _vertexCount; i++) {
-		ccTex2F* ptc = (ccTex2F*)[self addressOfElement: i];
-		ptc->u *= mapRatio.width;
-		ptc->v = texCoverage.height - (ptc->v * mapRatio.height);
+		ccTex2F tc = [self texCoord2FAt: i];
+		tc.u *= mapRatio.width;
+		tc.v = texCoverage.height - (tc.v * mapRatio.height);
+		[self setTexCoord2F: tc at: i];
 	}
 
 	// Remember that we've flipped and what we've set the map size to
@@ -1367,13 +1614,14 @@ static BOOL defaultExpectsVerticallyFlippedTextures = NO;
 	GLfloat minV = kCC3MaxGLfloat;
 	GLfloat maxV = -kCC3MaxGLfloat;
 	for (GLuint i = 0; i < _vertexCount; i++) {
-		ccTex2F* ptc = (ccTex2F*)[self addressOfElement: i];
-		minV = MIN(ptc->v, minV);
-		maxV = MAX(ptc->v, maxV);
+		ccTex2F tc = [self texCoord2FAt: i];
+		minV = MIN(tc.v, minV);
+		maxV = MAX(tc.v, maxV);
 	}
 	for (GLuint i = 0; i < _vertexCount; i++) {
-		ccTex2F* ptc = (ccTex2F*)[self addressOfElement: i];
-		ptc->v = minV + maxV - ptc->v;
+		ccTex2F tc = [self texCoord2FAt: i];
+		tc.v = minV + maxV - tc.v;
+		[self setTexCoord2F: tc at: i];
 	}
 	[self updateGLBuffer];
 }
@@ -1382,13 +1630,14 @@ static BOOL defaultExpectsVerticallyFlippedTextures = NO;
 	GLfloat minU = kCC3MaxGLfloat;
 	GLfloat maxU = -kCC3MaxGLfloat;
 	for (GLuint i = 0; i < _vertexCount; i++) {
-		ccTex2F* ptc = (ccTex2F*)[self addressOfElement: i];
-		minU = MIN(ptc->u, minU);
-		maxU = MAX(ptc->u, maxU);
+		ccTex2F tc = [self texCoord2FAt: i];
+		minU = MIN(tc.u, minU);
+		maxU = MAX(tc.u, maxU);
 	}
 	for (GLuint i = 0; i < _vertexCount; i++) {
-		ccTex2F* ptc = (ccTex2F*)[self addressOfElement: i];
-		ptc->u = minU + maxU - ptc->u;
+		ccTex2F tc = [self texCoord2FAt: i];
+		tc.u = minU + maxU - tc.u;
+		[self setTexCoord2F: tc at: i];
 	}
 	[self updateGLBuffer];
 }
@@ -194,6 +194,7 @@
 	CC3Matrix* _skeletalTransformMatrix;
 	CC3Matrix* _skeletalTransformMatrixInverted;
 	CC3DeformedFaceArray* _deformedFaces;
+	NSMutableArray* _levelOfDetailSectionRanges;
 }
 
 /** The collection of CC3SkinSections that are managed by this node. */
@@ -242,6 +243,31 @@
  */
 -(void) boneWasTransformed: (CC3Bone*) aBone;
 
+
+#pragma mark Levels of detail
+
+/**
+ * Overridden to simplify the mesh within each skin section, so that vertices are not collapsed
+ * across skin sections, and to record the range of vertex indices drawn by each skin section
+ * at each level of detail.
+ *
+ * The mesh must be drawn with GL_TRIANGLES. Otherwise, no levels of detail are generated.
+ */
+-(void) generateLevelsOfDetailWithTriangleRatios: (GLfloat*) ratios
+								belowScreenSizes: (GLfloat*) screenSizes
+										   count: (GLuint) lodCount;
+
+/**
+ * Adds a mesh to be drawn in place of the mesh in the mesh property, when this node appears
+ * smaller on the screen than the specified screen size.
+ *
+ * Because the range of vertex indices drawn by each skin section in the added mesh is not known,
+ * this node is drawn using the mesh in the mesh property wherever a level of detail added by this
+ * method is selected. Use the generateLevelsOfDetailWithTriangleRatios:belowScreenSizes:count:
+ * method instead, to add levels of detail that are drawn by the skin sections of this node.
+ */
+-(void) addLevelOfDetailMesh: (CC3Mesh*) aMesh belowScreenSize: (GLfloat) screenSize;
+
 @end
 
 
@@ -437,6 +463,18 @@
  */
 -(void) drawVerticesOfMesh: (CC3Mesh*) mesh withVisitor: (CC3NodeDrawingVisitor*) visitor;
 
+/**
+ * Draws the specified range of the vertices of the specified mesh, using the bones of this
+ * skin section, instead of the range defined by the vertexStart and vertexCount properties.
+ *
+ * This method is invoked automatically when a CC3SkinMeshNode is drawn at a level of detail
+ * other than its full mesh. Usually, the application never needs to invoke this method directly.
+ */
+-(void) drawVerticesOfMesh: (CC3Mesh*) mesh
+					  from: (GLuint) vertexStart
+				  forCount: (GLuint) vertexCount
+			   withVisitor: (CC3NodeDrawingVisitor*) visitor;
+
 /**
  * Returns the transform matrix used by the bone at the specified index to influence the 
  * vertices of the mesh in this skin section. 
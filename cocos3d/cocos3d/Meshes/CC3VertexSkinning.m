@@ -82,6 +82,7 @@
 	[_skeletalTransformMatrix release];
 	[_skeletalTransformMatrixInverted release];
 	[_deformedFaces release];
+	[_levelOfDetailSectionRanges release];
 
 	[super dealloc];
 }
@@ -153,13 +154,21 @@
 		_skeletalTransformMatrix = [CC3AffineMatrix new];			// retained
 		_skeletalTransformMatrixInverted = [CC3AffineMatrix new];	// retained
 		_deformedFaces = nil;
+		_levelOfDetailSectionRanges = nil;
 	}
 	return self;
 }
 
+// Protected property for copying
+-(NSArray*) levelOfDetailSectionRanges { return _levelOfDetailSectionRanges; }
+
 -(void) populateFrom: (CC3SkinMeshNode*) another {
 	[super populateFrom: another];
 
+	// The level of detail meshes are shared by the superclass, along with their section ranges
+	[_levelOfDetailSectionRanges release];
+	_levelOfDetailSectionRanges = [another.levelOfDetailSectionRanges mutableCopy];	// retained
+
 	// The deformedFaces instance is not copied, since the deformed faces
 	// are different for each mesh node and is created lazily if needed.
 	// The skeletal transform matrices are not copied
@@ -213,6 +222,59 @@
 -(void) boneWasTransformed: (CC3Bone*) aBone { [_deformedFaces clearDeformableCaches]; }
 
 
+#pragma mark Levels of detail
+
+-(void) generateLevelsOfDetailWithTriangleRatios: (GLfloat*) ratios
+								belowScreenSizes: (GLfloat*) screenSizes
+										   count: (GLuint) lodCount {
+	if (_mesh.drawingMode != GL_TRIANGLES) {
+		LogInfo(@"%@ cannot generate levels of detail because its mesh is not drawn with GL_TRIANGLES", self);
+		return;
+	}
+	[super generateLevelsOfDetailWithTriangleRatios: ratios belowScreenSizes: screenSizes count: lodCount];
+}
+
+/**
+ * Simplifies the mesh within each skin section, adds the simplified mesh as a level of detail,
+ * and records the start and count of the vertex indices of each skin section in that mesh.
+ */
+-(void) addLevelOfDetailWithTriangleRatio: (GLfloat) ratio belowScreenSize: (GLfloat) screenSize {
+	GLuint sectionCount = (GLuint)_skinSections.count;
+	NSMutableData* sectionRanges = [NSMutableData dataWithLength: (sectionCount * 2 * sizeof(GLuint))];
+	GLuint* sectionStarts = sectionRanges.mutableBytes;
+	GLuint* sectionCounts = sectionStarts + sectionCount;
+	GLuint sectionIdx = 0;
+	for (CC3SkinSection* skinSctn in _skinSections) {
+		sectionStarts[sectionIdx] = skinSctn.vertexStart;
+		sectionCounts[sectionIdx] = skinSctn.vertexCount;
+		sectionIdx++;
+	}
+
+	CC3Mesh* lodMesh = [_mesh meshSimplifiedToTriangleCount: (GLuint)(_mesh.faceCount * ratio)
+										  withSectionStarts: sectionStarts
+										   andSectionCounts: sectionCounts
+											   sectionCount: sectionCount];
+	if ( !lodMesh ) return;
+
+	[self addLevelOfDetailMesh: lodMesh belowScreenSize: screenSize];
+	[_levelOfDetailSectionRanges replaceObjectAtIndex: (_levelOfDetailSectionRanges.count - 1)
+										   withObject: sectionRanges];
+}
+
+/** The section ranges of a level of detail added directly are unknown, and are marked with NSNull. */
+-(void) addLevelOfDetailMesh: (CC3Mesh*) aMesh belowScreenSize: (GLfloat) screenSize {
+	[super addLevelOfDetailMesh: aMesh belowScreenSize: screenSize];
+	if ( !_levelOfDetailSectionRanges ) _levelOfDetailSectionRanges = [NSMutableArray new];	// retained
+	[_levelOfDetailSectionRanges addObject: [NSNull null]];
+}
+
+-(void) removeAllLevelsOfDetail {
+	[_levelOfDetailSectionRanges release];
+	_levelOfDetailSectionRanges = nil;
+	[super removeAllLevelsOfDetail];
+}
+
+
 #pragma mark Drawing
 
 /**
@@ -250,10 +312,31 @@
 	
 	[gl enableMatrixPalette: YES];		// Enable the matrix palette
 	
-	[_mesh bindWithVisitor: visitor];	// Bind the arrays
-	
-	for (CC3SkinSection* skinSctn in _skinSections)
-		[skinSctn drawVerticesOfMesh: _mesh withVisitor: visitor];
+	// Draw the simplified mesh if a level of detail with known skin section ranges is selected
+	GLuint lod = [self levelOfDetailForCamera: visitor.camera];
+	NSData* sectionRanges = lod ? [_levelOfDetailSectionRanges objectAtIndex: lod - 1] : nil;
+	if ( [sectionRanges isKindOfClass: [NSData class]] ) {
+		CC3Mesh* lodMesh = [self levelOfDetailMeshAt: lod];
+		[lodMesh bindWithVisitor: visitor];		// Bind the arrays
+		
+		GLuint sectionCount = (GLuint)_skinSections.count;
+		const GLuint* sectionStarts = sectionRanges.bytes;
+		const GLuint* sectionCounts = sectionStarts + sectionCount;
+		GLuint sectionIdx = 0;
+		for (CC3SkinSection* skinSctn in _skinSections) {
+			if (sectionCounts[sectionIdx])
+				[skinSctn drawVerticesOfMesh: lodMesh
+										from: sectionStarts[sectionIdx]
+									forCount: sectionCounts[sectionIdx]
+								 withVisitor: visitor];
+			sectionIdx++;
+		}
+	} else {
+		[_mesh bindWithVisitor: visitor];	// Bind the arrays
+		
+		for (CC3SkinSection* skinSctn in _skinSections)
+			[skinSctn drawVerticesOfMesh: _mesh withVisitor: visitor];
+	}
 	
 	[gl enableMatrixPalette: NO];		// We are finished with the matrix pallete so disable it.
 }
@@ -395,6 +478,13 @@
 #pragma mark Drawing
 
 -(void) drawVerticesOfMesh: (CC3Mesh*) mesh withVisitor: (CC3NodeDrawingVisitor*) visitor {
+	[self drawVerticesOfMesh: mesh from: _vertexStart forCount: _vertexCount withVisitor: visitor];
+}
+
+-(void) drawVerticesOfMesh: (CC3Mesh*) mesh
+					  from: (GLuint) vertexStart
+				  forCount: (GLuint) vertexCount
+			   withVisitor: (CC3NodeDrawingVisitor*) visitor {
 
 #if !CC3_GLSL
 	GLuint boneCnt = self.boneCount;
@@ -412,7 +502,7 @@
 #endif	// !CC3_GLSL
 
 	visitor.currentSkinSection = self;
-	[mesh drawVerticesFrom: _vertexStart forCount: _vertexCount withVisitor: visitor];
+	[mesh drawVerticesFrom: vertexStart forCount: vertexCount withVisitor: visitor];
 }
 
 -(CC3Matrix*) transformMatrixForBoneAt: (GLuint) boneIdx {
@@ -773,7 +863,10 @@
 
 @implementation CC3Node (Skinning)
 
--(CC3Vector) skeletalScale { return _parent ? CC3VectorScale(_parent.skeletalScale, _scale) : _scale; }
+-(CC3Vector) skeletalScale {
+	CC3Vector scale = self.scale;
+	return _parent ? CC3VectorScale(_parent.skeletalScale, scale) : scale;
+}
 
 -(void) bindRestPose { for (CC3Node* child in _children) [child bindRestPose]; }
 
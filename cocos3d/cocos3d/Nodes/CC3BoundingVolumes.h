@@ -465,6 +465,21 @@
  */
 @property(nonatomic, readonly) CC3Vector globalCenterOfGeometry;
 
+/**
+ * Returns the smallest axis-aligned box, in the global coordinate system, that completely
+ * encloses this bounding volume, or returns kCC3BoxNull if this bounding volume cannot be
+ * enclosed by a finite box.
+ *
+ * Because the returned box encloses this bounding volume, any other volume that is completely
+ * outside this box does not intersect this bounding volume. This allows the box to be used as
+ * a conservative stand-in for this bounding volume within spatial structures, such as the
+ * nodeBoundsTree of the CC3Scene.
+ *
+ * This implementation returns the box that encloses the global vertices of this bounding volume.
+ * Subclasses whose shape is not defined by vertices override to return an appropriate box.
+ */
+@property(nonatomic, readonly) CC3Box globalBoundingBox;
+
 /**
  * If the value of this property is set to YES, the boundary of this volume will only
  * ever expand when this bounding volume is repeatedly rebuilt from the underlying mesh
@@ -35,6 +35,10 @@
 #import "CC3Light.h"
 #import "CC3OSExtensions.h"
 
+@interface CC3Node (TemplateMethods)
+-(void) boundingVolumeDidChange;
+@end
+
 
 /**
  * A macro that invokes the logIntersection:with: method if the LOGGING_ENABLED
@@ -470,6 +474,15 @@
 	_isDirty = NO;
 	_shouldBuildFromMesh = NO;
 	[self markTransformDirty];
+	[_node boundingVolumeDidChange];
+}
+
+-(CC3Box) globalBoundingBox {
+	CC3Box gbb = kCC3BoxNull;
+	GLuint vCnt = self.vertexCount;
+	CC3Vector* vArray = self.vertices;		// Retrieve as property to force update
+	for (GLuint vIdx = 0; vIdx < vCnt; vIdx++) gbb = CC3BoxEngulfLocation(gbb, vArray[vIdx]);
+	return gbb;
 }
 
 /**
@@ -523,6 +536,11 @@
 
 -(void) scaleBy: (GLfloat) scale {}
 
+-(void) markDirty {
+	[super markDirty];
+	[_node boundingVolumeDidChange];
+}
+
 -(BOOL) isTransformDirty { return _isTransformDirty; }
 
 -(void) markTransformDirty { _isTransformDirty = YES; }
@@ -772,6 +790,7 @@
 	_isDirty = NO;
 	_shouldBuildFromMesh = NO;
 	[self markTransformDirty];
+	[_node boundingVolumeDidChange];
 }
 
 -(GLfloat) globalRadius {
@@ -788,6 +807,13 @@
 
 -(CC3Sphere) globalSphere { return CC3SphereMake(self.globalCenterOfGeometry, self.globalRadius); }
 
+-(CC3Box) globalBoundingBox {
+	CC3Vector gcog = self.globalCenterOfGeometry;
+	GLfloat gRad = self.globalRadius;
+	CC3Vector rVec = cc3v(gRad, gRad, gRad);
+	return CC3BoxFromMinMax(CC3VectorDifference(gcog, rVec), CC3VectorAdd(gcog, rVec));
+}
+
 -(void) populateFrom: (CC3NodeSphericalBoundingVolume*) another {
 	[super populateFrom: another];
 
@@ -942,6 +968,7 @@
 	_isDirty = NO;
 	_shouldBuildFromMesh = NO;
 	[self markTransformDirty];
+	[_node boundingVolumeDidChange];
 }
 
 -(void) scaleBy: (GLfloat) scale {
@@ -1165,6 +1192,17 @@
 	for (CC3NodeBoundingVolume* bv in _boundingVolumes) [bv transformVolume];
 }
 
+/** Returns the box that encloses all of the contained bounding volumes. */
+-(CC3Box) globalBoundingBox {
+	CC3Box gbb = kCC3BoxNull;
+	for (CC3NodeBoundingVolume* bv in _boundingVolumes) {
+		CC3Box bvgbb = bv.globalBoundingBox;
+		if (CC3BoxIsNull(bvgbb)) return kCC3BoxNull;	// Unbounded member
+		gbb = CC3BoxUnion(gbb, bvgbb);
+	}
+	return gbb;
+}
+
 -(NSString*) description {
 	if (_boundingVolumes.count == 0)
 		return [NSString stringWithFormat: @"%@ containing nothing", [self class]];
@@ -1327,6 +1365,13 @@
 	[_boxBoundingVolume transformVolume];
 }
 
+/** Returns the box that encloses both the sphere and the box. */
+-(CC3Box) globalBoundingBox {
+	CC3Box sgbb = _sphericalBoundingVolume ? _sphericalBoundingVolume.globalBoundingBox : kCC3BoxNull;
+	CC3Box bgbb = _boxBoundingVolume ? _boxBoundingVolume.globalBoundingBox : kCC3BoxNull;
+	return CC3BoxUnion(sgbb, bgbb);
+}
+
 
 #pragma mark Intersection testing
 
@@ -1460,6 +1505,9 @@
 
 @implementation CC3NodeBoundingArea
 
+/** A 2D bounding area has no extent in the 3D scene. */
+-(CC3Box) globalBoundingBox { return kCC3BoxNull; }
+
 
 #pragma mark Drawing
 
@@ -1492,6 +1540,9 @@
 
 -(BOOL) isInFrontOfPlane: (CC3Plane) aPlane { return NO; }
 
+/** An infinite volume cannot be enclosed by a finite box. */
+-(CC3Box) globalBoundingBox { return kCC3BoxNull; }
+
 -(BOOL) doesIntersectSphere: (CC3Sphere) aSphere
 					   from: (CC3BoundingVolume*) otherBoundingVolume { return YES; }
 
@@ -1533,6 +1584,9 @@
 
 -(BOOL) isInFrontOfPlane: (CC3Plane) aPlane { return YES; }
 
+/** A null volume has no extent. */
+-(CC3Box) globalBoundingBox { return kCC3BoxNull; }
+
 -(BOOL) doesIntersectSphere: (CC3Sphere) aSphere
 					   from: (CC3BoundingVolume*) otherBoundingVolume { return NO; }
 
@@ -45,6 +45,7 @@
 @interface CC3Node (TemplateMethods)
 -(void) notifyTransformListeners;
 -(void) setProjectedLocation: (CC3Vector) projectedLocation;
+@property(nonatomic, assign) CC3Vector storedScale;
 @end
 
 @implementation CC3Camera
@@ -143,7 +144,7 @@
 // globalTransformMatrix. This is because for a camera, scale acts as a zoom to change
 // the effective FOV, which is a projection quality, not a transformation quality.
 -(void) setScale: (CC3Vector) aScale {
-	_scale = aScale;
+	self.storedScale = aScale;
 	[self markProjectionDirty];
 }
 
@@ -178,6 +179,7 @@
 		_shouldClipToViewport = NO;
 		_hasInfiniteDepthOfField = NO;
 		_isOpen = NO;
+		_isUpdateThreadSafe = NO;		// Camera updates touch the scene and its viewport
 	}
 	return self;
 }
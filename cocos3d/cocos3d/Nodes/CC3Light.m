@@ -163,6 +163,7 @@
 		_isDirectionalOnly = YES;
 		_shouldCopyLightIndex = NO;
 		_shouldCastShadowsWhenInvisible = NO;
+		_isUpdateThreadSafe = NO;		// Light updates touch the shadows across the scene
 	}
 	return self;
 }
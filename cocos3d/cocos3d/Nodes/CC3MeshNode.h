@@ -93,12 +93,15 @@
 	CC3Mesh* _mesh;
 	CC3Material* _material;
 	CC3ShaderContext* _shaderContext;
+	NSMutableArray* _levelOfDetailMeshes;
+	NSMutableArray* _levelOfDetailScreenSizes;
 	char* _renderStreamGroupMarker;
 	GLenum _depthFunction;
 	GLfloat _decalOffsetFactor;
 	GLfloat _decalOffsetUnits;
 	GLfloat _lineWidth;
 	GLenum _lineSmoothingHint;
+	GLuint _levelOfDetail;
 	CC3NormalScaling _normalScalingMethod : 4;
 	BOOL _shouldUseLightProbes : 1;
 	BOOL _shouldSmoothLines : 1;
@@ -1834,6 +1837,120 @@ globalIntersections: (CC3MeshIntersection*) intersections
 	acceptBackFaces: (BOOL) acceptBackFaces
 	acceptBehindRay: (BOOL) acceptBehind;
 
+/**
+ * Finds the intersection of the specified ray and the mesh of this node that is closest to the
+ * startLocation of the ray, populates the specified intersection with information about it, and
+ * returns YES. If the ray does not intersect the mesh, or this node has no mesh, returns NO.
+ *
+ * The ray, and the location and distance components of the intersection, are specified in the
+ * local coordinate system of this node.
+ *
+ * See the notes for the findNearestIntersection:ofLocalRay:acceptBackFaces:acceptBehindRay:
+ * method of CC3Mesh to understand more about how to use this method.
+ */
+-(BOOL) findNearestIntersection: (CC3MeshIntersection*) intersection
+					 ofLocalRay: (CC3Ray) aRay
+				acceptBackFaces: (BOOL) acceptBackFaces
+				acceptBehindRay: (BOOL) acceptBehind;
+
+/**
+ * Finds the intersection of the specified ray and the mesh of this node that is closest to the
+ * startLocation of the ray, populates the specified intersection with information about it, and
+ * returns YES. If the ray does not intersect the mesh, or this node has no mesh, returns NO.
+ *
+ * This is a convenience method that converts the specified global ray to the local coordinate
+ * system of this node, invokes the findNearestIntersection:ofLocalRay:acceptBackFaces:acceptBehindRay:
+ * method, and converts the location and distance components of the intersection to the global
+ * coordinate system.
+ */
+-(BOOL) findNearestGlobalIntersection: (CC3MeshIntersection*) intersection
+						  ofGlobalRay: (CC3Ray) aRay
+					  acceptBackFaces: (BOOL) acceptBackFaces
+					  acceptBehindRay: (BOOL) acceptBehind;
+
+
+#pragma mark Levels of detail
+
+/**
+ * Adds a mesh to be drawn in place of the mesh in the mesh property, when this node appears
+ * smaller on the screen than the specified screen size, as returned by the screenSizeFromCamera:
+ * method. The added mesh is usually a simplified version of the mesh in the mesh property, that
+ * shares its vertex content, such as a mesh returned by the meshSimplifiedToTriangleRatio: method.
+ *
+ * Levels of detail must be added in order of decreasing screen size. The vertex attributes are
+ * bound from the mesh in the mesh property, and only the vertex indices of the added mesh are used
+ * to draw the added mesh, so the added mesh must share the vertex arrays of that mesh.
+ *
+ * Setting the mesh property removes all levels of detail.
+ */
+-(void) addLevelOfDetailMesh: (CC3Mesh*) aMesh belowScreenSize: (GLfloat) screenSize;
+
+/**
+ * Generates lodCount simplified versions of the mesh in the mesh property, each using
+ * approximately the fraction of the triangles of the mesh that is specified in the corresponding
+ * element of the ratios array, and adds each as a level of detail, to be drawn when this node
+ * appears smaller on the screen than the corresponding element of the screenSizes array.
+ *
+ * Each of the ratios and screenSizes arrays must contain lodCount elements, in decreasing order.
+ *
+ * The simplified meshes share the vertex content of the mesh in the mesh property. The vertex
+ * content of the mesh must be available in application memory, so this method must be invoked
+ * before the releaseRedundantContent method is invoked on this node. See the notes of the
+ * CC3Mesh meshSimplifiedToTriangleCount:withSectionStarts:andSectionCounts:sectionCount:
+ * method for more information about how each mesh is simplified.
+ */
+-(void) generateLevelsOfDetailWithTriangleRatios: (GLfloat*) ratios
+								belowScreenSizes: (GLfloat*) screenSizes
+										   count: (GLuint) lodCount;
+
+/** Removes all levels of detail from this node, so that the mesh in the mesh property is always drawn. */
+-(void) removeAllLevelsOfDetail;
+
+/**
+ * Returns the number of levels of detail of this node, including the mesh in the mesh property.
+ *
+ * Returns one if no levels of detail have been added, or zero if this node has no mesh.
+ */
+@property(nonatomic, readonly) GLuint levelOfDetailCount;
+
+/**
+ * Returns the mesh drawn at the specified level of detail. Level zero is the mesh in the mesh
+ * property, and each higher level is the mesh added by the corresponding invocation of the
+ * addLevelOfDetailMesh:belowScreenSize: method.
+ */
+-(CC3Mesh*) levelOfDetailMeshAt: (GLuint) lodIndex;
+
+/**
+ * Returns the screen size below which the specified level of detail is drawn, as specified
+ * when the level of detail was added. Level zero, the mesh in the mesh property, returns
+ * kCC3MaxGLfloat.
+ */
+-(GLfloat) levelOfDetailScreenSizeAt: (GLuint) lodIndex;
+
+/**
+ * Returns the level of detail at which this node was most recently drawn,
+ * as selected by the levelOfDetailForCamera: method.
+ */
+@property(nonatomic, readonly) GLuint levelOfDetail;
+
+/**
+ * Returns the size of this node on the screen, when viewed from the specified camera, as a
+ * fraction of the height of the viewport, estimated from the projected diameter of a sphere
+ * that surrounds the globalLocalContentBoundingBox of this node.
+ *
+ * The returned value can exceed one if this node fills the viewport.
+ */
+-(GLfloat) screenSizeFromCamera: (CC3Camera*) camera;
+
+/**
+ * Returns the level of detail at which this node should be drawn when viewed from the specified
+ * camera, which is the highest level of detail whose screen size is larger than the value returned
+ * by the screenSizeFromCamera: method, or zero if this node has no levels of detail, or camera is nil.
+ *
+ * This method is invoked automatically when this node is drawn.
+ */
+-(GLuint) levelOfDetailForCamera: (CC3Camera*) camera;
+
 
 #pragma mark Drawing
 
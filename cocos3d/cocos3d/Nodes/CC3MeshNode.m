@@ -33,6 +33,7 @@
 #import "CC3BoundingVolumes.h"
 #import "CC3Mesh.h"
 #import "CC3Light.h"
+#import "CC3Camera.h"
 #import "CC3ShaderMatcher.h"
 #import "CC3UtilityMeshNodes.h"
 #import "CC3OSExtensions.h"
@@ -59,6 +60,8 @@
 	[_mesh release];
 	[_material release];
 	[_shaderContext release];
+	[_levelOfDetailMeshes release];
+	[_levelOfDetailScreenSizes release];
 	[self deleteRenderStreamGroupMarker];
 	
 	[super dealloc];
@@ -79,6 +82,7 @@
 	_mesh = [aMesh retain];
 	
 	[_mesh deriveNameFrom: self];
+	[self removeAllLevelsOfDetail];
 	[self alignMaterialAndMesh];
 	[self markBoundingVolumeDirty];
 }
@@ -561,6 +565,9 @@
 		_mesh = nil;
 		_material = nil;
 		_shaderContext = nil;
+		_levelOfDetailMeshes = nil;
+		_levelOfDetailScreenSizes = nil;
+		_levelOfDetail = 0;
 		_renderStreamGroupMarker = NULL;
 		_shouldUseLightProbes = NO;
 		_shouldUseSmoothShading = YES;
@@ -594,6 +601,13 @@
 	[_shaderContext release];
 	_shaderContext = [another.shaderContext copy];	// retained
 	
+	// Level of detail meshes are shared between original and copy
+	[self removeAllLevelsOfDetail];
+	GLuint lodCount = another.levelOfDetailCount;
+	for (GLuint lodIdx = 1; lodIdx < lodCount; lodIdx++)
+		[self addLevelOfDetailMesh: [another levelOfDetailMeshAt: lodIdx]
+				   belowScreenSize: [another levelOfDetailScreenSizeAt: lodIdx]];
+	
 	_shouldUseSmoothShading = another.shouldUseSmoothShading;
 	_shouldCullBackFaces = another.shouldCullBackFaces;
 	_shouldCullFrontFaces = another.shouldCullFrontFaces;
@@ -612,11 +626,13 @@
 -(void) createGLBuffers {
 	LogTrace(@"%@ creating GL server buffers", self);
 	[_mesh createGLBuffers];
+	for (CC3Mesh* lodMesh in _levelOfDetailMeshes) [lodMesh createGLBuffers];
 	[super createGLBuffers];
 }
 
 -(void) deleteGLBuffers {
 	[_mesh deleteGLBuffers];
+	for (CC3Mesh* lodMesh in _levelOfDetailMeshes) [lodMesh deleteGLBuffers];
 	[super deleteGLBuffers];
 }
 
@@ -624,11 +640,13 @@
 
 -(void) releaseRedundantContent {
 	[_mesh releaseRedundantContent];
+	for (CC3Mesh* lodMesh in _levelOfDetailMeshes) [lodMesh releaseRedundantContent];
 	[super releaseRedundantContent];
 }
 
 -(void) retainVertexContent {
 	[_mesh retainVertexContent];
+	for (CC3Mesh* lodMesh in _levelOfDetailMeshes) [lodMesh retainVertexContent];
 	[super retainVertexContent];
 }
 
@@ -909,8 +927,80 @@
 	[visitor.currentShaderProgram bindWithVisitor: visitor];
 }
 
-/** Template method to draw the mesh to the GL engine. */
--(void) drawMeshWithVisitor: (CC3NodeDrawingVisitor*) visitor { [_mesh drawWithVisitor: visitor]; }
+/** Template method to draw the mesh, at the level of detail selected by the camera, to the GL engine. */
+-(void) drawMeshWithVisitor: (CC3NodeDrawingVisitor*) visitor {
+	[[self levelOfDetailMeshAt: [self levelOfDetailForCamera: visitor.camera]] drawWithVisitor: visitor];
+}
+
+
+#pragma mark Levels of detail
+
+-(void) addLevelOfDetailMesh: (CC3Mesh*) aMesh belowScreenSize: (GLfloat) screenSize {
+	CC3Assert(aMesh, @"%@ cannot add a nil level of detail mesh", self);
+	CC3Assert(!_levelOfDetailScreenSizes || screenSize < [_levelOfDetailScreenSizes.lastObject floatValue],
+			  @"%@ levels of detail must be added in order of decreasing screen size", self);
+	if ( !_levelOfDetailMeshes ) _levelOfDetailMeshes = [NSMutableArray new];				// retained
+	if ( !_levelOfDetailScreenSizes ) _levelOfDetailScreenSizes = [NSMutableArray new];		// retained
+	[_levelOfDetailMeshes addObject: aMesh];
+	[_levelOfDetailScreenSizes addObject: [NSNumber numberWithFloat: screenSize]];
+}
+
+-(void) generateLevelsOfDetailWithTriangleRatios: (GLfloat*) ratios
+								belowScreenSizes: (GLfloat*) screenSizes
+										   count: (GLuint) lodCount {
+	for (GLuint lodIdx = 0; lodIdx < lodCount; lodIdx++)
+		[self addLevelOfDetailWithTriangleRatio: ratios[lodIdx] belowScreenSize: screenSizes[lodIdx]];
+}
+
+/** Template method that simplifies the mesh to the specified ratio and adds it as a level of detail. */
+-(void) addLevelOfDetailWithTriangleRatio: (GLfloat) ratio belowScreenSize: (GLfloat) screenSize {
+	CC3Mesh* lodMesh = [_mesh meshSimplifiedToTriangleRatio: ratio];
+	if (lodMesh) [self addLevelOfDetailMesh: lodMesh belowScreenSize: screenSize];
+}
+
+-(void) removeAllLevelsOfDetail {
+	[_levelOfDetailMeshes release];
+	_levelOfDetailMeshes = nil;
+	[_levelOfDetailScreenSizes release];
+	_levelOfDetailScreenSizes = nil;
+	_levelOfDetail = 0;
+}
+
+-(GLuint) levelOfDetailCount { return _mesh ? (GLuint)_levelOfDetailMeshes.count + 1 : 0; }
+
+-(CC3Mesh*) levelOfDetailMeshAt: (GLuint) lodIndex {
+	return lodIndex ? [_levelOfDetailMeshes objectAtIndex: lodIndex - 1] : _mesh;
+}
+
+-(GLfloat) levelOfDetailScreenSizeAt: (GLuint) lodIndex {
+	return lodIndex ? [[_levelOfDetailScreenSizes objectAtIndex: lodIndex - 1] floatValue] : kCC3MaxGLfloat;
+}
+
+-(GLuint) levelOfDetail { return _levelOfDetail; }
+
+-(GLfloat) screenSizeFromCamera: (CC3Camera*) camera {
+	CC3Box bb = self.globalLocalContentBoundingBox;
+	if (CC3BoxIsNull(bb)) return kCC3MaxGLfloat;
+
+	CC3Frustum* frustum = camera.frustum;
+	GLfloat radius = CC3VectorLength(CC3BoxSize(bb)) * 0.5f;
+	if (camera.isUsingParallelProjection) return radius / frustum.top;
+
+	GLfloat distance = CC3VectorDistance(CC3BoxCenter(bb), camera.globalLocation);
+	if (distance <= radius) return kCC3MaxGLfloat;		// Camera is inside the node
+	return (radius * frustum.near) / (distance * frustum.top);
+}
+
+-(GLuint) levelOfDetailForCamera: (CC3Camera*) camera {
+	GLuint lodCount = (GLuint)_levelOfDetailScreenSizes.count;
+	GLuint lod = 0;
+	if (lodCount && camera) {
+		GLfloat screenSize = [self screenSizeFromCamera: camera];
+		while (lod < lodCount && screenSize < [[_levelOfDetailScreenSizes objectAtIndex: lod] floatValue]) lod++;
+	}
+	_levelOfDetail = lod;
+	return lod;
+}
 
 
 #pragma mark Vertex management
@@ -1215,6 +1305,33 @@ globalIntersections: (CC3MeshIntersection*) intersections
 	return hitCount;
 }
 
+-(BOOL) findNearestIntersection: (CC3MeshIntersection*) intersection
+					 ofLocalRay: (CC3Ray) aRay
+				acceptBackFaces: (BOOL) acceptBackFaces
+				acceptBehindRay: (BOOL) acceptBehind {
+	if ( !_mesh ) return NO;
+	return [_mesh findNearestIntersection: intersection
+							   ofLocalRay: aRay
+						  acceptBackFaces: acceptBackFaces
+						  acceptBehindRay: acceptBehind];
+}
+
+-(BOOL) findNearestGlobalIntersection: (CC3MeshIntersection*) intersection
+						  ofGlobalRay: (CC3Ray) aRay
+					  acceptBackFaces: (BOOL) acceptBackFaces
+					  acceptBehindRay: (BOOL) acceptBehind {
+	CC3Ray localRay = [self.globalTransformMatrixInverted transformRay: aRay];
+	if ( ![self findNearestIntersection: intersection
+							 ofLocalRay: localRay
+						acceptBackFaces: acceptBackFaces
+						acceptBehindRay: acceptBehind] ) return NO;
+
+	// Convert the intersection to global coordinates.
+	intersection->location = [self.globalTransformMatrix transformLocation: intersection->location];
+	intersection->distance = CC3VectorDistance(intersection->location, aRay.startLocation);
+	return YES;
+}
+
 -(GLuint) vertexUnitCount { return self.vertexBoneCount; }
 
 -(GLfloat) vertexWeightForVertexUnit: (GLuint) vertexUnit at: (GLuint) index {
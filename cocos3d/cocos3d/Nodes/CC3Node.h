@@ -40,7 +40,7 @@
 #import "CC3NodeListeners.h"
 
 @class CC3NodeDrawingVisitor, CC3Scene, CC3Camera, CC3Frustum, CC3Texture;
-@class CC3NodeDescriptor, CC3WireframeBoundingBoxNode;
+@class CC3NodeDescriptor, CC3WireframeBoundingBoxNode, CC3NodeTransformStore;
 
 
 /**
@@ -191,12 +191,15 @@ typedef enum {
 	CC3Rotator* _rotator;
 	CC3NodeBoundingVolume* _boundingVolume;
 	CC3NodeTransformListeners* _transformListeners;
+	CC3NodeTransformStore* _transformStore;	// weak reference
 	NSMutableArray* _animationStates;		// used by Animation category extension
 	CC3Vector _location;
 	CC3Vector _projectedLocation;
 	CC3Vector _scale;
 	GLfloat _boundingVolumePadding;
 	GLfloat _cameraDistanceProduct;
+	GLuint _transformSlot;
+	GLint _boundsTreeLeaf;
 	BOOL _touchEnabled : 1;
 	BOOL _shouldInheritTouchability : 1;
 	BOOL _shouldAllowTouchableWhenInvisible : 1;
@@ -210,12 +213,18 @@ typedef enum {
 	BOOL _cascadeOpacityEnabled : 1;
 	BOOL _isBeingAdded : 1;
 	BOOL _shouldCastShadows : 1;	// Used by subclasses - held here for conciseness
+	BOOL _isUpdateThreadSafe : 1;
+	BOOL _isSubtreeUpdateThreadSafe : 1;
+	BOOL _isSubtreeThreadSafetyDirty : 1;
 }
 
 /**
  * The location of the node in 3D space, relative to the parent of this node. The global
  * location of the node is therefore a combination of the global location of the parent
  * of this node and the value of this location property.
+ *
+ * While this node is part of a scene, the value of this property is held in the
+ * transformStore of the scene, rather than in this node.
  */
 @property(nonatomic, assign) CC3Vector location;
 
@@ -2412,6 +2421,42 @@ typedef enum {
  */
 -(void) updateAfterTransform: (CC3NodeUpdatingVisitor*) visitor;
 
+/**
+ * Indicates whether the updateBeforeTransform: and updateAfterTransform: methods of this
+ * node may be invoked on a background thread, concurrently with the updating of nodes that
+ * are in other branches of the scene.
+ *
+ * When the shouldUpdateConcurrently property of the CC3NodeUpdatingVisitor is set to YES,
+ * the visitor updates independent child subtrees of the scene concurrently on background
+ * threads. A subtree is only updated concurrently if this property is set to YES for every
+ * node in the subtree, and none of the nodes in the subtree is tracking a target. Other
+ * subtrees are updated on the thread that is updating the scene, once all of the concurrent
+ * subtree updates are complete.
+ *
+ * An update method that only changes the state of the node itself, or of its descendants,
+ * is thread-safe. If your update methods add or remove nodes from the scene, change the state
+ * of nodes in other branches of the scene, or access other shared state, set this property
+ * to NO. To remove nodes during updating, use the requestRemovalOf: method of the visitor,
+ * which is thread-safe under concurrent updating. Transform listeners of the nodes in a
+ * concurrent subtree are notified on the thread that is updating the scene, once all of
+ * the concurrent subtree updates are complete.
+ *
+ * The initial value of this property is YES, except in CC3Camera and CC3Light, where it is NO.
+ */
+@property(nonatomic, assign) BOOL isUpdateThreadSafe;
+
+/**
+ * Returns whether this node, and all of its descendants, may be updated on a background thread,
+ * concurrently with the nodes in other branches of the scene.
+ *
+ * This property returns YES if the isUpdateThreadSafe property is set to YES for this node and
+ * every descendant, and none of them is tracking a target.
+ *
+ * The value is cached, and is only determined again once the isUpdateThreadSafe property or
+ * rotator of this node or a descendant has changed, or a descendant has been added or removed.
+ */
+@property(nonatomic, readonly) BOOL isSubtreeUpdateThreadSafe;
+
 /** @deprecated No longer needed. Does nothing. */
 -(void) trackTargetWithVisitor: (id) visitor __deprecated;
 
@@ -2596,6 +2641,22 @@ typedef enum {
  */
 @property(nonatomic, readonly) BOOL isTransformDirty;
 
+/**
+ * The transform store that holds the location, scale and globalTransformMatrix of this node
+ * in contiguous arrays, alongside those of all other nodes in the same scene.
+ *
+ * This property is set automatically when this node is added to a scene, and is cleared
+ * when this node is removed from the scene. While this property is set, the location and
+ * scale properties and the globalTransformMatrix of this node are views into the arrays of
+ * the transform store, the transform store tracks whether the transform of this node is dirty,
+ * and the globalTransformMatrix of this node is rebuilt by the transform store during each
+ * update of the scene, in a single linear pass over all nodes whose transforms are dirty.
+ *
+ * The value of this property is nil while this node is not part of a scene. In that case,
+ * the location, scale and globalTransformMatrix are held within this node itself.
+ */
+@property(nonatomic, readonly) CC3NodeTransformStore* transformStore;
+
 /**
  * Marks that the globalTransformMatrix of this node is dirty and requires recalculation.
  *
@@ -3557,10 +3618,11 @@ typedef enum {
  * instance of CC3NodePuncturingVisitor, cache it, and invoke the visit: method
  * repeatedly, with or without changing the ray between invocations.
  *
- * This implementation simply invokes the nodesIntersectedByGlobalRay:
- * method, and reads the value of the closestPuncturedNode from the
- * CC3NodePuncturingVisitor returned by that method. See the notes
- * of the nodesIntersectedByGlobalRay: method for more info.
+ * This implementation creates an instance of CC3NodePuncturingVisitor on the specified
+ * ray, with the shouldFindClosestOnly property set to YES, invokes the visit: method on that
+ * visitor, passing this node as the starting point of the visitation, and returns the value of
+ * the closestPuncturedNode property of the visitor. See the notes of the
+ * nodesIntersectedByGlobalRay: method for more info.
  */
 -(CC3Node*) closestNodeIntersectedByGlobalRay: (CC3Ray) aRay;
 
@@ -50,11 +50,22 @@
 -(void) updateFromAnimationState;
 @end
 
+@interface CC3Node (TransformStore)
+@property(nonatomic, assign) CC3Vector storedLocation;
+@property(nonatomic, assign) CC3Vector storedScale;
+@property(nonatomic, readonly) BOOL hasStandardLocalTransforms;
+-(void) updateTransformStoreSlot;
+@end
+
+@interface CC3Node (Updating_Private)
+-(void) markSubtreeThreadSafetyDirty;
+@end
+
 
 @implementation CC3Node
 
 @synthesize parent=_parent, children=_children;
-@synthesize rotator=_rotator, location=_location, scale=_scale;
+@synthesize transformStore=_transformStore;
 @synthesize visible=_visible, isRunning=_isRunning;
 @synthesize boundingVolume=_boundingVolume, boundingVolumePadding=_boundingVolumePadding;
 @synthesize shouldInheritTouchability=_shouldInheritTouchability;
@@ -83,9 +94,11 @@
 	[super dealloc];
 }
 
+-(CC3Vector) location { return self.storedLocation; }
+
 // If tracking target, set the location anyway
 -(void) setLocation: (CC3Vector) aLocation {
-	_location = aLocation;
+	self.storedLocation = aLocation;
 	[self markTransformDirty];
 }
 
@@ -205,22 +218,31 @@
 
 -(CC3Vector) globalRightDirection { return [self.globalRotationMatrix extractRightDirection]; }
 
+-(CC3Vector) scale { return self.storedScale; }
+
 -(void) setScale: (CC3Vector) aScale {
-	_scale = aScale;
+	self.storedScale = aScale;
 	[self markTransformDirty];
 }
 
 -(GLfloat) uniformScale {
+	CC3Vector scale = self.storedScale;
 	return (self.isUniformlyScaledLocally)
-					? _scale.x 
-					: CC3VectorLength(_scale) / kCC3VectorUnitCubeLength;
+					? scale.x 
+					: CC3VectorLength(scale) / kCC3VectorUnitCubeLength;
 }
 
 -(void) setUniformScale:(GLfloat) aValue { self.scale = cc3v(aValue, aValue, aValue); }
 
--(BOOL) isUniformlyScaledLocally { return (_scale.x == _scale.y) && (_scale.x == _scale.z); }
+-(BOOL) isUniformlyScaledLocally {
+	CC3Vector scale = self.storedScale;
+	return (scale.x == scale.y) && (scale.x == scale.z);
+}
 
--(CC3Vector) globalScale { return _parent ? CC3VectorScale(_parent.globalScale, _scale) : _scale; }
+-(CC3Vector) globalScale {
+	CC3Vector scale = self.storedScale;
+	return _parent ? CC3VectorScale(_parent.globalScale, scale) : scale;
+}
 
 -(BOOL) isUniformlyScaledGlobally {
 	return self.isUniformlyScaledLocally && (_parent ? _parent.isUniformlyScaledGlobally : YES);
@@ -339,6 +361,18 @@
 
 #pragma mark Rotator
 
+-(CC3Rotator*) rotator { return _rotator; }
+
+-(void) setRotator: (CC3Rotator*) aRotator {
+	if (aRotator == _rotator) return;
+
+	[_rotator release];
+	_rotator = [aRotator retain];
+
+	[self updateTransformStoreSlot];
+	[self markSubtreeThreadSafetyDirty];		// Targettable rotators are not thread-safe
+}
+
 /**
  * Returns the rotator property, cast as a CC3MutableRotator.
  *
@@ -984,6 +1018,9 @@
 		_globalRotationMatrix = nil;
 		_rotator = [CC3Rotator new];						// retained
 		_transformListeners = nil;
+		_transformStore = nil;
+		_transformSlot = 0;
+		_boundsTreeLeaf = -1;
 		_animationStates = nil;
 		_isAnimationDirty = NO;
 		_boundingVolume = nil;
@@ -1003,6 +1040,9 @@
 		_cascadeColorEnabled = YES;
 		_cascadeOpacityEnabled = YES;
 		_shouldCastShadows = YES;
+		_isUpdateThreadSafe = YES;
+		_isSubtreeUpdateThreadSafe = NO;
+		_isSubtreeThreadSafetyDirty = YES;
 		_isBeingAdded = NO;
 	}
 	return self;
@@ -1042,9 +1082,9 @@
 	[super populateFrom: another];
 	
 	// Transform matrices are not copied, but are built from copied transform properties
-	_location = another.location;
+	self.storedLocation = another.location;
 	_projectedLocation = another.projectedLocation;
-	_scale = another.scale;
+	self.storedScale = another.scale;
 	[self markTransformDirty];
 
 	[_rotator release];
@@ -1073,6 +1113,7 @@
 	_cascadeOpacityEnabled = another.isCascadeOpacityEnabled;
 	_cameraDistanceProduct = another.cameraDistanceProduct;
 	_shouldCastShadows = another.shouldCastShadows;
+	self.isUpdateThreadSafe = another.isUpdateThreadSafe;		// Also covers copied rotator
 	
 	self.shouldDrawDescriptor = another.shouldDrawDescriptor;		// May create a child node
 	self.shouldDrawWireframeBox = another.shouldDrawWireframeBox;	// May create a child node
@@ -1273,6 +1314,37 @@ static GLuint lastAssignedNodeTag;
 	[self updateAfterChildren: visitor];
 }
 
+-(BOOL) isUpdateThreadSafe { return _isUpdateThreadSafe; }
+
+-(void) setIsUpdateThreadSafe: (BOOL) isThreadSafe {
+	_isUpdateThreadSafe = isThreadSafe;
+	[self markSubtreeThreadSafetyDirty];
+}
+
+/**
+ * Every child is checked, even once the result is known, so that the cached value of every
+ * descendant is current whenever the cached value of this node is current.
+ */
+-(BOOL) isSubtreeUpdateThreadSafe {
+	if (_isSubtreeThreadSafetyDirty) {
+		BOOL isThreadSafe = _isUpdateThreadSafe && !_rotator.isTargettable;
+		for (CC3Node* child in _children) isThreadSafe = child.isSubtreeUpdateThreadSafe && isThreadSafe;
+		_isSubtreeUpdateThreadSafe = isThreadSafe;
+		_isSubtreeThreadSafetyDirty = NO;
+	}
+	return _isSubtreeUpdateThreadSafe;
+}
+
+/**
+ * Marks the cached isSubtreeUpdateThreadSafe value of this node and its ancestors as needing
+ * to be determined again. If this node is already marked, so are all of its ancestors.
+ */
+-(void) markSubtreeThreadSafetyDirty {
+	if (_isSubtreeThreadSafetyDirty) return;
+	_isSubtreeThreadSafetyDirty = YES;
+	[_parent markSubtreeThreadSafetyDirty];
+}
+
 
 #pragma mark Transformations
 
@@ -1287,6 +1359,8 @@ static GLuint lastAssignedNodeTag;
 	if( !_transformListeners ) _transformListeners = [[CC3NodeTransformListeners listenersForNode: self] retain];
 	[_transformListeners addTransformListener: aListener];
 	
+	[self updateTransformStoreSlot];
+
 	// Notify immediately, to ensure the listener is aware of current state.
 	[aListener nodeWasTransformed: self];
 }
@@ -1298,9 +1372,13 @@ static GLuint lastAssignedNodeTag;
 		[_transformListeners release];
 		_transformListeners = nil;
 	}
+	[self updateTransformStoreSlot];
 }
 
--(void) removeAllTransformListeners { [_transformListeners removeAllTransformListeners]; }
+-(void) removeAllTransformListeners {
+	[_transformListeners removeAllTransformListeners];
+	[self updateTransformStoreSlot];
+}
 
 -(void) notifyTransformListeners { [_transformListeners notifyTransformListeners]; }
 
@@ -1319,13 +1397,23 @@ static GLuint lastAssignedNodeTag;
 
 -(BOOL) shouldUpdateToTarget { return _rotator.shouldUpdateToTarget; }
 
--(BOOL) isTransformDirty { return _globalTransformMatrix.isDirty; }
+-(BOOL) isTransformDirty {
+	return _transformStore ? [_transformStore isTransformDirtyAt: _transformSlot] : _globalTransformMatrix.isDirty;
+}
 
 -(void) markTransformDirty {
 	
 	// Mark the local matrix as dirty always, since it is independent of the globalTransformMatrix
 	_localTransformMatrix.isDirty = YES;
 
+	// If held in a transform store, copy the possibly changed rotation into the store, and let
+	// the store mark this node and its descendants dirty, by marking the range of their slots.
+	if (_transformStore) {
+		if (self.hasStandardLocalTransforms) [_transformStore setRotation: _rotator.rotationMatrix at: _transformSlot];
+		[_transformStore markTransformDirtyAt: _transformSlot];
+		return;
+	}
+
 	// All other transform activity is global, and is dependent on the globalTransformMatrix,
 	// so don't continue if it is already dirty, including marking descendants.
 	if (_globalTransformMatrix.isDirty) return;
@@ -1363,12 +1451,16 @@ static GLuint lastAssignedNodeTag;
 	
 	// Changing this matrix affects all other matrices, but be sure to mark this matrix
 	// as NOT dirty, so it won't get rebuilt from the transform properties.
+	[self updateTransformStoreSlot];
 	[self markTransformDirty];
 	_localTransformMatrix.isDirty = NO;
 }
 
 -(CC3Matrix*) globalTransformMatrix {
-	if (_globalTransformMatrix.isDirty) [self buildGlobalTransformMatrix];
+	if (_transformStore)
+		[_transformStore validateTransformAt: _transformSlot];
+	else if (_globalTransformMatrix.isDirty)
+		[self buildGlobalTransformMatrix];
 	return _globalTransformMatrix;
 }
 
@@ -1396,7 +1488,7 @@ static GLuint lastAssignedNodeTag;
 }
 
 /** Template method that applies the local location property to the transform matrix. */
--(void) applyTranslationTo: (CC3Matrix*) matrix { [matrix translateBy: _location]; }
+-(void) applyTranslationTo: (CC3Matrix*) matrix { [matrix translateBy: self.storedLocation]; }
 
 /**
  * Template method that applies the rotation in the rotator to the specified matrix.
@@ -1533,7 +1625,7 @@ static GLuint lastAssignedNodeTag;
 -(void) applyRotatorTo: (CC3Matrix*) matrix { [_rotator applyRotationTo: matrix]; }
 
 /** Template method that applies the local scale property to the specified matrix. */
--(void) applyScalingTo: (CC3Matrix*) matrix { [matrix scaleBy: CC3EnsureMinScaleVector(_scale)]; }
+-(void) applyScalingTo: (CC3Matrix*) matrix { [matrix scaleBy: CC3EnsureMinScaleVector(self.storedScale)]; }
 
 /**
  * Returns the inverse of the globalTransformMatrix.
@@ -1542,6 +1634,7 @@ static GLuint lastAssignedNodeTag;
  * it is only calculated when the globalTransformMatrix has changed, and then only on demand.
  */
 -(CC3Matrix*) globalTransformMatrixInverted {
+	if (_transformStore) [_transformStore validateTransformAt: _transformSlot];
 	if (!_globalTransformMatrixInverted) {
 		_globalTransformMatrixInverted = [CC3AffineMatrix new];		// retained
 		_globalTransformMatrixInverted.isDirty = YES;
@@ -1574,6 +1667,7 @@ static GLuint lastAssignedNodeTag;
  * and is cached until it is marked dirty again.
  */
 -(CC3Matrix*) globalRotationMatrix {
+	if (_transformStore) [_transformStore validateTransformAt: _transformSlot];
 	if (!_globalRotationMatrix) {
 		_globalRotationMatrix = [CC3LinearMatrix new];		// retained
 		_globalRotationMatrix.isDirty = YES;
@@ -1608,6 +1702,201 @@ static GLuint lastAssignedNodeTag;
 -(void) buildTransformMatrixWithVisitor: (id) visitor {}
 
 
+#pragma mark Transform store
+
+-(CC3Vector) storedLocation {
+	return _transformStore ? [_transformStore locationAt: _transformSlot] : _location;
+}
+
+-(void) setStoredLocation: (CC3Vector) aLocation {
+	if (_transformStore)
+		[_transformStore setLocation: aLocation at: _transformSlot];
+	else
+		_location = aLocation;
+}
+
+-(CC3Vector) storedScale {
+	return _transformStore ? [_transformStore scaleAt: _transformSlot] : _scale;
+}
+
+-(void) setStoredScale: (CC3Vector) aScale {
+	if (_transformStore)
+		[_transformStore setScale: aScale at: _transformSlot];
+	else
+		_scale = aScale;
+}
+
+-(GLuint) transformSlot { return _transformSlot; }
+
+/**
+ * Invoked by the transform store when this node is added to, moved within, or removed from
+ * the store, or when the arrays of the store are moved. The location and scale are carried
+ * across from the old storage to the new, and the globalTransformMatrix is pointed at the
+ * new slot. When removed from the store, the globalTransformMatrix keeps its contents, but
+ * it and the matrices derived from it are marked dirty.
+ */
+-(void) setTransformStore: (CC3NodeTransformStore*) aStore atSlot: (GLuint) aSlot {
+	CC3AffineMatrix* gtMtx = (CC3AffineMatrix*)_globalTransformMatrix;
+	if (aStore == _transformStore) {
+		_transformSlot = aSlot;
+		gtMtx.contentsStorage = [aStore globalTransformAt: aSlot];
+		return;
+	}
+
+	CC3Vector loc = self.storedLocation;
+	CC3Vector scl = self.storedScale;
+	_transformStore = aStore;
+	_transformSlot = aSlot;
+	self.storedLocation = loc;
+	self.storedScale = scl;
+	gtMtx.contentsStorage = [aStore globalTransformAt: aSlot];
+
+	if (aStore) {
+		[self updateTransformStoreSlot];
+	} else {
+		_globalTransformMatrix.isDirty = YES;
+		_globalTransformMatrixInverted.isDirty = YES;
+		_globalRotationMatrix.isDirty = YES;
+	}
+}
+
+/**
+ * Copies the state of this node that determines how its transform is built and
+ * marked dirty into the slot of the transform store that holds this node.
+ */
+-(void) updateTransformStoreSlot {
+	if ( !_transformStore ) return;
+
+	BOOL isStandard = self.hasStandardLocalTransforms;
+	[_transformStore setHasStandardLocalTransforms: isStandard at: _transformSlot];
+	if (isStandard) [_transformStore setRotation: _rotator.rotationMatrix at: _transformSlot];
+	[_transformStore setNeedsTransformDirtyNotification: (_boundingVolume || _transformListeners)
+													 at: _transformSlot];
+}
+
+/**
+ * Invoked by the transform store when the transform of this node has been marked dirty, either
+ * directly or because the transform of an ancestor was marked dirty, if this node has a bounding
+ * volume or transform listeners. Marks the bounding volume dirty and notifies the listeners.
+ */
+-(void) transformWasMarkedDirty {
+	[_boundingVolume markTransformDirty];
+	[self notifyTransformListeners];
+}
+
+/**
+ * Invoked by the transform store before the globalTransformMatrix is used, if the transform has
+ * been marked dirty, or has been rebuilt by the store, since it was last used. If dirty, the
+ * globalTransformMatrix is rebuilt. Otherwise, it is informed that its contents have changed.
+ * In either case, the matrices derived from the globalTransformMatrix are marked dirty.
+ */
+-(void) refreshGlobalTransformMatrix: (BOOL) isStale {
+	if (isStale)
+		[self buildGlobalTransformMatrix];
+	else
+		[(CC3AffineMatrix*)_globalTransformMatrix contentsWereChanged];
+	_globalTransformMatrixInverted.isDirty = YES;
+	_globalRotationMatrix.isDirty = YES;
+}
+
+/**
+ * Returns whether the specified class inherits the CC3Node implementations of all of the
+ * specified instance methods. The result is determined once per class, and held in the
+ * specified dictionary, which is created on first use, and is keyed by class. Nodes may
+ * be added to a scene from a background thread, so access to the dictionary is synchronized.
+ */
+static BOOL CC3NodeClassInheritsMethods(Class aClass, SEL* sels, GLuint selCnt, NSMutableDictionary** pCache) {
+	@synchronized([CC3Node class]) {
+		if ( !*pCache ) *pCache = [[NSMutableDictionary alloc] initWithCapacity: 16];	// retained
+
+		NSNumber* inherits = [*pCache objectForKey: aClass];
+		if ( !inherits ) {
+			BOOL doesInherit = YES;
+			for (GLuint selIdx = 0; selIdx < selCnt && doesInherit; selIdx++) {
+				SEL aSel = sels[selIdx];
+				doesInherit = ([aClass instanceMethodForSelector: aSel] == [CC3Node instanceMethodForSelector: aSel]);
+			}
+			inherits = [NSNumber numberWithBool: doesInherit];
+			[*pCache setObject: inherits forKey: (id<NSCopying>)aClass];
+		}
+		return inherits.boolValue;
+	}
+}
+
+static NSMutableDictionary* _standardLocalTransformClasses = nil;
+
+/**
+ * Returns whether instances of this class build their globalTransformMatrix using the standard
+ * translate-rotate-scale template methods of this class. If so, the transform store can build
+ * the globalTransformMatrix of instances directly from the location, rotator and scale.
+ *
+ * The result is determined the first time this method is invoked on each class, and is cached.
+ */
++(BOOL) usesStandardLocalTransforms {
+	SEL tfmSels[] = {
+		@selector(buildGlobalTransformMatrix),
+		@selector(applyLocalTransformsTo:),
+		@selector(applyTranslationTo:),
+		@selector(applyRotationTo:),
+		@selector(applyRotatorTo:),
+		@selector(applyScalingTo:),
+	};
+	return CC3NodeClassInheritsMethods(self, tfmSels, sizeof(tfmSels) / sizeof(SEL), &_standardLocalTransformClasses);
+}
+
+static NSMutableDictionary* _standardTransformDirtyMarkingClasses = nil;
+
+/**
+ * Returns whether instances of this class use the markTransformDirty method of this class
+ * unchanged. If not, the transform store must invoke the markTransformDirty method on
+ * instances whenever the transform of an ancestor is marked dirty.
+ *
+ * The result is determined the first time this method is invoked on each class, and is cached.
+ */
++(BOOL) usesStandardTransformDirtyMarking {
+	SEL markSels[] = { @selector(markTransformDirty), };
+	return CC3NodeClassInheritsMethods(self, markSels, sizeof(markSels) / sizeof(SEL), &_standardTransformDirtyMarkingClasses);
+}
+
+/**
+ * Returns whether the globalTransformMatrix of this node is currently defined only by the
+ * location, rotator and scale, and not by a localTransformMatrix, or by tracking a target.
+ */
+-(BOOL) hasStandardLocalTransforms { return !_localTransformMatrix && !_rotator.isTargettable; }
+
+
+#pragma mark Bounds tree
+
+/** The leaf of the nodeBoundsTree of the scene that holds this node, or -1 if this node is not in that tree. */
+-(GLint) boundsTreeLeaf { return _boundsTreeLeaf; }
+
+-(void) setBoundsTreeLeaf: (GLint) aLeaf { _boundsTreeLeaf = aLeaf; }
+
+static NSMutableDictionary* _standardFrustumIntersectionClasses = nil;
+
+/**
+ * Returns whether instances of this class determine whether they intersect the camera frustum
+ * using only their bounding volume. If so, the nodeBoundsTree of the scene can cull instances
+ * from the extent of that bounding volume.
+ *
+ * The result is determined the first time this method is invoked on each class, and is cached.
+ */
++(BOOL) usesStandardFrustumIntersection {
+	SEL isectSels[] = {
+		@selector(doesIntersectFrustum:),
+		@selector(doesIntersectBoundingVolume:),
+	};
+	return CC3NodeClassInheritsMethods(self, isectSels, sizeof(isectSels) / sizeof(SEL), &_standardFrustumIntersectionClasses);
+}
+
+/**
+ * Invoked by the bounding volume of this node when its shape has changed, independently of
+ * the transform of this node. Marks the transform slot of this node as dirty, so that the
+ * scene will refit this node within the nodeBoundsTree on the next update pass.
+ */
+-(void) boundingVolumeDidChange { [_transformStore markBoundsDirtyAt: _transformSlot]; }
+
+
 #pragma mark Bounding volumes
 
 -(void) setBoundingVolume:(CC3NodeBoundingVolume *) aBoundingVolume {
@@ -1626,6 +1915,9 @@ static GLuint lastAssignedNodeTag;
 		[self markBoundingVolumeDirty];
 	} else
 		_shouldUseFixedBoundingVolume = YES;
+
+	[self updateTransformStoreSlot];
+	[self boundingVolumeDidChange];
 }
 
 -(void) createBoundingVolume {
@@ -1742,6 +2034,7 @@ static GLuint lastAssignedNodeTag;
 	[_children addObject: aNode];
 
 	aNode.parent = self;
+	[self markSubtreeThreadSafetyDirty];
 	[self didAddDescendant: aNode];
 	[aNode markAddEnd];
 	[aNode wasAdded];
@@ -1863,6 +2156,7 @@ static GLuint lastAssignedNodeTag;
 		[_children release];
 		_children = nil;
 	}
+	[self markSubtreeThreadSafetyDirty];
 
 	[aNode wasRemoved];						// Invoke before didRemoveDesc notification
 	[self didRemoveDescendant: aNode];
@@ -2094,7 +2388,10 @@ static GLuint lastAssignedNodeTag;
 }
 
 -(CC3Node*) closestNodeIntersectedByGlobalRay: (CC3Ray) aRay {
-	return [self nodesIntersectedByGlobalRay: aRay].closestPuncturedNode;
+	CC3NodePuncturingVisitor* pnv = [CC3NodePuncturingVisitor visitorWithRay: aRay];
+	pnv.shouldFindClosestOnly = YES;
+	[pnv visit: self];
+	return pnv.closestPuncturedNode;
 }
 
 
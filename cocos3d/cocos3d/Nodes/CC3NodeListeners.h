@@ -149,6 +149,25 @@
 -(void) notifyDestructionListeners;
 
 
+#pragma mark Deferring notifications
+
+/**
+ * Starts deferring the transform notifications made on the current thread.
+ *
+ * Until the stopDeferringNotificationsOnCurrentThread method is invoked on the same thread, each
+ * time the notifyTransformListeners method of any instance is invoked on this thread, the listeners
+ * are not notified. Instead, the instance is added to the specified array. The listeners can later
+ * be notified by invoking the notifyTransformListeners method of each instance in the array.
+ *
+ * This allows transform notifications made while nodes are updated concurrently on background
+ * threads to be delivered later, on a single thread, to listeners that are not thread-safe.
+ */
++(void) deferNotificationsOnCurrentThreadInto: (NSMutableArray*) deferredListeners;
+
+/** Stops deferring the transform notifications made on the current thread. */
++(void) stopDeferringNotificationsOnCurrentThread;
+
+
 #pragma mark Allocation and initialization
 
 /** Initializes this instance to track transform listeners for the specified node. */
@@ -35,6 +35,9 @@
 #pragma mark -
 #pragma mark CC3NodeTransformListeners
 
+/** Thread-specific key holding the array of instances whose notifications are being deferred on each thread. */
+static pthread_key_t _deferredNotificationsKey;
+
 @implementation CC3NodeTransformListeners
 
 -(void) dealloc {
@@ -103,6 +106,12 @@
 }
 
 -(void) notifyTransformListeners {
+	NSMutableArray* deferredListeners = pthread_getspecific(_deferredNotificationsKey);
+	if (deferredListeners) {
+		[deferredListeners addObject: self];
+		return;
+	}
+
 	LogTrace(@"%@ notifying %lu transform listeners", _node, (unsigned long)self.count);
 	[self lock];
 	for (NSValue* xlWrap in _transformListenerWrappers)
@@ -118,6 +127,19 @@
 }
 
 
+#pragma mark Deferring notifications
+
++(void) initialize {
+	if (self == [CC3NodeTransformListeners class]) pthread_key_create(&_deferredNotificationsKey, NULL);
+}
+
++(void) deferNotificationsOnCurrentThreadInto: (NSMutableArray*) deferredListeners {
+	pthread_setspecific(_deferredNotificationsKey, deferredListeners);
+}
+
++(void) stopDeferringNotificationsOnCurrentThread { pthread_setspecific(_deferredNotificationsKey, NULL); }
+
+
 #pragma mark Allocation and initialization
 
 -(id) initForNode: (CC3Node*) node {
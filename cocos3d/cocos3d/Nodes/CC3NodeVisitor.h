@@ -38,6 +38,7 @@
 @class CC3Node, CC3MeshNode, CC3Camera, CC3Light, CC3LightProbe;
 @class CC3Scene, CC3ShaderProgram, CC3SceneDrawingSurfaceManager;
 @class CC3Material, CC3TextureUnit, CC3Mesh, CC3NodeSequencer, CC3SkinSection;
+@class CC3NodeBoundsTree;
 @protocol CC3RenderSurface;
 
 
@@ -264,9 +265,18 @@
  * during updating and transforming operations.
  *
  * This visitor encapsulates the time since the previous update.
+ *
+ * This visitor can optionally update independent subtrees of the scene concurrently on
+ * background threads. See the shouldUpdateConcurrently property for more information.
  */
 @interface CC3NodeUpdatingVisitor : CC3NodeVisitor {
+	NSMutableArray* _subtreeVisitors;
+	NSMutableArray* _concurrentChildren;
+	NSMutableArray* _deferredTransformListeners;
 	CCTime _deltaTime;
+	CCTime _subtreeUpdateTime;
+	GLuint _nodesUpdated;
+	BOOL _shouldUpdateConcurrently : 1;
 }
 
 /**
@@ -278,6 +288,44 @@
  */
 @property(nonatomic, assign) CCTime deltaTime;
 
+/**
+ * Indicates whether this visitor should update independent subtrees of nodes concurrently.
+ *
+ * When this property is set to YES, each time this visitor reaches a node whose child subtrees
+ * can be updated independently, those subtrees are distributed across the threads of the global
+ * concurrent dispatch queue. One visitor of the same class as this visitor is used for each
+ * available processor core, and each of those visitors updates an equal share of the subtrees,
+ * taking every Nth subtree, where N is the number of visitors. These visitors are retained, and
+ * reused each time subtrees are updated concurrently.
+ *
+ * A subtree is only updated concurrently if the isSubtreeUpdateThreadSafe property of the root
+ * node of the subtree returns YES, meaning that the isUpdateThreadSafe property of every node in
+ * the subtree is set to YES, and none of the nodes in the subtree is tracking a target. If at least
+ * two child subtrees of a node qualify, they are updated concurrently. Otherwise, this visitor
+ * descends into the child subtrees, looking for concurrent subtrees at the next level down.
+ *
+ * All of the concurrent subtree updates of a node complete before any of the remaining child
+ * subtrees of that node are updated, on the thread that invoked this visitor. As a result, all
+ * node updating is complete before the visit: method returns, and before the CC3Scene goes on to
+ * update the camera, billboards and shadows. Removals requested through the requestRemovalOf:
+ * method from any thread are processed on the thread that invoked this visitor, when the
+ * visitation run is complete.
+ *
+ * Transform listeners are not notified on the background threads. While a subtree is being
+ * updated concurrently, the transform notifications of its nodes are deferred, and the listeners
+ * are notified on the thread that invoked this visitor, once all of the concurrent subtree updates
+ * of the parent node are complete, and before the remaining child subtrees are updated. This allows
+ * listeners outside the subtree, such as nodes that track a target within the subtree, to be
+ * notified safely.
+ *
+ * If the CC3Scene has performanceStatistics, the elapsed time and the accumulated single-thread
+ * time of the concurrent updates are added to the statistics, from which the speedup achieved
+ * by updating concurrently can be determined.
+ *
+ * The initial value of this property is NO.
+ */
+@property(nonatomic, assign) BOOL shouldUpdateConcurrently;
+
 @end
 
 
@@ -316,6 +364,8 @@ typedef enum {
 	CC3DataArray* _boneMatricesGlobal;
 	CC3DataArray* _boneMatricesEyeSpace;
 	CC3DataArray* _boneMatricesModelSpace;
+	CC3NodeBoundsTree* _cullingTree;		// weak reference
+	GLubyte* _cullingResults;
 	CC3Matrix4x4 _projMatrix;
 	CC3Matrix4x3 _viewMatrix;
 	CC3Matrix4x3 _modelMatrix;
@@ -329,9 +379,12 @@ typedef enum {
 	GLuint _current2DTextureUnit;
 	GLuint _currentCubeTextureUnit;
 	GLuint _currentLightProbeTextureUnit;
+	GLuint _cullingResultsLength;
+	GLuint _cullingTreeVersion;
 	CCTime _deltaTime;
 	BOOL _shouldDecorateNode : 1;
 	BOOL _isDrawingEnvironmentMap : 1;
+	BOOL _shouldCullWithNodeBoundsTree : 1;
 	BOOL _isVPMtxDirty : 1;
 	BOOL _isMVMtxDirty : 1;
 	BOOL _isMVPMtxDirty : 1;
@@ -475,6 +528,25 @@ typedef enum {
  */
 @property(nonatomic, assign) BOOL isDrawingEnvironmentMap;
 
+/**
+ * Indicates whether this visitor should use the nodeBoundsTree of the CC3Scene to determine
+ * which nodes intersect the frustum of the camera.
+ *
+ * When this property is set to YES, and this visitor is drawing an entire CC3Scene, the
+ * nodeBoundsTree of the scene is tested against the camera frustum when this visitor is opened.
+ * Whole branches of the tree that lie outside or inside the frustum are resolved with a single
+ * test, and thereafter, determining whether a node held in the tree intersects the frustum is a
+ * simple lookup. Only nodes whose bounds straddle a plane of the frustum, and nodes that are not
+ * held in the tree, are tested individually against the frustum.
+ *
+ * The nodes that are drawn are the same as when each node is tested individually, but the cost of
+ * testing the bounding volume of every node against the frustum during every frame is avoided.
+ * This can be significant in scenes containing many nodes, most of which are out of view.
+ *
+ * The initial value of this property is YES.
+ */
+@property(nonatomic, assign) BOOL shouldCullWithNodeBoundsTree;
+
 /**
  * Aligns this visitor to use the same camera and rendering surface as the specified visitor.
  *
@@ -720,6 +792,7 @@ typedef enum {
 	CC3Vector _punctureLocation;
 	CC3Vector _globalPunctureLocation;
 	float _sqGlobalPunctureDistance;
+	GLint _faceIndex;
 }
 
 /** The punctured node. */
@@ -737,12 +810,28 @@ typedef enum {
  */
 @property(nonatomic, readonly) float sqGlobalPunctureDistance;
 
+/**
+ * The index of the mesh face on which the puncture is located, or -1 if the puncture is
+ * located on the bounding volume of the node, rather than on a face of its mesh.
+ */
+@property(nonatomic, readonly) GLint faceIndex;
+
 
 #pragma mark Allocation and initialization
 
-/** Initializes this instance with the specified node and ray. */
+/**
+ * Initializes this instance with the specified node and ray, locating the puncture
+ * where the ray intersects the bounding volume of the node.
+ */
 -(id) initOnNode: (CC3Node*) aNode fromRay: (CC3Ray) aRay;
 
+/**
+ * Initializes this instance with the specified node and ray, locating the puncture at the
+ * specified location on the mesh face at the specified index. The location is specified in
+ * the local coordinate system of the node.
+ */
+-(id) initOnNode: (CC3Node*) aNode atLocation: (CC3Vector) aLocation onFace: (GLint) faceIndex fromRay: (CC3Ray) aRay;
+
 /** Allocates and initializes an autoreleased instance with the specified node and ray. */
 +(id) punctureOnNode: (CC3Node*) aNode fromRay: (CC3Ray) aRay;
 
@@ -779,6 +868,15 @@ typedef enum {
  * The shouldPunctureFromInside property can be used to include or exclude nodes where the start
  * location of the ray is within its bounding volume. 
  *
+ * When the visit: method is invoked with the CC3Scene as the argument, the nodes are not visited
+ * one by one. Instead, the ray is traced through the nodeBoundsTree of the scene, and only those
+ * nodes whose bounds lie along the ray are tested. When only the closest puncture is needed, the
+ * shouldFindClosestOnly property can be set to YES, and nodes that lie beyond the closest puncture
+ * found so far are not tested at all. See the shouldUseNodeBoundsTree property for more info.
+ *
+ * By default, punctures are located on the bounding volumes of the nodes. Setting the
+ * shouldPunctureMeshFaces property to YES refines each puncture to the exact face of the mesh.
+ *
  * To save instantiating a CC3NodePuncturingVisitor each time, you can reuse the visitor instance
  * over and over, through different invocations of the visit: method.
  */
@@ -787,6 +885,10 @@ typedef enum {
 	CC3Ray _ray;
 	BOOL _shouldPunctureFromInside : 1;
 	BOOL _shouldPunctureInvisibleNodes : 1;
+	BOOL _shouldPunctureOnlyTouchableNodes : 1;
+	BOOL _shouldUseNodeBoundsTree : 1;
+	BOOL _shouldFindClosestOnly : 1;
+	BOOL _shouldPunctureMeshFaces : 1;
 }
 
 /**
@@ -816,6 +918,77 @@ typedef enum {
  */
 @property(nonatomic, assign) BOOL shouldPunctureInvisibleNodes;
 
+/**
+ * Indicates whether the visitor should collect only those nodes whose isTouchable property
+ * returns YES, ignoring any other nodes that the ray punctures, even if they are closer.
+ *
+ * This makes picking nodes with a ray consistent with picking nodes by color, which draws only
+ * touchable nodes. A non-touchable node in front of a touchable node, such as a floor, a skybox
+ * or a HUD plane, does not hide the touchable node from the ray.
+ *
+ * The isTouchable property also takes the visibility of each node into consideration, so when
+ * this property is set to YES, the shouldPunctureInvisibleNodes property is ignored.
+ *
+ * The initial value of this property is NO, indicating that nodes will be collected whether
+ * they are touchable or not.
+ */
+@property(nonatomic, assign) BOOL shouldPunctureOnlyTouchableNodes;
+
+/**
+ * Indicates whether this visitor should trace the ray through the nodeBoundsTree of the
+ * CC3Scene, when the visit: method is invoked with the CC3Scene as the argument.
+ *
+ * When this property is set to YES, instead of visiting and testing every node in the scene,
+ * this visitor tests only those nodes whose bounds in the nodeBoundsTree lie along the ray,
+ * along with any nodes that the tree cannot bound. Entire branches of the tree that the ray
+ * misses are skipped with a single test. The nodes that are punctured are the same as when
+ * each node is visited.
+ *
+ * When the visit: method is invoked with a node other than the CC3Scene, each node in the
+ * structural hierarchy of that node is visited and tested, regardless of this property.
+ *
+ * The initial value of this property is YES.
+ */
+@property(nonatomic, assign) BOOL shouldUseNodeBoundsTree;
+
+/**
+ * Indicates whether this visitor should collect only the puncture that is closest to the
+ * startLocation of the ray, instead of collecting all punctures.
+ *
+ * When this property is set to YES, the nodeCount property will be no more than one, and
+ * that node will be the same as the closestPuncturedNode that would be found if this property
+ * was set to NO. When tracing the ray through the nodeBoundsTree of the CC3Scene, any nodes that
+ * lie entirely beyond the closest puncture found so far are not tested at all, which can
+ * significantly improve performance in a scene containing many nodes.
+ *
+ * The initial value of this property is NO, indicating that all punctures will be collected.
+ */
+@property(nonatomic, assign) BOOL shouldFindClosestOnly;
+
+/**
+ * Indicates whether the punctures on mesh nodes should be refined from the bounding volume
+ * of the node, to the face of the mesh that is closest to the startLocation of the ray.
+ *
+ * When this property is set to YES, a mesh node whose bounding volume is punctured by the ray is
+ * only considered punctured if the ray also intersects a face of its mesh. The puncture location
+ * is then the location on that face, and the index of that face is available from the faceIndex
+ * property of the puncture. A ray that starts inside the bounding volume of the mesh node may
+ * still puncture a front face of the mesh. Back faces are only punctured if the
+ * shouldPunctureFromInside property is set to YES, or if the node does not cull back faces.
+ *
+ * Mesh nodes whose vertices are deformed by a skeleton, and nodes that are not mesh nodes,
+ * are punctured on their bounding volumes, regardless of this property.
+ *
+ * The faces of each mesh are searched using the faceTree of the mesh, unless the shouldUseFaceTree
+ * property of the mesh is set to NO. The tree is built the first time a mesh is punctured, which
+ * for a large mesh can take a noticeable amount of time. To avoid a pause during interaction,
+ * you can access the faceTree property of such meshes while your scene is loading.
+ *
+ * The initial value of this property is NO, indicating that all punctures are located on the
+ * bounding volumes of the nodes.
+ */
+@property(nonatomic, assign) BOOL shouldPunctureMeshFaces;
+
 /**
  * The ray that is to be traced, specified in the global coordinate system.
  *
@@ -920,6 +1093,15 @@ typedef enum {
  */
 -(CC3Vector) globalPunctureLocationAt: (NSUInteger) index;
 
+/**
+ * Returns the index of the mesh face on which the puncture of the node returned by the
+ * puncturedNodeAt: method is located, or -1 if the puncture is located on the bounding volume
+ * of the node. The specified index must be between zero and nodeCount minus one, inclusive.
+ *
+ * Punctures are located on mesh faces only if the shouldPunctureMeshFaces property is set to YES.
+ */
+-(GLint) punctureFaceIndexAt: (NSUInteger) index;
+
 
 #pragma mark Allocation and initialization
 
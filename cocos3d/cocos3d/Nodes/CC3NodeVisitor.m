@@ -43,6 +43,7 @@
 #endif	// CC3_CC2_RENDER_QUEUE
 
 @interface CC3Node (TemplateMethods)
+@property(nonatomic, readonly) GLint boundsTreeLeaf;
 -(void) processUpdateBeforeTransform: (CC3NodeUpdatingVisitor*) visitor;
 -(void) processUpdateAfterTransform: (CC3NodeUpdatingVisitor*) visitor;
 @end
@@ -51,6 +52,10 @@
 @property(nonatomic, readonly) CC3TouchedNodePicker* touchedNodePicker;
 @end
 
+@interface CC3NodeVisitor (TemplateMethods)
+-(void) processRemovals;
+@end
+
 
 #pragma mark -
 #pragma mark CC3NodeVisitor
@@ -266,11 +271,30 @@
 
 @implementation CC3NodeUpdatingVisitor
 
-@synthesize deltaTime=_deltaTime;
+@synthesize deltaTime=_deltaTime, shouldUpdateConcurrently=_shouldUpdateConcurrently;
+
+-(void) dealloc {
+	[_subtreeVisitors release];
+	[_concurrentChildren release];
+	[_deferredTransformListeners release];
+	[super dealloc];
+}
+
+-(void) open {
+	[super open];
+	_nodesUpdated = 0;
+}
+
+/** Processes any removals requested of the subtree visitors during concurrent updating. */
+-(void) close {
+	[self.performanceStatistics addNodesUpdated: _nodesUpdated];
+	for (CC3NodeUpdatingVisitor* stVisitor in _subtreeVisitors) [stVisitor processRemovals];
+	[super close];
+}
 
 -(void) processBeforeChildren: (CC3Node*) aNode {
 	LogTrace(@"Updating %@ after %.3f ms", aNode, _deltaTime * 1000.0f);
-	[self.performanceStatistics incrementNodesUpdated];
+	_nodesUpdated++;
 	[aNode processUpdateBeforeTransform: self];
 
 	// Process the transform AFTER updateBeforeTransform: invoked
@@ -282,9 +306,155 @@
 	[super processAfterChildren: aNode];
 }
 
+
+#pragma mark Concurrent updating
+
+/**
+ * If concurrent updating is enabled, updates the child subtrees of the specified node that
+ * can be updated independently, concurrently on background threads, and once they are all
+ * complete, updates the remaining child subtrees on this thread.
+ *
+ * Subtree visitors never update concurrently themselves, so this happens at most once down
+ * any branch of the scene.
+ */
+-(BOOL) processChildrenOf: (CC3Node*) aNode {
+	if ( !_shouldUpdateConcurrently ) return [super processChildrenOf: aNode];
+
+	NSArray* children = aNode.children;
+	NSUInteger stCnt = 0;
+	for (CC3Node* child in children) if (child.isSubtreeUpdateThreadSafe) stCnt++;
+	if (stCnt < 2) return [super processChildrenOf: aNode];
+
+	// The concurrent children are pushed onto the end of the buffer, and popped once the serial
+	// children have been visited, so the serial subtrees, which may themselves update concurrently,
+	// reuse the same buffer without disturbing the concurrent children of this node.
+	if ( !_concurrentChildren ) _concurrentChildren = [NSMutableArray new];		// retained
+	NSUInteger stBase = _concurrentChildren.count;
+	for (CC3Node* child in children) if (child.isSubtreeUpdateThreadSafe) [_concurrentChildren addObject: child];
+	NSArray* concurrentChildren = _concurrentChildren;
+
+	// One subtree visitor per processor core, each updating every workerCnt'th concurrent child.
+	// Subtree visitors share the camera, which is resolved here, before leaving this thread.
+	NSUInteger workerCnt = MIN(stCnt, MAX(NSProcessInfo.processInfo.activeProcessorCount, 1));
+	if ( !_subtreeVisitors ) _subtreeVisitors = [NSMutableArray new];		// retained
+	while (_subtreeVisitors.count < workerCnt) [_subtreeVisitors addObject: [[self class] visitor]];
+	CC3Camera* cam = self.camera;
+	for (NSUInteger wIdx = 0; wIdx < workerCnt; wIdx++)
+		((CC3NodeUpdatingVisitor*)[_subtreeVisitors objectAtIndex: wIdx]).camera = cam;
+
+	// Build the transform of the parent node, and its ancestors, before any subtree needs it,
+	// so that it is not lazily built by several threads at once.
+	[aNode globalTransformMatrix];
+
+	// Returns once all of the concurrent subtrees have been updated
+	NSTimeInterval startTime = NSDate.timeIntervalSinceReferenceDate;
+	dispatch_apply(workerCnt, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t wIdx) {
+		CC3NodeUpdatingVisitor* stVisitor = [_subtreeVisitors objectAtIndex: wIdx];
+		[stVisitor updateSubtrees: concurrentChildren
+						fromIndex: stBase + wIdx
+						  toIndex: stBase + stCnt
+						   stride: workerCnt
+					   forVisitor: self];
+	});
+	CCTime elapsedTime = NSDate.timeIntervalSinceReferenceDate - startTime;
+
+	CCTime workTime = 0;
+	for (NSUInteger wIdx = 0; wIdx < workerCnt; wIdx++) {
+		CC3NodeUpdatingVisitor* stVisitor = [_subtreeVisitors objectAtIndex: wIdx];
+		_nodesUpdated += stVisitor->_nodesUpdated;
+		workTime += stVisitor->_subtreeUpdateTime;
+	}
+	[self.performanceStatistics addConcurrentUpdateTime: elapsedTime withWorkTime: workTime];
+
+	// Deliver the transform notifications deferred during the concurrent updates
+	for (NSUInteger wIdx = 0; wIdx < workerCnt; wIdx++) {
+		CC3NodeUpdatingVisitor* stVisitor = [_subtreeVisitors objectAtIndex: wIdx];
+		[stVisitor notifyDeferredTransformListeners];
+	}
+
+	// Now update the subtrees that must be updated on this thread. Both collections are in
+	// the same order, so the concurrent children are skipped by stepping through the buffer.
+	CC3Node* currNode = _currentNode;		// Remember current node
+	NSUInteger stEnd = stBase + stCnt;
+	NSUInteger ccIdx = stBase;
+	for (CC3Node* child in children) {
+		if (ccIdx < stEnd && child == [_concurrentChildren objectAtIndex: ccIdx])
+			ccIdx++;
+		else
+			[self visit: child];
+	}
+	_currentNode = currNode;				// Restore current node
+
+	[_concurrentChildren removeObjectsInRange: NSMakeRange(stBase, stCnt)];
+
+	return NO;
+}
+
+/**
+ * Updates the subtrees of the specified nodes, starting at the node at startIdx, and taking every
+ * stride'th node before endIdx, on behalf of the specified visitor. Invoked on a background thread.
+ *
+ * This visitor takes on the startingNode of the other visitor, so that it neither opens nor closes
+ * during this visitation, and any removals requested of this visitor remain pending until the
+ * other visitor closes.
+ *
+ * Transform notifications made on this thread during the update are deferred, and are delivered
+ * when the other visitor invokes the notifyDeferredTransformListeners method of this visitor.
+ */
+-(void) updateSubtrees: (NSArray*) nodes
+			 fromIndex: (NSUInteger) startIdx
+			   toIndex: (NSUInteger) endIdx
+				stride: (NSUInteger) stride
+			forVisitor: (CC3NodeUpdatingVisitor*) visitor {
+	NSTimeInterval startTime = NSDate.timeIntervalSinceReferenceDate;
+
+	if ( !_deferredTransformListeners ) _deferredTransformListeners = [NSMutableArray new];		// retained
+	[CC3NodeTransformListeners deferNotificationsOnCurrentThreadInto: _deferredTransformListeners];
+
+	_startingNode = visitor.startingNode;		// weak reference
+	_deltaTime = visitor.deltaTime;
+	_nodesUpdated = 0;
+	for (NSUInteger nIdx = startIdx; nIdx < endIdx; nIdx += stride) {
+		@autoreleasepool { [self visit: [nodes objectAtIndex: nIdx]]; }
+	}
+	_startingNode = nil;
+
+	[CC3NodeTransformListeners stopDeferringNotificationsOnCurrentThread];
+
+	_subtreeUpdateTime = NSDate.timeIntervalSinceReferenceDate - startTime;
+}
+
+/**
+ * Delivers the transform notifications that were deferred during the most recent concurrent
+ * subtree update, in the order they were made. Invoked on the thread of the visitor that
+ * requested the subtree update.
+ */
+-(void) notifyDeferredTransformListeners {
+	for (CC3NodeTransformListeners* xfmListeners in _deferredTransformListeners)
+		[xfmListeners notifyTransformListeners];
+	[_deferredTransformListeners removeAllObjects];
+}
+
+
+#pragma mark Allocation and initialization
+
+-(id) init {
+	if ( (self = [super init]) ) {
+		_subtreeVisitors = nil;
+		_concurrentChildren = nil;
+		_deferredTransformListeners = nil;
+		_deltaTime = 0;
+		_subtreeUpdateTime = 0;
+		_nodesUpdated = 0;
+		_shouldUpdateConcurrently = NO;
+	}
+	return self;
+}
+
 -(NSString*) fullDescription {
-	return [NSString stringWithFormat: @"%@, dt: %.3f ms",
-			[super fullDescription], _deltaTime * 1000.0f];
+	return [NSString stringWithFormat: @"%@, dt: %.3f ms%@",
+			[super fullDescription], _deltaTime * 1000.0f,
+			(_shouldUpdateConcurrently ? @", concurrent" : @"")];
 }
 
 @end
@@ -298,13 +468,16 @@
 @synthesize deltaTime=_deltaTime;
 @synthesize shouldDecorateNode=_shouldDecorateNode;
 @synthesize isDrawingEnvironmentMap=_isDrawingEnvironmentMap;
+@synthesize shouldCullWithNodeBoundsTree=_shouldCullWithNodeBoundsTree;
 @synthesize currentColor=_currentColor;
 @synthesize ccRenderer=_ccRenderer, billboardCCRenderer=_billboardCCRenderer;
 
 -(void) dealloc {
 	_drawingSequencer = nil;				// weak reference
 	_currentSkinSection = nil;				// weak reference
+	_cullingTree = nil;						// weak reference
 	_gl = nil;								// weak reference
+	free(_cullingResults);
 	[_ccRenderer release];
 	[_billboardCCRenderer release];
 	[_surfaceManager release];
@@ -417,7 +590,24 @@
 			&& [self doesNodeIntersectFrustum: aNode];
 }
 
+/**
+ * If the node is held in the nodeBoundsTree that was culled when this visitor was opened, and
+ * the leaf holding the node was found to be completely outside or inside the frustum, returns
+ * that result. Otherwise, tests the node individually against the frustum.
+ */
 -(BOOL) doesNodeIntersectFrustum: (CC3Node*) aNode {
+	GLint leaf = aNode.boundsTreeLeaf;
+	if (_cullingTree && leaf >= 0 && leaf < (GLint)_cullingResultsLength &&
+		_cullingTree.structureVersion == _cullingTreeVersion) {
+		switch (_cullingResults[leaf]) {
+			case kCC3BoundsCullOutside:
+				return NO;
+			case kCC3BoundsCullInside:
+				return YES;
+			default:
+				break;
+		}
+	}
 	return [aNode doesIntersectFrustum: self.camera.frustum];
 }
 
@@ -449,6 +639,7 @@
 	[self activateRenderSurface];
 	[self openScene];
 	[self openCamera];
+	[self openCulling];
 }
 
 /** 
@@ -482,10 +673,39 @@
 
 }
 
+/**
+ * If this visitor was started on a CC3Scene node, and should cull with the nodeBoundsTree of
+ * the scene, refits the tree to any recent changes to the nodes, and classifies the leaves of
+ * the tree against the camera frustum, for lookup when each node is tested against the frustum.
+ */
+-(void) openCulling {
+	_cullingTree = nil;
+	if ( !(_shouldCullWithNodeBoundsTree && _startingNode.isScene) ) return;
+
+	CC3Frustum* frustum = self.camera.frustum;
+	if ( !frustum ) return;
+
+	CC3Scene* scene = self.scene;
+	[scene updateNodeBoundsTree];
+
+	CC3NodeBoundsTree* tree = scene.nodeBoundsTree;
+	if (tree.nodeCount == 0) return;
+
+	GLuint entryCap = tree.entryCapacity;
+	if (entryCap > _cullingResultsLength) {
+		_cullingResults = realloc(_cullingResults, entryCap * sizeof(GLubyte));
+		_cullingResultsLength = entryCap;
+	}
+	[tree classifyAgainstFrustum: frustum into: _cullingResults];
+	_cullingTree = tree;					// weak reference
+	_cullingTreeVersion = tree.structureVersion;
+}
+
 /** Close the camera. */
 -(void) close {
 	[self closeCamera];
 	_drawingSequencer = nil;
+	_cullingTree = nil;						// weak reference
 	[super close];
 }
 
@@ -781,6 +1001,11 @@
 		_isMVPMtxDirty = YES;
 		_shouldDecorateNode = YES;
 		_isDrawingEnvironmentMap = NO;
+		_shouldCullWithNodeBoundsTree = YES;
+		_cullingTree = nil;
+		_cullingResults = NULL;
+		_cullingResultsLength = 0;
+		_cullingTreeVersion = 0;
 	}
 	return self;
 }
@@ -931,7 +1156,7 @@
 
 @implementation CC3NodePuncture
 
-@synthesize node=_node, sqGlobalPunctureDistance=_sqGlobalPunctureDistance;
+@synthesize node=_node, sqGlobalPunctureDistance=_sqGlobalPunctureDistance, faceIndex=_faceIndex;
 @synthesize punctureLocation=_punctureLocation, globalPunctureLocation=_globalPunctureLocation;
 
 -(void) dealloc {
@@ -943,11 +1168,19 @@
 #pragma mark Allocation and initialization
 
 -(id) initOnNode: (CC3Node*) aNode fromRay: (CC3Ray) aRay {
+	return [self initOnNode: aNode
+				 atLocation: [aNode locationOfGlobalRayIntesection: aRay]
+					 onFace: -1
+					fromRay: aRay];
+}
+
+-(id) initOnNode: (CC3Node*) aNode atLocation: (CC3Vector) aLocation onFace: (GLint) faceIndex fromRay: (CC3Ray) aRay {
 	if ( (self = [super init]) ) {
 		_node = [aNode retain];
-		_punctureLocation = [aNode locationOfGlobalRayIntesection: aRay];
+		_punctureLocation = aLocation;
 		_globalPunctureLocation = [aNode.globalTransformMatrix transformLocation: _punctureLocation];
 		_sqGlobalPunctureDistance = CC3VectorDistanceSquared(_globalPunctureLocation, aRay.startLocation);
+		_faceIndex = faceIndex;
 	}
 	return self;
 }
@@ -966,6 +1199,10 @@
 
 @synthesize ray=_ray, shouldPunctureFromInside=_shouldPunctureFromInside;
 @synthesize shouldPunctureInvisibleNodes=_shouldPunctureInvisibleNodes;
+@synthesize shouldPunctureOnlyTouchableNodes=_shouldPunctureOnlyTouchableNodes;
+@synthesize shouldUseNodeBoundsTree=_shouldUseNodeBoundsTree;
+@synthesize shouldFindClosestOnly=_shouldFindClosestOnly;
+@synthesize shouldPunctureMeshFaces=_shouldPunctureMeshFaces;
 
 -(void) dealloc {
 	[_nodePunctures release];
@@ -998,40 +1235,129 @@
 	return (self.nodeCount > 0) ? [self globalPunctureLocationAt: 0] : kCC3VectorNull;
 }
 
+-(GLint) punctureFaceIndexAt: (NSUInteger) index { return [self nodePunctureAt: index].faceIndex; }
+
 -(void) open {
 	[super open];
 	[_nodePunctures removeAllObjects];
 }
 
+/**
+ * Returns whether the specified node should be tested for punctures at all. If the
+ * shouldPunctureOnlyTouchableNodes property is set to YES, only touchable nodes are tested.
+ * Otherwise, invisible nodes are tested only if the shouldPunctureInvisibleNodes property
+ * is set to YES.
+ */
+-(BOOL) isPuncturable: (CC3Node*) aNode {
+	if (_shouldPunctureOnlyTouchableNodes) return aNode.isTouchable;
+	return _shouldPunctureInvisibleNodes || aNode.visible;
+}
+
 /**
  * Utility method that returns whether the specified node is punctured by the ray.
  *   - Returns NO if the node has no bounding volume.
- *   - Returns NO if the node is invisible, unless the shouldPunctureInvisibleNodes property
- *     has been set to YES.
+ *   - Returns NO if the isPuncturable: method returns NO for the node.
  *   - Returns NO if the ray starts within the bounding volume, unless the 
  *     shouldPunctureFromInside property has been set to YES.
  */
 -(BOOL) doesPuncture: (CC3Node*) aNode {
 	CC3BoundingVolume* bv = aNode.boundingVolume;
 	if ( !bv ) return NO;
-	if ( !_shouldPunctureInvisibleNodes && !aNode.visible ) return NO;
+	if ( ![self isPuncturable: aNode] ) return NO;
 	if ( !_shouldPunctureFromInside && [bv doesIntersectLocation: _ray.startLocation] ) return NO;
 	return [bv doesIntersectRay: _ray];
 }
 
--(void) processBeforeChildren: (CC3Node*) aNode {
-	if ( [self doesPuncture: aNode] ) {
-		CC3NodePuncture* np = [CC3NodePuncture punctureOnNode: aNode fromRay: _ray];
-		NSUInteger nodeCount = _nodePunctures.count;
-		for (NSUInteger i = 0; i < nodeCount; i++) {
-			CC3NodePuncture* existNP = [_nodePunctures objectAtIndex: i];
-			if (np.sqGlobalPunctureDistance < existNP.sqGlobalPunctureDistance) {
+/** Returns whether the puncture of the specified node should be refined to the faces of its mesh. */
+-(BOOL) shouldPunctureFacesOf: (CC3Node*) aNode {
+	return _shouldPunctureMeshFaces && aNode.isMeshNode && !((CC3MeshNode*)aNode).hasSkeleton;
+}
+
+/**
+ * Returns the puncture of the ray on the closest face of the mesh of the specified node,
+ * or nil if the ray does not intersect the mesh. The bounding volume is tested first,
+ * to quickly reject nodes that the ray does not come near.
+ */
+-(CC3NodePuncture*) facePunctureOf: (CC3MeshNode*) aNode {
+	if ( ![aNode.boundingVolume doesIntersectRay: _ray] ) return nil;
+
+	CC3MeshIntersection hit;
+	CC3Ray localRay = [aNode.globalTransformMatrixInverted transformRay: _ray];
+	BOOL acceptBackFaces = _shouldPunctureFromInside || !aNode.shouldCullBackFaces;
+	if ( ![aNode findNearestIntersection: &hit
+							  ofLocalRay: localRay
+						 acceptBackFaces: acceptBackFaces
+						 acceptBehindRay: NO] ) return nil;
+
+	return [[[CC3NodePuncture alloc] initOnNode: aNode
+									 atLocation: hit.location
+										 onFace: hit.faceIndex
+										fromRay: _ray] autorelease];
+}
+
+/**
+ * Returns the puncture of the ray on the specified node, or nil if the node is not punctured.
+ * If the shouldPunctureMeshFaces property is set to YES, the puncture is refined to the faces
+ * of the mesh where possible.
+ */
+-(CC3NodePuncture*) punctureOf: (CC3Node*) aNode {
+	if ( [self shouldPunctureFacesOf: aNode] ) {
+		if ( !aNode.boundingVolume ) return nil;
+		if ( ![self isPuncturable: aNode] ) return nil;
+		return [self facePunctureOf: (CC3MeshNode*)aNode];
+	}
+	if ( ![self doesPuncture: aNode] ) return nil;
+	return [CC3NodePuncture punctureOnNode: aNode fromRay: _ray];
+}
+
+/**
+ * Adds the specified puncture to the collected punctures, in order of distance from the
+ * startLocation of the ray. If the shouldFindClosestOnly property is set to YES, only the
+ * closer of the specified puncture and the currently collected puncture is retained.
+ */
+-(void) addPuncture: (CC3NodePuncture*) np {
+	NSUInteger nodeCount = _nodePunctures.count;
+	for (NSUInteger i = 0; i < nodeCount; i++) {
+		CC3NodePuncture* existNP = [_nodePunctures objectAtIndex: i];
+		if (np.sqGlobalPunctureDistance < existNP.sqGlobalPunctureDistance) {
+			if (_shouldFindClosestOnly)
+				[_nodePunctures replaceObjectAtIndex: i withObject: np];
+			else
 				[_nodePunctures insertObject: np atIndex: i];
-				return;
-			}
+			return;
 		}
-		[_nodePunctures addObject: np];
 	}
+	if ( !(_shouldFindClosestOnly && nodeCount > 0) ) [_nodePunctures addObject: np];
+}
+
+-(void) processBeforeChildren: (CC3Node*) aNode {
+	CC3NodePuncture* np = [self punctureOf: aNode];
+	if (np) [self addPuncture: np];
+}
+
+/**
+ * If the starting node is the CC3Scene, and the shouldUseNodeBoundsTree property is set to YES,
+ * traces the ray through the nodeBoundsTree of the scene, instead of visiting each child node.
+ */
+-(BOOL) processChildrenOf: (CC3Node*) aNode {
+	if ( !(_shouldUseNodeBoundsTree && aNode == _startingNode && aNode.isScene) )
+		return [super processChildrenOf: aNode];
+
+	CC3Scene* scene = (CC3Scene*)aNode;
+	[scene updateNodeBoundsTree];
+
+	[scene.nodeBoundsTree testNodesAlongRay: _ray
+								closestOnly: _shouldFindClosestOnly
+								  withBlock: ^(CC3Node* testNode) {
+									  if (testNode == aNode) return -1.0f;		// Scene already tested
+									  _currentNode = testNode;
+									  CC3NodePuncture* np = [self punctureOf: testNode];
+									  if ( !np ) return -1.0f;
+									  [self addPuncture: np];
+									  return sqrtf(np.sqGlobalPunctureDistance);
+								  }];
+	_currentNode = aNode;
+	return NO;
 }
 
 #pragma mark Allocation and initialization
@@ -1044,6 +1370,10 @@
 		_nodePunctures = [[NSMutableArray array] retain];
 		_shouldPunctureFromInside = NO;
 		_shouldPunctureInvisibleNodes = NO;
+		_shouldPunctureOnlyTouchableNodes = NO;
+		_shouldUseNodeBoundsTree = YES;
+		_shouldFindClosestOnly = NO;
+		_shouldPunctureMeshFaces = NO;
 	}
 	return self;
 }
@@ -142,6 +142,7 @@ char* CC3GLEnumName(GLenum gle) {
 		case GL_SHORT: return "GL_SHORT";
 		case GL_UNSIGNED_SHORT: return "GL_UNSIGNED_SHORT";
 		case GL_FIXED: return "GL_FIXED";
+		case GL_HALF_FLOAT_OES: return "GL_HALF_FLOAT_OES";
 		case GL_UNSIGNED_INT: return "GL_UNSIGNED_INT";
 
 		case GL_INT_VEC2: return "GL_INT_VEC2";
@@ -573,6 +574,7 @@ size_t CC3GLElementTypeSize(GLenum dataType) {
 		case GL_SHORT: return sizeof(GLshort);
 		case GL_UNSIGNED_SHORT: return sizeof(GLushort);
 		case GL_FIXED: return sizeof(GLfixed);
+		case GL_HALF_FLOAT_OES: return sizeof(GLushort);
 
 #if CC3_GLSL
 		case GL_UNSIGNED_INT: return sizeof(GLuint);
@@ -213,6 +213,9 @@
 
 // Data types
 #define GL_UNSIGNED_INT						0x1405
+#ifndef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT_OES					0x8D61
+#endif
 
 // Separate Blend Functions
 #define GL_BLEND_DST_RGB                                 0x80C8
@@ -47,7 +47,7 @@ static const CCTime kCC3DefaultMaximumUpdateInterval = (1.0f / 15.0f);
 /** Default color for the ambient scene light. */
 static const ccColor4F kCC3DefaultLightColorAmbientScene = { 0.2f, 0.2f, 0.2f, 1.0f };
 
-@class CC3Layer, CC3TouchedNodePicker;
+@class CC3Layer, CC3TouchedNodePicker, CC3NodeBoundsTree;
 
 
 #pragma mark -
@@ -236,6 +236,8 @@ static const ccColor4F kCC3DefaultLightColorAmbientScene = { 0.2f, 0.2f, 0.2f, 1
 	CC3NodeSequencer* _drawingSequencer;
 	CC3TouchedNodePicker* _touchedNodePicker;
 	CC3PerformanceStatistics* _performanceStatistics;
+	CC3NodeTransformStore* _nodeTransforms;
+	CC3NodeBoundsTree* _nodeBoundsTree;
 	CC3NodeUpdatingVisitor* _updateVisitor;
 	CC3NodeDrawingVisitor* _viewDrawingVisitor;
 	CC3NodeDrawingVisitor* _envMapDrawingVisitor;
@@ -674,6 +676,37 @@ static const ccColor4F kCC3DefaultLightColorAmbientScene = { 0.2f, 0.2f, 0.2f, 1
  */
 @property(nonatomic, readonly) NSTimeInterval elapsedTimeSinceOpened;
 
+/**
+ * A bounding volume hierarchy holding the global bounds of the nodes in this scene that have
+ * local content to draw.
+ *
+ * During each drawing pass, the CC3NodeDrawingVisitor tests the branches of this tree against
+ * the camera frustum. Entire branches that lie completely outside the frustum, or completely
+ * inside it, are resolved with a single test, and only those nodes whose bounds straddle a plane
+ * of the frustum are tested individually. See the CC3NodeBoundsTree class for more information.
+ *
+ * When a CC3NodePuncturingVisitor is used to find the nodes punctured by a ray, such as when
+ * invoking the nodesIntersectedByGlobalRay: method on this scene, the ray is traced through
+ * this tree, and only the nodes whose bounds lie along the ray are tested.
+ *
+ * Nodes are added to and removed from this tree automatically as they are added to and removed
+ * from this scene, and are refitted within this tree when their transforms or bounding volumes
+ * change. Usually, the application never needs to interact with this tree directly.
+ */
+@property(nonatomic, readonly) CC3NodeBoundsTree* nodeBoundsTree;
+
+/**
+ * Rebuilds the globalTransformMatrix of any node whose transform is dirty, and refits each
+ * node whose transform or bounding volume has changed within the nodeBoundsTree.
+ *
+ * This method is invoked automatically at the end of each update pass, and again by the
+ * CC3NodeDrawingVisitor before it culls the nodes of this scene to the camera frustum, and by
+ * the CC3NodePuncturingVisitor before it traces a ray through the nodes of this scene, to pick
+ * up any changes made to the nodes since the update pass.
+ * Usually, the application never needs to invoke this method directly.
+ */
+-(void) updateNodeBoundsTree;
+
 
 #pragma mark Drawing
 
@@ -1186,9 +1219,14 @@ static const ccColor4F kCC3DefaultLightColorAmbientScene = { 0.2f, 0.2f, 0.2f, 1
  * is only added to the queue if it is different than the previous touch type. For example,
  * a rapid inflow of kCCTouchMoved events will only result in a single kCCTouchMoved event
  * being picked and dispatched to the CC3Scene on each pair of  rendering and updating passes.
+ *
+ * Alternately, by setting the shouldPickWithRay property to YES, nodes can be picked by tracing
+ * a ray from the camera, through the touch point, into the nodeBoundsTree of the scene. This
+ * avoids the additional rendering pass. See the notes for that property for more information.
  */
 @interface CC3TouchedNodePicker : NSObject {
 	CC3NodePickingVisitor* _pickVisitor;
+	CC3NodePuncturingVisitor* _puncturingVisitor;
 	CC3Scene* _scene;
 	CC3Node* _pickedNode;
 	uint _touchQueue[kCC3TouchQueueLength];
@@ -1196,6 +1234,7 @@ static const ccColor4F kCC3DefaultLightColorAmbientScene = { 0.2f, 0.2f, 0.2f, 1
 	CGPoint _touchPoint;
 	BOOL _wasTouched;
 	BOOL _wasPicked;
+	BOOL _shouldPickWithRay;
 }
 
 /**
@@ -1206,6 +1245,39 @@ static const ccColor4F kCC3DefaultLightColorAmbientScene = { 0.2f, 0.2f, 0.2f, 1
  */
 @property(nonatomic, retain) CC3NodePickingVisitor* pickVisitor;
 
+/**
+ * Indicates whether nodes should be picked by tracing a ray from the camera through the touch
+ * point, instead of by rendering the scene in unique colors and reading the touched pixel.
+ *
+ * When this property is set to YES, the touch point is unprojected through the camera into a
+ * ray, and the puncturingVisitor traces that ray through the nodeBoundsTree of the scene, to find
+ * the touchable node whose mesh face is closest to the camera. Only the branches of the tree that
+ * lie along the ray, up to that closest face, are tested, and no rendering pass is needed. As with
+ * color picking, nodes that are not touchable are ignored, so they do not hide touchable nodes
+ * that lie behind them.
+ *
+ * Picking with a ray is based on the geometry of the nodes, rather than on the pixels that were
+ * drawn. Nodes are picked even if their rendered content is fully transparent at the touch point,
+ * and vertex-skinned nodes are picked from their bounding volumes. If the shouldDisplayPickingRender
+ * property of the scene is set to YES, the color-picking rendering pass is used, regardless of the
+ * value of this property.
+ *
+ * The initial value of this property is NO, indicating that nodes are picked using color picking.
+ */
+@property(nonatomic, assign) BOOL shouldPickWithRay;
+
+/**
+ * The visitor that is used to trace a ray through the scene when picking a node from touch
+ * selection, when the shouldPickWithRay property is set to YES.
+ *
+ * The initial value of this property is a CC3NodePuncturingVisitor whose shouldFindClosestOnly,
+ * shouldPunctureMeshFaces and shouldPunctureOnlyTouchableNodes properties are set to YES. If you
+ * set a different visitor, set its shouldPunctureOnlyTouchableNodes property to YES, so that
+ * non-touchable nodes do not intercept touches. The application can set a different
+ * visitor, or change the configuration of this visitor, if desired.
+ */
+@property(nonatomic, retain) CC3NodePuncturingVisitor* puncturingVisitor;
+
 /** The most recent touch point in Cocos2D coordinates. */
 @property(nonatomic, readonly) CGPoint touchPoint;
 
@@ -1252,6 +1324,10 @@ static const ccColor4F kCC3DefaultLightColorAmbientScene = { 0.2f, 0.2f, 0.2f, 1
  * visitor is not used to render the scene for node picking. Instead, the internal drawing
  * visitor is aligned with the specified visitor, and is then used to render the scene.
  *
+ * If the shouldPickWithRay property is set to YES, no rendering takes place. Instead, the touch
+ * point is unprojected into a ray from the camera of the specified visitor, and the node closest
+ * to the camera along that ray is picked using the puncturingVisitor.
+ *
  * This method is invoked automatically whenever a touch event occurs. Usually, the
  * application never needs to invoke this method directly.
  */
@@ -1281,6 +1357,422 @@ static const ccColor4F kCC3DefaultLightColorAmbientScene = { 0.2f, 0.2f, 0.2f, 1
 @end
 
 
+#pragma mark -
+#pragma mark CC3NodeTransformStore
+
+/**
+ * A CC3NodeTransformStore holds the transform state of all of the nodes in a CC3Scene in
+ * contiguous arrays, and builds the globalTransformMatrix of each node whose transform is
+ * dirty, in a single linear pass over those arrays, during each update of the scene.
+ *
+ * Each node in the scene occupies a slot in each of the arrays. Slots are held in depth-first
+ * hierarchical order, so that the slot of each node follows the slot of its parent, and the
+ * slots of the descendants of each node immediately follow the slot of that node. As a result,
+ * the parent transform of each node has always been built by the time the node itself is reached
+ * in the linear pass, and marking the transform of a node dirty marks a contiguous range of slots,
+ * without visiting the descendant nodes themselves. The order is rebuilt automatically on the next
+ * update pass after nodes have been added to or removed from the scene.
+ *
+ * While a node is in the store, its location and scale properties, the dirty state of its
+ * transform, and the contents of its globalTransformMatrix are all held in the arrays of the
+ * store, and the globalTransformMatrix of the node is a view onto its slot. The rotator of the
+ * node remains the definitive representation of its rotation, and the node copies the rotation
+ * matrix of the rotator into its slot whenever the node is rotated.
+ *
+ * Nodes whose class overrides any of the template methods used to build the globalTransformMatrix,
+ * nodes that have a localTransformMatrix, and nodes that track a target, cannot have their
+ * transforms built directly from the arrays. Those nodes are still processed in order during the
+ * linear pass, but the store asks the node to build its own globalTransformMatrix instead.
+ *
+ * Between update passes, the globalTransformMatrix of each node continues to be built lazily on
+ * access, as usual, directly into the slot of the node. When the linear pass later reaches a node
+ * whose transform has already been rebuilt that way, there is nothing further to build.
+ *
+ * A CC3NodeTransformStore is created automatically by each CC3Scene, and nodes are added to it
+ * and removed from it automatically as they are added to and removed from the scene. Usually,
+ * the application never needs to interact with the store directly.
+ */
+@interface CC3NodeTransformStore : NSObject {
+	CC3Node* _rootNode;						// weak reference
+	CC3Node** _nodes;						// weak references
+	GLint* _parentSlots;
+	GLuint* _subtreeEnds;
+	CC3Vector* _locations;
+	CC3Matrix3x3* _rotations;
+	CC3Vector* _scales;
+	CC3Matrix4x3* _globalTransforms;
+	GLubyte* _slotFlags;
+	GLuint* _updatedSlots;
+	GLuint _nodeCount;
+	GLuint _updatedNodeCount;
+	GLuint _capacity;
+	BOOL _isOrderDirty : 1;
+}
+
+/**
+ * The node at the root of the hierarchy of nodes held by this store.
+ *
+ * Typically this is the CC3Scene that owns this store.
+ */
+@property(nonatomic, assign, readonly) CC3Node* rootNode;
+
+/** The number of nodes currently held by this store. */
+@property(nonatomic, readonly) GLuint nodeCount;
+
+
+#pragma mark Managing nodes
+
+/**
+ * Adds the specified node to this store, and copies its current location and scale into the
+ * arrays of this store. Thereafter, until the node is removed from this store, the location
+ * and scale properties, and the globalTransformMatrix, of the node are held in this store.
+ *
+ * If the node is already held in this store, or in another store, this method does nothing.
+ */
+-(void) addNode: (CC3Node*) aNode;
+
+/**
+ * Removes the specified node from this store, and copies its location, scale and
+ * globalTransformMatrix from the arrays of this store back into the node.
+ *
+ * If the node is not held in this store, this method does nothing.
+ */
+-(void) removeNode: (CC3Node*) aNode;
+
+/** Removes all nodes from this store, including the root node. */
+-(void) removeAllNodes;
+
+
+#pragma mark Accessing transform state
+
+/** Returns the location held in the specified slot. */
+-(CC3Vector) locationAt: (GLuint) slot;
+
+/** Sets the location held in the specified slot. */
+-(void) setLocation: (CC3Vector) aLocation at: (GLuint) slot;
+
+/** Returns the scale held in the specified slot. */
+-(CC3Vector) scaleAt: (GLuint) slot;
+
+/** Sets the scale held in the specified slot. */
+-(void) setScale: (CC3Vector) aScale at: (GLuint) slot;
+
+/**
+ * Sets the rotation held in the specified slot from the specified rotation matrix.
+ * If the matrix is nil, the slot holds no rotation.
+ *
+ * This method is invoked automatically by the node whenever its rotation changes.
+ */
+-(void) setRotation: (CC3Matrix*) aRotationMatrix at: (GLuint) slot;
+
+/**
+ * Sets whether the global transform of the node in the specified slot is currently defined only by
+ * its location, rotation and scale. If it is, and the class of the node uses the standard local
+ * transforms, the global transform is built directly from the arrays during the update pass.
+ *
+ * This method is invoked automatically by the node whenever this state changes.
+ */
+-(void) setHasStandardLocalTransforms: (BOOL) isStandard at: (GLuint) slot;
+
+/**
+ * Sets whether the node in the specified slot must be notified when its transform is marked dirty,
+ * either directly, or because the transform of an ancestor was marked dirty. Nodes that have a
+ * bounding volume or transform listeners must be notified.
+ *
+ * This method is invoked automatically by the node whenever this state changes.
+ */
+-(void) setNeedsTransformDirtyNotification: (BOOL) shouldNotify at: (GLuint) slot;
+
+/** Returns a pointer to the global transform held in the specified slot. */
+-(CC3Matrix4x3*) globalTransformAt: (GLuint) slot;
+
+/**
+ * Returns whether the global transform held in the specified slot is dirty, and must be
+ * rebuilt before it is used.
+ */
+-(BOOL) isTransformDirtyAt: (GLuint) slot;
+
+/**
+ * Marks the transform held in the specified slot, and the transforms of all descendants of the
+ * node in that slot, as dirty, so that they will be rebuilt when next accessed, or during the
+ * next invocation of the updateTransforms method, whichever comes first.
+ *
+ * Descendant slots are marked directly, without messaging the descendant nodes, except for those
+ * nodes that need to be notified, as indicated by the setNeedsTransformDirtyNotification:at: method,
+ * or whose class overrides the markTransformDirty method.
+ *
+ * If the transform in the specified slot is already dirty, this method does nothing.
+ *
+ * This method is invoked automatically from the markTransformDirty method of the node.
+ */
+-(void) markTransformDirtyAt: (GLuint) slot;
+
+/**
+ * Marks the node in the specified slot as changed, without marking its transform dirty, so that the
+ * node will be processed, and refit within the nodeBoundsTree of the scene, during the next update pass.
+ *
+ * This method is invoked automatically when the shape of the bounding volume of the node changes.
+ */
+-(void) markBoundsDirtyAt: (GLuint) slot;
+
+/**
+ * Ensures that the global transform held in the specified slot is up to date before it is used.
+ *
+ * If the transform is dirty, the node rebuilds it. If the transform was rebuilt by this store
+ * since the node last used it, the node is informed that the contents of its globalTransformMatrix
+ * have changed.
+ *
+ * This method is invoked automatically when the globalTransformMatrix of the node is accessed.
+ */
+-(void) validateTransformAt: (GLuint) slot;
+
+
+#pragma mark Updating
+
+/**
+ * Rebuilds the global transform of each node held in this store whose transform is dirty.
+ *
+ * The nodes are processed in a single pass in hierarchical order. For most nodes, the global
+ * transform is calculated directly from the arrays held in this store, by multiplying the global
+ * transform of the parent node by the location, rotation and scale held for the node, and the
+ * result is written directly into the slot that holds the globalTransformMatrix of the node.
+ * The nodes themselves are not messaged.
+ *
+ * This method is invoked automatically by the CC3Scene during each update pass, after the
+ * updateVisitor has updated all of the nodes in the scene.
+ */
+-(void) updateTransforms;
+
+/**
+ * The number of nodes whose slot was changed, and was therefore processed, during the most
+ * recent invocation of the updateTransforms method.
+ *
+ * This value is reset to zero whenever a node is added to or removed from this store.
+ */
+@property(nonatomic, readonly) GLuint updatedNodeCount;
+
+/**
+ * Returns the node at the specified index within the nodes that were processed during the most
+ * recent invocation of the updateTransforms method. The index must be less than the value of
+ * the updatedNodeCount property.
+ *
+ * The CC3Scene uses this list to refit only those nodes that have moved within its nodeBoundsTree.
+ */
+-(CC3Node*) updatedNodeAt: (GLuint) index;
+
+
+#pragma mark Allocation and initialization
+
+/** Initializes this instance with the specified root node, which is added to this store. */
+-(id) initWithRootNode: (CC3Node*) aNode;
+
+/** Allocates and initializes an autoreleased instance with the specified root node. */
++(id) storeWithRootNode: (CC3Node*) aNode;
+
+@end
+
+
+#pragma mark -
+#pragma mark CC3NodeBoundsTree
+
+/** The result of testing an entry of a CC3NodeBoundsTree against the planes of a frustum. */
+typedef enum {
+	kCC3BoundsCullOutside = 0,		/**< The bounds are completely outside the frustum. */
+	kCC3BoundsCullIntersecting,		/**< The bounds straddle at least one plane of the frustum. */
+	kCC3BoundsCullInside,			/**< The bounds are completely inside the frustum. */
+} CC3BoundsCullResult;
+
+/**
+ * An entry in a CC3NodeBoundsTree. Each entry is either a leaf, which holds a single node, or a
+ * branch, which has two child entries, and whose bounds enclose the bounds of both children.
+ */
+typedef struct {
+	CC3Box bounds;				/**< The global bounds of this entry. For leaves, this includes padding. */
+	CC3Node* node;				/**< The node held by a leaf entry, or nil for a branch entry. */
+	GLint parent;				/**< The parent entry, or the next free entry if this entry is not in use. */
+	GLint child1;				/**< The first child entry, or -1 for a leaf entry. */
+	GLint child2;				/**< The second child entry, or -1 for a leaf entry. */
+	GLint height;				/**< Zero for a leaf, or the height of the branch. -1 if not in use. */
+} CC3NodeBoundsTreeEntry;
+
+/**
+ * A block that tests whether a ray punctures the specified node, and returns the distance from
+ * the startLocation of the ray to the puncture, or returns a negative value if the node is not
+ * punctured by the ray. Used by the testNodesAlongRay:closestOnly:withBlock: method of
+ * CC3NodeBoundsTree.
+ */
+typedef GLfloat (^CC3NodeRayTestBlock)(CC3Node* aNode);
+
+/**
+ * CC3NodeBoundsTree is a dynamic bounding volume hierarchy of axis-aligned boxes, holding the
+ * global bounds of the nodes in a scene.
+ *
+ * Each node is held in a leaf of the tree, whose box encloses the globalBoundingBox of the
+ * bounding volume of the node, padded by a fraction of its size, as determined by the
+ * boundsPadding property. Leaves are combined into branches, so that the boxes of sibling
+ * entries overlap as little as possible, and the tree is kept balanced as nodes are added,
+ * moved and removed.
+ *
+ * When the transform or bounding volume of a node changes, the node is refitted within the tree.
+ * Because of the padding, a node may move a short distance without requiring any change to the
+ * tree. Only when the bounds of the node escape the padded box of its leaf is the leaf removed
+ * from the tree and reinserted. Nodes that do not move cost nothing to keep in the tree.
+ *
+ * The tree can be tested against the planes of a frustum, to determine whether the nodes in the
+ * tree are outside, inside, or straddling the frustum. A branch whose box is outside, or inside,
+ * the frustum resolves all of the nodes within that branch with a single test.
+ *
+ * The tree can also be traversed along a ray, to find the nodes that the ray punctures, in
+ * approximate order of distance from the start of the ray. Branches whose box is missed by the
+ * ray, or that lie beyond the closest puncture found so far, are skipped with a single test.
+ *
+ * Only nodes that have local content, and whose intersection with a frustum is determined solely
+ * by their own bounding volume, are held in the leaves of the tree. Nodes whose class overrides
+ * the frustum intersection methods, nodes that share a bounding volume with another node, and
+ * nodes whose bounding volume cannot be enclosed by a finite box, are held separately as unbounded
+ * nodes. Unbounded nodes continue to be tested individually against the frustum, and are always
+ * tested when the tree is traversed along a ray. Nodes that have no bounding volume at all are
+ * not held by the tree.
+ *
+ * A CC3NodeBoundsTree is created automatically by each CC3Scene, and nodes are added to it and
+ * removed from it automatically. Usually, the application never needs to interact with the tree
+ * directly.
+ */
+@interface CC3NodeBoundsTree : NSObject {
+	CC3NodeBoundsTreeEntry* _entries;
+	CC3Node** _unboundedNodes;				// weak references
+	GLint _rootEntry;
+	GLint _freeEntry;
+	GLuint _entryCapacity;
+	GLuint _nodeCount;
+	GLuint _unboundedNodeCount;
+	GLuint _unboundedNodeCapacity;
+	GLuint _structureVersion;
+	GLfloat _boundsPadding;
+}
+
+/** The number of nodes held in the leaves of this tree. */
+@property(nonatomic, readonly) GLuint nodeCount;
+
+/**
+ * The number of nodes held by this tree that have a bounding volume, but cannot be held in a
+ * leaf of this tree. See the notes for this class for more information about unbounded nodes.
+ */
+@property(nonatomic, readonly) GLuint unboundedNodeCount;
+
+/**
+ * The number of entries allocated for this tree. Each entry is identified by an index that is
+ * less than this value. A tree that holds N nodes uses (2N - 1) entries.
+ */
+@property(nonatomic, readonly) GLuint entryCapacity;
+
+/**
+ * A value that changes whenever an entry of this tree is added, removed or reassigned.
+ *
+ * Results collected by the classifyAgainstFrustum:into: method are indexed by entry, and remain
+ * valid only while the value of this property remains unchanged.
+ */
+@property(nonatomic, readonly) GLuint structureVersion;
+
+/** The box that encloses all of the nodes in this tree, or kCC3BoxNull if this tree is empty. */
+@property(nonatomic, readonly) CC3Box boundingBox;
+
+/**
+ * The padding added to the bounds of each node when it is inserted into a leaf of this tree,
+ * expressed as a fraction of the largest dimension of those bounds.
+ *
+ * Larger values allow nodes to move further before they must be reinserted into the tree, at
+ * the cost of looser boxes, and therefore less effective culling.
+ *
+ * The initial value of this property is 0.1, adding 10% of the size of the node on each side.
+ */
+@property(nonatomic, assign) GLfloat boundsPadding;
+
+
+#pragma mark Managing nodes
+
+/**
+ * Adds the specified node to this tree, refits the node within this tree, or removes the node
+ * from this tree, as appropriate for the current state of the node.
+ *
+ * If the node can be held in a leaf of this tree, but is not yet, it is inserted. If the node is
+ * already held in a leaf, and its bounds have escaped the padded box of that leaf, or have become
+ * much smaller than that box, the leaf is reinserted. If the node has a bounding volume that cannot
+ * be held in a leaf, it is held as an unbounded node. If the node no longer has a bounding volume,
+ * it is removed from this tree.
+ *
+ * The CC3Scene invokes this method automatically for each node whose transform or bounding
+ * volume has changed.
+ */
+-(void) updateNode: (CC3Node*) aNode;
+
+/** Removes the specified node from this tree. If the node is not held in this tree, does nothing. */
+-(void) removeNode: (CC3Node*) aNode;
+
+/** Removes all nodes from this tree. */
+-(void) removeAllNodes;
+
+/**
+ * Returns the node held in the specified leaf entry, or nil if the entry is not a leaf.
+ *
+ * Each node held in this tree knows the index of its leaf entry.
+ */
+-(CC3Node*) nodeAtLeaf: (GLint) leaf;
+
+
+#pragma mark Culling
+
+/**
+ * Tests the entries in this tree against the planes of the specified frustum, and records a
+ * CC3BoundsCullResult value for each leaf entry into the specified results array, which must
+ * have space for at least entryCapacity values.
+ *
+ * The tree is traversed from the root. Once the box of a branch is found to be completely outside
+ * the frustum, none of the entries within that branch are tested, and all of the leaves within it
+ * retain the value kCC3BoundsCullOutside. Once the box of a branch is found to be completely inside
+ * the frustum, all of the leaves within it are marked as kCC3BoundsCullInside without being tested.
+ * Leaves whose boxes straddle at least one plane of the frustum are marked kCC3BoundsCullIntersecting,
+ * and the nodes held in those leaves should be tested individually against the frustum.
+ *
+ * Returns the number of boxes that were tested against the frustum.
+ */
+-(GLuint) classifyAgainstFrustum: (CC3Frustum*) aFrustum into: (GLubyte*) results;
+
+
+#pragma mark Ray tracing
+
+/**
+ * Invokes the specified block on the nodes held by this tree that the specified global ray may
+ * puncture, and returns the number of nodes on which the block was invoked.
+ *
+ * The block is invoked on each unbounded node, and on each node whose leaf box is punctured by the
+ * ray, ahead of the startLocation of the ray. The leaves are traversed in approximate order of
+ * distance along the ray, by descending first into the child branch whose box the ray enters first.
+ * The block returns the distance from the startLocation of the ray to the puncture on the node, or
+ * a negative value if the ray does not puncture the node.
+ *
+ * If the closestOnly parameter is YES, any branch whose box the ray enters beyond the closest
+ * puncture returned so far by the block is skipped, along with all of the nodes within it. Since
+ * the box of each leaf encloses the bounding volume of its node, no node that is skipped could
+ * have been punctured closer to the startLocation of the ray than the closest puncture found.
+ * If the closestOnly parameter is NO, the block is invoked on every node whose leaf box is
+ * punctured by the ray.
+ *
+ * The tree must not be changed by the block.
+ */
+-(GLuint) testNodesAlongRay: (CC3Ray) aRay
+				closestOnly: (BOOL) closestOnly
+				  withBlock: (CC3NodeRayTestBlock) nodeTest;
+
+
+#pragma mark Allocation and initialization
+
+/** Allocates and initializes an autoreleased instance. */
++(id) tree;
+
+@end
+
+
 #pragma mark -
 #pragma mark CC3Node extension for scene
 
@@ -38,6 +38,7 @@
 #import "CC3Billboard.h"
 #import "CC3ShadowVolumes.h"
 #import "CC3AffineMatrix.h"
+#import "CC3PVRTexture.h"
 #import "CC3CC2Extensions.h"
 #import "CGPointExtension.h"
 #import "ccMacros.h"
@@ -51,6 +52,14 @@
 
 @interface CC3Node (TemplateMethods)
 @property(nonatomic, unsafe_unretained, readwrite) CC3Node* parent;	// Backdrop needs to have parent set
+@property(nonatomic, readonly) GLuint transformSlot;
++(BOOL) usesStandardLocalTransforms;
++(BOOL) usesStandardTransformDirtyMarking;
+-(void) setTransformStore: (CC3NodeTransformStore*) aStore atSlot: (GLuint) aSlot;
+-(void) transformWasMarkedDirty;
+-(void) refreshGlobalTransformMatrix: (BOOL) isStale;
+@property(nonatomic, assign) GLint boundsTreeLeaf;
++(BOOL) usesStandardFrustumIntersection;
 @end
 
 
@@ -67,6 +76,7 @@
 @synthesize lights=_lights, lightProbes=_lightProbes;
 @synthesize elapsedTimeSinceOpened=_elapsedTimeSinceOpened;
 @synthesize shouldDisplayPickingRender=_shouldDisplayPickingRender;
+@synthesize nodeBoundsTree=_nodeBoundsTree;
 
 /**
  * Descendant nodes will be removed by superclass. Their removal may invoke
@@ -89,6 +99,12 @@
 	self.touchedNodePicker = nil;			// Use setter to release and make nil
 	self.performanceStatistics = nil;		// Use setter to release and make nil
 	
+	[_nodeTransforms removeAllNodes];		// Return transform state to the nodes
+	[_nodeTransforms release];
+	_nodeTransforms = nil;					// Make nil so won't be referenced during parent dealloc
+	[_nodeBoundsTree removeAllNodes];		// Release the nodes from their leaves
+	[_nodeBoundsTree release];
+	_nodeBoundsTree = nil;					// Make nil so won't be referenced during parent dealloc
 	[_lights release];
 	_lights = nil;							// Make nil so won't be referenced during parent dealloc
 	[_lightProbes release];
@@ -220,6 +236,8 @@
 		self.shadowVisitor = nil;
 		self.updateVisitor = [[self updateVisitorClass] visitor];
 		self.touchedNodePicker = [CC3TouchedNodePicker pickerOnScene: self];
+		_nodeTransforms = [[CC3NodeTransformStore alloc] initWithRootNode: self];	// retained
+		_nodeBoundsTree = [CC3NodeBoundsTree new];									// retained
 		_cc3Layer = nil;
 		_backdrop = nil;
 		_fog = nil;
@@ -329,6 +347,7 @@
 	
 	_updateVisitor.deltaTime = _deltaFrameTime;
 	[_updateVisitor visit: self];
+	[self updateNodeBoundsTree];
 	
 	[self updateCamera: _deltaFrameTime];
 	[self updateBillboards: _deltaFrameTime];
@@ -338,6 +357,16 @@
 	LogTrace(@"******* %@ exiting update", self);
 }
 
+-(void) updateNodeBoundsTree {
+	[_nodeTransforms updateTransforms];
+
+	GLuint updCnt = _nodeTransforms.updatedNodeCount;
+	for (GLuint updIdx = 0; updIdx < updCnt; updIdx++)
+		[_nodeBoundsTree updateNode: [_nodeTransforms updatedNodeAt: updIdx]];
+
+	[_performanceStatistics addNodesTransformed: updCnt];
+}
+
 -(void) updateScene {
 	BOOL wasRunning = _isRunning;
 	_isRunning = YES;
@@ -390,6 +419,8 @@
 	
 	[self collectFrameInterval];	// Collect the frame interval in the performance statistics.
 
+	[CC3PVRTexture streamMipmaps];	// Stream in more detailed mipmap levels of PVR textures
+
 	[self open3DWithVisitor: visitor];
 	
 	[_touchedNodePicker pickTouchedNodeWithVisitor: visitor];
@@ -629,6 +660,9 @@
 	NSArray* allAdded = [aNode flatten];
 	for (CC3Node* addedNode in allAdded) {
 	
+		// Move the transform state of the node into the transform store
+		[_nodeTransforms addNode: addedNode];
+		
 		// Attempt to add the node to the draw sequence sorter.
 		[_drawingSequencer add: addedNode withVisitor: _drawingSequenceVisitor];
 		
@@ -663,6 +697,12 @@
 	NSArray* allRemoved = [aNode flatten];
 	for (CC3Node* removedNode in allRemoved) {
 		
+		// Move the transform state of the node back out of the transform store
+		[_nodeTransforms removeNode: removedNode];
+		
+		// Remove the node from the bounds hierarchy used for culling
+		[_nodeBoundsTree removeNode: removedNode];
+		
 		// Attempt to remove the node to the draw sequence sorter.
 		[_drawingSequencer remove: removedNode withVisitor: _drawingSequenceVisitor];
 		
@@ -737,10 +777,12 @@
 @implementation CC3TouchedNodePicker
 
 @synthesize pickVisitor=_pickVisitor, touchPoint=_touchPoint, pickedNode=_pickedNode;
+@synthesize puncturingVisitor=_puncturingVisitor, shouldPickWithRay=_shouldPickWithRay;
 
 -(void) dealloc {
 	_scene = nil;				// weak reference
 	[_pickVisitor release];
+	[_puncturingVisitor release];
 	[_pickedNode release];
 	
 	[super dealloc];
@@ -773,6 +815,14 @@
 	_wasPicked = _wasTouched;
 	_wasTouched = NO;
 	
+	// Trace a ray from the camera through the touch point into the scene
+	if (_shouldPickWithRay && !_scene.shouldDisplayPickingRender) {
+		_puncturingVisitor.ray = [visitor.camera unprojectPoint: _touchPoint];
+		[_puncturingVisitor visit: _scene];
+		self.pickedNode = _puncturingVisitor.closestPuncturedNode;
+		return;
+	}
+	
 	// Draw the scene for node picking. Don't bother drawing the backdrop.
 	[_pickVisitor alignShotWith: visitor];
 	[_pickVisitor visit: _scene];
@@ -813,6 +863,11 @@
 	if ( (self = [super init]) ) {
 		_scene = aCC3Scene;					// weak reference
 		self.pickVisitor = [[_scene pickVisitorClass] visitor];
+		self.puncturingVisitor = [CC3NodePuncturingVisitor visitor];
+		_puncturingVisitor.shouldFindClosestOnly = YES;
+		_puncturingVisitor.shouldPunctureMeshFaces = YES;
+		_puncturingVisitor.shouldPunctureOnlyTouchableNodes = YES;
+		_shouldPickWithRay = NO;
 		_touchPoint = CGPointZero;
 		_wasTouched = NO;
 		_wasPicked = NO;
@@ -829,6 +884,1013 @@
 @end
 
 
+#pragma mark -
+#pragma mark CC3NodeTransformStore
+
+/** The node in the slot has changed, and must be processed during the next update pass. */
+#define kCC3TransformSlotDirty			0x01
+
+/** The class of the node in the slot uses the standard local transform template methods. */
+#define kCC3TransformSlotStandard		0x02
+
+/** The node in the slot has a localTransformMatrix or tracks a target, and must build its own transform. */
+#define kCC3TransformSlotCustom			0x04
+
+/** The global transform in the slot is out of date, and must be rebuilt before it is used. */
+#define kCC3TransformSlotStale			0x08
+
+/** The global transform in the slot was rebuilt by the store since the node last used it. */
+#define kCC3TransformSlotWritten		0x10
+
+/** The node in the slot must be notified whenever its transform is marked dirty. */
+#define kCC3TransformSlotNotify			0x20
+
+/** The class of the node in the slot overrides the markTransformDirty method. */
+#define kCC3TransformSlotCustomMarking	0x40
+
+/** The parent slot value for a node that has no parent. */
+#define kCC3TransformSlotNoParent		-1
+
+/** The parent slot value for a node whose parent does not precede it in the store. */
+#define kCC3TransformSlotUnordered		-2
+
+/**
+ * Builds the specified global transform from the specified parent global transform, followed
+ * by the specified location, rotation and scale. The parent transform may be NULL if the node
+ * has no parent.
+ */
+static void CC3NodeTransformStoreBuildGlobalTransform(CC3Matrix4x3* gMtx, CC3Matrix4x3* parentMtx,
+													  CC3Vector location, CC3Matrix3x3* rotMtx3x3,
+													  CC3Vector scale) {
+	if (parentMtx)
+		CC3Matrix4x3PopulateFrom4x3(gMtx, parentMtx);
+	else
+		CC3Matrix4x3PopulateIdentity(gMtx);
+
+	CC3Matrix4x3TranslateBy(gMtx, location);
+
+	CC3Matrix4x3 rotMtx, mRslt;
+	CC3Matrix4x3PopulateFrom3x3(&rotMtx, rotMtx3x3);
+	CC3Matrix4x3Multiply(&mRslt, gMtx, &rotMtx);
+	CC3Matrix4x3ScaleBy(&mRslt, CC3EnsureMinScaleVector(scale));
+	CC3Matrix4x3PopulateFrom4x3(gMtx, &mRslt);
+}
+
+@implementation CC3NodeTransformStore
+
+@synthesize rootNode=_rootNode, nodeCount=_nodeCount, updatedNodeCount=_updatedNodeCount;
+
+-(void) dealloc {
+	[self removeAllNodes];
+	free(_nodes);
+	free(_parentSlots);
+	free(_subtreeEnds);
+	free(_locations);
+	free(_rotations);
+	free(_scales);
+	free(_globalTransforms);
+	free(_slotFlags);
+	free(_updatedSlots);
+	[super dealloc];
+}
+
+
+#pragma mark Managing nodes
+
+/**
+ * Ensures the arrays have room for at least the specified number of nodes. If the global
+ * transforms are moved, the globalTransformMatrix of each node is pointed to its new slot.
+ */
+-(void) ensureCapacity: (GLuint) nodeCount {
+	if (nodeCount <= _capacity) return;
+
+	GLuint newCap = MAX(_capacity * 2, 16);
+	while (newCap < nodeCount) newCap *= 2;
+
+	CC3Matrix4x3* oldGlobalTransforms = _globalTransforms;
+	_nodes = realloc(_nodes, newCap * sizeof(CC3Node*));
+	_parentSlots = realloc(_parentSlots, newCap * sizeof(GLint));
+	_subtreeEnds = realloc(_subtreeEnds, newCap * sizeof(GLuint));
+	_locations = realloc(_locations, newCap * sizeof(CC3Vector));
+	_rotations = realloc(_rotations, newCap * sizeof(CC3Matrix3x3));
+	_scales = realloc(_scales, newCap * sizeof(CC3Vector));
+	_globalTransforms = realloc(_globalTransforms, newCap * sizeof(CC3Matrix4x3));
+	_slotFlags = realloc(_slotFlags, newCap * sizeof(GLubyte));
+	_updatedSlots = realloc(_updatedSlots, newCap * sizeof(GLuint));
+	_capacity = newCap;
+
+	if (_globalTransforms != oldGlobalTransforms)
+		for (GLuint slot = 0; slot < _nodeCount; slot++) [_nodes[slot] setTransformStore: self atSlot: slot];
+}
+
+-(void) addNode: (CC3Node*) aNode {
+	if ( !aNode || aNode.transformStore ) return;
+
+	[self ensureCapacity: (_nodeCount + 1)];
+	GLuint slot = _nodeCount++;
+	_nodes[slot] = aNode;
+	_parentSlots[slot] = kCC3TransformSlotUnordered;
+	_subtreeEnds[slot] = slot + 1;
+	CC3Matrix3x3PopulateIdentity(&_rotations[slot]);
+	CC3Matrix4x3PopulateIdentity(&_globalTransforms[slot]);
+	_slotFlags[slot] = kCC3TransformSlotDirty | kCC3TransformSlotStale;
+	Class nodeClass = aNode.class;
+	if ([nodeClass usesStandardLocalTransforms]) _slotFlags[slot] |= kCC3TransformSlotStandard;
+	if ( ![nodeClass usesStandardTransformDirtyMarking] ) _slotFlags[slot] |= kCC3TransformSlotCustomMarking;
+
+	// Node copies its location, scale, rotation and state into the slot,
+	// and points its globalTransformMatrix at the slot.
+	[aNode setTransformStore: self atSlot: slot];
+	_isOrderDirty = YES;
+	_updatedNodeCount = 0;
+}
+
+/** Copies the content of one slot into another. */
+-(void) copySlot: (GLuint) srcSlot to: (GLuint) dstSlot {
+	_nodes[dstSlot] = _nodes[srcSlot];
+	_parentSlots[dstSlot] = _parentSlots[srcSlot];
+	_subtreeEnds[dstSlot] = _subtreeEnds[srcSlot];
+	_locations[dstSlot] = _locations[srcSlot];
+	_rotations[dstSlot] = _rotations[srcSlot];
+	_scales[dstSlot] = _scales[srcSlot];
+	_globalTransforms[dstSlot] = _globalTransforms[srcSlot];
+	_slotFlags[dstSlot] = _slotFlags[srcSlot];
+}
+
+-(void) removeNode: (CC3Node*) aNode {
+	if (aNode.transformStore != self) return;
+
+	GLuint slot = aNode.transformSlot;
+	CC3Assert(slot < _nodeCount && _nodes[slot] == aNode, @"%@ is not held in slot %u of %@", aNode, slot, self);
+
+	// Node copies its location, scale and globalTransformMatrix back out of the slot
+	[aNode setTransformStore: nil atSlot: 0];
+	if (aNode == _rootNode) _rootNode = nil;
+
+	// Fill the vacated slot with the last slot. Order is restored on the next update pass.
+	GLuint lastSlot = --_nodeCount;
+	if (slot != lastSlot) {
+		[self copySlot: lastSlot to: slot];
+		[_nodes[slot] setTransformStore: self atSlot: slot];
+	}
+	_isOrderDirty = YES;
+	_updatedNodeCount = 0;
+}
+
+-(void) removeAllNodes {
+	for (GLuint slot = 0; slot < _nodeCount; slot++) [_nodes[slot] setTransformStore: nil atSlot: 0];
+	_nodeCount = 0;
+	_updatedNodeCount = 0;
+	_rootNode = nil;
+	_isOrderDirty = NO;
+}
+
+/**
+ * Rearranges the slots into depth-first hierarchical order, starting at the root node, so that
+ * the slot of each node follows the slot of its parent, and the slots of the descendants of each
+ * node form a contiguous range immediately following the slot of the node. Records the parent
+ * slot of each node, and the end of the range of slots occupied by the subtree of each node.
+ * Any nodes that cannot be reached from the root node are moved to the end, and will build
+ * their own transforms during the update pass.
+ */
+-(void) reorderSlots {
+	_isOrderDirty = NO;
+	if (_nodeCount == 0) return;
+
+	// Collect the old slots in depth-first order, using a stack of old slots, and using the
+	// parent slot array to mark each old slot as it is pushed. Each pushed slot holds the
+	// new slot of its parent until the slot is popped.
+	GLuint* order = malloc(_nodeCount * sizeof(GLuint));
+	GLuint* stack = malloc(_nodeCount * sizeof(GLuint));
+	GLuint orderCnt = 0;
+	GLuint stackCnt = 0;
+	for (GLuint slot = 0; slot < _nodeCount; slot++) _parentSlots[slot] = kCC3TransformSlotUnordered;
+	if (_rootNode.transformStore == self) {
+		stack[stackCnt++] = _rootNode.transformSlot;
+		_parentSlots[_rootNode.transformSlot] = kCC3TransformSlotNoParent;
+	}
+	while (stackCnt > 0) {
+		GLuint oldSlot = stack[--stackCnt];
+		GLuint newSlot = orderCnt;
+		order[orderCnt++] = oldSlot;
+		for (CC3Node* child in _nodes[oldSlot].children) {
+			if (child.transformStore != self) continue;
+			GLuint childSlot = child.transformSlot;
+			if (_parentSlots[childSlot] != kCC3TransformSlotUnordered) continue;
+			_parentSlots[childSlot] = newSlot;		// Parent slot in the new order
+			stack[stackCnt++] = childSlot;
+		}
+	}
+	free(stack);
+	GLuint orderedCnt = orderCnt;
+	for (GLuint slot = 0; slot < _nodeCount; slot++)
+		if (_parentSlots[slot] == kCC3TransformSlotUnordered) order[orderCnt++] = slot;
+
+	// Permute all arrays into the new order
+	CC3Node** nodes = malloc(_capacity * sizeof(CC3Node*));
+	GLint* parentSlots = malloc(_capacity * sizeof(GLint));
+	GLuint* subtreeEnds = malloc(_capacity * sizeof(GLuint));
+	CC3Vector* locations = malloc(_capacity * sizeof(CC3Vector));
+	CC3Matrix3x3* rotations = malloc(_capacity * sizeof(CC3Matrix3x3));
+	CC3Vector* scales = malloc(_capacity * sizeof(CC3Vector));
+	CC3Matrix4x3* globalTransforms = malloc(_capacity * sizeof(CC3Matrix4x3));
+	GLubyte* slotFlags = malloc(_capacity * sizeof(GLubyte));
+	for (GLuint slot = 0; slot < _nodeCount; slot++) {
+		GLuint oldSlot = order[slot];
+		nodes[slot] = _nodes[oldSlot];
+		parentSlots[slot] = _parentSlots[oldSlot];
+		subtreeEnds[slot] = slot + 1;
+		locations[slot] = _locations[oldSlot];
+		rotations[slot] = _rotations[oldSlot];
+		scales[slot] = _scales[oldSlot];
+		globalTransforms[slot] = _globalTransforms[oldSlot];
+		slotFlags[slot] = _slotFlags[oldSlot];
+	}
+	free(order);
+
+	// Each subtree ends where the last subtree of its children ends. Working backwards,
+	// the subtree of each child is complete before it is folded into its parent.
+	for (GLuint slot = orderedCnt; slot-- > 0; ) {
+		GLint parentSlot = parentSlots[slot];
+		if (parentSlot >= 0) subtreeEnds[parentSlot] = MAX(subtreeEnds[parentSlot], subtreeEnds[slot]);
+	}
+
+	free(_nodes);				_nodes = nodes;
+	free(_parentSlots);			_parentSlots = parentSlots;
+	free(_subtreeEnds);			_subtreeEnds = subtreeEnds;
+	free(_locations);			_locations = locations;
+	free(_rotations);			_rotations = rotations;
+	free(_scales);				_scales = scales;
+	free(_globalTransforms);	_globalTransforms = globalTransforms;
+	free(_slotFlags);			_slotFlags = slotFlags;
+
+	for (GLuint slot = 0; slot < _nodeCount; slot++) [_nodes[slot] setTransformStore: self atSlot: slot];
+}
+
+
+#pragma mark Accessing transform state
+
+-(CC3Vector) locationAt: (GLuint) slot { return _locations[slot]; }
+
+-(void) setLocation: (CC3Vector) aLocation at: (GLuint) slot { _locations[slot] = aLocation; }
+
+-(CC3Vector) scaleAt: (GLuint) slot { return _scales[slot]; }
+
+-(void) setScale: (CC3Vector) aScale at: (GLuint) slot { _scales[slot] = aScale; }
+
+-(void) setRotation: (CC3Matrix*) aRotationMatrix at: (GLuint) slot {
+	if (aRotationMatrix)
+		[aRotationMatrix populateCC3Matrix3x3: &_rotations[slot]];
+	else
+		CC3Matrix3x3PopulateIdentity(&_rotations[slot]);
+}
+
+-(void) setHasStandardLocalTransforms: (BOOL) isStandard at: (GLuint) slot {
+	if (isStandard)
+		_slotFlags[slot] &= ~kCC3TransformSlotCustom;
+	else
+		_slotFlags[slot] |= kCC3TransformSlotCustom;
+}
+
+-(void) setNeedsTransformDirtyNotification: (BOOL) shouldNotify at: (GLuint) slot {
+	if (shouldNotify)
+		_slotFlags[slot] |= kCC3TransformSlotNotify;
+	else
+		_slotFlags[slot] &= ~kCC3TransformSlotNotify;
+}
+
+-(CC3Matrix4x3*) globalTransformAt: (GLuint) slot { return &_globalTransforms[slot]; }
+
+-(BOOL) isTransformDirtyAt: (GLuint) slot { return (_slotFlags[slot] & kCC3TransformSlotStale) != 0; }
+
+-(void) markTransformDirtyAt: (GLuint) slot {
+	if (_slotFlags[slot] & kCC3TransformSlotStale) return;
+
+	// If the slots are not currently in hierarchical order, subtrees do not occupy contiguous
+	// ranges of slots, so mark this slot, and descend through the children of the node.
+	if (_isOrderDirty || _parentSlots[slot] == kCC3TransformSlotUnordered) {
+		_slotFlags[slot] |= (kCC3TransformSlotDirty | kCC3TransformSlotStale);
+		CC3Node* node = _nodes[slot];
+		if (_slotFlags[slot] & kCC3TransformSlotNotify) [node transformWasMarkedDirty];
+		for (CC3Node* child in node.children) [child markTransformDirty];
+		return;
+	}
+
+	// Mark the contiguous range of slots occupied by the subtree of the node. If a descendant is
+	// already dirty, so is its own subtree, which can be skipped. Descendants are only messaged if
+	// they need to be notified, or if their class extends the markTransformDirty method, in which
+	// case the superclass implementation will find the descendant slot already marked.
+	GLuint endSlot = _subtreeEnds[slot];
+	for (GLuint subSlot = slot; subSlot < endSlot; subSlot++) {
+		GLubyte flags = _slotFlags[subSlot];
+		if (flags & kCC3TransformSlotStale) {
+			subSlot = _subtreeEnds[subSlot] - 1;
+			continue;
+		}
+		_slotFlags[subSlot] = flags | kCC3TransformSlotDirty | kCC3TransformSlotStale;
+		if (flags & kCC3TransformSlotNotify) [_nodes[subSlot] transformWasMarkedDirty];
+		if ((flags & kCC3TransformSlotCustomMarking) && subSlot != slot) [_nodes[subSlot] markTransformDirty];
+	}
+}
+
+-(void) markBoundsDirtyAt: (GLuint) slot { _slotFlags[slot] |= kCC3TransformSlotDirty; }
+
+-(void) validateTransformAt: (GLuint) slot {
+	GLubyte flags = _slotFlags[slot];
+	if ( !(flags & (kCC3TransformSlotStale | kCC3TransformSlotWritten)) ) return;
+
+	_slotFlags[slot] = flags & ~(kCC3TransformSlotStale | kCC3TransformSlotWritten);
+	[_nodes[slot] refreshGlobalTransformMatrix: ((flags & kCC3TransformSlotStale) != 0)];
+}
+
+
+#pragma mark Updating
+
+-(void) updateTransforms {
+	if (_isOrderDirty) [self reorderSlots];
+	_updatedNodeCount = 0;
+
+	for (GLuint slot = 0; slot < _nodeCount; slot++) {
+		GLubyte flags = _slotFlags[slot];
+		if ( !(flags & kCC3TransformSlotDirty) ) continue;
+
+		if (flags & kCC3TransformSlotStale) {
+			GLint parentSlot = _parentSlots[slot];
+			if ((flags & (kCC3TransformSlotStandard | kCC3TransformSlotCustom)) == kCC3TransformSlotStandard &&
+				parentSlot != kCC3TransformSlotUnordered) {
+
+				// The parent slot precedes this slot, and so has already been built during this pass.
+				CC3NodeTransformStoreBuildGlobalTransform(&_globalTransforms[slot],
+														  (parentSlot >= 0) ? &_globalTransforms[parentSlot] : NULL,
+														  _locations[slot], &_rotations[slot], _scales[slot]);
+				flags = (flags & ~kCC3TransformSlotStale) | kCC3TransformSlotWritten;
+			} else {
+				// Node builds its own transform into the slot
+				[self validateTransformAt: slot];
+				flags = _slotFlags[slot];
+			}
+		}
+		_slotFlags[slot] = flags & ~kCC3TransformSlotDirty;
+		_updatedSlots[_updatedNodeCount++] = slot;
+	}
+}
+
+-(CC3Node*) updatedNodeAt: (GLuint) index {
+	CC3Assert(index < _updatedNodeCount, @"%@ index %u is beyond the %u updated nodes", self, index, _updatedNodeCount);
+	return _nodes[_updatedSlots[index]];
+}
+
+
+#pragma mark Allocation and initialization
+
+-(id) init { return [self initWithRootNode: nil]; }
+
+-(id) initWithRootNode: (CC3Node*) aNode {
+	if ( (self = [super init]) ) {
+		_nodes = NULL;
+		_parentSlots = NULL;
+		_subtreeEnds = NULL;
+		_locations = NULL;
+		_rotations = NULL;
+		_scales = NULL;
+		_globalTransforms = NULL;
+		_slotFlags = NULL;
+		_updatedSlots = NULL;
+		_nodeCount = 0;
+		_updatedNodeCount = 0;
+		_capacity = 0;
+		_isOrderDirty = NO;
+		_rootNode = aNode;
+		[self addNode: aNode];
+	}
+	return self;
+}
+
++(id) storeWithRootNode: (CC3Node*) aNode { return [[[self alloc] initWithRootNode: aNode] autorelease]; }
+
+-(NSString*) description {
+	return [NSString stringWithFormat: @"%@ with %u nodes", [self class], _nodeCount];
+}
+
+@end
+
+
+#pragma mark -
+#pragma mark CC3NodeBoundsTree
+
+/** The index value used to indicate the absence of an entry. */
+#define kCC3BoundsTreeNoEntry			-1
+
+/** The maximum depth of the traversal stack. A balanced tree of 2^32 nodes is about 46 deep. */
+#define kCC3BoundsTreeMaxStackDepth		64
+
+/**
+ * The boundsTreeLeaf value of the first unbounded node. The values of subsequent unbounded nodes
+ * count down from this value, so that any negative value other than kCC3BoundsTreeNoEntry
+ * identifies the position of the node in the array of unbounded nodes.
+ */
+#define kCC3BoundsTreeUnboundedBase		-2
+
+/** Returns whether the specified entry is a leaf. */
+static inline BOOL CC3BoundsTreeEntryIsLeaf(CC3NodeBoundsTreeEntry* entry) {
+	return entry->child1 == kCC3BoundsTreeNoEntry;
+}
+
+/** Returns whether the outer box completely contains the inner box. */
+static inline BOOL CC3BoxContainsBox(CC3Box outer, CC3Box inner) {
+	return CC3BoxContainsLocation(outer, inner.minimum) && CC3BoxContainsLocation(outer, inner.maximum);
+}
+
+/**
+ * Tests the specified box against the specified planes, using the corner of the box furthest
+ * behind each plane, and the corner furthest in front of it. The box is outside if it lies
+ * entirely in front of any one plane, and inside if it lies entirely behind all of the planes.
+ */
+static CC3BoundsCullResult CC3BoxCullAgainstPlanes(CC3Box bb, CC3Plane* planes, GLuint planeCount) {
+	CC3BoundsCullResult result = kCC3BoundsCullInside;
+	for (GLuint pIdx = 0; pIdx < planeCount; pIdx++) {
+		CC3Plane p = planes[pIdx];
+		CC3Vector nearCorner = cc3v((p.a < 0.0f) ? bb.maximum.x : bb.minimum.x,
+									(p.b < 0.0f) ? bb.maximum.y : bb.minimum.y,
+									(p.c < 0.0f) ? bb.maximum.z : bb.minimum.z);
+		if (CC3DistanceFromPlane(nearCorner, p) > 0.0f) return kCC3BoundsCullOutside;
+
+		CC3Vector farCorner = cc3v((p.a < 0.0f) ? bb.minimum.x : bb.maximum.x,
+								   (p.b < 0.0f) ? bb.minimum.y : bb.maximum.y,
+								   (p.c < 0.0f) ? bb.minimum.z : bb.maximum.z);
+		if (CC3DistanceFromPlane(farCorner, p) > 0.0f) result = kCC3BoundsCullIntersecting;
+	}
+	return result;
+}
+
+/** Returns the reciprocal of the specified ray direction component, avoiding division by zero. */
+static inline GLfloat CC3BoundsTreeInverseDirection(GLfloat dirComponent) {
+	return 1.0f / ((dirComponent != 0.0f) ? dirComponent : FLT_MIN);
+}
+
+/**
+ * Returns the distance along the ray, from the specified start location, at which the ray enters
+ * the specified box, or returns a negative value if the ray misses the box, or the box is behind
+ * the start location. If the start location is inside the box, returns zero. The direction of the
+ * ray is specified as the reciprocal of each component of a unit vector.
+ */
+static GLfloat CC3BoxRayEntryDistance(CC3Box bb, CC3Vector rayStart, CC3Vector invDir) {
+	GLfloat tx1 = (bb.minimum.x - rayStart.x) * invDir.x;
+	GLfloat tx2 = (bb.maximum.x - rayStart.x) * invDir.x;
+	GLfloat ty1 = (bb.minimum.y - rayStart.y) * invDir.y;
+	GLfloat ty2 = (bb.maximum.y - rayStart.y) * invDir.y;
+	GLfloat tz1 = (bb.minimum.z - rayStart.z) * invDir.z;
+	GLfloat tz2 = (bb.maximum.z - rayStart.z) * invDir.z;
+	GLfloat tNear = MAX(MAX(MIN(tx1, tx2), MIN(ty1, ty2)), MIN(tz1, tz2));
+	GLfloat tFar = MIN(MIN(MAX(tx1, tx2), MAX(ty1, ty2)), MAX(tz1, tz2));
+	tNear = MAX(tNear, 0.0f);
+	return (tNear <= tFar) ? tNear : -1.0f;
+}
+
+@implementation CC3NodeBoundsTree
+
+@synthesize nodeCount=_nodeCount, unboundedNodeCount=_unboundedNodeCount, entryCapacity=_entryCapacity;
+@synthesize structureVersion=_structureVersion, boundsPadding=_boundsPadding;
+
+-(void) dealloc {
+	[self removeAllNodes];
+	free(_entries);
+	free(_unboundedNodes);
+	[super dealloc];
+}
+
+-(CC3Box) boundingBox {
+	return (_rootEntry == kCC3BoundsTreeNoEntry) ? kCC3BoxNull : _entries[_rootEntry].bounds;
+}
+
+
+#pragma mark Allocating entries
+
+/**
+ * Returns the index of an unused entry, expanding the pool of entries if needed.
+ *
+ * Expanding the pool may move the entries in memory, so pointers to entries
+ * must not be held across invocations of this method.
+ */
+-(GLint) allocateEntry {
+	if (_freeEntry == kCC3BoundsTreeNoEntry) {
+		GLuint oldCap = _entryCapacity;
+		GLuint newCap = MAX(oldCap * 2, 16);
+		_entries = realloc(_entries, newCap * sizeof(CC3NodeBoundsTreeEntry));
+		for (GLuint eIdx = oldCap; eIdx < newCap; eIdx++) {
+			_entries[eIdx].node = nil;
+			_entries[eIdx].height = -1;
+			_entries[eIdx].parent = (eIdx + 1 < newCap) ? (GLint)(eIdx + 1) : kCC3BoundsTreeNoEntry;
+		}
+		_freeEntry = oldCap;
+		_entryCapacity = newCap;
+	}
+
+	GLint eIdx = _freeEntry;
+	CC3NodeBoundsTreeEntry* entry = &_entries[eIdx];
+	_freeEntry = entry->parent;
+	entry->bounds = kCC3BoxNull;
+	entry->node = nil;
+	entry->parent = kCC3BoundsTreeNoEntry;
+	entry->child1 = kCC3BoundsTreeNoEntry;
+	entry->child2 = kCC3BoundsTreeNoEntry;
+	entry->height = 0;
+	_structureVersion++;
+	return eIdx;
+}
+
+/** Returns the specified entry to the pool of unused entries. */
+-(void) freeEntry: (GLint) eIdx {
+	CC3NodeBoundsTreeEntry* entry = &_entries[eIdx];
+	entry->node = nil;
+	entry->height = -1;
+	entry->parent = _freeEntry;
+	_freeEntry = eIdx;
+	_structureVersion++;
+}
+
+
+#pragma mark Managing nodes
+
+/**
+ * Returns the global bounds of the specified node, or kCC3BoxNull if the node cannot be held
+ * in this tree, because it has no local content, no bounding volume of its own, or a bounding
+ * volume that cannot be enclosed by a finite box.
+ */
+-(CC3Box) boundsOfNode: (CC3Node*) aNode {
+	CC3NodeBoundingVolume* bv = aNode.boundingVolume;
+	if ( !(bv && bv.node == aNode && aNode.hasLocalContent) ) return kCC3BoxNull;
+	return bv.globalBoundingBox;
+}
+
+/** Returns the specified bounds, padded by the boundsPadding fraction of their largest dimension. */
+-(CC3Box) paddedBounds: (CC3Box) bounds {
+	CC3Vector bbSize = CC3BoxSize(bounds);
+	GLfloat maxDim = MAX(MAX(bbSize.x, bbSize.y), bbSize.z);
+	return CC3BoxAddUniformPadding(bounds, (maxDim * _boundsPadding));
+}
+
+-(void) updateNode: (CC3Node*) aNode {
+	if ( !aNode.boundingVolume ) {
+		[self removeNode: aNode];
+		return;
+	}
+
+	// Avoid building the bounds of nodes whose class does not permit them to be held in a leaf.
+	// A node that already has a leaf has passed that test, and its class cannot have changed.
+	BOOL isStandard = (aNode.boundsTreeLeaf >= 0) || [aNode.class usesStandardFrustumIntersection];
+	CC3Box bounds = isStandard ? [self boundsOfNode: aNode] : kCC3BoxNull;
+	if (CC3BoxIsNull(bounds)) {
+		[self addUnboundedNode: aNode];
+		return;
+	}
+
+	GLint leaf = aNode.boundsTreeLeaf;
+	if (leaf < 0) {
+		[self removeUnboundedNode: aNode];
+		leaf = [self allocateEntry];
+		_entries[leaf].node = aNode;
+		_entries[leaf].bounds = [self paddedBounds: bounds];
+		[aNode setBoundsTreeLeaf: leaf];
+		[self insertLeaf: leaf];
+		_nodeCount++;
+		return;
+	}
+	CC3Assert(_entries[leaf].node == aNode, @"%@ is not held in leaf %i of %@", aNode, leaf, self);
+
+	// If the node is still enclosed by its leaf, and the leaf is not excessively larger
+	// than the node, the tree does not need to change.
+	CC3Box leafBounds = _entries[leaf].bounds;
+	CC3Box padBounds = [self paddedBounds: bounds];
+	if (CC3BoxContainsBox(leafBounds, bounds) &&
+		CC3BoxHalfSurfaceArea(leafBounds) <= (CC3BoxHalfSurfaceArea(padBounds) * 4.0f)) return;
+
+	[self removeLeaf: leaf];
+	_entries[leaf].bounds = padBounds;
+	[self insertLeaf: leaf];
+	_structureVersion++;
+}
+
+/** Holds the specified node as an unbounded node, removing it from its leaf, if it has one. */
+-(void) addUnboundedNode: (CC3Node*) aNode {
+	if (aNode.boundsTreeLeaf <= kCC3BoundsTreeUnboundedBase) return;		// Already unbounded
+	[self removeNode: aNode];
+
+	if (_unboundedNodeCount == _unboundedNodeCapacity) {
+		_unboundedNodeCapacity = MAX(_unboundedNodeCapacity * 2, 16);
+		_unboundedNodes = realloc(_unboundedNodes, _unboundedNodeCapacity * sizeof(CC3Node*));
+	}
+	_unboundedNodes[_unboundedNodeCount] = aNode;
+	[aNode setBoundsTreeLeaf: (kCC3BoundsTreeUnboundedBase - (GLint)_unboundedNodeCount)];
+	_unboundedNodeCount++;
+}
+
+/**
+ * If the specified node is held as an unbounded node, removes it, moving the last unbounded
+ * node into its position. Otherwise, does nothing.
+ */
+-(void) removeUnboundedNode: (CC3Node*) aNode {
+	GLint uIdx = kCC3BoundsTreeUnboundedBase - aNode.boundsTreeLeaf;
+	if (uIdx < 0 || uIdx >= (GLint)_unboundedNodeCount || _unboundedNodes[uIdx] != aNode) return;
+
+	CC3Node* lastNode = _unboundedNodes[--_unboundedNodeCount];
+	_unboundedNodes[uIdx] = lastNode;
+	[lastNode setBoundsTreeLeaf: (kCC3BoundsTreeUnboundedBase - uIdx)];
+	[aNode setBoundsTreeLeaf: kCC3BoundsTreeNoEntry];
+}
+
+-(void) removeNode: (CC3Node*) aNode {
+	GLint leaf = aNode.boundsTreeLeaf;
+	if (leaf <= kCC3BoundsTreeUnboundedBase) {
+		[self removeUnboundedNode: aNode];
+		return;
+	}
+	if (leaf < 0 || leaf >= (GLint)_entryCapacity || _entries[leaf].node != aNode) return;
+
+	[self removeLeaf: leaf];
+	[self freeEntry: leaf];
+	[aNode setBoundsTreeLeaf: kCC3BoundsTreeNoEntry];
+	_nodeCount--;
+}
+
+-(void) removeAllNodes {
+	for (GLuint eIdx = 0; eIdx < _entryCapacity; eIdx++) {
+		CC3NodeBoundsTreeEntry* entry = &_entries[eIdx];
+		if (entry->height == 0) [entry->node setBoundsTreeLeaf: kCC3BoundsTreeNoEntry];
+		entry->node = nil;
+		entry->height = -1;
+		entry->parent = (eIdx + 1 < _entryCapacity) ? (GLint)(eIdx + 1) : kCC3BoundsTreeNoEntry;
+	}
+	_freeEntry = (_entryCapacity > 0) ? 0 : kCC3BoundsTreeNoEntry;
+	_rootEntry = kCC3BoundsTreeNoEntry;
+	_nodeCount = 0;
+
+	for (GLuint uIdx = 0; uIdx < _unboundedNodeCount; uIdx++)
+		[_unboundedNodes[uIdx] setBoundsTreeLeaf: kCC3BoundsTreeNoEntry];
+	_unboundedNodeCount = 0;
+	_structureVersion++;
+}
+
+-(CC3Node*) nodeAtLeaf: (GLint) leaf {
+	if (leaf < 0 || leaf >= (GLint)_entryCapacity || _entries[leaf].height != 0) return nil;
+	return _entries[leaf].node;
+}
+
+
+#pragma mark Building the tree
+
+/**
+ * Returns the cost of descending into the specified child entry, when looking for a sibling
+ * for a leaf with the specified bounds. A leaf child would be paired with the new leaf,
+ * whereas a branch child would only grow by the amount needed to enclose the new leaf.
+ */
+-(GLfloat) costOfDescendingInto: (GLint) childIdx withBounds: (CC3Box) leafBounds {
+	CC3NodeBoundsTreeEntry* child = &_entries[childIdx];
+	GLfloat unionArea = CC3BoxHalfSurfaceArea(CC3BoxUnion(child->bounds, leafBounds));
+	return CC3BoundsTreeEntryIsLeaf(child) ? unionArea : (unionArea - CC3BoxHalfSurfaceArea(child->bounds));
+}
+
+/**
+ * Inserts the specified leaf into the tree, by descending from the root to find the sibling
+ * entry that results in the least increase in the total surface area of the tree, pairing
+ * the leaf with that sibling under a new branch, and refitting the ancestors of that branch.
+ */
+-(void) insertLeaf: (GLint) leaf {
+	if (_rootEntry == kCC3BoundsTreeNoEntry) {
+		_rootEntry = leaf;
+		_entries[leaf].parent = kCC3BoundsTreeNoEntry;
+		return;
+	}
+
+	CC3Box leafBounds = _entries[leaf].bounds;
+	GLint eIdx = _rootEntry;
+	while ( !CC3BoundsTreeEntryIsLeaf(&_entries[eIdx]) ) {
+		CC3NodeBoundsTreeEntry* entry = &_entries[eIdx];
+		GLfloat area = CC3BoxHalfSurfaceArea(entry->bounds);
+		GLfloat combinedArea = CC3BoxHalfSurfaceArea(CC3BoxUnion(entry->bounds, leafBounds));
+
+		// Cost of pairing the leaf with this entry under a new branch
+		GLfloat cost = 2.0f * combinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree
+		GLfloat inheritedCost = 2.0f * (combinedArea - area);
+		GLfloat cost1 = [self costOfDescendingInto: entry->child1 withBounds: leafBounds] + inheritedCost;
+		GLfloat cost2 = [self costOfDescendingInto: entry->child2 withBounds: leafBounds] + inheritedCost;
+
+		if (cost < cost1 && cost < cost2) break;
+		eIdx = (cost1 < cost2) ? entry->child1 : entry->child2;
+	}
+	GLint sibling = eIdx;
+
+	// Create a new branch to hold the sibling and the leaf
+	GLint oldParent = _entries[sibling].parent;
+	GLint newParent = [self allocateEntry];
+	_entries[newParent].parent = oldParent;
+	_entries[newParent].child1 = sibling;
+	_entries[newParent].child2 = leaf;
+	_entries[newParent].bounds = CC3BoxUnion(leafBounds, _entries[sibling].bounds);
+	_entries[newParent].height = _entries[sibling].height + 1;
+	_entries[sibling].parent = newParent;
+	_entries[leaf].parent = newParent;
+
+	if (oldParent == kCC3BoundsTreeNoEntry)
+		_rootEntry = newParent;
+	else if (_entries[oldParent].child1 == sibling)
+		_entries[oldParent].child1 = newParent;
+	else
+		_entries[oldParent].child2 = newParent;
+
+	[self refitFrom: newParent];
+}
+
+/**
+ * Removes the specified leaf from the tree, replacing its parent branch with its sibling,
+ * and refitting the ancestors of that sibling. The leaf entry itself is not freed.
+ */
+-(void) removeLeaf: (GLint) leaf {
+	if (leaf == _rootEntry) {
+		_rootEntry = kCC3BoundsTreeNoEntry;
+		return;
+	}
+
+	GLint parent = _entries[leaf].parent;
+	GLint grandParent = _entries[parent].parent;
+	GLint sibling = (_entries[parent].child1 == leaf) ? _entries[parent].child2 : _entries[parent].child1;
+
+	_entries[sibling].parent = grandParent;
+	if (grandParent == kCC3BoundsTreeNoEntry)
+		_rootEntry = sibling;
+	else if (_entries[grandParent].child1 == parent)
+		_entries[grandParent].child1 = sibling;
+	else
+		_entries[grandParent].child2 = sibling;
+
+	[self freeEntry: parent];
+	_entries[leaf].parent = kCC3BoundsTreeNoEntry;
+	[self refitFrom: grandParent];
+}
+
+/**
+ * Walks up the tree from the specified branch to the root, rebalancing each branch along the
+ * way, and recalculating its height and bounds from those of its children.
+ */
+-(void) refitFrom: (GLint) eIdx {
+	while (eIdx != kCC3BoundsTreeNoEntry) {
+		eIdx = [self rebalance: eIdx];
+		CC3NodeBoundsTreeEntry* entry = &_entries[eIdx];
+		CC3NodeBoundsTreeEntry* child1 = &_entries[entry->child1];
+		CC3NodeBoundsTreeEntry* child2 = &_entries[entry->child2];
+		entry->height = 1 + MAX(child1->height, child2->height);
+		entry->bounds = CC3BoxUnion(child1->bounds, child2->bounds);
+		eIdx = entry->parent;
+	}
+}
+
+/**
+ * If the heights of the children of the specified branch differ by more than one, rotates the
+ * taller child up into the position of the branch, and returns the index of the entry that now
+ * occupies that position. Otherwise, returns the index of the specified branch.
+ */
+-(GLint) rebalance: (GLint) iA {
+	CC3NodeBoundsTreeEntry* A = &_entries[iA];
+	if (CC3BoundsTreeEntryIsLeaf(A) || A->height < 2) return iA;
+
+	GLint iB = A->child1;
+	GLint iC = A->child2;
+	CC3NodeBoundsTreeEntry* B = &_entries[iB];
+	CC3NodeBoundsTreeEntry* C = &_entries[iC];
+	GLint balance = C->height - B->height;
+
+	if (balance > 1) {
+		// Rotate C up, making A a child of C
+		GLint iF = C->child1;
+		GLint iG = C->child2;
+		CC3NodeBoundsTreeEntry* F = &_entries[iF];
+		CC3NodeBoundsTreeEntry* G = &_entries[iG];
+
+		C->child1 = iA;
+		C->parent = A->parent;
+		A->parent = iC;
+		[self replaceChild: iA with: iC inParent: C->parent];
+
+		// Keep the taller grandchild under C, and move the shorter one under A
+		if (F->height > G->height) {
+			C->child2 = iF;
+			A->child2 = iG;
+			G->parent = iA;
+			A->bounds = CC3BoxUnion(B->bounds, G->bounds);
+			C->bounds = CC3BoxUnion(A->bounds, F->bounds);
+			A->height = 1 + MAX(B->height, G->height);
+			C->height = 1 + MAX(A->height, F->height);
+		} else {
+			C->child2 = iG;
+			A->child2 = iF;
+			F->parent = iA;
+			A->bounds = CC3BoxUnion(B->bounds, F->bounds);
+			C->bounds = CC3BoxUnion(A->bounds, G->bounds);
+			A->height = 1 + MAX(B->height, F->height);
+			C->height = 1 + MAX(A->height, G->height);
+		}
+		_structureVersion++;
+		return iC;
+	}
+
+	if (balance < -1) {
+		// Rotate B up, making A a child of B
+		GLint iD = B->child1;
+		GLint iE = B->child2;
+		CC3NodeBoundsTreeEntry* D = &_entries[iD];
+		CC3NodeBoundsTreeEntry* E = &_entries[iE];
+
+		B->child1 = iA;
+		B->parent = A->parent;
+		A->parent = iB;
+		[self replaceChild: iA with: iB inParent: B->parent];
+
+		// Keep the taller grandchild under B, and move the shorter one under A
+		if (D->height > E->height) {
+			B->child2 = iD;
+			A->child1 = iE;
+			E->parent = iA;
+			A->bounds = CC3BoxUnion(C->bounds, E->bounds);
+			B->bounds = CC3BoxUnion(A->bounds, D->bounds);
+			A->height = 1 + MAX(C->height, E->height);
+			B->height = 1 + MAX(A->height, D->height);
+		} else {
+			B->child2 = iE;
+			A->child1 = iD;
+			D->parent = iA;
+			A->bounds = CC3BoxUnion(C->bounds, D->bounds);
+			B->bounds = CC3BoxUnion(A->bounds, E->bounds);
+			A->height = 1 + MAX(C->height, D->height);
+			B->height = 1 + MAX(A->height, E->height);
+		}
+		_structureVersion++;
+		return iB;
+	}
+
+	return iA;
+}
+
+/** Replaces the old child with the new child in the specified parent, or at the root if there is no parent. */
+-(void) replaceChild: (GLint) oldChild with: (GLint) newChild inParent: (GLint) parent {
+	if (parent == kCC3BoundsTreeNoEntry)
+		_rootEntry = newChild;
+	else if (_entries[parent].child1 == oldChild)
+		_entries[parent].child1 = newChild;
+	else
+		_entries[parent].child2 = newChild;
+}
+
+
+#pragma mark Culling
+
+-(GLuint) classifyAgainstFrustum: (CC3Frustum*) aFrustum into: (GLubyte*) results {
+	memset(results, kCC3BoundsCullOutside, _entryCapacity * sizeof(GLubyte));
+	if (_rootEntry == kCC3BoundsTreeNoEntry) return 0;
+
+	CC3Plane* planes = aFrustum.planes;
+	GLuint planeCount = aFrustum.planeCount;
+	GLuint testCount = 0;
+
+	// Depth-first traversal. Entries are pushed with a flag indicating whether they are
+	// already known to be inside the frustum, in which case they need not be tested.
+	GLint stack[kCC3BoundsTreeMaxStackDepth];
+	BOOL isInsideStack[kCC3BoundsTreeMaxStackDepth];
+	GLuint stackDepth = 0;
+	stack[stackDepth] = _rootEntry;
+	isInsideStack[stackDepth++] = NO;
+
+	while (stackDepth > 0) {
+		stackDepth--;
+		GLint eIdx = stack[stackDepth];
+		CC3NodeBoundsTreeEntry* entry = &_entries[eIdx];
+
+		CC3BoundsCullResult result = kCC3BoundsCullInside;
+		if ( !isInsideStack[stackDepth] ) {
+			result = CC3BoxCullAgainstPlanes(entry->bounds, planes, planeCount);
+			testCount++;
+		}
+		if (result == kCC3BoundsCullOutside) continue;
+
+		if (CC3BoundsTreeEntryIsLeaf(entry)) {
+			results[eIdx] = result;
+		} else {
+			CC3Assert(stackDepth + 2 <= kCC3BoundsTreeMaxStackDepth, @"%@ is too deep to traverse", self);
+			BOOL isInside = (result == kCC3BoundsCullInside);
+			stack[stackDepth] = entry->child1;
+			isInsideStack[stackDepth++] = isInside;
+			stack[stackDepth] = entry->child2;
+			isInsideStack[stackDepth++] = isInside;
+		}
+	}
+	return testCount;
+}
+
+
+#pragma mark Ray tracing
+
+-(GLuint) testNodesAlongRay: (CC3Ray) aRay
+				closestOnly: (BOOL) closestOnly
+				  withBlock: (CC3NodeRayTestBlock) nodeTest {
+	GLuint testCount = 0;
+	GLfloat closestDist = kCC3MaxGLfloat;
+
+	// Unbounded nodes might be punctured anywhere along the ray. Test them first, so that
+	// any puncture they contain can be used to skip branches of the tree.
+	for (GLuint uIdx = 0; uIdx < _unboundedNodeCount; uIdx++) {
+		GLfloat dist = nodeTest(_unboundedNodes[uIdx]);
+		testCount++;
+		if (dist >= 0.0f) closestDist = MIN(closestDist, dist);
+	}
+
+	if (_rootEntry == kCC3BoundsTreeNoEntry) return testCount;
+
+	// Work with a unit direction, so that distances along the ray are global distances
+	CC3Vector rayStart = aRay.startLocation;
+	CC3Vector rayDir = CC3VectorNormalize(aRay.direction);
+	CC3Vector invDir = cc3v(CC3BoundsTreeInverseDirection(rayDir.x),
+							CC3BoundsTreeInverseDirection(rayDir.y),
+							CC3BoundsTreeInverseDirection(rayDir.z));
+
+	GLfloat rootDist = CC3BoxRayEntryDistance(_entries[_rootEntry].bounds, rayStart, invDir);
+	if (rootDist < 0.0f) return testCount;
+
+	// Depth-first traversal. Entries are pushed with the distance at which the ray enters their box.
+	GLint stack[kCC3BoundsTreeMaxStackDepth];
+	GLfloat distStack[kCC3BoundsTreeMaxStackDepth];
+	GLuint stackDepth = 0;
+	stack[stackDepth] = _rootEntry;
+	distStack[stackDepth++] = rootDist;
+
+	while (stackDepth > 0) {
+		stackDepth--;
+		if (closestOnly && distStack[stackDepth] > closestDist) continue;
+
+		CC3NodeBoundsTreeEntry* entry = &_entries[stack[stackDepth]];
+		if (CC3BoundsTreeEntryIsLeaf(entry)) {
+			GLfloat dist = nodeTest(entry->node);
+			testCount++;
+			if (dist >= 0.0f) closestDist = MIN(closestDist, dist);
+			continue;
+		}
+
+		// Order the children so that the child that the ray enters first is popped first
+		GLint nearIdx = entry->child1;
+		GLint farIdx = entry->child2;
+		GLfloat nearDist = CC3BoxRayEntryDistance(_entries[nearIdx].bounds, rayStart, invDir);
+		GLfloat farDist = CC3BoxRayEntryDistance(_entries[farIdx].bounds, rayStart, invDir);
+		if (nearDist < 0.0f || (farDist >= 0.0f && farDist < nearDist)) {
+			GLint tmpIdx = nearIdx;
+			nearIdx = farIdx;
+			farIdx = tmpIdx;
+			GLfloat tmpDist = nearDist;
+			nearDist = farDist;
+			farDist = tmpDist;
+		}
+
+		CC3Assert(stackDepth + 2 <= kCC3BoundsTreeMaxStackDepth, @"%@ is too deep to traverse", self);
+		if (farDist >= 0.0f) {
+			stack[stackDepth] = farIdx;
+			distStack[stackDepth++] = farDist;
+		}
+		if (nearDist >= 0.0f) {
+			stack[stackDepth] = nearIdx;
+			distStack[stackDepth++] = nearDist;
+		}
+	}
+	return testCount;
+}
+
+
+#pragma mark Allocation and initialization
+
+-(id) init {
+	if ( (self = [super init]) ) {
+		_entries = NULL;
+		_unboundedNodes = NULL;
+		_rootEntry = kCC3BoundsTreeNoEntry;
+		_freeEntry = kCC3BoundsTreeNoEntry;
+		_entryCapacity = 0;
+		_nodeCount = 0;
+		_unboundedNodeCount = 0;
+		_unboundedNodeCapacity = 0;
+		_structureVersion = 0;
+		_boundsPadding = 0.1f;
+	}
+	return self;
+}
+
++(id) tree { return [[[self alloc] init] autorelease]; }
+
+-(NSString*) description {
+	return [NSString stringWithFormat: @"%@ with %u nodes and %u unbounded nodes",
+			[self class], _nodeCount, _unboundedNodeCount];
+}
+
+@end
+
+
 #pragma mark -
 #pragma mark CC3Node extension for scene
 
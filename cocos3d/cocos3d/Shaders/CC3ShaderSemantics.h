@@ -86,6 +86,10 @@ typedef enum {
 	kCC3SemanticIsDrawingPoints,				/**< (bool) Whether the vertices are being drawn as points. */
 	kCC3SemanticShouldDrawFrontFaces,			/**< (bool) Whether the front side of each face is to be drawn. */
 	kCC3SemanticShouldDrawBackFaces,			/**< (bool) Whether the back side of each face is to be drawn. */
+	kCC3SemanticVertexLocationOffset,			/**< (vec3) Offset added to quantized vertex locations to decode them (zero if the locations are not quantized). */
+	kCC3SemanticVertexLocationScale,			/**< (vec3) Scale applied to quantized vertex locations to decode them (unity if the locations are not quantized). */
+	kCC3SemanticIsVertexNormalOctahedral,		/**< (bool) Whether the vertex normals are held in two-component octahedral form. */
+	kCC3SemanticIsVertexTangentOctahedral,		/**< (bool) Whether the vertex tangents and bitangents are held in two-component octahedral form. */
 	
 	// ENVIRONMENT MATRICES --------------
 	kCC3SemanticModelLocalMatrix,				/**< (mat4) Current model-to-parent matrix. */
@@ -71,6 +71,10 @@ NSString* NSStringFromCC3Semantic(CC3Semantic semantic) {
 		case kCC3SemanticIsDrawingPoints: return @"kCC3SemanticIsDrawingPoints";
 		case kCC3SemanticShouldDrawFrontFaces: return @"kCC3SemanticShouldDrawFrontFaces";
 		case kCC3SemanticShouldDrawBackFaces: return @"kCC3SemanticShouldDrawBackFaces";
+		case kCC3SemanticVertexLocationOffset: return @"kCC3SemanticVertexLocationOffset";
+		case kCC3SemanticVertexLocationScale: return @"kCC3SemanticVertexLocationScale";
+		case kCC3SemanticIsVertexNormalOctahedral: return @"kCC3SemanticIsVertexNormalOctahedral";
+		case kCC3SemanticIsVertexTangentOctahedral: return @"kCC3SemanticIsVertexTangentOctahedral";
 
 			// ENVIRONMENT MATRICES --------------
 		case kCC3SemanticModelLocalMatrix: return @"kCC3SemanticModelLocalMatrix";
@@ -377,6 +381,7 @@ NSString* NSStringFromCC3Semantic(CC3Semantic semantic) {
 	CC3Material* mat;
 	CC3SkinSection* skin;
 	CC3PointParticleEmitter* emitter;
+	CC3VertexLocations* vtxLocs;
 	CC3Matrix4x4 m4x4;
 	CC3Matrix4x3 m4x3,  mRslt4x3, tfmMtx;
 	const CC3Matrix4x3 *pm4x3;
@@ -429,6 +434,20 @@ NSString* NSStringFromCC3Semantic(CC3Semantic semantic) {
 		case kCC3SemanticShouldDrawBackFaces:
 			[uniform setBoolean: !visitor.currentMeshNode.shouldCullBackFaces];
 			return YES;
+		case kCC3SemanticVertexLocationOffset:
+			vtxLocs = visitor.currentMesh.vertexLocations;
+			[uniform setVector: (vtxLocs.isQuantized ? vtxLocs.quantizationOffset : kCC3VectorZero)];
+			return YES;
+		case kCC3SemanticVertexLocationScale:
+			vtxLocs = visitor.currentMesh.vertexLocations;
+			[uniform setVector: (vtxLocs.isQuantized ? vtxLocs.quantizationScale : kCC3VectorUnitCube)];
+			return YES;
+		case kCC3SemanticIsVertexNormalOctahedral:
+			[uniform setBoolean: visitor.currentMesh.vertexNormals.isOctahedral];
+			return YES;
+		case kCC3SemanticIsVertexTangentOctahedral:
+			[uniform setBoolean: visitor.currentMesh.vertexTangents.isOctahedral];
+			return YES;
 
 #pragma mark Setting environment matrix semantics
 		// ENVIRONMENT MATRICES --------------
@@ -1281,6 +1300,10 @@ NSString* NSStringFromCC3Semantic(CC3Semantic semantic) {
 	[self mapVarName: @"u_cc3VertexShouldRescaleNormal" toSemantic: kCC3SemanticShouldRescaleVertexNormal];		/**< (bool) Whether vertex normals should be rescaled. */
 	[self mapVarName: @"u_cc3VertexShouldDrawFrontFaces" toSemantic: kCC3SemanticShouldDrawFrontFaces];			/**< (bool) Whether the front side of each face is to be drawn. */
 	[self mapVarName: @"u_cc3VertexShouldDrawBackFaces" toSemantic: kCC3SemanticShouldDrawBackFaces];			/**< (bool) Whether the back side of each face is to be drawn. */
+	[self mapVarName: @"u_cc3VertexLocationOffset" toSemantic: kCC3SemanticVertexLocationOffset];				/**< (vec3) Offset added to quantized vertex locations to decode them. */
+	[self mapVarName: @"u_cc3VertexLocationScale" toSemantic: kCC3SemanticVertexLocationScale];					/**< (vec3) Scale applied to quantized vertex locations to decode them. */
+	[self mapVarName: @"u_cc3VertexNormalIsOctahedral" toSemantic: kCC3SemanticIsVertexNormalOctahedral];		/**< (bool) Whether the vertex normals are held in octahedral form. */
+	[self mapVarName: @"u_cc3VertexTangentIsOctahedral" toSemantic: kCC3SemanticIsVertexTangentOctahedral];		/**< (bool) Whether the vertex tangents and bitangents are held in octahedral form. */
 	
 	// ENVIRONMENT MATRICES --------------
 	[self mapVarName: @"u_cc3MatrixModelLocal" toSemantic: kCC3SemanticModelLocalMatrix];						/**< (mat4) Current model-to-parent matrix. */
@@ -1489,6 +1512,10 @@ NSString* NSStringFromCC3Semantic(CC3Semantic semantic) {
 	[self mapVarName: @"u_cc3Vertex.isDrawingPoints" toSemantic: kCC3SemanticIsDrawingPoints];					/**< (bool) Whether the vertices are being drawn as points. */
 	[self mapVarName: @"u_cc3Vertex.shouldNormalizeNormal" toSemantic: kCC3SemanticShouldNormalizeVertexNormal];	/**< (bool) Whether vertex normals should be normalized. */
 	[self mapVarName: @"u_cc3Vertex.shouldRescaleNormal" toSemantic: kCC3SemanticShouldRescaleVertexNormal];	/**< (bool) Whether vertex normals should be rescaled. */
+	[self mapVarName: @"u_cc3Vertex.locationOffset" toSemantic: kCC3SemanticVertexLocationOffset];				/**< (vec3) Offset added to quantized vertex locations to decode them. */
+	[self mapVarName: @"u_cc3Vertex.locationScale" toSemantic: kCC3SemanticVertexLocationScale];				/**< (vec3) Scale applied to quantized vertex locations to decode them. */
+	[self mapVarName: @"u_cc3Vertex.isNormalOctahedral" toSemantic: kCC3SemanticIsVertexNormalOctahedral];		/**< (bool) Whether the vertex normals are held in octahedral form. */
+	[self mapVarName: @"u_cc3Vertex.isTangentOctahedral" toSemantic: kCC3SemanticIsVertexTangentOctahedral];	/**< (bool) Whether the vertex tangents and bitangents are held in octahedral form. */
 	
 	// ENVIRONMENT MATRICES --------------
 	[self mapVarName: @"u_cc3Matrices.modelLocal" toSemantic: kCC3SemanticModelLocalMatrix];					/**< (mat4) Current model-to-parent matrix. */
@@ -1408,6 +1408,25 @@ CC3Vector CC3RayIntersectionWithBox(CC3Ray aRay, CC3Box bb);
 CC3Vector4 CC3RayIntersectionWithBoxSide(CC3Ray aRay, CC3Box bb,
 										 CC3Vector sideNormal, CC3Vector4 prevHit);
 
+/**
+ * Returns half of the surface area of the specified bounding box.
+ *
+ * The surface area of a box is proportional to the likelihood that a randomly oriented ray
+ * will strike it, and is used to estimate the cost of boxes within bounding volume hierarchies.
+ */
+static inline GLfloat CC3BoxHalfSurfaceArea(CC3Box bb) {
+	CC3Vector bbSize = CC3BoxSize(bb);
+	return (bbSize.x * bbSize.y) + (bbSize.y * bbSize.z) + (bbSize.z * bbSize.x);
+}
+
+/** Returns whether the two specified bounding boxes overlap. Boxes that share only a side are considered to overlap. */
+static inline BOOL CC3DoesBoxIntersectBox(CC3Box bb1, CC3Box bb2) {
+	if (bb1.minimum.x > bb2.maximum.x || bb2.minimum.x > bb1.maximum.x) return NO;
+	if (bb1.minimum.y > bb2.maximum.y || bb2.minimum.y > bb1.maximum.y) return NO;
+	if (bb1.minimum.z > bb2.maximum.z || bb2.minimum.z > bb1.maximum.z) return NO;
+	return YES;
+}
+
 /** @deprecated Renamed to CC3Box. */
 typedef CC3Box CC3BoundingBox __deprecated;
 
@@ -1682,6 +1701,25 @@ static inline CC3Vector CC3FaceLocationFromBarycentricWeights(CC3Face face, CC3B
 	return v;
 }
 
+/**
+ * Returns the location on the specified face, including its edges and corners,
+ * that is closest to the specified location.
+ *
+ * Reference: Real-Time Collision Detection book, by Christer Ericson.
+ */
+CC3Vector CC3FaceClosestLocation(CC3Face face, CC3Vector aLocation);
+
+/**
+ * Returns whether the specified face overlaps the specified bounding box.
+ *
+ * The face overlaps the box if no plane can be found that separates the two. The planes tested
+ * are those perpendicular to the axes of the box, the plane of the face, and the planes that are
+ * parallel to an edge of the face and to an edge of the box.
+ *
+ * Reference: Fast 3D Triangle-Box Overlap Testing, by Tomas Akenine-Moller.
+ */
+BOOL CC3DoesFaceIntersectBox(CC3Face face, CC3Box bb);
+
 /**
  * Defines a triangular face of the mesh, comprised of three vertex indices,
  * each a GLuint, stored in winding order.
@@ -1922,6 +1960,18 @@ static inline BOOL CC3DoesSphereIntersectSphere(CC3Sphere sphereOne, CC3Sphere s
 	return CC3IsLocationWithinSphere(sphereTwo.center, bigSphere);
 }
 
+/** Returns whether the specified bounding box and sphere intersect. */
+static inline BOOL CC3DoesBoxIntersectSphere(CC3Box bb, CC3Sphere aSphere) {
+	// Clamp the center of the sphere to the box to find the location in the box closest to it.
+	CC3Vector closestLoc = CC3VectorMaximize(bb.minimum, CC3VectorMinimize(aSphere.center, bb.maximum));
+	return CC3IsLocationWithinSphere(closestLoc, aSphere);
+}
+
+/** Returns whether the specified face and sphere intersect. */
+static inline BOOL CC3DoesFaceIntersectSphere(CC3Face face, CC3Sphere aSphere) {
+	return CC3IsLocationWithinSphere(CC3FaceClosestLocation(face, aSphere.center), aSphere);
+}
+
 /** Returns the smallest CC3Sphere that contains the two specified spheres. */
 CC3Sphere CC3SphereUnion(CC3Sphere s1, CC3Sphere s2);
 
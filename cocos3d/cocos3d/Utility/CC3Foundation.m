@@ -332,6 +332,89 @@ CC3BarycentricWeights CC3FaceBarycentricWeights(CC3Face face, CC3Vector v) {
 }
 */
 
+CC3Vector CC3FaceClosestLocation(CC3Face face, CC3Vector aLocation) {
+	CC3Vector a = face.vertices[0];
+	CC3Vector b = face.vertices[1];
+	CC3Vector c = face.vertices[2];
+	CC3Vector ab = CC3VectorDifference(b, a);
+	CC3Vector ac = CC3VectorDifference(c, a);
+
+	// Determine which of the seven Voronoi regions of the triangle (three corners, three edges,
+	// and the interior) contains the location, by projecting the location onto each edge.
+	CC3Vector ap = CC3VectorDifference(aLocation, a);
+	GLfloat d1 = CC3VectorDot(ab, ap);
+	GLfloat d2 = CC3VectorDot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f) return a;
+	
+	CC3Vector bp = CC3VectorDifference(aLocation, b);
+	GLfloat d3 = CC3VectorDot(ab, bp);
+	GLfloat d4 = CC3VectorDot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3) return b;
+	
+	GLfloat vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		return CC3VectorAdd(a, CC3VectorScaleUniform(ab, d1 / (d1 - d3)));
+	
+	CC3Vector cp = CC3VectorDifference(aLocation, c);
+	GLfloat d5 = CC3VectorDot(ab, cp);
+	GLfloat d6 = CC3VectorDot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6) return c;
+	
+	GLfloat vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		return CC3VectorAdd(a, CC3VectorScaleUniform(ac, d2 / (d2 - d6)));
+	
+	GLfloat va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+		return CC3VectorAdd(b, CC3VectorScaleUniform(CC3VectorDifference(c, b),
+													 (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+	
+	// The location projects onto the interior of the triangle
+	GLfloat denom = 1.0f / (va + vb + vc);
+	return CC3VectorAdd(a, CC3VectorAdd(CC3VectorScaleUniform(ab, vb * denom),
+										CC3VectorScaleUniform(ac, vc * denom)));
+}
+
+/**
+ * Returns whether the specified axis separates the specified triangle, whose corners are
+ * specified relative to the center of a box, from the box, whose size is specified as the
+ * distance from its center to each side. The axis does not need to be normalized.
+ */
+static BOOL CC3IsAxisSeparatingFaceFromBox(CC3Vector axis, CC3Vector v0, CC3Vector v1, CC3Vector v2,
+										   CC3Vector halfSize) {
+	GLfloat p0 = CC3VectorDot(v0, axis);
+	GLfloat p1 = CC3VectorDot(v1, axis);
+	GLfloat p2 = CC3VectorDot(v2, axis);
+	GLfloat r = (halfSize.x * fabsf(axis.x)) + (halfSize.y * fabsf(axis.y)) + (halfSize.z * fabsf(axis.z));
+	return MIN(MIN(p0, p1), p2) > r || MAX(MAX(p0, p1), p2) < -r;
+}
+
+BOOL CC3DoesFaceIntersectBox(CC3Face face, CC3Box bb) {
+	// Work relative to the center of the box
+	CC3Vector bbCenter = CC3BoxCenter(bb);
+	CC3Vector halfSize = CC3VectorScaleUniform(CC3BoxSize(bb), 0.5f);
+	CC3Vector v0 = CC3VectorDifference(face.vertices[0], bbCenter);
+	CC3Vector v1 = CC3VectorDifference(face.vertices[1], bbCenter);
+	CC3Vector v2 = CC3VectorDifference(face.vertices[2], bbCenter);
+
+	// The three axes of the box
+	if (CC3IsAxisSeparatingFaceFromBox(kCC3VectorUnitXPositive, v0, v1, v2, halfSize)) return NO;
+	if (CC3IsAxisSeparatingFaceFromBox(kCC3VectorUnitYPositive, v0, v1, v2, halfSize)) return NO;
+	if (CC3IsAxisSeparatingFaceFromBox(kCC3VectorUnitZPositive, v0, v1, v2, halfSize)) return NO;
+
+	// The nine cross-products of each edge of the face with each axis of the box
+	CC3Vector edges[3] = { CC3VectorDifference(v1, v0), CC3VectorDifference(v2, v1), CC3VectorDifference(v0, v2) };
+	for (int eIdx = 0; eIdx < 3; eIdx++) {
+		CC3Vector e = edges[eIdx];
+		if (CC3IsAxisSeparatingFaceFromBox(cc3v(0.0f, -e.z, e.y), v0, v1, v2, halfSize)) return NO;
+		if (CC3IsAxisSeparatingFaceFromBox(cc3v(e.z, 0.0f, -e.x), v0, v1, v2, halfSize)) return NO;
+		if (CC3IsAxisSeparatingFaceFromBox(cc3v(-e.y, e.x, 0.0f), v0, v1, v2, halfSize)) return NO;
+	}
+
+	// The normal of the face
+	return !CC3IsAxisSeparatingFaceFromBox(CC3VectorCross(edges[0], edges[1]), v0, v1, v2, halfSize);
+}
+
 
 #pragma mark -
 #pragma mark Plane structures and functions
@@ -51,6 +51,8 @@
 	CCTime _accumulatedUpdateTime;
 	GLuint _nodesUpdated;
 	GLuint _nodesTransformed;
+	CCTime _accumulatedConcurrentUpdateTime;
+	CCTime _accumulatedConcurrentUpdateWorkTime;
 	
 	GLuint _framesHandled;
 	CCTime _accumulatedFrameTime;
@@ -96,6 +98,28 @@
 /** Increments the nodesTransformed property by one. */
 -(void) incrementNodesTransformed;
 
+/**
+ * The total elapsed time spent updating subtrees of nodes concurrently since the reset
+ * method was last invoked.
+ *
+ * Subtrees of nodes are updated concurrently when the shouldUpdateConcurrently property
+ * of the CC3NodeUpdatingVisitor of the scene is set to YES.
+ */
+@property(nonatomic, readonly) CCTime accumulatedConcurrentUpdateTime;
+
+/**
+ * The total time that the subtrees that were updated concurrently, and whose elapsed time is
+ * tracked in the accumulatedConcurrentUpdateTime property, would have taken to update one
+ * after the other on a single thread. This is the sum of the time taken by each subtree.
+ */
+@property(nonatomic, readonly) CCTime accumulatedConcurrentUpdateWorkTime;
+
+/**
+ * Adds the specified elapsed time and single-thread work time of a single concurrent update
+ * to the accumulatedConcurrentUpdateTime and accumulatedConcurrentUpdateWorkTime properties.
+ */
+-(void) addConcurrentUpdateTime: (CCTime) elapsedTime withWorkTime: (CCTime) workTime;
+
 
 #pragma mark Accumulated frame drawing statistics
 
@@ -191,6 +215,16 @@
  */
 @property(nonatomic, readonly) GLfloat averageNodesTransformedPerUpdate;
 
+/**
+ * The speedup achieved by updating subtrees of nodes concurrently, calculated by dividing the
+ * accumulatedConcurrentUpdateWorkTime property by the accumulatedConcurrentUpdateTime property.
+ *
+ * On a multi-core device, a value greater than one indicates the factor by which concurrent
+ * updating has reduced the time spent updating those subtrees. If no subtrees have been updated
+ * concurrently, this property returns zero.
+ */
+@property(nonatomic, readonly) GLfloat concurrentUpdateSpeedup;
+
 
 #pragma mark Average frame drawing statistics
 
@@ -39,6 +39,8 @@
 
 @synthesize updatesHandled=_updatesHandled, accumulatedUpdateTime=_accumulatedUpdateTime;
 @synthesize nodesUpdated=_nodesUpdated, nodesTransformed=_nodesTransformed;
+@synthesize accumulatedConcurrentUpdateTime=_accumulatedConcurrentUpdateTime;
+@synthesize accumulatedConcurrentUpdateWorkTime=_accumulatedConcurrentUpdateWorkTime;
 @synthesize framesHandled=_framesHandled, accumulatedFrameTime=_accumulatedFrameTime;
 @synthesize nodesDrawn=_nodesDrawn, nodesVisitedForDrawing=_nodesVisitedForDrawing;
 @synthesize drawingCallsMade=_drawingCallsMade, facesPresented=_facesPresented;
@@ -59,6 +61,11 @@
 
 -(void) incrementNodesTransformed { _nodesTransformed++; }
 
+-(void) addConcurrentUpdateTime: (CCTime) elapsedTime withWorkTime: (CCTime) workTime {
+	_accumulatedConcurrentUpdateTime += elapsedTime;
+	_accumulatedConcurrentUpdateWorkTime += workTime;
+}
+
 
 #pragma mark Accumulated frame drawing statistics
 
@@ -99,6 +106,11 @@
 	return _framesHandled ? ((GLfloat)_nodesTransformed / (GLfloat)_updatesHandled) : 0.0;
 }
 
+-(GLfloat) concurrentUpdateSpeedup {
+	return (_accumulatedConcurrentUpdateTime != 0.0f)
+				? (_accumulatedConcurrentUpdateWorkTime / _accumulatedConcurrentUpdateTime) : 0.0;
+}
+
 
 #pragma mark Average frame drawing statistics
 
@@ -139,6 +151,8 @@
 	_accumulatedUpdateTime = 0;
 	_nodesUpdated = 0;
 	_nodesTransformed = 0;
+	_accumulatedConcurrentUpdateTime = 0.0;
+	_accumulatedConcurrentUpdateWorkTime = 0.0;
 	
 	_framesHandled = 0;
 	_accumulatedFrameTime = 0.0;
@@ -153,6 +167,8 @@
 	_accumulatedUpdateTime = another.accumulatedUpdateTime;
 	_nodesUpdated = another.nodesUpdated;
 	_nodesTransformed = another.nodesTransformed;
+	_accumulatedConcurrentUpdateTime = another.accumulatedConcurrentUpdateTime;
+	_accumulatedConcurrentUpdateWorkTime = another.accumulatedConcurrentUpdateWorkTime;
 	
 	_framesHandled = another.framesHandled;
 	_accumulatedFrameTime = another.accumulatedFrameTime;